@@ -0,0 +1,238 @@
+/*
+ * FreeRTOS Kernel V10.2.0
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*
+ * Work queues are used to defer processing from interrupts (or tasks) to a
+ * small pool of worker tasks.  An interrupt posts a function pointer and two
+ * parameters, in the same form as xTimerPendFunctionCallFromISR(), and one of
+ * the worker tasks executes the function at task level.
+ *
+ * Submissions claim a slot in a ring with the atomic.h compare-and-swap, so
+ * any number of interrupts and tasks may submit to the same work queue, and no
+ * critical section is held across the copy of an item.  Unless
+ * configUSE_GCC_BUILTIN_ATOMICS is set, atomic.h implements each
+ * compare-and-swap with a short critical section of its own.
+ *
+ * Only the first submission made while the workers are idle generates a task
+ * notification - later submissions are picked up by the same wake up.  Under
+ * an interrupt storm this collapses many ISR to task hand offs into a single
+ * context switch.
+ *
+ * configUSE_WORK_QUEUES must be set to 1 in FreeRTOSConfig.h for the work
+ * queue API to be available.
+ */
+
+#ifndef WORK_QUEUE_H
+#define WORK_QUEUE_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include work_queue.h"
+#endif
+
+#include "task.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/* The maximum number of worker tasks that can service a single work queue. */
+#define workqueueMAX_WORKERS	( ( UBaseType_t ) 32U )
+
+/**
+ * Type by which work queues are referenced.  For example, a call to
+ * xWorkQueueCreate() returns a WorkQueueHandle_t variable that can then be
+ * used as a parameter to xWorkQueueSubmitFromISR(), xWorkQueueSubmit(), etc.
+ */
+struct WorkQueueDef_t;
+typedef struct WorkQueueDef_t * WorkQueueHandle_t;
+
+/*
+ * Defines the prototype to which functions submitted to a work queue must
+ * conform.
+ */
+typedef void (*WorkFunction_t)( void *, uint32_t );
+
+/*
+ * Counters maintained by each work queue, see vWorkQueueGetStats().
+ */
+typedef struct xWORK_QUEUE_STATS
+{
+	uint32_t ulSubmitted;	/*<< The number of items successfully submitted to the queue. */
+	uint32_t ulExecuted;	/*<< The number of items executed by the worker tasks. */
+	uint32_t ulWakeUps;		/*<< The number of task notifications sent to the worker tasks. */
+	uint32_t ulOverflows;	/*<< The number of submissions rejected because the ring was full. */
+} WorkQueueStats_t;
+
+/**
+ * work_queue.h
+ *
+<pre>
+WorkQueueHandle_t xWorkQueueCreate( UBaseType_t uxQueueLength,
+                                    UBaseType_t uxNumberOfWorkers,
+                                    UBaseType_t uxPriority,
+                                    configSTACK_DEPTH_TYPE usStackDepth,
+                                    const char * const pcName );
+</pre>
+ *
+ * Creates a work queue along with the pool of worker tasks that service it.
+ * Work queues are intended to be created once, before or shortly after the
+ * scheduler is started, and are never deleted.
+ *
+ * Drivers that need their deferred processing to run at different urgencies
+ * should create one work queue per priority level - all the workers of a queue
+ * run at the same priority.
+ *
+ * @param uxQueueLength The maximum number of items that can be pending at any
+ * one time.  Must be a power of two.
+ *
+ * @param uxNumberOfWorkers The number of worker tasks to create, from 1 to
+ * workqueueMAX_WORKERS.  When more than one worker is created an idle worker
+ * is woken to share a backlog while another worker is busy executing an item.
+ *
+ * @param uxPriority The priority at which the worker tasks execute.
+ *
+ * @param usStackDepth The stack depth, in words, of each worker task.
+ *
+ * @param pcName The name given to each worker task, for debugging only.
+ *
+ * @return A handle to the created work queue, or NULL if there was
+ * insufficient heap memory to create the queue or its worker tasks.
+ *
+ * \defgroup xWorkQueueCreate xWorkQueueCreate
+ * \ingroup WorkQueueManagement
+ */
+WorkQueueHandle_t xWorkQueueCreate( UBaseType_t uxQueueLength,
+									UBaseType_t uxNumberOfWorkers,
+									UBaseType_t uxPriority,
+									configSTACK_DEPTH_TYPE usStackDepth,
+									const char * const pcName ) PRIVILEGED_FUNCTION;
+
+/**
+ * work_queue.h
+ *
+<pre>
+BaseType_t xWorkQueueSubmitFromISR( WorkQueueHandle_t xWorkQueue,
+                                    WorkFunction_t xFunctionToDefer,
+                                    void *pvParameter1,
+                                    uint32_t ulParameter2,
+                                    BaseType_t *pxHigherPriorityTaskWoken );
+</pre>
+ *
+ * Used from an interrupt service routine to defer the execution of a function
+ * to one of the worker tasks of xWorkQueue.  The call never blocks.
+ *
+ * @param xWorkQueue The work queue to which the function is submitted.
+ *
+ * @param xFunctionToDefer The function to execute from a worker task.
+ *
+ * @param pvParameter1 The value passed into the deferred function as its first
+ * parameter.
+ *
+ * @param ulParameter2 The value passed into the deferred function as its
+ * second parameter.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if the submission woke a
+ * worker task that has a priority above that of the interrupted task, in
+ * which case a context switch should be requested before the interrupt exits.
+ * Submissions that are coalesced into an earlier wake up leave the value
+ * unchanged.
+ *
+ * @return pdPASS if the function was queued, or pdFAIL if the ring was full.
+ *
+ * Example use:
+<pre>
+
+ // The deferred part of the interrupt handling, runs in a worker task.
+ void vProcessRxDescriptors( void *pvParameter1, uint32_t ulParameter2 )
+ {
+     // Empty the DMA descriptors that completed since the last call.
+ }
+
+ // The interrupt service routine itself.
+ void vEMACInterruptHandler( void )
+ {
+ BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+     // Clear the interrupt source, then defer the work.
+     xWorkQueueSubmitFromISR( xEthWorkQueue, vProcessRxDescriptors, NULL, 0, &xHigherPriorityTaskWoken );
+
+     portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+ }
+
+</pre>
+ * \defgroup xWorkQueueSubmitFromISR xWorkQueueSubmitFromISR
+ * \ingroup WorkQueueManagement
+ */
+BaseType_t xWorkQueueSubmitFromISR( WorkQueueHandle_t xWorkQueue,
+									WorkFunction_t xFunctionToDefer,
+									void *pvParameter1,
+									uint32_t ulParameter2,
+									BaseType_t *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * work_queue.h
+ *
+<pre>
+BaseType_t xWorkQueueSubmit( WorkQueueHandle_t xWorkQueue,
+                             WorkFunction_t xFunctionToDefer,
+                             void *pvParameter1,
+                             uint32_t ulParameter2 );
+</pre>
+ *
+ * The task level equivalent of xWorkQueueSubmitFromISR().  The call never
+ * blocks.
+ *
+ * @return pdPASS if the function was queued, or pdFAIL if the ring was full.
+ *
+ * \defgroup xWorkQueueSubmit xWorkQueueSubmit
+ * \ingroup WorkQueueManagement
+ */
+BaseType_t xWorkQueueSubmit( WorkQueueHandle_t xWorkQueue,
+							 WorkFunction_t xFunctionToDefer,
+							 void *pvParameter1,
+							 uint32_t ulParameter2 ) PRIVILEGED_FUNCTION;
+
+/**
+ * work_queue.h
+ *
+<pre>
+void vWorkQueueGetStats( WorkQueueHandle_t xWorkQueue, WorkQueueStats_t *pxStats );
+</pre>
+ *
+ * Takes a snapshot of the counters maintained by xWorkQueue.  Comparing
+ * ulSubmitted with ulWakeUps shows how many submissions were coalesced.
+ *
+ * \defgroup vWorkQueueGetStats vWorkQueueGetStats
+ * \ingroup WorkQueueManagement
+ */
+void vWorkQueueGetStats( WorkQueueHandle_t xWorkQueue, WorkQueueStats_t *pxStats ) PRIVILEGED_FUNCTION;
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif	/* !defined( WORK_QUEUE_H ) */
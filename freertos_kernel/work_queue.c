@@ -0,0 +1,468 @@
+/*
+ * FreeRTOS Kernel V10.2.0
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "atomic.h"
+#include "work_queue.h"
+
+/* Lint e961, e9021 and e750 are suppressed as a MISRA exception justified
+because the MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined
+for the header files above, but not in this file, in order to generate the
+correct privileged Vs unprivileged linkage and placement. */
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE /*lint !e961 !e750 !e9021. */
+
+/* This entire source file will be skipped if the application is not configured
+to include work queue functionality.  This #if is closed at the very bottom of
+this file.  If you want to include work queues then ensure configUSE_WORK_QUEUES
+is set to 1 in FreeRTOSConfig.h. */
+#if( configUSE_WORK_QUEUES == 1 )
+
+#if( configUSE_TASK_NOTIFICATIONS != 1 )
+	#error configUSE_TASK_NOTIFICATIONS must be set to 1 to build work_queue.c
+#endif
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION != 1 )
+	#error configSUPPORT_DYNAMIC_ALLOCATION must be set to 1 to build work_queue.c
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* A single slot in the ring.  The ring is the bounded multi-producer queue
+described by Dmitry Vyukov: ulSequence tells producers and consumers whether
+the slot is free to write (ulSequence == position) or holds an item ready to be
+read (ulSequence == position + 1).  Producers and consumers claim positions
+with the atomic.h compare-and-swap, and no critical section is held while an
+item is being copied in or out.  Without configUSE_GCC_BUILTIN_ATOMICS the
+compare-and-swap itself is a short critical section.  The members are volatile
+so the compiler cannot move the copy to the far side of the ulSequence
+update. */
+typedef struct WorkQueueItemDef_t
+{
+	volatile uint32_t ulSequence;
+	volatile WorkFunction_t pxFunction;
+	void * volatile pvParameter1;
+	volatile uint32_t ulParameter2;
+} WorkQueueItem_t;
+
+struct WorkQueueDef_t;
+
+/* Each worker task is passed a pointer to its own descriptor. */
+typedef struct WorkQueueWorkerDef_t
+{
+	struct WorkQueueDef_t *pxWorkQueue;	/* The queue serviced by the worker. */
+	TaskHandle_t xTask;					/* The worker task itself. */
+	uint32_t ulIdleBit;					/* The bit that represents this worker in ulIdleWorkers. */
+} WorkQueueWorker_t;
+
+/* Structure that holds the state of a work queue. */
+typedef struct WorkQueueDef_t /*lint !e9058 Style convention uses tag. */
+{
+	volatile uint32_t ulEnqueuePosition;	/* The next position a producer will claim. */
+	volatile uint32_t ulDequeuePosition;	/* The next position a worker will claim. */
+	uint32_t ulMask;						/* The ring length minus one. */
+	WorkQueueItem_t *pxItems;				/* The ring itself. */
+	volatile uint32_t ulWakeUpPending;		/* Non-zero while a notification has been sent that no worker has yet acted on. */
+	volatile uint32_t ulIdleWorkers;		/* One bit per worker, set while the worker is waiting for a notification. */
+	UBaseType_t uxNumberOfWorkers;
+	UBaseType_t uxNextWorker;				/* Used to pick a worker when none are idle. */
+	WorkQueueWorker_t *pxWorkers;
+	volatile uint32_t ulSubmitted;
+	volatile uint32_t ulExecuted;
+	volatile uint32_t ulWakeUps;
+	volatile uint32_t ulOverflows;
+} WorkQueue_t;
+
+/*
+ * The function executed by each worker task.
+ */
+static portTASK_FUNCTION_PROTO( prvWorkQueueTask, pvParameters ) PRIVILEGED_FUNCTION;
+
+/*
+ * Claim the next free slot in the ring and fill it.  Returns pdFAIL if the
+ * ring is full.
+ */
+static BaseType_t prvEnqueue( WorkQueue_t * const pxWorkQueue,
+							  WorkFunction_t xFunctionToDefer,
+							  void *pvParameter1,
+							  uint32_t ulParameter2 ) PRIVILEGED_FUNCTION;
+
+/*
+ * Copy the oldest item out of the ring into pxItem.  Returns pdFALSE if there
+ * is no item ready to be read.
+ */
+static BaseType_t prvDequeue( WorkQueue_t * const pxWorkQueue, WorkQueueItem_t *pxItem ) PRIVILEGED_FUNCTION;
+
+/*
+ * Notify a worker, unless a notification is already outstanding.  Called
+ * after every successful enqueue.
+ */
+static void prvWakeWorker( WorkQueue_t * const pxWorkQueue, BaseType_t xFromISR, BaseType_t *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+WorkQueueHandle_t xWorkQueueCreate( UBaseType_t uxQueueLength,
+									UBaseType_t uxNumberOfWorkers,
+									UBaseType_t uxPriority,
+									configSTACK_DEPTH_TYPE usStackDepth,
+									const char * const pcName )
+{
+WorkQueue_t *pxWorkQueue;
+uint8_t *pucAllocatedMemory;
+size_t xItemSpace, xWorkerSpace;
+UBaseType_t uxIndex;
+
+	/* The ring is indexed by masking the position, so its length must be a
+	power of two. */
+	configASSERT( uxQueueLength > ( UBaseType_t ) 1 );
+	configASSERT( ( uxQueueLength & ( uxQueueLength - ( UBaseType_t ) 1 ) ) == ( UBaseType_t ) 0 );
+	configASSERT( uxNumberOfWorkers > ( UBaseType_t ) 0 );
+	configASSERT( uxNumberOfWorkers <= workqueueMAX_WORKERS );
+
+	/* The structure, the ring and the worker descriptors are allocated in one
+	block.  The ring is placed directly after the structure, whose size is a
+	multiple of the pointer size, so the ring is suitably aligned. */
+	xItemSpace = ( size_t ) uxQueueLength * sizeof( WorkQueueItem_t );
+	xWorkerSpace = ( size_t ) uxNumberOfWorkers * sizeof( WorkQueueWorker_t );
+	pucAllocatedMemory = ( uint8_t * ) pvPortMalloc( sizeof( WorkQueue_t ) + xItemSpace + xWorkerSpace ); /*lint !e9079 malloc() only returns void*. */
+
+	if( pucAllocatedMemory != NULL )
+	{
+		pxWorkQueue = ( WorkQueue_t * ) pucAllocatedMemory; /*lint !e9087 Safe cast as allocated memory is aligned. */
+		pxWorkQueue->pxItems = ( WorkQueueItem_t * ) ( pucAllocatedMemory + sizeof( WorkQueue_t ) ); /*lint !e9087 !e9016 Safe cast and pointer arithmetic. */
+		pxWorkQueue->pxWorkers = ( WorkQueueWorker_t * ) ( pucAllocatedMemory + sizeof( WorkQueue_t ) + xItemSpace ); /*lint !e9087 !e9016 Safe cast and pointer arithmetic. */
+		pxWorkQueue->ulMask = ( uint32_t ) uxQueueLength - 1U;
+		pxWorkQueue->ulEnqueuePosition = 0U;
+		pxWorkQueue->ulDequeuePosition = 0U;
+		pxWorkQueue->ulWakeUpPending = 0U;
+		pxWorkQueue->ulIdleWorkers = 0U;
+		pxWorkQueue->uxNumberOfWorkers = uxNumberOfWorkers;
+		pxWorkQueue->uxNextWorker = 0U;
+		pxWorkQueue->ulSubmitted = 0U;
+		pxWorkQueue->ulExecuted = 0U;
+		pxWorkQueue->ulWakeUps = 0U;
+		pxWorkQueue->ulOverflows = 0U;
+
+		for( uxIndex = 0U; uxIndex < uxQueueLength; uxIndex++ )
+		{
+			pxWorkQueue->pxItems[ uxIndex ].ulSequence = ( uint32_t ) uxIndex;
+		}
+
+		for( uxIndex = 0U; uxIndex < uxNumberOfWorkers; uxIndex++ )
+		{
+			pxWorkQueue->pxWorkers[ uxIndex ].pxWorkQueue = pxWorkQueue;
+			pxWorkQueue->pxWorkers[ uxIndex ].ulIdleBit = ( ( uint32_t ) 1U ) << uxIndex;
+
+			/* xTaskCreate() stores the handle before the new task can run, so
+			the worker is always known before it advertises itself as idle. */
+			if( xTaskCreate( prvWorkQueueTask,
+							 pcName,
+							 usStackDepth,
+							 ( void * ) &( pxWorkQueue->pxWorkers[ uxIndex ] ),
+							 uxPriority,
+							 &( pxWorkQueue->pxWorkers[ uxIndex ].xTask ) ) != pdPASS )
+			{
+				break;
+			}
+		}
+
+		if( uxIndex != uxNumberOfWorkers )
+		{
+			/* Could not create every worker.  Delete those that were created
+			before freeing the memory they reference. */
+			while( uxIndex > 0U )
+			{
+				uxIndex--;
+				vTaskDelete( pxWorkQueue->pxWorkers[ uxIndex ].xTask );
+			}
+
+			vPortFree( pucAllocatedMemory );
+			pxWorkQueue = NULL;
+		}
+	}
+	else
+	{
+		pxWorkQueue = NULL;
+	}
+
+	return pxWorkQueue;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xWorkQueueSubmitFromISR( WorkQueueHandle_t xWorkQueue,
+									WorkFunction_t xFunctionToDefer,
+									void *pvParameter1,
+									uint32_t ulParameter2,
+									BaseType_t *pxHigherPriorityTaskWoken )
+{
+WorkQueue_t * const pxWorkQueue = xWorkQueue;
+BaseType_t xReturn;
+
+	configASSERT( pxWorkQueue );
+	configASSERT( xFunctionToDefer );
+
+	xReturn = prvEnqueue( pxWorkQueue, xFunctionToDefer, pvParameter1, ulParameter2 );
+
+	if( xReturn != pdFAIL )
+	{
+		prvWakeWorker( pxWorkQueue, pdTRUE, pxHigherPriorityTaskWoken );
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xWorkQueueSubmit( WorkQueueHandle_t xWorkQueue,
+							 WorkFunction_t xFunctionToDefer,
+							 void *pvParameter1,
+							 uint32_t ulParameter2 )
+{
+WorkQueue_t * const pxWorkQueue = xWorkQueue;
+BaseType_t xReturn;
+
+	configASSERT( pxWorkQueue );
+	configASSERT( xFunctionToDefer );
+
+	xReturn = prvEnqueue( pxWorkQueue, xFunctionToDefer, pvParameter1, ulParameter2 );
+
+	if( xReturn != pdFAIL )
+	{
+		prvWakeWorker( pxWorkQueue, pdFALSE, NULL );
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vWorkQueueGetStats( WorkQueueHandle_t xWorkQueue, WorkQueueStats_t *pxStats )
+{
+WorkQueue_t * const pxWorkQueue = xWorkQueue;
+
+	configASSERT( pxWorkQueue );
+	configASSERT( pxStats );
+
+	pxStats->ulSubmitted = pxWorkQueue->ulSubmitted;
+	pxStats->ulExecuted = pxWorkQueue->ulExecuted;
+	pxStats->ulWakeUps = pxWorkQueue->ulWakeUps;
+	pxStats->ulOverflows = pxWorkQueue->ulOverflows;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvEnqueue( WorkQueue_t * const pxWorkQueue,
+							  WorkFunction_t xFunctionToDefer,
+							  void *pvParameter1,
+							  uint32_t ulParameter2 )
+{
+WorkQueueItem_t *pxItem;
+uint32_t ulPosition;
+int32_t lDifference;
+BaseType_t xReturn = pdFAIL;
+
+	for( ;; )
+	{
+		ulPosition = pxWorkQueue->ulEnqueuePosition;
+		pxItem = &( pxWorkQueue->pxItems[ ulPosition & pxWorkQueue->ulMask ] );
+		lDifference = ( int32_t ) ( pxItem->ulSequence - ulPosition );
+
+		if( lDifference == 0 )
+		{
+			/* The slot is free, try to claim it.  If another producer (most
+			likely a nested interrupt) claimed it first then go around again. */
+			if( Atomic_CompareAndSwap_u32( &( pxWorkQueue->ulEnqueuePosition ), ulPosition + 1U, ulPosition ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+			{
+				xReturn = pdPASS;
+				break;
+			}
+		}
+		else if( lDifference < 0 )
+		{
+			/* The slot still holds an item from the previous lap: full. */
+			break;
+		}
+		else
+		{
+			/* Another producer advanced the position, reload it. */
+		}
+	}
+
+	if( xReturn != pdFAIL )
+	{
+		pxItem->pxFunction = xFunctionToDefer;
+		pxItem->pvParameter1 = pvParameter1;
+		pxItem->ulParameter2 = ulParameter2;
+
+		/* Publish the item to the workers. */
+		pxItem->ulSequence = ulPosition + 1U;
+
+		( void ) Atomic_Increment_u32( &( pxWorkQueue->ulSubmitted ) );
+	}
+	else
+	{
+		( void ) Atomic_Increment_u32( &( pxWorkQueue->ulOverflows ) );
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvDequeue( WorkQueue_t * const pxWorkQueue, WorkQueueItem_t *pxItem )
+{
+WorkQueueItem_t *pxSlot;
+uint32_t ulPosition;
+int32_t lDifference;
+BaseType_t xReturn = pdFALSE;
+
+	for( ;; )
+	{
+		ulPosition = pxWorkQueue->ulDequeuePosition;
+		pxSlot = &( pxWorkQueue->pxItems[ ulPosition & pxWorkQueue->ulMask ] );
+		lDifference = ( int32_t ) ( pxSlot->ulSequence - ( ulPosition + 1U ) );
+
+		if( lDifference == 0 )
+		{
+			if( Atomic_CompareAndSwap_u32( &( pxWorkQueue->ulDequeuePosition ), ulPosition + 1U, ulPosition ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+			{
+				xReturn = pdTRUE;
+				break;
+			}
+		}
+		else if( lDifference < 0 )
+		{
+			/* Empty, or the producer that claimed this slot has not yet
+			published it.  In the latter case the producer will wake a worker
+			once it has done so. */
+			break;
+		}
+		else
+		{
+			/* Another worker took the item, reload the position. */
+		}
+	}
+
+	if( xReturn != pdFALSE )
+	{
+		pxItem->pxFunction = pxSlot->pxFunction;
+		pxItem->pvParameter1 = pxSlot->pvParameter1;
+		pxItem->ulParameter2 = pxSlot->ulParameter2;
+
+		/* Hand the slot back to the producers for the next lap. */
+		pxSlot->ulSequence = ulPosition + pxWorkQueue->ulMask + 1U;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWakeWorker( WorkQueue_t * const pxWorkQueue, BaseType_t xFromISR, BaseType_t *pxHigherPriorityTaskWoken )
+{
+uint32_t ulIdleWorkers;
+UBaseType_t uxWorker;
+
+	/* Only the submission that moves ulWakeUpPending from 0 to 1 notifies a
+	worker.  The worker clears the flag before it starts to empty the ring, so
+	anything submitted while the flag is set is guaranteed to be seen by the
+	worker that was already notified. */
+	if( Atomic_CompareAndSwap_u32( &( pxWorkQueue->ulWakeUpPending ), 1U, 0U ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+	{
+		ulIdleWorkers = pxWorkQueue->ulIdleWorkers;
+
+		if( ulIdleWorkers != 0U )
+		{
+			/* Prefer the lowest numbered idle worker. */
+			for( uxWorker = 0U; ( ulIdleWorkers & ( ( uint32_t ) 1U << uxWorker ) ) == 0U; uxWorker++ )
+			{
+				/* Just searching for the first set bit. */
+			}
+		}
+		else
+		{
+			/* Every worker is busy.  Any of them will do, as the notification
+			is latched and makes the worker go round its loop once more. */
+			uxWorker = pxWorkQueue->uxNextWorker;
+			pxWorkQueue->uxNextWorker = ( uxWorker + 1U ) % pxWorkQueue->uxNumberOfWorkers;
+		}
+
+		( void ) Atomic_Increment_u32( &( pxWorkQueue->ulWakeUps ) );
+
+		if( xFromISR != pdFALSE )
+		{
+			vTaskNotifyGiveFromISR( pxWorkQueue->pxWorkers[ uxWorker ].xTask, pxHigherPriorityTaskWoken );
+		}
+		else
+		{
+			( void ) xTaskNotifyGive( pxWorkQueue->pxWorkers[ uxWorker ].xTask );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static portTASK_FUNCTION( prvWorkQueueTask, pvParameters )
+{
+WorkQueueWorker_t * const pxWorker = ( WorkQueueWorker_t * ) pvParameters;
+WorkQueue_t * const pxWorkQueue = pxWorker->pxWorkQueue;
+WorkQueueItem_t xItem;
+
+	for( ;; )
+	{
+		( void ) Atomic_OR_u32( &( pxWorkQueue->ulIdleWorkers ), pxWorker->ulIdleBit );
+		( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+		( void ) Atomic_AND_u32( &( pxWorkQueue->ulIdleWorkers ), ~( pxWorker->ulIdleBit ) );
+
+		/* From here on any new submission generates a fresh notification.
+		Everything submitted before this point is drained by the loop below. */
+		pxWorkQueue->ulWakeUpPending = 0U;
+
+		while( prvDequeue( pxWorkQueue, &xItem ) != pdFALSE )
+		{
+			/* If more work is waiting and a peer is idle then let the peer
+			share the backlog while this worker executes the item. */
+			if( ( pxWorkQueue->ulIdleWorkers != 0U ) &&
+				( pxWorkQueue->ulDequeuePosition != pxWorkQueue->ulEnqueuePosition ) )
+			{
+				prvWakeWorker( pxWorkQueue, pdFALSE, NULL );
+			}
+
+			xItem.pxFunction( xItem.pvParameter1, xItem.ulParameter2 );
+			( void ) Atomic_Increment_u32( &( pxWorkQueue->ulExecuted ) );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+/* This entire source file will be skipped if the application is not configured
+to include work queue functionality.  If you want to include work queues then
+ensure configUSE_WORK_QUEUES is set to 1 in FreeRTOSConfig.h. */
+#endif /* configUSE_WORK_QUEUES == 1 */
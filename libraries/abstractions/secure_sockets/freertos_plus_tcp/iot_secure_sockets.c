@@ -245,6 +245,62 @@ int32_t SOCKETS_Recv( Socket_t xSocket,
 }
 /*-----------------------------------------------------------*/
 
+#if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 )
+
+    int32_t SOCKETS_RecvZeroCopy( Socket_t xSocket,
+                                  SocketsRegions_t * pxRegions,
+                                  uint32_t ulFlags )
+    {
+        int32_t lStatus = SOCKETS_SOCKET_ERROR;
+        SSOCKETContextPtr_t pxContext = ( SSOCKETContextPtr_t ) xSocket; /*lint !e9087 cast used for portability. */
+        StreamRegions_t xRegions;
+
+        if( ( xSocket != SOCKETS_INVALID_SOCKET ) &&
+            ( pxRegions != NULL ) &&
+            ( pdTRUE != pxContext->xRequireTLS ) )
+        {
+            pxContext->xRecvFlags = ( BaseType_t ) ulFlags;
+
+            /* The data are read in place from the receive stream of the
+             * socket. */
+            lStatus = FreeRTOS_recv_regions( pxContext->xSocket, &xRegions, pxContext->xRecvFlags );
+
+            pxRegions->pucFirst = xRegions.pucFirst;
+            pxRegions->xFirstLength = xRegions.uxFirstLength;
+            pxRegions->pucSecond = xRegions.pucSecond;
+            pxRegions->xSecondLength = xRegions.uxSecondLength;
+        }
+        else
+        {
+            lStatus = SOCKETS_EINVAL;
+        }
+
+        return lStatus;
+    }
+/*-----------------------------------------------------------*/
+
+    int32_t SOCKETS_RecvRelease( Socket_t xSocket,
+                                 size_t xLength )
+    {
+        int32_t lStatus = SOCKETS_SOCKET_ERROR;
+        SSOCKETContextPtr_t pxContext = ( SSOCKETContextPtr_t ) xSocket; /*lint !e9087 cast used for portability. */
+
+        if( ( xSocket != SOCKETS_INVALID_SOCKET ) &&
+            ( pdTRUE != pxContext->xRequireTLS ) )
+        {
+            lStatus = FreeRTOS_recv_consume( pxContext->xSocket, xLength );
+        }
+        else
+        {
+            lStatus = SOCKETS_EINVAL;
+        }
+
+        return lStatus;
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 ) */
+
 int32_t SOCKETS_Send( Socket_t xSocket,
                       const void * pvBuffer,
                       size_t xDataLength,
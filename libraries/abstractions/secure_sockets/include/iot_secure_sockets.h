@@ -316,6 +316,64 @@ int32_t SOCKETS_Recv( Socket_t xSocket,
                       uint32_t ulFlags );
 /* @[declare_secure_sockets_recv] */
 
+#if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 )
+
+/**
+ * @ingroup SecureSockets_datatypes_paramstructs
+ * @brief Received data that is still stored in the socket.
+ *
+ * The data lie in at most two regions, because the receive buffer of the
+ * socket is circular.  The second region follows the first one.
+ */
+    typedef struct SocketsRegions
+    {
+        uint8_t * pucFirst;    /**< The first region. */
+        size_t xFirstLength;   /**< The number of bytes in the first region. */
+        uint8_t * pucSecond;   /**< The second region, NULL when it is not used. */
+        size_t xSecondLength;  /**< The number of bytes in the second region. */
+    } SocketsRegions_t;
+
+/**
+ * @brief Receive data from a TCP socket without copying it.
+ *
+ * Waits for data in the same way as SOCKETS_Recv().  The data stay in the
+ * socket until they are released with SOCKETS_RecvRelease(), so a parser can
+ * read them in place and release them when it is done.  Only available for
+ * sockets that do not use TLS: the TLS layer decrypts into its own buffer.
+ *
+ * @param[in] xSocket The handle of the socket from which data is being received.
+ * @param[out] pxRegions Receives the location of the data.
+ * @param[in] ulFlags Not currently used. Should be set to 0.
+ *
+ * @return
+ * * The number of bytes in both regions.
+ * * If a timeout occurred before data could be received then 0 is returned.
+ * * If an error occurred, a negative value is returned. @ref SocketsErrors
+ */
+/* @[declare_secure_sockets_recvzerocopy] */
+    int32_t SOCKETS_RecvZeroCopy( Socket_t xSocket,
+                                  SocketsRegions_t * pxRegions,
+                                  uint32_t ulFlags );
+/* @[declare_secure_sockets_recvzerocopy] */
+
+/**
+ * @brief Release data obtained with SOCKETS_RecvZeroCopy().
+ *
+ * @param[in] xSocket The handle of the socket from which data was received.
+ * @param[in] xLength The number of bytes to release, counted from the start of
+ * the first region.
+ *
+ * @return
+ * * The number of bytes released.
+ * * If an error occurred, a negative value is returned. @ref SocketsErrors
+ */
+/* @[declare_secure_sockets_recvrelease] */
+    int32_t SOCKETS_RecvRelease( Socket_t xSocket,
+                                 size_t xLength );
+/* @[declare_secure_sockets_recvrelease] */
+
+#endif /* if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 ) */
+
 /**
  * @brief Transmit data to the remote socket.
  *
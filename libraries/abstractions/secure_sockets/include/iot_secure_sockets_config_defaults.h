@@ -61,6 +61,17 @@
     #define socketsconfigDEFAULT_RECV_TIMEOUT    ( 10000 )
 #endif
 
+/**
+ * @brief By default, the zero-copy receive API is disabled.
+ *
+ * SOCKETS_RecvZeroCopy() and SOCKETS_RecvRelease() are only implemented by
+ * ports whose TCP/IP stack keeps the received data in a buffer of the socket,
+ * such as FreeRTOS+TCP.
+ */
+#ifndef socketsconfigENABLE_ZERO_COPY_RECV
+    #define socketsconfigENABLE_ZERO_COPY_RECV    ( 0 )
+#endif
+
 /**
  * @brief By default, metrics of secure socket is disabled.
  *
@@ -787,6 +787,10 @@ TEST_GROUP_RUNNER( Full_TCP )
     RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_htons_HappyCase );
     RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_inet_addr_quick_HappyCase );
 
+    #if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 )
+        RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_RecvZeroCopy );
+    #endif
+
     #if ( tcptestSECURE_SERVER == 1 )
         RUN_TEST_CASE( Full_TCP, AFQP_SECURE_SOCKETS_CloseInvalidParams );
         RUN_TEST_CASE( Full_TCP, AFQP_SECURE_SOCKETS_CloseWithoutReceiving );
@@ -1564,6 +1568,72 @@ TEST( Full_TCP, AFQP_SECURE_SOCKETS_Recv_ByteByByte )
 
 /*-----------------------------------------------------------*/
 
+#if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 )
+
+    TEST( Full_TCP, AFQP_SOCKETS_RecvZeroCopy )
+    {
+        BaseType_t xResult = pdFAIL;
+        int32_t lReceived;
+        size_t xBytesReceived = 0;
+        size_t xMessageLength = tcptestBUFFER_SIZE / 2;
+        uint8_t * pucTxBuffer = ( uint8_t * ) pcTxBuffer;
+        uint8_t * pucRxBuffer = ( uint8_t * ) pcRxBuffer;
+        SocketsRegions_t xRegions;
+
+        tcptestPRINTF( ( "Starting %s.\r\n", __FUNCTION__ ) );
+
+        xResult = prvConnectHelperWithRetry( &xSocket, eNonsecure, xReceiveTimeOut, xSendTimeOut, &xSocketOpen );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Failed to connect" );
+
+        prvCreateTxData( ( char * ) pucTxBuffer, xMessageLength, 0 );
+        memset( pucRxBuffer, tcptestRX_BUFFER_FILLER, tcptestBUFFER_SIZE );
+        xResult = prvSendHelper( xSocket, pucTxBuffer, xMessageLength );
+
+        while( ( xResult == pdPASS ) && ( xBytesReceived < xMessageLength ) )
+        {
+            lReceived = SOCKETS_RecvZeroCopy( xSocket, &xRegions, 0 );
+
+            if( ( lReceived <= 0 ) ||
+                ( ( size_t ) lReceived != ( xRegions.xFirstLength + xRegions.xSecondLength ) ) ||
+                ( xBytesReceived + ( size_t ) lReceived > xMessageLength ) )
+            {
+                tcptestFAILUREPRINTF( ( "Error %d while receiving from echo server\r\n", lReceived ) );
+                xResult = pdFAIL;
+                break;
+            }
+
+            /* The data are only copied to compare them. */
+            memcpy( &pucRxBuffer[ xBytesReceived ], xRegions.pucFirst, xRegions.xFirstLength );
+
+            if( xRegions.xSecondLength != 0 )
+            {
+                memcpy( &pucRxBuffer[ xBytesReceived + xRegions.xFirstLength ], xRegions.pucSecond, xRegions.xSecondLength );
+            }
+
+            if( SOCKETS_RecvRelease( xSocket, ( size_t ) lReceived ) != lReceived )
+            {
+                xResult = pdFAIL;
+                break;
+            }
+
+            xBytesReceived += ( size_t ) lReceived;
+        }
+
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( pdPASS, xResult, "Failed received" );
+        xResult = prvCheckRxTxBuffers( pucTxBuffer, pucRxBuffer, xMessageLength );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( pdPASS, xResult, "Received data differs" );
+
+        xResult = prvShutdownHelper( xSocket );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket failed to shutdown" );
+
+        xResult = prvCloseHelper( xSocket, &xSocketOpen );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket failed to close" );
+    }
+
+#endif /* if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 ) */
+
+/*-----------------------------------------------------------*/
+
 static void prvSOCKETS_SendRecv_VaryLength( Server_t xConn )
 {
     BaseType_t xResult;
@@ -148,6 +148,65 @@ from the FreeRTOSIPConfig.h configuration header file. */
 		TCP packets which are unknown, or out-of-order. */
 		#define ipconfigIGNORE_UNKNOWN_PACKETS	( 0 )
 	#endif
+
+	#ifndef ipconfigTCP_HASH_TABLE_SIZE
+		/* The number of buckets in the tables that are used to find the TCP
+		socket of a received packet, must be a power of 2.  Set to 0 to search
+		the list of bound sockets instead, which uses less RAM. */
+		#define ipconfigTCP_HASH_TABLE_SIZE		( 16 )
+	#endif
+
+	#ifndef ipconfigUSE_TCP_CONGESTION_CONTROL
+		/* When non-zero, the amount of unacknowledged TCP data is also limited
+		by a congestion window, which grows during slow start and congestion
+		avoidance and which shrinks after a loss.  Three duplicate ACKs will
+		cause a fast retransmission.  See FreeRTOS_TCP_CC.c. */
+		#define ipconfigUSE_TCP_CONGESTION_CONTROL	( 0 )
+	#endif
+
+	#ifndef ipconfigTCP_CONGESTION_DEFAULT
+		/* The congestion control algorithm of sockets that didn't choose one
+		with the FREERTOS_SO_TCP_CONGESTION option: either
+		xTCPCongestionNewReno or xTCPCongestionCubic. */
+		#define ipconfigTCP_CONGESTION_DEFAULT	xTCPCongestionNewReno
+	#endif
+
+	#ifndef ipconfigTCP_INITIAL_CWND_SEGMENTS
+		/* The size of the congestion window at the start of a connection, in
+		units of MSS. */
+		#define ipconfigTCP_INITIAL_CWND_SEGMENTS	( 4 )
+	#endif
+
+	#if( ( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 ) && ( ipconfigUSE_TCP_WIN == 0 ) )
+		#error ipconfigUSE_TCP_CONGESTION_CONTROL can only be used with ipconfigUSE_TCP_WIN
+	#endif
+
+	#ifndef ipconfigUSE_TCP_TIMESTAMPS
+		/* When non-zero, the TCP time-stamp option (RFC 7323) is offered in
+		the SYN phase.  If the peer accepts it, every segment carries a
+		time-stamp, which costs 12 bytes of payload per packet, and the round
+		trip time is measured with every ACK that confirms new data, also for
+		retransmitted segments. */
+		#define ipconfigUSE_TCP_TIMESTAMPS		( 0 )
+	#endif
+
+	#if( ( ipconfigUSE_TCP_TIMESTAMPS != 0 ) && ( ipconfigUSE_TCP_WIN == 0 ) )
+		#error ipconfigUSE_TCP_TIMESTAMPS can only be used with ipconfigUSE_TCP_WIN
+	#endif
+
+	#ifndef ipconfigTCP_RTO_MIN_MS
+		/* The lower limit of the retransmission time-out, which is calculated
+		from the measured round trip times as described in RFC 6298.  A value
+		well below the delayed-ACK time of the peers would cause spurious
+		retransmissions. */
+		#define ipconfigTCP_RTO_MIN_MS			( 200 )
+	#endif
+
+	#ifndef ipconfigTCP_RTO_MAX_MS
+		/* The upper limit of the retransmission time-out, also after it has
+		been doubled for repeated retransmissions of a segment. */
+		#define ipconfigTCP_RTO_MAX_MS			( 60000 )
+	#endif
 #endif
 
 /*
@@ -289,6 +348,23 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define	ipconfigUSE_ARP_REMOVE_ENTRY		0
 #endif
 
+#ifndef ipconfigARP_HASH_TABLE_SIZE
+	/* When non-zero the ARP cache is indexed by a hash table with this number
+	of buckets, which must be a power of 2, and the least recently used entry
+	is replaced when the cache is full.  Worthwhile when ipconfigARP_CACHE_ENTRIES
+	is large.  When zero the cache is searched linearly and the entry with the
+	lowest age is replaced. */
+	#define ipconfigARP_HASH_TABLE_SIZE		0
+#endif
+
+#ifndef ipconfigARP_QUEUE_LENGTH
+	/* The maximum number of outgoing UDP and ICMP packets that an ARP cache
+	entry holds while it waits for an ARP reply.  They are sent as soon as the
+	reply arrives, and released when the entry expires.  When zero such a
+	packet is turned into the ARP request, and so it is lost. */
+	#define ipconfigARP_QUEUE_LENGTH		2
+#endif
+
 #ifndef ipconfigINCLUDE_FULL_INET_ADDR
 	#define ipconfigINCLUDE_FULL_INET_ADDR	1
 #endif
@@ -297,6 +373,27 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS		45
 #endif
 
+/* The following three options are only used by BufferAllocation_3.c.  That
+allocator gives ipconfigBUFFER_ALLOC_SMALL_COUNT of the network buffers a
+storage of only ipconfigBUFFER_ALLOC_SMALL_SIZE bytes, which is enough for ARP
+packets, TCP packets without data, and other short frames.  The remaining
+buffers can hold a frame of ipTOTAL_ETHERNET_FRAME_SIZE bytes.  A longer frame
+is stored in memory from pvPortMalloc(). */
+#ifndef ipconfigBUFFER_ALLOC_SMALL_COUNT
+	#define ipconfigBUFFER_ALLOC_SMALL_COUNT	( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS / 4 )
+#endif
+
+#ifndef ipconfigBUFFER_ALLOC_SMALL_SIZE
+	#define ipconfigBUFFER_ALLOC_SMALL_SIZE		128
+#endif
+
+#ifndef ipconfigBUFFER_ALLOC_CACHE_SIZE
+	/* The number of free buffers of each size that BufferAllocation_3.c keeps
+	aside for the IP-task, which can take and return them without any atomic
+	operation.  Zero disables this cache. */
+	#define ipconfigBUFFER_ALLOC_CACHE_SIZE		4
+#endif
+
 #ifndef ipconfigEVENT_QUEUE_LENGTH
 	#define ipconfigEVENT_QUEUE_LENGTH		( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS + 5 )
 #endif
@@ -321,6 +418,21 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define ipconfigUDP_MAX_RX_PACKETS		0u
 #endif
 
+#ifndef ipconfigUDP_HASH_TABLE_SIZE
+	/* The number of buckets in the table that is used to find the UDP socket
+	bound to a port, must be a power of 2.  Set to 0 to search the list of bound
+	sockets instead, which uses less RAM. */
+	#define ipconfigUDP_HASH_TABLE_SIZE		( 16 )
+#endif
+
+#ifndef ipconfigUSE_UDP_BATCH
+	/* When set to 1, FreeRTOS_sendmmsg() and FreeRTOS_recvmmsg() send or
+	receive a number of UDP datagrams in a single call.  The datagrams that are
+	sent are passed to the IP-task with a single message, the datagrams that
+	are received are taken from the socket with a single critical section. */
+	#define ipconfigUSE_UDP_BATCH			0
+#endif
+
 #ifndef ipconfigUSE_DHCP
 	#define ipconfigUSE_DHCP				1
 #endif
@@ -383,6 +495,20 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define ipconfigDNS_REQUEST_ATTEMPTS		5
 #endif
 
+#ifndef ipconfigDNS_MAX_SERVERS
+	/* The number of DNS servers that are remembered.  A request that is not
+	answered is sent again to the next server.  The first server is the one
+	passed to FreeRTOS_IPInit(), the others can be set with
+	FreeRTOS_SetDNSServerAddressAt(), or are provided by the DHCP server. */
+	#define ipconfigDNS_MAX_SERVERS				2
+#endif
+
+#ifndef ipconfigDNS_RETRY_INTERVAL_MS
+	/* When ipconfigDNS_USE_CALLBACKS is used, a request that has not been
+	answered within this time is sent again, to the next DNS server. */
+	#define ipconfigDNS_RETRY_INTERVAL_MS		500
+#endif
+
 #ifndef ipconfigUSE_DNS_CACHE
 	#define ipconfigUSE_DNS_CACHE				0
 #endif
@@ -397,12 +523,48 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#ifndef ipconfigDNS_CACHE_ENTRIES
 		#define ipconfigDNS_CACHE_ENTRIES			1
 	#endif
+
+	#ifndef ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY
+		/* The number of IPv4 addresses that are remembered for each name.
+		When a name has more than one A record, the addresses are returned in
+		turn (round-robin). */
+		#define ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY	1
+	#endif
+
+	#ifndef ipconfigDNS_CACHE_HASH_TABLE_SIZE
+		/* When non-zero, the cache entries are found through a hash table
+		with this number of buckets, which must be a power of 2.  Worthwhile
+		when ipconfigDNS_CACHE_ENTRIES is large. */
+		#define ipconfigDNS_CACHE_HASH_TABLE_SIZE	0
+	#endif
+
+	#ifndef ipconfigDNS_CACHE_NEGATIVE_TTL
+		/* The number of seconds that a name is remembered as not existing,
+		after a DNS server answered that it has no IPv4 address.  During that
+		time FreeRTOS_gethostbyname() returns 0 without asking again.  Set to 0
+		to disable negative caching. */
+		#define ipconfigDNS_CACHE_NEGATIVE_TTL		30
+	#endif
+
+	#ifndef ipconfigDNS_CACHE_PREFETCH
+		/* When non-zero, a look-up that finds an entry which is in the last
+		eighth of its TTL returns the cached address, and sends a new request
+		to refresh the entry before it expires. */
+		#define ipconfigDNS_CACHE_PREFETCH			1
+	#endif
 #endif /* ipconfigUSE_DNS_CACHE != 0 */
 
 #ifndef ipconfigCHECK_IP_QUEUE_SPACE
 	#define ipconfigCHECK_IP_QUEUE_SPACE			0
 #endif
 
+/* When ipconfigUSE_MIB_COUNTERS is non-zero, the stack keeps counters of the
+packets received and sent per protocol, and of the packets that were dropped,
+per reason.  They can be read with FreeRTOS_GetMIBCounters(). */
+#ifndef ipconfigUSE_MIB_COUNTERS
+	#define ipconfigUSE_MIB_COUNTERS				0
+#endif
+
 #ifndef ipconfigUSE_LLMNR
 	/* Include support for LLMNR: Link-local Multicast Name Resolution (non-Microsoft) */
 	#define ipconfigUSE_LLMNR					( 0 )
@@ -487,6 +649,14 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define ipconfigZERO_COPY_RX_DRIVER		( 0 )
 #endif
 
+#ifndef ipconfigUSE_LINKED_RX_MESSAGES
+	/* When set to 1, a driver may link received frames through their
+	'pxNextBuffer' field and pass the whole chain to the IP-task with a single
+	call to xSendNetworkBuffersToIPTask().  Under a high packet rate this saves
+	one queue message, and possibly one task switch, per frame. */
+	#define ipconfigUSE_LINKED_RX_MESSAGES	0
+#endif
+
 #ifndef ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM
 	#define ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM 0
 #endif
@@ -495,6 +665,116 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM 0
 #endif
 
+#ifndef ipconfigUSE_DRIVER_OFFLOADS
+	/* When non-zero, a driver can advertise at run-time which work its
+	hardware does, see the ipOFFLOAD_ flags in NetworkInterface.h.  The stack
+	then leaves out checksums that the driver sets or checks, and passes TCP
+	frames longer than the MTU to a driver that cuts them into segments.  The
+	driver-included checksum options above still apply to all frames. */
+	#define ipconfigUSE_DRIVER_OFFLOADS 0
+#endif
+
+#ifndef ipconfigUSE_NETWORK_BUFFER_CHAINS
+	/* When non-zero, network buffers are reference counted, and an outgoing
+	frame may consist of a buffer with the headers to which the payload of
+	another buffer is chained, see vNetworkBufferChainPayload().  A driver that
+	advertises ipOFFLOAD_TX_GATHER then gets TCP segments of which the payload
+	is not copied, and FreeRTOS_send_buffer() sends the data of a network
+	buffer of the application.  Needs ipconfigUSE_DRIVER_OFFLOADS. */
+	#define ipconfigUSE_NETWORK_BUFFER_CHAINS 0
+#endif
+
+#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 ) && ( ipconfigUSE_DRIVER_OFFLOADS == 0 )
+	#error ipconfigUSE_NETWORK_BUFFER_CHAINS needs ipconfigUSE_DRIVER_OFFLOADS
+#endif
+
+#ifndef ipconfigUSE_CHECKSUM_KERNELS
+	/* When non-zero, the Internet checksum is calculated by FreeRTOS_Checksum.c,
+	which uses the vector instructions of the target when the compiler offers
+	them.  The payload of a UDP packet is then also summed while it is copied
+	into the network buffer. */
+	#define ipconfigUSE_CHECKSUM_KERNELS 0
+#endif
+
+#ifndef ipconfigUSE_IP_REASSEMBLY
+	/* When non-zero, incoming IPv4 datagrams that were fragmented are
+	reassembled, see FreeRTOS_Reassembly.c.  When zero, fragments are
+	dropped. */
+	#define ipconfigUSE_IP_REASSEMBLY 0
+#endif
+
+#ifndef ipconfigIP_REASSEMBLY_MAX_SIZE
+	/* The longest datagram, including its IP header, that can be reassembled.
+	Each datagram that is being reassembled holds a network buffer of this
+	size.  The default, ipconfigNETWORK_MTU, only covers datagrams that were
+	fragmented by a link with a smaller MTU: a longer datagram, such as a
+	large DNS response, is still dropped.  BufferAllocation_2.c and
+	BufferAllocation_3.c can provide buffers of up to 65535 bytes, so raise
+	it when they are used.  The buffers of BufferAllocation_1.c only hold
+	ipconfigNETWORK_MTU bytes: a larger value fails a configASSERT(), and
+	fragments are dropped. */
+	#define ipconfigIP_REASSEMBLY_MAX_SIZE ipconfigNETWORK_MTU
+#endif
+
+#ifndef ipconfigIP_REASSEMBLY_MAX_DATAGRAMS
+	/* The number of datagrams that can be reassembled at the same time, and
+	so the number of network buffers that reassembly can hold. */
+	#define ipconfigIP_REASSEMBLY_MAX_DATAGRAMS 2
+#endif
+
+#ifndef ipconfigIP_REASSEMBLY_TIMEOUT_MS
+	/* A datagram that is not complete this long after its first fragment
+	arrived is discarded. */
+	#define ipconfigIP_REASSEMBLY_TIMEOUT_MS 5000
+#endif
+
+#ifndef ipconfigUSE_PCAP_CAPTURE
+	/* When non-zero, the frames that are received and sent can be captured
+	into a ring buffer in RAM, and exported in the pcapng format, see
+	FreeRTOS_Capture.h. */
+	#define ipconfigUSE_PCAP_CAPTURE 0
+#endif
+
+#ifndef ipconfigPCAP_CAPTURE_BUFFER_SIZE
+	/* The size in bytes of the capture ring buffer, a multiple of 4.  Every
+	frame takes 44 bytes plus its captured length, rounded up to 4.  When the
+	buffer is full, the oldest frames are overwritten. */
+	#define ipconfigPCAP_CAPTURE_BUFFER_SIZE 16384
+#endif
+
+#if( ( ipconfigPCAP_CAPTURE_BUFFER_SIZE % 4 ) != 0 )
+	#error ipconfigPCAP_CAPTURE_BUFFER_SIZE must be a multiple of 4
+#endif
+
+#ifndef ipconfigPCAP_TIME_US
+	/* The time-stamp of a captured frame, in micro-seconds.  Define it to read a
+	hardware timer when the resolution of the tick count is not good enough. */
+	#define ipconfigPCAP_TIME_US()	( ( uint64_t ) xTaskGetTickCount() * ( uint64_t ) portTICK_PERIOD_MS * 1000ULL )
+#endif
+
+#ifndef ipconfigUSE_IPv6
+	/* When non-zero, the stack also speaks IPv6 on the primary end-point, see
+	FreeRTOS_IPv6.c.  It configures a link-local address and, when a router
+	advertises a prefix, a global address (SLAAC), answers neighbour
+	solicitations and pings, and lets UDP sockets send to and receive from
+	IPv6 addresses.  TCP and DNS remain IPv4 only: there are no AAAA queries,
+	so a network that only offers IPv6 or NAT64 still needs IPv4. */
+	#define ipconfigUSE_IPv6 0
+#endif
+
+#ifndef ipconfigND_CACHE_ENTRIES
+	/* The number of IPv6 neighbours of which the MAC address is remembered. */
+	#define ipconfigND_CACHE_ENTRIES 6
+#endif
+
+#ifndef ipconfigMAX_ND_AGE
+	/* The number of seconds that an entry stays in the neighbour cache without
+	being refreshed by incoming traffic.  Shortly before it expires, a
+	neighbour solicitation is sent to confirm that the neighbour is still
+	there. */
+	#define ipconfigMAX_ND_AGE 300
+#endif
+
 #ifndef ipconfigDHCP_REGISTER_HOSTNAME
 	#define ipconfigDHCP_REGISTER_HOSTNAME 0
 #endif
@@ -511,10 +791,95 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define ipconfigSUPPORT_SELECT_FUNCTION 0
 #endif
 
+#ifndef ipconfigSUPPORT_SELECT_READY_LIST
+	/* When set to 1, every socket set keeps a list of the sockets that had an
+	event since FreeRTOS_select_ready() was last called.  That function
+	returns the sockets with their events, so a task that serves many sockets
+	does not need to call FreeRTOS_FD_ISSET() for each of them.  Each socket
+	grows by one list item.  Needs ipconfigSUPPORT_SELECT_FUNCTION. */
+	#define ipconfigSUPPORT_SELECT_READY_LIST 0
+#endif
+
+#if( ipconfigSUPPORT_SELECT_READY_LIST == 1 ) && ( ipconfigSUPPORT_SELECT_FUNCTION != 1 )
+	#error ipconfigSUPPORT_SELECT_READY_LIST needs ipconfigSUPPORT_SELECT_FUNCTION
+#endif
+
 #ifndef ipconfigTCP_KEEP_ALIVE
 	#define ipconfigTCP_KEEP_ALIVE 0
 #endif
 
+/* The policy for acknowledging received TCP data, which only applies when
+ipconfigUSE_TCP_WIN is 1.  By default an ACK is postponed as long as full-size
+segments keep coming in, until the delayed-ACK timer expires or the reception
+buffer runs short.  When ipconfigTCP_ACK_EVERY_N_SEGMENTS is non-zero, an ACK is
+sent at least for every N data segments received. */
+#ifndef ipconfigTCP_ACK_EVERY_N_SEGMENTS
+	#define ipconfigTCP_ACK_EVERY_N_SEGMENTS	0
+#endif
+
+/* When ipconfigTCP_QUICKACK_IDLE_MS is non-zero, and no data was received for
+that many ms, the next ipconfigTCP_QUICKACK_SEGMENTS data segments are
+acknowledged immediately.  A peer that starts sending again after an idle period
+has a small congestion window, which grows with every ACK it receives. */
+#ifndef ipconfigTCP_QUICKACK_IDLE_MS
+	#define ipconfigTCP_QUICKACK_IDLE_MS		0
+#endif
+
+#ifndef ipconfigTCP_QUICKACK_SEGMENTS
+	#define ipconfigTCP_QUICKACK_SEGMENTS		8
+#endif
+
+#if( ipconfigTCP_QUICKACK_SEGMENTS > 255 )
+	#error ipconfigTCP_QUICKACK_SEGMENTS must fit in a uint8_t
+#endif
+
+#if( ipconfigTCP_ACK_EVERY_N_SEGMENTS > 255 )
+	#error ipconfigTCP_ACK_EVERY_N_SEGMENTS must fit in a uint8_t
+#endif
+
+/* When ipconfigTCP_RX_COALESCE_BYTES is non-zero, a task reading from a TCP
+socket is not woken up for every full-size segment that arrives in order.  It
+is woken up when at least this many bytes are available (at most half of the
+reception buffer), when a segment is short or has the PSH flag, or when the
+delayed-ACK timer expires.  Sockets with an OnReceive handler are not affected. */
+#ifndef ipconfigTCP_RX_COALESCE_BYTES
+	#define ipconfigTCP_RX_COALESCE_BYTES		0
+#endif
+
+/* When ipconfigTCP_SYN_CACHE_SIZE is non-zero, a listening socket that does not
+have the FREERTOS_SO_REUSE_LISTEN_SOCKET option answers a SYN without creating a
+socket.  The connection request is stored in a compact cache of this many
+entries, and the socket is created when the final ACK of the handshake arrives.
+When the cache is full, the oldest entry is dropped. */
+#ifndef ipconfigTCP_SYN_CACHE_SIZE
+	#define ipconfigTCP_SYN_CACHE_SIZE			0
+#endif
+
+/* The time after which an unanswered entry of the SYN cache may be reused.  The
+peer will repeat its SYN in the mean time, which gets the same answer. */
+#ifndef ipconfigTCP_SYN_CACHE_TIMEOUT_MS
+	#define ipconfigTCP_SYN_CACHE_TIMEOUT_MS	20000
+#endif
+
+/* When ipconfigTCP_SYN_COOKIES is non-zero and the SYN cache is full, a SYN is
+answered with a SYN cookie: the state of the connection request is encoded in
+the initial sequence number, so nothing needs to be stored.  A connection that
+is opened by a cookie does not use window scaling or time-stamps. */
+#ifndef ipconfigTCP_SYN_COOKIES
+	#define ipconfigTCP_SYN_COOKIES				0
+#endif
+
+#if( ipconfigTCP_SYN_COOKIES != 0 ) && ( ipconfigTCP_SYN_CACHE_SIZE == 0 )
+	#error ipconfigTCP_SYN_COOKIES needs ipconfigTCP_SYN_CACHE_SIZE
+#endif
+
+/* When ipconfigUSE_TCP_INFO is non-zero, every TCP connection counts its
+segments, retransmissions and duplicate ACKs, and FreeRTOS_GetTCPInfo() can be
+used to read those together with the round-trip time and the window sizes. */
+#ifndef ipconfigUSE_TCP_INFO
+	#define ipconfigUSE_TCP_INFO				0
+#endif
+
 #ifndef ipconfigDNS_USE_CALLBACKS
 	#define ipconfigDNS_USE_CALLBACKS 0
 #endif
@@ -557,4 +922,18 @@ connections, hang protection can help reduce the impact of SYN floods. */
 	#define ipconfigPACKET_FILLER_SIZE 2
 #endif
 
+#ifndef ipconfigUSE_MULTI_INTERFACE
+	/* When set to 1 the stack can be attached to more than one network
+	interface, each having one or more end-points (IP/MAC addresses).  See
+	FreeRTOS_Routing.h. */
+	#define ipconfigUSE_MULTI_INTERFACE 0
+#endif
+
+#ifndef ipconfigMAX_ROUTES
+	/* The number of entries in the routing table, only used when
+	ipconfigUSE_MULTI_INTERFACE is 1.  The subnet and gateway of each end-point
+	are routed implicitly and do not take a table entry. */
+	#define ipconfigMAX_ROUTES 8
+#endif
+
 #endif /* FREERTOS_DEFAULT_IP_CONFIG_H */
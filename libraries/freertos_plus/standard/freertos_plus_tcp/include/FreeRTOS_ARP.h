@@ -45,6 +45,16 @@ typedef struct xARP_CACHE_TABLE_ROW
 	MACAddress_t xMACAddress;  /* The MAC address of an ARP cache entry. */
 	uint8_t ucAge;				/* A value that is periodically decremented but can also be refreshed by active communication.  The ARP cache entry is removed if the value reaches zero. */
     uint8_t ucValid;			/* pdTRUE: xMACAddress is valid, pdFALSE: waiting for ARP reply */
+	#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+		struct xNetworkEndPoint *pxEndPoint;	/* The end-point through which the IP address is reached. */
+	#endif
+	#if( ipconfigARP_HASH_TABLE_SIZE > 0 )
+		ListItem_t xHashListItem;	/* Links the entry in the hash bucket of its IP address. */
+		ListItem_t xLRUListItem;	/* Links the entry in the list of used entries, least recently used first, or in the list of free entries. */
+	#endif
+	#if( ipconfigARP_QUEUE_LENGTH > 0 )
+		List_t xWaitingPackets;		/* Outgoing packets that wait for the ARP reply. */
+	#endif
 } ARPCacheRow_t;
 
 typedef enum
@@ -61,6 +71,11 @@ typedef enum
 	eFollowingFragment			/* The IP packet being sent is part of a set of fragmented packets. */
 } eIPFragmentStatus_t;
 
+/*
+ * Prepare the lists of the ARP cache.  Called once, before the IP-task starts.
+ */
+void vARPInitialiseCache( void );
+
 /*
  * If ulIPAddress is already in the ARP cache table then reset the age of the
  * entry back to its maximum value.  If ulIPAddress is not already in the ARP
@@ -96,12 +111,36 @@ void vARPRefreshCacheEntry( const MACAddress_t * pxMACAddress, const uint32_t ul
  */
 eARPLookupResult_t eARPGetCacheEntry( uint32_t *pulIPAddress, MACAddress_t * const pxMACAddress );
 
+#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+
+	/*
+	 * As eARPGetCacheEntry(), and also return the end-point through which
+	 * the IP address is reached.  The end-point is NULL when eCantSendPacket
+	 * is returned because there is no route.
+	 */
+	eARPLookupResult_t eARPGetCacheEntryOnEndPoint( uint32_t *pulIPAddress, MACAddress_t * const pxMACAddress, struct xNetworkEndPoint **ppxEndPoint );
+
+#endif /* ipconfigUSE_MULTI_INTERFACE */
+
 #if( ipconfigUSE_ARP_REVERSED_LOOKUP != 0 )
 
 	/* Lookup an IP-address if only the MAC-address is known */
 	eARPLookupResult_t eARPGetCacheEntryByMac( MACAddress_t * const pxMACAddress, uint32_t *pulIPAddress );
 
 #endif
+#if( ipconfigARP_QUEUE_LENGTH > 0 )
+
+	/*
+	 * Let the ARP cache entry of ulIPAddress hold pxNetworkBuffer until its ARP
+	 * reply arrives, after which the packet is passed to
+	 * vProcessGeneratedUDPPacket() again.  Returns pdFALSE when there is no
+	 * entry waiting for a reply, or when its queue is full, in which case the
+	 * caller still owns the buffer.
+	 */
+	BaseType_t xARPWaitForResolution( NetworkBufferDescriptor_t * const pxNetworkBuffer, uint32_t ulIPAddress );
+
+#endif /* ipconfigARP_QUEUE_LENGTH */
+
 /*
  * Reduce the age count in each entry within the ARP cache.  An entry is no
  * longer considered valid and is deleted if its age reaches zero.
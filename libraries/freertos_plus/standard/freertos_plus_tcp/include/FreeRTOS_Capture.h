@@ -0,0 +1,105 @@
+/*
+ * FreeRTOS+TCP V2.0.11
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+#ifndef FREERTOS_CAPTURE_H
+#define FREERTOS_CAPTURE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Application level configuration options. */
+#include "FreeRTOSIPConfig.h"
+#include "FreeRTOSIPConfigDefaults.h"
+
+/*
+ * When ipconfigUSE_PCAP_CAPTURE is set to 1 the stack can capture the Ethernet
+ * frames that it receives and sends, for debugging on devices where a wire
+ * capture is not possible.  Received frames are captured before they are
+ * processed, sent frames just before they are passed to
+ * xNetworkInterfaceOutput().
+ *
+ * Captured frames are stored as pcapng Enhanced Packet Blocks in a ring buffer
+ * of ipconfigPCAP_CAPTURE_BUFFER_SIZE bytes, so that exporting the capture
+ * does not need more memory.  When the ring is full, the oldest frames are
+ * overwritten.  A filter selects the frames that are captured, and only the
+ * first bytes of a frame may be stored.
+ *
+ * A capture is exported as a pcapng file that Wireshark can read, either over
+ * a TCP socket with FreeRTOS_CaptureSend(), or through a function of the
+ * application, e.g. one that writes to a file on the host of a simulator.
+ */
+
+#if( ipconfigUSE_PCAP_CAPTURE != 0 )
+
+	/* Selects the frames that are captured.  A field that is zero matches
+	any frame, the fields are in network byte order.  The address, protocol
+	and port fields only match IPv4 packets.  The address and port match both
+	the source and the destination. */
+	typedef struct xCAPTURE_FILTER
+	{
+		uint16_t usFrameType;		/* The Ethernet frame type, e.g. FreeRTOS_htons( 0x0806 ) for ARP. */
+		uint8_t ucProtocol;			/* The IPv4 protocol, e.g. 6 for TCP. */
+		uint32_t ulIPAddress;		/* An IPv4 address, as returned by FreeRTOS_inet_addr(). */
+		uint16_t usPort;			/* A TCP or UDP port number, e.g. FreeRTOS_htons( 80 ). */
+	} CaptureFilter_t;
+
+	/* Writes 'uxLength' bytes of the capture, returns pdFAIL to stop the
+	export. */
+	typedef BaseType_t ( * CaptureWriteFunction_t )( void *pvContext, const uint8_t *pucData, size_t uxLength );
+
+	/*
+	 * Clear the ring buffer and start capturing the frames that match
+	 * pxFilter, or all frames when pxFilter is NULL.  Of each frame at most
+	 * uxSnapLength bytes are stored, or all of it when uxSnapLength is 0.
+	 */
+	void FreeRTOS_CaptureStart( const CaptureFilter_t *pxFilter, size_t uxSnapLength );
+
+	/* Stop capturing, the frames in the ring buffer are kept. */
+	void FreeRTOS_CaptureStop( void );
+
+	/*
+	 * Export the capture in the pcapng format through pxWrite.  Capturing is
+	 * paused during the export.  Returns the number of bytes written, or a
+	 * negative errno when pxWrite failed.
+	 */
+	BaseType_t FreeRTOS_CaptureExport( CaptureWriteFunction_t pxWrite, void *pvContext );
+
+	#if( ipconfigUSE_TCP == 1 )
+		/* Export the capture over a connected TCP socket. */
+		BaseType_t FreeRTOS_CaptureSend( Socket_t xSocket );
+	#endif
+
+	/* Get the number of frames stored in the ring buffer, and the number of
+	frames that were overwritten or too long to store. */
+	void FreeRTOS_CaptureGetCounts( uint32_t *pulStored, uint32_t *pulLost );
+
+#endif /* ipconfigUSE_PCAP_CAPTURE */
+
+#ifdef __cplusplus
+}	/* extern "C" */
+#endif
+
+#endif /* FREERTOS_CAPTURE_H */
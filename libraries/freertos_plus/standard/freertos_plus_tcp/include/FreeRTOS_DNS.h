@@ -107,6 +107,30 @@ uint32_t ulDNSHandlePacket( NetworkBufferDescriptor_t *pxNetworkBuffer );
 	uint32_t FreeRTOS_gethostbyname_a( const char *pcHostName, FOnDNSEvent pCallback, void *pvSearchID, TickType_t xTimeout );
 	void FreeRTOS_gethostbyname_cancel( void *pvSearchID );
 
+	#if( configUSE_TASK_NOTIFICATIONS == 1 )
+
+		/*
+		 * Start looking up pcHostName without blocking.  When the look-up
+		 * has finished, the address is written to *pulIPAddress (0 when the
+		 * name could not be resolved within xTimeout ms) and ulNotifyBits are
+		 * set in the notification value of the calling task.  Give each of
+		 * several parallel look-ups its own bit, and wait for all of them with
+		 * xTaskNotifyWait().  pulIPAddress must remain valid until then, or
+		 * until it has been passed to FreeRTOS_gethostbyname_cancel().
+		 * Returns pdFAIL when the look-up could not be started.
+		 */
+		BaseType_t FreeRTOS_gethostbyname_notify( const char *pcHostName, uint32_t *pulIPAddress, uint32_t ulNotifyBits, TickType_t xTimeout );
+
+	#endif /* configUSE_TASK_NOTIFICATIONS */
+
+	/*
+	 * The asynchronous look-ups are sent by the IP-task, through a socket of
+	 * its own.  vDNSProcess() sends new requests, handles the replies and the
+	 * timeouts.
+	 */
+	void vDNSProcess( void );
+	BaseType_t xIsDNSSocket( Socket_t xSocket );
+
 #endif
 
 /*
@@ -38,6 +38,7 @@ extern "C" {
 /* Some constants defining the sizes of several parts of a packet */
 #define ipSIZE_OF_ETH_HEADER			14u
 #define ipSIZE_OF_IPv4_HEADER			20u
+#define ipSIZE_OF_IPv6_HEADER			40u
 #define ipSIZE_OF_IGMP_HEADER			8u
 #define ipSIZE_OF_ICMP_HEADER			8u
 #define ipSIZE_OF_UDP_HEADER			8u
@@ -47,6 +48,7 @@ extern "C" {
 /* The number of octets in the MAC and IP addresses respectively. */
 #define ipMAC_ADDRESS_LENGTH_BYTES ( 6 )
 #define ipIP_ADDRESS_LENGTH_BYTES ( 4 )
+#define ipSIZE_OF_IPv6_ADDRESS ( 16 )
 
 /* IP protocol definitions. */
 #define ipPROTOCOL_ICMP			( 1 )
@@ -83,6 +85,12 @@ buffer will have the following contents:
     #define ipBUFFER_PADDING    ( 8u + ipconfigPACKET_FILLER_SIZE )
 #endif
 
+/* An IPv6 address, in network order. */
+typedef struct xIPv6_ADDRESS
+{
+	uint8_t ucBytes[ ipSIZE_OF_IPv6_ADDRESS ];
+} IPv6_Address_t;
+
 /* The structure used to store buffers and pass them around the network stack.
 Buffers can be in use by the stack, in use by the network interface hardware
 driver, or free (not in use). */
@@ -94,9 +102,31 @@ typedef struct xNETWORK_BUFFER
 	size_t xDataLength; 			/* Starts by holding the total Ethernet frame length, then the UDP/TCP payload length. */
 	uint16_t usPort;				/* Source or destination port, depending on usage scenario. */
 	uint16_t usBoundPort;			/* The port to which a transmitting socket is bound. */
-	#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+	#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 ) || ( ipconfigUSE_UDP_BATCH != 0 )
 		struct xNETWORK_BUFFER *pxNextBuffer; /* Possible optimisation for expert users - requires network driver support. */
 	#endif
+	#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+		struct xNetworkInterface *pxInterface;	/* The interface on which the packet was received, set by the driver. */
+		struct xNetworkEndPoint *pxEndPoint;	/* The end-point to which the packet belongs, or which must send it. */
+	#endif
+	#if( ipconfigUSE_DRIVER_OFFLOADS != 0 )
+		uint16_t usSegmentSize;					/* When non-zero, the driver must cut this TCP frame into segments, see NetworkInterface.h. */
+	#endif
+	#if( ipconfigUSE_CHECKSUM_KERNELS != 0 )
+		uint16_t usPayloadChecksum;				/* The checksum of the UDP payload, taken while it was copied, or zero when unknown. */
+	#endif
+	#if( ipconfigUSE_IPv6 != 0 )
+		IPv6_Address_t xIPv6Address;			/* As ulIPAddress, for a UDP packet that is received from or sent to an IPv6 address. */
+		BaseType_t xUsesIPv6;					/* pdTRUE when xIPv6Address is used instead of ulIPAddress. */
+	#endif
+	#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+		volatile uint32_t ulReferenceCount;		/* The number of owners, the buffer is released when the last one lets go. */
+		struct xNETWORK_BUFFER *pxPayloadBuffer;	/* The buffer that holds the payload of this frame, or NULL when the frame is contiguous. */
+		uint8_t *pucPayload;					/* The payload, which is sent after the xDataLength bytes of this buffer. */
+		size_t uxPayloadLength;					/* The number of bytes at pucPayload. */
+		void ( *pxReleaseCallback )( struct xNETWORK_BUFFER *pxNetworkBuffer );	/* Called instead of returning the buffer to the pool, see vNetworkBufferWrapData(). */
+		size_t uxStreamOffset;					/* For a buffer that is queued on a TCP socket: the position in txStream of its first byte. */
+	#endif
 } NetworkBufferDescriptor_t;
 
 #include "pack_struct_start.h"
@@ -243,6 +273,8 @@ void FreeRTOS_SetNetmask( uint32_t ulNetmask );
 void FreeRTOS_SetGatewayAddress( uint32_t ulGatewayAddress );
 uint32_t FreeRTOS_GetGatewayAddress( void );
 uint32_t FreeRTOS_GetDNSServerAddress( void );
+uint32_t FreeRTOS_GetDNSServerAddressAt( BaseType_t xIndex );
+void FreeRTOS_SetDNSServerAddressAt( BaseType_t xIndex, uint32_t ulDNSServerAddress );
 uint32_t FreeRTOS_GetNetmask( void );
 void FreeRTOS_OutputARPRequest( uint32_t ulIPAddress );
 BaseType_t FreeRTOS_IsNetworkUp( void );
@@ -251,6 +283,41 @@ BaseType_t FreeRTOS_IsNetworkUp( void );
 	UBaseType_t uxGetMinimumIPQueueSpace( void );
 #endif
 
+#if( ipconfigUSE_MIB_COUNTERS != 0 )
+	/* Counters of the IPv4 traffic, named after their equivalents in the MIB-II
+	of RFC 1213.  The counters are updated by the IP-task without protection and
+	they wrap around at 2^32. */
+	typedef struct xIP_MIB_COUNTERS
+	{
+		uint32_t ulFramesReceived;		/* Ethernet frames passed to the IP-task. */
+		uint32_t ulFramesNotForUs;		/* Frames dropped because of their destination MAC address. */
+		uint32_t ulFramesNotEthernetII;	/* Frames dropped because they are not Ethernet II. */
+		uint32_t ulFramesUnknownType;	/* Frames dropped because of an unknown frame type. */
+		uint32_t ulIPInReceives;		/* IPv4 packets received. */
+		uint32_t ulIPInHdrErrors;		/* IPv4 packets dropped because of an invalid header or header checksum. */
+		uint32_t ulIPInAddrErrors;		/* IPv4 packets dropped because they are not addressed to this node. */
+		uint32_t ulIPInFragmentDrops;	/* IPv4 fragments dropped because reassembly is not enabled. */
+		uint32_t ulIPInChecksumErrors;	/* IPv4 packets dropped because of the checksum of the TCP, UDP or ICMP message. */
+		uint32_t ulIPInUnknownProtos;	/* IPv4 packets dropped because of an unknown protocol. */
+		uint32_t ulIPInDelivers;		/* IPv4 packets passed to ICMP, UDP or TCP. */
+		uint32_t ulICMPInMsgs;			/* ICMP messages received. */
+		uint32_t ulICMPOutMsgs;			/* ICMP messages sent. */
+		uint32_t ulUDPInDatagrams;		/* UDP datagrams delivered to a socket. */
+		uint32_t ulUDPNoPorts;			/* UDP datagrams for which no socket was bound. */
+		uint32_t ulUDPInErrors;			/* UDP datagrams dropped because they were too short or the socket was full. */
+		uint32_t ulUDPOutDatagrams;		/* UDP datagrams sent. */
+		uint32_t ulTCPInSegs;			/* TCP segments received. */
+		uint32_t ulTCPInErrs;			/* TCP segments dropped because they were malformed. */
+		uint32_t ulTCPOutSegs;			/* TCP segments sent, including retransmissions. */
+		uint32_t ulTCPRetransSegs;		/* TCP segments retransmitted. */
+		uint32_t ulTCPOutRsts;			/* TCP segments sent with the RST flag. */
+	} IPMIBCounters_t;
+
+	/* Copy the current counters to pxCounters.  When xReset is non-zero, the
+	counters are cleared after they have been copied. */
+	void FreeRTOS_GetMIBCounters( IPMIBCounters_t *pxCounters, BaseType_t xReset );
+#endif /* ipconfigUSE_MIB_COUNTERS */
+
 /*
  * Defined in FreeRTOS_Sockets.c
  * //_RB_ Don't think this comment is correct.  If this is for internal use only it should appear after all the public API functions and not start with FreeRTOS_.
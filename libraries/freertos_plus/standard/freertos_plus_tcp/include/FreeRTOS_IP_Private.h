@@ -50,6 +50,9 @@ typedef struct xNetworkAddressingParameters
 	uint32_t ulGatewayAddress;
 	uint32_t ulDNSServerAddress;
 	uint32_t ulBroadcastAddress;
+#if( ipconfigDNS_MAX_SERVERS > 1 )
+	uint32_t ulAlternateDNSServerAddresses[ ipconfigDNS_MAX_SERVERS - 1 ];	/* Tried after ulDNSServerAddress, in this order. */
+#endif
 } NetworkAddressingParameters_t;
 
 extern BaseType_t xTCPWindowLoggingLevel;
@@ -231,6 +234,15 @@ typedef union XPROT_PACKET
 /* The maximum UDP payload length. */
 #define ipMAX_UDP_PAYLOAD_LENGTH ( ( ipconfigNETWORK_MTU - ipSIZE_OF_IPv4_HEADER ) - ipSIZE_OF_UDP_HEADER )
 
+/* The maximum UDP payload length when sending to an IPv6 address. */
+#define ipMAX_UDP_PAYLOAD_LENGTH_IPv6 ( ( ipconfigNETWORK_MTU - ipSIZE_OF_IPv6_HEADER ) - ipSIZE_OF_UDP_HEADER )
+
+/* A UDP packet to an IPv6 address is built on a buffer of which the payload
+starts at ipUDP_PAYLOAD_OFFSET_IPv4, like any UDP packet.  When it is sent, the
+payload moves up to make room for the longer header, so the buffer must be
+this many bytes longer. */
+#define ipIPv6_EXTRA_HEADER_LENGTH ( ipSIZE_OF_IPv6_HEADER - ipSIZE_OF_IPv4_HEADER )
+
 typedef enum
 {
 	eReleaseBuffer = 0,		/* Processing the frame did not find anything to do - just release the buffer. */
@@ -254,6 +266,8 @@ typedef enum
 	eSocketCloseEvent,		/* 9: Send a message to the IP-task to close a socket. */
 	eSocketSelectEvent,		/*10: Send a message to the IP-task for select(). */
 	eSocketSignalEvent,		/*11: A socket must be signalled. */
+	eDNSEvent,				/*12: Send pending DNS requests and handle their replies. */
+	eStackTxBatchEvent,		/*13: The software stack has queued a chain of UDP packets to transmit. */
 } eIPEvent_t;
 
 typedef struct IP_TASK_COMMANDS
@@ -297,6 +311,7 @@ typedef struct xUDP_IP_FRAGMENT_PARAMETERS IPFragmentParameters_t;
 	/* Ethernet frame types. */
 	#define ipARP_FRAME_TYPE	( 0x0608U )
 	#define ipIPv4_FRAME_TYPE	( 0x0008U )
+	#define ipIPv6_FRAME_TYPE	( 0xDD86U )
 
 	/* ARP related definitions. */
 	#define ipARP_PROTOCOL_TYPE				( 0x0008U )
@@ -309,6 +324,7 @@ typedef struct xUDP_IP_FRAGMENT_PARAMETERS IPFragmentParameters_t;
 	/* Ethernet frame types. */
 	#define ipARP_FRAME_TYPE	( 0x0806U )
 	#define ipIPv4_FRAME_TYPE	( 0x0800U )
+	#define ipIPv6_FRAME_TYPE	( 0x86DDU )
 
 	/* ARP related definitions. */
 	#define ipARP_PROTOCOL_TYPE ( 0x0800U )
@@ -348,6 +364,15 @@ extern const BaseType_t xBufferAllocFixedSize;
 	extern List_t xBoundTCPSocketsList;
 #endif
 
+/* Defined in FreeRTOS_IP.c, see FreeRTOS_GetMIBCounters(). */
+#if( ipconfigUSE_MIB_COUNTERS != 0 )
+	extern IPMIBCounters_t xIPMIBCounters;
+
+	#define ipMIB_INCREMENT( xField )	( xIPMIBCounters.xField )++
+#else
+	#define ipMIB_INCREMENT( xField )
+#endif
+
 /* The local IP address is accessed from within xDefaultPartUDPPacketHeader,
 rather than duplicated in its own variable. */
 #define ipLOCAL_IP_ADDRESS_POINTER ( ( uint32_t * ) &( xDefaultPartUDPPacketHeader.ulWords[ 20u / sizeof(uint32_t) ] ) )
@@ -435,6 +460,31 @@ eFrameProcessingResult_t eConsiderFrameForProcessing( const uint8_t * const pucE
  */
 uint16_t usGenerateChecksum( uint32_t ulSum, const uint8_t * pucNextData, size_t uxDataLengthBytes );
 
+#if( ipconfigUSE_CHECKSUM_KERNELS != 0 )
+	/*
+	 * Copy xDataLengthBytes from pucSource to pucTarget, and return the same
+	 * checksum over the copied data as usGenerateChecksum() does.
+	 */
+	uint16_t usGenerateChecksumCopy( uint32_t ulSum, uint8_t *pucTarget, const uint8_t *pucSource, size_t uxDataLengthBytes );
+#endif
+
+#if( ipconfigUSE_IP_REASSEMBLY != 0 )
+	/*
+	 * Pass a received fragment to the reassembly of its datagram.  The data of
+	 * the fragment is copied, the caller still owns pxFragment.  When the
+	 * fragment completes the datagram, a network buffer holding the whole
+	 * datagram is returned, which must be processed like a received packet.
+	 * Otherwise NULL is returned.
+	 */
+	NetworkBufferDescriptor_t *pxIPReassemble( const NetworkBufferDescriptor_t * const pxFragment, UBaseType_t uxHeaderLength );
+
+	/*
+	 * Discard the datagrams whose reassembly took too long.  Called
+	 * periodically by the IP-task.
+	 */
+	void vIPReassemblyCheckTimeouts( void );
+#endif
+
 /* Socket related private functions. */
 
 /* 
@@ -503,6 +553,9 @@ BaseType_t xIPIsNetworkTaskReady( void );
 	{
 		uint32_t ulRemoteIP;		/* IP address of remote machine */
 		uint16_t usRemotePort;		/* Port on remote machine */
+		#if( ipconfigTCP_HASH_TABLE_SIZE > 0 )
+			ListItem_t xHashListItem;	/* Used to reference the socket from the connection or listen table */
+		#endif
 		struct {
 			/* Most compilers do like bit-flags */
 			uint32_t
@@ -531,6 +584,13 @@ BaseType_t xIPIsNetworkTaskReady( void );
 				bFinLast : 1,		/* The last ACK (after FIN and FIN+ACK) has been sent or will be sent by the peer */
 				bRxStopped : 1,		/* Application asked to temporarily stop reception */
 				bMallocError : 1,	/* There was an error allocating a stream */
+				#if( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+					bTimeStamps : 1,	/* Both parties sent a TCP time-stamp option in the SYN phase */
+				#endif /* ipconfigUSE_TCP_TIMESTAMPS */
+				#if( ipconfigTCP_RX_COALESCE_BYTES > 0 )
+					bRxCoalesce : 1,	/* The segment being stored is full-size and more are expected */
+					bRxWakePending : 1,	/* Data was stored without waking up the reader */
+				#endif /* ipconfigTCP_RX_COALESCE_BYTES */
 				bWinScaling : 1;	/* A TCP-Window Scaling option was offered and accepted in the SYN phase. */
 		} bits;
 		uint32_t ulHighestRxAllowed;
@@ -552,12 +612,22 @@ BaseType_t xIPIsNetworkTaskReady( void );
 		#if( ipconfigTCP_HANG_PROTECTION == 1 )
 			TickType_t xLastActTime;
 		#endif /* ipconfigTCP_HANG_PROTECTION */
+		#if( ipconfigTCP_ACK_EVERY_N_SEGMENTS > 0 )
+			uint8_t ucUnackedSegments;	/* Data segments received since the last ACK was sent */
+		#endif
+		#if( ipconfigTCP_QUICKACK_IDLE_MS > 0 )
+			uint8_t ucQuickAcks;		/* The number of data segments that will still be acknowledged immediately */
+			TickType_t xLastRxDataTime;	/* The time at which the last data segment was received */
+		#endif
 		size_t uxLittleSpace;
 		size_t uxEnoughSpace;
 		size_t uxRxStreamSize;
 		size_t uxTxStreamSize;
 		StreamBuffer_t *rxStream;
 		StreamBuffer_t *txStream;
+		#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+			List_t xTxBufferList;	/* Buffers passed to FreeRTOS_send_buffer(), in stream order, see 'uxStreamOffset'. */
+		#endif
 		#if( ipconfigUSE_TCP_WIN == 1 )
 			NetworkBufferDescriptor_t *pxAckMessage;
 		#endif /* ipconfigUSE_TCP_WIN */
@@ -568,6 +638,9 @@ BaseType_t xIPIsNetworkTaskReady( void );
 			uint8_t ucMyWinScaleFactor;
 			uint8_t ucPeerWinScaleFactor;
 		#endif
+		#if( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+			uint32_t ulTSRecent;		/* The time-stamp of the peer that will be echoed in the next segment */
+		#endif
 		#if( ipconfigUSE_CALLBACKS == 1 )
 			FOnTCPReceive_t pxHandleReceive;	/*
 										 		 * In case of a TCP socket:
@@ -588,6 +661,9 @@ BaseType_t xIPIsNetworkTaskReady( void );
 typedef struct UDPSOCKET
 {
 	List_t xWaitingPacketsList;	/* Incoming packets */
+	#if( ipconfigUDP_HASH_TABLE_SIZE > 0 )
+		ListItem_t xHashListItem;	/* Used to reference the socket from the port table, holds the port number */
+	#endif
 	#if( ipconfigUDP_MAX_RX_PACKETS > 0 )
 		UBaseType_t uxMaxPackets; /* Protection: limits the number of packets buffered per socket */
 	#endif /* ipconfigUDP_MAX_RX_PACKETS */
@@ -638,6 +714,13 @@ typedef struct XSOCKET
 		They are maintained by the IP-task */
 		EventBits_t xSocketBits;
 	#endif /* ipconfigSUPPORT_SELECT_FUNCTION */
+	#if( ipconfigSUPPORT_SELECT_READY_LIST == 1 )
+		/* Links the socket into the ready list of its socket set. */
+		ListItem_t xReadyListItem;
+		/* The events that occurred since the socket was last taken from the
+		ready list. */
+		EventBits_t xReadyBits;
+	#endif /* ipconfigSUPPORT_SELECT_READY_LIST */
 	/* TCP/UDP specific fields: */
 	/* Before accessing any member of this structure, it should be confirmed */
 	/* that the protocol corresponds with the type of structure */
@@ -661,6 +744,15 @@ typedef struct XSOCKET
 	 */
 	FreeRTOS_Socket_t *pxTCPSocketLookup( uint32_t ulLocalIP, UBaseType_t uxLocalPort, uint32_t ulRemoteIP, UBaseType_t uxRemotePort );
 
+	#if( ipconfigTCP_HASH_TABLE_SIZE > 0 )
+		/*
+		 * Move a TCP socket to the table that matches its current state and
+		 * addresses, so pxTCPSocketLookup() finds it without walking through
+		 * xBoundTCPSocketsList.  Must be called from the IP-task.
+		 */
+		void vSocketTCPHashUpdate( FreeRTOS_Socket_t *pxSocket );
+	#endif /* ipconfigTCP_HASH_TABLE_SIZE */
+
 #endif /* ipconfigUSE_TCP */
 
 /*
@@ -682,6 +774,51 @@ void vProcessGeneratedUDPPacket( NetworkBufferDescriptor_t * const pxNetworkBuff
  */
 uint16_t usGenerateProtocolChecksum( const uint8_t * const pucEthernetBuffer, size_t uxBufferLength, BaseType_t xOutgoingPacket );
 
+#if( ipconfigUSE_DRIVER_OFFLOADS != 0 )
+	/*
+	 * Return the ipOFFLOAD_ flags of the interface that sends or received
+	 * pxNetworkBuffer, see NetworkInterface.h.  The driver-included checksum
+	 * options are added to them.  When puxMaxFrameLength is not NULL, it
+	 * receives the longest frame that may be passed for TCP segmentation, or
+	 * zero.  pxNetworkBuffer is only used when there is more than one
+	 * interface.
+	 */
+	UBaseType_t uxIPGetOffloads( const NetworkBufferDescriptor_t *pxNetworkBuffer, size_t *puxMaxFrameLength );
+
+	#define ipHAS_OFFLOAD( pxNetworkBuffer, uxOffload )	( ( uxIPGetOffloads( ( pxNetworkBuffer ), NULL ) & ( uxOffload ) ) != 0U )
+#else
+	#define ipHAS_OFFLOAD( pxNetworkBuffer, uxOffload )	( pdFALSE )
+#endif /* ipconfigUSE_DRIVER_OFFLOADS */
+
+#if( ipconfigUSE_PCAP_CAPTURE != 0 )
+	/*
+	 * Store a frame that is received (xOutgoing is pdFALSE) or sent in the
+	 * capture ring buffer, when a capture is running, see FreeRTOS_Capture.h.
+	 */
+	void vCaptureFrame( const NetworkBufferDescriptor_t *pxNetworkBuffer, BaseType_t xOutgoing );
+
+	#define ipCAPTURE_RECEIVED( pxNetworkBuffer )	vCaptureFrame( ( pxNetworkBuffer ), pdFALSE )
+
+	#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+		/* The source MAC address is only filled in by xNetworkInterfaceOutput(),
+		which captures the frames that it sends. */
+		#define ipCAPTURE_SENT( pxNetworkBuffer )
+	#else
+		#define ipCAPTURE_SENT( pxNetworkBuffer )	vCaptureFrame( ( pxNetworkBuffer ), pdTRUE )
+	#endif
+#else
+	#define ipCAPTURE_RECEIVED( pxNetworkBuffer )
+	#define ipCAPTURE_SENT( pxNetworkBuffer )
+#endif /* ipconfigUSE_PCAP_CAPTURE */
+
+/* pdTRUE when a payload is chained to the frame in pxNetworkBuffer, see
+vNetworkBufferChainPayload(). */
+#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+	#define ipIS_CHAINED( pxNetworkBuffer )	( ( pxNetworkBuffer )->pxPayloadBuffer != NULL )
+#else
+	#define ipIS_CHAINED( pxNetworkBuffer )	( pdFALSE )
+#endif
+
 /*
  * An Ethernet frame has been updated (maybe it was an ARP request or a PING
  * request?) and is to be sent back to its source.
@@ -777,6 +914,14 @@ NetworkBufferDescriptor_t *pxUDPPayloadBuffer_to_NetworkBuffer( void *pvBuffer )
 	void vTCPStateChange( FreeRTOS_Socket_t *pxSocket, enum eTCP_STATE eTCPState );
 #endif /* ipconfigUSE_TCP */
 
+#if( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+	/*
+	 * Release the buffers that the application passed to
+	 * FreeRTOS_send_buffer(), when the socket is closed or reused.
+	 */
+	void vTCPReleaseTxBuffers( FreeRTOS_Socket_t *pxSocket );
+#endif
+
 /*_RB_ Should this be part of the public API? */
 void FreeRTOS_netstat( void );
 
@@ -790,10 +935,22 @@ typedef struct xSOCKET_SET
 	EventGroupHandle_t xSelectGroup;
 	BaseType_t bApiCalled;	/* True if the API was calling  the private vSocketSelect */
 	FreeRTOS_Socket_t *pxSocket;
+	#if( ipconfigSUPPORT_SELECT_READY_LIST == 1 )
+		/* The sockets that had an event which FreeRTOS_select_ready() has not
+		returned yet, in the order of their first event. */
+		List_t xReadyList;
+	#endif
 } SocketSelect_t;
 
 extern void vSocketSelect( SocketSelect_t *pxSocketSelect );
 
+#if( ipconfigSUPPORT_SELECT_READY_LIST == 1 )
+	/* Called by the IP-task when events in xSelectBits occurred on pxSocket,
+	which belongs to a socket set: add the socket to the ready list of the
+	set, and wake up FreeRTOS_select_ready(). */
+	void vSocketSelectReady( FreeRTOS_Socket_t *pxSocket, EventBits_t xSelectBits );
+#endif
+
 #endif /* ipconfigSUPPORT_SELECT_FUNCTION */
 
 void vIPSetDHCPTimerEnableState( BaseType_t xEnableState );
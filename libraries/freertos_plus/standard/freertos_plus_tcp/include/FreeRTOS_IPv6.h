@@ -0,0 +1,168 @@
+/*
+ * FreeRTOS+TCP V2.0.11
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+#ifndef FREERTOS_IPv6_H
+#define FREERTOS_IPv6_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Application level configuration options. */
+#include "FreeRTOSIPConfig.h"
+#include "FreeRTOSIPConfigDefaults.h"
+#include "IPTraceMacroDefaults.h"
+
+#if( ipconfigUSE_IPv6 != 0 )
+
+/*-----------------------------------------------------------*/
+/* Miscellaneous structure and definitions. */
+/*-----------------------------------------------------------*/
+
+/* The value of ucNextHeader for ICMPv6. */
+#define ipPROTOCOL_ICMP_IPv6	( 58 )
+
+/* A received UDP packet from an IPv6 peer is rearranged before it is passed to
+the sockets, so that its payload starts at ipUDP_PAYLOAD_OFFSET_IPv4 like that
+of an IPv4 packet.  Its source address is copied to the xIPv6Address field of
+the network buffer, and its destination address is kept at this offset. */
+#define ipIPv6_UDP_DESTINATION_OFFSET	( ipSIZE_OF_ETH_HEADER )
+
+#include "pack_struct_start.h"
+struct xIPv6_HEADER
+{
+	uint8_t ucVersionTrafficClass;			/*  0 +  1 =  1 */
+	uint8_t ucTrafficClassFlowLabel;		/*  1 +  1 =  2 */
+	uint16_t usFlowLabel;					/*  2 +  2 =  4 */
+	uint16_t usPayloadLength;				/*  4 +  2 =  6 */
+	uint8_t ucNextHeader;					/*  6 +  1 =  7 */
+	uint8_t ucHopLimit;						/*  7 +  1 =  8 */
+	IPv6_Address_t xSourceAddress;			/*  8 + 16 = 24 */
+	IPv6_Address_t xDestinationAddress;		/* 24 + 16 = 40 */
+}
+#include "pack_struct_end.h"
+typedef struct xIPv6_HEADER IPv6Header_t;
+
+#include "pack_struct_start.h"
+struct xICMPv6_HEADER
+{
+	uint8_t ucTypeOfMessage;	/* 0 + 1 = 1 */
+	uint8_t ucTypeOfService;	/* 1 + 1 = 2, the code of the message. */
+	uint16_t usChecksum;		/* 2 + 2 = 4 */
+	uint8_t ucMessageBody[ 4 ];	/* 4 + 4 = 8, depends on the type. */
+}
+#include "pack_struct_end.h"
+typedef struct xICMPv6_HEADER ICMPv6Header_t;
+
+#include "pack_struct_start.h"
+struct xIPv6_PACKET
+{
+	EthernetHeader_t xEthernetHeader;	/*  0 + 14 = 14 */
+	IPv6Header_t xIPHeader;				/* 14 + 40 = 54 */
+}
+#include "pack_struct_end.h"
+typedef struct xIPv6_PACKET IPv6Packet_t;
+
+#include "pack_struct_start.h"
+struct xICMPv6_PACKET
+{
+	EthernetHeader_t xEthernetHeader;	/*  0 + 14 = 14 */
+	IPv6Header_t xIPHeader;				/* 14 + 40 = 54 */
+	ICMPv6Header_t xICMPHeader;			/* 54 +  8 = 62 */
+}
+#include "pack_struct_end.h"
+typedef struct xICMPv6_PACKET ICMPv6Packet_t;
+
+#include "pack_struct_start.h"
+struct xUDPv6_PACKET
+{
+	EthernetHeader_t xEthernetHeader;	/*  0 + 14 = 14 */
+	IPv6Header_t xIPHeader;				/* 14 + 40 = 54 */
+	UDPHeader_t xUDPHeader;				/* 54 +  8 = 62 */
+}
+#include "pack_struct_end.h"
+typedef struct xUDPv6_PACKET UDPv6Packet_t;
+
+/* A neighbour solicitation or advertisement, with one link-layer address
+option. */
+#include "pack_struct_start.h"
+struct xND_PACKET
+{
+	EthernetHeader_t xEthernetHeader;	/*  0 + 14 = 14 */
+	IPv6Header_t xIPHeader;				/* 14 + 40 = 54 */
+	ICMPv6Header_t xICMPHeader;			/* 54 +  8 = 62 */
+	IPv6_Address_t xTargetAddress;		/* 62 + 16 = 78 */
+	uint8_t ucOptionType;				/* 78 +  1 = 79 */
+	uint8_t ucOptionLength;				/* 79 +  1 = 80, in units of 8 bytes. */
+	MACAddress_t xLinkLayerAddress;		/* 80 +  6 = 86 */
+}
+#include "pack_struct_end.h"
+typedef struct xND_PACKET NDPacket_t;
+
+typedef enum
+{
+	eIPv6LinkLocal = 0,		/* The fe80::/64 address that is derived from the MAC address. */
+	eIPv6Global				/* The address that is formed from a prefix advertised by a router. */
+} eIPv6AddressType_t;
+
+/*
+ * Copy an IPv6 address of this node to pxAddress.  Returns pdPASS when the
+ * address has passed duplicate address detection and can be used, pdFAIL
+ * otherwise.
+ */
+BaseType_t FreeRTOS_GetIPv6Address( eIPv6AddressType_t eType, IPv6_Address_t *pxAddress );
+
+/*
+ * Called by the IP-task when the network interface has come up: forget the
+ * addresses, the router and the neighbour cache, and start configuring the
+ * link-local address.
+ */
+void vIPv6NetworkUp( void );
+
+/*
+ * Called by the IP-task every second: detect duplicate addresses, solicit
+ * routers, age the neighbour cache and expire lifetimes.
+ */
+void vIPv6CheckTimers( void );
+
+/*
+ * Process a received Ethernet frame of type ipIPv6_FRAME_TYPE.
+ */
+eFrameProcessingResult_t eIPv6ProcessPacket( NetworkBufferDescriptor_t * const pxNetworkBuffer );
+
+/*
+ * As vProcessGeneratedUDPPacket(), for a packet of which xUsesIPv6 is set.
+ * The payload starts at ipUDP_PAYLOAD_OFFSET_IPv4, and the buffer has room
+ * for ipIPv6_EXTRA_HEADER_LENGTH more bytes.
+ */
+void vIPv6ProcessGeneratedUDPPacket( NetworkBufferDescriptor_t * const pxNetworkBuffer );
+
+#endif /* ipconfigUSE_IPv6 */
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* FREERTOS_IPv6_H */
@@ -0,0 +1,177 @@
+/*
+ * FreeRTOS+TCP V2.0.11
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+#ifndef FREERTOS_ROUTING_H
+#define FREERTOS_ROUTING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Application level configuration options. */
+#include "FreeRTOSIPConfig.h"
+#include "FreeRTOSIPConfigDefaults.h"
+
+/*
+ * When ipconfigUSE_MULTI_INTERFACE is set to 1 the IP-task can be attached to
+ * more than one network interface, for instance an Ethernet port and a WiFi
+ * module.  Each interface is described by a NetworkInterface_t, and owns one
+ * or more end-points.  An end-point holds the IP and MAC addresses that the
+ * stack uses on that interface.
+ *
+ * The first end-point is created by FreeRTOS_IPInit() on the first interface
+ * that was added.  Its addressing is the one returned by FreeRTOS_GetIPAddress()
+ * etc., and it is the only end-point that is configured by DHCP.  More
+ * end-points can be added with FreeRTOS_AddEndPoint(), they use static
+ * addresses.
+ *
+ * Outgoing packets are routed by destination address.  Each end-point
+ * provides a route to its own subnet and, when it has a gateway, a default
+ * route through that gateway.  More routes can be added to a small routing
+ * table.  The most specific route wins; when several routes
+ * are equally specific, the one with the lowest metric is used.  Traffic is
+ * spread over routes that also have the same metric, keeping all packets to
+ * one destination on the same route.  Routes through an interface whose link
+ * is down are skipped, so traffic fails over to the remaining interfaces
+ * without re-initialising the stack.
+ *
+ * In this mode the stack itself implements xNetworkInterfaceInitialise() and
+ * xNetworkInterfaceOutput(), and forwards the calls to the interfaces.
+ * Drivers fill in a NetworkInterface_t instead of implementing those two
+ * functions, and set 'pxInterface' of every received network buffer before
+ * passing it to the IP-task.
+ */
+
+struct xNetworkInterface;
+
+typedef BaseType_t ( * NetworkInterfaceInitialiseFunction_t ) ( struct xNetworkInterface *pxInterface );
+typedef BaseType_t ( * NetworkInterfaceOutputFunction_t ) ( struct xNetworkInterface *pxInterface,
+	NetworkBufferDescriptor_t * const pxNetworkBuffer, BaseType_t xReleaseAfterSend );
+
+typedef struct xNetworkInterface
+{
+	const char *pcName;								/* Just for logging and debugging. */
+	void *pvArgument;								/* Can be used freely by the driver. */
+	NetworkInterfaceInitialiseFunction_t pfInitialise;	/* Brings up the hardware, returns pdPASS when the link is up. */
+	NetworkInterfaceOutputFunction_t pfOutput;		/* Sends a frame, see xNetworkInterfaceOutput(). */
+	volatile BaseType_t xLinkUp;					/* pdFALSE while the link is down, see FreeRTOS_SetInterfaceLinkState(). */
+	#if( ipconfigUSE_DRIVER_OFFLOADS != 0 )
+		UBaseType_t uxOffloads;						/* The ipOFFLOAD_ flags that the driver supports, see NetworkInterface.h. */
+		size_t uxMaxFrameLength;					/* The longest frame accepted with ipOFFLOAD_TCP_SEGMENTATION. */
+	#endif
+	struct xNetworkInterface *pxNext;				/* Used by the stack to link the interfaces together. */
+} NetworkInterface_t;
+
+typedef struct xNetworkEndPoint
+{
+	uint32_t ulIPAddress;							/* IP address of this end-point, network byte order. */
+	uint32_t ulNetMask;
+	uint32_t ulGatewayAddress;
+	uint32_t ulDNSServerAddress;
+	uint32_t ulBroadcastAddress;
+	MACAddress_t xMACAddress;						/* Used as the source address of all frames sent from this end-point. */
+	UBaseType_t uxMetric;							/* The metric of the subnet and default routes provided by this end-point. */
+	NetworkInterface_t *pxNetworkInterface;			/* The interface that owns this end-point. */
+	struct xNetworkEndPoint *pxNext;				/* Used by the stack to link the end-points together. */
+} NetworkEndPoint_t;
+
+/*
+ * Add a network interface to the stack.  Interfaces must be added before
+ * FreeRTOS_IPInit() is called, and they can not be removed.  The structure
+ * must remain valid for as long as the stack runs.
+ */
+void FreeRTOS_AddNetworkInterface( NetworkInterface_t *pxInterface );
+
+/*
+ * Add an extra end-point with static addressing to an interface that was
+ * added earlier.  The parameters have the same format as those of
+ * FreeRTOS_IPInit().  The routes provided by the end-point get a metric of
+ * zero, a higher 'uxMetric' can be set to make them less preferred.
+ */
+void FreeRTOS_AddEndPoint( NetworkInterface_t *pxInterface,
+	NetworkEndPoint_t *pxEndPoint,
+	const uint8_t ucIPAddress[ ipIP_ADDRESS_LENGTH_BYTES ],
+	const uint8_t ucNetMask[ ipIP_ADDRESS_LENGTH_BYTES ],
+	const uint8_t ucGatewayAddress[ ipIP_ADDRESS_LENGTH_BYTES ],
+	const uint8_t ucDNSServerAddress[ ipIP_ADDRESS_LENGTH_BYTES ],
+	const uint8_t ucMACAddress[ ipMAC_ADDRESS_LENGTH_BYTES ] );
+
+/*
+ * Add a route for the network ulDestination/ulNetMask, reachable through the
+ * router ulGateway on pxEndPoint.  A ulGateway of zero means that the network
+ * is reached directly.  A ulNetMask of zero gives a default route.  All
+ * addresses are in network byte order.  Returns pdFAIL when the routing table
+ * is full.
+ */
+BaseType_t FreeRTOS_AddRoute( uint32_t ulDestination, uint32_t ulNetMask, uint32_t ulGateway,
+	NetworkEndPoint_t *pxEndPoint, UBaseType_t uxMetric );
+
+/*
+ * Remove a route that was added by FreeRTOS_AddRoute().  Returns pdFAIL if
+ * there was no such route.
+ */
+BaseType_t FreeRTOS_RemoveRoute( uint32_t ulDestination, uint32_t ulNetMask, NetworkEndPoint_t *pxEndPoint );
+
+/*
+ * To be called by a driver when the link of its interface goes up or down.
+ * Routes through an interface that is down are not used, and the ARP entries
+ * learned on it are flushed by the next ARP timer event.  Unlike
+ * FreeRTOS_NetworkDown(), this does not re-initialise the stack.
+ */
+void FreeRTOS_SetInterfaceLinkState( NetworkInterface_t *pxInterface, BaseType_t xLinkUp );
+
+/*
+ * Find the end-point through which ulIPAddress is reached.  The address of the
+ * next hop (either ulIPAddress itself or a router) is written to pulNextHop
+ * when pulNextHop is not NULL.  Returns NULL if there is no usable route.
+ */
+NetworkEndPoint_t *FreeRTOS_FindRoute( uint32_t ulIPAddress, uint32_t *pulNextHop );
+
+/* Find the end-point that owns the IP address ulIPAddress. */
+NetworkEndPoint_t *FreeRTOS_FindEndPointOnIP( uint32_t ulIPAddress );
+
+/* Find the end-point whose subnet contains ulIPAddress. */
+NetworkEndPoint_t *FreeRTOS_FindEndPointOnNetMask( uint32_t ulIPAddress );
+
+/* Find the end-point that owns the MAC address pxMACAddress. */
+NetworkEndPoint_t *FreeRTOS_FindEndPointOnMAC( const MACAddress_t *pxMACAddress );
+
+/* Iterate through all end-points, starting with the one created by
+FreeRTOS_IPInit(). */
+NetworkEndPoint_t *FreeRTOS_FirstEndPoint( void );
+NetworkEndPoint_t *FreeRTOS_NextEndPoint( const NetworkEndPoint_t *pxEndPoint );
+
+/*
+ * NOT A PUBLIC API FUNCTION.
+ * Find the end-point of pxInterface to which a received frame is addressed.
+ * Returns NULL if the frame is not for this node.
+ */
+NetworkEndPoint_t *pxRoutingMatchingEndPoint( NetworkInterface_t *pxInterface, const uint8_t *pucEthernetBuffer );
+
+#ifdef __cplusplus
+}	/* extern "C" */
+#endif
+
+#endif /* FREERTOS_ROUTING_H */
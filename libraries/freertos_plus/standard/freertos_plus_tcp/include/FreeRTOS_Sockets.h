@@ -93,7 +93,8 @@ standard.  See the documentation of FreeRTOS_socket() for more information. */
 /* A bit value that can be passed into the FreeRTOS_sendto() function as part of
 the flags parameter.  Setting the FREERTOS_ZERO_COPY in the flags parameter
 indicates that the zero copy interface is being used.  See the documentation for
-FreeRTOS_sockets() for more information. */
+FreeRTOS_sockets() for more information.  TCP data is sent without copying with
+FreeRTOS_send_buffer(). */
 #define FREERTOS_ZERO_COPY		( 1 )
 
 /* Values that can be passed in the option name parameter of calls to
@@ -132,6 +133,10 @@ FreeRTOS_setsockopt(). */
 
 #define FREERTOS_SO_SET_LOW_HIGH_WATER	( 18 )
 
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+	#define FREERTOS_SO_TCP_CONGESTION	( 19 )		/* Choose the congestion control algorithm before connecting, parameter is a pointer to a TCPCongestionOps_t, e.g. &xTCPCongestionCubic, see FreeRTOS_TCP_WIN.h */
+#endif
+
 #define FREERTOS_NOT_LAST_IN_FRAGMENTED_PACKET 	( 0x80 )  /* For internal use only, but also part of an 8-bit bitwise value. */
 #define FREERTOS_FRAGMENTED_PACKET				( 0x40 )  /* For internal use only, but also part of an 8-bit bitwise value. */
 
@@ -162,6 +167,37 @@ typedef struct xLOW_HIGH_WATER {
 	size_t uxEnoughSpace;	/* Send a GO when buffer space grows above X bytes */
 } LowHighWater_t;
 
+typedef struct xCONGESTION_INFO {
+	/* Structure filled in by FreeRTOS_GetCongestionInfo() */
+	const char *pcAlgorithm;	/* Name of the congestion control algorithm */
+	uint32_t ulCWnd;			/* Congestion window, unit: bytes */
+	uint32_t ulSSThresh;		/* Slow start threshold, unit: bytes */
+	uint32_t ulFastRetransmits;	/* Number of losses detected by duplicate ACKs or SACK's */
+	uint32_t ulTimeouts;		/* Number of retransmission time-outs */
+	BaseType_t xInRecovery;		/* pdTRUE while in fast recovery */
+} CongestionInfo_t;
+
+typedef struct xTCP_INFO {
+	/* Structure filled in by FreeRTOS_GetTCPInfo() */
+	uint8_t ucState;			/* The eIPTCPState_t of the connection */
+	uint8_t ucMyWinScale;		/* Scale factor of the window that we advertise */
+	uint8_t ucPeerWinScale;		/* Scale factor of the window that the peer advertises */
+	uint16_t usMSS;				/* Maximum segment size in use, unit: bytes */
+	int32_t lSRTT;				/* Smoothed round-trip time, unit: ms, 0 until it has been measured */
+	int32_t lRTTVar;			/* Variation of the round-trip time, unit: ms */
+	int32_t lRTO;				/* Retransmission time-out, unit: ms */
+	uint32_t ulRxWindow;		/* Size of the reception window, unit: bytes */
+	uint32_t ulTxWindow;		/* Size of the transmission window, unit: bytes */
+	uint32_t ulPeerWindow;		/* Last window advertised by the peer, unit: bytes */
+	uint32_t ulBytesInFlight;	/* Bytes sent but not yet acknowledged */
+	size_t uxRxQueued;			/* Bytes received that wait to be read */
+	size_t uxTxQueued;			/* Bytes in the transmission buffer, sent or not */
+	uint32_t ulSegmentsIn;		/* Segments received */
+	uint32_t ulSegmentsOut;		/* Segments sent, including retransmissions */
+	uint32_t ulRetransmits;		/* Segments retransmitted */
+	uint32_t ulDupAcks;			/* Duplicate ACKs received */
+} TCPInfo_t;
+
 /* For compatibility with the expected Berkeley sockets naming. */
 #define socklen_t uint32_t
 
@@ -180,6 +216,38 @@ struct freertos_sockaddr
 	uint32_t sin_addr;
 };
 
+#if( ipconfigUSE_IPv6 != 0 )
+	/* The address of an IPv6 peer of a UDP socket.  It can be passed to
+	FreeRTOS_sendto() and FreeRTOS_recvfrom() in stead of a struct
+	freertos_sockaddr: the first three fields are at the same positions.  It
+	is only taken for an IPv6 address when 'sin6_family' is FREERTOS_AF_INET6
+	and the address length passed is at least the size of this structure.
+	FreeRTOS_recvfrom() only fills in this structure when the length passed in
+	*pxSourceAddressLength allows it.  IPv6_Address_t is declared in
+	FreeRTOS_IP.h. */
+	struct freertos_sockaddr6
+	{
+		uint8_t sin6_len;			/* length of this structure. */
+		uint8_t sin6_family;		/* FREERTOS_AF_INET6. */
+		uint16_t sin6_port;
+		uint32_t sin6_flowinfo;		/* Not used. */
+		IPv6_Address_t sin6_addr;
+	};
+#endif /* ipconfigUSE_IPv6 */
+
+#if( ipconfigUSE_UDP_BATCH != 0 )
+	/* One datagram that is passed to FreeRTOS_sendmmsg() or
+	FreeRTOS_recvmmsg(). */
+	typedef struct xUDP_MESSAGE
+	{
+		void *pvBuffer;							/* The data to send, or the space for the data received. */
+		size_t uxLength;						/* The length of the data to send, or the size of the space at pvBuffer. */
+		struct freertos_sockaddr *pxAddress;	/* The destination, or filled in with the source when not NULL. */
+		socklen_t xAddressLength;				/* As the address length of FreeRTOS_sendto() and FreeRTOS_recvfrom(). */
+		int32_t lResult;						/* Set to the number of bytes sent or received. */
+	} UDPMessage_t;
+#endif /* ipconfigUSE_UDP_BATCH */
+
 #if ipconfigBYTE_ORDER == pdFREERTOS_LITTLE_ENDIAN
 
 	#define FreeRTOS_inet_addr_quick( ucOctet0, ucOctet1, ucOctet2, ucOctet3 )				\
@@ -227,6 +295,14 @@ typedef void *SocketSet_t;
 Socket_t FreeRTOS_socket( BaseType_t xDomain, BaseType_t xType, BaseType_t xProtocol );
 int32_t FreeRTOS_recvfrom( Socket_t xSocket, void *pvBuffer, size_t xBufferLength, BaseType_t xFlags, struct freertos_sockaddr *pxSourceAddress, socklen_t *pxSourceAddressLength );
 int32_t FreeRTOS_sendto( Socket_t xSocket, const void *pvBuffer, size_t xTotalDataLength, BaseType_t xFlags, const struct freertos_sockaddr *pxDestinationAddress, socklen_t xDestinationAddressLength );
+
+#if( ipconfigUSE_UDP_BATCH != 0 )
+	/* Send or receive up to xMessageCount datagrams in one call.  Both return
+	the number of datagrams that were sent or received, see
+	FreeRTOS_Sockets.c. */
+	BaseType_t FreeRTOS_sendmmsg( Socket_t xSocket, UDPMessage_t *pxMessages, BaseType_t xMessageCount, BaseType_t xFlags );
+	BaseType_t FreeRTOS_recvmmsg( Socket_t xSocket, UDPMessage_t *pxMessages, BaseType_t xMessageCount, BaseType_t xFlags );
+#endif
 BaseType_t FreeRTOS_bind( Socket_t xSocket, struct freertos_sockaddr *pxAddress, socklen_t xAddressLength );
 
 /* function to get the local address and IP port */
@@ -241,6 +317,15 @@ BaseType_t FreeRTOS_connect( Socket_t xClientSocket, struct freertos_sockaddr *p
 BaseType_t FreeRTOS_listen( Socket_t xSocket, BaseType_t xBacklog );
 BaseType_t FreeRTOS_recv( Socket_t xSocket, void *pvBuffer, size_t xBufferLength, BaseType_t xFlags );
 BaseType_t FreeRTOS_send( Socket_t xSocket, const void *pvBuffer, size_t uxDataLength, BaseType_t xFlags );
+
+#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+	/* Send the first 'uxDataLength' bytes of a network buffer, e.g. one
+	prepared with vNetworkBufferWrapData(), without copying them.  When the call
+	succeeds, the stack releases the buffer once the peer has acknowledged the
+	data.  When it fails, the buffer still belongs to the caller. */
+	BaseType_t FreeRTOS_send_buffer( Socket_t xSocket, struct xNETWORK_BUFFER *pxNetworkBuffer, size_t uxDataLength, BaseType_t xFlags );
+#endif
+
 Socket_t FreeRTOS_accept( Socket_t xServerSocket, struct freertos_sockaddr *pxAddress, socklen_t *pxAddressLength );
 BaseType_t FreeRTOS_shutdown (Socket_t xSocket, BaseType_t xHow);
 
@@ -268,6 +353,17 @@ BaseType_t FreeRTOS_connstatus( Socket_t xSocket );
 /* Returns the number of bytes that may be added to txStream */
 BaseType_t FreeRTOS_maywrite( Socket_t xSocket );
 
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+	/* Get the congestion window and the loss statistics of a connection */
+	BaseType_t FreeRTOS_GetCongestionInfo( Socket_t xSocket, CongestionInfo_t *pxInfo );
+#endif
+
+#if( ipconfigUSE_TCP_INFO != 0 )
+	/* Get the round-trip time, the windows and the statistics of a connection,
+	like the TCP_INFO socket option of other stacks */
+	BaseType_t FreeRTOS_GetTCPInfo( Socket_t xSocket, TCPInfo_t *pxInfo );
+#endif
+
 /*
  * Two helper functions, mostly for testing
  * rx_size returns the number of bytes available in the Rx buffer
@@ -294,6 +390,40 @@ FreeRTOS_rx_size(). */
  */
 uint8_t *FreeRTOS_get_tx_head( Socket_t xSocket, BaseType_t *pxLength );
 
+/* Bytes in the circular buffer of a TCP socket.  They lie in at most two
+regions: the second one starts at the beginning of the buffer, and is only used
+when the bytes wrap around its end. */
+typedef struct xSTREAM_REGIONS
+{
+	uint8_t *pucFirst;			/* The first region. */
+	size_t uxFirstLength;		/* The number of bytes in the first region. */
+	uint8_t *pucSecond;			/* The second region, NULL when it is not used. */
+	size_t uxSecondLength;		/* The number of bytes in the second region. */
+} StreamRegions_t;
+
+/*
+ * For advanced applications only:
+ * Get the received data of a TCP socket without copying them.  Waits for data
+ * in the same way as FreeRTOS_recv().  Returns the number of bytes found in
+ * both regions, or 0 or a negative errno like FreeRTOS_recv().  The data stay
+ * in the buffer until they are removed with FreeRTOS_recv_consume().
+ */
+BaseType_t FreeRTOS_recv_regions( Socket_t xSocket, StreamRegions_t *pxRegions, BaseType_t xFlags );
+
+/*
+ * Remove 'uxCount' bytes, which were obtained with FreeRTOS_recv_regions(),
+ * from the receive buffer.  Returns the number of bytes removed.
+ */
+BaseType_t FreeRTOS_recv_consume( Socket_t xSocket, size_t uxCount );
+
+/*
+ * For advanced applications only:
+ * Get the free space in the transmit buffer as at most two regions.  Returns
+ * the number of bytes that may be written.  Data written there is sent after
+ * a call to FreeRTOS_send() with 'pvBuffer' NULL and the number of bytes.
+ */
+BaseType_t FreeRTOS_get_tx_regions( Socket_t xSocket, StreamRegions_t *pxRegions );
+
 #endif /* ipconfigUSE_TCP */
 
 /*
@@ -348,6 +478,17 @@ BaseType_t FreeRTOS_closesocket( Socket_t xSocket );
 uint32_t FreeRTOS_gethostbyname( const char *pcHostName );
 uint32_t FreeRTOS_inet_addr( const char * pcIPAddress );
 
+#if( ipconfigUSE_IPv6 != 0 )
+	/* Convert the text form of an IPv6 address, such as "fe80::1", to an
+	address.  Returns pdPASS, or pdFAIL when the text is not an address. */
+	BaseType_t FreeRTOS_inet_pton6( const char *pcSource, IPv6_Address_t *pxAddress );
+
+	/* Write the shortest text form of an IPv6 address, RFC 5952, to
+	pcBuffer, which should be at least 40 bytes long.  Returns pcBuffer, or
+	NULL when the buffer is too short. */
+	const char *FreeRTOS_inet_ntop6( const IPv6_Address_t *pxAddress, char *pcBuffer, size_t uxBufferLength );
+#endif /* ipconfigUSE_IPv6 */
+
 /*
  * For the web server: borrow the circular Rx buffer for inspection
  * HTML driver wants to see if a sequence of 13/10/13/10 is available
@@ -356,6 +497,27 @@ const struct xSTREAM_BUFFER *FreeRTOS_get_rx_buf( Socket_t xSocket );
 
 void FreeRTOS_netstat( void );
 
+#if( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_SYN_CACHE_SIZE > 0 )
+	/* Statistics about the connection requests received by listening sockets,
+	see ipconfigTCP_SYN_CACHE_SIZE.  The counters are not protected, so a count
+	may be missed while the IP-task updates them. */
+	typedef struct xTCP_LISTEN_STATISTICS
+	{
+		uint32_t ulSynReceived;			/* SYN's received by listening sockets. */
+		uint32_t ulSynRepeated;			/* Repeated SYN's, answered with the same SYN+ACK. */
+		uint32_t ulCacheOverflows;		/* Entries dropped because the SYN cache was full. */
+		uint32_t ulCookiesSent;			/* SYN's answered with a SYN cookie. */
+		uint32_t ulCookiesAccepted;		/* Connections opened by a valid SYN cookie. */
+		uint32_t ulInvalidAcks;			/* ACK's that matched no entry and no cookie. */
+		uint32_t ulBacklogOverflows;	/* Connection requests refused because the backlog was full. */
+		uint32_t ulSocketFailures;		/* Connections lost because no socket could be created. */
+		uint32_t ulResets;				/* Entries removed by a RST from the peer. */
+		uint32_t ulConnectionsCreated;	/* Sockets created when the handshake completed. */
+	} TCPListenStatistics_t;
+
+	void FreeRTOS_GetListenStatistics( TCPListenStatistics_t *pxStatistics );
+#endif /* ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_SYN_CACHE_SIZE > 0 ) */
+
 #if ipconfigSUPPORT_SELECT_FUNCTION == 1
 
 	/* For FD_SET and FD_CLR, a combination of the following bits can be used: */
@@ -368,6 +530,7 @@ void FreeRTOS_netstat( void );
 		eSELECT_ALL		= 0x000F,
 		/* Reserved for internal use: */
 		eSELECT_CALL_IP	= 0x0010,
+		eSELECT_READY_LIST = 0x0020,
 		/* end */
 	} eSelectEvent_t;
 
@@ -378,6 +541,25 @@ void FreeRTOS_netstat( void );
 	EventBits_t FreeRTOS_FD_ISSET( Socket_t xSocket, SocketSet_t xSocketSet );
 	BaseType_t FreeRTOS_select( SocketSet_t xSocketSet, TickType_t xBlockTimeTicks );
 
+	#if( ipconfigSUPPORT_SELECT_READY_LIST == 1 )
+
+		/* A socket returned by FreeRTOS_select_ready(), with the events that
+		occurred on it: eSELECT_READ, eSELECT_WRITE and/or eSELECT_EXCEPT. */
+		typedef struct xSOCKET_SELECT_EVENT
+		{
+			Socket_t xSocket;
+			EventBits_t xEvents;
+		} SocketSelectEvent_t;
+
+		/* Wait until sockets of the set have had events, and return up to
+		xMaxEvents of them.  Returns the number of sockets, 0 on a time-out, or
+		-pdFREERTOS_ERRNO_EINTR when the set was signalled.  A socket is only
+		returned again after a new event, so the events must be handled
+		completely, e.g. by reading until recv() returns -pdFREERTOS_ERRNO_EWOULDBLOCK. */
+		BaseType_t FreeRTOS_select_ready( SocketSet_t xSocketSet, SocketSelectEvent_t *pxEvents, BaseType_t xMaxEvents, TickType_t xBlockTimeTicks );
+
+	#endif /* ipconfigSUPPORT_SELECT_READY_LIST */
+
 #endif /* ipconfigSUPPORT_SELECT_FUNCTION */
 
 #ifdef __cplusplus
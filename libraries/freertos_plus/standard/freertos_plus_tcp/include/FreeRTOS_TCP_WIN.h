@@ -79,12 +79,63 @@ typedef struct xTCP_WINSIZE
  * each packet, and thus the message space will become smaller
  */
 /* Keep this as a multiple of 4 */
-#if( ipconfigUSE_TCP_WIN == 1 )
+#if( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+	/* Time-stamps followed by a SACK option, or the SYN options followed by
+	time-stamps. */
+	#define ipSIZE_TCP_OPTIONS	24u
+#elif( ipconfigUSE_TCP_WIN == 1 )
 	#define ipSIZE_TCP_OPTIONS	16u
 #else
 	#define ipSIZE_TCP_OPTIONS   12u
 #endif
 
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+
+struct xTCP_WINDOW;
+
+/*
+ * A congestion control algorithm.  The detection of losses, the fast
+ * retransmission and the fast recovery are handled by FreeRTOS_TCP_WIN.c, the
+ * algorithm decides how the congestion window grows and how far it shrinks.
+ * A socket may select an algorithm with the FREERTOS_SO_TCP_CONGESTION option.
+ */
+typedef struct xTCP_CONGESTION_OPS
+{
+	const char *pcName;					/* For logging and statistics */
+	/* The window has been initialised, ulCWnd and ulSSThresh have their start values. */
+	void ( *fnInit )( struct xTCP_WINDOW *pxWindow );
+	/* New data has been acknowledged while not in fast recovery: grow ulCWnd. */
+	void ( *fnOnAck )( struct xTCP_WINDOW *pxWindow, uint32_t ulBytesAcked );
+	/* A loss has been detected: return the new value of ulSSThresh. */
+	uint32_t ( *fnOnLoss )( struct xTCP_WINDOW *pxWindow, uint32_t ulFlightSize );
+} TCPCongestionOps_t;
+
+typedef struct xTCP_CONGESTION
+{
+	const TCPCongestionOps_t *pxOps;	/* The algorithm in use, ipconfigTCP_CONGESTION_DEFAULT unless chosen otherwise */
+	uint32_t ulCWnd;					/* Congestion window: the maximum number of outstanding bytes */
+	uint32_t ulSSThresh;				/* Slow start threshold: below this value, ulCWnd grows exponentially */
+	uint32_t ulBytesAcked;				/* Bytes acknowledged while in congestion avoidance, not yet added to ulCWnd */
+	uint32_t ulRecover;					/* The highest sequence number sent when the fast recovery started */
+	uint8_t ucDupAckCount;				/* The number of duplicate ACKs received in a row */
+	uint8_t ucInRecovery;				/* Non-zero while in fast recovery */
+	/* The state of CUBIC. */
+	uint32_t ulWMax;					/* ulCWnd just before the last reduction */
+	uint32_t ulOriginPoint;				/* ulCWnd at the plateau of the cubic function */
+	uint32_t ulK;						/* Time it takes to reach ulOriginPoint, in units of 10 ms */
+	uint32_t ulRenoCWnd;				/* The window that NewReno would have, the minimum for CUBIC */
+	TickType_t xEpochStart;				/* The start of the current congestion avoidance period, or zero */
+	/* Statistics. */
+	uint32_t ulFastRetransmits;			/* Number of losses detected by duplicate ACKs or SACKs */
+	uint32_t ulTimeouts;				/* Number of retransmission time-outs */
+} TCPCongestion_t;
+
+/* The built-in algorithms, see FreeRTOS_TCP_CC.c. */
+extern const TCPCongestionOps_t xTCPCongestionNewReno;
+extern const TCPCongestionOps_t xTCPCongestionCubic;
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
 /*
  *	Every TCP connection owns a TCP window for the administration of all packets
  *	It owns two sets of segment descriptors, incoming and outgoing
@@ -98,8 +149,10 @@ typedef struct xTCP_WINDOW
 			uint32_t
 				bHasInit : 1,		/* The window structure has been initialised */
 				bSendFullSize : 1,	/* May only send packets with a size equal to MSS (for optimisation) */
-				bTimeStamps : 1;	/* Socket is supposed to use TCP time-stamps. This depends on the */
-		} bits;						/* party which opens the connection */
+				bTimeStamps : 1,	/* Socket is supposed to use TCP time-stamps. This depends on the */
+									/* party which opens the connection */
+				bHasRTT : 1;		/* At least one round trip time has been measured */
+		} bits;
 		uint32_t ulFlags;
 	} u;
 	TCPWinSize_t xSize;
@@ -116,7 +169,9 @@ typedef struct xTCP_WINDOW
 	uint32_t ulOurSequenceNumber;		/* The SEQ number we're sending out */
 	uint32_t ulUserDataLength;			/* Number of bytes in Rx buffer which may be passed to the user, after having received a 'missing packet' */
 	uint32_t ulNextTxSequenceNumber;	/* The sequence number given to the next byte to be added for transmission */
-	int32_t lSRTT;						/* Smoothed Round Trip Time, it may increment quickly and it decrements slower */
+	int32_t lSRTT;						/* Smoothed Round Trip Time in ms, see RFC 6298 */
+	int32_t lRTTVar;					/* Variation of the Round Trip Time in ms */
+	int32_t lRTO;						/* Retransmission time-out in ms, it is doubled for every retransmission of a segment */
 	uint8_t ucOptionLength;				/* Number of valid bytes in ulOptionsData[] */
 #if( ipconfigUSE_TCP_WIN == 1 )
 	List_t xPriorityQueue;				/* Priority queue: segments which must be sent immediately */
@@ -126,6 +181,9 @@ typedef struct xTCP_WINDOW
 	uint32_t ulOptionsData[ipSIZE_TCP_OPTIONS/sizeof(uint32_t)];	/* Contains the options we send out */
 	List_t xTxSegments;					/* A linked list of all transmission segments, sorted on sequence number */
 	List_t xRxSegments;					/* A linked list of reception segments, order depends on sequence of arrival */
+	#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+		TCPCongestion_t xCongestion;	/* Congestion window and the state of the congestion control algorithm */
+	#endif
 #else
 	/* For tiny TCP, there is only 1 outstanding TX segment */
 	TCPSegment_t xTxSegment;			/* Priority queue */
@@ -134,6 +192,13 @@ typedef struct xTCP_WINDOW
 	uint16_t usPeerPortNumber;			/* debugging/logging: the peer's TCP port number */
 	uint16_t usMSS;						/* Current accepted MSS */
 	uint16_t usMSSInit;					/* MSS as configured by the socket owner */
+#if( ipconfigUSE_TCP_INFO != 0 )
+	/* Statistics of the connection, see FreeRTOS_GetTCPInfo() */
+	uint32_t ulSegmentsIn;				/* Segments received */
+	uint32_t ulSegmentsOut;				/* Segments sent, including retransmissions */
+	uint32_t ulRetransmits;				/* Segments retransmitted */
+	uint32_t ulDupAcks;					/* Duplicate ACKs received */
+#endif
 } TCPWindow_t;
 
 
@@ -199,12 +264,37 @@ BaseType_t xTCPWindowTxDone( TCPWindow_t *pxWindow );
  * apPos will point to a location with the circular data buffer: txStream */
 uint32_t ulTCPWindowTxGet( TCPWindow_t *pxWindow, uint32_t ulWindowSize, int32_t *plPosition );
 
+#if( ( ipconfigUSE_TCP_WIN == 1 ) && ( ipconfigUSE_DRIVER_OFFLOADS != 0 ) )
+	/* Fetches the segment that directly follows the 'ulLength' bytes returned
+	 * by ulTCPWindowTxGet() and earlier calls, so they can be sent as one long
+	 * frame that the driver segments.  Returns 0 when there is no such segment,
+	 * or when it is longer than 'ulMaxLength' */
+	uint32_t ulTCPWindowTxGetNext( TCPWindow_t *pxWindow, uint32_t ulWindowSize, uint32_t ulLength, uint32_t ulMaxLength );
+#endif
+
 /* Receive a normal ACK */
 uint32_t ulTCPWindowTxAck( TCPWindow_t *pxWindow, uint32_t ulSequenceNumber );
 
 /* Receive a SACK option */
 uint32_t ulTCPWindowTxSack( TCPWindow_t *pxWindow, uint32_t ulFirst, uint32_t ulLast );
 
+/* A new Round Trip Time has been measured, either by the TCP window itself, or
+ * with the help of the TCP time-stamp option.  Updates the retransmission
+ * time-out */
+void vTCPWindowUpdateRTT( TCPWindow_t *pxWindow, int32_t lRoundTripTime );
+
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+	/* Receive an ACK which carries no data and which doesn't change the
+	 * peer's window.  After 3 duplicate ACKs, a fast retransmission takes place */
+	void vTCPWindowTxDupAck( TCPWindow_t *pxWindow, uint32_t ulSequenceNumber );
+#endif
+
+#if( ipconfigUSE_TCP_INFO != 0 )
+	/* Returns the number of bytes that have been sent but that are not yet
+	 * acknowledged */
+	uint32_t ulTCPWindowTxInFlight( const TCPWindow_t *pxWindow );
+#endif
+
 
 #ifdef __cplusplus
 }	/* extern "C" */
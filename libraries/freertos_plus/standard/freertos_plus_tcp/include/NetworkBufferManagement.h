@@ -45,10 +45,78 @@ UBaseType_t uxGetNumberOfFreeNetworkBuffers( void );
 /* Get the lowest number of free network buffers. */
 UBaseType_t uxGetMinimumFreeNetworkBuffers( void );
 
-/* Copy a network buffer into a bigger buffer. */
+/* Statistics about the use of network buffers, only available when
+BufferAllocation_3.c is used.  The counters are not protected, so they may miss
+a count when an interrupt uses the buffers at the same time. */
+typedef struct xNETWORK_BUFFER_STATISTICS
+{
+	UBaseType_t uxFreeBuffers;			/* The current number of free buffers, of any size. */
+	UBaseType_t uxMinimumFreeBuffers;	/* The lowest number of free buffers since start-up. */
+	uint32_t ulSmallAllocations;		/* The number of buffers given out with a small storage. */
+	uint32_t ulFullAllocations;			/* The number of buffers given out with a full-size storage. */
+	uint32_t ulFallbacks;				/* Small requests that were served by a full-size buffer. */
+	uint32_t ulHeapAllocations;			/* Storages obtained with pvPortMalloc() for frames longer than ipTOTAL_ETHERNET_FRAME_SIZE. */
+	uint32_t ulCacheHits;				/* Buffers that the IP-task obtained from its own cache. */
+	uint32_t ulFailures;				/* Requests that could not be served. */
+	uint32_t ulContentions;				/* Updates of the free list that had to be retried. */
+} NetworkBufferStatistics_t;
+
+void vGetNetworkBufferStatistics( NetworkBufferStatistics_t *pxStatistics );
+
+/* Copy a network buffer into a bigger buffer.  A chained payload is copied
+behind the xDataLength bytes of the original, and the new buffer gets that many
+more bytes, so the copy is always contiguous. */
 NetworkBufferDescriptor_t *pxDuplicateNetworkBufferWithDescriptor( NetworkBufferDescriptor_t * const pxNetworkBuffer,
 	BaseType_t xNewLength);
 
+#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+	/* Called when the last reference to a buffer of the application has been
+	released, see vNetworkBufferWrapData(). */
+	typedef void ( * NetworkBufferReleaseFunction_t )( NetworkBufferDescriptor_t *pxNetworkBuffer );
+
+	/*
+	 * Add a reference to a network buffer for an owner that will call
+	 * vReleaseNetworkBufferAndDescriptor() when it is done with it.  A buffer
+	 * is returned to the pool when its last reference is released.  Returns
+	 * pxNetworkBuffer.
+	 */
+	NetworkBufferDescriptor_t *pxNetworkBufferReference( NetworkBufferDescriptor_t * const pxNetworkBuffer );
+
+	/*
+	 * Let the frame in pxNetworkBuffer continue with the uxPayloadLength bytes
+	 * at pucPayload, which lie in pxPayloadBuffer.  The frame takes a reference
+	 * to pxPayloadBuffer, which it drops when it is released or unchained.  The
+	 * length fields in the headers count the payload, 'xDataLength' does not.
+	 * Only a driver that advertises ipOFFLOAD_TX_GATHER may be given such a
+	 * frame.
+	 */
+	void vNetworkBufferChainPayload( NetworkBufferDescriptor_t * const pxNetworkBuffer, NetworkBufferDescriptor_t *pxPayloadBuffer,
+		uint8_t *pucPayload, size_t uxPayloadLength );
+
+	/* Drop the payload that was chained to pxNetworkBuffer, if any. */
+	void vNetworkBufferUnchain( NetworkBufferDescriptor_t * const pxNetworkBuffer );
+
+	/*
+	 * Turn a descriptor of the application, which is not part of the pool,
+	 * into a buffer that holds the uxLength bytes at pucData, so that the data
+	 * can be passed to the stack without copying, e.g. to
+	 * FreeRTOS_send_buffer().  When the last reference is released, from whichever
+	 * task that may be, pxReleaseCallback is called and the data may be used
+	 * again.
+	 */
+	void vNetworkBufferWrapData( NetworkBufferDescriptor_t * const pxNetworkBuffer, uint8_t *pucData, size_t uxLength,
+		NetworkBufferReleaseFunction_t pxReleaseCallback );
+
+	/*
+	 * For the buffer allocation schemes: drop one reference to pxNetworkBuffer.
+	 * When it was the last one, the chained payload is released and pdTRUE is
+	 * returned if the buffer must go back to the pool.  pdFALSE is returned
+	 * when the buffer is still referenced, or when it was handed back to the
+	 * application that owns it.
+	 */
+	BaseType_t xNetworkBufferReleaseReference( NetworkBufferDescriptor_t * const pxNetworkBuffer );
+#endif /* ipconfigUSE_NETWORK_BUFFER_CHAINS */
+
 /* Increase the size of a Network Buffer.
 In case BufferAllocation_2.c is used, the new space must be allocated. */
 NetworkBufferDescriptor_t *pxResizeNetworkBufferWithDescriptor( NetworkBufferDescriptor_t * pxNetworkBuffer,
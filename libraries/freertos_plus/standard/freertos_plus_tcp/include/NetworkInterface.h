@@ -36,6 +36,58 @@ BaseType_t xNetworkInterfaceOutput( NetworkBufferDescriptor_t * const pxNetworkB
 void vNetworkInterfaceAllocateRAMToBuffers( NetworkBufferDescriptor_t pxNetworkBuffers[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ] );
 BaseType_t xGetPhyLinkStatus( void );
 
+/*
+ * Called by a driver to pass received frames to the IP-task.  With
+ * ipconfigUSE_LINKED_RX_MESSAGES, 'pxFirstBuffer' may be the first of a chain
+ * that is linked through 'pxNextBuffer' and terminated by NULL; otherwise it is
+ * a single frame.  When the IP-task can not be reached within 'xTimeout', all
+ * buffers are released and pdFAIL is returned.
+ */
+BaseType_t xSendNetworkBuffersToIPTask( NetworkBufferDescriptor_t *pxFirstBuffer, TickType_t xTimeout );
+
+#if( ipconfigUSE_DRIVER_OFFLOADS != 0 )
+	/* The work that a driver can take over from the stack. */
+	#define ipOFFLOAD_TX_CHECKSUM		( 0x0001U )	/* The driver sets the IP and protocol checksums of outgoing frames. */
+	#define ipOFFLOAD_RX_CHECKSUM		( 0x0002U )	/* The driver drops incoming frames with a bad IP or protocol checksum. */
+	#define ipOFFLOAD_TCP_SEGMENTATION	( 0x0004U )	/* The driver cuts long TCP frames into segments, see 'usSegmentSize'. */
+	#define ipOFFLOAD_TX_GATHER			( 0x0008U )	/* The driver sends frames with a chained payload, see 'pxPayloadBuffer'. */
+
+	/*
+	 * A TCP frame is only longer than the MTU when the driver advertised
+	 * ipOFFLOAD_TCP_SEGMENTATION.  Its 'usSegmentSize' is then non-zero, and the
+	 * driver sends it as a series of segments that each carry at most
+	 * 'usSegmentSize' bytes of payload.  Every segment gets a copy of the
+	 * headers, with the sequence number, the IP length and identification, and
+	 * both checksums adapted.  Only the last segment keeps the PSH and FIN
+	 * flags.  Segmentation implies ipOFFLOAD_TX_CHECKSUM for these frames.
+	 *
+	 * With ipconfigUSE_NETWORK_BUFFER_CHAINS, a driver that advertised
+	 * ipOFFLOAD_TX_GATHER may get a frame of which 'pxPayloadBuffer' is not
+	 * NULL.  It must send the 'xDataLength' bytes of the buffer followed by the
+	 * 'uxPayloadLength' bytes at 'pucPayload', pad the frame to the minimum
+	 * length, and set the checksums: gathering also implies
+	 * ipOFFLOAD_TX_CHECKSUM for these frames.  Releasing the buffer releases
+	 * the payload.  When a driver also segments, a long frame may be chained.
+	 */
+	#if( ipconfigUSE_MULTI_INTERFACE == 0 )
+		/*
+		 * Called by the driver, normally from xNetworkInterfaceInitialise(), to
+		 * advertise its offloads as a combination of the ipOFFLOAD_ flags.
+		 * 'uxMaxFrameLength' is the longest Ethernet frame that it accepts for
+		 * segmentation.  With more interfaces, each NetworkInterface_t has its
+		 * own 'uxOffloads' and 'uxMaxFrameLength' fields instead.
+		 */
+		void FreeRTOS_SetNetworkOffloads( UBaseType_t uxOffloads, size_t uxMaxFrameLength );
+	#endif
+#endif /* ipconfigUSE_DRIVER_OFFLOADS */
+
+#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+	/* When more than one interface is used xNetworkInterfaceInitialise() and
+	xNetworkInterfaceOutput() are implemented by FreeRTOS_Routing.c, which
+	dispatches to the NetworkInterface_t of each registered driver. */
+	#include "FreeRTOS_Routing.h"
+#endif
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
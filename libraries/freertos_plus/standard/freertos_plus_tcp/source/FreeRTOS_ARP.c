@@ -45,6 +45,7 @@
 #endif /* ipconfigUSE_LLMNR */
 #include "NetworkInterface.h"
 #include "NetworkBufferManagement.h"
+#include "FreeRTOS_Routing.h"
 
 
 /* When the age of an entry in the ARP table reaches this value (it counts down
@@ -57,6 +58,10 @@ entry is still valid and can therefore be refreshed. */
 	#define arpGRATUITOUS_ARP_PERIOD					( pdMS_TO_TICKS( 20000 ) )
 #endif
 
+#if( ( ipconfigARP_HASH_TABLE_SIZE & ( ipconfigARP_HASH_TABLE_SIZE - 1 ) ) != 0 )
+	#error ipconfigARP_HASH_TABLE_SIZE must be a power of 2
+#endif
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -64,11 +69,67 @@ entry is still valid and can therefore be refreshed. */
  */
 static eARPLookupResult_t prvCacheLookup( uint32_t ulAddressToLookup, MACAddress_t * const pxMACAddress );
 
+/*
+ * Returns pdTRUE if ulIPAddress is on a subnet that is reached directly,
+ * without passing a router.
+ */
+static BaseType_t prvIsOnLocalNetwork( uint32_t ulIPAddress );
+
+/*
+ * Return the index of the row that holds ulIPAddress, or -1 if there is none.
+ */
+static BaseType_t prvFindEntry( uint32_t ulIPAddress );
+
+/*
+ * Give row x a new IP address, and mark it as the most recently used row.
+ */
+static void prvSetEntryAddress( BaseType_t x, uint32_t ulIPAddress );
+
+/*
+ * Wipe out row x, releasing the packets that it holds.
+ */
+static void prvClearEntry( BaseType_t x );
+
+#if( ipconfigARP_HASH_TABLE_SIZE > 0 )
+
+	/*
+	 * Return the hash bucket in which ulIPAddress is stored.
+	 */
+	static List_t *prvHashBucket( uint32_t ulIPAddress );
+
+	/*
+	 * Return a free row, or else clear and return the least recently used
+	 * row.
+	 */
+	static BaseType_t prvGetFreeEntry( void );
+
+#endif /* ipconfigARP_HASH_TABLE_SIZE */
+
+#if( ipconfigARP_QUEUE_LENGTH > 0 )
+
+	/*
+	 * Row x has just become valid, send the packets that were waiting for it.
+	 */
+	static void prvSendWaitingPackets( BaseType_t x );
+
+#endif /* ipconfigARP_QUEUE_LENGTH */
+
 /*-----------------------------------------------------------*/
 
 /* The ARP cache. */
 static ARPCacheRow_t xARPCache[ ipconfigARP_CACHE_ENTRIES ];
 
+#if( ipconfigARP_HASH_TABLE_SIZE > 0 )
+	/* The rows that hold an IP address, hashed on that address. */
+	static List_t xARPHashTable[ ipconfigARP_HASH_TABLE_SIZE ];
+
+	/* The rows that hold an IP address, the least recently used first. */
+	static List_t xARPUsedList;
+
+	/* The rows that don't hold an IP address. */
+	static List_t xARPFreeList;
+#endif /* ipconfigARP_HASH_TABLE_SIZE */
+
 /* The time at which the last gratuitous ARP was sent.  Gratuitous ARPs are used
 to ensure ARP tables are up to date and to detect IP address conflicts. */
 static TickType_t xLastGratuitousARPTime = ( TickType_t ) 0;
@@ -110,6 +171,8 @@ eFrameProcessingResult_t eARPProcessPacket( ARPPacket_t * const pxARPFrame )
 eFrameProcessingResult_t eReturn = eReleaseBuffer;
 ARPHeader_t *pxARPHeader;
 uint32_t ulTargetProtocolAddress, ulSenderProtocolAddress;
+uint32_t ulLocalIPAddress = *ipLOCAL_IP_ADDRESS_POINTER;
+const uint8_t *pucLocalMACAddress = ipLOCAL_MAC_ADDRESS;
 
 	pxARPHeader = &( pxARPFrame->xARPHeader );
 
@@ -120,16 +183,30 @@ uint32_t ulTargetProtocolAddress, ulSenderProtocolAddress;
 
 	traceARP_PACKET_RECEIVED();
 
+	#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+	{
+	NetworkEndPoint_t *pxEndPoint = FreeRTOS_FindEndPointOnIP( ulTargetProtocolAddress );
+
+		/* Answer with the addresses of the end-point that is asked for.  When
+		the packet is not for any end-point, the primary end-point is used. */
+		if( pxEndPoint != NULL )
+		{
+			ulLocalIPAddress = pxEndPoint->ulIPAddress;
+			pucLocalMACAddress = pxEndPoint->xMACAddress.ucBytes;
+		}
+	}
+	#endif /* ipconfigUSE_MULTI_INTERFACE */
+
 	/* Don't do anything if the local IP address is zero because
 	that means a DHCP request has not completed. */
-	if( *ipLOCAL_IP_ADDRESS_POINTER != 0UL )
+	if( ulLocalIPAddress != 0UL )
 	{
 		switch( pxARPHeader->usOperation )
 		{
 			case ipARP_REQUEST	:
 				/* The packet contained an ARP request.  Was it for the IP
 				address of the node running this code? */
-				if( ulTargetProtocolAddress == *ipLOCAL_IP_ADDRESS_POINTER )
+				if( ulTargetProtocolAddress == ulLocalIPAddress )
 				{
 					iptraceSENDING_ARP_REPLY( ulSenderProtocolAddress );
 
@@ -153,8 +230,8 @@ uint32_t ulTargetProtocolAddress, ulSenderProtocolAddress;
 						memcpy( pxARPHeader->xTargetHardwareAddress.ucBytes, pxARPHeader->xSenderHardwareAddress.ucBytes, sizeof( MACAddress_t ) );
 						pxARPHeader->ulTargetProtocolAddress = ulSenderProtocolAddress;
 					}
-					memcpy( pxARPHeader->xSenderHardwareAddress.ucBytes, ( void * ) ipLOCAL_MAC_ADDRESS, sizeof( MACAddress_t ) );
-					memcpy( ( void* )pxARPHeader->ucSenderProtocolAddress, ( void* )ipLOCAL_IP_ADDRESS_POINTER, sizeof( pxARPHeader->ucSenderProtocolAddress ) );
+					memcpy( pxARPHeader->xSenderHardwareAddress.ucBytes, ( const void * ) pucLocalMACAddress, sizeof( MACAddress_t ) );
+					memcpy( ( void* )pxARPHeader->ucSenderProtocolAddress, ( void* )&ulLocalIPAddress, sizeof( pxARPHeader->ucSenderProtocolAddress ) );
 
 					eReturn = eReturnEthernetFrame;
 				}
@@ -166,7 +243,7 @@ uint32_t ulTargetProtocolAddress, ulSenderProtocolAddress;
 				/* Process received ARP frame to see if there is a clash. */
 				#if( ipconfigARP_USE_CLASH_DETECTION != 0 )
 				{
-					if( ulSenderProtocolAddress == *ipLOCAL_IP_ADDRESS_POINTER )
+					if( ulSenderProtocolAddress == ulLocalIPAddress )
 					{
 						xARPHadIPClash = pdTRUE;
 						memcpy( xARPClashMacAddress.ucBytes, pxARPHeader->xSenderHardwareAddress.ucBytes, sizeof( xARPClashMacAddress.ucBytes ) );
@@ -198,7 +275,7 @@ uint32_t ulTargetProtocolAddress, ulSenderProtocolAddress;
 			if( ( memcmp( xARPCache[ x ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 ) )
 			{
 				lResult = xARPCache[ x ].ulIPAddress;
-				memset( &xARPCache[ x ], '\0', sizeof( xARPCache[ x ] ) );
+				prvClearEntry( x );
 				break;
 			}
 		}
@@ -221,7 +298,7 @@ uint8_t ucMinAgeFound = 0U;
 		/* Only process the IP address if it is on the local network.
 		Unless: when '*ipLOCAL_IP_ADDRESS_POINTER' equals zero, the IP-address
 		and netmask are still unknown. */
-		if( ( ( ulIPAddress & xNetworkAddressing.ulNetMask ) == ( ( *ipLOCAL_IP_ADDRESS_POINTER ) & xNetworkAddressing.ulNetMask ) ) ||
+		if( ( prvIsOnLocalNetwork( ulIPAddress ) != pdFALSE ) ||
 			( *ipLOCAL_IP_ADDRESS_POINTER == 0ul ) )
 	#else
 		/* If ipconfigARP_STORES_REMOTE_ADDRESSES is non-zero, IP addresses with
@@ -233,6 +310,30 @@ uint8_t ucMinAgeFound = 0U;
 		if( pdTRUE )
 	#endif
 	{
+		#if( ipconfigARP_HASH_TABLE_SIZE > 0 )
+		{
+			/* The most common case, an IP address that is known with the same
+			MAC address, does not need to look at the other rows. */
+			x = prvFindEntry( ulIPAddress );
+
+			if( ( x >= 0 ) &&
+				( pxMACAddress != NULL ) &&
+				( memcmp( xARPCache[ x ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 ) )
+			{
+				xARPCache[ x ].ucAge = ( uint8_t ) ipconfigMAX_ARP_AGE;
+				xARPCache[ x ].ucValid = ( uint8_t ) pdTRUE;
+				prvSetEntryAddress( x, ulIPAddress );
+
+				#if( ipconfigARP_QUEUE_LENGTH > 0 )
+				{
+					prvSendWaitingPackets( x );
+				}
+				#endif
+				return;
+			}
+		}
+		#endif /* ipconfigARP_HASH_TABLE_SIZE */
+
 		/* Start with the maximum possible number. */
 		ucMinAgeFound--;
 
@@ -261,6 +362,12 @@ uint8_t ucMinAgeFound = 0U;
 					optimisation. */
 					xARPCache[ x ].ucAge = ( uint8_t ) ipconfigMAX_ARP_AGE;
 					xARPCache[ x ].ucValid = ( uint8_t ) pdTRUE;
+
+					#if( ipconfigARP_QUEUE_LENGTH > 0 )
+					{
+						prvSendWaitingPackets( x );
+					}
+					#endif
 					return;
 				}
 
@@ -281,8 +388,8 @@ uint8_t ucMinAgeFound = 0U;
 				network, than the MAC address of the gateway should not be
 				overwritten. */
 				BaseType_t bIsLocal[ 2 ];
-				bIsLocal[ 0 ] = ( ( xARPCache[ x ].ulIPAddress & xNetworkAddressing.ulNetMask ) == ( ( *ipLOCAL_IP_ADDRESS_POINTER ) & xNetworkAddressing.ulNetMask ) );
-				bIsLocal[ 1 ] = ( ( ulIPAddress & xNetworkAddressing.ulNetMask ) == ( ( *ipLOCAL_IP_ADDRESS_POINTER ) & xNetworkAddressing.ulNetMask ) );
+				bIsLocal[ 0 ] = prvIsOnLocalNetwork( xARPCache[ x ].ulIPAddress );
+				bIsLocal[ 1 ] = prvIsOnLocalNetwork( ulIPAddress );
 				if( bIsLocal[ 0 ] == bIsLocal[ 1 ] )
 				{
 					xMacEntry = x;
@@ -291,6 +398,7 @@ uint8_t ucMinAgeFound = 0U;
 				xMacEntry = x;
 	#endif
 			}
+	#if( ipconfigARP_HASH_TABLE_SIZE == 0 )
 			/* _HT_
 			Shouldn't we test for xARPCache[ x ].ucValid == pdFALSE here ? */
 			else if( xARPCache[ x ].ucAge < ucMinAgeFound )
@@ -302,28 +410,56 @@ uint8_t ucMinAgeFound = 0U;
 				ucMinAgeFound = xARPCache[ x ].ucAge;
 				xUseEntry = x;
 			}
+	#endif /* ipconfigARP_HASH_TABLE_SIZE == 0 */
 		}
 
 		if( xMacEntry >= 0 )
 		{
 			xUseEntry = xMacEntry;
-
-			if( xIpEntry >= 0 )
-			{
-				/* Both the MAC address as well as the IP address were found in
-				different locations: clear the entry which matches the
-				IP-address */
-				memset( &xARPCache[ xIpEntry ], '\0', sizeof( xARPCache[ xIpEntry ] ) );
-			}
 		}
 		else if( xIpEntry >= 0 )
 		{
 			/* An entry containing the IP-address was found, but it had a different MAC address */
 			xUseEntry = xIpEntry;
 		}
+	#if( ipconfigARP_HASH_TABLE_SIZE > 0 )
+		else
+		{
+			/* Use a free row, or replace the least recently used one. */
+			xUseEntry = prvGetFreeEntry();
+		}
+	#endif
 
 		/* If the entry was not found, we use the oldest entry and set the IPaddress */
-		xARPCache[ xUseEntry ].ulIPAddress = ulIPAddress;
+		prvSetEntryAddress( xUseEntry, ulIPAddress );
+
+		if( ( xMacEntry >= 0 ) && ( xIpEntry >= 0 ) )
+		{
+			/* Both the MAC address as well as the IP address were found in
+			different locations: clear the entry which matches the
+			IP-address, after taking over the packets that it holds. */
+			#if( ipconfigARP_QUEUE_LENGTH > 0 )
+			{
+			ListItem_t *pxItem;
+
+				while( listLIST_IS_EMPTY( &( xARPCache[ xIpEntry ].xWaitingPackets ) ) == pdFALSE )
+				{
+					pxItem = listGET_HEAD_ENTRY( &( xARPCache[ xIpEntry ].xWaitingPackets ) );
+					( void ) uxListRemove( pxItem );
+					vListInsertEnd( &( xARPCache[ xUseEntry ].xWaitingPackets ), pxItem );
+				}
+			}
+			#endif /* ipconfigARP_QUEUE_LENGTH */
+			prvClearEntry( xIpEntry );
+		}
+
+		#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+		{
+			/* Remember on which end-point the neighbour was found, so the
+			entry can be flushed when the link of its interface goes down. */
+			xARPCache[ xUseEntry ].pxEndPoint = FreeRTOS_FindRoute( ulIPAddress, NULL );
+		}
+		#endif /* ipconfigUSE_MULTI_INTERFACE */
 
 		if( pxMACAddress != NULL )
 		{
@@ -333,6 +469,12 @@ uint8_t ucMinAgeFound = 0U;
 			/* And this entry does not need immediate attention */
 			xARPCache[ xUseEntry ].ucAge = ( uint8_t ) ipconfigMAX_ARP_AGE;
 			xARPCache[ xUseEntry ].ucValid = ( uint8_t ) pdTRUE;
+
+			#if( ipconfigARP_QUEUE_LENGTH > 0 )
+			{
+				prvSendWaitingPackets( xUseEntry );
+			}
+			#endif
 		}
 		else if( xIpEntry < 0 )
 		{
@@ -368,6 +510,26 @@ uint8_t ucMinAgeFound = 0U;
 
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvIsOnLocalNetwork( uint32_t ulIPAddress )
+{
+BaseType_t xReturn;
+
+	#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+	{
+		xReturn = ( FreeRTOS_FindEndPointOnNetMask( ulIPAddress ) != NULL ) ? pdTRUE : pdFALSE;
+	}
+	#else
+	{
+		xReturn = ( ( ulIPAddress & xNetworkAddressing.ulNetMask ) == ( ( *ipLOCAL_IP_ADDRESS_POINTER ) & xNetworkAddressing.ulNetMask ) ) ? pdTRUE : pdFALSE;
+	}
+	#endif /* ipconfigUSE_MULTI_INTERFACE */
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_MULTI_INTERFACE == 0 )
+
 eARPLookupResult_t eARPGetCacheEntry( uint32_t *pulIPAddress, MACAddress_t * const pxMACAddress )
 {
 eARPLookupResult_t eReturn;
@@ -444,9 +606,11 @@ uint32_t ulAddressToLookup;
 			{
 				eReturn = prvCacheLookup( ulAddressToLookup, pxMACAddress );
 
-				if( eReturn == eARPCacheMiss )
+				if( eReturn != eARPCacheHit )
 				{
-					/* It might be that the ARP has to go to the gateway. */
+					/* It might be that the ARP has to go to the gateway.  Also
+					when an ARP request is outstanding, the caller may want to
+					wait for the reply of the next hop. */
 					*pulIPAddress = ulAddressToLookup;
 				}
 			}
@@ -456,6 +620,105 @@ uint32_t ulAddressToLookup;
 	return eReturn;
 }
 
+#else /* ipconfigUSE_MULTI_INTERFACE */
+
+eARPLookupResult_t eARPGetCacheEntry( uint32_t *pulIPAddress, MACAddress_t * const pxMACAddress )
+{
+	return eARPGetCacheEntryOnEndPoint( pulIPAddress, pxMACAddress, NULL );
+}
+/*-----------------------------------------------------------*/
+
+eARPLookupResult_t eARPGetCacheEntryOnEndPoint( uint32_t *pulIPAddress, MACAddress_t * const pxMACAddress, struct xNetworkEndPoint **ppxEndPoint )
+{
+eARPLookupResult_t eReturn;
+NetworkEndPoint_t *pxEndPoint;
+uint32_t ulNextHop = *pulIPAddress;
+
+	for( pxEndPoint = FreeRTOS_FirstEndPoint(); pxEndPoint != NULL; pxEndPoint = pxEndPoint->pxNext )
+	{
+		/* Is it a local broadcast address, eg 192.168.1.255? */
+		if( ( pxEndPoint->ulIPAddress != 0UL ) && ( *pulIPAddress == pxEndPoint->ulBroadcastAddress ) )
+		{
+			break;
+		}
+	}
+
+	if( ( pxEndPoint != NULL ) ||
+	#if( ipconfigUSE_LLMNR == 1 )
+		( *pulIPAddress == ipLLMNR_IP_ADDR ) ||
+	#endif
+		( *pulIPAddress == ipBROADCAST_IP_ADDRESS ) )
+	{
+		if( pxEndPoint == NULL )
+		{
+			/* General broadcasts, which are used by DHCP, and LLMNR are sent
+			from the primary end-point. */
+			pxEndPoint = FreeRTOS_FirstEndPoint();
+		}
+
+		#if( ipconfigUSE_LLMNR == 1 )
+		if( *pulIPAddress == ipLLMNR_IP_ADDR )
+		{
+			/* The LLMNR IP-address has a fixed virtual MAC address. */
+			memcpy( pxMACAddress->ucBytes, xLLMNR_MacAdress.ucBytes, sizeof( MACAddress_t ) );
+		}
+		else
+		#endif
+		{
+			memcpy( pxMACAddress->ucBytes, xBroadcastMACAddress.ucBytes, sizeof( MACAddress_t ) );
+		}
+		eReturn = eARPCacheHit;
+	}
+	else
+	{
+		/* Find the end-point and the next hop: either the address itself
+		or a router. */
+		pxEndPoint = FreeRTOS_FindRoute( *pulIPAddress, &ulNextHop );
+
+		if( pxEndPoint == NULL )
+		{
+			/* There is no route, or the interface is down. */
+			eReturn = eCantSendPacket;
+		}
+		else
+		{
+			eReturn = eARPCacheMiss;
+
+			#if( ipconfigARP_STORES_REMOTE_ADDRESSES == 1 )
+			{
+				if( ulNextHop != *pulIPAddress )
+				{
+					/* The MAC address of remote addresses might be stored. */
+					eReturn = prvCacheLookup( *pulIPAddress, pxMACAddress );
+				}
+			}
+			#endif
+
+			if( eReturn != eARPCacheHit )
+			{
+				eReturn = prvCacheLookup( ulNextHop, pxMACAddress );
+
+				if( eReturn != eARPCacheHit )
+				{
+					/* It might be that the ARP has to go to the gateway.  Also
+					when an ARP request is outstanding, the caller may want to
+					wait for the reply of the next hop. */
+					*pulIPAddress = ulNextHop;
+				}
+			}
+		}
+	}
+
+	if( ppxEndPoint != NULL )
+	{
+		*ppxEndPoint = pxEndPoint;
+	}
+
+	return eReturn;
+}
+
+#endif /* ipconfigUSE_MULTI_INTERFACE */
+
 /*-----------------------------------------------------------*/
 
 static eARPLookupResult_t prvCacheLookup( uint32_t ulAddressToLookup, MACAddress_t * const pxMACAddress )
@@ -463,30 +726,262 @@ static eARPLookupResult_t prvCacheLookup( uint32_t ulAddressToLookup, MACAddress
 BaseType_t x;
 eARPLookupResult_t eReturn = eARPCacheMiss;
 
-	/* Loop through each entry in the ARP cache. */
-	for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+	/* Does a row in the ARP cache table hold an entry for the IP address
+	being queried? */
+	x = prvFindEntry( ulAddressToLookup );
+
+	if( x >= 0 )
 	{
-		/* Does this row in the ARP cache table hold an entry for the IP address
-		being queried? */
-		if( xARPCache[ x ].ulIPAddress == ulAddressToLookup )
+		/* A matching valid entry was found. */
+		if( xARPCache[ x ].ucValid == ( uint8_t ) pdFALSE )
 		{
-			/* A matching valid entry was found. */
-			if( xARPCache[ x ].ucValid == ( uint8_t ) pdFALSE )
+			/* This entry is waiting an ARP reply, so is not valid. */
+			eReturn = eCantSendPacket;
+		}
+		else
+		{
+			/* A valid entry was found. */
+			memcpy( pxMACAddress->ucBytes, xARPCache[ x ].xMACAddress.ucBytes, sizeof( MACAddress_t ) );
+			eReturn = eARPCacheHit;
+
+			#if( ipconfigARP_HASH_TABLE_SIZE > 0 )
 			{
-				/* This entry is waiting an ARP reply, so is not valid. */
-				eReturn = eCantSendPacket;
+				/* Move the row to the end of the LRU list. */
+				prvSetEntryAddress( x, ulAddressToLookup );
 			}
-			else
+			#endif
+		}
+	}
+
+	return eReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvFindEntry( uint32_t ulIPAddress )
+{
+BaseType_t xResult = -1;
+
+	#if( ipconfigARP_HASH_TABLE_SIZE > 0 )
+	{
+	const List_t *pxBucket = prvHashBucket( ulIPAddress );
+	const ListItem_t *pxIterator;
+	const MiniListItem_t *pxEnd = ( const MiniListItem_t* )listGET_END_MARKER( pxBucket );
+	const ARPCacheRow_t *pxRow;
+
+		/* Only the rows in one bucket need to be compared. */
+		for( pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxEnd );
+			 pxIterator != ( const ListItem_t * ) pxEnd;
+			 pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+		{
+			pxRow = ( const ARPCacheRow_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+
+			if( pxRow->ulIPAddress == ulIPAddress )
 			{
-				/* A valid entry was found. */
-				memcpy( pxMACAddress->ucBytes, xARPCache[ x ].xMACAddress.ucBytes, sizeof( MACAddress_t ) );
-				eReturn = eARPCacheHit;
+				xResult = ( BaseType_t ) ( pxRow - xARPCache );
+				break;
 			}
-			break;
 		}
 	}
+	#else
+	{
+	BaseType_t x;
 
-	return eReturn;
+		/* Loop through each entry in the ARP cache. */
+		for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+		{
+			if( xARPCache[ x ].ulIPAddress == ulIPAddress )
+			{
+				xResult = x;
+				break;
+			}
+		}
+	}
+	#endif /* ipconfigARP_HASH_TABLE_SIZE */
+
+	return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetEntryAddress( BaseType_t x, uint32_t ulIPAddress )
+{
+	if( xARPCache[ x ].ulIPAddress != ulIPAddress )
+	{
+		/* Forget the previous address, and the packets that were waiting for
+		it. */
+		prvClearEntry( x );
+		xARPCache[ x ].ulIPAddress = ulIPAddress;
+
+		#if( ipconfigARP_HASH_TABLE_SIZE > 0 )
+		{
+			vListInsertEnd( prvHashBucket( ulIPAddress ), &( xARPCache[ x ].xHashListItem ) );
+		}
+		#endif
+	}
+
+	#if( ipconfigARP_HASH_TABLE_SIZE > 0 )
+	{
+		/* The row becomes the most recently used one. */
+		( void ) uxListRemove( &( xARPCache[ x ].xLRUListItem ) );
+		vListInsertEnd( &xARPUsedList, &( xARPCache[ x ].xLRUListItem ) );
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvClearEntry( BaseType_t x )
+{
+	#if( ipconfigARP_QUEUE_LENGTH > 0 )
+	{
+	NetworkBufferDescriptor_t *pxNetworkBuffer;
+
+		while( listLIST_IS_EMPTY( &( xARPCache[ x ].xWaitingPackets ) ) == pdFALSE )
+		{
+			pxNetworkBuffer = ( NetworkBufferDescriptor_t * ) listGET_OWNER_OF_HEAD_ENTRY( &( xARPCache[ x ].xWaitingPackets ) );
+			( void ) uxListRemove( &( pxNetworkBuffer->xBufferListItem ) );
+			vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+		}
+	}
+	#endif /* ipconfigARP_QUEUE_LENGTH */
+
+	#if( ipconfigARP_HASH_TABLE_SIZE > 0 )
+	{
+		if( listLIST_ITEM_CONTAINER( &( xARPCache[ x ].xHashListItem ) ) != NULL )
+		{
+			( void ) uxListRemove( &( xARPCache[ x ].xHashListItem ) );
+		}
+
+		if( listLIST_ITEM_CONTAINER( &( xARPCache[ x ].xLRUListItem ) ) != &xARPFreeList )
+		{
+			( void ) uxListRemove( &( xARPCache[ x ].xLRUListItem ) );
+			vListInsertEnd( &xARPFreeList, &( xARPCache[ x ].xLRUListItem ) );
+		}
+	}
+	#endif /* ipconfigARP_HASH_TABLE_SIZE */
+
+	/* The list items and the queue must survive, so the fields are cleared
+	one by one. */
+	xARPCache[ x ].ulIPAddress = 0UL;
+	memset( xARPCache[ x ].xMACAddress.ucBytes, '\0', sizeof( xARPCache[ x ].xMACAddress.ucBytes ) );
+	xARPCache[ x ].ucAge = 0U;
+	xARPCache[ x ].ucValid = ( uint8_t ) pdFALSE;
+
+	#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+	{
+		xARPCache[ x ].pxEndPoint = NULL;
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+#if( ipconfigARP_HASH_TABLE_SIZE > 0 )
+
+	static List_t *prvHashBucket( uint32_t ulIPAddress )
+	{
+	uint32_t ulHash = ulIPAddress;
+
+		/* Fold the address, so all of its bytes contribute to the index. */
+		ulHash ^= ulHash >> 16;
+		ulHash ^= ulHash >> 8;
+
+		return &( xARPHashTable[ ulHash & ( ( uint32_t ) ipconfigARP_HASH_TABLE_SIZE - 1UL ) ] );
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvGetFreeEntry( void )
+	{
+	const ARPCacheRow_t *pxRow;
+	BaseType_t x;
+
+		if( listLIST_IS_EMPTY( &xARPFreeList ) == pdFALSE )
+		{
+			pxRow = ( const ARPCacheRow_t * ) listGET_OWNER_OF_HEAD_ENTRY( &xARPFreeList );
+			x = ( BaseType_t ) ( pxRow - xARPCache );
+		}
+		else
+		{
+			/* The cache is full, evict the row that was used least recently. */
+			pxRow = ( const ARPCacheRow_t * ) listGET_OWNER_OF_HEAD_ENTRY( &xARPUsedList );
+			x = ( BaseType_t ) ( pxRow - xARPCache );
+			prvClearEntry( x );
+		}
+
+		return x;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigARP_HASH_TABLE_SIZE */
+
+#if( ipconfigARP_QUEUE_LENGTH > 0 )
+
+	BaseType_t xARPWaitForResolution( NetworkBufferDescriptor_t * const pxNetworkBuffer, uint32_t ulIPAddress )
+	{
+	BaseType_t x;
+	BaseType_t xReturn = pdFALSE;
+
+		x = prvFindEntry( ulIPAddress );
+
+		if( ( x >= 0 ) &&
+			( xARPCache[ x ].ucValid == ( uint8_t ) pdFALSE ) &&
+			( listCURRENT_LIST_LENGTH( &( xARPCache[ x ].xWaitingPackets ) ) < ( UBaseType_t ) ipconfigARP_QUEUE_LENGTH ) )
+		{
+			vListInsertEnd( &( xARPCache[ x ].xWaitingPackets ), &( pxNetworkBuffer->xBufferListItem ) );
+			xReturn = pdTRUE;
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvSendWaitingPackets( BaseType_t x )
+	{
+	NetworkBufferDescriptor_t *pxNetworkBuffer;
+
+		while( listLIST_IS_EMPTY( &( xARPCache[ x ].xWaitingPackets ) ) == pdFALSE )
+		{
+			/* The MAC address is known now, so the packet will be sent and
+			not come back to this list. */
+			pxNetworkBuffer = ( NetworkBufferDescriptor_t * ) listGET_OWNER_OF_HEAD_ENTRY( &( xARPCache[ x ].xWaitingPackets ) );
+			( void ) uxListRemove( &( pxNetworkBuffer->xBufferListItem ) );
+			vProcessGeneratedUDPPacket( pxNetworkBuffer );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigARP_QUEUE_LENGTH */
+
+void vARPInitialiseCache( void )
+{
+BaseType_t x;
+
+	#if( ipconfigARP_HASH_TABLE_SIZE > 0 )
+	{
+		for( x = 0; x < ( BaseType_t ) ipconfigARP_HASH_TABLE_SIZE; x++ )
+		{
+			vListInitialise( &( xARPHashTable[ x ] ) );
+		}
+		vListInitialise( &xARPUsedList );
+		vListInitialise( &xARPFreeList );
+	}
+	#endif /* ipconfigARP_HASH_TABLE_SIZE */
+
+	for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+	{
+		#if( ipconfigARP_HASH_TABLE_SIZE > 0 )
+		{
+			vListInitialiseItem( &( xARPCache[ x ].xHashListItem ) );
+			listSET_LIST_ITEM_OWNER( &( xARPCache[ x ].xHashListItem ), ( void * ) &( xARPCache[ x ] ) );
+			vListInitialiseItem( &( xARPCache[ x ].xLRUListItem ) );
+			listSET_LIST_ITEM_OWNER( &( xARPCache[ x ].xLRUListItem ), ( void * ) &( xARPCache[ x ] ) );
+			vListInsertEnd( &xARPFreeList, &( xARPCache[ x ].xLRUListItem ) );
+		}
+		#endif /* ipconfigARP_HASH_TABLE_SIZE */
+
+		#if( ipconfigARP_QUEUE_LENGTH > 0 )
+		{
+			vListInitialise( &( xARPCache[ x ].xWaitingPackets ) );
+		}
+		#endif /* ipconfigARP_QUEUE_LENGTH */
+	}
 }
 /*-----------------------------------------------------------*/
 
@@ -498,6 +993,18 @@ TickType_t xTimeNow;
 	/* Loop through each entry in the ARP cache. */
 	for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
 	{
+		#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+		{
+			/* Flush the entries that were learned on an interface which
+			lost its link, as in prvProcessNetworkDownEvent(). */
+			if( ( xARPCache[ x ].pxEndPoint != NULL ) &&
+				( xARPCache[ x ].pxEndPoint->pxNetworkInterface->xLinkUp == pdFALSE ) )
+			{
+				prvClearEntry( x );
+			}
+		}
+		#endif /* ipconfigUSE_MULTI_INTERFACE */
+
 		/* If the entry is valid (its age is greater than zero). */
 		if( xARPCache[ x ].ucAge > 0U )
 		{
@@ -527,7 +1034,7 @@ TickType_t xTimeNow;
 			{
 				/* The entry is no longer valid.  Wipe it out. */
 				iptraceARP_TABLE_ENTRY_EXPIRED( xARPCache[ x ].ulIPAddress );
-				xARPCache[ x ].ulIPAddress = 0UL;
+				prvClearEntry( x );
 			}
 		}
 	}
@@ -536,7 +1043,24 @@ TickType_t xTimeNow;
 
 	if( ( xLastGratuitousARPTime == ( TickType_t ) 0 ) || ( ( xTimeNow - xLastGratuitousARPTime ) > ( TickType_t ) arpGRATUITOUS_ARP_PERIOD ) )
 	{
-		FreeRTOS_OutputARPRequest( *ipLOCAL_IP_ADDRESS_POINTER );
+		#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+		{
+		NetworkEndPoint_t *pxEndPoint;
+
+			/* Announce each end-point on its own interface. */
+			for( pxEndPoint = FreeRTOS_FirstEndPoint(); pxEndPoint != NULL; pxEndPoint = pxEndPoint->pxNext )
+			{
+				if( pxEndPoint->ulIPAddress != 0UL )
+				{
+					FreeRTOS_OutputARPRequest( pxEndPoint->ulIPAddress );
+				}
+			}
+		}
+		#else
+		{
+			FreeRTOS_OutputARPRequest( *ipLOCAL_IP_ADDRESS_POINTER );
+		}
+		#endif /* ipconfigUSE_MULTI_INTERFACE */
 		xLastGratuitousARPTime = xTimeNow;
 	}
 }
@@ -564,6 +1088,19 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 	if( pxNetworkBuffer != NULL )
 	{
 		pxNetworkBuffer->ulIPAddress = ulIPAddress;
+
+		#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+		{
+			/* Gratuitous ARPs are sent by the end-point that owns the address,
+			other requests by the end-point on the subnet of the target. */
+			pxNetworkBuffer->pxEndPoint = FreeRTOS_FindEndPointOnIP( ulIPAddress );
+			if( pxNetworkBuffer->pxEndPoint == NULL )
+			{
+				pxNetworkBuffer->pxEndPoint = FreeRTOS_FindRoute( ulIPAddress, NULL );
+			}
+		}
+		#endif /* ipconfigUSE_MULTI_INTERFACE */
+
 		vARPGenerateRequestPacket( pxNetworkBuffer );
 
 		#if defined( ipconfigETHERNET_MINIMUM_PACKET_BYTES )
@@ -581,6 +1118,7 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 		}
 		#endif
 
+		ipCAPTURE_SENT( pxNetworkBuffer );
 		xNetworkInterfaceOutput( pxNetworkBuffer, pdTRUE );
 	}
 }
@@ -588,9 +1126,22 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 void vARPGenerateRequestPacket( NetworkBufferDescriptor_t * const pxNetworkBuffer )
 {
 ARPPacket_t *pxARPPacket;
+const uint8_t *pucLocalMACAddress = ipLOCAL_MAC_ADDRESS;
+const uint32_t *pulLocalIPAddress = ipLOCAL_IP_ADDRESS_POINTER;
 
 	pxARPPacket = ( ARPPacket_t * ) pxNetworkBuffer->pucEthernetBuffer;
 
+	#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+	{
+		/* Use the addresses of the end-point that sends the request. */
+		if( pxNetworkBuffer->pxEndPoint != NULL )
+		{
+			pucLocalMACAddress = pxNetworkBuffer->pxEndPoint->xMACAddress.ucBytes;
+			pulLocalIPAddress = &( pxNetworkBuffer->pxEndPoint->ulIPAddress );
+		}
+	}
+	#endif /* ipconfigUSE_MULTI_INTERFACE */
+
 	/* memcpy the const part of the header information into the correct
 	location in the packet.  This copies:
 		xEthernetHeader.ulDestinationAddress
@@ -603,10 +1154,10 @@ ARPPacket_t *pxARPPacket;
 		xARPHeader.xTargetHardwareAddress;
 	*/
 	memcpy( ( void * ) pxARPPacket, ( void * ) xDefaultPartARPPacketHeader, sizeof( xDefaultPartARPPacketHeader ) );
-	memcpy( ( void * ) pxARPPacket->xEthernetHeader.xSourceAddress.ucBytes , ( void * ) ipLOCAL_MAC_ADDRESS, ( size_t ) ipMAC_ADDRESS_LENGTH_BYTES );
-	memcpy( ( void * ) pxARPPacket->xARPHeader.xSenderHardwareAddress.ucBytes, ( void * ) ipLOCAL_MAC_ADDRESS, ( size_t ) ipMAC_ADDRESS_LENGTH_BYTES );
+	memcpy( ( void * ) pxARPPacket->xEthernetHeader.xSourceAddress.ucBytes , ( const void * ) pucLocalMACAddress, ( size_t ) ipMAC_ADDRESS_LENGTH_BYTES );
+	memcpy( ( void * ) pxARPPacket->xARPHeader.xSenderHardwareAddress.ucBytes, ( const void * ) pucLocalMACAddress, ( size_t ) ipMAC_ADDRESS_LENGTH_BYTES );
 
-	memcpy( ( void* )pxARPPacket->xARPHeader.ucSenderProtocolAddress, ( void* )ipLOCAL_IP_ADDRESS_POINTER, sizeof( pxARPPacket->xARPHeader.ucSenderProtocolAddress ) );
+	memcpy( ( void* )pxARPPacket->xARPHeader.ucSenderProtocolAddress, ( const void* )pulLocalIPAddress, sizeof( pxARPPacket->xARPHeader.ucSenderProtocolAddress ) );
 	pxARPPacket->xARPHeader.ulTargetProtocolAddress = pxNetworkBuffer->ulIPAddress;
 
 	pxNetworkBuffer->xDataLength = sizeof( ARPPacket_t );
@@ -617,7 +1168,12 @@ ARPPacket_t *pxARPPacket;
 
 void FreeRTOS_ClearARP( void )
 {
-	memset( xARPCache, '\0', sizeof( xARPCache ) );
+BaseType_t x;
+
+	for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+	{
+		prvClearEntry( x );
+	}
 }
 /*-----------------------------------------------------------*/
 
@@ -651,3 +1207,11 @@ void FreeRTOS_ClearARP( void )
 	}
 
 #endif /* ( ipconfigHAS_PRINTF != 0 ) || ( ipconfigHAS_DEBUG_PRINTF != 0 ) */
+
+/*-----------------------------------------------------------*/
+
+/* Provide access to private members for testing. */
+#ifdef AMAZON_FREERTOS_ENABLE_UNIT_TESTS
+	#include "iot_freertos_tcp_test_access_arp_define.h"
+#endif
+
@@ -0,0 +1,484 @@
+/*
+ * FreeRTOS+TCP V2.0.11
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ * FreeRTOS_Capture.c
+ * Capture of the Ethernet frames that are received and sent, when
+ * ipconfigUSE_PCAP_CAPTURE is set to 1, see FreeRTOS_Capture.h.
+ *
+ * The frames are stored in the ring buffer in the form in which they are
+ * exported: as pcapng Enhanced Packet Blocks, in host byte order, which the
+ * reader recognises from the byte-order magic of the Section Header Block.
+ * An export writes a Section Header Block and an Interface Description Block,
+ * followed by the contents of the ring, so it needs no memory of its own.
+ *
+ * All blocks have a length that is a multiple of 4, and so has the ring, so
+ * the 32-bit fields of a block never wrap around the end of the ring.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_IP_Private.h"
+#include "FreeRTOS_Capture.h"
+
+/* Exclude the entire file if capturing is not used. */
+#if( ipconfigUSE_PCAP_CAPTURE != 0 )
+
+/* The pcapng block types that are used. */
+#define capBLOCK_SECTION_HEADER			( 0x0A0D0D0AUL )
+#define capBLOCK_INTERFACE				( 0x00000001UL )
+#define capBLOCK_ENHANCED_PACKET		( 0x00000006UL )
+
+#define capBYTE_ORDER_MAGIC				( 0x1A2B3C4DUL )
+#define capLINKTYPE_ETHERNET			( 1U )
+
+/* The 'epb_flags' option tells the direction of a frame. */
+#define capOPTION_END					( 0U )
+#define capOPTION_EPB_FLAGS				( 2U )
+#define capFLAGS_INBOUND				( 0x00000001UL )
+#define capFLAGS_OUTBOUND				( 0x00000002UL )
+
+/* The lengths of the fixed parts of the blocks, in bytes. */
+#define capSECTION_HEADER_LENGTH		( 28U )
+#define capINTERFACE_LENGTH				( 20U )
+#define capPACKET_HEADER_LENGTH			( 28U )
+#define capPACKET_TRAILER_LENGTH		( 16U )
+
+/* The offset of the 'Block Total Length' field of a block. */
+#define capBLOCK_LENGTH_OFFSET			( 4U )
+
+/* Round a length up to a multiple of 4 bytes. */
+#define capPAD4( uxLength )				( ( ( uxLength ) + 3U ) & ~( ( size_t ) 3U ) )
+
+#define capRING_SIZE					( ( size_t ) ipconfigPCAP_CAPTURE_BUFFER_SIZE )
+
+/* The state of the capture.  It is changed by the IP-task and by the API
+functions, always with the scheduler suspended. */
+typedef struct xCAPTURE_STATE
+{
+	CaptureFilter_t xFilter;	/* The frames that are captured. */
+	size_t uxSnapLength;		/* The longest part of a frame that is stored, or 0. */
+	size_t uxHead;				/* The offset at which the next block is written. */
+	size_t uxTail;				/* The offset of the oldest block. */
+	size_t uxUsed;				/* The number of bytes that hold blocks. */
+	uint32_t ulStored;			/* The number of blocks in the ring. */
+	uint32_t ulLost;			/* Frames that were overwritten or too long. */
+	BaseType_t xActive;			/* pdTRUE while frames are captured. */
+} CaptureState_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Returns pdTRUE when the frame at pucFrame, of which uxLength bytes are
+ * contiguous, is selected by the filter.
+ */
+static BaseType_t prvCaptureMatches( const uint8_t *pucFrame, size_t uxLength );
+
+/*
+ * Copy uxLength bytes to the ring at offset uxOffset, wrapping around its end.
+ * Returns the offset that follows the bytes.
+ */
+static size_t prvRingWrite( size_t uxOffset, const void *pvData, size_t uxLength );
+
+/*
+ * Write the frame in pxNetworkBuffer to the ring as an Enhanced Packet Block
+ * of uxBlockLength bytes, of which uxCaptureLength bytes are frame data.
+ */
+static void prvRingWriteFrame( const NetworkBufferDescriptor_t *pxNetworkBuffer, size_t uxFrameLength,
+	size_t uxCaptureLength, size_t uxBlockLength, BaseType_t xOutgoing );
+
+/*-----------------------------------------------------------*/
+
+/* The ring buffer, as 32-bit words so that the fields of a block are
+aligned. */
+static uint32_t ulCaptureRing[ capRING_SIZE / sizeof( uint32_t ) ];
+
+static CaptureState_t xCapture;
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCaptureMatches( const uint8_t *pucFrame, size_t uxLength )
+{
+const CaptureFilter_t *pxFilter = &( xCapture.xFilter );
+const EthernetHeader_t *pxEthernetHeader = ( const EthernetHeader_t * ) pucFrame;
+const IPHeader_t *pxIPHeader;
+size_t uxPortOffset;
+uint16_t usPorts[ 2 ];
+BaseType_t xReturn = pdTRUE;
+
+	if( uxLength < ipSIZE_OF_ETH_HEADER )
+	{
+		xReturn = pdFALSE;
+	}
+	else if( ( pxFilter->usFrameType != 0U ) && ( pxEthernetHeader->usFrameType != pxFilter->usFrameType ) )
+	{
+		xReturn = pdFALSE;
+	}
+	else if( ( pxFilter->ucProtocol == 0U ) && ( pxFilter->ulIPAddress == 0UL ) && ( pxFilter->usPort == 0U ) )
+	{
+		/* The frame type is all that is checked. */
+	}
+	else if( ( pxEthernetHeader->usFrameType != ipIPv4_FRAME_TYPE ) || ( uxLength < ( ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER ) ) )
+	{
+		xReturn = pdFALSE;
+	}
+	else
+	{
+		pxIPHeader = ( const IPHeader_t * ) &( pucFrame[ ipSIZE_OF_ETH_HEADER ] );
+
+		if( ( pxFilter->ucProtocol != 0U ) && ( pxIPHeader->ucProtocol != pxFilter->ucProtocol ) )
+		{
+			xReturn = pdFALSE;
+		}
+		else if( ( pxFilter->ulIPAddress != 0UL ) &&
+				 ( pxIPHeader->ulSourceIPAddress != pxFilter->ulIPAddress ) &&
+				 ( pxIPHeader->ulDestinationIPAddress != pxFilter->ulIPAddress ) )
+		{
+			xReturn = pdFALSE;
+		}
+		else if( pxFilter->usPort != 0U )
+		{
+			/* The source and destination ports are the first fields of both
+			the TCP and the UDP header. */
+			uxPortOffset = ipSIZE_OF_ETH_HEADER + ( ( size_t ) ( pxIPHeader->ucVersionHeaderLength & 0x0FU ) << 2 );
+
+			if( ( ( pxIPHeader->ucProtocol != ( uint8_t ) ipPROTOCOL_TCP ) && ( pxIPHeader->ucProtocol != ( uint8_t ) ipPROTOCOL_UDP ) ) ||
+				( ( uxPortOffset + sizeof( usPorts ) ) > uxLength ) )
+			{
+				xReturn = pdFALSE;
+			}
+			else
+			{
+				memcpy( usPorts, &( pucFrame[ uxPortOffset ] ), sizeof( usPorts ) );
+
+				if( ( usPorts[ 0 ] != pxFilter->usPort ) && ( usPorts[ 1 ] != pxFilter->usPort ) )
+				{
+					xReturn = pdFALSE;
+				}
+			}
+		}
+		else
+		{
+			/* The frame matches. */
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvRingWrite( size_t uxOffset, const void *pvData, size_t uxLength )
+{
+uint8_t *pucRing = ( uint8_t * ) ulCaptureRing;
+const uint8_t *pucData = ( const uint8_t * ) pvData;
+size_t uxFirst = capRING_SIZE - uxOffset;
+
+	if( uxFirst > uxLength )
+	{
+		uxFirst = uxLength;
+	}
+
+	memcpy( &( pucRing[ uxOffset ] ), pucData, uxFirst );
+
+	if( uxFirst < uxLength )
+	{
+		memcpy( pucRing, &( pucData[ uxFirst ] ), uxLength - uxFirst );
+	}
+
+	return ( uxOffset + uxLength ) % capRING_SIZE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRingWriteFrame( const NetworkBufferDescriptor_t *pxNetworkBuffer, size_t uxFrameLength,
+	size_t uxCaptureLength, size_t uxBlockLength, BaseType_t xOutgoing )
+{
+uint32_t ulHeader[ capPACKET_HEADER_LENGTH / sizeof( uint32_t ) ];
+uint32_t ulTrailer[ capPACKET_TRAILER_LENGTH / sizeof( uint32_t ) ];
+uint16_t usOption[ 2 ];
+uint64_t ullTime = ipconfigPCAP_TIME_US();
+size_t uxOffset = xCapture.uxHead;
+size_t uxCopy;
+const uint32_t ulZero = 0UL;
+
+	ulHeader[ 0 ] = capBLOCK_ENHANCED_PACKET;
+	ulHeader[ 1 ] = ( uint32_t ) uxBlockLength;
+	ulHeader[ 2 ] = 0UL;	/* The interface ID. */
+	ulHeader[ 3 ] = ( uint32_t ) ( ullTime >> 32 );
+	ulHeader[ 4 ] = ( uint32_t ) ullTime;
+	ulHeader[ 5 ] = ( uint32_t ) uxCaptureLength;
+	ulHeader[ 6 ] = ( uint32_t ) uxFrameLength;
+	uxOffset = prvRingWrite( uxOffset, ulHeader, sizeof( ulHeader ) );
+
+	/* The contiguous part of the frame first, then the payload that may be
+	chained to it. */
+	uxCopy = ( pxNetworkBuffer->xDataLength < uxCaptureLength ) ? pxNetworkBuffer->xDataLength : uxCaptureLength;
+	uxOffset = prvRingWrite( uxOffset, pxNetworkBuffer->pucEthernetBuffer, uxCopy );
+
+	#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+	{
+		if( uxCopy < uxCaptureLength )
+		{
+			uxOffset = prvRingWrite( uxOffset, pxNetworkBuffer->pucPayload, uxCaptureLength - uxCopy );
+		}
+	}
+	#endif /* ipconfigUSE_NETWORK_BUFFER_CHAINS */
+
+	uxOffset = prvRingWrite( uxOffset, &ulZero, capPAD4( uxCaptureLength ) - uxCaptureLength );
+
+	usOption[ 0 ] = capOPTION_EPB_FLAGS;
+	usOption[ 1 ] = ( uint16_t ) sizeof( uint32_t );
+	memcpy( &( ulTrailer[ 0 ] ), usOption, sizeof( usOption ) );
+	ulTrailer[ 1 ] = ( xOutgoing != pdFALSE ) ? capFLAGS_OUTBOUND : capFLAGS_INBOUND;
+	usOption[ 0 ] = capOPTION_END;
+	usOption[ 1 ] = 0U;
+	memcpy( &( ulTrailer[ 2 ] ), usOption, sizeof( usOption ) );
+	ulTrailer[ 3 ] = ( uint32_t ) uxBlockLength;
+	( void ) prvRingWrite( uxOffset, ulTrailer, sizeof( ulTrailer ) );
+}
+/*-----------------------------------------------------------*/
+
+void vCaptureFrame( const NetworkBufferDescriptor_t *pxNetworkBuffer, BaseType_t xOutgoing )
+{
+size_t uxFrameLength, uxCaptureLength, uxBlockLength;
+uint32_t ulOldest;
+
+	/* Most of the time no capture is running, that is checked first. */
+	if( xCapture.xActive != pdFALSE )
+	{
+		uxFrameLength = pxNetworkBuffer->xDataLength;
+
+		#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+		{
+			uxFrameLength += pxNetworkBuffer->uxPayloadLength;
+		}
+		#endif
+
+		vTaskSuspendAll();
+		{
+			/* The capture may have been stopped in the mean time. */
+			if( ( xCapture.xActive != pdFALSE ) &&
+				( prvCaptureMatches( pxNetworkBuffer->pucEthernetBuffer, pxNetworkBuffer->xDataLength ) != pdFALSE ) )
+			{
+				uxCaptureLength = uxFrameLength;
+
+				if( ( xCapture.uxSnapLength != 0U ) && ( uxCaptureLength > xCapture.uxSnapLength ) )
+				{
+					uxCaptureLength = xCapture.uxSnapLength;
+				}
+
+				uxBlockLength = capPACKET_HEADER_LENGTH + capPAD4( uxCaptureLength ) + capPACKET_TRAILER_LENGTH;
+
+				if( uxBlockLength > capRING_SIZE )
+				{
+					xCapture.ulLost++;
+				}
+				else
+				{
+					/* Make room by dropping the oldest frames. */
+					while( ( capRING_SIZE - xCapture.uxUsed ) < uxBlockLength )
+					{
+						ulOldest = ulCaptureRing[ ( ( xCapture.uxTail + capBLOCK_LENGTH_OFFSET ) % capRING_SIZE ) / sizeof( uint32_t ) ];
+						xCapture.uxTail = ( xCapture.uxTail + ( size_t ) ulOldest ) % capRING_SIZE;
+						xCapture.uxUsed -= ( size_t ) ulOldest;
+						xCapture.ulStored--;
+						xCapture.ulLost++;
+					}
+
+					prvRingWriteFrame( pxNetworkBuffer, uxFrameLength, uxCaptureLength, uxBlockLength, xOutgoing );
+					xCapture.uxHead = ( xCapture.uxHead + uxBlockLength ) % capRING_SIZE;
+					xCapture.uxUsed += uxBlockLength;
+					xCapture.ulStored++;
+				}
+			}
+		}
+		( void ) xTaskResumeAll();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void FreeRTOS_CaptureStart( const CaptureFilter_t *pxFilter, size_t uxSnapLength )
+{
+	vTaskSuspendAll();
+	{
+		if( pxFilter != NULL )
+		{
+			memcpy( &( xCapture.xFilter ), pxFilter, sizeof( xCapture.xFilter ) );
+		}
+		else
+		{
+			memset( &( xCapture.xFilter ), '\0', sizeof( xCapture.xFilter ) );
+		}
+
+		xCapture.uxSnapLength = uxSnapLength;
+		xCapture.uxHead = 0U;
+		xCapture.uxTail = 0U;
+		xCapture.uxUsed = 0U;
+		xCapture.ulStored = 0UL;
+		xCapture.ulLost = 0UL;
+		xCapture.xActive = pdTRUE;
+	}
+	( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void FreeRTOS_CaptureStop( void )
+{
+	xCapture.xActive = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_CaptureExport( CaptureWriteFunction_t pxWrite, void *pvContext )
+{
+uint32_t ulSection[ capSECTION_HEADER_LENGTH / sizeof( uint32_t ) ];
+uint32_t ulInterface[ capINTERFACE_LENGTH / sizeof( uint32_t ) ];
+uint16_t usPair[ 2 ];
+const uint8_t *pucRing = ( const uint8_t * ) ulCaptureRing;
+size_t uxTail, uxUsed, uxFirst;
+BaseType_t xWasActive, xResult;
+
+	/* Pause the capture, so the ring doesn't change while it is being
+	read. */
+	vTaskSuspendAll();
+	{
+		xWasActive = xCapture.xActive;
+		xCapture.xActive = pdFALSE;
+		uxTail = xCapture.uxTail;
+		uxUsed = xCapture.uxUsed;
+	}
+	( void ) xTaskResumeAll();
+
+	ulSection[ 0 ] = capBLOCK_SECTION_HEADER;
+	ulSection[ 1 ] = capSECTION_HEADER_LENGTH;
+	ulSection[ 2 ] = capBYTE_ORDER_MAGIC;
+	usPair[ 0 ] = 1U;	/* Major version. */
+	usPair[ 1 ] = 0U;	/* Minor version. */
+	memcpy( &( ulSection[ 3 ] ), usPair, sizeof( usPair ) );
+	/* The length of the section is not specified. */
+	ulSection[ 4 ] = 0xFFFFFFFFUL;
+	ulSection[ 5 ] = 0xFFFFFFFFUL;
+	ulSection[ 6 ] = capSECTION_HEADER_LENGTH;
+
+	ulInterface[ 0 ] = capBLOCK_INTERFACE;
+	ulInterface[ 1 ] = capINTERFACE_LENGTH;
+	usPair[ 0 ] = capLINKTYPE_ETHERNET;
+	usPair[ 1 ] = 0U;
+	memcpy( &( ulInterface[ 2 ] ), usPair, sizeof( usPair ) );
+	ulInterface[ 3 ] = ( uint32_t ) xCapture.uxSnapLength;
+	ulInterface[ 4 ] = capINTERFACE_LENGTH;
+
+	xResult = pxWrite( pvContext, ( const uint8_t * ) ulSection, sizeof( ulSection ) );
+
+	if( xResult != pdFAIL )
+	{
+		xResult = pxWrite( pvContext, ( const uint8_t * ) ulInterface, sizeof( ulInterface ) );
+	}
+
+	uxFirst = capRING_SIZE - uxTail;
+
+	if( uxFirst > uxUsed )
+	{
+		uxFirst = uxUsed;
+	}
+
+	if( ( xResult != pdFAIL ) && ( uxFirst != 0U ) )
+	{
+		xResult = pxWrite( pvContext, &( pucRing[ uxTail ] ), uxFirst );
+	}
+
+	if( ( xResult != pdFAIL ) && ( uxFirst < uxUsed ) )
+	{
+		xResult = pxWrite( pvContext, pucRing, uxUsed - uxFirst );
+	}
+
+	xCapture.xActive = xWasActive;
+
+	if( xResult != pdFAIL )
+	{
+		xResult = ( BaseType_t ) ( sizeof( ulSection ) + sizeof( ulInterface ) + uxUsed );
+	}
+	else
+	{
+		xResult = -pdFREERTOS_ERRNO_EIO;
+	}
+
+	return xResult;
+}
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP == 1 )
+
+	static BaseType_t prvCaptureSocketWrite( void *pvContext, const uint8_t *pucData, size_t uxLength )
+	{
+	Socket_t xSocket = ( Socket_t ) pvContext;
+	BaseType_t xSent, xResult = pdPASS;
+
+		while( uxLength > 0U )
+		{
+			xSent = FreeRTOS_send( xSocket, pucData, uxLength, 0 );
+
+			if( xSent <= 0 )
+			{
+				/* The connection was lost, or the time-out expired. */
+				xResult = pdFAIL;
+				break;
+			}
+
+			pucData += xSent;
+			uxLength -= ( size_t ) xSent;
+		}
+
+		return xResult;
+	}
+	/*-----------------------------------------------------------*/
+
+	BaseType_t FreeRTOS_CaptureSend( Socket_t xSocket )
+	{
+		return FreeRTOS_CaptureExport( prvCaptureSocketWrite, ( void * ) xSocket );
+	}
+
+#endif /* ipconfigUSE_TCP */
+/*-----------------------------------------------------------*/
+
+void FreeRTOS_CaptureGetCounts( uint32_t *pulStored, uint32_t *pulLost )
+{
+	vTaskSuspendAll();
+	{
+		*pulStored = xCapture.ulStored;
+		*pulLost = xCapture.ulLost;
+	}
+	( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_PCAP_CAPTURE */
@@ -0,0 +1,421 @@
+/*
+ * FreeRTOS+TCP V2.0.11
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ * FreeRTOS_Checksum.c
+ * The Internet checksum (RFC 1071) when ipconfigUSE_CHECKSUM_KERNELS is set to
+ * 1.  It replaces the generic usGenerateChecksum() of FreeRTOS_IP.c by a
+ * version that sums many bytes per instruction, and adds a routine that
+ * calculates the checksum while copying.
+ *
+ * The kernel is chosen at compile time, from the macros that the compiler
+ * defines for the target:
+ *
+ *   Cortex-M with Helium (MVE)   16 bytes per step, summed across the vector.
+ *   Cortex-A with NEON           16 bytes per step, pairwise into 32-bit lanes.
+ *   x86 with AVX2                32 bytes per step, widened to 32-bit lanes.
+ *   x86 with SSE2                16 bytes per step, widened to 32-bit lanes.
+ *   Any other CPU                32-bit words, added into a 64-bit sum.
+ *
+ * The generic kernel does not count carries like the original loop does; on
+ * Cortex-M3/M4/M7 the 64-bit additions compile to ADDS/ADC pairs.  The DSP
+ * extension of the Cortex-M4 has no use here, its 16-bit SIMD additions drop
+ * the carries that the checksum needs.
+ *
+ * All kernels sum the data as 16-bit words in the byte order of the CPU.  The
+ * one's complement sum does not depend on the byte order, so the result only
+ * has to be swapped once, at the end.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+
+/* Exclude the entire file if the generic checksum of FreeRTOS_IP.c is used. */
+#if( ipconfigUSE_CHECKSUM_KERNELS != 0 )
+
+#if defined( __ARM_FEATURE_MVE )
+	#include <arm_mve.h>
+	#define csumUSE_HELIUM		1
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+	#include <arm_neon.h>
+	#define csumUSE_NEON		1
+#elif defined( __AVX2__ )
+	#include <immintrin.h>
+	#define csumUSE_AVX2		1
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+	#include <emmintrin.h>
+	#define csumUSE_SSE2		1
+#endif
+
+/* The vector kernels add 16-bit words into 32-bit lanes.  After this many
+steps the lanes are added to the 64-bit sum, long before they can overflow. */
+#define csumMAX_VECTOR_STEPS	( 4096U )
+
+/* Access to the bytes of a 16-bit word, in memory order. */
+typedef union xUNION16
+{
+	uint16_t u16;
+	uint8_t u8[ 2 ];
+} xUnion16;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Returns the sum of the 16-bit words in pucData, as loaded by the CPU.  A
+ * last odd byte is added as if it was followed by a zero.  pucData must be
+ * 16-bit aligned.  The sum is not folded.
+ */
+static uint64_t prvChecksumKernel( const uint8_t *pucData, size_t uxLength );
+
+/*
+ * The same for the last few bytes of a block, at any alignment.
+ */
+static uint64_t prvChecksumTail( const uint8_t *pucData, size_t uxLength );
+
+/*
+ * Fold a sum into 16 bits, adding the carries back in.
+ */
+static uint16_t prvFold( uint64_t ullSum );
+
+/*
+ * Returns the folded sum of the 16-bit words in pucData, at any alignment.
+ */
+static uint16_t prvChecksumAt( const uint8_t *pucData, size_t uxLength );
+
+/*
+ * Copy pucSource to pucTarget and return the sum of the copied data, like
+ * prvChecksumKernel() does.  Both may have any alignment.
+ */
+static uint64_t prvCopyKernel( uint8_t *pucTarget, const uint8_t *pucSource, size_t uxLength );
+
+/*-----------------------------------------------------------*/
+
+static uint16_t prvFold( uint64_t ullSum )
+{
+uint64_t ullFolded = ullSum;
+
+	/* Each fold adds the carries back in, until only 16 bits are left. */
+	ullFolded = ( ullFolded & 0xffffffffULL ) + ( ullFolded >> 32 );
+	ullFolded = ( ullFolded & 0xffffULL ) + ( ullFolded >> 16 );
+	ullFolded = ( ullFolded & 0xffffULL ) + ( ullFolded >> 16 );
+	ullFolded = ( ullFolded & 0xffffULL ) + ( ullFolded >> 16 );
+
+	return ( uint16_t ) ullFolded;
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvChecksumTail( const uint8_t *pucData, size_t uxLength )
+{
+uint64_t ullSum = 0ULL;
+size_t uxIndex;
+xUnion16 xTerm;
+
+	for( uxIndex = 0U; ( uxIndex + 1U ) < uxLength; uxIndex += 2U )
+	{
+		xTerm.u8[ 0 ] = pucData[ uxIndex ];
+		xTerm.u8[ 1 ] = pucData[ uxIndex + 1U ];
+		ullSum += xTerm.u16;
+	}
+
+	if( ( uxLength & 1U ) != 0U )
+	{
+		xTerm.u8[ 0 ] = pucData[ uxLength - 1U ];
+		xTerm.u8[ 1 ] = 0U;
+		ullSum += xTerm.u16;
+	}
+
+	return ullSum;
+}
+/*-----------------------------------------------------------*/
+
+#if defined( csumUSE_HELIUM )
+
+	static uint64_t prvChecksumKernel( const uint8_t *pucData, size_t uxLength )
+	{
+	const uint8_t *pucSource = pucData;
+	size_t uxRemaining = uxLength;
+	uint64_t ullSum = 0ULL;
+	uint32_t ulSum, ulSteps;
+
+		while( uxRemaining >= 16U )
+		{
+			ulSum = 0UL;
+
+			/* Every step adds at most 8 * 0xffff, so 4096 steps fit in 32
+			bits. */
+			for( ulSteps = 0U; ( ulSteps < csumMAX_VECTOR_STEPS ) && ( uxRemaining >= 16U ); ulSteps++ )
+			{
+				ulSum = vaddvaq_u16( ulSum, vld1q_u16( ( const uint16_t * ) pucSource ) );
+				pucSource += 16;
+				uxRemaining -= 16U;
+			}
+
+			ullSum += ulSum;
+		}
+
+		return ullSum + prvChecksumTail( pucSource, uxRemaining );
+	}
+
+#elif defined( csumUSE_NEON )
+
+	static uint64_t prvChecksumKernel( const uint8_t *pucData, size_t uxLength )
+	{
+	const uint8_t *pucSource = pucData;
+	size_t uxRemaining = uxLength;
+	uint64x2_t xSum64 = vdupq_n_u64( 0ULL );
+	uint32x4_t xSum32;
+	uint32_t ulSteps;
+
+		while( uxRemaining >= 16U )
+		{
+			xSum32 = vdupq_n_u32( 0UL );
+
+			/* Each lane receives two 16-bit words per step. */
+			for( ulSteps = 0U; ( ulSteps < csumMAX_VECTOR_STEPS ) && ( uxRemaining >= 16U ); ulSteps++ )
+			{
+				xSum32 = vpadalq_u16( xSum32, vld1q_u16( ( const uint16_t * ) pucSource ) );
+				pucSource += 16;
+				uxRemaining -= 16U;
+			}
+
+			xSum64 = vpadalq_u32( xSum64, xSum32 );
+		}
+
+		return vgetq_lane_u64( xSum64, 0 ) + vgetq_lane_u64( xSum64, 1 ) + prvChecksumTail( pucSource, uxRemaining );
+	}
+
+#elif defined( csumUSE_AVX2 )
+
+	static uint64_t prvChecksumKernel( const uint8_t *pucData, size_t uxLength )
+	{
+	const uint8_t *pucSource = pucData;
+	size_t uxRemaining = uxLength;
+	const __m256i xZero = _mm256_setzero_si256();
+	__m256i xSum64 = xZero, xSum32, xData;
+	uint64_t ullLanes[ 4 ];
+	uint32_t ulSteps;
+
+		while( uxRemaining >= 32U )
+		{
+			xSum32 = xZero;
+
+			/* Widen the 16-bit words to 32 bits before adding them.  The
+			unpack instructions work within each 128-bit half, which does not
+			matter for a sum. */
+			for( ulSteps = 0U; ( ulSteps < csumMAX_VECTOR_STEPS ) && ( uxRemaining >= 32U ); ulSteps++ )
+			{
+				xData = _mm256_loadu_si256( ( const __m256i * ) pucSource );
+				xSum32 = _mm256_add_epi32( xSum32, _mm256_unpacklo_epi16( xData, xZero ) );
+				xSum32 = _mm256_add_epi32( xSum32, _mm256_unpackhi_epi16( xData, xZero ) );
+				pucSource += 32;
+				uxRemaining -= 32U;
+			}
+
+			xSum64 = _mm256_add_epi64( xSum64, _mm256_unpacklo_epi32( xSum32, xZero ) );
+			xSum64 = _mm256_add_epi64( xSum64, _mm256_unpackhi_epi32( xSum32, xZero ) );
+		}
+
+		_mm256_storeu_si256( ( __m256i * ) ullLanes, xSum64 );
+
+		return ullLanes[ 0 ] + ullLanes[ 1 ] + ullLanes[ 2 ] + ullLanes[ 3 ] + prvChecksumTail( pucSource, uxRemaining );
+	}
+
+#elif defined( csumUSE_SSE2 )
+
+	static uint64_t prvChecksumKernel( const uint8_t *pucData, size_t uxLength )
+	{
+	const uint8_t *pucSource = pucData;
+	size_t uxRemaining = uxLength;
+	const __m128i xZero = _mm_setzero_si128();
+	__m128i xSum64 = xZero, xSum32, xData;
+	uint64_t ullLanes[ 2 ];
+	uint32_t ulSteps;
+
+		while( uxRemaining >= 16U )
+		{
+			xSum32 = xZero;
+
+			/* Widen the 16-bit words to 32 bits before adding them. */
+			for( ulSteps = 0U; ( ulSteps < csumMAX_VECTOR_STEPS ) && ( uxRemaining >= 16U ); ulSteps++ )
+			{
+				xData = _mm_loadu_si128( ( const __m128i * ) pucSource );
+				xSum32 = _mm_add_epi32( xSum32, _mm_unpacklo_epi16( xData, xZero ) );
+				xSum32 = _mm_add_epi32( xSum32, _mm_unpackhi_epi16( xData, xZero ) );
+				pucSource += 16;
+				uxRemaining -= 16U;
+			}
+
+			xSum64 = _mm_add_epi64( xSum64, _mm_unpacklo_epi32( xSum32, xZero ) );
+			xSum64 = _mm_add_epi64( xSum64, _mm_unpackhi_epi32( xSum32, xZero ) );
+		}
+
+		_mm_storeu_si128( ( __m128i * ) ullLanes, xSum64 );
+
+		return ullLanes[ 0 ] + ullLanes[ 1 ] + prvChecksumTail( pucSource, uxRemaining );
+	}
+
+#else /* Generic kernel. */
+
+	static uint64_t prvChecksumKernel( const uint8_t *pucData, size_t uxLength )
+	{
+	const uint8_t *pucSource = pucData;
+	const uint32_t *pulSource;
+	size_t uxRemaining = uxLength;
+	uint64_t ullSum = 0ULL;
+
+		/* Reach a 32-bit boundary with one 16-bit word. */
+		if( ( ( ( uintptr_t ) pucSource & 2U ) != 0U ) && ( uxRemaining >= 2U ) )
+		{
+			ullSum += *( ( const uint16_t * ) pucSource );
+			pucSource += 2;
+			uxRemaining -= 2U;
+		}
+
+		pulSource = ( const uint32_t * ) pucSource;
+
+		/* A 64-bit sum can take 2^32 words without overflowing, so there is
+		no need to count the carries. */
+		while( uxRemaining >= 16U )
+		{
+			ullSum += ( uint64_t ) pulSource[ 0 ] + pulSource[ 1 ] + pulSource[ 2 ] + pulSource[ 3 ];
+			pulSource += 4;
+			uxRemaining -= 16U;
+		}
+
+		while( uxRemaining >= 4U )
+		{
+			ullSum += pulSource[ 0 ];
+			pulSource++;
+			uxRemaining -= 4U;
+		}
+
+		return ullSum + prvChecksumTail( ( const uint8_t * ) pulSource, uxRemaining );
+	}
+
+#endif /* csumUSE_HELIUM etc. */
+/*-----------------------------------------------------------*/
+
+static uint16_t prvChecksumAt( const uint8_t *pucData, size_t uxLength )
+{
+uint16_t usSum;
+xUnion16 xTerm;
+
+	if( ( ( ( uintptr_t ) pucData & 1U ) != 0U ) && ( uxLength >= 1U ) )
+	{
+		/* The data starts at an odd address.  Sum it as if it started one
+		byte earlier, with a zero, and swap the result back. */
+		xTerm.u8[ 0 ] = 0U;
+		xTerm.u8[ 1 ] = pucData[ 0 ];
+		usSum = prvFold( prvChecksumKernel( &( pucData[ 1 ] ), uxLength - 1U ) + xTerm.u16 );
+		usSum = ( uint16_t ) ( ( usSum << 8 ) | ( usSum >> 8 ) );
+	}
+	else
+	{
+		usSum = prvFold( prvChecksumKernel( pucData, uxLength ) );
+	}
+
+	return usSum;
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvCopyKernel( uint8_t *pucTarget, const uint8_t *pucSource, size_t uxLength )
+{
+size_t uxOffset = 0U, uxBlock;
+uint64_t ullSum = 0ULL;
+
+	#if !defined( csumUSE_HELIUM ) && !defined( csumUSE_NEON ) && !defined( csumUSE_AVX2 ) && !defined( csumUSE_SSE2 )
+	{
+	const uint32_t *pulSource = ( const uint32_t * ) pucSource;
+	uint32_t *pulTarget = ( uint32_t * ) pucTarget;
+	uint32_t ulWord;
+
+		if( ( ( ( uintptr_t ) pucSource | ( uintptr_t ) pucTarget ) & 3U ) == 0U )
+		{
+			/* Both are 32-bit aligned: every word is loaded once, and stored
+			and added straight away. */
+			while( ( uxLength - uxOffset ) >= 4U )
+			{
+				ulWord = *( pulSource++ );
+				*( pulTarget++ ) = ulWord;
+				ullSum += ulWord;
+				uxOffset += 4U;
+			}
+		}
+	}
+	#endif
+
+	/* Otherwise sum every block just after it has been copied, while it is
+	still in the cache.  The blocks have an even length, so the words keep
+	their position. */
+	while( uxOffset < uxLength )
+	{
+		uxBlock = uxLength - uxOffset;
+
+		if( uxBlock > 512U )
+		{
+			uxBlock = 512U;
+		}
+
+		memcpy( &( pucTarget[ uxOffset ] ), &( pucSource[ uxOffset ] ), uxBlock );
+		ullSum += prvChecksumAt( &( pucTarget[ uxOffset ] ), uxBlock );
+		uxOffset += uxBlock;
+	}
+
+	return ullSum;
+}
+/*-----------------------------------------------------------*/
+
+uint16_t usGenerateChecksum( uint32_t ulSum, const uint8_t * pucNextData, size_t uxDataLengthBytes )
+{
+uint16_t usSum;
+
+	/* The initial value is in host order, the sum in memory order. */
+	usSum = prvFold( ( uint64_t ) prvChecksumAt( pucNextData, uxDataLengthBytes ) + FreeRTOS_ntohs( ulSum ) );
+
+	return FreeRTOS_htons( usSum );
+}
+/*-----------------------------------------------------------*/
+
+uint16_t usGenerateChecksumCopy( uint32_t ulSum, uint8_t *pucTarget, const uint8_t *pucSource, size_t uxDataLengthBytes )
+{
+uint16_t usSum;
+
+	usSum = prvFold( prvCopyKernel( pucTarget, pucSource, uxDataLengthBytes ) );
+	usSum = prvFold( ( uint64_t ) usSum + FreeRTOS_ntohs( ulSum ) );
+
+	return FreeRTOS_htons( usSum );
+}
+/*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_CHECKSUM_KERNELS != 0 */
@@ -739,8 +739,28 @@ const uint32_t ulMandatoryOptions = 2ul; /* DHCP server address, and the correct
 
 							/* ulProcessed is not incremented in this case
 							because the DNS server is not essential.  Only the
-							first DNS server address is taken. */
+							first ipconfigDNS_MAX_SERVERS addresses are taken. */
 							xNetworkAddressing.ulDNSServerAddress = ulParameter;
+
+							#if( ipconfigDNS_MAX_SERVERS > 1 )
+							{
+							BaseType_t xIndex;
+
+								for( xIndex = 1; xIndex < ( BaseType_t ) ipconfigDNS_MAX_SERVERS; xIndex++ )
+								{
+									if( ( size_t ) ucLength >= ( size_t ) ( xIndex + 1 ) * sizeof( ulParameter ) )
+									{
+										memcpy( ( void * ) &( xNetworkAddressing.ulAlternateDNSServerAddresses[ xIndex - 1 ] ),
+												( void * ) ( pucByte + ( ( size_t ) xIndex * sizeof( ulParameter ) ) ),
+												sizeof( ulParameter ) );
+									}
+									else
+									{
+										xNetworkAddressing.ulAlternateDNSServerAddresses[ xIndex - 1 ] = 0UL;
+									}
+								}
+							}
+							#endif /* ipconfigDNS_MAX_SERVERS */
 							break;
 
 						case dhcpSERVER_IP_ADDRESS_OPTION_CODE :
@@ -887,6 +907,7 @@ uint8_t *pucUDPPayloadBuffer;
 		( void * ) ipLOCAL_MAC_ADDRESS, sizeof( MACAddress_t ) );
 
 	/* Set the addressing. */
+	pxAddress->sin_family = FREERTOS_AF_INET;
 	pxAddress->sin_addr = ipBROADCAST_IP_ADDRESS;
 	pxAddress->sin_port = ( uint16_t ) dhcpSERVER_PORT;
 
@@ -52,12 +52,14 @@
 	#define dnsOUTGOING_FLAGS				0x0001 /* Standard query. */
 	#define dnsRX_FLAGS_MASK				0x0f80 /* The bits of interest in the flags field of incoming DNS messages. */
 	#define dnsEXPECTED_RX_FLAGS			0x0080 /* Should be a response, without any errors. */
+	#define dnsNXDOMAIN_RX_FLAGS			0x0380 /* A response saying that the name does not exist. */
 #else
 	#define dnsDNS_PORT						0x0035
 	#define dnsONE_QUESTION					0x0001
 	#define dnsOUTGOING_FLAGS				0x0100 /* Standard query. */
 	#define dnsRX_FLAGS_MASK				0x800f /* The bits of interest in the flags field of incoming DNS messages. */
 	#define dnsEXPECTED_RX_FLAGS			0x8000 /* Should be a response, without any errors. */
+	#define dnsNXDOMAIN_RX_FLAGS			0x8003 /* A response saying that the name does not exist. */
 
 #endif /* ipconfigBYTE_ORDER */
 
@@ -122,11 +124,30 @@ static uint8_t *prvSkipNameField( uint8_t *pucByte, size_t xSourceLen );
 static uint32_t prvParseDNSReply( uint8_t *pucUDPPayloadBuffer, size_t xBufferLength, TickType_t xIdentifier );
 
 /*
- * Prepare and send a message to a DNS server.  'xReadTimeOut_ms' will be passed as
- * zero, in case the user has supplied a call-back function.
+ * Prepare and send a message to a DNS server.  'xReadTimeOut_ms' is passed as
+ * zero when the reply will be handled by the IP-task.
  */
 static uint32_t prvGetHostByName( const char *pcHostName, TickType_t xIdentifier, TickType_t xReadTimeOut_ms );
 
+/*
+ * Check if pcHostName is a dotted-decimal address, or if it is found in the
+ * DNS cache.  Returns pdTRUE when no request needs to be sent, in which case
+ * *pulIPAddress is 0 for a name that is known not to exist.
+ */
+static BaseType_t prvGetKnownAddress( const char *pcHostName, uint32_t *pulIPAddress );
+
+/*
+ * Return the size of a request for pcHostName.
+ */
+static size_t prvDNSMessageLength( const char *pcHostName );
+
+/*
+ * Fill in the address to which a request is sent: the LLMNR group for a name
+ * without a dot, or else a DNS server.  The servers are asked in turn as
+ * xAttempt increases.
+ */
+static void prvSetDNSDestination( struct freertos_sockaddr *pxAddress, uint8_t *pucUDPPayloadBuffer, const char *pcHostName, BaseType_t xAttempt );
+
 /*
  * The NBNS and the LLMNR protocol share this reply function.
  */
@@ -139,22 +160,91 @@ static uint32_t prvGetHostByName( const char *pcHostName, TickType_t xIdentifier
 #endif /* ipconfigUSE_NBNS */
 
 #if( ipconfigUSE_DNS_CACHE == 1 )
+	#if( ( ipconfigDNS_CACHE_HASH_TABLE_SIZE & ( ipconfigDNS_CACHE_HASH_TABLE_SIZE - 1 ) ) != 0 )
+		#error ipconfigDNS_CACHE_HASH_TABLE_SIZE must be a power of 2
+	#endif
+
+	/* The uptime in seconds, used to let cache entries expire. */
+	#define dnsCURRENT_TIME_SECONDS()	( ( uint32_t ) ( xTaskGetTickCount() / ( TickType_t ) configTICK_RATE_HZ ) )
+
 	static uint8_t *prvReadNameField( uint8_t *pucByte, size_t xSourceLen, char *pcName, size_t xLen );
-	static void prvProcessDNSCache( const char *pcName, uint32_t *pulIP, uint32_t ulTTL, BaseType_t xLookUp );
+
+	/*
+	 * Look for pcName in the DNS cache.  Returns pdTRUE if the name is known,
+	 * in which case *pulIP is one of its addresses, or 0 if the name is known
+	 * not to exist.  When the entry is about to expire, *pxPrefetchIdentifier
+	 * is set to the identifier of the request that should refresh it, and
+	 * otherwise it is set to 0.
+	 */
+	static BaseType_t prvLookupDNSCache( const char *pcName, uint32_t *pulIP, TickType_t *pxPrefetchIdentifier );
+
+	/*
+	 * Store xCount IP addresses of pcName in the DNS cache, valid during ulTTL
+	 * seconds.  When xCount is zero, pcName is stored as not existing.
+	 */
+	static void prvStoreDNSCache( const char *pcName, const uint32_t *pulIPAddresses, BaseType_t xCount, uint32_t ulTTL );
+
+	/*
+	 * Return the index of the cache entry of pcName, or -1 if there is none.
+	 * Must be called with the scheduler suspended.
+	 */
+	static BaseType_t prvFindDNSCacheEntry( const char *pcName, uint32_t ulNameHash );
+
+	/*
+	 * Wipe out cache entry x.  Must be called with the scheduler suspended.
+	 */
+	static void prvClearDNSCacheEntry( BaseType_t x );
+
+	/*
+	 * Return a hash of pcName, used to find its cache entry quickly.
+	 */
+	static uint32_t prvHashDNSName( const char *pcName );
+
+	#if( ipconfigDNS_CACHE_PREFETCH != 0 )
+		/*
+		 * Returns pdTRUE if usIdentifier belongs to a request that was sent to
+		 * refresh a cache entry.
+		 */
+		static BaseType_t prvIsDNSPrefetchReply( uint16_t usIdentifier );
+	#endif
 
 	typedef struct xDNS_CACHE_TABLE_ROW
 	{
-		uint32_t ulIPAddress;		/* The IP address of an ARP cache entry. */
+		uint32_t ulIPAddresses[ ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY ];	/* The IP addresses of the host. */
 		char pcName[ ipconfigDNS_CACHE_NAME_LENGTH ];  /* The name of the host */
 		uint32_t ulTTL; /* Time-to-Live (in seconds) from the DNS server. */
 		uint32_t ulTimeWhenAddedInSeconds;
+		uint32_t ulNameHash;			/* The hash of pcName, compared before the name itself. */
+		uint8_t ucNumIPAddresses;		/* The number of valid addresses in ulIPAddresses[], 0 for a name that does not exist. */
+		uint8_t ucCurrentIPAddress;		/* The address that will be returned by the next look-up. */
+		#if( ipconfigDNS_CACHE_PREFETCH != 0 )
+			uint16_t usPrefetchIdentifier;	/* Non-zero while a request to refresh the entry is outstanding. */
+		#endif
+		#if( ipconfigDNS_CACHE_HASH_TABLE_SIZE > 0 )
+			uint16_t usHashNext;		/* 1 + the index of the next entry in the same bucket, or 0. */
+		#endif
 	} DNSCacheRow_t;
 
 	static DNSCacheRow_t xDNSCache[ ipconfigDNS_CACHE_ENTRIES ];
 
+	#if( ipconfigDNS_CACHE_HASH_TABLE_SIZE > 0 )
+		/* 1 + the index of the first entry in each bucket, or 0 for an empty
+		bucket, so the table is valid when it is cleared. */
+		static uint16_t usDNSHashTable[ ipconfigDNS_CACHE_HASH_TABLE_SIZE ];
+	#endif
+
     void FreeRTOS_dnsclear()
     {
-        memset( xDNSCache, 0x0, sizeof( xDNSCache ) );
+		vTaskSuspendAll();
+		{
+			memset( xDNSCache, 0x0, sizeof( xDNSCache ) );
+			#if( ipconfigDNS_CACHE_HASH_TABLE_SIZE > 0 )
+			{
+				memset( usDNSHashTable, 0x0, sizeof( usDNSHashTable ) );
+			}
+			#endif
+		}
+		xTaskResumeAll();
     }
 #endif /* ipconfigUSE_DNS_CACHE == 1 */
 
@@ -261,7 +351,9 @@ typedef struct xDNSAnswerRecord DNSAnswerRecord_t;
 	uint32_t FreeRTOS_dnslookup( const char *pcHostName )
 	{
 	uint32_t ulIPAddress = 0UL;
-		prvProcessDNSCache( pcHostName, &ulIPAddress, 0, pdTRUE );
+	TickType_t xPrefetchIdentifier;
+
+		( void ) prvLookupDNSCache( pcHostName, &ulIPAddress, &xPrefetchIdentifier );
 		return ulIPAddress;
 	}
 #endif /* ipconfigUSE_DNS_CACHE == 1 */
@@ -269,17 +361,34 @@ typedef struct xDNSAnswerRecord DNSAnswerRecord_t;
 
 #if( ipconfigDNS_USE_CALLBACKS != 0 )
 
+	/* The period of the DNS timer, which makes the IP-task check for
+	requests that must be resent or that have reached their timeout. */
+	#define dnsCALLBACK_TIMER_PERIOD	pdMS_TO_TICKS( 100U )
+
+	/* A look-up started by FreeRTOS_gethostbyname_a() or by
+	FreeRTOS_gethostbyname_notify().  The IP-task sends the request, resends it
+	to the next DNS server when it is not answered, and reports the result when
+	a reply arrives or when the timeout is reached.  The value of xListItem is
+	the identifier of the request. */
 	typedef struct xDNS_Callback {
-		TickType_t xRemaningTime;		/* Timeout in ms */
-		FOnDNSEvent pCallbackFunction;	/* Function to be called when the address has been found or when a timeout has beeen reached */
+		TickType_t xRemaningTime;		/* Timeout in clock ticks */
+		FOnDNSEvent pCallbackFunction;	/* Function to be called when the address has been found or when a timeout has beeen reached, NULL when a task is notified instead */
 		TimeOut_t xTimeoutState;
-		void *pvSearchID;
+		void *pvSearchID;				/* Points to the result when a task is notified */
+		TaskHandle_t xTaskToNotify;
+		uint32_t ulNotifyBits;
+		TickType_t xLastSendTime;		/* The time at which the request was last sent */
+		BaseType_t xAttempts;			/* The number of times the request was sent */
 		struct xLIST_ITEM xListItem;
 		char pcName[ 1 ];
 	} DNSCallback_t;
 
 	static List_t xCallbackList;
 
+	/* The socket through which the IP-task sends all requests in
+	xCallbackList, and receives the replies. */
+	static Socket_t xDNSResolverSocket = NULL;
+
 	/* Define FreeRTOS_gethostbyname() as a normal blocking call. */
 	uint32_t FreeRTOS_gethostbyname( const char *pcHostName )
 	{
@@ -287,21 +396,38 @@ typedef struct xDNSAnswerRecord DNSAnswerRecord_t;
 	}
 	/*-----------------------------------------------------------*/
 
-	/* Initialise the list of call-back structures. */
+	/* Initialise the list of call-back structures.  This is done each time
+	the network comes up, look-ups that are still outstanding are kept. */
 	void vDNSInitialise( void );
 	void vDNSInitialise( void )
 	{
-		vListInitialise( &xCallbackList );
+		if( listLIST_IS_INITIALISED( &xCallbackList ) == pdFALSE )
+		{
+			vListInitialise( &xCallbackList );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	BaseType_t xIsDNSSocket( Socket_t xSocket )
+	{
+	BaseType_t xReturn;
+
+		if( ( xDNSResolverSocket != NULL ) && ( xDNSResolverSocket == xSocket ) )
+		{
+			xReturn = pdTRUE;
+		}
+		else
+		{
+			xReturn = pdFALSE;
+		}
+
+		return xReturn;
 	}
 	/*-----------------------------------------------------------*/
 
-	/* Iterate through the list of call-back structures and remove
-	old entries which have reached a timeout.
-	As soon as the list hase become empty, the DNS timer will be stopped
-	In case pvSearchID is supplied, the user wants to cancel a DNS request
-	*/
-	void vDNSCheckCallBack( void *pvSearchID );
-	void vDNSCheckCallBack( void *pvSearchID )
+	/* Remove the requests that were started with pvSearchID.  Their
+	call-back will not be called, nor will their task be notified. */
+	void FreeRTOS_gethostbyname_cancel( void *pvSearchID )
 	{
 	const ListItem_t *pxIterator;
 	const MiniListItem_t* xEnd = ( const MiniListItem_t* )listGET_END_MARKER( &xCallbackList );
@@ -315,117 +441,320 @@ typedef struct xDNSAnswerRecord DNSAnswerRecord_t;
 				DNSCallback_t *pxCallback = ( DNSCallback_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
 				/* Move to the next item because we might remove this item */
 				pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator );
-				if( ( pvSearchID != NULL ) && ( pvSearchID == pxCallback->pvSearchID ) )
+				if( pvSearchID == pxCallback->pvSearchID )
 				{
 					uxListRemove( &pxCallback->xListItem );
 					vPortFree( pxCallback );
 				}
-				else if( xTaskCheckForTimeOut( &pxCallback->xTimeoutState, &pxCallback->xRemaningTime ) != pdFALSE )
-				{
-					pxCallback->pCallbackFunction( pxCallback->pcName, pxCallback->pvSearchID, 0 );
-					uxListRemove( &pxCallback->xListItem );
-					vPortFree( ( void * ) pxCallback );
-				}
 			}
 		}
 		xTaskResumeAll();
-
-		if( listLIST_IS_EMPTY( &xCallbackList ) )
-		{
-			vIPSetDnsTimerEnableState( pdFALSE );
-		}
 	}
 	/*-----------------------------------------------------------*/
 
-	void FreeRTOS_gethostbyname_cancel( void *pvSearchID )
-	{
-		/* _HT_ Should better become a new API call to have the IP-task remove the callback */
-		vDNSCheckCallBack( pvSearchID );
-	}
-	/*-----------------------------------------------------------*/
-
-	/* FreeRTOS_gethostbyname_a() was called along with callback parameters.
-	Store them in a list for later reference. */
-	static void vDNSSetCallBack( const char *pcHostName, void *pvSearchID, FOnDNSEvent pCallbackFunction, TickType_t xTimeout, TickType_t xIdentifier );
-	static void vDNSSetCallBack( const char *pcHostName, void *pvSearchID, FOnDNSEvent pCallbackFunction, TickType_t xTimeout, TickType_t xIdentifier )
+	/* FreeRTOS_gethostbyname_a() or FreeRTOS_gethostbyname_notify() was
+	called.  Store the parameters in a list and have the IP-task send the
+	request. */
+	static BaseType_t prvDNSSetCallBack( const char *pcHostName, void *pvSearchID, FOnDNSEvent pCallbackFunction, TickType_t xTimeout, TaskHandle_t xTaskToNotify, uint32_t ulNotifyBits )
 	{
 		size_t lLength = strlen( pcHostName );
 		DNSCallback_t *pxCallback = ( DNSCallback_t * )pvPortMalloc( sizeof( *pxCallback ) + lLength );
+		BaseType_t xReturn = pdFAIL;
+
+		if( xTimeout == 0 )
+		{
+			/* Long enough to send all attempts. */
+			xTimeout = ( TickType_t ) ( ipconfigDNS_REQUEST_ATTEMPTS * ipconfigDNS_RETRY_INTERVAL_MS );
+		}
 
 		/* Translate from ms to number of clock ticks. */
 		xTimeout /= portTICK_PERIOD_MS;
 		if( pxCallback != NULL )
 		{
-			if( listLIST_IS_EMPTY( &xCallbackList ) )
-			{
-				/* This is the first one, start the DNS timer to check for timeouts */
-				vIPReloadDNSTimer( FreeRTOS_min_uint32( 1000U, xTimeout ) );
-			}
 			strcpy( pxCallback->pcName, pcHostName );
 			pxCallback->pCallbackFunction = pCallbackFunction;
 			pxCallback->pvSearchID = pvSearchID;
+			pxCallback->xTaskToNotify = xTaskToNotify;
+			pxCallback->ulNotifyBits = ulNotifyBits;
 			pxCallback->xRemaningTime = xTimeout;
+			pxCallback->xLastSendTime = 0;
+			pxCallback->xAttempts = 0;
 			vTaskSetTimeOutState( &pxCallback->xTimeoutState );
 			listSET_LIST_ITEM_OWNER( &( pxCallback->xListItem ), ( void* ) pxCallback );
-			listSET_LIST_ITEM_VALUE( &( pxCallback->xListItem ), xIdentifier );
+
+			/* Replies are matched with the 16-bit identifier, as it appears
+			in the message. */
+			listSET_LIST_ITEM_VALUE( &( pxCallback->xListItem ), ( TickType_t ) ( uint16_t ) ipconfigRAND32() );
+
 			vTaskSuspendAll();
 			{
+				if( listLIST_IS_EMPTY( &xCallbackList ) )
+				{
+					/* This is the first one, start the DNS timer to check for timeouts */
+					vIPReloadDNSTimer( dnsCALLBACK_TIMER_PERIOD );
+				}
 				vListInsertEnd( &xCallbackList, &pxCallback->xListItem );
 			}
 			xTaskResumeAll();
+
+			/* The IP-task will send the request. */
+			xSendEventToIPTask( eDNSEvent );
+			xReturn = pdPASS;
 		}
+
+		return xReturn;
 	}
 	/*-----------------------------------------------------------*/
 
-	/* A DNS reply was received, see if there is any matching entry and
-	call the handler. */
-	static void vDNSDoCallback( TickType_t xIdentifier, const char *pcName, uint32_t ulIPAddress );
-	static void vDNSDoCallback( TickType_t xIdentifier, const char *pcName, uint32_t ulIPAddress )
+	/* A look-up has finished, remove it and report the result.  Called with
+	the scheduler suspended. */
+	static void prvDNSDoCallback( DNSCallback_t *pxCallback, uint32_t ulIPAddress )
 	{
-		const ListItem_t *pxIterator;
-		const MiniListItem_t* xEnd = ( const MiniListItem_t* )listGET_END_MARKER( &xCallbackList );
+		uxListRemove( &pxCallback->xListItem );
 
-		vTaskSuspendAll();
+		if( pxCallback->pCallbackFunction != NULL )
 		{
-			for( pxIterator  = ( const ListItem_t * ) listGET_NEXT( xEnd );
-				 pxIterator != ( const ListItem_t * ) xEnd;
-				 pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+			pxCallback->pCallbackFunction( pxCallback->pcName, pxCallback->pvSearchID, ulIPAddress );
+		}
+		#if( configUSE_TASK_NOTIFICATIONS == 1 )
+		else
+		{
+			*( ( uint32_t * ) pxCallback->pvSearchID ) = ulIPAddress;
+			( void ) xTaskNotify( pxCallback->xTaskToNotify, pxCallback->ulNotifyBits, eSetBits );
+		}
+		#endif /* configUSE_TASK_NOTIFICATIONS */
+
+		vPortFree( pxCallback );
+	}
+	/*-----------------------------------------------------------*/
+
+	/* Called by the IP-task to send a request through xDNSResolverSocket,
+	each attempt goes to the next DNS server. */
+	static void prvDNSSendCallBack( DNSCallback_t *pxCallback )
+	{
+	struct freertos_sockaddr xAddress;
+	uint8_t *pucUDPPayloadBuffer;
+	size_t xPayloadLength;
+
+		/* The IP-task may not wait for a buffer. */
+		pucUDPPayloadBuffer = ( uint8_t * ) FreeRTOS_GetUDPPayloadBuffer( prvDNSMessageLength( pxCallback->pcName ), 0 );
+
+		if( pucUDPPayloadBuffer != NULL )
+		{
+			xPayloadLength = prvCreateDNSMessage( pucUDPPayloadBuffer, pxCallback->pcName, listGET_LIST_ITEM_VALUE( &( pxCallback->xListItem ) ) );
+
+			iptraceSENDING_DNS_REQUEST();
+
+			prvSetDNSDestination( &xAddress, pucUDPPayloadBuffer, pxCallback->pcName, pxCallback->xAttempts );
+
+			if( FreeRTOS_sendto( xDNSResolverSocket, pucUDPPayloadBuffer, xPayloadLength, FREERTOS_ZERO_COPY, &xAddress, sizeof( xAddress ) ) == 0 )
 			{
-				if( listGET_LIST_ITEM_VALUE( pxIterator ) == xIdentifier )
+				/* The message was not sent so the stack will not be
+				releasing the zero copy - it must be released here. */
+				FreeRTOS_ReleaseUDPPayloadBuffer( ( void * ) pucUDPPayloadBuffer );
+			}
+		}
+
+		/* A request that could not be sent is retried like a request that
+		was not answered. */
+		pxCallback->xAttempts++;
+		pxCallback->xLastSendTime = xTaskGetTickCount();
+	}
+	/*-----------------------------------------------------------*/
+
+	/* A reply was received by xDNSResolverSocket.  Find the request with the
+	same identifier and report the result, unless the server failed to answer
+	the question, in which case the next server is asked. */
+	static void prvDNSHandleReply( uint8_t *pucUDPPayloadBuffer, size_t xBufferLength )
+	{
+	const DNSMessage_t *pxDNSMessageHeader = ( const DNSMessage_t * ) pucUDPPayloadBuffer;
+	const ListItem_t *pxIterator;
+	const MiniListItem_t* xEnd = ( const MiniListItem_t* )listGET_END_MARKER( &xCallbackList );
+	uint32_t ulIPAddress;
+	uint16_t usIdentifier, usFlags;
+
+		if( xBufferLength >= sizeof( DNSMessage_t ) )
+		{
+			usIdentifier = pxDNSMessageHeader->usIdentifier;
+			usFlags = pxDNSMessageHeader->usFlags & dnsRX_FLAGS_MASK;
+
+			/* Also stores the answer in the DNS cache. */
+			ulIPAddress = prvParseDNSReply( pucUDPPayloadBuffer, xBufferLength, ( TickType_t ) usIdentifier );
+
+			vTaskSuspendAll();
+			{
+				for( pxIterator  = ( const ListItem_t * ) listGET_NEXT( xEnd );
+					 pxIterator != ( const ListItem_t * ) xEnd;
+					 pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
 				{
-					DNSCallback_t *pxCallback = ( DNSCallback_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
-					pxCallback->pCallbackFunction( pcName, pxCallback->pvSearchID, ulIPAddress );
-					uxListRemove( &pxCallback->xListItem );
-					vPortFree( pxCallback );
-					if( listLIST_IS_EMPTY( &xCallbackList ) )
+					if( listGET_LIST_ITEM_VALUE( pxIterator ) == ( TickType_t ) usIdentifier )
 					{
-						vIPSetDnsTimerEnableState( pdFALSE );
+						DNSCallback_t *pxCallback = ( DNSCallback_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+
+						if( ( ulIPAddress != 0UL ) ||
+							( usFlags == dnsEXPECTED_RX_FLAGS ) ||
+							( usFlags == dnsNXDOMAIN_RX_FLAGS ) )
+						{
+							/* An address, or an answer saying that the name
+							has no IPv4 address. */
+							prvDNSDoCallback( pxCallback, ulIPAddress );
+						}
+						else if( pxCallback->xAttempts < ( BaseType_t ) ipconfigDNS_REQUEST_ATTEMPTS )
+						{
+							prvDNSSendCallBack( pxCallback );
+						}
+						break;
 					}
+				}
+			}
+			xTaskResumeAll();
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvCreateDNSResolverSocket( void )
+	{
+	struct freertos_sockaddr xAddress;
+	TickType_t xTimeoutTime = ( TickType_t ) 0;
+
+		xDNSResolverSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+		if( xDNSResolverSocket != FREERTOS_INVALID_SOCKET )
+		{
+			/* Ensure the Rx and Tx timeouts are zero as the socket is used in
+			the context of the IP task. */
+			FreeRTOS_setsockopt( xDNSResolverSocket, 0, FREERTOS_SO_RCVTIMEO, ( void * ) &xTimeoutTime, sizeof( TickType_t ) );
+			FreeRTOS_setsockopt( xDNSResolverSocket, 0, FREERTOS_SO_SNDTIMEO, ( void * ) &xTimeoutTime, sizeof( TickType_t ) );
+
+			/* Bind to a random port number. */
+			xAddress.sin_port = 0U;
+			if( vSocketBind( xDNSResolverSocket, &xAddress, sizeof( xAddress ), pdFALSE ) != 0 )
+			{
+				/* Binding failed, close the socket again. */
+				vSocketClose( xDNSResolverSocket );
+				xDNSResolverSocket = NULL;
+			}
+		}
+		else
+		{
+			/* Change to NULL for easier testing. */
+			xDNSResolverSocket = NULL;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	void vDNSProcess( void )
+	{
+	const ListItem_t *pxIterator;
+	const MiniListItem_t* xEnd = ( const MiniListItem_t* )listGET_END_MARKER( &xCallbackList );
+	struct freertos_sockaddr xAddress;
+	uint32_t ulAddressLength = sizeof( xAddress );
+	uint8_t *pucUDPPayloadBuffer;
+	int32_t lBytes;
+
+		if( xDNSResolverSocket == NULL )
+		{
+			prvCreateDNSResolverSocket();
+		}
+
+		if( xDNSResolverSocket != NULL )
+		{
+			/* Handle the replies that have been received. */
+			for( ;; )
+			{
+				lBytes = FreeRTOS_recvfrom( xDNSResolverSocket, ( void * ) &pucUDPPayloadBuffer, 0, FREERTOS_ZERO_COPY, &xAddress, &ulAddressLength );
+				if( lBytes <= 0 )
+				{
 					break;
 				}
+
+				prvDNSHandleReply( pucUDPPayloadBuffer, ( size_t ) lBytes );
+				FreeRTOS_ReleaseUDPPayloadBuffer( ( void * ) pucUDPPayloadBuffer );
+			}
+		}
+
+		/* Send the new requests, resend the ones that were not answered in
+		time, and remove the ones that have reached their timeout. */
+		vTaskSuspendAll();
+		{
+			for( pxIterator  = ( const ListItem_t * ) listGET_NEXT( xEnd );
+				 pxIterator != ( const ListItem_t * ) xEnd;
+				  )
+			{
+				DNSCallback_t *pxCallback = ( DNSCallback_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+				/* Move to the next item because we might remove this item */
+				pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator );
+				if( xTaskCheckForTimeOut( &pxCallback->xTimeoutState, &pxCallback->xRemaningTime ) != pdFALSE )
+				{
+					prvDNSDoCallback( pxCallback, 0UL );
+				}
+				else if( xDNSResolverSocket == NULL )
+				{
+					/* Try to create the socket again later. */
+				}
+				else if( pxCallback->xAttempts == 0 )
+				{
+					prvDNSSendCallBack( pxCallback );
+				}
+				else if( ( pxCallback->xAttempts < ( BaseType_t ) ipconfigDNS_REQUEST_ATTEMPTS ) &&
+						 ( ( xTaskGetTickCount() - pxCallback->xLastSendTime ) >= pdMS_TO_TICKS( ipconfigDNS_RETRY_INTERVAL_MS ) ) )
+				{
+					prvDNSSendCallBack( pxCallback );
+				}
 			}
 		}
 		xTaskResumeAll();
+
+		if( listLIST_IS_EMPTY( &xCallbackList ) )
+		{
+			vIPSetDnsTimerEnableState( pdFALSE );
+		}
 	}
+	/*-----------------------------------------------------------*/
+
+	#if( configUSE_TASK_NOTIFICATIONS == 1 )
+
+		BaseType_t FreeRTOS_gethostbyname_notify( const char *pcHostName, uint32_t *pulIPAddress, uint32_t ulNotifyBits, TickType_t xTimeout )
+		{
+		uint32_t ulIPAddress = 0UL;
+		BaseType_t xReturn = pdPASS;
+
+			if( prvGetKnownAddress( pcHostName, &ulIPAddress ) != pdFALSE )
+			{
+				/* The answer is known already, notify the task now. */
+				*pulIPAddress = ulIPAddress;
+				( void ) xTaskNotify( xTaskGetCurrentTaskHandle(), ulNotifyBits, eSetBits );
+			}
+			else
+			{
+				xReturn = prvDNSSetCallBack( pcHostName, ( void * ) pulIPAddress, ( FOnDNSEvent ) NULL, xTimeout, xTaskGetCurrentTaskHandle(), ulNotifyBits );
+			}
+
+			return xReturn;
+		}
+		/*-----------------------------------------------------------*/
+
+	#endif /* configUSE_TASK_NOTIFICATIONS */
 
 #endif	/* ipconfigDNS_USE_CALLBACKS != 0 */
 /*-----------------------------------------------------------*/
 
-#if( ipconfigDNS_USE_CALLBACKS == 0 )
-uint32_t FreeRTOS_gethostbyname( const char *pcHostName )
-#else
-uint32_t FreeRTOS_gethostbyname_a( const char *pcHostName, FOnDNSEvent pCallback, void *pvSearchID, TickType_t xTimeout )
-#endif
+static BaseType_t prvGetKnownAddress( const char *pcHostName, uint32_t *pulIPAddress )
 {
 uint32_t ulIPAddress = 0UL;
-TickType_t xReadTimeOut_ms = ipconfigSOCK_DEFAULT_RECEIVE_BLOCK_TIME;
-TickType_t xIdentifier = 0;
+BaseType_t xKnown = pdFALSE;
+#if( ipconfigUSE_DNS_CACHE == 1 )
+	TickType_t xPrefetchIdentifier = 0;
+#endif
 
 	/* If the supplied hostname is IP address, convert it to uint32_t
 	and return. */
 	#if( ipconfigINCLUDE_FULL_INET_ADDR == 1 )
 	{
 		ulIPAddress = FreeRTOS_inet_addr( pcHostName );
+		if( ulIPAddress != 0UL )
+		{
+			xKnown = pdTRUE;
+		}
 	}
 	#endif /* ipconfigINCLUDE_FULL_INET_ADDR == 1 */
 
@@ -433,58 +762,118 @@ TickType_t xIdentifier = 0;
 	request. */
 	#if( ipconfigUSE_DNS_CACHE == 1 )
 	{
-		if( ulIPAddress == 0UL )
+		if( xKnown == pdFALSE )
 		{
-			ulIPAddress = FreeRTOS_dnslookup( pcHostName );
-			if( ulIPAddress != 0 )
+			xKnown = prvLookupDNSCache( pcHostName, &ulIPAddress, &xPrefetchIdentifier );
+			if( xKnown != pdFALSE )
 			{
+				/* The address is 0 if the name is known not to exist. */
 				FreeRTOS_debug_printf( ( "FreeRTOS_gethostbyname: found '%s' in cache: %lxip\n", pcHostName, ulIPAddress ) );
 			}
-			else
-			{
-				/* prvGetHostByName will be called to start a DNS lookup */
-			}
+		}
+
+		if( xPrefetchIdentifier != 0 )
+		{
+			/* The cached entry is about to expire.  Send a request without
+			waiting for the reply, which will refresh the entry when it is
+			received by the IP-task. */
+			( void ) prvGetHostByName( pcHostName, xPrefetchIdentifier, 0 );
 		}
 	}
 	#endif /* ipconfigUSE_DNS_CACHE == 1 */
 
-	/* Generate a unique identifier. */
-	if( 0 == ulIPAddress )
-	{
-		xIdentifier = ( TickType_t )ipconfigRAND32( );
-	}
+	*pulIPAddress = ulIPAddress;
+
+	return xKnown;
+}
+/*-----------------------------------------------------------*/
+
+#if( ipconfigDNS_USE_CALLBACKS == 0 )
+uint32_t FreeRTOS_gethostbyname( const char *pcHostName )
+#else
+uint32_t FreeRTOS_gethostbyname_a( const char *pcHostName, FOnDNSEvent pCallback, void *pvSearchID, TickType_t xTimeout )
+#endif
+{
+uint32_t ulIPAddress = 0UL;
+TickType_t xIdentifier;
+BaseType_t xKnown;
+
+	xKnown = prvGetKnownAddress( pcHostName, &ulIPAddress );
 
 	#if( ipconfigDNS_USE_CALLBACKS != 0 )
+	if( pCallback != NULL )
 	{
-		if( pCallback != NULL )
+		if( xKnown == pdFALSE )
 		{
-			if( ulIPAddress == 0UL )
-			{
-				/* The user has provided a callback function, so do not block on recvfrom() */
-				if( 0 != xIdentifier )
-				{
-					xReadTimeOut_ms = 0;
-					vDNSSetCallBack( pcHostName, pvSearchID, pCallback, xTimeout, ( TickType_t )xIdentifier );
-				}
-			}
-			else
-			{
-				/* The IP address is known, do the call-back now. */
-				pCallback( pcHostName, pvSearchID, ulIPAddress );
-			}
+			/* The user has provided a callback function, so do not block.
+			The IP-task will send the request and call it. */
+			( void ) prvDNSSetCallBack( pcHostName, pvSearchID, pCallback, xTimeout, NULL, 0UL );
+		}
+		else
+		{
+			/* The IP address is known, do the call-back now. */
+			pCallback( pcHostName, pvSearchID, ulIPAddress );
 		}
 	}
-	#endif
-
-	if( ( ulIPAddress == 0UL ) && ( 0 != xIdentifier ) )
+	else
+	#endif /* ipconfigDNS_USE_CALLBACKS != 0 */
+	if( xKnown == pdFALSE )
 	{
-		ulIPAddress = prvGetHostByName( pcHostName, xIdentifier, xReadTimeOut_ms );
+		/* Generate a unique identifier. */
+		xIdentifier = ( TickType_t )ipconfigRAND32( );
+
+		if( xIdentifier != 0 )
+		{
+			ulIPAddress = prvGetHostByName( pcHostName, xIdentifier, ipconfigSOCK_DEFAULT_RECEIVE_BLOCK_TIME );
+		}
 	}
 
 	return ulIPAddress;
 }
 /*-----------------------------------------------------------*/
 
+static size_t prvDNSMessageLength( const char *pcHostName )
+{
+	/* Two is added at the end for the count of characters in the first
+	subdomain part and the string end byte. */
+	return sizeof( DNSMessage_t ) + strlen( pcHostName ) + sizeof( uint16_t ) + sizeof( uint16_t ) + 2u;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetDNSDestination( struct freertos_sockaddr *pxAddress, uint8_t *pucUDPPayloadBuffer, const char *pcHostName, BaseType_t xAttempt )
+{
+BaseType_t xIndex;
+
+	pxAddress->sin_family = FREERTOS_AF_INET;
+
+	/* If LLMNR is being used then determine if the host name includes a '.' -
+	if not then LLMNR can be used as the lookup method. */
+#if( ipconfigUSE_LLMNR == 1 )
+	if( strchr( pcHostName, '.' ) == NULL )
+	{
+		/* Use LLMNR addressing. */
+		( ( DNSMessage_t * ) pucUDPPayloadBuffer) -> usFlags = 0;
+		pxAddress->sin_addr = ipLLMNR_IP_ADDR;	/* Is in network byte order. */
+		pxAddress->sin_port = FreeRTOS_ntohs( ipLLMNR_PORT );
+	}
+	else
+#else
+	( void ) pucUDPPayloadBuffer;
+	( void ) pcHostName;
+#endif
+	{
+		/* Use a DNS server.  Each attempt goes to the next one, servers
+		that are not configured are skipped. */
+		pxAddress->sin_addr = 0UL;
+		for( xIndex = 0; ( xIndex < ( BaseType_t ) ipconfigDNS_MAX_SERVERS ) && ( pxAddress->sin_addr == 0UL ); xIndex++ )
+		{
+			pxAddress->sin_addr = FreeRTOS_GetDNSServerAddressAt( ( xAttempt + xIndex ) % ( BaseType_t ) ipconfigDNS_MAX_SERVERS );
+		}
+		pxAddress->sin_port = dnsDNS_PORT;
+	}
+}
+/*-----------------------------------------------------------*/
+
 static uint32_t prvGetHostByName( const char *pcHostName, TickType_t xIdentifier, TickType_t xReadTimeOut_ms )
 {
 struct freertos_sockaddr xAddress;
@@ -497,29 +886,7 @@ int32_t lBytes;
 size_t xPayloadLength, xExpectedPayloadLength;
 TickType_t xWriteTimeOut_ms = ipconfigSOCK_DEFAULT_SEND_BLOCK_TIME;
 
-#if( ipconfigUSE_LLMNR == 1 )
-	BaseType_t bHasDot = pdFALSE;
-#endif /* ipconfigUSE_LLMNR == 1 */
-
-	/* If LLMNR is being used then determine if the host name includes a '.' -
-	if not then LLMNR can be used as the lookup method. */
-	#if( ipconfigUSE_LLMNR == 1 )
-	{
-		const char *pucPtr;
-		for( pucPtr = pcHostName; *pucPtr; pucPtr++ )
-		{
-			if( *pucPtr == '.' )
-			{
-				bHasDot = pdTRUE;
-				break;
-			}
-		}
-	}
-	#endif /* ipconfigUSE_LLMNR == 1 */
-
-	/* Two is added at the end for the count of characters in the first
-	subdomain part and the string end byte. */
-	xExpectedPayloadLength = sizeof( DNSMessage_t ) + strlen( pcHostName ) + sizeof( uint16_t ) + sizeof( uint16_t ) + 2u;
+	xExpectedPayloadLength = prvDNSMessageLength( pcHostName );
 
 	xDNSSocket = prvCreateDNSSocket();
 
@@ -542,30 +909,20 @@ TickType_t xWriteTimeOut_ms = ipconfigSOCK_DEFAULT_SEND_BLOCK_TIME;
 
 				iptraceSENDING_DNS_REQUEST();
 
-				/* Obtain the DNS server address. */
-				FreeRTOS_GetAddressConfiguration( NULL, NULL, NULL, &ulIPAddress );
+				/* Obtain the address of the LLMNR group or of the DNS server
+				that is asked this time. */
+				prvSetDNSDestination( &xAddress, pucUDPPayloadBuffer, pcHostName, xAttempt );
 
 				/* Send the DNS message. */
-#if( ipconfigUSE_LLMNR == 1 )
-				if( bHasDot == pdFALSE )
-				{
-					/* Use LLMNR addressing. */
-					( ( DNSMessage_t * ) pucUDPPayloadBuffer) -> usFlags = 0;
-					xAddress.sin_addr = ipLLMNR_IP_ADDR;	/* Is in network byte order. */
-					xAddress.sin_port = FreeRTOS_ntohs( ipLLMNR_PORT );
-				}
-				else
-#endif
-				{
-					/* Use DNS server. */
-					xAddress.sin_addr = ulIPAddress;
-					xAddress.sin_port = dnsDNS_PORT;
-				}
-
-				ulIPAddress = 0UL;
-
 				if( FreeRTOS_sendto( xDNSSocket, pucUDPPayloadBuffer, xPayloadLength, FREERTOS_ZERO_COPY, &xAddress, sizeof( xAddress ) ) != 0 )
 				{
+					if( xReadTimeOut_ms == 0 )
+					{
+						/* The reply will be handled by the IP-task, there is
+						no point in sending the same request again. */
+						break;
+					}
+
 					/* Wait for the reply. */
 					lBytes = FreeRTOS_recvfrom( xDNSSocket, &pucUDPPayloadBuffer, 0, FREERTOS_ZERO_COPY, &xAddress, &ulAddressLength );
 
@@ -821,9 +1178,27 @@ DNSMessage_t *pxDNSMessageHeader;
         pxDNSMessageHeader = 
             ( DNSMessage_t * )( pxNetworkBuffer->pucEthernetBuffer + sizeof( UDPPacket_t ) );
 
-        prvParseDNSReply( ( uint8_t * )pxDNSMessageHeader,
-                          pxNetworkBuffer->xDataLength,
-                          ( uint32_t )pxDNSMessageHeader->usIdentifier );
+		#if( ipconfigUSE_DNS_CACHE == 1 ) && ( ipconfigDNS_CACHE_PREFETCH != 0 )
+		{
+		const UDPPacket_t *pxUDPPacket = ( const UDPPacket_t * ) pxNetworkBuffer->pucEthernetBuffer;
+
+			/* Replies from a DNS server only get here when they arrive after
+			the socket was closed.  Only accept the ones that refresh the
+			cache, so the cache can not be filled with unsolicited answers. */
+			if( ( pxUDPPacket->xUDPHeader.usSourcePort == FreeRTOS_ntohs( ipDNS_PORT ) ) &&
+				( prvIsDNSPrefetchReply( pxDNSMessageHeader->usIdentifier ) == pdFALSE ) )
+			{
+				pxDNSMessageHeader = NULL;
+			}
+		}
+		#endif
+
+		if( pxDNSMessageHeader != NULL )
+		{
+			prvParseDNSReply( ( uint8_t * )pxDNSMessageHeader,
+							  pxNetworkBuffer->xDataLength,
+							  ( uint32_t )pxDNSMessageHeader->usIdentifier );
+		}
     }
 
 	/* The packet was not consumed. */
@@ -867,6 +1242,9 @@ uint16_t x, usDataLength, usQuestions;
 #endif
 #if( ipconfigUSE_DNS_CACHE == 1 )
 	char pcName[ ipconfigDNS_CACHE_NAME_LENGTH ] = "";
+	uint32_t ulAddresses[ ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY ];
+	BaseType_t xNumAddresses = 0;
+	uint32_t ulTTL = 0UL;
 #endif
 
 	/* Ensure that the buffer is of at least minimal DNS message length. */
@@ -990,26 +1368,46 @@ uint16_t x, usDataLength, usQuestions;
 					/* Sanity check the data length of an IPv4 answer. */
 					if( FreeRTOS_ntohs( pxDNSAnswerRecord->usDataLength ) == sizeof( uint32_t ) )
 					{
+					uint32_t ulAddress;
+
 						/* Copy the IP address out of the record. */
-						memcpy( &ulIPAddress,
+						memcpy( &ulAddress,
 								pucByte + sizeof( DNSAnswerRecord_t ),
 								sizeof( uint32_t ) );
 
 						#if( ipconfigUSE_DNS_CACHE == 1 )
 						{
-							prvProcessDNSCache( pcName, &ulIPAddress, pxDNSAnswerRecord->ulTTL, pdFALSE );
+							/* Remember all addresses, valid for the shortest
+							TTL of their records. */
+							if( ( xNumAddresses == 0 ) || ( FreeRTOS_ntohl( pxDNSAnswerRecord->ulTTL ) < ulTTL ) )
+							{
+								ulTTL = FreeRTOS_ntohl( pxDNSAnswerRecord->ulTTL );
+							}
+							ulAddresses[ xNumAddresses ] = ulAddress;
+							xNumAddresses++;
 						}
 						#endif /* ipconfigUSE_DNS_CACHE */
-						#if( ipconfigDNS_USE_CALLBACKS != 0 )
+
+						if( ulIPAddress == 0UL )
 						{
-							/* See if any asynchronous call was made to FreeRTOS_gethostbyname_a() */
-							vDNSDoCallback( ( TickType_t ) pxDNSMessageHeader->usIdentifier, pcName, ulIPAddress );
+							/* The first address is the one returned. */
+							ulIPAddress = ulAddress;
 						}
-						#endif	/* ipconfigDNS_USE_CALLBACKS != 0 */
 					}
 
 					pucByte += sizeof( DNSAnswerRecord_t ) + sizeof( uint32_t );
 					xSourceBytesRemaining -= ( sizeof( DNSAnswerRecord_t ) + sizeof( uint32_t ) );
+
+					#if( ipconfigUSE_DNS_CACHE == 1 )
+					{
+						if( xNumAddresses < ( BaseType_t ) ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY )
+						{
+							/* Look for more A records, the cache returns
+							them in turn. */
+							continue;
+						}
+					}
+					#endif /* ipconfigUSE_DNS_CACHE */
 					break;
 				}
 				else if( xSourceBytesRemaining >= sizeof( DNSAnswerRecord_t ) )
@@ -1036,7 +1434,30 @@ uint16_t x, usDataLength, usQuestions;
 					}
 				}
 			}
+
+			#if( ipconfigUSE_DNS_CACHE == 1 )
+			{
+				if( xNumAddresses > 0 )
+				{
+					prvStoreDNSCache( pcName, ulAddresses, xNumAddresses, ulTTL );
+				}
+				#if( ipconfigDNS_CACHE_NEGATIVE_TTL > 0 )
+				else
+				{
+					/* The name exists, but it has no IPv4 address. */
+					prvStoreDNSCache( pcName, NULL, 0, ( uint32_t ) ipconfigDNS_CACHE_NEGATIVE_TTL );
+				}
+				#endif
+			}
+			#endif /* ipconfigUSE_DNS_CACHE */
+		}
+#if( ipconfigUSE_DNS_CACHE == 1 ) && ( ipconfigDNS_CACHE_NEGATIVE_TTL > 0 )
+		else if( ( pxDNSMessageHeader->usFlags & dnsRX_FLAGS_MASK ) == dnsNXDOMAIN_RX_FLAGS )
+		{
+			/* The server says that the name does not exist. */
+			prvStoreDNSCache( pcName, NULL, 0, ( uint32_t ) ipconfigDNS_CACHE_NEGATIVE_TTL );
 		}
+#endif
 #if( ipconfigUSE_LLMNR == 1 )
 		else if( usQuestions && ( usType == dnsTYPE_A_HOST ) && ( usClass == dnsCLASS_IN ) )
 		{
@@ -1176,7 +1597,7 @@ uint16_t x, usDataLength, usQuestions;
 				{
 					/* If this is a response from another device,
 					add the name to the DNS cache */
-					prvProcessDNSCache( ( char * ) ucNBNSName, &ulIPAddress, 0, pdFALSE );
+					prvStoreDNSCache( ( char * ) ucNBNSName, &ulIPAddress, 1, 0UL );
 				}
 			}
 			#else
@@ -1332,80 +1753,258 @@ TickType_t xTimeoutTime = pdMS_TO_TICKS( 200 );
 
 #if( ipconfigUSE_DNS_CACHE == 1 )
 
-	static void prvProcessDNSCache( const char *pcName, uint32_t *pulIP, uint32_t ulTTL, BaseType_t xLookUp )
+	static uint32_t prvHashDNSName( const char *pcName )
+	{
+	uint32_t ulHash = 2166136261UL;
+
+		/* FNV-1a, cheap and good enough to tell host names apart. */
+		while( *pcName != '\0' )
+		{
+			ulHash ^= ( uint32_t ) ( uint8_t ) *pcName;
+			ulHash *= 16777619UL;
+			pcName++;
+		}
+
+		return ulHash;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvFindDNSCacheEntry( const char *pcName, uint32_t ulNameHash )
 	{
 	BaseType_t x;
-	BaseType_t xFound = pdFALSE;
-	uint32_t ulCurrentTimeSeconds = ( xTaskGetTickCount() / portTICK_PERIOD_MS ) / 1000;
-	static BaseType_t xFreeEntry = 0;
+	BaseType_t xResult = -1;
 
-		/* For each entry in the DNS cache table. */
-		for( x = 0; x < ipconfigDNS_CACHE_ENTRIES; x++ )
+		#if( ipconfigDNS_CACHE_HASH_TABLE_SIZE > 0 )
+		{
+			/* Only the entries in one bucket need to be compared. */
+			for( x = ( BaseType_t ) usDNSHashTable[ ulNameHash & ( ipconfigDNS_CACHE_HASH_TABLE_SIZE - 1U ) ] - 1;
+				 x >= 0;
+				 x = ( BaseType_t ) xDNSCache[ x ].usHashNext - 1 )
+			{
+				if( ( xDNSCache[ x ].ulNameHash == ulNameHash ) && ( strcmp( xDNSCache[ x ].pcName, pcName ) == 0 ) )
+				{
+					xResult = x;
+					break;
+				}
+			}
+		}
+		#else
 		{
-			if( xDNSCache[ x ].pcName[ 0 ] == 0 )
+			/* For each entry in the DNS cache table. */
+			for( x = 0; x < ipconfigDNS_CACHE_ENTRIES; x++ )
 			{
-				continue;
+				/* Only compare the names when the hashes are equal. */
+				if( ( xDNSCache[ x ].pcName[ 0 ] != '\0' ) &&
+					( xDNSCache[ x ].ulNameHash == ulNameHash ) &&
+					( strcmp( xDNSCache[ x ].pcName, pcName ) == 0 ) )
+				{
+					xResult = x;
+					break;
+				}
 			}
+		}
+		#endif /* ipconfigDNS_CACHE_HASH_TABLE_SIZE */
+
+		return xResult;
+	}
+	/*-----------------------------------------------------------*/
 
-			if( 0 == strcmp( xDNSCache[ x ].pcName, pcName ) )
+	static void prvClearDNSCacheEntry( BaseType_t x )
+	{
+		#if( ipconfigDNS_CACHE_HASH_TABLE_SIZE > 0 )
+		{
+		uint16_t *pusLink = &( usDNSHashTable[ xDNSCache[ x ].ulNameHash & ( ipconfigDNS_CACHE_HASH_TABLE_SIZE - 1U ) ] );
+
+			/* Find the link that refers to this entry, and skip it. */
+			while( *pusLink != 0U )
 			{
-				/* Is this function called for a lookup or to add/update an IP address? */
-				if( xLookUp != pdFALSE )
+				if( *pusLink == ( uint16_t ) ( x + 1 ) )
 				{
-					/* Confirm that the record is still fresh. */
-					if( ulCurrentTimeSeconds < ( xDNSCache[ x ].ulTimeWhenAddedInSeconds + FreeRTOS_ntohl( xDNSCache[ x ].ulTTL ) ) )
-					{
-						*pulIP = xDNSCache[ x ].ulIPAddress;
-					}
-					else
+					*pusLink = xDNSCache[ x ].usHashNext;
+					break;
+				}
+				pusLink = &( xDNSCache[ *pusLink - 1U ].usHashNext );
+			}
+		}
+		#endif /* ipconfigDNS_CACHE_HASH_TABLE_SIZE */
+
+		memset( &( xDNSCache[ x ] ), 0x0, sizeof( xDNSCache[ x ] ) );
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvLookupDNSCache( const char *pcName, uint32_t *pulIP, TickType_t *pxPrefetchIdentifier )
+	{
+	BaseType_t x;
+	BaseType_t xFound = pdFALSE;
+	uint32_t ulCurrentTimeSeconds = dnsCURRENT_TIME_SECONDS();
+	uint32_t ulAge;
+	DNSCacheRow_t *pxRow;
+
+		*pulIP = 0UL;
+		*pxPrefetchIdentifier = 0U;
+
+		vTaskSuspendAll();
+		{
+			x = prvFindDNSCacheEntry( pcName, prvHashDNSName( pcName ) );
+
+			if( x >= 0 )
+			{
+				pxRow = &( xDNSCache[ x ] );
+				ulAge = ulCurrentTimeSeconds - pxRow->ulTimeWhenAddedInSeconds;
+
+				/* Confirm that the record is still fresh. */
+				if( ulAge < pxRow->ulTTL )
+				{
+					xFound = pdTRUE;
+
+					if( pxRow->ucNumIPAddresses > 0U )
 					{
-						/* Age out the old cached record. */
-						xDNSCache[ x ].pcName[ 0 ] = 0;
+						/* Hand out the addresses in turn. */
+						*pulIP = pxRow->ulIPAddresses[ pxRow->ucCurrentIPAddress ];
+						pxRow->ucCurrentIPAddress++;
+						if( pxRow->ucCurrentIPAddress >= pxRow->ucNumIPAddresses )
+						{
+							pxRow->ucCurrentIPAddress = 0U;
+						}
+
+						#if( ipconfigDNS_CACHE_PREFETCH != 0 )
+						{
+							if( ( pxRow->usPrefetchIdentifier == 0U ) &&
+								( ( pxRow->ulTTL - ulAge ) <= ( pxRow->ulTTL >> 3 ) ) )
+							{
+								/* Let one caller refresh the entry before it
+								expires. */
+								pxRow->usPrefetchIdentifier = ( uint16_t ) ipconfigRAND32();
+								if( pxRow->usPrefetchIdentifier == 0U )
+								{
+									pxRow->usPrefetchIdentifier = 1U;
+								}
+								*pxPrefetchIdentifier = ( TickType_t ) pxRow->usPrefetchIdentifier;
+							}
+						}
+						#endif /* ipconfigDNS_CACHE_PREFETCH */
 					}
 				}
 				else
 				{
-					xDNSCache[ x ].ulIPAddress = *pulIP;
-					xDNSCache[ x ].ulTTL = ulTTL;
-					xDNSCache[ x ].ulTimeWhenAddedInSeconds = ulCurrentTimeSeconds;
+					/* Age out the old cached record. */
+					prvClearDNSCacheEntry( x );
 				}
-
-				xFound = pdTRUE;
-				break;
 			}
 		}
+		xTaskResumeAll();
 
-		if( xFound == pdFALSE )
+		if( xFound != pdFALSE )
 		{
-			if( xLookUp != pdFALSE )
-			{
-				*pulIP = 0;
-			}
-			else
+			FreeRTOS_debug_printf( ( "prvLookupDNSCache: '%s' @ %lxip\n", pcName, FreeRTOS_ntohl( *pulIP ) ) );
+		}
+
+		return xFound;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvStoreDNSCache( const char *pcName, const uint32_t *pulIPAddresses, BaseType_t xCount, uint32_t ulTTL )
+	{
+	BaseType_t x;
+	uint32_t ulNameHash;
+	uint32_t ulCurrentTimeSeconds = dnsCURRENT_TIME_SECONDS();
+	static BaseType_t xFreeEntry = 0;
+
+		if( ( pcName[ 0 ] != '\0' ) && ( strlen( pcName ) < ipconfigDNS_CACHE_NAME_LENGTH ) )
+		{
+			ulNameHash = prvHashDNSName( pcName );
+
+			vTaskSuspendAll();
 			{
-				/* Add or update the item. */
-				if( strlen( pcName ) < ipconfigDNS_CACHE_NAME_LENGTH )
+				x = prvFindDNSCacheEntry( pcName, ulNameHash );
+
+				if( x < 0 )
 				{
-					strcpy( xDNSCache[ xFreeEntry ].pcName, pcName );
+					/* Use an empty or an expired entry if there is one,
+					otherwise overwrite the entries in turn. */
+					for( x = 0; x < ipconfigDNS_CACHE_ENTRIES; x++ )
+					{
+						if( ( xDNSCache[ x ].pcName[ 0 ] == '\0' ) ||
+							( ( ulCurrentTimeSeconds - xDNSCache[ x ].ulTimeWhenAddedInSeconds ) >= xDNSCache[ x ].ulTTL ) )
+						{
+							break;
+						}
+					}
 
-					xDNSCache[ xFreeEntry ].ulIPAddress = *pulIP;
-					xDNSCache[ xFreeEntry ].ulTTL = ulTTL;
-					xDNSCache[ xFreeEntry ].ulTimeWhenAddedInSeconds = ulCurrentTimeSeconds;
+					if( x == ipconfigDNS_CACHE_ENTRIES )
+					{
+						x = xFreeEntry;
+						xFreeEntry++;
+						if( xFreeEntry == ipconfigDNS_CACHE_ENTRIES )
+						{
+							xFreeEntry = 0;
+						}
+					}
+
+					prvClearDNSCacheEntry( x );
+					strcpy( xDNSCache[ x ].pcName, pcName );
+					xDNSCache[ x ].ulNameHash = ulNameHash;
 
-					xFreeEntry++;
-					if( xFreeEntry == ipconfigDNS_CACHE_ENTRIES )
+					#if( ipconfigDNS_CACHE_HASH_TABLE_SIZE > 0 )
 					{
-						xFreeEntry = 0;
+						xDNSCache[ x ].usHashNext = usDNSHashTable[ ulNameHash & ( ipconfigDNS_CACHE_HASH_TABLE_SIZE - 1U ) ];
+						usDNSHashTable[ ulNameHash & ( ipconfigDNS_CACHE_HASH_TABLE_SIZE - 1U ) ] = ( uint16_t ) ( x + 1 );
 					}
+					#endif
 				}
+
+				if( xCount > ( BaseType_t ) ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY )
+				{
+					xCount = ( BaseType_t ) ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY;
+				}
+
+				if( xCount > 0 )
+				{
+					memcpy( xDNSCache[ x ].ulIPAddresses, pulIPAddresses, ( size_t ) xCount * sizeof( uint32_t ) );
+				}
+				xDNSCache[ x ].ucNumIPAddresses = ( uint8_t ) xCount;
+				xDNSCache[ x ].ucCurrentIPAddress = 0U;
+				xDNSCache[ x ].ulTTL = ulTTL;
+				xDNSCache[ x ].ulTimeWhenAddedInSeconds = ulCurrentTimeSeconds;
+
+				#if( ipconfigDNS_CACHE_PREFETCH != 0 )
+				{
+					xDNSCache[ x ].usPrefetchIdentifier = 0U;
+				}
+				#endif
 			}
+			xTaskResumeAll();
+
+			FreeRTOS_debug_printf( ( "prvStoreDNSCache: '%s' @ %lxip (%ld addresses)\n", pcName,
+				( xCount > 0 ) ? FreeRTOS_ntohl( pulIPAddresses[ 0 ] ) : 0UL, xCount ) );
 		}
+	}
+	/*-----------------------------------------------------------*/
+
+	#if( ipconfigDNS_CACHE_PREFETCH != 0 )
 
-		if( ( xLookUp == 0 ) || ( *pulIP != 0 ) )
+		static BaseType_t prvIsDNSPrefetchReply( uint16_t usIdentifier )
 		{
-			FreeRTOS_debug_printf( ( "prvProcessDNSCache: %s: '%s' @ %lxip\n", xLookUp ? "look-up" : "add", pcName, FreeRTOS_ntohl( *pulIP ) ) );
+		BaseType_t x;
+		BaseType_t xResult = pdFALSE;
+
+			/* The identifiers are compared as they appear in the message
+			header. */
+			for( x = 0; x < ipconfigDNS_CACHE_ENTRIES; x++ )
+			{
+				if( ( xDNSCache[ x ].usPrefetchIdentifier != 0U ) &&
+					( xDNSCache[ x ].usPrefetchIdentifier == usIdentifier ) )
+				{
+					xResult = pdTRUE;
+					break;
+				}
+			}
+
+			return xResult;
 		}
-	}
+		/*-----------------------------------------------------------*/
+
+	#endif /* ipconfigDNS_CACHE_PREFETCH */
 
 #endif /* ipconfigUSE_DNS_CACHE */
 
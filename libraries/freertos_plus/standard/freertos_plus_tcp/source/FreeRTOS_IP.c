@@ -45,6 +45,13 @@
 #include "NetworkInterface.h"
 #include "NetworkBufferManagement.h"
 #include "FreeRTOS_DNS.h"
+#include "FreeRTOS_Routing.h"
+#include "FreeRTOS_IPv6.h"
+
+#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+	/* Reference counts are updated by tasks and drivers alike. */
+	#include "atomic.h"
+#endif
 
 
 /* Used to ensure the structure packing is having the desired effect.  The
@@ -87,6 +94,16 @@ shorted in the Windows simulator as simulated time is not real time. */
 	#define ipTCP_TIMER_PERIOD_MS	( 1000 )
 #endif
 
+#if( ( ipconfigUSE_IP_REASSEMBLY != 0 ) && !defined( ipREASSEMBLY_TIMER_PERIOD_MS ) )
+	/* How often incomplete datagrams are checked for a time-out. */
+	#define ipREASSEMBLY_TIMER_PERIOD_MS	( 1000 )
+#endif
+
+#if( ( ipconfigUSE_IPv6 != 0 ) && !defined( ipIPv6_TIMER_PERIOD_MS ) )
+	/* The IPv6 timers count in seconds. */
+	#define ipIPv6_TIMER_PERIOD_MS	( 1000 )
+#endif
+
 /* If ipconfigETHERNET_DRIVER_FILTERS_FRAME_TYPES is set to 1, then the Ethernet
 driver will filter incoming packets and only pass the stack those packets it
 considers need processing.  In this case ipCONSIDER_FRAME_FOR_PROCESSING() can
@@ -107,11 +124,22 @@ character expected to fill ICMP echo replies. */
 #if( ipconfigBYTE_ORDER == pdFREERTOS_LITTLE_ENDIAN )
 	/* The bits in the two byte IP header field that make up the fragment offset value. */
 	#define ipFRAGMENT_OFFSET_BIT_MASK				( ( uint16_t ) 0xff0f )
+	/* The same bits plus the "more fragments" flag, which are zero unless the packet is a fragment. */
+	#define ipFRAGMENT_BIT_MASK						( ( uint16_t ) 0xff3f )
 #else
 	/* The bits in the two byte IP header field that make up the fragment offset value. */
 	#define ipFRAGMENT_OFFSET_BIT_MASK				( ( uint16_t ) 0x0fff )
+	/* The same bits plus the "more fragments" flag, which are zero unless the packet is a fragment. */
+	#define ipFRAGMENT_BIT_MASK						( ( uint16_t ) 0x3fff )
 #endif /* ipconfigBYTE_ORDER */
 
+#if( ( ipconfigUSE_IP_REASSEMBLY != 0 ) && ( ipconfigIP_REASSEMBLY_MAX_SIZE > ipconfigNETWORK_MTU ) )
+	/* A reassembled datagram can be longer than the MTU. */
+	#define ipMAX_IP_DATAGRAM_LENGTH				( ipconfigIP_REASSEMBLY_MAX_SIZE )
+#else
+	#define ipMAX_IP_DATAGRAM_LENGTH				( ipconfigNETWORK_MTU )
+#endif
+
 /* The maximum time the IP task is allowed to remain in the Blocked state if no
 events are posted to the network event queue. */
 #ifndef	ipconfigMAX_IP_TASK_SLEEP_TIME
@@ -232,6 +260,11 @@ static TickType_t prvCalculateSleepTime( void );
  */
 static void prvHandleEthernetPacket( NetworkBufferDescriptor_t *pxBuffer );
 
+/*
+ * A socket has queued a UDP packet to send, as an IPv4 or an IPv6 packet.
+ */
+static void prvHandleGeneratedPacket( NetworkBufferDescriptor_t *pxBuffer );
+
 /*
  * Utility functions for the light weight IP timers.
  */
@@ -255,11 +288,16 @@ reference. */
 const MACAddress_t xBroadcastMACAddress = { { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff } };
 
 /* Structure that stores the netmask, gateway address and DNS server addresses. */
-NetworkAddressingParameters_t xNetworkAddressing = { 0, 0, 0, 0, 0 };
+NetworkAddressingParameters_t xNetworkAddressing = { 0 };
 
 /* Default values for the above struct in case DHCP
 does not lead to a confirmed request. */
-NetworkAddressingParameters_t xDefaultAddressing = { 0, 0, 0, 0, 0 };
+NetworkAddressingParameters_t xDefaultAddressing = { 0 };
+
+#if( ipconfigUSE_MIB_COUNTERS != 0 )
+	/* The counters of the received and sent traffic, see ipMIB_INCREMENT(). */
+	IPMIBCounters_t xIPMIBCounters = { 0 };
+#endif
 
 /* Used to ensure network down events cannot be missed when they cannot be
 posted to the network event queue because the network event queue is already
@@ -289,6 +327,7 @@ regular basis:
 	2. DPHC, to send requests and to renew a reservation
 	3. TCP, to check for timeouts, resends
 	4. DNS, to check for timeouts when looking-up a domain.
+	5. IP reassembly, to discard datagrams that are not completed in time.
  */
 static IPTimer_t xARPTimer;
 #if( ipconfigUSE_DHCP != 0 )
@@ -300,6 +339,12 @@ static IPTimer_t xARPTimer;
 #if( ipconfigDNS_USE_CALLBACKS != 0 )
 	static IPTimer_t xDNSTimer;
 #endif
+#if( ipconfigUSE_IP_REASSEMBLY != 0 )
+	static IPTimer_t xReassemblyTimer;
+#endif
+#if( ipconfigUSE_IPv6 != 0 )
+	static IPTimer_t xIPv6Timer;
+#endif
 
 /* Set to pdTRUE when the IP task is ready to start processing packets. */
 static BaseType_t xIPTaskInitialised = pdFALSE;
@@ -309,6 +354,12 @@ static BaseType_t xIPTaskInitialised = pdFALSE;
 	static UBaseType_t uxQueueMinimumSpace = ipconfigEVENT_QUEUE_LENGTH;
 #endif
 
+#if( ( ipconfigUSE_DRIVER_OFFLOADS != 0 ) && ( ipconfigUSE_MULTI_INTERFACE == 0 ) )
+	/* The offloads advertised by the driver, see FreeRTOS_SetNetworkOffloads(). */
+	static UBaseType_t uxNetworkOffloads = 0U;
+	static size_t uxNetworkMaxFrameLength = 0U;
+#endif
+
 /*-----------------------------------------------------------*/
 
 static void prvIPTask( void *pvParameters )
@@ -337,6 +388,18 @@ struct freertos_sockaddr xAddress;
 	}
 	#endif
 
+	#if( ipconfigUSE_IP_REASSEMBLY != 0 )
+	{
+		prvIPTimerReload( &xReassemblyTimer, pdMS_TO_TICKS( ipREASSEMBLY_TIMER_PERIOD_MS ) );
+	}
+	#endif
+
+	#if( ipconfigUSE_IPv6 != 0 )
+	{
+		prvIPTimerReload( &xIPv6Timer, pdMS_TO_TICKS( ipIPv6_TIMER_PERIOD_MS ) );
+	}
+	#endif
+
 	/* Initialisation is complete and events can now be processed. */
 	xIPTaskInitialised = pdTRUE;
 
@@ -430,7 +493,24 @@ struct freertos_sockaddr xAddress;
 				/* The network stack has generated a packet to send.  A
 				pointer to the generated buffer is located in the pvData
 				member of the received event structure. */
-				vProcessGeneratedUDPPacket( ( NetworkBufferDescriptor_t * ) ( xReceivedEvent.pvData ) );
+				prvHandleGeneratedPacket( ( NetworkBufferDescriptor_t * ) ( xReceivedEvent.pvData ) );
+				break;
+
+			case eStackTxBatchEvent :
+				/* FreeRTOS_sendmmsg() has generated a number of packets,
+				linked through their 'pxNextBuffer' field. */
+				#if( ipconfigUSE_UDP_BATCH != 0 )
+				{
+				NetworkBufferDescriptor_t *pxBuffer, *pxNextBuffer;
+
+					for( pxBuffer = ( NetworkBufferDescriptor_t * ) ( xReceivedEvent.pvData ); pxBuffer != NULL; pxBuffer = pxNextBuffer )
+					{
+						pxNextBuffer = pxBuffer->pxNextBuffer;
+						pxBuffer->pxNextBuffer = NULL;
+						prvHandleGeneratedPacket( pxBuffer );
+					}
+				}
+				#endif /* ipconfigUSE_UDP_BATCH */
 				break;
 
 			case eDHCPEvent:
@@ -442,6 +522,15 @@ struct freertos_sockaddr xAddress;
 				#endif /* ipconfigUSE_DHCP */
 				break;
 
+			case eDNSEvent:
+				/* Outstanding DNS look-ups need processing. */
+				#if( ipconfigDNS_USE_CALLBACKS != 0 )
+				{
+					vDNSProcess();
+				}
+				#endif /* ipconfigDNS_USE_CALLBACKS */
+				break;
+
 			case eSocketSelectEvent :
 				/* FreeRTOS_select() has got unblocked by a socket event,
 				vSocketSelect() will check which sockets actually have an event
@@ -539,6 +628,7 @@ static void prvHandleEthernetPacket( NetworkBufferDescriptor_t *pxBuffer )
 		/* When ipconfigUSE_LINKED_RX_MESSAGES is not set to 0 then only one
 		buffer will be sent at a time.  This is the default way for +TCP to pass
 		messages from the MAC to the TCP/IP stack. */
+		ipCAPTURE_RECEIVED( pxBuffer );
 		prvProcessEthernetPacket( pxBuffer );
 	}
 	#else /* ipconfigUSE_LINKED_RX_MESSAGES */
@@ -559,6 +649,7 @@ static void prvHandleEthernetPacket( NetworkBufferDescriptor_t *pxBuffer )
 			/* Make it NULL to avoid using it later on. */
 			pxBuffer->pxNextBuffer = NULL;
 
+			ipCAPTURE_RECEIVED( pxBuffer );
 			prvProcessEthernetPacket( pxBuffer );
 			pxBuffer = pxNextBuffer;
 
@@ -569,6 +660,21 @@ static void prvHandleEthernetPacket( NetworkBufferDescriptor_t *pxBuffer )
 }
 /*-----------------------------------------------------------*/
 
+static void prvHandleGeneratedPacket( NetworkBufferDescriptor_t *pxBuffer )
+{
+	#if( ipconfigUSE_IPv6 != 0 )
+	if( pxBuffer->xUsesIPv6 != pdFALSE )
+	{
+		vIPv6ProcessGeneratedUDPPacket( pxBuffer );
+	}
+	else
+	#endif /* ipconfigUSE_IPv6 */
+	{
+		vProcessGeneratedUDPPacket( pxBuffer );
+	}
+}
+/*-----------------------------------------------------------*/
+
 static TickType_t prvCalculateSleepTime( void )
 {
 TickType_t xMaximumSleepTime;
@@ -618,6 +724,24 @@ TickType_t xMaximumSleepTime;
 	}
 	#endif
 
+	#if( ipconfigUSE_IP_REASSEMBLY != 0 )
+	{
+		if( xReassemblyTimer.ulRemainingTime < xMaximumSleepTime )
+		{
+			xMaximumSleepTime = xReassemblyTimer.ulRemainingTime;
+		}
+	}
+	#endif
+
+	#if( ipconfigUSE_IPv6 != 0 )
+	{
+		if( xIPv6Timer.ulRemainingTime < xMaximumSleepTime )
+		{
+			xMaximumSleepTime = xIPv6Timer.ulRemainingTime;
+		}
+	}
+	#endif
+
 	return xMaximumSleepTime;
 }
 /*-----------------------------------------------------------*/
@@ -642,16 +766,34 @@ static void prvCheckNetworkTimers( void )
 
 	#if( ipconfigDNS_USE_CALLBACKS != 0 )
 	{
-	extern void vDNSCheckCallBack( void *pvSearchID );
-
 		/* Is it time for DNS processing? */
 		if( prvIPTimerCheck( &xDNSTimer ) != pdFALSE )
 		{
-			vDNSCheckCallBack( NULL );
+			xSendEventToIPTask( eDNSEvent );
 		}
 	}
 	#endif /* ipconfigDNS_USE_CALLBACKS */
 
+	#if( ipconfigUSE_IP_REASSEMBLY != 0 )
+	{
+		/* Is it time to discard incomplete datagrams? */
+		if( prvIPTimerCheck( &xReassemblyTimer ) != pdFALSE )
+		{
+			vIPReassemblyCheckTimeouts();
+		}
+	}
+	#endif /* ipconfigUSE_IP_REASSEMBLY */
+
+	#if( ipconfigUSE_IPv6 != 0 )
+	{
+		/* Is it time for address configuration and neighbour discovery? */
+		if( prvIPTimerCheck( &xIPv6Timer ) != pdFALSE )
+		{
+			vIPv6CheckTimers();
+		}
+	}
+	#endif /* ipconfigUSE_IPv6 */
+
 	#if( ipconfigUSE_TCP == 1 )
 	{
 	BaseType_t xWillSleep;
@@ -799,8 +941,18 @@ void *pvReturn;
 		xBlockTimeTicks = ipconfigUDP_MAX_SEND_BLOCK_TIME_TICKS;
 	}
 
-	/* Obtain a network buffer with the required amount of storage. */
-	pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( sizeof( UDPPacket_t ) + xRequestedSizeBytes, xBlockTimeTicks );
+	/* Obtain a network buffer with the required amount of storage.  The
+	buffer may be passed to FreeRTOS_sendto() with an IPv6 address, which
+	needs a longer header. */
+	#if( ipconfigUSE_IPv6 != 0 )
+	{
+		pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( sizeof( UDPPacket_t ) + xRequestedSizeBytes + ipIPv6_EXTRA_HEADER_LENGTH, xBlockTimeTicks );
+	}
+	#else
+	{
+		pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( sizeof( UDPPacket_t ) + xRequestedSizeBytes, xBlockTimeTicks );
+	}
+	#endif
 
 	if( pxNetworkBuffer != NULL )
 	{
@@ -823,29 +975,130 @@ NetworkBufferDescriptor_t *pxDuplicateNetworkBufferWithDescriptor( NetworkBuffer
 	BaseType_t xNewLength )
 {
 NetworkBufferDescriptor_t * pxNewBuffer;
+size_t uxPayloadLength = 0U;
+
+	#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+	{
+		/* The payload is copied behind the headers. */
+		uxPayloadLength = pxNetworkBuffer->uxPayloadLength;
+	}
+	#endif
 
 	/* This function is only used when 'ipconfigZERO_COPY_TX_DRIVER' is set to 1.
 	The transmit routine wants to have ownership of the network buffer
 	descriptor, because it will pass the buffer straight to DMA. */
-	pxNewBuffer = pxGetNetworkBufferWithDescriptor( ( size_t ) xNewLength, ( TickType_t ) 0 );
+	pxNewBuffer = pxGetNetworkBufferWithDescriptor( ( size_t ) xNewLength + uxPayloadLength, ( TickType_t ) 0 );
 
 	if( pxNewBuffer != NULL )
 	{
 		/* Set the actual packet size in case a bigger buffer than requested
 		was returned. */
-		pxNewBuffer->xDataLength = xNewLength;
+		pxNewBuffer->xDataLength = ( size_t ) xNewLength + uxPayloadLength;
 
 		/* Copy the original packet information. */
 		pxNewBuffer->ulIPAddress = pxNetworkBuffer->ulIPAddress;
 		pxNewBuffer->usPort = pxNetworkBuffer->usPort;
 		pxNewBuffer->usBoundPort = pxNetworkBuffer->usBoundPort;
 		memcpy( pxNewBuffer->pucEthernetBuffer, pxNetworkBuffer->pucEthernetBuffer, pxNetworkBuffer->xDataLength );
+
+		#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+		{
+			if( ipIS_CHAINED( pxNetworkBuffer ) )
+			{
+				memcpy( &( pxNewBuffer->pucEthernetBuffer[ pxNetworkBuffer->xDataLength ] ), pxNetworkBuffer->pucPayload, uxPayloadLength );
+			}
+		}
+		#endif
 	}
 
 	return pxNewBuffer;
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+
+	NetworkBufferDescriptor_t *pxNetworkBufferReference( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+	{
+		/* A buffer that is referenced has at least one owner already. */
+		configASSERT( pxNetworkBuffer->ulReferenceCount != 0UL );
+		( void ) Atomic_Increment_u32( &( pxNetworkBuffer->ulReferenceCount ) );
+
+		return pxNetworkBuffer;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vNetworkBufferChainPayload( NetworkBufferDescriptor_t * const pxNetworkBuffer, NetworkBufferDescriptor_t *pxPayloadBuffer,
+		uint8_t *pucPayload, size_t uxPayloadLength )
+	{
+		/* A frame has at most one payload, and a payload is not chained itself. */
+		configASSERT( pxNetworkBuffer->pxPayloadBuffer == NULL );
+		configASSERT( pxPayloadBuffer->pxPayloadBuffer == NULL );
+
+		pxNetworkBuffer->pxPayloadBuffer = pxNetworkBufferReference( pxPayloadBuffer );
+		pxNetworkBuffer->pucPayload = pucPayload;
+		pxNetworkBuffer->uxPayloadLength = uxPayloadLength;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vNetworkBufferUnchain( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+	{
+	NetworkBufferDescriptor_t *pxPayloadBuffer = pxNetworkBuffer->pxPayloadBuffer;
+
+		if( pxPayloadBuffer != NULL )
+		{
+			pxNetworkBuffer->pxPayloadBuffer = NULL;
+			pxNetworkBuffer->pucPayload = NULL;
+			pxNetworkBuffer->uxPayloadLength = 0U;
+			vReleaseNetworkBufferAndDescriptor( pxPayloadBuffer );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	void vNetworkBufferWrapData( NetworkBufferDescriptor_t * const pxNetworkBuffer, uint8_t *pucData, size_t uxLength,
+		NetworkBufferReleaseFunction_t pxReleaseCallback )
+	{
+		/* The callback is what keeps the descriptor out of the pool. */
+		configASSERT( pxReleaseCallback != NULL );
+
+		memset( pxNetworkBuffer, '\0', sizeof( *pxNetworkBuffer ) );
+		vListInitialiseItem( &( pxNetworkBuffer->xBufferListItem ) );
+		listSET_LIST_ITEM_OWNER( &( pxNetworkBuffer->xBufferListItem ), ( void * ) pxNetworkBuffer );
+		pxNetworkBuffer->pucEthernetBuffer = pucData;
+		pxNetworkBuffer->xDataLength = uxLength;
+		pxNetworkBuffer->ulReferenceCount = 1UL;
+		pxNetworkBuffer->pxReleaseCallback = pxReleaseCallback;
+	}
+	/*-----------------------------------------------------------*/
+
+	BaseType_t xNetworkBufferReleaseReference( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+	{
+	BaseType_t xReturn = pdFALSE;
+
+		/* Atomic_Decrement_u32() returns the count from before the
+		decrement. */
+		configASSERT( pxNetworkBuffer->ulReferenceCount != 0UL );
+
+		if( Atomic_Decrement_u32( &( pxNetworkBuffer->ulReferenceCount ) ) == 1UL )
+		{
+			vNetworkBufferUnchain( pxNetworkBuffer );
+
+			if( pxNetworkBuffer->pxReleaseCallback != NULL )
+			{
+				/* The buffer belongs to the application. */
+				pxNetworkBuffer->pxReleaseCallback( pxNetworkBuffer );
+			}
+			else
+			{
+				xReturn = pdTRUE;
+			}
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_NETWORK_BUFFER_CHAINS */
+
 #if( ipconfigZERO_COPY_TX_DRIVER != 0 ) || ( ipconfigZERO_COPY_RX_DRIVER != 0 )
 
 	NetworkBufferDescriptor_t *pxPacketBuffer_to_NetworkBuffer( const void *pvBuffer )
@@ -994,7 +1247,8 @@ BaseType_t xReturn = pdFALSE;
 			header fragment, which is used when sending UDP packets. */
 			memcpy( ( void * ) ipLOCAL_MAC_ADDRESS, ( void * ) ucMACAddress, ( size_t ) ipMAC_ADDRESS_LENGTH_BYTES );
 
-			/* Prepare the sockets interface. */
+			/* Prepare the ARP cache and the sockets interface. */
+			vARPInitialiseCache();
 			xReturn = vNetworkSocketsInit();
 
 			if( pdTRUE == xReturn )
@@ -1214,6 +1468,44 @@ BaseType_t xReturn, xSendMessage;
 }
 /*-----------------------------------------------------------*/
 
+BaseType_t xSendNetworkBuffersToIPTask( NetworkBufferDescriptor_t *pxFirstBuffer, TickType_t xTimeout )
+{
+IPStackEvent_t xRxEvent;
+BaseType_t xReturn;
+
+	xRxEvent.eEventType = eNetworkRxEvent;
+	xRxEvent.pvData = ( void * ) pxFirstBuffer;
+
+	xReturn = xSendEventStructToIPTask( &xRxEvent, xTimeout );
+
+	if( xReturn == pdFAIL )
+	{
+		#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+		{
+		NetworkBufferDescriptor_t *pxNextBuffer;
+
+			/* None of the frames in the chain will be processed. */
+			while( pxFirstBuffer != NULL )
+			{
+				pxNextBuffer = pxFirstBuffer->pxNextBuffer;
+				pxFirstBuffer->pxNextBuffer = NULL;
+				vReleaseNetworkBufferAndDescriptor( pxFirstBuffer );
+				pxFirstBuffer = pxNextBuffer;
+			}
+		}
+		#else
+		{
+			vReleaseNetworkBufferAndDescriptor( pxFirstBuffer );
+		}
+		#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
+
+		iptraceETHERNET_RX_EVENT_LOST();
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
 eFrameProcessingResult_t eConsiderFrameForProcessing( const uint8_t * const pucEthernetBuffer )
 {
 eFrameProcessingResult_t eReturn;
@@ -1221,7 +1513,11 @@ const EthernetHeader_t *pxEthernetHeader;
 
 	pxEthernetHeader = ( const EthernetHeader_t * ) pucEthernetBuffer;
 
+	#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+	if( FreeRTOS_FindEndPointOnMAC( &( pxEthernetHeader->xDestinationAddress ) ) != NULL )
+	#else
 	if( memcmp( ( void * ) ipLOCAL_MAC_ADDRESS, ( void * ) &( pxEthernetHeader->xDestinationAddress ), sizeof( MACAddress_t ) ) == 0 )
+	#endif
 	{
 		/* The packet was directed to this node directly - process it. */
 		eReturn = eProcessBuffer;
@@ -1240,10 +1536,20 @@ const EthernetHeader_t *pxEthernetHeader;
 	}
 	else
 #endif /* ipconfigUSE_LLMNR */
+#if( ipconfigUSE_IPv6 != 0 )
+	if( ( pxEthernetHeader->xDestinationAddress.ucBytes[ 0 ] == 0x33U ) && ( pxEthernetHeader->xDestinationAddress.ucBytes[ 1 ] == 0x33U ) )
+	{
+		/* An IPv6 multicast, which eIPv6ProcessPacket() filters on its IP
+		address - process it. */
+		eReturn = eProcessBuffer;
+	}
+	else
+#endif /* ipconfigUSE_IPv6 */
 	{
 		/* The packet was not a broadcast, or for this node, just release
 		the buffer without taking any other action. */
 		eReturn = eReleaseBuffer;
+		ipMIB_INCREMENT( ulFramesNotForUs );
 	}
 
 	#if( ipconfigFILTER_OUT_NON_ETHERNET_II_FRAMES == 1 )
@@ -1259,6 +1565,7 @@ const EthernetHeader_t *pxEthernetHeader;
 			{
 				/* Not an Ethernet II frame. */
 				eReturn = eReleaseBuffer;
+				ipMIB_INCREMENT( ulFramesNotEthernetII );
 			}
 		}
 	}
@@ -1306,6 +1613,14 @@ static void prvProcessNetworkDownEvent( void )
 	}
 	else
 	{
+		#if( ipconfigUSE_IPv6 != 0 )
+		{
+			/* IPv6 does not wait for DHCP, its link-local address is
+			configured from the MAC address. */
+			vIPv6NetworkUp();
+		}
+		#endif /* ipconfigUSE_IPv6 */
+
 		/* Set remaining time to 0 so it will become active immediately. */
 		#if ipconfigUSE_DHCP == 1
 		{
@@ -1354,12 +1669,22 @@ eFrameProcessingResult_t eReturned = eReleaseBuffer;
 
 	configASSERT( pxNetworkBuffer );
 
+	ipMIB_INCREMENT( ulFramesReceived );
+
 	/* Interpret the Ethernet frame. */
 	if( pxNetworkBuffer->xDataLength >= sizeof( EthernetHeader_t ) )
 	{
 		eReturned = ipCONSIDER_FRAME_FOR_PROCESSING( pxNetworkBuffer->pucEthernetBuffer );
 		pxEthernetHeader = ( EthernetHeader_t * )( pxNetworkBuffer->pucEthernetBuffer );
 
+		#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+		{
+			/* Find the end-point to which the frame is addressed.  A reply
+			to the frame will be sent from the same end-point. */
+			pxNetworkBuffer->pxEndPoint = pxRoutingMatchingEndPoint( pxNetworkBuffer->pxInterface, pxNetworkBuffer->pucEthernetBuffer );
+		}
+		#endif /* ipconfigUSE_MULTI_INTERFACE */
+
 		if( eReturned == eProcessBuffer )
 		{
 			/* Interpret the received Ethernet packet. */
@@ -1389,9 +1714,25 @@ eFrameProcessingResult_t eReturned = eReleaseBuffer;
 				}
 				break;
 
+			case ipIPv6_FRAME_TYPE:
+				/* The Ethernet frame contains an IPv6 packet, which checks
+				its own length. */
+				#if( ipconfigUSE_IPv6 != 0 )
+				{
+					eReturned = eIPv6ProcessPacket( pxNetworkBuffer );
+				}
+				#else
+				{
+					eReturned = eReleaseBuffer;
+					ipMIB_INCREMENT( ulFramesUnknownType );
+				}
+				#endif /* ipconfigUSE_IPv6 */
+				break;
+
 			default:
 				/* No other packet types are handled.  Nothing to do. */
 				eReturned = eReleaseBuffer;
+				ipMIB_INCREMENT( ulFramesUnknownType );
 				break;
 			}
 		}
@@ -1442,15 +1783,19 @@ eFrameProcessingResult_t eReturn = eProcessBuffer;
 		/* In systems with a very small amount of RAM, it might be advantageous
 		to have incoming messages checked earlier, by the network card driver.
 		This method may decrease the usage of sparse network buffers. */
+	#if( ipconfigUSE_MULTI_INTERFACE == 0 )
 		uint32_t ulDestinationIPAddress = pxIPHeader->ulDestinationIPAddress;
+	#endif
 
 			/* Ensure that the incoming packet is not fragmented (only outgoing
 			packets can be fragmented) as these are the only handled IP frames
-			currently. */
-			if( ( pxIPHeader->usFragmentOffset & ipFRAGMENT_OFFSET_BIT_MASK ) != 0U )
+			currently, unless fragments are reassembled. */
+			if( ( ipconfigUSE_IP_REASSEMBLY == 0 ) &&
+				( ( pxIPHeader->usFragmentOffset & ipFRAGMENT_OFFSET_BIT_MASK ) != 0U ) )
 			{
 				/* Can not handle, fragmented packet. */
 				eReturn = eReleaseBuffer;
+				ipMIB_INCREMENT( ulIPInFragmentDrops );
 			}
 			/* 0x45 means: IPv4 with an IP header of 5 x 4 = 20 bytes
 			 * 0x47 means: IPv4 with an IP header of 7 x 4 = 28 bytes */
@@ -1458,7 +1803,17 @@ eFrameProcessingResult_t eReturn = eProcessBuffer;
 			{
 				/* Can not handle, unknown or invalid header version. */
 				eReturn = eReleaseBuffer;
+				ipMIB_INCREMENT( ulIPInHdrErrors );
+			}
+		#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+			/* Is the packet for one of the end-points of the interface? */
+			else if( pxNetworkBuffer->pxEndPoint == NULL )
+			{
+				/* Packet is not for this node, release it */
+				eReturn = eReleaseBuffer;
+				ipMIB_INCREMENT( ulIPInAddrErrors );
 			}
+		#else
 				/* Is the packet for this IP address? */
 			else if( ( ulDestinationIPAddress != *ipLOCAL_IP_ADDRESS_POINTER ) &&
 				/* Is it the global broadcast address 255.255.255.255 ? */
@@ -1474,7 +1829,9 @@ eFrameProcessingResult_t eReturn = eProcessBuffer;
 			{
 				/* Packet is not for this node, release it */
 				eReturn = eReleaseBuffer;
+				ipMIB_INCREMENT( ulIPInAddrErrors );
 			}
+		#endif /* ipconfigUSE_MULTI_INTERFACE */
 	}
 	#endif /* ipconfigETHERNET_DRIVER_FILTERS_PACKETS */
 
@@ -1484,18 +1841,31 @@ eFrameProcessingResult_t eReturn = eProcessBuffer;
 		define, so that the checksum won't be checked again here */
 		if (eReturn == eProcessBuffer )
 		{
+			if( ipHAS_OFFLOAD( pxNetworkBuffer, ipOFFLOAD_RX_CHECKSUM ) )
+			{
+				/* The driver has checked both checksums already. */
+			}
 			/* Is the IP header checksum correct? */
-			if( ( pxIPHeader->ucProtocol != ( uint8_t ) ipPROTOCOL_ICMP ) &&
+			else if( ( pxIPHeader->ucProtocol != ( uint8_t ) ipPROTOCOL_ICMP ) &&
 				( usGenerateChecksum( 0UL, ( uint8_t * ) &( pxIPHeader->ucVersionHeaderLength ), ( size_t ) uxHeaderLength ) != ipCORRECT_CRC ) )
 			{
 				/* Check sum in IP-header not correct. */
 				eReturn = eReleaseBuffer;
+				ipMIB_INCREMENT( ulIPInHdrErrors );
 			}
+		#if( ipconfigUSE_IP_REASSEMBLY != 0 )
+			else if( ( pxIPHeader->usFragmentOffset & ipFRAGMENT_BIT_MASK ) != 0U )
+			{
+				/* The upper-layer checksum covers the whole datagram, it is
+				checked once the datagram has been reassembled. */
+			}
+		#endif
 			/* Is the upper-layer checksum (TCP/UDP/ICMP) correct? */
 			else if( usGenerateProtocolChecksum( ( uint8_t * )( pxNetworkBuffer->pucEthernetBuffer ), pxNetworkBuffer->xDataLength, pdFALSE ) != ipCORRECT_CRC )
 			{
 				/* Protocol checksum not accepted. */
 				eReturn = eReleaseBuffer;
+				ipMIB_INCREMENT( ulIPInChecksumErrors );
 			}
 		}
 	}
@@ -1521,9 +1891,12 @@ uint8_t ucProtocol;
 	/* Bound the calculated header length: take away the Ethernet header size,
 	then check if the IP header is claiming to be longer than the remaining
 	total packet size. Also check for minimal header field length. */
+	ipMIB_INCREMENT( ulIPInReceives );
+
 	if( ( uxHeaderLength > ( pxNetworkBuffer->xDataLength - ipSIZE_OF_ETH_HEADER ) ) ||
 		( uxHeaderLength < ipSIZE_OF_IPv4_HEADER ) )
 	{
+		ipMIB_INCREMENT( ulIPInHdrErrors );
 		return eReleaseBuffer;
 	}
 
@@ -1531,6 +1904,36 @@ uint8_t ucProtocol;
 	/* Check if the IP headers are acceptable and if it has our destination. */
 	eReturn = prvAllowIPPacket( pxIPPacket, pxNetworkBuffer, uxHeaderLength );
 
+	#if( ipconfigUSE_IP_REASSEMBLY != 0 )
+	{
+		if( ( eReturn == eProcessBuffer ) && ( ( pxIPHeader->usFragmentOffset & ipFRAGMENT_BIT_MASK ) != 0U ) )
+		{
+		NetworkBufferDescriptor_t *pxDatagram;
+
+			/* The data of the fragment is copied, so it can be released.  A
+			datagram that is complete is processed as if it was received
+			in one piece. */
+			pxDatagram = pxIPReassemble( pxNetworkBuffer, uxHeaderLength );
+			eReturn = eReleaseBuffer;
+
+			if( pxDatagram != NULL )
+			{
+				if( ( ( ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM != 0 ) || ipHAS_OFFLOAD( pxDatagram, ipOFFLOAD_RX_CHECKSUM ) ) &&
+					( usGenerateProtocolChecksum( pxDatagram->pucEthernetBuffer, pxDatagram->xDataLength, pdFALSE ) != ipCORRECT_CRC ) )
+				{
+					/* A driver that checks the upper-layer checksum can not do
+					so for a fragmented datagram, it is checked here. */
+					vReleaseNetworkBufferAndDescriptor( pxDatagram );
+				}
+				else
+				{
+					prvProcessEthernetPacket( pxDatagram );
+				}
+			}
+		}
+	}
+	#endif /* ipconfigUSE_IP_REASSEMBLY */
+
 	if( eReturn == eProcessBuffer )
 	{
 		if( uxHeaderLength > ipSIZE_OF_IPv4_HEADER )
@@ -1570,6 +1973,9 @@ uint8_t ucProtocol;
 		switch( ucProtocol )
 		{
 			case ipPROTOCOL_ICMP :
+				ipMIB_INCREMENT( ulIPInDelivers );
+				ipMIB_INCREMENT( ulICMPInMsgs );
+
 				/* The IP packet contained an ICMP frame.  Don't bother
 				checking the ICMP checksum, as if it is wrong then the
 				wrong data will also be returned, and the source of the
@@ -1580,7 +1986,12 @@ uint8_t ucProtocol;
 					if( pxNetworkBuffer->xDataLength >= sizeof( ICMPPacket_t ) )
 					{
 						ICMPPacket_t *pxICMPPacket = ( ICMPPacket_t * )( pxNetworkBuffer->pucEthernetBuffer );
+					#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+						if( ( pxNetworkBuffer->pxEndPoint != NULL ) &&
+							( pxIPHeader->ulDestinationIPAddress == pxNetworkBuffer->pxEndPoint->ulIPAddress ) )
+					#else
 						if( pxIPHeader->ulDestinationIPAddress == *ipLOCAL_IP_ADDRESS_POINTER )
+					#endif
 						{
 							eReturn = prvProcessICMPPacket( pxICMPPacket );
 						}
@@ -1598,6 +2009,8 @@ uint8_t ucProtocol;
 					/* The IP packet contained a UDP frame. */
 					UDPPacket_t *pxUDPPacket = ( UDPPacket_t * ) ( pxNetworkBuffer->pucEthernetBuffer );
 
+					ipMIB_INCREMENT( ulIPInDelivers );
+
 					/* Only proceed if the payload length indicated in the header
 					appears to be valid. */
 					if ( pxNetworkBuffer->xDataLength >= sizeof( UDPPacket_t ) )
@@ -1637,6 +2050,7 @@ uint8_t ucProtocol;
 					else
 					{
 						eReturn = eReleaseBuffer;
+						ipMIB_INCREMENT( ulUDPInErrors );
 					}
 				}
 				break;
@@ -1644,6 +2058,7 @@ uint8_t ucProtocol;
 #if ipconfigUSE_TCP == 1
 			case ipPROTOCOL_TCP :
 				{
+					ipMIB_INCREMENT( ulIPInDelivers );
 
 					if( xProcessReceivedTCPPacket( pxNetworkBuffer ) == pdPASS )
 					{
@@ -1658,6 +2073,7 @@ uint8_t ucProtocol;
 #endif
 			default	:
 				/* Not a supported frame type. */
+				ipMIB_INCREMENT( ulIPInUnknownProtos );
 				break;
 		}
 	}
@@ -1753,6 +2169,9 @@ uint8_t ucProtocol;
 				( ( ( uint32_t ) pxICMPHeader->usChecksum ) +
 					FreeRTOS_htons( usRequest ) );
 		}
+
+		ipMIB_INCREMENT( ulICMPOutMsgs );
+
 		return eReturnEthernetFrame;
 	}
 
@@ -1914,7 +2333,7 @@ uint8_t ucProtocol;
 		( FreeRTOS_ntohs( pxIPPacket->xIPHeader.usLength ) - ( ( uint16_t ) uxIPHeaderLength ) ); /* normally minus 20 */
 
 	if( ( ulLength < sizeof( pxProtPack->xUDPPacket.xUDPHeader ) ) ||
-		( ulLength > ( uint32_t )( ipconfigNETWORK_MTU - uxIPHeaderLength ) ) )
+		( ulLength > ( uint32_t )( ipMAX_IP_DATAGRAM_LENGTH - uxIPHeaderLength ) ) )
 	{
 		#if( ipconfigHAS_DEBUG_PRINTF != 0 )
 		{
@@ -1997,6 +2416,11 @@ uint8_t ucProtocol;
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_CHECKSUM_KERNELS == 0 )
+
+/* With ipconfigUSE_CHECKSUM_KERNELS, usGenerateChecksum() is implemented by
+FreeRTOS_Checksum.c. */
+
 /**
  * This method generates a checksum for a given IPv4 header, per RFC791 (page 14).
  * The checksum algorithm is decribed as:
@@ -2146,6 +2570,8 @@ uint32_t ulAlignBits, ulCarry = 0ul;
 }
 /*-----------------------------------------------------------*/
 
+#endif /* ipconfigUSE_CHECKSUM_KERNELS == 0 */
+
 void vReturnEthernetFrame( NetworkBufferDescriptor_t * pxNetworkBuffer, BaseType_t xReleaseAfterSend )
 {
 EthernetHeader_t *pxEthernetHeader;
@@ -2189,6 +2615,7 @@ EthernetHeader_t *pxEthernetHeader;
 		memcpy( ( void * ) &( pxEthernetHeader->xSourceAddress) , ( void * ) ipLOCAL_MAC_ADDRESS, ( size_t ) ipMAC_ADDRESS_LENGTH_BYTES );
 
 		/* Send! */
+		ipCAPTURE_SENT( pxNetworkBuffer );
 		xNetworkInterfaceOutput( pxNetworkBuffer, xReleaseAfterSend );
 	}
 }
@@ -2220,6 +2647,43 @@ uint32_t FreeRTOS_GetDNSServerAddress( void )
 }
 /*-----------------------------------------------------------*/
 
+/* The DNS servers are tried in turn, index 0 is the server returned by
+FreeRTOS_GetDNSServerAddress().  Indexes beyond ipconfigDNS_MAX_SERVERS
+read as 0 and can not be set. */
+uint32_t FreeRTOS_GetDNSServerAddressAt( BaseType_t xIndex )
+{
+uint32_t ulDNSServerAddress = 0UL;
+
+	if( xIndex == 0 )
+	{
+		ulDNSServerAddress = xNetworkAddressing.ulDNSServerAddress;
+	}
+	#if( ipconfigDNS_MAX_SERVERS > 1 )
+	else if( ( xIndex > 0 ) && ( xIndex < ( BaseType_t ) ipconfigDNS_MAX_SERVERS ) )
+	{
+		ulDNSServerAddress = xNetworkAddressing.ulAlternateDNSServerAddresses[ xIndex - 1 ];
+	}
+	#endif
+
+	return ulDNSServerAddress;
+}
+/*-----------------------------------------------------------*/
+
+void FreeRTOS_SetDNSServerAddressAt( BaseType_t xIndex, uint32_t ulDNSServerAddress )
+{
+	if( xIndex == 0 )
+	{
+		xNetworkAddressing.ulDNSServerAddress = ulDNSServerAddress;
+	}
+	#if( ipconfigDNS_MAX_SERVERS > 1 )
+	else if( ( xIndex > 0 ) && ( xIndex < ( BaseType_t ) ipconfigDNS_MAX_SERVERS ) )
+	{
+		xNetworkAddressing.ulAlternateDNSServerAddresses[ xIndex - 1 ] = ulDNSServerAddress;
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
 uint32_t FreeRTOS_GetNetmask( void )
 {
 	return xNetworkAddressing.ulNetMask;
@@ -2317,6 +2781,102 @@ BaseType_t FreeRTOS_IsNetworkUp( void )
 #endif
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_MIB_COUNTERS != 0 )
+	void FreeRTOS_GetMIBCounters( IPMIBCounters_t *pxCounters, BaseType_t xReset )
+	{
+		/* The IP-task may not update the counters while they are copied, or
+		between the copy and the reset. */
+		vTaskSuspendAll();
+		{
+			memcpy( pxCounters, &xIPMIBCounters, sizeof( *pxCounters ) );
+
+			if( xReset != pdFALSE )
+			{
+				memset( &xIPMIBCounters, '\0', sizeof( xIPMIBCounters ) );
+			}
+		}
+		xTaskResumeAll();
+	}
+#endif /* ipconfigUSE_MIB_COUNTERS */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_DRIVER_OFFLOADS != 0 )
+
+	#if( ipconfigUSE_MULTI_INTERFACE == 0 )
+
+		void FreeRTOS_SetNetworkOffloads( UBaseType_t uxOffloads, size_t uxMaxFrameLength )
+		{
+			uxNetworkOffloads = uxOffloads;
+			uxNetworkMaxFrameLength = uxMaxFrameLength;
+		}
+		/*-----------------------------------------------------------*/
+
+	#endif /* ipconfigUSE_MULTI_INTERFACE == 0 */
+
+	UBaseType_t uxIPGetOffloads( const NetworkBufferDescriptor_t *pxNetworkBuffer, size_t *puxMaxFrameLength )
+	{
+	UBaseType_t uxOffloads;
+	size_t uxMaxFrameLength;
+
+		#if( ipconfigUSE_MULTI_INTERFACE == 0 )
+		{
+			( void ) pxNetworkBuffer;
+			uxOffloads = uxNetworkOffloads;
+			uxMaxFrameLength = uxNetworkMaxFrameLength;
+		}
+		#else
+		{
+		const NetworkInterface_t *pxInterface = pxNetworkBuffer->pxInterface;
+
+			/* An outgoing frame is sent through the interface of its
+			end-point. */
+			if( pxNetworkBuffer->pxEndPoint != NULL )
+			{
+				pxInterface = pxNetworkBuffer->pxEndPoint->pxNetworkInterface;
+			}
+
+			if( pxInterface != NULL )
+			{
+				uxOffloads = pxInterface->uxOffloads;
+				uxMaxFrameLength = pxInterface->uxMaxFrameLength;
+			}
+			else
+			{
+				uxOffloads = 0U;
+				uxMaxFrameLength = 0U;
+			}
+		}
+		#endif /* ipconfigUSE_MULTI_INTERFACE */
+
+		#if( ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM != 0 )
+		{
+			uxOffloads |= ipOFFLOAD_TX_CHECKSUM;
+		}
+		#endif
+		#if( ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM != 0 )
+		{
+			uxOffloads |= ipOFFLOAD_RX_CHECKSUM;
+		}
+		#endif
+
+		if( puxMaxFrameLength != NULL )
+		{
+			if( ( uxOffloads & ipOFFLOAD_TCP_SEGMENTATION ) != 0U )
+			{
+				*puxMaxFrameLength = uxMaxFrameLength;
+			}
+			else
+			{
+				*puxMaxFrameLength = 0U;
+			}
+		}
+
+		return uxOffloads;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_DRIVER_OFFLOADS */
+
 /* Provide access to private members for verification. */
 #ifdef FREERTOS_TCP_ENABLE_VERIFICATION
 	#include "aws_freertos_ip_verification_access_ip_define.h"
@@ -0,0 +1,1507 @@
+/*
+ * FreeRTOS+TCP V2.0.11
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ * FreeRTOS_IPv6.c
+ * IPv6 on the primary end-point, when ipconfigUSE_IPv6 is set to 1.
+ *
+ * The node gets a link-local address in fe80::/64, of which the interface
+ * identifier is derived from the MAC address (modified EUI-64, RFC 4291).  When
+ * a router advertises a /64 prefix for autonomous configuration, a global
+ * address is formed from that prefix and the same identifier (SLAAC, RFC 4862).
+ * An address is only used after one neighbour solicitation has not been
+ * answered (duplicate address detection).
+ *
+ * Neighbour discovery (RFC 4861) works much like ARP: a small cache maps IPv6
+ * addresses to MAC addresses, and an outgoing packet to an unknown neighbour
+ * waits in its cache entry until the neighbour advertisement arrives.
+ * Neighbour solicitations and echo requests are answered.
+ *
+ * UDP packets are handled by the same sockets as IPv4 packets, see struct
+ * freertos_sockaddr6.  TCP over IPv6 and packets with extension headers are not
+ * supported, they are dropped.  The DNS client only sends A queries to IPv4
+ * servers, so host names do not resolve to IPv6 addresses.  A network that
+ * only offers IPv6, also one that reaches IPv4 hosts through NAT64, can
+ * therefore not be used for TCP or for name lookups.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_IP_Private.h"
+#include "FreeRTOS_IPv6.h"
+#include "NetworkInterface.h"
+#include "NetworkBufferManagement.h"
+#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+	#include "FreeRTOS_Routing.h"
+#endif
+
+/* Exclude the entire file if IPv6 is not used. */
+#if( ipconfigUSE_IPv6 != 0 )
+
+/* The ICMPv6 messages that are handled, RFC 4443 and RFC 4861. */
+#define ipv6ICMP_ECHO_REQUEST				( 128U )
+#define ipv6ICMP_ECHO_REPLY					( 129U )
+#define ipv6ICMP_ROUTER_SOLICITATION		( 133U )
+#define ipv6ICMP_ROUTER_ADVERTISEMENT		( 134U )
+#define ipv6ICMP_NEIGHBOUR_SOLICITATION		( 135U )
+#define ipv6ICMP_NEIGHBOUR_ADVERTISEMENT	( 136U )
+
+/* The neighbour discovery options that are used. */
+#define ipv6OPTION_SOURCE_LINK_LAYER		( 1U )
+#define ipv6OPTION_TARGET_LINK_LAYER		( 2U )
+#define ipv6OPTION_PREFIX_INFORMATION		( 3U )
+
+/* The length of options is expressed in units of 8 bytes. */
+#define ipv6OPTION_UNIT						( 8U )
+
+/* The lengths of the options that are used, in bytes. */
+#define ipv6OPTION_LINK_LAYER_LENGTH		( 8U )
+#define ipv6OPTION_PREFIX_LENGTH			( 32U )
+
+/* The lengths of the fixed parts of the ICMPv6 messages that are used: the
+ICMPv6 header, plus a target address for solicitations and advertisements, or
+plus the reachable time and the retransmission timer for router
+advertisements. */
+#define ipv6ND_MESSAGE_LENGTH				( sizeof( ICMPv6Header_t ) + sizeof( IPv6_Address_t ) )
+#define ipv6RA_MESSAGE_LENGTH				( sizeof( ICMPv6Header_t ) + 8U )
+
+/* The flags in the first byte of a neighbour advertisement. */
+#define ipv6NA_FLAG_SOLICITED				( 0x40U )
+#define ipv6NA_FLAG_OVERRIDE				( 0x20U )
+
+/* The autonomous address-configuration flag of a prefix information option. */
+#define ipv6PREFIX_FLAG_AUTONOMOUS			( 0x40U )
+
+/* Neighbour discovery messages are sent with this hop limit, and only accepted
+with it, which proves that they were not forwarded by a router. */
+#define ipv6ND_HOP_LIMIT					( 255U )
+
+/* The length of the prefixes that are used to form addresses.  The interface
+identifier fills the other 64 bits. */
+#define ipv6PREFIX_BYTES					( 8U )
+
+/* The timing below is expressed in calls to vIPv6CheckTimers(), which are one
+second apart.  An address is used when its duplicate address detection was not
+answered within one to two seconds, RFC 4862 section 5.4. */
+#define ipv6DAD_TICKS						( 2U )
+
+/* Up to three router solicitations are sent, four seconds apart, RFC 4861
+section 10. */
+#define ipv6MAX_ROUTER_SOLICITATIONS		( 3U )
+#define ipv6ROUTER_SOLICITATION_INTERVAL	( 4U )
+
+/* The number of neighbour solicitations sent for an address that is not in
+the cache, one per second, before the address is given up. */
+#define ipv6ND_MAX_SOLICITATIONS			( 3U )
+
+/* When the age of a valid entry in the neighbour cache reaches this value, a
+solicitation is sent to see if the neighbour is still there. */
+#define ipv6ND_AGE_BEFORE_NEW_SOLICITATION	( 3U )
+
+/* A lifetime that never expires, and the shortest lifetime to which an
+unauthenticated router advertisement can reduce that of an address, see
+RFC 4862 section 5.5.3. */
+#define ipv6INFINITE_LIFETIME				( 0xffffffffUL )
+#define ipv6TWO_HOURS						( 7200UL )
+
+/* True for a multicast address, and for an address in fe80::/10. */
+#define ipv6IS_MULTICAST( pxAddress )		( ( pxAddress )->ucBytes[ 0 ] == 0xffU )
+#define ipv6IS_LINK_LOCAL( pxAddress )		( ( ( pxAddress )->ucBytes[ 0 ] == 0xfeU ) && ( ( ( pxAddress )->ucBytes[ 1 ] & 0xc0U ) == 0x80U ) )
+
+/* The scope of a multicast address.  Scopes up to this one are link-local. */
+#define ipv6MULTICAST_SCOPE( pxAddress )	( ( pxAddress )->ucBytes[ 1 ] & 0x0fU )
+#define ipv6MULTICAST_SCOPE_LINK			( 2U )
+
+#if( ipconfigMAX_ND_AGE > 0xffff )
+	#error ipconfigMAX_ND_AGE must fit in 16 bits
+#endif
+
+/*-----------------------------------------------------------*/
+
+typedef enum
+{
+	eIPv6AddressUnused = 0,		/* The address has not been configured. */
+	eIPv6AddressTentative,		/* Duplicate address detection is in progress. */
+	eIPv6AddressPreferred,		/* The address can be used. */
+	eIPv6AddressDuplicate		/* Another node uses the address. */
+} eIPv6AddressState_t;
+
+/* One of the addresses of this node. */
+typedef struct xIPv6_ADDRESS_ENTRY
+{
+	IPv6_Address_t xAddress;
+	eIPv6AddressState_t eState;
+	UBaseType_t uxDADTicks;			/* The seconds left before a tentative address is used. */
+	uint32_t ulValidLifetime;		/* The seconds left before the address expires, or ipv6INFINITE_LIFETIME. */
+} IPv6AddressEntry_t;
+
+/* An entry of the neighbour cache. */
+typedef struct xND_CACHE_ROW
+{
+	IPv6_Address_t xIPAddress;
+	MACAddress_t xMACAddress;
+	uint16_t usAge;					/* The seconds left before the entry is removed.  The entry is free when zero. */
+	uint8_t ucValid;				/* pdTRUE: xMACAddress is valid, pdFALSE: waiting for an advertisement. */
+	NetworkBufferDescriptor_t *pxWaitingPacket;	/* An outgoing packet that waits for the advertisement, or NULL. */
+} NDCacheRow_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Return the one's complement sum of the IPv6 pseudo header and the
+ * uxProtocolLength bytes that follow the IPv6 header, in host order.  A packet
+ * of which the checksum is correct sums to 0xffff.
+ */
+static uint16_t prvProtocolSum( const IPv6Header_t *pxIPHeader, size_t uxProtocolLength );
+
+/*
+ * Return pdTRUE if pxAddress is all zeros, the unspecified address.
+ */
+static BaseType_t prvIsUnspecified( const IPv6_Address_t *pxAddress );
+
+/*
+ * Return the address of this node that equals pxAddress, in any state but
+ * eIPv6AddressUnused, or NULL.
+ */
+static IPv6AddressEntry_t *prvFindAddress( const IPv6_Address_t *pxAddress );
+
+/*
+ * Return pdTRUE if a packet to pxDestination must be accepted: it is sent to
+ * a preferred address of this node, to the all-nodes address, or to the
+ * solicited-node address of one of the addresses of this node.
+ */
+static BaseType_t prvIsForThisNode( const IPv6_Address_t *pxDestination );
+
+/*
+ * Return the address from which a packet to pxDestination is sent, or NULL
+ * when there is no usable address of the right scope.
+ */
+static const IPv6_Address_t *prvSelectSourceAddress( const IPv6_Address_t *pxDestination );
+
+/*
+ * Find the neighbour to which a packet to pxDestination is sent: the
+ * destination itself when it is on the link, or else the default router.
+ * Returns pdFAIL when there is no route.
+ */
+static BaseType_t prvNextHop( const IPv6_Address_t *pxDestination, IPv6_Address_t *pxNextHop );
+
+/*
+ * Write the solicited-node multicast address of pxAddress to pxResult.
+ */
+static void prvSolicitedNodeAddress( const IPv6_Address_t *pxAddress, IPv6_Address_t *pxResult );
+
+/*
+ * Write the MAC address to which packets for the multicast address pxAddress
+ * are sent, RFC 2464.
+ */
+static void prvMulticastMACAddress( const IPv6_Address_t *pxAddress, MACAddress_t *pxMACAddress );
+
+/*
+ * Give address eType the prefix pucPrefix and the interface identifier of
+ * this node, and start its duplicate address detection.
+ */
+static void prvStartAddress( eIPv6AddressType_t eType, const uint8_t *pucPrefix );
+
+/*
+ * Another node uses the tentative address pxEntry.
+ */
+static void prvDuplicateAddress( IPv6AddressEntry_t *pxEntry );
+
+/*
+ * Fill in the Ethernet and IPv6 headers of pxNetworkBuffer, set its length,
+ * and pass it to the network interface, which will release it.
+ */
+static void prvSendPacket( NetworkBufferDescriptor_t * const pxNetworkBuffer, const MACAddress_t *pxDestinationMAC, size_t uxProtocolLength );
+
+/*
+ * Send a neighbour solicitation or advertisement about pxTarget.  When
+ * pxDestinationMAC is NULL, pxDestination must be a multicast address.  A
+ * solicitation from the unspecified address, used for duplicate address
+ * detection, carries no link-layer address.
+ */
+static void prvOutputND( uint8_t ucType, const IPv6_Address_t *pxTarget, const IPv6_Address_t *pxSource,
+	const IPv6_Address_t *pxDestination, const MACAddress_t *pxDestinationMAC, uint8_t ucFlags );
+
+/*
+ * Send a neighbour solicitation to learn the MAC address of pxTarget.
+ */
+static void prvSolicitNeighbour( const IPv6_Address_t *pxTarget );
+
+/*
+ * Send a router solicitation from the link-local address.
+ */
+static void prvOutputRouterSolicitation( void );
+
+/*
+ * Return the offset of the first option of type ucType that starts at or after
+ * uxOffset in the uxLength bytes of options at pucOptions, and that is at least
+ * uxMinimumLength bytes long.  Returns uxLength when there is none, or when the
+ * options are malformed.
+ */
+static size_t prvFindOption( const uint8_t *pucOptions, size_t uxLength, size_t uxOffset, uint8_t ucType, size_t uxMinimumLength );
+
+/*
+ * Return the index of the neighbour cache entry of pxAddress, or -1.
+ */
+static BaseType_t prvNDFindEntry( const IPv6_Address_t *pxAddress );
+
+/*
+ * Store the MAC address of pxAddress in the neighbour cache, and send the
+ * packet that was waiting for it.  A new entry replaces the oldest one when
+ * the cache is full.
+ */
+static void prvNDRefreshCacheEntry( const MACAddress_t *pxMACAddress, const IPv6_Address_t *pxAddress );
+
+/*
+ * Wipe out entry x of the neighbour cache, releasing its waiting packet.
+ */
+static void prvNDClearEntry( BaseType_t x );
+
+/*
+ * Age the neighbour cache, called every second.
+ */
+static void prvNDAgeCache( void );
+
+/*
+ * Handle the ICMPv6 messages.
+ */
+static eFrameProcessingResult_t prvProcessICMPv6( NetworkBufferDescriptor_t * const pxNetworkBuffer, size_t uxICMPLength );
+static void prvProcessNeighbourSolicitation( const NDPacket_t *pxPacket, size_t uxICMPLength );
+static void prvProcessNeighbourAdvertisement( const NDPacket_t *pxPacket, size_t uxICMPLength );
+static void prvProcessRouterAdvertisement( const ICMPv6Packet_t *pxPacket, size_t uxICMPLength );
+
+/*
+ * Pass a UDP packet to the sockets.
+ */
+static eFrameProcessingResult_t prvProcessUDPPacket( NetworkBufferDescriptor_t * const pxNetworkBuffer, size_t uxUDPLength );
+
+/*-----------------------------------------------------------*/
+
+/* The link-local and the global address of this node, indexed by
+eIPv6AddressType_t. */
+static IPv6AddressEntry_t xAddresses[ 2 ];
+
+/* The neighbour cache. */
+static NDCacheRow_t xNDCache[ ipconfigND_CACHE_ENTRIES ];
+
+/* The default router, valid while ulRouterLifetime is not zero. */
+static IPv6_Address_t xRouterAddress;
+static uint32_t ulRouterLifetime = 0UL;
+
+/* The hop limit of unicast packets, which a router may advertise. */
+static uint8_t ucHopLimit = ( uint8_t ) ipconfigUDP_TIME_TO_LIVE;
+
+/* The router solicitations sent so far, and the seconds until the next one. */
+static UBaseType_t uxRouterSolicitations = 0U;
+static UBaseType_t uxRouterSolicitationTicks = 0U;
+
+/* The all-nodes and all-routers multicast addresses. */
+static const IPv6_Address_t xAllNodesAddress = { { 0xff, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01 } };
+static const IPv6_Address_t xAllRoutersAddress = { { 0xff, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02 } };
+
+/* The unspecified address. */
+static const IPv6_Address_t xUnspecifiedAddress = { { 0 } };
+
+/* The prefix of link-local addresses. */
+static const uint8_t ucLinkLocalPrefix[ ipv6PREFIX_BYTES ] = { 0xfe, 0x80, 0, 0, 0, 0, 0, 0 };
+
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_GetIPv6Address( eIPv6AddressType_t eType, IPv6_Address_t *pxAddress )
+{
+BaseType_t xReturn = pdFAIL;
+const IPv6AddressEntry_t *pxEntry = &( xAddresses[ eType ] );
+
+	/* The address is written by the IP-task, a copy is taken in a critical
+	section so that it can not change half-way. */
+	taskENTER_CRITICAL();
+	{
+		if( pxEntry->eState == eIPv6AddressPreferred )
+		{
+			memcpy( pxAddress->ucBytes, pxEntry->xAddress.ucBytes, sizeof( pxAddress->ucBytes ) );
+			xReturn = pdPASS;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vIPv6NetworkUp( void )
+{
+BaseType_t x;
+
+	for( x = 0; x < ipconfigND_CACHE_ENTRIES; x++ )
+	{
+		prvNDClearEntry( x );
+	}
+
+	taskENTER_CRITICAL();
+	{
+		memset( xAddresses, 0, sizeof( xAddresses ) );
+	}
+	taskEXIT_CRITICAL();
+
+	ulRouterLifetime = 0UL;
+	ucHopLimit = ( uint8_t ) ipconfigUDP_TIME_TO_LIVE;
+	uxRouterSolicitations = 0U;
+	uxRouterSolicitationTicks = 0U;
+
+	prvStartAddress( eIPv6LinkLocal, ucLinkLocalPrefix );
+}
+/*-----------------------------------------------------------*/
+
+void vIPv6CheckTimers( void )
+{
+IPv6AddressEntry_t *pxEntry;
+BaseType_t x;
+
+	for( x = 0; x < ( BaseType_t ) ( sizeof( xAddresses ) / sizeof( xAddresses[ 0 ] ) ); x++ )
+	{
+		pxEntry = &( xAddresses[ x ] );
+
+		if( pxEntry->eState == eIPv6AddressTentative )
+		{
+			pxEntry->uxDADTicks--;
+
+			if( pxEntry->uxDADTicks == 0U )
+			{
+				/* Nobody objected, the address can be used. */
+				pxEntry->eState = eIPv6AddressPreferred;
+				FreeRTOS_printf( ( "IPv6: %s address is ready\n", ( x == ( BaseType_t ) eIPv6LinkLocal ) ? "link-local" : "global" ) );
+			}
+		}
+
+		if( ( pxEntry->eState != eIPv6AddressUnused ) && ( pxEntry->ulValidLifetime != ipv6INFINITE_LIFETIME ) )
+		{
+			pxEntry->ulValidLifetime--;
+
+			if( pxEntry->ulValidLifetime == 0UL )
+			{
+				/* The prefix was not advertised again in time. */
+				FreeRTOS_printf( ( "IPv6: global address expired\n" ) );
+				pxEntry->eState = eIPv6AddressUnused;
+			}
+		}
+	}
+
+	if( ulRouterLifetime != 0UL )
+	{
+		ulRouterLifetime--;
+	}
+	else if( ( xAddresses[ eIPv6LinkLocal ].eState == eIPv6AddressPreferred ) &&
+			 ( uxRouterSolicitations < ipv6MAX_ROUTER_SOLICITATIONS ) )
+	{
+		/* Look for a router, which will advertise the prefix of the global
+		address. */
+		if( uxRouterSolicitationTicks == 0U )
+		{
+			prvOutputRouterSolicitation();
+			uxRouterSolicitations++;
+			uxRouterSolicitationTicks = ipv6ROUTER_SOLICITATION_INTERVAL;
+		}
+
+		uxRouterSolicitationTicks--;
+	}
+	else
+	{
+		/* There is a router, or it was solicited often enough. */
+	}
+
+	prvNDAgeCache();
+}
+/*-----------------------------------------------------------*/
+
+eFrameProcessingResult_t eIPv6ProcessPacket( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+{
+const IPv6Packet_t *pxIPPacket = ( const IPv6Packet_t * ) pxNetworkBuffer->pucEthernetBuffer;
+const IPv6Header_t *pxIPHeader = &( pxIPPacket->xIPHeader );
+eFrameProcessingResult_t eReturn = eReleaseBuffer;
+size_t uxPayloadLength;
+
+	if( pxNetworkBuffer->xDataLength >= sizeof( IPv6Packet_t ) )
+	{
+		uxPayloadLength = ( size_t ) FreeRTOS_ntohs( pxIPHeader->usPayloadLength );
+
+		if( ( pxIPHeader->ucVersionTrafficClass & 0xf0U ) != 0x60U )
+		{
+			/* Not IPv6. */
+		}
+		else if( ( sizeof( IPv6Packet_t ) + uxPayloadLength ) > pxNetworkBuffer->xDataLength )
+		{
+			/* The packet is shorter than its header says. */
+		}
+		#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+		else if( pxNetworkBuffer->pxEndPoint != FreeRTOS_FirstEndPoint() )
+		{
+			/* IPv6 only runs on the primary end-point. */
+		}
+		#endif
+		else if( ( prvIsForThisNode( &( pxIPHeader->xDestinationAddress ) ) == pdFALSE ) ||
+				 ( ipv6IS_MULTICAST( &( pxIPHeader->xSourceAddress ) ) ) )
+		{
+			/* Not for this node, or from an invalid source. */
+		}
+		else if( pxIPHeader->ucNextHeader == ( uint8_t ) ipPROTOCOL_ICMP_IPv6 )
+		{
+			eReturn = prvProcessICMPv6( pxNetworkBuffer, uxPayloadLength );
+		}
+		else if( pxIPHeader->ucNextHeader == ( uint8_t ) ipPROTOCOL_UDP )
+		{
+			eReturn = prvProcessUDPPacket( pxNetworkBuffer, uxPayloadLength );
+		}
+		else
+		{
+			/* TCP and the extension headers are not supported. */
+		}
+	}
+
+	return eReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vIPv6ProcessGeneratedUDPPacket( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+{
+UDPv6Packet_t *pxUDPPacket = ( UDPv6Packet_t * ) pxNetworkBuffer->pucEthernetBuffer;
+const IPv6_Address_t *pxSource;
+IPv6_Address_t xNextHop;
+MACAddress_t xMACAddress;
+size_t uxUDPLength = pxNetworkBuffer->xDataLength + ipSIZE_OF_UDP_HEADER;
+uint16_t usChecksum;
+BaseType_t x = -1;
+BaseType_t xSend = pdFALSE;
+
+	pxSource = prvSelectSourceAddress( &( pxNetworkBuffer->xIPv6Address ) );
+
+	if( ( pxSource != NULL ) && ( pxNetworkBuffer->usPort != ipPACKET_CONTAINS_ICMP_DATA ) )
+	{
+		/* Move the payload behind the longer header. */
+		memmove( &( pxNetworkBuffer->pucEthernetBuffer[ sizeof( UDPv6Packet_t ) ] ),
+			&( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] ),
+			pxNetworkBuffer->xDataLength );
+
+		memcpy( pxUDPPacket->xIPHeader.xSourceAddress.ucBytes, pxSource->ucBytes, sizeof( pxUDPPacket->xIPHeader.xSourceAddress.ucBytes ) );
+		memcpy( pxUDPPacket->xIPHeader.xDestinationAddress.ucBytes, pxNetworkBuffer->xIPv6Address.ucBytes, sizeof( pxUDPPacket->xIPHeader.xDestinationAddress.ucBytes ) );
+		pxUDPPacket->xIPHeader.ucNextHeader = ( uint8_t ) ipPROTOCOL_UDP;
+
+		if( ipv6IS_MULTICAST( &( pxNetworkBuffer->xIPv6Address ) ) )
+		{
+			/* Multicast packets stay on the link unless the application
+			asks otherwise, which this implementation does not support. */
+			pxUDPPacket->xIPHeader.ucHopLimit = 1U;
+		}
+		else
+		{
+			pxUDPPacket->xIPHeader.ucHopLimit = ucHopLimit;
+		}
+
+		pxUDPPacket->xUDPHeader.usSourcePort = pxNetworkBuffer->usBoundPort;
+		pxUDPPacket->xUDPHeader.usDestinationPort = pxNetworkBuffer->usPort;
+		pxUDPPacket->xUDPHeader.usLength = FreeRTOS_htons( ( uint16_t ) uxUDPLength );
+		pxUDPPacket->xUDPHeader.usChecksum = 0U;
+
+		/* The checksum is not optional in IPv6. */
+		#if( ipconfigUSE_CHECKSUM_KERNELS != 0 )
+		if( pxNetworkBuffer->usPayloadChecksum != 0U )
+		{
+		uint32_t ulSum;
+
+			/* The payload was summed while it was copied.  It moved by an
+			even number of bytes, so its sum did not change. */
+			ulSum = ( uint32_t ) uxUDPLength + ( uint32_t ) ipPROTOCOL_UDP + ( uint32_t ) pxNetworkBuffer->usPayloadChecksum;
+			ulSum = ( ulSum & 0xffffUL ) + ( ulSum >> 16 );
+			ulSum = ( ulSum & 0xffffUL ) + ( ulSum >> 16 );
+			usChecksum = ( uint16_t ) ~usGenerateChecksum( ulSum, pxUDPPacket->xIPHeader.xSourceAddress.ucBytes,
+				2U * sizeof( IPv6_Address_t ) + ipSIZE_OF_UDP_HEADER );
+		}
+		else
+		#endif /* ipconfigUSE_CHECKSUM_KERNELS */
+		{
+			usChecksum = ( uint16_t ) ~prvProtocolSum( &( pxUDPPacket->xIPHeader ), uxUDPLength );
+		}
+
+		if( usChecksum == 0U )
+		{
+			/* A checksum of zero is not allowed. */
+			usChecksum = ( uint16_t ) 0xffffU;
+		}
+
+		pxUDPPacket->xUDPHeader.usChecksum = FreeRTOS_htons( usChecksum );
+
+		if( ipv6IS_MULTICAST( &( pxNetworkBuffer->xIPv6Address ) ) )
+		{
+			prvMulticastMACAddress( &( pxNetworkBuffer->xIPv6Address ), &xMACAddress );
+			xSend = pdTRUE;
+		}
+		else if( prvNextHop( &( pxNetworkBuffer->xIPv6Address ), &xNextHop ) == pdPASS )
+		{
+			x = prvNDFindEntry( &xNextHop );
+
+			if( x < 0 )
+			{
+				/* Create an entry that waits for the advertisement, and let it
+				hold the packet. */
+				prvNDRefreshCacheEntry( NULL, &xNextHop );
+				x = prvNDFindEntry( &xNextHop );
+			}
+
+			if( x < 0 )
+			{
+				/* Can not happen, a new entry replaces the oldest one. */
+			}
+			else if( xNDCache[ x ].ucValid != ( uint8_t ) pdFALSE )
+			{
+				memcpy( xMACAddress.ucBytes, xNDCache[ x ].xMACAddress.ucBytes, sizeof( xMACAddress.ucBytes ) );
+				xSend = pdTRUE;
+			}
+			else
+			{
+				/* Only the last packet is held, as RFC 4861 section 7.2.2
+				allows. */
+				if( xNDCache[ x ].pxWaitingPacket != NULL )
+				{
+					vReleaseNetworkBufferAndDescriptor( xNDCache[ x ].pxWaitingPacket );
+				}
+				else
+				{
+					/* The first packet for this neighbour. */
+					prvSolicitNeighbour( &xNextHop );
+				}
+
+				/* The length will be set by prvSendPacket() when the
+				advertisement arrives. */
+				pxNetworkBuffer->xDataLength = uxUDPLength;
+				xNDCache[ x ].pxWaitingPacket = pxNetworkBuffer;
+			}
+		}
+		else
+		{
+			FreeRTOS_debug_printf( ( "vIPv6ProcessGeneratedUDPPacket: no route\n" ) );
+		}
+
+		if( xSend != pdFALSE )
+		{
+			prvSendPacket( pxNetworkBuffer, &xMACAddress, uxUDPLength );
+		}
+		else if( ( x < 0 ) || ( xNDCache[ x ].pxWaitingPacket != pxNetworkBuffer ) )
+		{
+			vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+		}
+		else
+		{
+			/* The neighbour cache holds the packet. */
+		}
+	}
+	else
+	{
+		/* There is no address to send from yet, or the packet is a ping,
+		which is only supported for IPv4. */
+		vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static uint16_t prvProtocolSum( const IPv6Header_t *pxIPHeader, size_t uxProtocolLength )
+{
+uint32_t ulSum;
+
+	/* The length and next header fields of the pseudo header, then the source
+	and destination addresses, which are followed by the protocol data. */
+	ulSum = ( uint32_t ) uxProtocolLength + ( uint32_t ) pxIPHeader->ucNextHeader;
+	ulSum = ( ulSum & 0xffffUL ) + ( ulSum >> 16 );
+
+	return usGenerateChecksum( ulSum, pxIPHeader->xSourceAddress.ucBytes, 2U * sizeof( IPv6_Address_t ) + uxProtocolLength );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvIsUnspecified( const IPv6_Address_t *pxAddress )
+{
+BaseType_t xReturn;
+
+	if( memcmp( pxAddress->ucBytes, xUnspecifiedAddress.ucBytes, sizeof( pxAddress->ucBytes ) ) == 0 )
+	{
+		xReturn = pdTRUE;
+	}
+	else
+	{
+		xReturn = pdFALSE;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static IPv6AddressEntry_t *prvFindAddress( const IPv6_Address_t *pxAddress )
+{
+IPv6AddressEntry_t *pxReturn = NULL;
+BaseType_t x;
+
+	for( x = 0; x < ( BaseType_t ) ( sizeof( xAddresses ) / sizeof( xAddresses[ 0 ] ) ); x++ )
+	{
+		if( ( xAddresses[ x ].eState != eIPv6AddressUnused ) &&
+			( memcmp( xAddresses[ x ].xAddress.ucBytes, pxAddress->ucBytes, sizeof( pxAddress->ucBytes ) ) == 0 ) )
+		{
+			pxReturn = &( xAddresses[ x ] );
+			break;
+		}
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvIsForThisNode( const IPv6_Address_t *pxDestination )
+{
+const IPv6AddressEntry_t *pxEntry;
+IPv6_Address_t xSolicitedNode;
+BaseType_t xReturn = pdFALSE;
+BaseType_t x;
+
+	if( ipv6IS_MULTICAST( pxDestination ) )
+	{
+		if( memcmp( pxDestination->ucBytes, xAllNodesAddress.ucBytes, sizeof( pxDestination->ucBytes ) ) == 0 )
+		{
+			xReturn = pdTRUE;
+		}
+		else
+		{
+			/* Solicitations for a tentative address must be seen too. */
+			for( x = 0; x < ( BaseType_t ) ( sizeof( xAddresses ) / sizeof( xAddresses[ 0 ] ) ); x++ )
+			{
+				if( xAddresses[ x ].eState != eIPv6AddressUnused )
+				{
+					prvSolicitedNodeAddress( &( xAddresses[ x ].xAddress ), &xSolicitedNode );
+
+					if( memcmp( pxDestination->ucBytes, xSolicitedNode.ucBytes, sizeof( pxDestination->ucBytes ) ) == 0 )
+					{
+						xReturn = pdTRUE;
+						break;
+					}
+				}
+			}
+		}
+	}
+	else
+	{
+		pxEntry = prvFindAddress( pxDestination );
+
+		if( ( pxEntry != NULL ) && ( pxEntry->eState == eIPv6AddressPreferred ) )
+		{
+			xReturn = pdTRUE;
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static const IPv6_Address_t *prvSelectSourceAddress( const IPv6_Address_t *pxDestination )
+{
+const IPv6_Address_t *pxReturn = NULL;
+BaseType_t xLinkScope;
+
+	if( ipv6IS_MULTICAST( pxDestination ) )
+	{
+		xLinkScope = ( ipv6MULTICAST_SCOPE( pxDestination ) <= ipv6MULTICAST_SCOPE_LINK ) ? pdTRUE : pdFALSE;
+	}
+	else
+	{
+		xLinkScope = ( ipv6IS_LINK_LOCAL( pxDestination ) ) ? pdTRUE : pdFALSE;
+	}
+
+	if( ( xLinkScope == pdFALSE ) && ( xAddresses[ eIPv6Global ].eState == eIPv6AddressPreferred ) )
+	{
+		pxReturn = &( xAddresses[ eIPv6Global ].xAddress );
+	}
+	else if( ( xAddresses[ eIPv6LinkLocal ].eState == eIPv6AddressPreferred ) &&
+			 ( ( xLinkScope != pdFALSE ) || ( ipv6IS_MULTICAST( pxDestination ) ) ) )
+	{
+		/* A global unicast address can not be reached from a link-local
+		address. */
+		pxReturn = &( xAddresses[ eIPv6LinkLocal ].xAddress );
+	}
+	else
+	{
+		/* No usable address. */
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvNextHop( const IPv6_Address_t *pxDestination, IPv6_Address_t *pxNextHop )
+{
+BaseType_t xReturn = pdPASS;
+
+	if( ( ipv6IS_LINK_LOCAL( pxDestination ) ) ||
+		( ( xAddresses[ eIPv6Global ].eState == eIPv6AddressPreferred ) &&
+		  ( memcmp( pxDestination->ucBytes, xAddresses[ eIPv6Global ].xAddress.ucBytes, ipv6PREFIX_BYTES ) == 0 ) ) )
+	{
+		/* The destination is on the link. */
+		memcpy( pxNextHop->ucBytes, pxDestination->ucBytes, sizeof( pxNextHop->ucBytes ) );
+	}
+	else if( ulRouterLifetime != 0UL )
+	{
+		memcpy( pxNextHop->ucBytes, xRouterAddress.ucBytes, sizeof( pxNextHop->ucBytes ) );
+	}
+	else
+	{
+		xReturn = pdFAIL;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSolicitedNodeAddress( const IPv6_Address_t *pxAddress, IPv6_Address_t *pxResult )
+{
+	/* ff02::1:ff00:0/104, followed by the last 24 bits of the address. */
+	memset( pxResult->ucBytes, 0, sizeof( pxResult->ucBytes ) );
+	pxResult->ucBytes[ 0 ] = 0xffU;
+	pxResult->ucBytes[ 1 ] = 0x02U;
+	pxResult->ucBytes[ 11 ] = 0x01U;
+	pxResult->ucBytes[ 12 ] = 0xffU;
+	memcpy( &( pxResult->ucBytes[ 13 ] ), &( pxAddress->ucBytes[ 13 ] ), 3U );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMulticastMACAddress( const IPv6_Address_t *pxAddress, MACAddress_t *pxMACAddress )
+{
+	/* 33:33, followed by the last 32 bits of the address. */
+	pxMACAddress->ucBytes[ 0 ] = 0x33U;
+	pxMACAddress->ucBytes[ 1 ] = 0x33U;
+	memcpy( &( pxMACAddress->ucBytes[ 2 ] ), &( pxAddress->ucBytes[ 12 ] ), 4U );
+}
+/*-----------------------------------------------------------*/
+
+static void prvStartAddress( eIPv6AddressType_t eType, const uint8_t *pucPrefix )
+{
+IPv6AddressEntry_t *pxEntry = &( xAddresses[ eType ] );
+const uint8_t *pucMAC = ipLOCAL_MAC_ADDRESS;
+IPv6_Address_t xSolicitedNode;
+
+	taskENTER_CRITICAL();
+	{
+		memcpy( pxEntry->xAddress.ucBytes, pucPrefix, ipv6PREFIX_BYTES );
+
+		/* The modified EUI-64 interface identifier, RFC 4291 appendix A:
+		the MAC address with ff:fe in the middle, and the universal/local bit
+		inverted. */
+		pxEntry->xAddress.ucBytes[ 8 ] = pucMAC[ 0 ] ^ 0x02U;
+		pxEntry->xAddress.ucBytes[ 9 ] = pucMAC[ 1 ];
+		pxEntry->xAddress.ucBytes[ 10 ] = pucMAC[ 2 ];
+		pxEntry->xAddress.ucBytes[ 11 ] = 0xffU;
+		pxEntry->xAddress.ucBytes[ 12 ] = 0xfeU;
+		pxEntry->xAddress.ucBytes[ 13 ] = pucMAC[ 3 ];
+		pxEntry->xAddress.ucBytes[ 14 ] = pucMAC[ 4 ];
+		pxEntry->xAddress.ucBytes[ 15 ] = pucMAC[ 5 ];
+
+		pxEntry->eState = eIPv6AddressTentative;
+		pxEntry->uxDADTicks = ipv6DAD_TICKS;
+		pxEntry->ulValidLifetime = ipv6INFINITE_LIFETIME;
+	}
+	taskEXIT_CRITICAL();
+
+	/* Ask whether another node already uses the address. */
+	prvSolicitedNodeAddress( &( pxEntry->xAddress ), &xSolicitedNode );
+	prvOutputND( ( uint8_t ) ipv6ICMP_NEIGHBOUR_SOLICITATION, &( pxEntry->xAddress ), &xUnspecifiedAddress, &xSolicitedNode, NULL, 0U );
+}
+/*-----------------------------------------------------------*/
+
+static void prvDuplicateAddress( IPv6AddressEntry_t *pxEntry )
+{
+	/* RFC 4862 section 5.4.5: the address must not be used. */
+	pxEntry->eState = eIPv6AddressDuplicate;
+	FreeRTOS_printf( ( "IPv6: %s address is used by another node\n", ( pxEntry == &( xAddresses[ eIPv6LinkLocal ] ) ) ? "link-local" : "global" ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendPacket( NetworkBufferDescriptor_t * const pxNetworkBuffer, const MACAddress_t *pxDestinationMAC, size_t uxProtocolLength )
+{
+IPv6Packet_t *pxIPPacket = ( IPv6Packet_t * ) pxNetworkBuffer->pucEthernetBuffer;
+
+	/* The addresses, the next header and the hop limit were filled in by the
+	caller. */
+	memcpy( pxIPPacket->xEthernetHeader.xDestinationAddress.ucBytes, pxDestinationMAC->ucBytes, sizeof( pxDestinationMAC->ucBytes ) );
+	memcpy( pxIPPacket->xEthernetHeader.xSourceAddress.ucBytes, ipLOCAL_MAC_ADDRESS, ( size_t ) ipMAC_ADDRESS_LENGTH_BYTES );
+	pxIPPacket->xEthernetHeader.usFrameType = ipIPv6_FRAME_TYPE;
+	pxIPPacket->xIPHeader.ucVersionTrafficClass = 0x60U;
+	pxIPPacket->xIPHeader.ucTrafficClassFlowLabel = 0U;
+	pxIPPacket->xIPHeader.usFlowLabel = 0U;
+	pxIPPacket->xIPHeader.usPayloadLength = FreeRTOS_htons( ( uint16_t ) uxProtocolLength );
+
+	pxNetworkBuffer->xDataLength = sizeof( IPv6Packet_t ) + uxProtocolLength;
+
+	#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+	{
+		pxNetworkBuffer->pxEndPoint = FreeRTOS_FirstEndPoint();
+	}
+	#endif /* ipconfigUSE_MULTI_INTERFACE */
+
+	#if defined( ipconfigETHERNET_MINIMUM_PACKET_BYTES )
+	{
+		if( pxNetworkBuffer->xDataLength < ( size_t ) ipconfigETHERNET_MINIMUM_PACKET_BYTES )
+		{
+		BaseType_t xIndex;
+
+			for( xIndex = ( BaseType_t ) pxNetworkBuffer->xDataLength; xIndex < ( BaseType_t ) ipconfigETHERNET_MINIMUM_PACKET_BYTES; xIndex++ )
+			{
+				pxNetworkBuffer->pucEthernetBuffer[ xIndex ] = 0u;
+			}
+			pxNetworkBuffer->xDataLength = ( size_t ) ipconfigETHERNET_MINIMUM_PACKET_BYTES;
+		}
+	}
+	#endif
+
+	ipCAPTURE_SENT( pxNetworkBuffer );
+	xNetworkInterfaceOutput( pxNetworkBuffer, pdTRUE );
+}
+/*-----------------------------------------------------------*/
+
+static void prvOutputND( uint8_t ucType, const IPv6_Address_t *pxTarget, const IPv6_Address_t *pxSource,
+	const IPv6_Address_t *pxDestination, const MACAddress_t *pxDestinationMAC, uint8_t ucFlags )
+{
+NetworkBufferDescriptor_t *pxNetworkBuffer;
+NDPacket_t *pxPacket;
+MACAddress_t xMACAddress;
+size_t uxICMPLength = ipv6ND_MESSAGE_LENGTH;
+uint16_t usChecksum;
+
+	/* This is called from the context of the IP event task, so a block time
+	must not be used. */
+	pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( sizeof( NDPacket_t ), ( TickType_t ) 0 );
+
+	if( pxNetworkBuffer != NULL )
+	{
+		pxPacket = ( NDPacket_t * ) pxNetworkBuffer->pucEthernetBuffer;
+
+		memcpy( pxPacket->xIPHeader.xSourceAddress.ucBytes, pxSource->ucBytes, sizeof( pxSource->ucBytes ) );
+		memcpy( pxPacket->xIPHeader.xDestinationAddress.ucBytes, pxDestination->ucBytes, sizeof( pxDestination->ucBytes ) );
+		pxPacket->xIPHeader.ucNextHeader = ( uint8_t ) ipPROTOCOL_ICMP_IPv6;
+		pxPacket->xIPHeader.ucHopLimit = ( uint8_t ) ipv6ND_HOP_LIMIT;
+
+		memset( &( pxPacket->xICMPHeader ), 0, sizeof( pxPacket->xICMPHeader ) );
+		pxPacket->xICMPHeader.ucTypeOfMessage = ucType;
+		pxPacket->xICMPHeader.ucMessageBody[ 0 ] = ucFlags;
+		memcpy( pxPacket->xTargetAddress.ucBytes, pxTarget->ucBytes, sizeof( pxTarget->ucBytes ) );
+
+		if( prvIsUnspecified( pxSource ) == pdFALSE )
+		{
+			/* Tell the MAC address of this node. */
+			pxPacket->ucOptionType = ( ucType == ( uint8_t ) ipv6ICMP_NEIGHBOUR_SOLICITATION ) ? ( uint8_t ) ipv6OPTION_SOURCE_LINK_LAYER : ( uint8_t ) ipv6OPTION_TARGET_LINK_LAYER;
+			pxPacket->ucOptionLength = ( uint8_t ) ( ipv6OPTION_LINK_LAYER_LENGTH / ipv6OPTION_UNIT );
+			memcpy( pxPacket->xLinkLayerAddress.ucBytes, ipLOCAL_MAC_ADDRESS, ( size_t ) ipMAC_ADDRESS_LENGTH_BYTES );
+			uxICMPLength += ipv6OPTION_LINK_LAYER_LENGTH;
+		}
+
+		usChecksum = ( uint16_t ) ~prvProtocolSum( &( pxPacket->xIPHeader ), uxICMPLength );
+		pxPacket->xICMPHeader.usChecksum = FreeRTOS_htons( usChecksum );
+
+		if( pxDestinationMAC == NULL )
+		{
+			prvMulticastMACAddress( pxDestination, &xMACAddress );
+			pxDestinationMAC = &xMACAddress;
+		}
+
+		prvSendPacket( pxNetworkBuffer, pxDestinationMAC, uxICMPLength );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSolicitNeighbour( const IPv6_Address_t *pxTarget )
+{
+const IPv6_Address_t *pxSource = prvSelectSourceAddress( pxTarget );
+IPv6_Address_t xSolicitedNode;
+
+	if( pxSource != NULL )
+	{
+		prvSolicitedNodeAddress( pxTarget, &xSolicitedNode );
+		prvOutputND( ( uint8_t ) ipv6ICMP_NEIGHBOUR_SOLICITATION, pxTarget, pxSource, &xSolicitedNode, NULL, 0U );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvOutputRouterSolicitation( void )
+{
+NetworkBufferDescriptor_t *pxNetworkBuffer;
+ICMPv6Packet_t *pxPacket;
+MACAddress_t xMACAddress;
+uint8_t *pucOption;
+const size_t uxICMPLength = sizeof( ICMPv6Header_t ) + ipv6OPTION_LINK_LAYER_LENGTH;
+uint16_t usChecksum;
+
+	pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( sizeof( ICMPv6Packet_t ) + ipv6OPTION_LINK_LAYER_LENGTH, ( TickType_t ) 0 );
+
+	if( pxNetworkBuffer != NULL )
+	{
+		pxPacket = ( ICMPv6Packet_t * ) pxNetworkBuffer->pucEthernetBuffer;
+
+		memcpy( pxPacket->xIPHeader.xSourceAddress.ucBytes, xAddresses[ eIPv6LinkLocal ].xAddress.ucBytes, sizeof( IPv6_Address_t ) );
+		memcpy( pxPacket->xIPHeader.xDestinationAddress.ucBytes, xAllRoutersAddress.ucBytes, sizeof( IPv6_Address_t ) );
+		pxPacket->xIPHeader.ucNextHeader = ( uint8_t ) ipPROTOCOL_ICMP_IPv6;
+		pxPacket->xIPHeader.ucHopLimit = ( uint8_t ) ipv6ND_HOP_LIMIT;
+
+		memset( &( pxPacket->xICMPHeader ), 0, sizeof( pxPacket->xICMPHeader ) );
+		pxPacket->xICMPHeader.ucTypeOfMessage = ( uint8_t ) ipv6ICMP_ROUTER_SOLICITATION;
+
+		/* The source link-layer address option follows the header. */
+		pucOption = &( pxNetworkBuffer->pucEthernetBuffer[ sizeof( ICMPv6Packet_t ) ] );
+		pucOption[ 0 ] = ( uint8_t ) ipv6OPTION_SOURCE_LINK_LAYER;
+		pucOption[ 1 ] = ( uint8_t ) ( ipv6OPTION_LINK_LAYER_LENGTH / ipv6OPTION_UNIT );
+		memcpy( &( pucOption[ 2 ] ), ipLOCAL_MAC_ADDRESS, ( size_t ) ipMAC_ADDRESS_LENGTH_BYTES );
+
+		usChecksum = ( uint16_t ) ~prvProtocolSum( &( pxPacket->xIPHeader ), uxICMPLength );
+		pxPacket->xICMPHeader.usChecksum = FreeRTOS_htons( usChecksum );
+
+		prvMulticastMACAddress( &xAllRoutersAddress, &xMACAddress );
+		prvSendPacket( pxNetworkBuffer, &xMACAddress, uxICMPLength );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvFindOption( const uint8_t *pucOptions, size_t uxLength, size_t uxOffset, uint8_t ucType, size_t uxMinimumLength )
+{
+size_t uxOptionLength;
+size_t uxReturn = uxLength;
+
+	while( ( uxOffset + 2U ) <= uxLength )
+	{
+		uxOptionLength = ( size_t ) pucOptions[ uxOffset + 1U ] * ipv6OPTION_UNIT;
+
+		if( ( uxOptionLength == 0U ) || ( ( uxOffset + uxOptionLength ) > uxLength ) )
+		{
+			/* A malformed option, the rest can not be interpreted. */
+			break;
+		}
+
+		if( ( pucOptions[ uxOffset ] == ucType ) && ( uxOptionLength >= uxMinimumLength ) )
+		{
+			uxReturn = uxOffset;
+			break;
+		}
+
+		uxOffset += uxOptionLength;
+	}
+
+	return uxReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvNDFindEntry( const IPv6_Address_t *pxAddress )
+{
+BaseType_t x;
+BaseType_t xReturn = -1;
+
+	for( x = 0; x < ipconfigND_CACHE_ENTRIES; x++ )
+	{
+		if( ( xNDCache[ x ].usAge != 0U ) &&
+			( memcmp( xNDCache[ x ].xIPAddress.ucBytes, pxAddress->ucBytes, sizeof( pxAddress->ucBytes ) ) == 0 ) )
+		{
+			xReturn = x;
+			break;
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvNDRefreshCacheEntry( const MACAddress_t *pxMACAddress, const IPv6_Address_t *pxAddress )
+{
+BaseType_t x, xOldest = 0;
+NetworkBufferDescriptor_t *pxWaitingPacket;
+
+	x = prvNDFindEntry( pxAddress );
+
+	if( x < 0 )
+	{
+		/* Use a free entry, or else the one that is closest to expiry. */
+		for( x = 0; x < ipconfigND_CACHE_ENTRIES; x++ )
+		{
+			if( xNDCache[ x ].usAge < xNDCache[ xOldest ].usAge )
+			{
+				xOldest = x;
+			}
+		}
+
+		x = xOldest;
+		prvNDClearEntry( x );
+		memcpy( xNDCache[ x ].xIPAddress.ucBytes, pxAddress->ucBytes, sizeof( pxAddress->ucBytes ) );
+	}
+
+	if( pxMACAddress != NULL )
+	{
+		memcpy( xNDCache[ x ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) );
+		xNDCache[ x ].usAge = ( uint16_t ) ipconfigMAX_ND_AGE;
+		xNDCache[ x ].ucValid = ( uint8_t ) pdTRUE;
+
+		pxWaitingPacket = xNDCache[ x ].pxWaitingPacket;
+		xNDCache[ x ].pxWaitingPacket = NULL;
+
+		if( pxWaitingPacket != NULL )
+		{
+			prvSendPacket( pxWaitingPacket, pxMACAddress, pxWaitingPacket->xDataLength );
+		}
+	}
+	else if( xNDCache[ x ].ucValid == ( uint8_t ) pdFALSE )
+	{
+		/* A new entry that waits for an advertisement. */
+		xNDCache[ x ].usAge = ( uint16_t ) ipv6ND_MAX_SOLICITATIONS;
+	}
+	else
+	{
+		/* The entry is valid already. */
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvNDClearEntry( BaseType_t x )
+{
+	if( xNDCache[ x ].pxWaitingPacket != NULL )
+	{
+		vReleaseNetworkBufferAndDescriptor( xNDCache[ x ].pxWaitingPacket );
+	}
+
+	memset( &( xNDCache[ x ] ), 0, sizeof( xNDCache[ x ] ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvNDAgeCache( void )
+{
+BaseType_t x;
+
+	for( x = 0; x < ipconfigND_CACHE_ENTRIES; x++ )
+	{
+		if( xNDCache[ x ].usAge > 0U )
+		{
+			xNDCache[ x ].usAge--;
+
+			if( xNDCache[ x ].usAge == 0U )
+			{
+				/* The entry is no longer valid, or the neighbour did not
+				answer. */
+				prvNDClearEntry( x );
+			}
+			else if( ( xNDCache[ x ].ucValid == ( uint8_t ) pdFALSE ) ||
+					 ( xNDCache[ x ].usAge <= ( uint16_t ) ipv6ND_AGE_BEFORE_NEW_SOLICITATION ) )
+			{
+				/* Waiting for an advertisement, or see if the entry can be
+				refreshed before it is removed. */
+				prvSolicitNeighbour( &( xNDCache[ x ].xIPAddress ) );
+			}
+			else
+			{
+				/* The age has just ticked down, with nothing to do. */
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static eFrameProcessingResult_t prvProcessICMPv6( NetworkBufferDescriptor_t * const pxNetworkBuffer, size_t uxICMPLength )
+{
+ICMPv6Packet_t *pxPacket = ( ICMPv6Packet_t * ) pxNetworkBuffer->pucEthernetBuffer;
+eFrameProcessingResult_t eReturn = eReleaseBuffer;
+#if( ipconfigREPLY_TO_INCOMING_PINGS == 1 )
+	const IPv6_Address_t *pxSource;
+	IPv6_Address_t xReplySource;
+	uint16_t usChecksum;
+#endif
+
+	if( uxICMPLength < sizeof( ICMPv6Header_t ) )
+	{
+		/* Too short. */
+	}
+	else if( prvProtocolSum( &( pxPacket->xIPHeader ), uxICMPLength ) != 0xffffU )
+	{
+		/* The checksum is not correct. */
+	}
+	else
+	{
+		switch( pxPacket->xICMPHeader.ucTypeOfMessage )
+		{
+			case ipv6ICMP_ECHO_REQUEST:
+				#if( ipconfigREPLY_TO_INCOMING_PINGS == 1 )
+				{
+					/* Reply from the address that was pinged, or, for a
+					multicast ping, from an address of the right scope. */
+					if( ipv6IS_MULTICAST( &( pxPacket->xIPHeader.xDestinationAddress ) ) )
+					{
+						pxSource = prvSelectSourceAddress( &( pxPacket->xIPHeader.xSourceAddress ) );
+					}
+					else
+					{
+						pxSource = &( pxPacket->xIPHeader.xDestinationAddress );
+					}
+
+					if( pxSource != NULL )
+					{
+						/* The source and destination are swapped.  The
+						identifier, sequence number and data are returned as
+						they are. */
+						memcpy( xReplySource.ucBytes, pxSource->ucBytes, sizeof( xReplySource.ucBytes ) );
+						memcpy( pxPacket->xIPHeader.xDestinationAddress.ucBytes, pxPacket->xIPHeader.xSourceAddress.ucBytes, sizeof( IPv6_Address_t ) );
+						memcpy( pxPacket->xIPHeader.xSourceAddress.ucBytes, xReplySource.ucBytes, sizeof( IPv6_Address_t ) );
+						pxPacket->xIPHeader.ucHopLimit = ucHopLimit;
+
+						pxPacket->xICMPHeader.ucTypeOfMessage = ( uint8_t ) ipv6ICMP_ECHO_REPLY;
+						pxPacket->xICMPHeader.usChecksum = 0U;
+						usChecksum = ( uint16_t ) ~prvProtocolSum( &( pxPacket->xIPHeader ), uxICMPLength );
+						pxPacket->xICMPHeader.usChecksum = FreeRTOS_htons( usChecksum );
+
+						/* Drop any padding that the frame had. */
+						pxNetworkBuffer->xDataLength = sizeof( IPv6Packet_t ) + uxICMPLength;
+						eReturn = eReturnEthernetFrame;
+					}
+				}
+				#endif /* ipconfigREPLY_TO_INCOMING_PINGS */
+				break;
+
+			case ipv6ICMP_NEIGHBOUR_SOLICITATION:
+				prvProcessNeighbourSolicitation( ( const NDPacket_t * ) pxPacket, uxICMPLength );
+				break;
+
+			case ipv6ICMP_NEIGHBOUR_ADVERTISEMENT:
+				prvProcessNeighbourAdvertisement( ( const NDPacket_t * ) pxPacket, uxICMPLength );
+				break;
+
+			case ipv6ICMP_ROUTER_ADVERTISEMENT:
+				prvProcessRouterAdvertisement( pxPacket, uxICMPLength );
+				break;
+
+			default:
+				/* Echo replies, router solicitations and error messages are
+				not handled. */
+				break;
+		}
+	}
+
+	return eReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvProcessNeighbourSolicitation( const NDPacket_t *pxPacket, size_t uxICMPLength )
+{
+IPv6AddressEntry_t *pxEntry;
+const uint8_t *pucOptions = &( ( ( const uint8_t * ) pxPacket )[ sizeof( IPv6Packet_t ) + ipv6ND_MESSAGE_LENGTH ] );
+size_t uxOptionsLength, uxOffset;
+BaseType_t xFromDAD;
+
+	if( ( uxICMPLength >= ipv6ND_MESSAGE_LENGTH ) &&
+		( pxPacket->xIPHeader.ucHopLimit == ( uint8_t ) ipv6ND_HOP_LIMIT ) &&
+		( pxPacket->xICMPHeader.ucTypeOfService == 0U ) &&
+		( !ipv6IS_MULTICAST( &( pxPacket->xTargetAddress ) ) ) )
+	{
+		pxEntry = prvFindAddress( &( pxPacket->xTargetAddress ) );
+		xFromDAD = prvIsUnspecified( &( pxPacket->xIPHeader.xSourceAddress ) );
+
+		if( pxEntry == NULL )
+		{
+			/* The solicitation is about another node. */
+		}
+		else if( pxEntry->eState == eIPv6AddressTentative )
+		{
+			if( xFromDAD != pdFALSE )
+			{
+				/* Another node is trying to use the same address. */
+				prvDuplicateAddress( pxEntry );
+			}
+		}
+		else if( pxEntry->eState == eIPv6AddressPreferred )
+		{
+			if( xFromDAD != pdFALSE )
+			{
+				/* Defend the address to all nodes, RFC 4861 section 7.2.4. */
+				prvOutputND( ( uint8_t ) ipv6ICMP_NEIGHBOUR_ADVERTISEMENT, &( pxEntry->xAddress ), &( pxEntry->xAddress ),
+					&xAllNodesAddress, NULL, ( uint8_t ) ipv6NA_FLAG_OVERRIDE );
+			}
+			else
+			{
+				/* The solicitation tells the MAC address of its source,
+				which is needed for the reply. */
+				uxOptionsLength = uxICMPLength - ipv6ND_MESSAGE_LENGTH;
+				uxOffset = prvFindOption( pucOptions, uxOptionsLength, 0U, ( uint8_t ) ipv6OPTION_SOURCE_LINK_LAYER, ipv6OPTION_LINK_LAYER_LENGTH );
+
+				if( uxOffset < uxOptionsLength )
+				{
+					prvNDRefreshCacheEntry( ( const MACAddress_t * ) &( pucOptions[ uxOffset + 2U ] ), &( pxPacket->xIPHeader.xSourceAddress ) );
+				}
+
+				/* A unicast solicitation may come without the option, the
+				reply goes to the MAC address that sent it. */
+				prvOutputND( ( uint8_t ) ipv6ICMP_NEIGHBOUR_ADVERTISEMENT, &( pxEntry->xAddress ), &( pxEntry->xAddress ),
+					&( pxPacket->xIPHeader.xSourceAddress ), &( pxPacket->xEthernetHeader.xSourceAddress ),
+					( uint8_t ) ( ipv6NA_FLAG_SOLICITED | ipv6NA_FLAG_OVERRIDE ) );
+			}
+		}
+		else
+		{
+			/* The address is not used. */
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvProcessNeighbourAdvertisement( const NDPacket_t *pxPacket, size_t uxICMPLength )
+{
+IPv6AddressEntry_t *pxEntry;
+const uint8_t *pucOptions = &( ( ( const uint8_t * ) pxPacket )[ sizeof( IPv6Packet_t ) + ipv6ND_MESSAGE_LENGTH ] );
+size_t uxOptionsLength, uxOffset;
+
+	if( ( uxICMPLength >= ipv6ND_MESSAGE_LENGTH ) &&
+		( pxPacket->xIPHeader.ucHopLimit == ( uint8_t ) ipv6ND_HOP_LIMIT ) &&
+		( pxPacket->xICMPHeader.ucTypeOfService == 0U ) &&
+		( !ipv6IS_MULTICAST( &( pxPacket->xTargetAddress ) ) ) )
+	{
+		pxEntry = prvFindAddress( &( pxPacket->xTargetAddress ) );
+
+		if( pxEntry != NULL )
+		{
+			if( pxEntry->eState == eIPv6AddressTentative )
+			{
+				/* Another node uses the address already. */
+				prvDuplicateAddress( pxEntry );
+			}
+			else
+			{
+				FreeRTOS_printf( ( "IPv6: another node advertises an address of this node\n" ) );
+			}
+		}
+		else if( prvNDFindEntry( &( pxPacket->xTargetAddress ) ) >= 0 )
+		{
+			/* Only neighbours that are in the cache are updated, mostly
+			those that were solicited. */
+			uxOptionsLength = uxICMPLength - ipv6ND_MESSAGE_LENGTH;
+			uxOffset = prvFindOption( pucOptions, uxOptionsLength, 0U, ( uint8_t ) ipv6OPTION_TARGET_LINK_LAYER, ipv6OPTION_LINK_LAYER_LENGTH );
+
+			if( uxOffset < uxOptionsLength )
+			{
+				prvNDRefreshCacheEntry( ( const MACAddress_t * ) &( pucOptions[ uxOffset + 2U ] ), &( pxPacket->xTargetAddress ) );
+			}
+		}
+		else
+		{
+			/* Not interested. */
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvProcessRouterAdvertisement( const ICMPv6Packet_t *pxPacket, size_t uxICMPLength )
+{
+const uint8_t *pucOptions = &( ( ( const uint8_t * ) pxPacket )[ sizeof( IPv6Packet_t ) + ipv6RA_MESSAGE_LENGTH ] );
+const uint8_t *pucPrefix;
+IPv6AddressEntry_t *pxGlobal = &( xAddresses[ eIPv6Global ] );
+size_t uxOptionsLength, uxOffset;
+uint32_t ulValidLifetime, ulPreferredLifetime;
+uint16_t usRouterLifetime;
+
+	if( ( uxICMPLength >= ipv6RA_MESSAGE_LENGTH ) &&
+		( pxPacket->xIPHeader.ucHopLimit == ( uint8_t ) ipv6ND_HOP_LIMIT ) &&
+		( pxPacket->xICMPHeader.ucTypeOfService == 0U ) &&
+		( ipv6IS_LINK_LOCAL( &( pxPacket->xIPHeader.xSourceAddress ) ) ) )
+	{
+		uxOptionsLength = uxICMPLength - ipv6RA_MESSAGE_LENGTH;
+
+		/* The routers are known, stop soliciting. */
+		uxRouterSolicitations = ipv6MAX_ROUTER_SOLICITATIONS;
+
+		if( pxPacket->xICMPHeader.ucMessageBody[ 0 ] != 0U )
+		{
+			ucHopLimit = pxPacket->xICMPHeader.ucMessageBody[ 0 ];
+		}
+
+		/* Only one default router is remembered, the last one that
+		advertised itself. */
+		usRouterLifetime = usChar2u16( &( pxPacket->xICMPHeader.ucMessageBody[ 2 ] ) );
+
+		if( usRouterLifetime != 0U )
+		{
+			memcpy( xRouterAddress.ucBytes, pxPacket->xIPHeader.xSourceAddress.ucBytes, sizeof( xRouterAddress.ucBytes ) );
+			ulRouterLifetime = ( uint32_t ) usRouterLifetime;
+		}
+		else if( memcmp( xRouterAddress.ucBytes, pxPacket->xIPHeader.xSourceAddress.ucBytes, sizeof( xRouterAddress.ucBytes ) ) == 0 )
+		{
+			/* The router stops being a default router. */
+			ulRouterLifetime = 0UL;
+		}
+		else
+		{
+			/* Another router that is not a default router. */
+		}
+
+		uxOffset = prvFindOption( pucOptions, uxOptionsLength, 0U, ( uint8_t ) ipv6OPTION_SOURCE_LINK_LAYER, ipv6OPTION_LINK_LAYER_LENGTH );
+
+		if( uxOffset < uxOptionsLength )
+		{
+			prvNDRefreshCacheEntry( ( const MACAddress_t * ) &( pucOptions[ uxOffset + 2U ] ), &( pxPacket->xIPHeader.xSourceAddress ) );
+		}
+
+		for( uxOffset = prvFindOption( pucOptions, uxOptionsLength, 0U, ( uint8_t ) ipv6OPTION_PREFIX_INFORMATION, ipv6OPTION_PREFIX_LENGTH );
+			 uxOffset < uxOptionsLength;
+			 uxOffset = prvFindOption( pucOptions, uxOptionsLength, uxOffset + ipv6OPTION_PREFIX_LENGTH, ( uint8_t ) ipv6OPTION_PREFIX_INFORMATION, ipv6OPTION_PREFIX_LENGTH ) )
+		{
+			/* The prefix information option, RFC 4861 section 4.6.2:
+			type, length, prefix length, flags, valid lifetime, preferred
+			lifetime, 4 reserved bytes, and the prefix. */
+			ulValidLifetime = ulChar2u32( &( pucOptions[ uxOffset + 4U ] ) );
+			ulPreferredLifetime = ulChar2u32( &( pucOptions[ uxOffset + 8U ] ) );
+			pucPrefix = &( pucOptions[ uxOffset + 16U ] );
+
+			if( ( pucOptions[ uxOffset + 2U ] != ( uint8_t ) ( ipv6PREFIX_BYTES * 8U ) ) ||
+				( ( pucOptions[ uxOffset + 3U ] & ipv6PREFIX_FLAG_AUTONOMOUS ) == 0U ) ||
+				( ulPreferredLifetime > ulValidLifetime ) ||
+				( ( pucPrefix[ 0 ] == 0xfeU ) && ( ( pucPrefix[ 1 ] & 0xc0U ) == 0x80U ) ) )
+			{
+				/* Not a prefix from which an address can be formed. */
+			}
+			else if( pxGlobal->eState == eIPv6AddressUnused )
+			{
+				if( ulValidLifetime != 0UL )
+				{
+					prvStartAddress( eIPv6Global, pucPrefix );
+					pxGlobal->ulValidLifetime = ulValidLifetime;
+				}
+			}
+			else if( memcmp( pxGlobal->xAddress.ucBytes, pucPrefix, ipv6PREFIX_BYTES ) == 0 )
+			{
+				/* The prefix of the current address, RFC 4862 section 5.5.3
+				item e: an advertisement can not make the lifetime shorter
+				than two hours. */
+				if( pxGlobal->eState == eIPv6AddressDuplicate )
+				{
+					/* The address can not be used. */
+				}
+				else if( ( ulValidLifetime > ipv6TWO_HOURS ) || ( ulValidLifetime > pxGlobal->ulValidLifetime ) )
+				{
+					pxGlobal->ulValidLifetime = ulValidLifetime;
+				}
+				else if( pxGlobal->ulValidLifetime > ipv6TWO_HOURS )
+				{
+					pxGlobal->ulValidLifetime = ipv6TWO_HOURS;
+				}
+				else
+				{
+					/* Keep the remaining lifetime. */
+				}
+			}
+			else
+			{
+				/* Only one global address is configured. */
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static eFrameProcessingResult_t prvProcessUDPPacket( NetworkBufferDescriptor_t * const pxNetworkBuffer, size_t uxUDPLength )
+{
+UDPv6Packet_t *pxUDPPacket = ( UDPv6Packet_t * ) pxNetworkBuffer->pucEthernetBuffer;
+IPv6_Address_t xSourceAddress;
+eFrameProcessingResult_t eReturn = eReleaseBuffer;
+uint16_t usLength, usDestinationPort;
+BaseType_t xValid;
+
+	usLength = FreeRTOS_ntohs( pxUDPPacket->xUDPHeader.usLength );
+
+	if( ( uxUDPLength < ipSIZE_OF_UDP_HEADER ) ||
+		( ( size_t ) usLength < ipSIZE_OF_UDP_HEADER ) ||
+		( ( size_t ) usLength > uxUDPLength ) )
+	{
+		xValid = pdFALSE;
+	}
+	else if( ( ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM != 0 ) || ipHAS_OFFLOAD( pxNetworkBuffer, ipOFFLOAD_RX_CHECKSUM ) )
+	{
+		/* The driver checked the checksum already. */
+		xValid = pdTRUE;
+	}
+	else if( ( pxUDPPacket->xUDPHeader.usChecksum == 0U ) ||
+			 ( prvProtocolSum( &( pxUDPPacket->xIPHeader ), ( size_t ) usLength ) != 0xffffU ) )
+	{
+		/* The checksum is missing, which IPv6 does not allow, or wrong. */
+		xValid = pdFALSE;
+	}
+	else
+	{
+		xValid = pdTRUE;
+	}
+
+	if( xValid != pdFALSE )
+	{
+		memcpy( xSourceAddress.ucBytes, pxUDPPacket->xIPHeader.xSourceAddress.ucBytes, sizeof( xSourceAddress.ucBytes ) );
+
+		if( ( !ipv6IS_MULTICAST( &( pxUDPPacket->xIPHeader.xDestinationAddress ) ) ) &&
+			( ( ipv6IS_LINK_LOCAL( &xSourceAddress ) ) ||
+			  ( memcmp( xSourceAddress.ucBytes, xAddresses[ eIPv6Global ].xAddress.ucBytes, ipv6PREFIX_BYTES ) == 0 ) ) )
+		{
+			/* A neighbour that sent to this node directly, remember its MAC
+			address, as vARPRefreshCacheEntry() does for IPv4. */
+			prvNDRefreshCacheEntry( &( pxUDPPacket->xEthernetHeader.xSourceAddress ), &xSourceAddress );
+		}
+
+		/* Rearrange the packet so that the payload is found where the sockets
+		expect it, like prvProcessIPPacket() removes IPv4 options.  The
+		destination address is kept in the space of the IPv4 header, which
+		is followed by the UDP header and the payload. */
+		memcpy( pxNetworkBuffer->xIPv6Address.ucBytes, xSourceAddress.ucBytes, sizeof( xSourceAddress.ucBytes ) );
+		memcpy( &( pxNetworkBuffer->pucEthernetBuffer[ ipIPv6_UDP_DESTINATION_OFFSET ] ), pxUDPPacket->xIPHeader.xDestinationAddress.ucBytes, sizeof( IPv6_Address_t ) );
+		memmove( &( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 - ipSIZE_OF_UDP_HEADER ] ),
+			&( pxNetworkBuffer->pucEthernetBuffer[ sizeof( IPv6Packet_t ) ] ),
+			( size_t ) usLength );
+
+		/* Fields in pxNetworkBuffer (usPort, ulIPAddress) are network order. */
+		usDestinationPort = ( ( UDPPacket_t * ) pxNetworkBuffer->pucEthernetBuffer )->xUDPHeader.usDestinationPort;
+		pxNetworkBuffer->usPort = ( ( UDPPacket_t * ) pxNetworkBuffer->pucEthernetBuffer )->xUDPHeader.usSourcePort;
+		pxNetworkBuffer->ulIPAddress = 0UL;
+		pxNetworkBuffer->xUsesIPv6 = pdTRUE;
+		pxNetworkBuffer->xDataLength = ( size_t ) usLength - ipSIZE_OF_UDP_HEADER;
+
+		if( xProcessReceivedUDPPacket( pxNetworkBuffer, usDestinationPort ) == pdPASS )
+		{
+			eReturn = eFrameConsumed;
+		}
+	}
+
+	return eReturn;
+}
+/*-----------------------------------------------------------*/
+
+/* Provide access to private members for testing. */
+#ifdef AMAZON_FREERTOS_ENABLE_UNIT_TESTS
+	#include "iot_freertos_tcp_test_access_ipv6_define.h"
+#endif
+
+#endif /* ipconfigUSE_IPv6 */
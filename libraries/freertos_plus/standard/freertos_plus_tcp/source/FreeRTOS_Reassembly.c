@@ -0,0 +1,463 @@
+/*
+ * FreeRTOS+TCP V2.0.11
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ * FreeRTOS_Reassembly.c
+ * Reassembly of incoming IPv4 datagrams that were fragmented on their way,
+ * when ipconfigUSE_IP_REASSEMBLY is set to 1.
+ *
+ * Memory is bounded: at most ipconfigIP_REASSEMBLY_MAX_DATAGRAMS datagrams are
+ * reassembled at the same time, each in one network buffer that can hold a
+ * datagram of ipconfigIP_REASSEMBLY_MAX_SIZE bytes.  The data of a fragment is
+ * copied into that buffer, after which the fragment is released.  Fragments of
+ * a new datagram are dropped while all buffers are in use, and a datagram that
+ * is not complete within ipconfigIP_REASSEMBLY_TIMEOUT_MS is discarded.
+ *
+ * The parts of a datagram that are still missing are kept in a list of holes,
+ * as described in RFC 815.  A fragment only fills the holes that it overlaps,
+ * so the bytes that arrived first are kept, and overlapping or duplicated
+ * fragments can never overwrite data or write outside the buffer.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "NetworkBufferManagement.h"
+#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+	#include "FreeRTOS_Routing.h"
+#endif
+
+/* Exclude the entire file if reassembly is not used. */
+#if( ipconfigUSE_IP_REASSEMBLY != 0 )
+
+/* The largest payload, after the IP header, of a reassembled datagram. */
+#define reassMAX_PAYLOAD_LENGTH		( ( size_t ) ipconfigIP_REASSEMBLY_MAX_SIZE - ipSIZE_OF_IPv4_HEADER )
+
+/* The number of holes that a datagram can have.  Every fragment splits at
+most one hole in two, so fragments that arrive in order only need one. */
+#define reassMAX_HOLES				( 8U )
+
+/* The fields of the 'usFragmentOffset' member of the IP header, in host order. */
+#define reassMORE_FRAGMENTS			( 0x2000U )
+#define reassOFFSET_MASK			( 0x1FFFU )
+
+/* The fragment offset is expressed in units of 8 bytes. */
+#define reassOFFSET_UNIT			( 8U )
+
+#if( ipconfigIP_REASSEMBLY_MAX_SIZE > 0xffff )
+	#error ipconfigIP_REASSEMBLY_MAX_SIZE can not be larger than an IPv4 datagram
+#endif
+
+/* BufferAllocation_1.c ignores the size that is asked for, its buffers hold
+ipconfigNETWORK_MTU bytes.  Which allocator is linked is only known at run
+time, from xBufferAllocFixedSize. */
+#define reassBUFFER_FITS()			( ( xBufferAllocFixedSize == pdFALSE ) || ( ipconfigIP_REASSEMBLY_MAX_SIZE <= ipconfigNETWORK_MTU ) )
+
+/*-----------------------------------------------------------*/
+
+/* A range of payload bytes that has not been received yet. */
+typedef struct xREASSEMBLY_HOLE
+{
+	size_t uxFirst;			/* The offset of the first missing byte. */
+	size_t uxEnd;			/* The offset just past the last missing byte. */
+} ReassemblyHole_t;
+
+/* A datagram that is being reassembled. */
+typedef struct xREASSEMBLY_DATAGRAM
+{
+	NetworkBufferDescriptor_t *pxBuffer;	/* Holds the datagram, or NULL when this entry is free. */
+	uint32_t ulSourceIPAddress;				/* The source, destination, identification and */
+	uint32_t ulDestinationIPAddress;		/* protocol identify the fragments of a datagram, */
+	uint16_t usIdentification;				/* see RFC 791. */
+	uint8_t ucProtocol;
+	BaseType_t xHasHeaders;					/* pdTRUE once the first fragment supplied the headers. */
+	TickType_t xStartTime;					/* When the first fragment arrived. */
+	size_t uxTotalLength;					/* The length of the payload, or zero until the last fragment arrived. */
+	size_t uxHighestEnd;					/* The end of the furthest fragment received. */
+	UBaseType_t uxHoleCount;
+	ReassemblyHole_t xHoles[ reassMAX_HOLES ];
+} ReassemblyDatagram_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Find the datagram to which a fragment belongs, or start a new one.  Returns
+ * NULL when all datagrams are in use or when no network buffer is available.
+ */
+static ReassemblyDatagram_t *prvFindDatagram( const IPHeader_t *pxIPHeader );
+
+/*
+ * Discard a datagram and release its network buffer.
+ */
+static void prvFreeDatagram( ReassemblyDatagram_t *pxDatagram );
+
+/*
+ * Learn the length of the payload from the last fragment, and forget the
+ * holes beyond it.  Returns pdFAIL when the fragments contradict each other.
+ */
+static BaseType_t prvSetTotalLength( ReassemblyDatagram_t *pxDatagram, size_t uxTotalLength );
+
+/*
+ * Copy the bytes of a fragment that fall into holes, and shrink or split those
+ * holes.  Returns pdFAIL when there is no room to split a hole.
+ */
+static BaseType_t prvFillHoles( ReassemblyDatagram_t *pxDatagram, const uint8_t *pucData, size_t uxFirst, size_t uxEnd );
+
+/*
+ * Turn a complete datagram into a normal received packet.
+ */
+static NetworkBufferDescriptor_t *prvCompleteDatagram( ReassemblyDatagram_t *pxDatagram );
+
+/*-----------------------------------------------------------*/
+
+static ReassemblyDatagram_t xDatagrams[ ipconfigIP_REASSEMBLY_MAX_DATAGRAMS ];
+
+/*-----------------------------------------------------------*/
+
+static ReassemblyDatagram_t *prvFindDatagram( const IPHeader_t *pxIPHeader )
+{
+ReassemblyDatagram_t *pxReturn = NULL;
+ReassemblyDatagram_t *pxFree = NULL;
+UBaseType_t uxIndex;
+
+	for( uxIndex = 0U; uxIndex < ( UBaseType_t ) ipconfigIP_REASSEMBLY_MAX_DATAGRAMS; uxIndex++ )
+	{
+		if( xDatagrams[ uxIndex ].pxBuffer == NULL )
+		{
+			if( pxFree == NULL )
+			{
+				pxFree = &( xDatagrams[ uxIndex ] );
+			}
+		}
+		else if( ( xDatagrams[ uxIndex ].ulSourceIPAddress == pxIPHeader->ulSourceIPAddress ) &&
+				 ( xDatagrams[ uxIndex ].ulDestinationIPAddress == pxIPHeader->ulDestinationIPAddress ) &&
+				 ( xDatagrams[ uxIndex ].usIdentification == pxIPHeader->usIdentification ) &&
+				 ( xDatagrams[ uxIndex ].ucProtocol == pxIPHeader->ucProtocol ) )
+		{
+			pxReturn = &( xDatagrams[ uxIndex ] );
+			break;
+		}
+		else
+		{
+			/* Another datagram. */
+		}
+	}
+
+	/* A longer datagram would be written past the end of a fixed size
+	buffer: lower ipconfigIP_REASSEMBLY_MAX_SIZE, or use BufferAllocation_2.c
+	or BufferAllocation_3.c. */
+	configASSERT( reassBUFFER_FITS() );
+
+	if( ( pxReturn == NULL ) && ( pxFree != NULL ) && reassBUFFER_FITS() )
+	{
+		/* The IP-task may not block, so the buffer must be available now. */
+		pxFree->pxBuffer = pxGetNetworkBufferWithDescriptor( ipSIZE_OF_ETH_HEADER + ( size_t ) ipconfigIP_REASSEMBLY_MAX_SIZE, 0U );
+
+		if( pxFree->pxBuffer != NULL )
+		{
+			pxFree->ulSourceIPAddress = pxIPHeader->ulSourceIPAddress;
+			pxFree->ulDestinationIPAddress = pxIPHeader->ulDestinationIPAddress;
+			pxFree->usIdentification = pxIPHeader->usIdentification;
+			pxFree->ucProtocol = pxIPHeader->ucProtocol;
+			pxFree->xHasHeaders = pdFALSE;
+			pxFree->xStartTime = xTaskGetTickCount();
+			pxFree->uxTotalLength = 0U;
+			pxFree->uxHighestEnd = 0U;
+			pxFree->uxHoleCount = 1U;
+			pxFree->xHoles[ 0 ].uxFirst = 0U;
+			pxFree->xHoles[ 0 ].uxEnd = reassMAX_PAYLOAD_LENGTH;
+			pxReturn = pxFree;
+		}
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvFreeDatagram( ReassemblyDatagram_t *pxDatagram )
+{
+	if( pxDatagram->pxBuffer != NULL )
+	{
+		vReleaseNetworkBufferAndDescriptor( pxDatagram->pxBuffer );
+		pxDatagram->pxBuffer = NULL;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSetTotalLength( ReassemblyDatagram_t *pxDatagram, size_t uxTotalLength )
+{
+BaseType_t xReturn = pdPASS;
+UBaseType_t uxIndex;
+
+	if( pxDatagram->uxTotalLength != 0U )
+	{
+		/* A second last fragment must agree with the first one. */
+		if( pxDatagram->uxTotalLength != uxTotalLength )
+		{
+			xReturn = pdFAIL;
+		}
+	}
+	else if( pxDatagram->uxHighestEnd > uxTotalLength )
+	{
+		/* Data was received beyond the end of the datagram. */
+		xReturn = pdFAIL;
+	}
+	else
+	{
+		pxDatagram->uxTotalLength = uxTotalLength;
+
+		uxIndex = 0U;
+		while( uxIndex < pxDatagram->uxHoleCount )
+		{
+			if( pxDatagram->xHoles[ uxIndex ].uxFirst >= uxTotalLength )
+			{
+				/* The hole is beyond the end, replace it by the last one. */
+				pxDatagram->uxHoleCount--;
+				pxDatagram->xHoles[ uxIndex ] = pxDatagram->xHoles[ pxDatagram->uxHoleCount ];
+			}
+			else
+			{
+				if( pxDatagram->xHoles[ uxIndex ].uxEnd > uxTotalLength )
+				{
+					pxDatagram->xHoles[ uxIndex ].uxEnd = uxTotalLength;
+				}
+				uxIndex++;
+			}
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvFillHoles( ReassemblyDatagram_t *pxDatagram, const uint8_t *pucData, size_t uxFirst, size_t uxEnd )
+{
+BaseType_t xReturn = pdPASS;
+UBaseType_t uxIndex;
+ReassemblyHole_t xHole;
+size_t uxCopyFirst, uxCopyEnd;
+uint8_t *pucPayload = &( pxDatagram->pxBuffer->pucEthernetBuffer[ ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER ] );
+
+	uxIndex = 0U;
+	while( uxIndex < pxDatagram->uxHoleCount )
+	{
+		xHole = pxDatagram->xHoles[ uxIndex ];
+
+		if( ( uxFirst >= xHole.uxEnd ) || ( uxEnd <= xHole.uxFirst ) )
+		{
+			/* The fragment does not overlap this hole. */
+			uxIndex++;
+		}
+		else
+		{
+			/* Copy only the part that falls in the hole. */
+			uxCopyFirst = ( uxFirst > xHole.uxFirst ) ? uxFirst : xHole.uxFirst;
+			uxCopyEnd = ( uxEnd < xHole.uxEnd ) ? uxEnd : xHole.uxEnd;
+			memcpy( &( pucPayload[ uxCopyFirst ] ), &( pucData[ uxCopyFirst - uxFirst ] ), uxCopyEnd - uxCopyFirst );
+
+			if( ( xHole.uxFirst < uxFirst ) && ( uxEnd < xHole.uxEnd ) )
+			{
+				/* The fragment falls inside the hole, which is split in two. */
+				if( pxDatagram->uxHoleCount >= reassMAX_HOLES )
+				{
+					xReturn = pdFAIL;
+					break;
+				}
+				pxDatagram->xHoles[ uxIndex ].uxEnd = uxFirst;
+				pxDatagram->xHoles[ pxDatagram->uxHoleCount ].uxFirst = uxEnd;
+				pxDatagram->xHoles[ pxDatagram->uxHoleCount ].uxEnd = xHole.uxEnd;
+				pxDatagram->uxHoleCount++;
+				uxIndex++;
+			}
+			else if( xHole.uxFirst < uxFirst )
+			{
+				/* The fragment covers the end of the hole. */
+				pxDatagram->xHoles[ uxIndex ].uxEnd = uxFirst;
+				uxIndex++;
+			}
+			else if( uxEnd < xHole.uxEnd )
+			{
+				/* The fragment covers the start of the hole. */
+				pxDatagram->xHoles[ uxIndex ].uxFirst = uxEnd;
+				uxIndex++;
+			}
+			else
+			{
+				/* The hole is filled, replace it by the last one. */
+				pxDatagram->uxHoleCount--;
+				pxDatagram->xHoles[ uxIndex ] = pxDatagram->xHoles[ pxDatagram->uxHoleCount ];
+			}
+		}
+	}
+
+	if( uxEnd > pxDatagram->uxHighestEnd )
+	{
+		pxDatagram->uxHighestEnd = uxEnd;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static NetworkBufferDescriptor_t *prvCompleteDatagram( ReassemblyDatagram_t *pxDatagram )
+{
+NetworkBufferDescriptor_t *pxReturn = pxDatagram->pxBuffer;
+IPHeader_t *pxIPHeader = &( ( ( IPPacket_t * ) pxReturn->pucEthernetBuffer )->xIPHeader );
+
+	pxDatagram->pxBuffer = NULL;
+
+	/* The options of the first fragment were not copied. */
+	pxIPHeader->ucVersionHeaderLength = ( uint8_t ) ( ( pxIPHeader->ucVersionHeaderLength & 0xF0U ) | ( ipSIZE_OF_IPv4_HEADER >> 2 ) );
+	pxIPHeader->usLength = FreeRTOS_htons( ( uint16_t ) ( ipSIZE_OF_IPv4_HEADER + pxDatagram->uxTotalLength ) );
+	pxIPHeader->usFragmentOffset = 0U;
+	pxIPHeader->usHeaderChecksum = 0U;
+	pxIPHeader->usHeaderChecksum = usGenerateChecksum( 0UL, ( uint8_t * ) &( pxIPHeader->ucVersionHeaderLength ), ipSIZE_OF_IPv4_HEADER );
+	pxIPHeader->usHeaderChecksum = ~FreeRTOS_htons( pxIPHeader->usHeaderChecksum );
+
+	pxReturn->xDataLength = ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + pxDatagram->uxTotalLength;
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+NetworkBufferDescriptor_t *pxIPReassemble( const NetworkBufferDescriptor_t * const pxFragment, UBaseType_t uxHeaderLength )
+{
+NetworkBufferDescriptor_t *pxReturn = NULL;
+const IPHeader_t *pxIPHeader = &( ( ( const IPPacket_t * ) pxFragment->pucEthernetBuffer )->xIPHeader );
+ReassemblyDatagram_t *pxDatagram;
+uint16_t usFlags = FreeRTOS_ntohs( pxIPHeader->usFragmentOffset );
+size_t uxIPLength = ( size_t ) FreeRTOS_ntohs( pxIPHeader->usLength );
+size_t uxFirst, uxEnd;
+BaseType_t xResult;
+
+	uxFirst = ( size_t ) ( usFlags & reassOFFSET_MASK ) * reassOFFSET_UNIT;
+	uxEnd = uxFirst + uxIPLength - ( size_t ) uxHeaderLength;
+
+	if( ( uxIPLength <= ( size_t ) uxHeaderLength ) ||
+		( uxIPLength > ( pxFragment->xDataLength - ipSIZE_OF_ETH_HEADER ) ) )
+	{
+		/* The length field is not valid. */
+	}
+	else if( ( ( usFlags & reassMORE_FRAGMENTS ) != 0U ) && ( ( ( uxEnd - uxFirst ) % reassOFFSET_UNIT ) != 0U ) )
+	{
+		/* Only the last fragment may have a length that is not a multiple of
+		8 bytes. */
+	}
+	else
+	{
+		pxDatagram = prvFindDatagram( pxIPHeader );
+
+		if( pxDatagram == NULL )
+		{
+			FreeRTOS_debug_printf( ( "pxIPReassemble: no room for datagram %u\n", FreeRTOS_ntohs( pxIPHeader->usIdentification ) ) );
+		}
+		else
+		{
+			if( uxEnd > reassMAX_PAYLOAD_LENGTH )
+			{
+				/* The datagram is too long to be reassembled. */
+				xResult = pdFAIL;
+			}
+			else if( ( usFlags & reassMORE_FRAGMENTS ) == 0U )
+			{
+				xResult = prvSetTotalLength( pxDatagram, uxEnd );
+			}
+			else if( ( pxDatagram->uxTotalLength != 0U ) && ( uxEnd > pxDatagram->uxTotalLength ) )
+			{
+				/* The fragment reaches beyond the last fragment. */
+				xResult = pdFAIL;
+			}
+			else
+			{
+				xResult = pdPASS;
+			}
+
+			if( ( xResult != pdFAIL ) && ( uxFirst == 0U ) && ( pxDatagram->xHasHeaders == pdFALSE ) )
+			{
+				/* The first fragment supplies the Ethernet and IP headers. */
+				memcpy( pxDatagram->pxBuffer->pucEthernetBuffer, pxFragment->pucEthernetBuffer, ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER );
+				#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+				{
+					pxDatagram->pxBuffer->pxInterface = pxFragment->pxInterface;
+					pxDatagram->pxBuffer->pxEndPoint = pxFragment->pxEndPoint;
+				}
+				#endif
+				pxDatagram->xHasHeaders = pdTRUE;
+			}
+
+			if( xResult != pdFAIL )
+			{
+				xResult = prvFillHoles( pxDatagram, &( pxFragment->pucEthernetBuffer[ ipSIZE_OF_ETH_HEADER + uxHeaderLength ] ), uxFirst, uxEnd );
+			}
+
+			if( xResult == pdFAIL )
+			{
+				FreeRTOS_debug_printf( ( "pxIPReassemble: dropped datagram %u\n", FreeRTOS_ntohs( pxIPHeader->usIdentification ) ) );
+				prvFreeDatagram( pxDatagram );
+			}
+			else if( ( pxDatagram->uxTotalLength != 0U ) && ( pxDatagram->uxHoleCount == 0U ) )
+			{
+				/* The hole at offset 0 can only be filled by the first
+				fragment, so the headers are present. */
+				configASSERT( pxDatagram->xHasHeaders != pdFALSE );
+				pxReturn = prvCompleteDatagram( pxDatagram );
+			}
+			else
+			{
+				/* Wait for more fragments. */
+			}
+		}
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vIPReassemblyCheckTimeouts( void )
+{
+UBaseType_t uxIndex;
+TickType_t xNow = xTaskGetTickCount();
+
+	for( uxIndex = 0U; uxIndex < ( UBaseType_t ) ipconfigIP_REASSEMBLY_MAX_DATAGRAMS; uxIndex++ )
+	{
+		if( ( xDatagrams[ uxIndex ].pxBuffer != NULL ) &&
+			( ( xNow - xDatagrams[ uxIndex ].xStartTime ) >= pdMS_TO_TICKS( ipconfigIP_REASSEMBLY_TIMEOUT_MS ) ) )
+		{
+			FreeRTOS_debug_printf( ( "vIPReassemblyCheckTimeouts: datagram %u timed out\n", FreeRTOS_ntohs( xDatagrams[ uxIndex ].usIdentification ) ) );
+			prvFreeDatagram( &( xDatagrams[ uxIndex ] ) );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_IP_REASSEMBLY != 0 */
@@ -0,0 +1,649 @@
+/*
+ * FreeRTOS+TCP V2.0.11
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_IP_Private.h"
+#include "FreeRTOS_ARP.h"
+#include "FreeRTOS_DNS.h"
+#include "FreeRTOS_Routing.h"
+#include "NetworkInterface.h"
+#include "NetworkBufferManagement.h"
+
+/* Exclude the entire file if multiple interfaces are not being used. */
+#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+
+/* An entry in the routing table.  The entry is free when pxEndPoint is NULL. */
+typedef struct xIP_ROUTE
+{
+	uint32_t ulDestination;			/* Network byte order. */
+	uint32_t ulNetMask;				/* Network byte order. */
+	uint32_t ulGateway;				/* Network byte order, zero when the destination is reached directly. */
+	NetworkEndPoint_t *pxEndPoint;	/* The end-point through which the destination is reached. */
+	UBaseType_t uxMetric;			/* Lower metrics are preferred. */
+} IPRoute_t;
+
+/* A route that matches the destination being looked up. */
+typedef struct xROUTE_CANDIDATE
+{
+	NetworkEndPoint_t *pxEndPoint;
+	uint32_t ulPrefix;				/* The netmask in host byte order, so a more specific route compares higher. */
+	uint32_t ulNextHop;
+	UBaseType_t uxMetric;
+} RouteCandidate_t;
+
+/* Walks through the implicit routes of the end-points followed by the routing
+table, see prvNextCandidate(). */
+typedef struct xROUTE_ITERATOR
+{
+	NetworkEndPoint_t *pxEndPoint;
+	BaseType_t xGatewayDone;
+	UBaseType_t uxRoute;
+} RouteIterator_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Returns the next route that leads to ulIPAddress, or pdFALSE when all routes
+ * have been visited.  Routes through an interface that is down are skipped.
+ */
+static BaseType_t prvNextCandidate( uint32_t ulIPAddress, RouteIterator_t *pxIterator, RouteCandidate_t *pxCandidate );
+
+/*
+ * Returns pdTRUE if the end-point has an address and its link is up.
+ */
+static BaseType_t prvEndPointIsUsable( const NetworkEndPoint_t *pxEndPoint );
+
+/*
+ * Returns the end-point that must send a frame for which the stack didn't set
+ * 'pxEndPoint', based on the source address in the frame.
+ */
+static NetworkEndPoint_t *prvEndPointForFrame( const NetworkBufferDescriptor_t *pxNetworkBuffer );
+
+/*-----------------------------------------------------------*/
+
+/* All interfaces, in the order in which they were added. */
+static NetworkInterface_t *pxNetworkInterfaces = NULL;
+
+/* The end-point created by FreeRTOS_IPInit().  Its addressing is kept in
+xNetworkAddressing and xDefaultPartUDPPacketHeader, as it was before multiple
+interfaces were supported, and is copied into this structure whenever the list
+of end-points is accessed.  The end-points added by FreeRTOS_AddEndPoint() are
+linked behind it. */
+static NetworkEndPoint_t xPrimaryEndPoint;
+
+/* The routes added with FreeRTOS_AddRoute(). */
+static IPRoute_t xRoutes[ ipconfigMAX_ROUTES ];
+
+/*-----------------------------------------------------------*/
+
+void FreeRTOS_AddNetworkInterface( NetworkInterface_t *pxInterface )
+{
+NetworkInterface_t **ppxLast = &pxNetworkInterfaces;
+
+	configASSERT( pxInterface != NULL );
+	configASSERT( pxInterface->pfInitialise != NULL );
+	configASSERT( pxInterface->pfOutput != NULL );
+
+	/* Interfaces can only be added before the IP-task starts using them. */
+	configASSERT( xIPIsNetworkTaskReady() == pdFALSE );
+
+	pxInterface->xLinkUp = pdFALSE;
+	pxInterface->pxNext = NULL;
+
+	while( *ppxLast != NULL )
+	{
+		ppxLast = &( ( *ppxLast )->pxNext );
+	}
+	*ppxLast = pxInterface;
+}
+/*-----------------------------------------------------------*/
+
+void FreeRTOS_AddEndPoint( NetworkInterface_t *pxInterface,
+	NetworkEndPoint_t *pxEndPoint,
+	const uint8_t ucIPAddress[ ipIP_ADDRESS_LENGTH_BYTES ],
+	const uint8_t ucNetMask[ ipIP_ADDRESS_LENGTH_BYTES ],
+	const uint8_t ucGatewayAddress[ ipIP_ADDRESS_LENGTH_BYTES ],
+	const uint8_t ucDNSServerAddress[ ipIP_ADDRESS_LENGTH_BYTES ],
+	const uint8_t ucMACAddress[ ipMAC_ADDRESS_LENGTH_BYTES ] )
+{
+NetworkEndPoint_t *pxLast;
+
+	configASSERT( pxInterface != NULL );
+	configASSERT( pxEndPoint != NULL );
+
+	memset( pxEndPoint, '\0', sizeof( *pxEndPoint ) );
+	pxEndPoint->ulIPAddress = FreeRTOS_inet_addr_quick( ucIPAddress[ 0 ], ucIPAddress[ 1 ], ucIPAddress[ 2 ], ucIPAddress[ 3 ] );
+	pxEndPoint->ulNetMask = FreeRTOS_inet_addr_quick( ucNetMask[ 0 ], ucNetMask[ 1 ], ucNetMask[ 2 ], ucNetMask[ 3 ] );
+	pxEndPoint->ulGatewayAddress = FreeRTOS_inet_addr_quick( ucGatewayAddress[ 0 ], ucGatewayAddress[ 1 ], ucGatewayAddress[ 2 ], ucGatewayAddress[ 3 ] );
+	pxEndPoint->ulDNSServerAddress = FreeRTOS_inet_addr_quick( ucDNSServerAddress[ 0 ], ucDNSServerAddress[ 1 ], ucDNSServerAddress[ 2 ], ucDNSServerAddress[ 3 ] );
+	pxEndPoint->ulBroadcastAddress = ( pxEndPoint->ulIPAddress & pxEndPoint->ulNetMask ) | ~pxEndPoint->ulNetMask;
+	memcpy( pxEndPoint->xMACAddress.ucBytes, ucMACAddress, ( size_t ) ipMAC_ADDRESS_LENGTH_BYTES );
+	pxEndPoint->pxNetworkInterface = pxInterface;
+
+	/* The gateway must be on the same subnet as the end-point. */
+	configASSERT( ( pxEndPoint->ulGatewayAddress == 0UL ) ||
+		( ( ( pxEndPoint->ulIPAddress ^ pxEndPoint->ulGatewayAddress ) & pxEndPoint->ulNetMask ) == 0UL ) );
+
+	vTaskSuspendAll();
+	{
+		for( pxLast = &xPrimaryEndPoint; pxLast->pxNext != NULL; pxLast = pxLast->pxNext )
+		{
+		}
+		pxLast->pxNext = pxEndPoint;
+	}
+	( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_AddRoute( uint32_t ulDestination, uint32_t ulNetMask, uint32_t ulGateway,
+	NetworkEndPoint_t *pxEndPoint, UBaseType_t uxMetric )
+{
+BaseType_t xIndex;
+BaseType_t xReturn = pdFAIL;
+
+	configASSERT( pxEndPoint != NULL );
+
+	taskENTER_CRITICAL();
+	{
+		for( xIndex = 0; xIndex < ( BaseType_t ) ipconfigMAX_ROUTES; xIndex++ )
+		{
+			if( xRoutes[ xIndex ].pxEndPoint == NULL )
+			{
+				xRoutes[ xIndex ].ulDestination = ulDestination & ulNetMask;
+				xRoutes[ xIndex ].ulNetMask = ulNetMask;
+				xRoutes[ xIndex ].ulGateway = ulGateway;
+				xRoutes[ xIndex ].uxMetric = uxMetric;
+				/* Written last, as it marks the entry as being in use. */
+				xRoutes[ xIndex ].pxEndPoint = pxEndPoint;
+				xReturn = pdPASS;
+				break;
+			}
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_RemoveRoute( uint32_t ulDestination, uint32_t ulNetMask, NetworkEndPoint_t *pxEndPoint )
+{
+BaseType_t xIndex;
+BaseType_t xReturn = pdFAIL;
+
+	taskENTER_CRITICAL();
+	{
+		for( xIndex = 0; xIndex < ( BaseType_t ) ipconfigMAX_ROUTES; xIndex++ )
+		{
+			if( ( xRoutes[ xIndex ].pxEndPoint == pxEndPoint ) &&
+				( pxEndPoint != NULL ) &&
+				( xRoutes[ xIndex ].ulDestination == ( ulDestination & ulNetMask ) ) &&
+				( xRoutes[ xIndex ].ulNetMask == ulNetMask ) )
+			{
+				xRoutes[ xIndex ].pxEndPoint = NULL;
+				xReturn = pdPASS;
+				break;
+			}
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void FreeRTOS_SetInterfaceLinkState( NetworkInterface_t *pxInterface, BaseType_t xLinkUp )
+{
+	configASSERT( pxInterface != NULL );
+
+	if( xLinkUp != pdFALSE )
+	{
+		xLinkUp = pdTRUE;
+	}
+
+	if( pxInterface->xLinkUp != xLinkUp )
+	{
+		FreeRTOS_printf( ( "Interface %s: link %s\n", pxInterface->pcName, ( xLinkUp != pdFALSE ) ? "up" : "down" ) );
+		pxInterface->xLinkUp = xLinkUp;
+	}
+}
+/*-----------------------------------------------------------*/
+
+NetworkEndPoint_t *FreeRTOS_FirstEndPoint( void )
+{
+	/* Refresh the copy of the addressing of the primary end-point, which
+	might have been changed by DHCP or by FreeRTOS_SetIPAddress() etc. */
+	xPrimaryEndPoint.ulIPAddress = *ipLOCAL_IP_ADDRESS_POINTER;
+	xPrimaryEndPoint.ulNetMask = xNetworkAddressing.ulNetMask;
+	xPrimaryEndPoint.ulGatewayAddress = xNetworkAddressing.ulGatewayAddress;
+	xPrimaryEndPoint.ulDNSServerAddress = xNetworkAddressing.ulDNSServerAddress;
+	xPrimaryEndPoint.ulBroadcastAddress = xNetworkAddressing.ulBroadcastAddress;
+	memcpy( xPrimaryEndPoint.xMACAddress.ucBytes, ipLOCAL_MAC_ADDRESS, ( size_t ) ipMAC_ADDRESS_LENGTH_BYTES );
+	xPrimaryEndPoint.pxNetworkInterface = pxNetworkInterfaces;
+
+	return &xPrimaryEndPoint;
+}
+/*-----------------------------------------------------------*/
+
+NetworkEndPoint_t *FreeRTOS_NextEndPoint( const NetworkEndPoint_t *pxEndPoint )
+{
+	return pxEndPoint->pxNext;
+}
+/*-----------------------------------------------------------*/
+
+NetworkEndPoint_t *FreeRTOS_FindEndPointOnIP( uint32_t ulIPAddress )
+{
+NetworkEndPoint_t *pxEndPoint;
+
+	for( pxEndPoint = FreeRTOS_FirstEndPoint(); pxEndPoint != NULL; pxEndPoint = pxEndPoint->pxNext )
+	{
+		if( pxEndPoint->ulIPAddress == ulIPAddress )
+		{
+			break;
+		}
+	}
+
+	return pxEndPoint;
+}
+/*-----------------------------------------------------------*/
+
+NetworkEndPoint_t *FreeRTOS_FindEndPointOnNetMask( uint32_t ulIPAddress )
+{
+NetworkEndPoint_t *pxEndPoint;
+
+	for( pxEndPoint = FreeRTOS_FirstEndPoint(); pxEndPoint != NULL; pxEndPoint = pxEndPoint->pxNext )
+	{
+		if( ( pxEndPoint->ulIPAddress != 0UL ) &&
+			( ( ( ulIPAddress ^ pxEndPoint->ulIPAddress ) & pxEndPoint->ulNetMask ) == 0UL ) )
+		{
+			break;
+		}
+	}
+
+	return pxEndPoint;
+}
+/*-----------------------------------------------------------*/
+
+NetworkEndPoint_t *FreeRTOS_FindEndPointOnMAC( const MACAddress_t *pxMACAddress )
+{
+NetworkEndPoint_t *pxEndPoint;
+
+	for( pxEndPoint = FreeRTOS_FirstEndPoint(); pxEndPoint != NULL; pxEndPoint = pxEndPoint->pxNext )
+	{
+		if( memcmp( pxEndPoint->xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( MACAddress_t ) ) == 0 )
+		{
+			break;
+		}
+	}
+
+	return pxEndPoint;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvEndPointIsUsable( const NetworkEndPoint_t *pxEndPoint )
+{
+BaseType_t xReturn = pdFALSE;
+
+	if( ( pxEndPoint->ulIPAddress != 0UL ) &&
+		( pxEndPoint->pxNetworkInterface != NULL ) &&
+		( pxEndPoint->pxNetworkInterface->xLinkUp != pdFALSE ) )
+	{
+		xReturn = pdTRUE;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvNextCandidate( uint32_t ulIPAddress, RouteIterator_t *pxIterator, RouteCandidate_t *pxCandidate )
+{
+NetworkEndPoint_t *pxEndPoint;
+IPRoute_t *pxRoute;
+BaseType_t xFound = pdFALSE;
+
+	/* First the two implicit routes of each end-point: its own subnet, and
+	the default route through its gateway. */
+	while( ( xFound == pdFALSE ) && ( pxIterator->pxEndPoint != NULL ) )
+	{
+		pxEndPoint = pxIterator->pxEndPoint;
+
+		if( prvEndPointIsUsable( pxEndPoint ) == pdFALSE )
+		{
+			pxIterator->pxEndPoint = pxEndPoint->pxNext;
+		}
+		else if( pxIterator->xGatewayDone == pdFALSE )
+		{
+			pxIterator->xGatewayDone = pdTRUE;
+
+			if( ( ( ulIPAddress ^ pxEndPoint->ulIPAddress ) & pxEndPoint->ulNetMask ) == 0UL )
+			{
+				pxCandidate->ulPrefix = FreeRTOS_ntohl( pxEndPoint->ulNetMask );
+				pxCandidate->ulNextHop = ulIPAddress;
+				xFound = pdTRUE;
+			}
+		}
+		else
+		{
+			pxIterator->pxEndPoint = pxEndPoint->pxNext;
+			pxIterator->xGatewayDone = pdFALSE;
+
+			if( pxEndPoint->ulGatewayAddress != 0UL )
+			{
+				pxCandidate->ulPrefix = 0UL;
+				pxCandidate->ulNextHop = pxEndPoint->ulGatewayAddress;
+				xFound = pdTRUE;
+			}
+		}
+
+		if( xFound != pdFALSE )
+		{
+			pxCandidate->pxEndPoint = pxEndPoint;
+			pxCandidate->uxMetric = pxEndPoint->uxMetric;
+		}
+	}
+
+	/* Then the routes that were added explicitly. */
+	while( ( xFound == pdFALSE ) && ( pxIterator->uxRoute < ( UBaseType_t ) ipconfigMAX_ROUTES ) )
+	{
+		pxRoute = &( xRoutes[ pxIterator->uxRoute ] );
+		pxIterator->uxRoute++;
+		pxEndPoint = pxRoute->pxEndPoint;
+
+		if( ( pxEndPoint != NULL ) &&
+			( prvEndPointIsUsable( pxEndPoint ) != pdFALSE ) &&
+			( ( ulIPAddress & pxRoute->ulNetMask ) == pxRoute->ulDestination ) )
+		{
+			pxCandidate->pxEndPoint = pxEndPoint;
+			pxCandidate->ulPrefix = FreeRTOS_ntohl( pxRoute->ulNetMask );
+			pxCandidate->ulNextHop = ( pxRoute->ulGateway != 0UL ) ? pxRoute->ulGateway : ulIPAddress;
+			pxCandidate->uxMetric = pxRoute->uxMetric;
+			xFound = pdTRUE;
+		}
+	}
+
+	return xFound;
+}
+/*-----------------------------------------------------------*/
+
+NetworkEndPoint_t *FreeRTOS_FindRoute( uint32_t ulIPAddress, uint32_t *pulNextHop )
+{
+RouteIterator_t xIterator;
+RouteCandidate_t xCandidate, xBest;
+UBaseType_t uxCount = 0U, uxChoice;
+uint32_t ulHash;
+
+	memset( &xBest, '\0', sizeof( xBest ) );
+
+	/* Find the most specific route with the lowest metric, and count how
+	many routes are equally good. */
+	xIterator.pxEndPoint = FreeRTOS_FirstEndPoint();
+	xIterator.xGatewayDone = pdFALSE;
+	xIterator.uxRoute = 0U;
+
+	while( prvNextCandidate( ulIPAddress, &xIterator, &xCandidate ) != pdFALSE )
+	{
+		if( ( uxCount == 0U ) ||
+			( xCandidate.ulPrefix > xBest.ulPrefix ) ||
+			( ( xCandidate.ulPrefix == xBest.ulPrefix ) && ( xCandidate.uxMetric < xBest.uxMetric ) ) )
+		{
+			xBest = xCandidate;
+			uxCount = 1U;
+		}
+		else if( ( xCandidate.ulPrefix == xBest.ulPrefix ) && ( xCandidate.uxMetric == xBest.uxMetric ) )
+		{
+			uxCount++;
+		}
+		else
+		{
+			/* A less specific or more expensive route. */
+		}
+	}
+
+	if( uxCount > 1U )
+	{
+		/* Spread the destinations over the equivalent routes.  The choice
+		only depends on the destination address, so all packets of a
+		connection take the same route. */
+		ulHash = FreeRTOS_ntohl( ulIPAddress );
+		ulHash ^= ulHash >> 16;
+		ulHash ^= ulHash >> 8;
+		uxChoice = ( UBaseType_t ) ( ulHash % ( uint32_t ) uxCount );
+
+		xIterator.pxEndPoint = FreeRTOS_FirstEndPoint();
+		xIterator.xGatewayDone = pdFALSE;
+		xIterator.uxRoute = 0U;
+
+		while( prvNextCandidate( ulIPAddress, &xIterator, &xCandidate ) != pdFALSE )
+		{
+			if( ( xCandidate.ulPrefix == xBest.ulPrefix ) && ( xCandidate.uxMetric == xBest.uxMetric ) )
+			{
+				if( uxChoice == 0U )
+				{
+					xBest = xCandidate;
+					break;
+				}
+				uxChoice--;
+			}
+		}
+	}
+
+	if( ( uxCount != 0U ) && ( pulNextHop != NULL ) )
+	{
+		*pulNextHop = xBest.ulNextHop;
+	}
+
+	return xBest.pxEndPoint;
+}
+/*-----------------------------------------------------------*/
+
+NetworkEndPoint_t *pxRoutingMatchingEndPoint( NetworkInterface_t *pxInterface, const uint8_t *pucEthernetBuffer )
+{
+NetworkEndPoint_t *pxEndPoint, *pxFirst = NULL, *pxReturn = NULL;
+const EthernetHeader_t *pxEthernetHeader = ( const EthernetHeader_t * ) pucEthernetBuffer;
+uint32_t ulDestination;
+
+	if( pxInterface == NULL )
+	{
+		/* The driver did not say where the frame came from. */
+		pxInterface = pxNetworkInterfaces;
+	}
+
+	if( pxEthernetHeader->usFrameType == ipIPv4_FRAME_TYPE )
+	{
+		ulDestination = ( ( const IPPacket_t * ) pucEthernetBuffer )->xIPHeader.ulDestinationIPAddress;
+	}
+	else if( pxEthernetHeader->usFrameType == ipARP_FRAME_TYPE )
+	{
+		ulDestination = ( ( const ARPPacket_t * ) pucEthernetBuffer )->xARPHeader.ulTargetProtocolAddress;
+	}
+	else
+	{
+		ulDestination = 0UL;
+	}
+
+	for( pxEndPoint = FreeRTOS_FirstEndPoint(); pxEndPoint != NULL; pxEndPoint = pxEndPoint->pxNext )
+	{
+		if( pxEndPoint->pxNetworkInterface == pxInterface )
+		{
+			if( pxFirst == NULL )
+			{
+				pxFirst = pxEndPoint;
+			}
+
+			if( ( pxEndPoint->ulIPAddress == ulDestination ) ||
+				( pxEndPoint->ulBroadcastAddress == ulDestination ) ||
+				/* During DHCP negotiation the end-point has no address yet. */
+				( pxEndPoint->ulIPAddress == 0UL ) )
+			{
+				pxReturn = pxEndPoint;
+				break;
+			}
+		}
+	}
+
+	if( pxReturn == NULL )
+	{
+		if( pxEthernetHeader->usFrameType != ipIPv4_FRAME_TYPE )
+		{
+			/* ARP packets are also inspected when they are not addressed to
+			this node, in order to refresh the ARP cache. */
+			pxReturn = pxFirst;
+		}
+		else if( ( ulDestination == ipBROADCAST_IP_ADDRESS )
+		#if( ipconfigUSE_LLMNR == 1 )
+			|| ( ulDestination == ipLLMNR_IP_ADDR )
+		#endif
+			)
+		{
+			pxReturn = pxFirst;
+		}
+		else
+		{
+			/* The packet is not for this node. */
+		}
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+static NetworkEndPoint_t *prvEndPointForFrame( const NetworkBufferDescriptor_t *pxNetworkBuffer )
+{
+const EthernetHeader_t *pxEthernetHeader = ( const EthernetHeader_t * ) pxNetworkBuffer->pucEthernetBuffer;
+NetworkEndPoint_t *pxEndPoint = NULL;
+uint32_t ulSource;
+
+	if( pxEthernetHeader->usFrameType == ipIPv4_FRAME_TYPE )
+	{
+		ulSource = ( ( const IPPacket_t * ) pxNetworkBuffer->pucEthernetBuffer )->xIPHeader.ulSourceIPAddress;
+		pxEndPoint = FreeRTOS_FindEndPointOnIP( ulSource );
+	}
+	else if( pxEthernetHeader->usFrameType == ipARP_FRAME_TYPE )
+	{
+		/* The field ulSenderProtocolAddress is badly aligned, copy byte-by-byte. */
+		memcpy( ( void * ) &ulSource, ( const void * ) ( ( const ARPPacket_t * ) pxNetworkBuffer->pucEthernetBuffer )->xARPHeader.ucSenderProtocolAddress, sizeof( ulSource ) );
+		pxEndPoint = FreeRTOS_FindEndPointOnIP( ulSource );
+	}
+	else
+	{
+		/* Unknown frame type, use the primary end-point. */
+	}
+
+	if( pxEndPoint == NULL )
+	{
+		pxEndPoint = FreeRTOS_FirstEndPoint();
+	}
+
+	return pxEndPoint;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfaceInitialise( void )
+{
+NetworkInterface_t *pxInterface;
+BaseType_t xReturn = pdFAIL;
+
+	/* At least one interface must be added with FreeRTOS_AddNetworkInterface()
+	before calling FreeRTOS_IPInit(). */
+	configASSERT( pxNetworkInterfaces != NULL );
+
+	for( pxInterface = pxNetworkInterfaces; pxInterface != NULL; pxInterface = pxInterface->pxNext )
+	{
+		if( pxInterface->pfInitialise( pxInterface ) == pdPASS )
+		{
+			pxInterface->xLinkUp = pdTRUE;
+			xReturn = pdPASS;
+		}
+		else
+		{
+			/* The driver must call FreeRTOS_SetInterfaceLinkState() once it
+			becomes available. */
+			pxInterface->xLinkUp = pdFALSE;
+			FreeRTOS_printf( ( "Interface %s: initialisation failed\n", pxInterface->pcName ) );
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfaceOutput( NetworkBufferDescriptor_t * const pxNetworkBuffer, BaseType_t xReleaseAfterSend )
+{
+NetworkEndPoint_t *pxEndPoint = pxNetworkBuffer->pxEndPoint;
+NetworkInterface_t *pxInterface;
+EthernetHeader_t *pxEthernetHeader;
+BaseType_t xReturn = pdFAIL;
+
+	if( pxEndPoint == NULL )
+	{
+		pxEndPoint = prvEndPointForFrame( pxNetworkBuffer );
+	}
+
+	pxInterface = pxEndPoint->pxNetworkInterface;
+
+	if( ( pxInterface != NULL ) && ( pxInterface->xLinkUp != pdFALSE ) )
+	{
+		/* Frames are sent with the MAC address of the end-point that sends
+		them. */
+		pxEthernetHeader = ( EthernetHeader_t * ) pxNetworkBuffer->pucEthernetBuffer;
+		memcpy( pxEthernetHeader->xSourceAddress.ucBytes, pxEndPoint->xMACAddress.ucBytes, ( size_t ) ipMAC_ADDRESS_LENGTH_BYTES );
+		pxNetworkBuffer->pxInterface = pxInterface;
+
+		#if( ipconfigUSE_PCAP_CAPTURE != 0 )
+		{
+			vCaptureFrame( pxNetworkBuffer, pdTRUE );
+		}
+		#endif
+
+		xReturn = pxInterface->pfOutput( pxInterface, pxNetworkBuffer, xReleaseAfterSend );
+	}
+	else if( xReleaseAfterSend != pdFALSE )
+	{
+		/* The interface is down, drop the packet. */
+		vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+	}
+	else
+	{
+		/* The buffer belongs to the caller. */
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_MULTI_INTERFACE != 0 */
@@ -68,6 +68,11 @@ range 1024-65535" excluding those already in use (inbound or outbound). */
 /* The number of octets that make up an IP address. */
 #define socketMAX_IP_ADDRESS_OCTETS		4u
 
+/* The number of 16-bit groups in an IPv6 address, and the length of its
+longest text form, including the terminating zero. */
+#define socketIPv6_ADDRESS_GROUPS		8
+#define socketIPv6_ADDRESS_TEXT_LENGTH	40u
+
 /* A block time of 0 simply means "don't block". */
 #define socketDONT_BLOCK				( ( TickType_t ) 0 )
 
@@ -94,6 +99,18 @@ respectively. */
 #define sock80_PERCENT						80
 #define sock100_PERCENT						100
 
+#if( ( ipconfigUDP_HASH_TABLE_SIZE & ( ipconfigUDP_HASH_TABLE_SIZE - 1 ) ) != 0 )
+	#error ipconfigUDP_HASH_TABLE_SIZE must be a power of 2
+#endif
+
+/* The bucket of xUDPPortTable[] for a port number in network byte order. */
+#define socketUDP_PORT_BUCKET( xPort )	( &( xUDPPortTable[ ( ( xPort ) ^ ( ( xPort ) >> 8 ) ) & ( ( TickType_t ) ipconfigUDP_HASH_TABLE_SIZE - 1 ) ] ) )
+
+#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_HASH_TABLE_SIZE > 0 ) )
+	#if( ( ipconfigTCP_HASH_TABLE_SIZE & ( ipconfigTCP_HASH_TABLE_SIZE - 1 ) ) != 0 )
+		#error ipconfigTCP_HASH_TABLE_SIZE must be a power of 2
+	#endif
+#endif
 
 /*-----------------------------------------------------------*/
 
@@ -110,6 +127,12 @@ static uint16_t prvGetPrivatePortNumber( BaseType_t xProtocol );
  */
 static const ListItem_t * pxListFindListItemWithValue( const List_t *pxList, TickType_t xWantedItemValue );
 
+/*
+ * Return the list item of the UDP socket that is bound to port xPort, in
+ * network byte order.  If there is no such socket return NULL.
+ */
+static const ListItem_t * pxUDPPortFind( TickType_t xPort );
+
 /*
  * Return pdTRUE only if pxSocket is valid and bound, as far as can be
  * determined.
@@ -122,6 +145,49 @@ static BaseType_t prvValidSocket( FreeRTOS_Socket_t *pxSocket, BaseType_t xProto
  */
 static BaseType_t prvDetermineSocketSize( BaseType_t xDomain, BaseType_t xType, BaseType_t xProtocol, size_t *pxSocketSize );
 
+/*
+ * Called from FreeRTOS_recvfrom(): wait until the socket has received a
+ * packet, as long as its reception time-out and xFlags allow.  Returns the
+ * number of packets waiting, and the event bits that ended the wait in
+ * *pxEventBits.
+ */
+static BaseType_t prvRecvFromWaitForPacket( FreeRTOS_Socket_t *pxSocket, BaseType_t xFlags, EventBits_t *pxEventBits );
+
+/*
+ * Called from FreeRTOS_recvfrom(): pass a packet that was taken from the
+ * socket to the caller.  Returns the number of bytes copied.
+ */
+static int32_t prvRecvFromCopyPacket( NetworkBufferDescriptor_t *pxNetworkBuffer, void *pvBuffer, size_t xBufferLength, BaseType_t xFlags,
+	struct freertos_sockaddr *pxSourceAddress, socklen_t *pxSourceAddressLength );
+
+/*
+ * Called from FreeRTOS_sendto(): the time that the caller may block.
+ */
+static TickType_t prvSendToBlockTime( const FreeRTOS_Socket_t *pxSocket, BaseType_t xFlags );
+
+/*
+ * Called from FreeRTOS_sendto(): the longest payload that can be sent to a
+ * destination, which is shorter for IPv6.
+ */
+static size_t prvSendToMaxPayload( const struct freertos_sockaddr *pxDestinationAddress, socklen_t xDestinationAddressLength );
+
+/*
+ * Called from FreeRTOS_sendto(): get a network buffer that holds the payload
+ * and the destination of a packet, or NULL when no buffer is available.  The
+ * caller checks the length of the payload first.
+ */
+static NetworkBufferDescriptor_t *prvSendToGetBuffer( const FreeRTOS_Socket_t *pxSocket, const void *pvBuffer, size_t xTotalDataLength, BaseType_t xFlags,
+	const struct freertos_sockaddr *pxDestinationAddress, socklen_t xDestinationAddressLength, TickType_t xTicksToWait );
+
+#if( ipconfigUSE_IPv6 != 0 )
+	/*
+	 * Returns pdTRUE when an address is a struct freertos_sockaddr6.  Many
+	 * callers leave 'sin_family' of a struct freertos_sockaddr uninitialised,
+	 * so the length of the address must confirm it.
+	 */
+	static BaseType_t prvAddressIsIPv6( const struct freertos_sockaddr *pxAddress, socklen_t xAddressLength );
+#endif /* ipconfigUSE_IPv6 */
+
 #if( ipconfigUSE_TCP == 1 )
 	/*
 	 * Create a txStream or a rxStream, depending on the parameter 'xIsInputStream'
@@ -149,25 +215,64 @@ static BaseType_t prvDetermineSocketSize( BaseType_t xDomain, BaseType_t xType,
 	 * Called from FreeRTOS_connect(): make some checks and if allowed, send a
 	 * message to the IP-task to start connecting to a remote socket
 	 */
-	static BaseType_t prvTCPConnectStart( FreeRTOS_Socket_t *pxSocket, struct freertos_sockaddr *pxAddress );
+	static BaseType_t prvTCPConnectStart( FreeRTOS_Socket_t *pxSocket, struct freertos_sockaddr *pxAddress, socklen_t xAddressLength );
+#endif /* ipconfigUSE_TCP */
+
+#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_HASH_TABLE_SIZE > 0 ) )
+	/*
+	 * Returns the index in xTCPConnectionTable[] or xTCPListenTable[] of a
+	 * socket with the given port numbers and remote IP address.  Listening
+	 * sockets are hashed with a remote IP address and port of zero.
+	 */
+	static UBaseType_t prvTCPHash( UBaseType_t uxLocalPort, uint32_t ulRemoteIP, UBaseType_t uxRemotePort );
+#endif /* ipconfigTCP_HASH_TABLE_SIZE */
+
+#if( ipconfigUSE_TCP == 1 )
+	/*
+	 * Find a TCP socket by walking through all bound sockets.
+	 */
+	static FreeRTOS_Socket_t *prvTCPSocketLookupList( UBaseType_t uxLocalPort, uint32_t ulRemoteIP, UBaseType_t uxRemotePort );
 #endif /* ipconfigUSE_TCP */
 
 #if( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
 
 	/* Executed by the IP-task, it will check all sockets belonging to a set */
 	static FreeRTOS_Socket_t *prvFindSelectedSocket( SocketSelect_t *pxSocketSet );
+#endif
 
-#endif /* ipconfigSUPPORT_SELECT_FUNCTION == 1 */
+#if( ipconfigSUPPORT_SELECT_READY_LIST == 1 )
+	/*
+	 * Take a socket out of the ready list of its socket set, e.g. because it
+	 * leaves the set or because it is closed.
+	 */
+	static void prvSocketSelectUnready( FreeRTOS_Socket_t *pxSocket );
+#endif /* ipconfigSUPPORT_SELECT_READY_LIST */
 /*-----------------------------------------------------------*/
 
 /* The list that contains mappings between sockets and port numbers.  Accesses
 to this list must be protected by critical sections of one kind or another. */
 List_t xBoundUDPSocketsList;
 
+#if( ipconfigUDP_HASH_TABLE_SIZE > 0 )
+	/* Every bound UDP socket is also in this table, hashed on its port number,
+	so a port can be looked up without walking through xBoundUDPSocketsList.
+	The table is protected in the same way as xBoundUDPSocketsList. */
+	static List_t xUDPPortTable[ ipconfigUDP_HASH_TABLE_SIZE ];
+#endif /* ipconfigUDP_HASH_TABLE_SIZE */
+
 #if ipconfigUSE_TCP == 1
 	List_t xBoundTCPSocketsList;
 #endif /* ipconfigUSE_TCP == 1 */
 
+#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_HASH_TABLE_SIZE > 0 ) )
+	/* Every bound TCP socket is also in one of the following tables, depending
+	on its state.  Listening sockets are hashed on their local port, connected
+	sockets on their local port and their remote IP address and port.  The
+	tables are only accessed by the IP-task. */
+	static List_t xTCPListenTable[ ipconfigTCP_HASH_TABLE_SIZE ];
+	static List_t xTCPConnectionTable[ ipconfigTCP_HASH_TABLE_SIZE ];
+#endif /* ipconfigTCP_HASH_TABLE_SIZE */
+
 /*-----------------------------------------------------------*/
 
 static BaseType_t prvValidSocket( FreeRTOS_Socket_t *pxSocket, BaseType_t xProtocol, BaseType_t xIsBound )
@@ -197,9 +302,32 @@ BaseType_t vNetworkSocketsInit( void )
 {
 	vListInitialise( &xBoundUDPSocketsList );
 
+	#if( ipconfigUDP_HASH_TABLE_SIZE > 0 )
+	{
+	UBaseType_t uxIndex;
+
+		for( uxIndex = 0U; uxIndex < ( UBaseType_t ) ipconfigUDP_HASH_TABLE_SIZE; uxIndex++ )
+		{
+			vListInitialise( &( xUDPPortTable[ uxIndex ] ) );
+		}
+	}
+	#endif /* ipconfigUDP_HASH_TABLE_SIZE */
+
 	#if( ipconfigUSE_TCP == 1 )
 	{
 		vListInitialise( &xBoundTCPSocketsList );
+
+		#if( ipconfigTCP_HASH_TABLE_SIZE > 0 )
+		{
+		UBaseType_t uxIndex;
+
+			for( uxIndex = 0U; uxIndex < ( UBaseType_t ) ipconfigTCP_HASH_TABLE_SIZE; uxIndex++ )
+			{
+				vListInitialise( &( xTCPListenTable[ uxIndex ] ) );
+				vListInitialise( &( xTCPConnectionTable[ uxIndex ] ) );
+			}
+		}
+		#endif /* ipconfigTCP_HASH_TABLE_SIZE */
 	}
 	#endif  /* ipconfigUSE_TCP == 1 */
 
@@ -311,6 +439,13 @@ Socket_t xReturn;
 			{
 				vListInitialise( &( pxSocket->u.xUDP.xWaitingPacketsList ) );
 
+				#if( ipconfigUDP_HASH_TABLE_SIZE > 0 )
+				{
+					vListInitialiseItem( &( pxSocket->u.xUDP.xHashListItem ) );
+					listSET_LIST_ITEM_OWNER( &( pxSocket->u.xUDP.xHashListItem ), ( void * ) pxSocket );
+				}
+				#endif /* ipconfigUDP_HASH_TABLE_SIZE */
+
 				#if( ipconfigUDP_MAX_RX_PACKETS > 0 )
 				{
 					pxSocket->u.xUDP.uxMaxPackets = ( UBaseType_t ) ipconfigUDP_MAX_RX_PACKETS;
@@ -321,6 +456,13 @@ Socket_t xReturn;
 			vListInitialiseItem( &( pxSocket->xBoundSocketListItem ) );
 			listSET_LIST_ITEM_OWNER( &( pxSocket->xBoundSocketListItem ), ( void * ) pxSocket );
 
+			#if( ipconfigSUPPORT_SELECT_READY_LIST == 1 )
+			{
+				vListInitialiseItem( &( pxSocket->xReadyListItem ) );
+				listSET_LIST_ITEM_OWNER( &( pxSocket->xReadyListItem ), ( void * ) pxSocket );
+			}
+			#endif /* ipconfigSUPPORT_SELECT_READY_LIST */
+
 			pxSocket->xReceiveBlockTime = ipconfigSOCK_DEFAULT_RECEIVE_BLOCK_TIME;
 			pxSocket->xSendBlockTime	= ipconfigSOCK_DEFAULT_SEND_BLOCK_TIME;
 			pxSocket->ucSocketOptions   = ( uint8_t ) FREERTOS_SO_UDPCKSUM_OUT;
@@ -350,6 +492,19 @@ Socket_t xReturn;
 					/* The above values are just defaults, and can be overridden by
 					calling FreeRTOS_setsockopt().  No buffers will be allocated until a
 					socket is connected and data is exchanged. */
+
+					#if( ipconfigTCP_HASH_TABLE_SIZE > 0 )
+					{
+						vListInitialiseItem( &( pxSocket->u.xTCP.xHashListItem ) );
+						listSET_LIST_ITEM_OWNER( &( pxSocket->u.xTCP.xHashListItem ), ( void * ) pxSocket );
+					}
+					#endif /* ipconfigTCP_HASH_TABLE_SIZE */
+
+					#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+					{
+						vListInitialise( &( pxSocket->u.xTCP.xTxBufferList ) );
+					}
+					#endif
 				}
 			}
 			#endif  /* ipconfigUSE_TCP == 1 */
@@ -383,6 +538,12 @@ Socket_t xReturn;
 				vPortFree( ( void* ) pxSocketSet );
 				pxSocketSet = NULL;
 			}
+			#if( ipconfigSUPPORT_SELECT_READY_LIST == 1 )
+			else
+			{
+				vListInitialise( &( pxSocketSet->xReadyList ) );
+			}
+			#endif /* ipconfigSUPPORT_SELECT_READY_LIST */
 		}
 
 		return ( SocketSet_t * ) pxSocketSet;
@@ -397,6 +558,24 @@ Socket_t xReturn;
 	{
 		SocketSelect_t *pxSocketSet = ( SocketSelect_t*) xSocketSet;
 
+		#if( ipconfigSUPPORT_SELECT_READY_LIST == 1 )
+		{
+			/* Sockets that are still waiting in the ready list must not point
+			to the list after it has been freed. */
+			taskENTER_CRITICAL();
+			{
+				while( listLIST_IS_EMPTY( &( pxSocketSet->xReadyList ) ) == pdFALSE )
+				{
+					FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) listGET_OWNER_OF_HEAD_ENTRY( &( pxSocketSet->xReadyList ) );
+
+					( void ) uxListRemove( &( pxSocket->xReadyListItem ) );
+					pxSocket->xReadyBits = 0;
+				}
+			}
+			taskEXIT_CRITICAL();
+		}
+		#endif /* ipconfigSUPPORT_SELECT_READY_LIST */
+
 		vEventGroupDelete( pxSocketSet->xSelectGroup );
 		vPortFree( ( void* ) pxSocketSet );
 	}
@@ -421,6 +600,17 @@ Socket_t xReturn;
 
 		if( ( pxSocket->xSelectBits & eSELECT_ALL ) != 0 )
 		{
+			#if( ipconfigSUPPORT_SELECT_READY_LIST == 1 )
+			{
+				if( pxSocket->pxSocketSet != pxSocketSet )
+				{
+					/* The socket moves to another set, its pending events
+					belong to the old set. */
+					prvSocketSelectUnready( pxSocket );
+				}
+			}
+			#endif /* ipconfigSUPPORT_SELECT_READY_LIST */
+
 			/* Adding a socket to a socket set. */
 			pxSocket->pxSocketSet = ( SocketSelect_t * ) xSocketSet;
 
@@ -453,6 +643,12 @@ Socket_t xReturn;
 		}
 		else
 		{
+			#if( ipconfigSUPPORT_SELECT_READY_LIST == 1 )
+			{
+				prvSocketSelectUnready( pxSocket );
+			}
+			#endif /* ipconfigSUPPORT_SELECT_READY_LIST */
+
 			/* disconnect it from the socket set */
 			pxSocket->pxSocketSet = ( SocketSelect_t *)NULL;
 		}
@@ -550,6 +746,106 @@ Socket_t xReturn;
 #endif /* ipconfigSUPPORT_SELECT_FUNCTION */
 /*-----------------------------------------------------------*/
 
+#if( ipconfigSUPPORT_SELECT_READY_LIST == 1 )
+
+	/* Like select(), but return the sockets which had an event, so that the
+	caller does not have to test every socket with FreeRTOS_FD_ISSET(). */
+	BaseType_t FreeRTOS_select_ready( SocketSet_t xSocketSet, SocketSelectEvent_t *pxEvents, BaseType_t xMaxEvents, TickType_t xBlockTimeTicks )
+	{
+	TimeOut_t xTimeOut;
+	TickType_t xRemainingTime;
+	SocketSelect_t *pxSocketSet = ( SocketSelect_t * ) xSocketSet;
+	FreeRTOS_Socket_t *pxSocket;
+	EventBits_t xBits;
+	BaseType_t xCount = 0;
+
+		configASSERT( xSocketSet != NULL );
+		configASSERT( pxEvents != NULL );
+		configASSERT( xMaxEvents > 0 );
+
+		/* Only in the first round, check for non-blocking */
+		xRemainingTime = xBlockTimeTicks;
+
+		/* Fetch the current time */
+		vTaskSetTimeOutState( &xTimeOut );
+
+		for( ;; )
+		{
+			/* Clear the wake-up bit before looking at the list.  The IP-task
+			sets it again when it adds a socket after this point. */
+			xEventGroupClearBits( pxSocketSet->xSelectGroup, eSELECT_READY_LIST );
+
+			/* The IP-task adds sockets to the list, so take them out within a
+			critical section. */
+			taskENTER_CRITICAL();
+			{
+				while( ( xCount < xMaxEvents ) && ( listLIST_IS_EMPTY( &( pxSocketSet->xReadyList ) ) == pdFALSE ) )
+				{
+					pxSocket = ( FreeRTOS_Socket_t * ) listGET_OWNER_OF_HEAD_ENTRY( &( pxSocketSet->xReadyList ) );
+					( void ) uxListRemove( &( pxSocket->xReadyListItem ) );
+
+					pxEvents[ xCount ].xSocket = ( Socket_t ) pxSocket;
+					pxEvents[ xCount ].xEvents = pxSocket->xReadyBits & eSELECT_ALL;
+					pxSocket->xReadyBits = 0;
+					xCount++;
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			if( xCount > 0 )
+			{
+				break;
+			}
+
+			xBits = xEventGroupWaitBits( pxSocketSet->xSelectGroup, eSELECT_READY_LIST | eSELECT_INTR, pdFALSE, pdFALSE, xRemainingTime );
+
+			#if( ipconfigSUPPORT_SIGNALS != 0 )
+			{
+				if( ( xBits & eSELECT_INTR ) != 0u )
+				{
+					xEventGroupClearBits( pxSocketSet->xSelectGroup, eSELECT_INTR );
+					FreeRTOS_debug_printf( ( "FreeRTOS_select_ready: interrupted\n" ) );
+					xCount = -pdFREERTOS_ERRNO_EINTR;
+					break;
+				}
+			}
+			#endif /* ipconfigSUPPORT_SIGNALS */
+
+			/* When a socket was added, it will be taken in the next round,
+			even if the time-out was reached meanwhile. */
+			if( ( xBits & eSELECT_READY_LIST ) == 0u )
+			{
+				if( xTaskCheckForTimeOut( &xTimeOut, &xRemainingTime ) != pdFALSE )
+				{
+					break;
+				}
+			}
+		}
+
+		return xCount;
+	}
+
+#endif /* ipconfigSUPPORT_SELECT_READY_LIST */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigSUPPORT_SELECT_READY_LIST == 1 )
+
+	static void prvSocketSelectUnready( FreeRTOS_Socket_t *pxSocket )
+	{
+		taskENTER_CRITICAL();
+		{
+			if( listLIST_ITEM_CONTAINER( &( pxSocket->xReadyListItem ) ) != NULL )
+			{
+				( void ) uxListRemove( &( pxSocket->xReadyListItem ) );
+			}
+			pxSocket->xReadyBits = 0;
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif /* ipconfigSUPPORT_SELECT_READY_LIST */
+/*-----------------------------------------------------------*/
+
 #if( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
 
 	/* Send a message to the IP-task to have it check all sockets belonging to
@@ -589,33 +885,16 @@ Socket_t xReturn;
 #endif /* ipconfigSUPPORT_SELECT_FUNCTION == 1 */
 /*-----------------------------------------------------------*/
 
-/*
- * FreeRTOS_recvfrom: receive data from a bound socket
- * In this library, the function can only be used with connectionsless sockets
- * (UDP)
- */
-int32_t FreeRTOS_recvfrom( Socket_t xSocket, void *pvBuffer, size_t xBufferLength, BaseType_t xFlags, struct freertos_sockaddr *pxSourceAddress, socklen_t *pxSourceAddressLength )
+static BaseType_t prvRecvFromWaitForPacket( FreeRTOS_Socket_t *pxSocket, BaseType_t xFlags, EventBits_t *pxEventBits )
 {
-BaseType_t lPacketCount = 0;
-NetworkBufferDescriptor_t *pxNetworkBuffer;
-FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+BaseType_t lPacketCount;
 TickType_t xRemainingTime = ( TickType_t ) 0; /* Obsolete assignment, but some compilers output a warning if its not done. */
 BaseType_t xTimed = pdFALSE;
 TimeOut_t xTimeOut;
-int32_t lReturn;
 EventBits_t xEventBits = ( EventBits_t ) 0;
 
-	if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_UDP, pdTRUE ) == pdFALSE )
-	{
-		return -pdFREERTOS_ERRNO_EINVAL;
-	}
-
 	lPacketCount = ( BaseType_t ) listCURRENT_LIST_LENGTH( &( pxSocket->u.xUDP.xWaitingPacketsList ) );
 
-	/* The function prototype is designed to maintain the expected Berkeley
-	sockets standard, but this implementation does not use all the parameters. */
-	( void ) pxSourceAddressLength;
-
 	while( lPacketCount == 0 )
 	{
 		if( xTimed == pdFALSE )
@@ -666,10 +945,6 @@ EventBits_t xEventBits = ( EventBits_t ) 0;
 				break;
 			}
 		}
-		#else
-		{
-			( void ) xEventBits;
-		}
 		#endif /* ipconfigSUPPORT_SIGNALS */
 
 		lPacketCount = ( BaseType_t ) listCURRENT_LIST_LENGTH( &( pxSocket->u.xUDP.xWaitingPacketsList ) );
@@ -686,6 +961,108 @@ EventBits_t xEventBits = ( EventBits_t ) 0;
 		}
 	} /* while( lPacketCount == 0 ) */
 
+	*pxEventBits = xEventBits;
+
+	return lPacketCount;
+}
+/*-----------------------------------------------------------*/
+
+static int32_t prvRecvFromCopyPacket( NetworkBufferDescriptor_t *pxNetworkBuffer, void *pvBuffer, size_t xBufferLength, BaseType_t xFlags,
+	struct freertos_sockaddr *pxSourceAddress, socklen_t *pxSourceAddressLength )
+{
+int32_t lReturn;
+
+	#if( ipconfigUSE_IPv6 == 0 )
+	{
+		/* The function prototype is designed to maintain the expected
+		Berkeley sockets standard, but this implementation does not use all
+		the parameters. */
+		( void ) pxSourceAddressLength;
+	}
+	#endif
+
+	/* The returned value is the data length, which may have been capped to
+	the receive buffer size. */
+	lReturn = ( int32_t ) pxNetworkBuffer->xDataLength;
+
+	if( pxSourceAddress != NULL )
+	{
+		#if( ipconfigUSE_IPv6 != 0 )
+		if( ( pxNetworkBuffer->xUsesIPv6 != pdFALSE ) &&
+			( pxSourceAddressLength != NULL ) &&
+			( *pxSourceAddressLength >= ( socklen_t ) sizeof( struct freertos_sockaddr6 ) ) )
+		{
+		struct freertos_sockaddr6 *pxSourceAddress6 = ( struct freertos_sockaddr6 * ) pxSourceAddress;
+
+			/* The caller has room for the address of an IPv6 peer. */
+			pxSourceAddress6->sin6_len = ( uint8_t ) sizeof( struct freertos_sockaddr6 );
+			pxSourceAddress6->sin6_family = FREERTOS_AF_INET6;
+			pxSourceAddress6->sin6_port = pxNetworkBuffer->usPort;
+			pxSourceAddress6->sin6_flowinfo = 0UL;
+			memcpy( pxSourceAddress6->sin6_addr.ucBytes, pxNetworkBuffer->xIPv6Address.ucBytes, sizeof( pxSourceAddress6->sin6_addr.ucBytes ) );
+			*pxSourceAddressLength = ( socklen_t ) sizeof( struct freertos_sockaddr6 );
+		}
+		else
+		#endif /* ipconfigUSE_IPv6 */
+		{
+			/* The IPv4 address is zero for a packet from an IPv6 peer. */
+			pxSourceAddress->sin_port = pxNetworkBuffer->usPort;
+			pxSourceAddress->sin_addr = pxNetworkBuffer->ulIPAddress;
+		}
+	}
+
+	if( ( xFlags & FREERTOS_ZERO_COPY ) == 0 )
+	{
+		/* The zero copy flag is not set.  Truncate the length if it won't
+		fit in the provided buffer. */
+		if( lReturn > ( int32_t ) xBufferLength )
+		{
+			iptraceRECVFROM_DISCARDING_BYTES( ( xBufferLength - lReturn ) );
+			lReturn = ( int32_t )xBufferLength;
+		}
+
+		/* Copy the received data into the provided buffer, then release the
+		network buffer. */
+		memcpy( pvBuffer, ( void * ) &( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] ), ( size_t )lReturn );
+
+		if( ( xFlags & FREERTOS_MSG_PEEK ) == 0 )
+		{
+			vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+		}
+	}
+	else
+	{
+		/* The zero copy flag was set.  pvBuffer is not a buffer into which
+		the received data can be copied, but a pointer that must be set to
+		point to the buffer in which the received data has already been
+		placed. */
+		*( ( void** ) pvBuffer ) = ( void * ) ( &( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] ) );
+	}
+
+	return lReturn;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * FreeRTOS_recvfrom: receive data from a bound socket
+ * In this library, the function can only be used with connectionsless sockets
+ * (UDP)
+ */
+int32_t FreeRTOS_recvfrom( Socket_t xSocket, void *pvBuffer, size_t xBufferLength, BaseType_t xFlags, struct freertos_sockaddr *pxSourceAddress, socklen_t *pxSourceAddressLength )
+{
+BaseType_t lPacketCount;
+NetworkBufferDescriptor_t *pxNetworkBuffer;
+FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+int32_t lReturn;
+EventBits_t xEventBits = ( EventBits_t ) 0;
+
+	if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_UDP, pdTRUE ) == pdFALSE )
+	{
+		return -pdFREERTOS_ERRNO_EINVAL;
+	}
+
+	lPacketCount = prvRecvFromWaitForPacket( pxSocket, xFlags, &xEventBits );
+
 	if( lPacketCount != 0 )
 	{
 		taskENTER_CRITICAL();
@@ -702,59 +1079,289 @@ EventBits_t xEventBits = ( EventBits_t ) 0;
 		}
 		taskEXIT_CRITICAL();
 
-		/* The returned value is the data length, which may have been capped to
-		the receive buffer size. */
-		lReturn = ( int32_t ) pxNetworkBuffer->xDataLength;
+		lReturn = prvRecvFromCopyPacket( pxNetworkBuffer, pvBuffer, xBufferLength, xFlags, pxSourceAddress, pxSourceAddressLength );
+	}
+#if( ipconfigSUPPORT_SIGNALS != 0 )
+	else if( ( xEventBits & eSOCKET_INTR ) != 0 )
+	{
+		lReturn = -pdFREERTOS_ERRNO_EINTR;
+		iptraceRECVFROM_INTERRUPTED();
+	}
+#endif /* ipconfigSUPPORT_SIGNALS */
+	else
+	{
+		( void ) xEventBits;
+		lReturn = -pdFREERTOS_ERRNO_EWOULDBLOCK;
+		iptraceRECVFROM_TIMEOUT();
+	}
+
+	return lReturn;
+}
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_UDP_BATCH != 0 )
+
+	/*
+	 * FreeRTOS_recvmmsg: receive up to xMessageCount datagrams from a bound UDP
+	 * socket.  The call blocks, like FreeRTOS_recvfrom(), until the first
+	 * datagram has arrived.  All datagrams that are waiting, up to
+	 * xMessageCount, are then taken from the socket in a single critical
+	 * section.  Each message gets its data, its source address and, in
+	 * 'lResult', its length, as FreeRTOS_recvfrom() would give them.  With
+	 * FREERTOS_ZERO_COPY, 'pvBuffer' of each message is set to point to the
+	 * data, which must be released with FreeRTOS_ReleaseUDPPayloadBuffer().
+	 * Returns the number of messages that were filled in, or a negative errno.
+	 * FREERTOS_MSG_PEEK is not supported.
+	 */
+	BaseType_t FreeRTOS_recvmmsg( Socket_t xSocket, UDPMessage_t *pxMessages, BaseType_t xMessageCount, BaseType_t xFlags )
+	{
+	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+	NetworkBufferDescriptor_t *pxFirstBuffer = NULL, *pxLastBuffer = NULL, *pxNetworkBuffer;
+	EventBits_t xEventBits = ( EventBits_t ) 0;
+	BaseType_t xCount = 0;
+	UDPMessage_t *pxMessage;
 
-		if( pxSourceAddress != NULL )
+		if( ( prvValidSocket( pxSocket, FREERTOS_IPPROTO_UDP, pdTRUE ) == pdFALSE ) ||
+			( xMessageCount <= 0 ) ||
+			( ( xFlags & FREERTOS_MSG_PEEK ) != 0 ) )
 		{
-			pxSourceAddress->sin_port = pxNetworkBuffer->usPort;
-			pxSourceAddress->sin_addr = pxNetworkBuffer->ulIPAddress;
+			return -pdFREERTOS_ERRNO_EINVAL;
 		}
 
-		if( ( xFlags & FREERTOS_ZERO_COPY ) == 0 )
+		if( prvRecvFromWaitForPacket( pxSocket, xFlags, &xEventBits ) != 0 )
 		{
-			/* The zero copy flag is not set.  Truncate the length if it won't
-			fit in the provided buffer. */
-			if( lReturn > ( int32_t ) xBufferLength )
+			taskENTER_CRITICAL();
 			{
-				iptraceRECVFROM_DISCARDING_BYTES( ( xBufferLength - lReturn ) );
-				lReturn = ( int32_t )xBufferLength;
-			}
+				/* Take the datagrams from the socket, linked in the order in
+				which they were received. */
+				while( ( xCount < xMessageCount ) && ( listCURRENT_LIST_LENGTH( &( pxSocket->u.xUDP.xWaitingPacketsList ) ) != 0U ) )
+				{
+					pxNetworkBuffer = ( NetworkBufferDescriptor_t * ) listGET_OWNER_OF_HEAD_ENTRY( &( pxSocket->u.xUDP.xWaitingPacketsList ) );
+					uxListRemove( &( pxNetworkBuffer->xBufferListItem ) );
+					pxNetworkBuffer->pxNextBuffer = NULL;
 
-			/* Copy the received data into the provided buffer, then release the
-			network buffer. */
-			memcpy( pvBuffer, ( void * ) &( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] ), ( size_t )lReturn );
+					if( pxLastBuffer == NULL )
+					{
+						pxFirstBuffer = pxNetworkBuffer;
+					}
+					else
+					{
+						pxLastBuffer->pxNextBuffer = pxNetworkBuffer;
+					}
 
-			if( ( xFlags & FREERTOS_MSG_PEEK ) == 0 )
+					pxLastBuffer = pxNetworkBuffer;
+					xCount++;
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			/* Copy the data outside the critical section. */
+			for( pxMessage = pxMessages; pxFirstBuffer != NULL; pxMessage++ )
 			{
-				vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+				pxNetworkBuffer = pxFirstBuffer;
+				pxFirstBuffer = pxNetworkBuffer->pxNextBuffer;
+				pxNetworkBuffer->pxNextBuffer = NULL;
+
+				if( ( xFlags & FREERTOS_ZERO_COPY ) == 0 )
+				{
+					pxMessage->lResult = prvRecvFromCopyPacket( pxNetworkBuffer, pxMessage->pvBuffer, pxMessage->uxLength, xFlags,
+						pxMessage->pxAddress, &( pxMessage->xAddressLength ) );
+				}
+				else
+				{
+					pxMessage->lResult = prvRecvFromCopyPacket( pxNetworkBuffer, &( pxMessage->pvBuffer ), pxMessage->uxLength, xFlags,
+						pxMessage->pxAddress, &( pxMessage->xAddressLength ) );
+				}
 			}
 		}
+	#if( ipconfigSUPPORT_SIGNALS != 0 )
+		else if( ( xEventBits & eSOCKET_INTR ) != 0 )
+		{
+			xCount = -pdFREERTOS_ERRNO_EINTR;
+			iptraceRECVFROM_INTERRUPTED();
+		}
+	#endif /* ipconfigSUPPORT_SIGNALS */
 		else
 		{
-			/* The zero copy flag was set.  pvBuffer is not a buffer into which
-			the received data can be copied, but a pointer that must be set to
-			point to the buffer in which the received data has already been
-			placed. */
-			*( ( void** ) pvBuffer ) = ( void * ) ( &( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] ) );
+			( void ) xEventBits;
+			xCount = -pdFREERTOS_ERRNO_EWOULDBLOCK;
+			iptraceRECVFROM_TIMEOUT();
 		}
 
+		return xCount;
 	}
-#if( ipconfigSUPPORT_SIGNALS != 0 )
-	else if( ( xEventBits & eSOCKET_INTR ) != 0 )
+
+#endif /* ipconfigUSE_UDP_BATCH */
+/*-----------------------------------------------------------*/
+
+static TickType_t prvSendToBlockTime( const FreeRTOS_Socket_t *pxSocket, BaseType_t xFlags )
+{
+TickType_t xTicksToWait = pxSocket->xSendBlockTime;
+
+	#if( ipconfigUSE_CALLBACKS != 0 )
 	{
-		lReturn = -pdFREERTOS_ERRNO_EINTR;
-		iptraceRECVFROM_INTERRUPTED();
+		if( xIsCallingFromIPTask() != pdFALSE )
+		{
+			/* If this send function is called from within a call-back
+			handler it may not block, otherwise chances would be big to
+			get a deadlock: the IP-task waiting for itself. */
+			xTicksToWait = ( TickType_t )0;
+		}
+	}
+	#endif /* ipconfigUSE_CALLBACKS */
+
+	if( ( xFlags & FREERTOS_MSG_DONTWAIT ) != 0 )
+	{
+		xTicksToWait = ( TickType_t ) 0;
+	}
+
+	return xTicksToWait;
+}
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_IPv6 != 0 )
+
+	static BaseType_t prvAddressIsIPv6( const struct freertos_sockaddr *pxAddress, socklen_t xAddressLength )
+	{
+	BaseType_t xReturn = pdFALSE;
+
+		if( ( pxAddress->sin_family == ( uint8_t ) FREERTOS_AF_INET6 ) &&
+			( ( size_t ) xAddressLength >= sizeof( struct freertos_sockaddr6 ) ) )
+		{
+			xReturn = pdTRUE;
+		}
+
+		return xReturn;
+	}
+
+#endif /* ipconfigUSE_IPv6 */
+/*-----------------------------------------------------------*/
+
+static size_t prvSendToMaxPayload( const struct freertos_sockaddr *pxDestinationAddress, socklen_t xDestinationAddressLength )
+{
+size_t uxMaxPayloadLength = ( size_t ) ipMAX_UDP_PAYLOAD_LENGTH;
+
+	#if( ipconfigUSE_IPv6 != 0 )
+	{
+		if( prvAddressIsIPv6( pxDestinationAddress, xDestinationAddressLength ) != pdFALSE )
+		{
+			/* The IPv6 header is longer than the IPv4 header. */
+			uxMaxPayloadLength = ( size_t ) ipMAX_UDP_PAYLOAD_LENGTH_IPv6;
+		}
+	}
+	#else
+	{
+		( void ) pxDestinationAddress;
+		( void ) xDestinationAddressLength;
+	}
+	#endif /* ipconfigUSE_IPv6 */
+
+	return uxMaxPayloadLength;
+}
+/*-----------------------------------------------------------*/
+
+static NetworkBufferDescriptor_t *prvSendToGetBuffer( const FreeRTOS_Socket_t *pxSocket, const void *pvBuffer, size_t xTotalDataLength, BaseType_t xFlags,
+	const struct freertos_sockaddr *pxDestinationAddress, socklen_t xDestinationAddressLength, TickType_t xTicksToWait )
+{
+NetworkBufferDescriptor_t *pxNetworkBuffer = NULL;
+size_t uxHeaderLength = sizeof( UDPPacket_t );
+#if( ipconfigUSE_IPv6 != 0 )
+	BaseType_t xUsesIPv6 = pdFALSE;
+#endif
+
+	configASSERT( pvBuffer );
+
+	#if( ipconfigUSE_IPv6 != 0 )
+	{
+		if( prvAddressIsIPv6( pxDestinationAddress, xDestinationAddressLength ) != pdFALSE )
+		{
+			/* The destination is a struct freertos_sockaddr6.  The IPv6
+			header needs more space than the IPv4 header. */
+			xUsesIPv6 = pdTRUE;
+			uxHeaderLength += ipIPv6_EXTRA_HEADER_LENGTH;
+		}
+	}
+	#else
+	{
+		( void ) xDestinationAddressLength;
+	}
+	#endif /* ipconfigUSE_IPv6 */
+
+	if( ( xFlags & FREERTOS_ZERO_COPY ) == 0 )
+	{
+		/* Zero copy is not set, so obtain a network buffer into
+		which the payload will be copied.  Block until a buffer becomes
+		available, or until a timeout has been reached */
+		pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( xTotalDataLength + uxHeaderLength, xTicksToWait );
+
+		if( pxNetworkBuffer != NULL )
+		{
+			#if( ipconfigUSE_CHECKSUM_KERNELS != 0 )
+			{
+				/* Sum the payload while it is copied, so the IP-task
+				only has to sum the headers. */
+				pxNetworkBuffer->usPayloadChecksum = usGenerateChecksumCopy( 0UL, &( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] ), ( const uint8_t * ) pvBuffer, xTotalDataLength );
+			}
+			#else
+			{
+				memcpy( ( void * ) &( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] ), ( void * ) pvBuffer, xTotalDataLength );
+			}
+			#endif
+		}
 	}
-#endif /* ipconfigSUPPORT_SIGNALS */
 	else
 	{
-		lReturn = -pdFREERTOS_ERRNO_EWOULDBLOCK;
-		iptraceRECVFROM_TIMEOUT();
+		/* When zero copy is used, pvBuffer is a pointer to the
+		payload of a buffer that has already been obtained from the
+		stack.  Obtain the network buffer pointer from the buffer. */
+		pxNetworkBuffer = pxUDPPayloadBuffer_to_NetworkBuffer( (void*)pvBuffer );
 	}
 
-	return lReturn;
+	if( pxNetworkBuffer != NULL )
+	{
+		pxNetworkBuffer->xDataLength = xTotalDataLength;
+		pxNetworkBuffer->usPort = pxDestinationAddress->sin_port;
+		pxNetworkBuffer->usBoundPort = ( uint16_t ) socketGET_SOCKET_PORT( pxSocket );
+
+		#if( ipconfigUSE_IPv6 != 0 )
+		{
+			/* A zero-copy buffer may have been received from an IPv6
+			peer, so the field is always set. */
+			pxNetworkBuffer->xUsesIPv6 = xUsesIPv6;
+
+			if( xUsesIPv6 != pdFALSE )
+			{
+				memcpy( pxNetworkBuffer->xIPv6Address.ucBytes,
+					( ( const struct freertos_sockaddr6 * ) pxDestinationAddress )->sin6_addr.ucBytes,
+					sizeof( pxNetworkBuffer->xIPv6Address.ucBytes ) );
+				pxNetworkBuffer->ulIPAddress = 0UL;
+			}
+			else
+			{
+				pxNetworkBuffer->ulIPAddress = pxDestinationAddress->sin_addr;
+			}
+		}
+		#else
+		{
+			pxNetworkBuffer->ulIPAddress = pxDestinationAddress->sin_addr;
+		}
+		#endif /* ipconfigUSE_IPv6 */
+
+		/* The socket options are passed to the IP layer in the
+		space that will eventually get used by the Ethernet header. */
+		pxNetworkBuffer->pucEthernetBuffer[ ipSOCKET_OPTIONS_OFFSET ] = pxSocket->ucSocketOptions;
+	}
+	else
+	{
+		/* If errno was available, errno would be set to
+		FREERTOS_ENOPKTS.  As it is, the function must return the
+		number of transmitted bytes, so the calling function knows
+		how	much data was actually sent. */
+		iptraceNO_BUFFER_FOR_SENDTO();
+	}
+
+
+	return pxNetworkBuffer;
 }
 /*-----------------------------------------------------------*/
 
@@ -769,13 +1376,9 @@ FreeRTOS_Socket_t *pxSocket;
 
 	pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
 
-	/* The function prototype is designed to maintain the expected Berkeley
-	sockets standard, but this implementation does not use all the
-	parameters. */
-	( void ) xDestinationAddressLength;
-	configASSERT( pvBuffer );
-
-	if( xTotalDataLength <= ( size_t ) ipMAX_UDP_PAYLOAD_LENGTH )
+	/* Check the length before the socket gets bound, a datagram that can
+	not be sent should not take a port. */
+	if( xTotalDataLength <= prvSendToMaxPayload( pxDestinationAddress, xDestinationAddressLength ) )
 	{
 		/* If the socket is not already bound to an address, bind it now.
 		Passing NULL as the address parameter tells FreeRTOS_bind() to select
@@ -783,64 +1386,18 @@ FreeRTOS_Socket_t *pxSocket;
 		if( ( socketSOCKET_IS_BOUND( pxSocket ) != pdFALSE ) ||
 			( FreeRTOS_bind( xSocket, NULL, 0u ) == 0 ) )
 		{
-			xTicksToWait = pxSocket->xSendBlockTime;
+			xTicksToWait = prvSendToBlockTime( pxSocket, xFlags );
+			vTaskSetTimeOutState( &xTimeOut );
 
-			#if( ipconfigUSE_CALLBACKS != 0 )
-			{
-				if( xIsCallingFromIPTask() != pdFALSE )
-				{
-					/* If this send function is called from within a call-back
-					handler it may not block, otherwise chances would be big to
-					get a deadlock: the IP-task waiting for itself. */
-					xTicksToWait = ( TickType_t )0;
-				}
-			}
-			#endif /* ipconfigUSE_CALLBACKS */
+			pxNetworkBuffer = prvSendToGetBuffer( pxSocket, pvBuffer, xTotalDataLength, xFlags, pxDestinationAddress, xDestinationAddressLength, xTicksToWait );
 
-			if( ( xFlags & FREERTOS_MSG_DONTWAIT ) != 0 )
-			{
-				xTicksToWait = ( TickType_t ) 0;
-			}
-
-			if( ( xFlags & FREERTOS_ZERO_COPY ) == 0 )
+			if( pxNetworkBuffer != NULL )
 			{
-				/* Zero copy is not set, so obtain a network buffer into
-				which the payload will be copied. */
-				vTaskSetTimeOutState( &xTimeOut );
-
-				/* Block until a buffer becomes available, or until a
-				timeout has been reached */
-				pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( xTotalDataLength + sizeof( UDPPacket_t ), xTicksToWait );
-
-				if( pxNetworkBuffer != NULL )
+				if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdTRUE )
 				{
-					memcpy( ( void * ) &( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] ), ( void * ) pvBuffer, xTotalDataLength );
-
-					if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdTRUE )
-					{
-						/* The entire block time has been used up. */
-						xTicksToWait = ( TickType_t ) 0;
-					}
+					/* The entire block time has been used up. */
+					xTicksToWait = ( TickType_t ) 0;
 				}
-			}
-			else
-			{
-				/* When zero copy is used, pvBuffer is a pointer to the
-				payload of a buffer that has already been obtained from the
-				stack.  Obtain the network buffer pointer from the buffer. */
-				pxNetworkBuffer = pxUDPPayloadBuffer_to_NetworkBuffer( (void*)pvBuffer );
-			}
-
-			if( pxNetworkBuffer != NULL )
-			{
-				pxNetworkBuffer->xDataLength = xTotalDataLength;
-				pxNetworkBuffer->usPort = pxDestinationAddress->sin_port;
-				pxNetworkBuffer->usBoundPort = ( uint16_t ) socketGET_SOCKET_PORT( pxSocket );
-				pxNetworkBuffer->ulIPAddress = pxDestinationAddress->sin_addr;
-
-				/* The socket options are passed to the IP layer in the
-				space that will eventually get used by the Ethernet header. */
-				pxNetworkBuffer->pucEthernetBuffer[ ipSOCKET_OPTIONS_OFFSET ] = pxSocket->ucSocketOptions;
 
 				/* Tell the networking task that the packet needs sending. */
 				xStackTxEvent.pvData = pxNetworkBuffer;
@@ -870,28 +1427,155 @@ FreeRTOS_Socket_t *pxSocket;
 					iptraceSTACK_TX_EVENT_LOST( ipSTACK_TX_EVENT );
 				}
 			}
-			else
-			{
-				/* If errno was available, errno would be set to
-				FREERTOS_ENOPKTS.  As it is, the function must return the
-				number of transmitted bytes, so the calling function knows
-				how	much data was actually sent. */
-				iptraceNO_BUFFER_FOR_SENDTO();
-			}
 		}
 		else
 		{
 			iptraceSENDTO_SOCKET_NOT_BOUND();
 		}
-	}
-	else
-	{
-		/* The data is longer than the available buffer space. */
-		iptraceSENDTO_DATA_TOO_LONG();
+	}
+	else
+	{
+		/* The data is longer than the available buffer space. */
+		iptraceSENDTO_DATA_TOO_LONG();
+	}
+
+	return lReturn;
+} /* Tested */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_UDP_BATCH != 0 )
+
+	/*
+	 * FreeRTOS_sendmmsg: send up to xMessageCount datagrams, each to its own
+	 * destination, and pass them all to the IP-task with a single message.
+	 * Only the first datagram may wait for a network buffer, the others are
+	 * taken from the buffers that are free, so a batch never blocks while it
+	 * holds buffers.  The datagrams are sent in order: when one can not be
+	 * prepared, it and the ones after it are not sent.  'lResult' of each
+	 * message is set to the number of bytes that were sent, or zero.  Returns
+	 * the number of datagrams sent, or -pdFREERTOS_ERRNO_EINVAL.
+	 */
+	BaseType_t FreeRTOS_sendmmsg( Socket_t xSocket, UDPMessage_t *pxMessages, BaseType_t xMessageCount, BaseType_t xFlags )
+	{
+	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+	NetworkBufferDescriptor_t *pxFirstBuffer = NULL, *pxLastBuffer = NULL, *pxNetworkBuffer;
+	IPStackEvent_t xStackTxEvent = { eStackTxBatchEvent, NULL };
+	TimeOut_t xTimeOut;
+	TickType_t xTicksToWait;
+	BaseType_t xIndex, xCount = 0;
+
+		if( ( prvValidSocket( pxSocket, FREERTOS_IPPROTO_UDP, pdFALSE ) == pdFALSE ) || ( xMessageCount < 0 ) )
+		{
+			return -pdFREERTOS_ERRNO_EINVAL;
+		}
+
+		for( xIndex = 0; xIndex < xMessageCount; xIndex++ )
+		{
+			pxMessages[ xIndex ].lResult = 0;
+		}
+
+		if( ( xMessageCount > 0 ) &&
+			( pxMessages[ 0 ].uxLength > prvSendToMaxPayload( pxMessages[ 0 ].pxAddress, pxMessages[ 0 ].xAddressLength ) ) )
+		{
+			/* As in FreeRTOS_sendto(), the socket is not bound for a
+			datagram that can not be sent. */
+			iptraceSENDTO_DATA_TOO_LONG();
+		}
+		else if( ( socketSOCKET_IS_BOUND( pxSocket ) != pdFALSE ) ||
+				 ( FreeRTOS_bind( xSocket, NULL, 0u ) == 0 ) )
+		{
+			xTicksToWait = prvSendToBlockTime( pxSocket, xFlags );
+			vTaskSetTimeOutState( &xTimeOut );
+
+			while( xCount < xMessageCount )
+			{
+				if( pxMessages[ xCount ].uxLength > prvSendToMaxPayload( pxMessages[ xCount ].pxAddress, pxMessages[ xCount ].xAddressLength ) )
+				{
+					iptraceSENDTO_DATA_TOO_LONG();
+					break;
+				}
+
+				pxNetworkBuffer = prvSendToGetBuffer( pxSocket, pxMessages[ xCount ].pvBuffer, pxMessages[ xCount ].uxLength, xFlags,
+					pxMessages[ xCount ].pxAddress, pxMessages[ xCount ].xAddressLength, ( pxFirstBuffer == NULL ) ? xTicksToWait : ( TickType_t ) 0 );
+
+				if( pxNetworkBuffer == NULL )
+				{
+					break;
+				}
+
+				pxNetworkBuffer->pxNextBuffer = NULL;
+
+				if( pxLastBuffer == NULL )
+				{
+					pxFirstBuffer = pxNetworkBuffer;
+				}
+				else
+				{
+					pxLastBuffer->pxNextBuffer = pxNetworkBuffer;
+				}
+
+				pxLastBuffer = pxNetworkBuffer;
+				xCount++;
+			}
+
+			if( pxFirstBuffer != NULL )
+			{
+				if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdTRUE )
+				{
+					/* The entire block time has been used up. */
+					xTicksToWait = ( TickType_t ) 0;
+				}
+
+				/* Ask the IP-task to send the whole chain. */
+				xStackTxEvent.pvData = pxFirstBuffer;
+
+				if( xSendEventStructToIPTask( &xStackTxEvent, xTicksToWait ) == pdPASS )
+				{
+					for( xIndex = 0; xIndex < xCount; xIndex++ )
+					{
+						pxMessages[ xIndex ].lResult = ( int32_t ) pxMessages[ xIndex ].uxLength;
+
+						#if( ipconfigUSE_CALLBACKS == 1 )
+						{
+							if( ipconfigIS_VALID_PROG_ADDRESS( pxSocket->u.xUDP.pxHandleSent ) )
+							{
+								pxSocket->u.xUDP.pxHandleSent( ( Socket_t * ) pxSocket, pxMessages[ xIndex ].uxLength );
+							}
+						}
+						#endif /* ipconfigUSE_CALLBACKS */
+					}
+				}
+				else
+				{
+					/* None of the datagrams will be sent.  Release the buffers
+					that were allocated here, zero-copy buffers still belong
+					to the caller. */
+					while( pxFirstBuffer != NULL )
+					{
+						pxNetworkBuffer = pxFirstBuffer;
+						pxFirstBuffer = pxNetworkBuffer->pxNextBuffer;
+						pxNetworkBuffer->pxNextBuffer = NULL;
+
+						if( ( xFlags & FREERTOS_ZERO_COPY ) == 0 )
+						{
+							vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+						}
+					}
+
+					xCount = 0;
+					iptraceSTACK_TX_EVENT_LOST( ipSTACK_TX_EVENT );
+				}
+			}
+		}
+		else
+		{
+			iptraceSENDTO_SOCKET_NOT_BOUND();
+		}
+
+		return xCount;
 	}
 
-	return lReturn;
-} /* Tested */
+#endif /* ipconfigUSE_UDP_BATCH */
 /*-----------------------------------------------------------*/
 
 /*
@@ -1028,7 +1712,9 @@ List_t *pxSocketList;
 		/* Check to ensure the port is not already in use.  If the bind is
 		called internally, a port MAY be used by more than one socket. */
 		if( ( ( xInternal == pdFALSE ) || ( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP ) ) &&
-			( pxListFindListItemWithValue( pxSocketList, ( TickType_t ) pxAddress->sin_port ) != NULL ) )
+			( ( ( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_UDP ) ?
+				pxUDPPortFind( ( TickType_t ) pxAddress->sin_port ) :
+				pxListFindListItemWithValue( pxSocketList, ( TickType_t ) pxAddress->sin_port ) ) != NULL ) )
 		{
 			FreeRTOS_debug_printf( ( "vSocketBind: %sP port %d in use\n",
 				pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_TCP ? "TC" : "UD",
@@ -1059,12 +1745,31 @@ List_t *pxSocketList;
 				/* Add the socket to 'xBoundUDPSocketsList' or 'xBoundTCPSocketsList' */
 				vListInsertEnd( pxSocketList, &( pxSocket->xBoundSocketListItem ) );
 
+				#if( ipconfigUDP_HASH_TABLE_SIZE > 0 )
+				{
+					if( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_UDP )
+					{
+						listSET_LIST_ITEM_VALUE( &( pxSocket->u.xUDP.xHashListItem ), ( TickType_t ) pxAddress->sin_port );
+						vListInsertEnd( socketUDP_PORT_BUCKET( ( TickType_t ) pxAddress->sin_port ), &( pxSocket->u.xUDP.xHashListItem ) );
+					}
+				}
+				#endif /* ipconfigUDP_HASH_TABLE_SIZE */
+
 				#if( ipconfigETHERNET_DRIVER_FILTERS_PACKETS == 1 )
 				{
 					xTaskResumeAll();
 				}
 				#endif /* ipconfigETHERNET_DRIVER_FILTERS_PACKETS */
 			}
+
+			#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_HASH_TABLE_SIZE > 0 ) )
+			{
+				if( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_TCP )
+				{
+					vSocketTCPHashUpdate( pxSocket );
+				}
+			}
+			#endif /* ipconfigTCP_HASH_TABLE_SIZE */
 		}
 	}
 	else
@@ -1159,6 +1864,14 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 			}
 			#endif /* ipconfigUSE_TCP_WIN */
 
+			#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+			{
+				/* Data that were sent without copying will not be delivered
+				anymore. */
+				vTCPReleaseTxBuffers( pxSocket );
+			}
+			#endif
+
 			/* Free the input and output streams */
 			if( pxSocket->u.xTCP.rxStream != NULL )
 			{
@@ -1173,6 +1886,15 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 			/* In case this is a child socket, make sure the child-count of the
 			parent socket is decreased. */
 			prvTCPSetSocketCount( pxSocket );
+
+			#if( ipconfigTCP_HASH_TABLE_SIZE > 0 )
+			{
+				if( listLIST_ITEM_CONTAINER( &( pxSocket->u.xTCP.xHashListItem ) ) != NULL )
+				{
+					( void ) uxListRemove( &( pxSocket->u.xTCP.xHashListItem ) );
+				}
+			}
+			#endif /* ipconfigTCP_HASH_TABLE_SIZE */
 		}
 	}
 	#endif  /* ipconfigUSE_TCP == 1 */
@@ -1192,6 +1914,15 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 
 		uxListRemove( &( pxSocket->xBoundSocketListItem ) );
 
+		#if( ipconfigUDP_HASH_TABLE_SIZE > 0 )
+		{
+			if( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_UDP )
+			{
+				( void ) uxListRemove( &( pxSocket->u.xUDP.xHashListItem ) );
+			}
+		}
+		#endif /* ipconfigUDP_HASH_TABLE_SIZE */
+
 		#if( ipconfigETHERNET_DRIVER_FILTERS_PACKETS == 1 )
 		{
 			xTaskResumeAll();
@@ -1216,6 +1947,12 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 		vEventGroupDelete( pxSocket->xEventGroup );
 	}
 
+	#if( ipconfigSUPPORT_SELECT_READY_LIST == 1 )
+	{
+		prvSocketSelectUnready( pxSocket );
+	}
+	#endif /* ipconfigSUPPORT_SELECT_READY_LIST */
+
 	#if( ipconfigUSE_TCP == 1 ) && ( ipconfigHAS_DEBUG_PRINTF != 0 )
 	{
 		if( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_TCP )
@@ -1633,6 +2370,35 @@ FreeRTOS_Socket_t *pxSocket;
 				xReturn = 0;
 				break;
 
+			#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+				case FREERTOS_SO_TCP_CONGESTION:	/* Choose the congestion control algorithm, parameter is a pointer to a TCPCongestionOps_t */
+					{
+					const TCPCongestionOps_t *pxOps = ( const TCPCongestionOps_t * ) pvOptionValue;
+
+						if( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP )
+						{
+							break;	/* will return -pdFREERTOS_ERRNO_EINVAL */
+						}
+
+						if( ( pxSocket->u.xTCP.ucTCPState != ( uint8_t ) eCLOSED ) && ( pxSocket->u.xTCP.ucTCPState != ( uint8_t ) eTCP_LISTEN ) )
+						{
+							FreeRTOS_debug_printf( ( "Set SO_TCP_CONGESTION: already connected\n" ) );
+							break;	/* will return -pdFREERTOS_ERRNO_EINVAL */
+						}
+
+						if( ( pxOps == NULL ) || ( pxOps->fnOnAck == NULL ) || ( pxOps->fnOnLoss == NULL ) )
+						{
+							break;	/* will return -pdFREERTOS_ERRNO_EINVAL */
+						}
+
+						/* vTCPWindowInit() will start using it as soon as the
+						connection is being made. */
+						pxSocket->u.xTCP.xTCPWindow.xCongestion.pxOps = pxOps;
+					}
+					xReturn = 0;
+					break;
+			#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
 		#endif  /* ipconfigUSE_TCP == 1 */
 
 		default :
@@ -1665,7 +2431,8 @@ const List_t *pxList;
 	else
 #endif
 	{
-		pxList = &xBoundUDPSocketsList;
+		/* UDP ports are looked up with pxUDPPortFind(). */
+		pxList = NULL;
 	}
 
 	/* Avoid compiler warnings if ipconfigUSE_TCP is not defined. */
@@ -1699,9 +2466,8 @@ const List_t *pxList;
 
 		/* Check if there's already an open socket with the same protocol
 		and port. */
-		if( NULL == pxListFindListItemWithValue(
-			pxList,
-			( TickType_t )FreeRTOS_htons( usResult ) ) )
+		if( ( ( pxList != NULL ) && ( NULL == pxListFindListItemWithValue( pxList, ( TickType_t ) FreeRTOS_htons( usResult ) ) ) ) ||
+			( ( pxList == NULL ) && ( NULL == pxUDPPortFind( ( TickType_t ) FreeRTOS_htons( usResult ) ) ) ) )
 		{
 			usResult = FreeRTOS_htons( usResult );
 			break;
@@ -1746,6 +2512,27 @@ const ListItem_t * pxResult = NULL;
 
 /*-----------------------------------------------------------*/
 
+static const ListItem_t * pxUDPPortFind( TickType_t xPort )
+{
+const ListItem_t * pxResult;
+
+	#if( ipconfigUDP_HASH_TABLE_SIZE > 0 )
+	{
+		/* Only the sockets of one bucket need to be compared.  Note that the
+		item values in the bucket are port numbers, just like those in
+		xBoundUDPSocketsList. */
+		pxResult = pxListFindListItemWithValue( socketUDP_PORT_BUCKET( xPort ), xPort );
+	}
+	#else
+	{
+		pxResult = pxListFindListItemWithValue( &xBoundUDPSocketsList, xPort );
+	}
+	#endif /* ipconfigUDP_HASH_TABLE_SIZE */
+
+	return pxResult;
+}
+/*-----------------------------------------------------------*/
+
 FreeRTOS_Socket_t *pxUDPSocketLookup( UBaseType_t uxLocalPort )
 {
 const ListItem_t *pxListItem;
@@ -1755,7 +2542,7 @@ FreeRTOS_Socket_t *pxSocket = NULL;
 
 	See if there is a list item associated with the port number on the
 	list of bound sockets. */
-	pxListItem = pxListFindListItemWithValue( &xBoundUDPSocketsList, ( TickType_t ) uxLocalPort );
+	pxListItem = pxUDPPortFind( ( TickType_t ) uxLocalPort );
 
 	if( pxListItem != NULL )
 	{
@@ -1858,6 +2645,220 @@ FreeRTOS_Socket_t *pxSocket = NULL;
 
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_IPv6 != 0 )
+
+	BaseType_t FreeRTOS_inet_pton6( const char *pcSource, IPv6_Address_t *pxAddress )
+	{
+	uint16_t usGroups[ socketIPv6_ADDRESS_GROUPS ];
+	BaseType_t xGroupCount = 0, xGapIndex = -1, xDigitCount, xIndex, xTarget;
+	uint32_t ulValue;
+	char cChar;
+	BaseType_t xResult = pdPASS;
+
+		if( ( pcSource[ 0 ] == ':' ) && ( pcSource[ 1 ] == ':' ) )
+		{
+			/* The address starts with a run of zero groups. */
+			xGapIndex = 0;
+			pcSource += 2;
+		}
+
+		while( ( xResult == pdPASS ) && ( *pcSource != ( char ) 0 ) )
+		{
+			ulValue = 0UL;
+			xDigitCount = 0;
+
+			for( ;; )
+			{
+				cChar = *pcSource;
+
+				if( ( cChar >= '0' ) && ( cChar <= '9' ) )
+				{
+					ulValue = ( ulValue << 4 ) + ( uint32_t ) ( cChar - '0' );
+				}
+				else if( ( cChar >= 'a' ) && ( cChar <= 'f' ) )
+				{
+					ulValue = ( ulValue << 4 ) + ( uint32_t ) ( cChar - 'a' ) + 10UL;
+				}
+				else if( ( cChar >= 'A' ) && ( cChar <= 'F' ) )
+				{
+					ulValue = ( ulValue << 4 ) + ( uint32_t ) ( cChar - 'A' ) + 10UL;
+				}
+				else
+				{
+					/* The end of the group. */
+					break;
+				}
+
+				xDigitCount++;
+				pcSource++;
+			}
+
+			if( ( xDigitCount == 0 ) || ( xDigitCount > 4 ) || ( xGroupCount == socketIPv6_ADDRESS_GROUPS ) )
+			{
+				xResult = pdFAIL;
+			}
+			else
+			{
+				usGroups[ xGroupCount ] = ( uint16_t ) ulValue;
+				xGroupCount++;
+
+				if( *pcSource == ':' )
+				{
+					pcSource++;
+
+					if( *pcSource == ':' )
+					{
+						/* "::" may only appear once. */
+						if( xGapIndex >= 0 )
+						{
+							xResult = pdFAIL;
+						}
+						xGapIndex = xGroupCount;
+						pcSource++;
+					}
+					else if( *pcSource == ( char ) 0 )
+					{
+						/* A single colon can not end the address. */
+						xResult = pdFAIL;
+					}
+					else
+					{
+						/* Another group follows. */
+					}
+				}
+				else if( *pcSource != ( char ) 0 )
+				{
+					/* Dotted IPv4 notation is not supported. */
+					xResult = pdFAIL;
+				}
+				else
+				{
+					/* The end of the address. */
+				}
+			}
+		}
+
+		if( xGapIndex < 0 )
+		{
+			if( xGroupCount != socketIPv6_ADDRESS_GROUPS )
+			{
+				xResult = pdFAIL;
+			}
+		}
+		else if( xGroupCount == socketIPv6_ADDRESS_GROUPS )
+		{
+			/* "::" stands for at least one group. */
+			xResult = pdFAIL;
+		}
+		else
+		{
+			/* The gap is filled in below. */
+		}
+
+		if( xResult == pdPASS )
+		{
+			memset( pxAddress->ucBytes, 0, sizeof( pxAddress->ucBytes ) );
+
+			for( xIndex = 0; xIndex < xGroupCount; xIndex++ )
+			{
+				/* The groups behind the gap go to the end of the address. */
+				if( ( xGapIndex >= 0 ) && ( xIndex >= xGapIndex ) )
+				{
+					xTarget = xIndex + ( socketIPv6_ADDRESS_GROUPS - xGroupCount );
+				}
+				else
+				{
+					xTarget = xIndex;
+				}
+
+				pxAddress->ucBytes[ 2 * xTarget ] = ( uint8_t ) ( usGroups[ xIndex ] >> 8 );
+				pxAddress->ucBytes[ 2 * xTarget + 1 ] = ( uint8_t ) ( usGroups[ xIndex ] & 0xffU );
+			}
+		}
+
+		return xResult;
+	}
+	/*-----------------------------------------------------------*/
+
+	const char *FreeRTOS_inet_ntop6( const IPv6_Address_t *pxAddress, char *pcBuffer, size_t uxBufferLength )
+	{
+	static const char cHexDigits[] = "0123456789abcdef";
+	BaseType_t xIndex, xRunStart = -1, xBestStart = -1, xBestLength = 1, xShift;
+	BaseType_t xPreviousWasGroup = pdFALSE;
+	uint16_t usGroup;
+	size_t uxTarget = 0U;
+	const char *pcReturn = NULL;
+
+		if( uxBufferLength >= socketIPv6_ADDRESS_TEXT_LENGTH )
+		{
+			/* Find the longest run of two or more zero groups, the first one
+			when there are several of the same length. */
+			for( xIndex = 0; xIndex < socketIPv6_ADDRESS_GROUPS; xIndex++ )
+			{
+				if( ( pxAddress->ucBytes[ 2 * xIndex ] == 0U ) && ( pxAddress->ucBytes[ 2 * xIndex + 1 ] == 0U ) )
+				{
+					if( xRunStart < 0 )
+					{
+						xRunStart = xIndex;
+					}
+
+					if( ( xIndex - xRunStart + 1 ) > xBestLength )
+					{
+						xBestStart = xRunStart;
+						xBestLength = xIndex - xRunStart + 1;
+					}
+				}
+				else
+				{
+					xRunStart = -1;
+				}
+			}
+
+			xIndex = 0;
+
+			while( xIndex < socketIPv6_ADDRESS_GROUPS )
+			{
+				if( xIndex == xBestStart )
+				{
+					/* The run of zero groups is left out. */
+					pcBuffer[ uxTarget++ ] = ':';
+					pcBuffer[ uxTarget++ ] = ':';
+					xIndex += xBestLength;
+					xPreviousWasGroup = pdFALSE;
+				}
+				else
+				{
+					if( xPreviousWasGroup != pdFALSE )
+					{
+						pcBuffer[ uxTarget++ ] = ':';
+					}
+
+					/* Print the group without leading zeros. */
+					usGroup = ( uint16_t ) ( ( ( uint16_t ) pxAddress->ucBytes[ 2 * xIndex ] << 8 ) | pxAddress->ucBytes[ 2 * xIndex + 1 ] );
+
+					for( xShift = 12; xShift >= 0; xShift -= 4 )
+					{
+						if( ( xShift == 0 ) || ( ( usGroup >> xShift ) != 0U ) )
+						{
+							pcBuffer[ uxTarget++ ] = cHexDigits[ ( usGroup >> xShift ) & 0x0fU ];
+						}
+					}
+
+					xIndex++;
+					xPreviousWasGroup = pdTRUE;
+				}
+			}
+
+			pcBuffer[ uxTarget ] = ( char ) 0;
+			pcReturn = pcBuffer;
+		}
+
+		return pcReturn;
+	}
+
+#endif /* ipconfigUSE_IPv6 */
+/*-----------------------------------------------------------*/
+
 /* Function to get the local address and IP port */
 size_t FreeRTOS_GetLocalAddress( Socket_t xSocket, struct freertos_sockaddr *pxAddress )
 {
@@ -1905,6 +2906,12 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 			{
 				pxSocket->xSocketBits |= xSelectBits;
 				xEventGroupSetBits( pxSocket->pxSocketSet->xSelectGroup, xSelectBits );
+
+				#if( ipconfigSUPPORT_SELECT_READY_LIST == 1 )
+				{
+					vSocketSelectReady( pxSocket, xSelectBits );
+				}
+				#endif /* ipconfigSUPPORT_SELECT_READY_LIST */
 			}
 		}
 
@@ -1936,7 +2943,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 
 		vTaskSuspendAll();
 		{
-			if( ( pxListFindListItemWithValue( &xBoundUDPSocketsList, ( TickType_t ) usPortNr ) != NULL ) )
+			if( ( pxUDPPortFind( ( TickType_t ) usPortNr ) != NULL ) )
 			{
 				xFound = pdTRUE;
 			}
@@ -1969,10 +2976,16 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 
 #if( ipconfigUSE_TCP == 1 )
 
-	static BaseType_t prvTCPConnectStart( FreeRTOS_Socket_t *pxSocket, struct freertos_sockaddr *pxAddress )
+	static BaseType_t prvTCPConnectStart( FreeRTOS_Socket_t *pxSocket, struct freertos_sockaddr *pxAddress, socklen_t xAddressLength )
 	{
 	BaseType_t xResult = 0;
 
+		#if( ipconfigUSE_IPv6 == 0 )
+		{
+			( void ) xAddressLength;
+		}
+		#endif
+
 		if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_TCP, pdFALSE ) == pdFALSE )
 		{
 			/* Not a valid socket or wrong type */
@@ -1983,6 +2996,13 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 			/* The socket is already connected. */
 			xResult = -pdFREERTOS_ERRNO_EISCONN;
 		}
+	#if( ipconfigUSE_IPv6 != 0 )
+		else if( prvAddressIsIPv6( pxAddress, xAddressLength ) != pdFALSE )
+		{
+			/* TCP only connects to IPv4 addresses. */
+			xResult = -pdFREERTOS_ERRNO_EADDRNOTAVAIL;
+		}
+	#endif /* ipconfigUSE_IPv6 */
 		else if( socketSOCKET_IS_BOUND( pxSocket ) == pdFALSE )
 		{
 			/* Bind the socket to the port that the client task will send from.
@@ -2043,9 +3063,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 	BaseType_t xResult;
 	TimeOut_t xTimeOut;
 
-		( void ) xAddressLength;
-
-		xResult = prvTCPConnectStart( pxSocket, pxAddress );
+		xResult = prvTCPConnectStart( pxSocket, pxAddress, xAddressLength );
 
 		if( xResult == 0 )
 		{
@@ -2469,13 +3487,113 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
             BaseType_t xSpace = ( BaseType_t )uxStreamBufferGetSpace( pxBuffer );
             BaseType_t xRemain = ( BaseType_t )( pxBuffer->LENGTH - pxBuffer->uxHead );
 
-                *pxLength = FreeRTOS_min_BaseType( xSpace, xRemain );
-                pucReturn = pxBuffer->ucArray + pxBuffer->uxHead;
-            }
-		}
+                *pxLength = FreeRTOS_min_BaseType( xSpace, xRemain );
+                pucReturn = pxBuffer->ucArray + pxBuffer->uxHead;
+            }
+		}
+
+		return pucReturn;
+	}
+#endif /* ipconfigUSE_TCP */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP == 1 )
+
+	BaseType_t FreeRTOS_get_tx_regions( Socket_t xSocket, StreamRegions_t *pxRegions )
+	{
+	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+	StreamBuffer_t *pxBuffer;
+	size_t uxHead, uxSpace;
+
+		memset( pxRegions, '\0', sizeof( *pxRegions ) );
+
+		if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_TCP, pdFALSE ) == pdTRUE )
+		{
+			pxBuffer = pxSocket->u.xTCP.txStream;
+
+			if( pxBuffer != NULL )
+			{
+				/* Only the owner moves the head, the IP-task may free more
+				space in the mean time. */
+				uxHead = pxBuffer->uxHead;
+				uxSpace = uxStreamBufferGetSpace( pxBuffer );
+
+				pxRegions->pucFirst = pxBuffer->ucArray + uxHead;
+				pxRegions->uxFirstLength = FreeRTOS_min_uint32( uxSpace, pxBuffer->LENGTH - uxHead );
+
+				if( uxSpace > pxRegions->uxFirstLength )
+				{
+					pxRegions->pucSecond = pxBuffer->ucArray;
+					pxRegions->uxSecondLength = uxSpace - pxRegions->uxFirstLength;
+				}
+			}
+		}
+
+		return ( BaseType_t ) ( pxRegions->uxFirstLength + pxRegions->uxSecondLength );
+	}
+
+#endif /* ipconfigUSE_TCP */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP == 1 )
+
+	BaseType_t FreeRTOS_recv_regions( Socket_t xSocket, StreamRegions_t *pxRegions, BaseType_t xFlags )
+	{
+	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+	StreamBuffer_t *pxBuffer;
+	uint8_t *pucData;
+	size_t uxHead, uxTail;
+	BaseType_t xResult;
+
+		memset( pxRegions, '\0', sizeof( *pxRegions ) );
+
+		/* Let FreeRTOS_recv() wait for data and check the socket.  In zero-copy
+		mode it only returns the first region. */
+		xResult = FreeRTOS_recv( xSocket, &pucData, 0u, ( xFlags & ~FREERTOS_MSG_PEEK ) | FREERTOS_ZERO_COPY );
+
+		if( xResult > 0 )
+		{
+			/* Only the owner moves the tail.  The IP-task may have added data
+			since, so look at the head once more. */
+			pxBuffer = pxSocket->u.xTCP.rxStream;
+			uxTail = pxBuffer->uxTail;
+			uxHead = pxBuffer->uxHead;
+
+			pxRegions->pucFirst = pxBuffer->ucArray + uxTail;
+
+			if( uxHead >= uxTail )
+			{
+				pxRegions->uxFirstLength = uxHead - uxTail;
+			}
+			else
+			{
+				pxRegions->uxFirstLength = pxBuffer->LENGTH - uxTail;
+
+				if( uxHead != 0u )
+				{
+					pxRegions->pucSecond = pxBuffer->ucArray;
+					pxRegions->uxSecondLength = uxHead;
+				}
+			}
+
+			xResult = ( BaseType_t ) ( pxRegions->uxFirstLength + pxRegions->uxSecondLength );
+		}
+
+		return xResult;
+	}
+
+#endif /* ipconfigUSE_TCP */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP == 1 )
 
-		return pucReturn;
+	BaseType_t FreeRTOS_recv_consume( Socket_t xSocket, size_t uxCount )
+	{
+		/* Without a buffer, FreeRTOS_recv() only moves the tail of rxStream,
+		and it lets the peer send again when the low-water mark was reached. */
+		return FreeRTOS_recv( xSocket, NULL, uxCount, FREERTOS_MSG_DONTWAIT );
 	}
+
 #endif /* ipconfigUSE_TCP */
 /*-----------------------------------------------------------*/
 
@@ -2663,6 +3781,134 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 #endif /* ipconfigUSE_TCP */
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+
+	/*
+	 * Send data from a network buffer of the application without copying it.
+	 * The space in txStream is reserved, the data are taken from the buffer
+	 * when they are sent.
+	 */
+	BaseType_t FreeRTOS_send_buffer( Socket_t xSocket, NetworkBufferDescriptor_t *pxNetworkBuffer, size_t uxDataLength, BaseType_t xFlags )
+	{
+	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+	BaseType_t xResult;
+	StreamBuffer_t *pxStream;
+	TickType_t xRemainingTime;
+	BaseType_t xTimed = pdFALSE;
+	TimeOut_t xTimeOut;
+
+		xResult = ( BaseType_t ) prvTCPSendCheck( pxSocket, uxDataLength );
+
+		if( xResult <= 0 )
+		{
+			/* The socket can not send, or there is nothing to send. */
+		}
+		else if( ( pxNetworkBuffer == NULL ) ||
+			( uxDataLength > pxNetworkBuffer->xDataLength ) ||
+			( uxDataLength >= pxSocket->u.xTCP.txStream->LENGTH ) )
+		{
+			/* The data must fit in txStream as a whole: its space is reserved
+			in one go. */
+			xResult = -pdFREERTOS_ERRNO_EINVAL;
+		}
+		else
+		{
+			/* prvTCPSendCheck() has created txStream. */
+			pxStream = pxSocket->u.xTCP.txStream;
+
+			for( ;; )
+			{
+				if( uxStreamBufferGetSpace( pxStream ) >= uxDataLength )
+				{
+					break;
+				}
+
+				if( xTimed == pdFALSE )
+				{
+					/* Only in the first round, check for non-blocking. */
+					xRemainingTime = pxSocket->xSendBlockTime;
+
+					#if( ipconfigUSE_CALLBACKS != 0 )
+					{
+						if( xIsCallingFromIPTask() != pdFALSE )
+						{
+							/* Called from a call-back handler, which may not
+							block. */
+							xRemainingTime = ( TickType_t ) 0;
+						}
+					}
+					#endif /* ipconfigUSE_CALLBACKS */
+
+					if( ( xRemainingTime == ( TickType_t ) 0 ) || ( ( xFlags & FREERTOS_MSG_DONTWAIT ) != 0 ) )
+					{
+						break;
+					}
+
+					/* Don't get here a second time. */
+					xTimed = pdTRUE;
+					vTaskSetTimeOutState( &xTimeOut );
+				}
+				else if( xTaskCheckForTimeOut( &xTimeOut, &xRemainingTime ) != pdFALSE )
+				{
+					break;
+				}
+
+				/* Go sleeping until down-stream events are received. */
+				xEventGroupWaitBits( pxSocket->xEventGroup, eSOCKET_SEND | eSOCKET_CLOSED,
+					pdTRUE /*xClearOnExit*/, pdFALSE /*xWaitAllBits*/, xRemainingTime );
+			}
+
+			if( uxStreamBufferGetSpace( pxStream ) < uxDataLength )
+			{
+				/* The buffer still belongs to the caller. */
+				if( pxSocket->u.xTCP.ucTCPState > eESTABLISHED )
+				{
+					xResult = -pdFREERTOS_ERRNO_ENOTCONN;
+				}
+				else
+				{
+					xResult = -pdFREERTOS_ERRNO_ENOSPC;
+				}
+			}
+			else
+			{
+				/* The space in txStream is reserved without copying any data:
+				the IP-task takes the bytes from the buffer when it sends them.
+				'uxStreamOffset' remembers where in the stream they start.
+				From here on the reference of the caller belongs to the socket,
+				it will be released when all bytes have been acknowledged. */
+				vTaskSuspendAll();
+				{
+					pxNetworkBuffer->uxStreamOffset = pxStream->uxHead;
+					pxNetworkBuffer->xDataLength = uxDataLength;
+					vListInsertEnd( &( pxSocket->u.xTCP.xTxBufferList ), &( pxNetworkBuffer->xBufferListItem ) );
+					( void ) uxStreamBufferAdd( pxStream, 0ul, NULL, uxDataLength );
+
+					if( pxSocket->u.xTCP.bits.bCloseAfterSend != pdFALSE_UNSIGNED )
+					{
+						pxSocket->u.xTCP.bits.bCloseRequested = pdTRUE_UNSIGNED;
+					}
+				}
+				xTaskResumeAll();
+
+				/* Let the IP-task work on this socket. */
+				pxSocket->u.xTCP.usTimeout = 1u;
+
+				if( xIsCallingFromIPTask() == pdFALSE )
+				{
+					xSendEventToIPTask( eTCPTimerEvent );
+				}
+
+				xResult = ( BaseType_t ) uxDataLength;
+			}
+		}
+
+		return xResult;
+	}
+
+#endif /* ipconfigUSE_TCP && ipconfigUSE_NETWORK_BUFFER_CHAINS */
+/*-----------------------------------------------------------*/
+
 #if( ipconfigUSE_TCP == 1 )
 
 	/*
@@ -2706,6 +3952,12 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 					vStreamBufferClear( pxSocket->u.xTCP.txStream );
 				}
 
+				#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+				{
+					vTCPReleaseTxBuffers( pxSocket );
+				}
+				#endif
+
 				memset( pxSocket->u.xTCP.xPacket.u.ucLastPacket, '\0', sizeof( pxSocket->u.xTCP.xPacket.u.ucLastPacket ) );
 				memset( &pxSocket->u.xTCP.xTCPWindow, '\0', sizeof( pxSocket->u.xTCP.xTCPWindow ) );
 				memset( &pxSocket->u.xTCP.bits, '\0', sizeof( pxSocket->u.xTCP.bits ) );
@@ -2859,13 +4111,89 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 	 */
 	FreeRTOS_Socket_t *pxTCPSocketLookup( uint32_t ulLocalIP, UBaseType_t uxLocalPort, uint32_t ulRemoteIP, UBaseType_t uxRemotePort )
 	{
-	ListItem_t *pxIterator;
-	FreeRTOS_Socket_t *pxResult = NULL, *pxListenSocket = NULL;
-	MiniListItem_t *pxEnd = ( MiniListItem_t* )listGET_END_MARKER( &xBoundTCPSocketsList );
+	FreeRTOS_Socket_t *pxResult = NULL;
 
 		/* Parameter not yet supported. */
 		( void ) ulLocalIP;
 
+		#if( ipconfigTCP_HASH_TABLE_SIZE > 0 )
+		{
+		const List_t *pxBucket;
+		const ListItem_t *pxIterator;
+		const MiniListItem_t *pxEnd;
+		FreeRTOS_Socket_t *pxSocket;
+
+			/* First look for a connected socket with a perfect match. */
+			pxBucket = &( xTCPConnectionTable[ prvTCPHash( uxLocalPort, ulRemoteIP, uxRemotePort ) ] );
+			pxEnd = ( const MiniListItem_t * ) listGET_END_MARKER( pxBucket );
+
+			for( pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxEnd );
+				 pxIterator != ( const ListItem_t * ) pxEnd;
+				 pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+			{
+				pxSocket = ( FreeRTOS_Socket_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+
+				if( ( pxSocket->usLocalPort == ( uint16_t ) uxLocalPort ) &&
+					( pxSocket->u.xTCP.ucTCPState != eTCP_LISTEN ) &&
+					( pxSocket->u.xTCP.usRemotePort == ( uint16_t ) uxRemotePort ) &&
+					( pxSocket->u.xTCP.ulRemoteIP == ulRemoteIP ) )
+				{
+					pxResult = pxSocket;
+					break;
+				}
+			}
+
+			if( pxResult == NULL )
+			{
+				/* Maybe a socket is listening to uxLocalPort. */
+				pxBucket = &( xTCPListenTable[ prvTCPHash( uxLocalPort, 0UL, 0U ) ] );
+				pxEnd = ( const MiniListItem_t * ) listGET_END_MARKER( pxBucket );
+
+				for( pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxEnd );
+					 pxIterator != ( const ListItem_t * ) pxEnd;
+					 pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+				{
+					pxSocket = ( FreeRTOS_Socket_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+
+					if( ( pxSocket->usLocalPort == ( uint16_t ) uxLocalPort ) &&
+						( pxSocket->u.xTCP.ucTCPState == eTCP_LISTEN ) )
+					{
+						pxResult = pxSocket;
+						break;
+					}
+				}
+			}
+
+			if( pxResult == NULL )
+			{
+				/* FreeRTOS_connect() and FreeRTOS_listen() change the state
+				of a socket from the API task, so the socket might still be
+				in the wrong table.  Search all bound sockets, and file the
+				socket that was found in the correct table. */
+				pxResult = prvTCPSocketLookupList( uxLocalPort, ulRemoteIP, uxRemotePort );
+
+				if( pxResult != NULL )
+				{
+					vSocketTCPHashUpdate( pxResult );
+				}
+			}
+		}
+		#else
+		{
+			pxResult = prvTCPSocketLookupList( uxLocalPort, ulRemoteIP, uxRemotePort );
+		}
+		#endif /* ipconfigTCP_HASH_TABLE_SIZE */
+
+		return pxResult;
+	}
+	/*-----------------------------------------------------------*/
+
+	static FreeRTOS_Socket_t *prvTCPSocketLookupList( UBaseType_t uxLocalPort, uint32_t ulRemoteIP, UBaseType_t uxRemotePort )
+	{
+	ListItem_t *pxIterator;
+	FreeRTOS_Socket_t *pxResult = NULL, *pxListenSocket = NULL;
+	MiniListItem_t *pxEnd = ( MiniListItem_t* )listGET_END_MARKER( &xBoundTCPSocketsList );
+
 		for( pxIterator  = ( ListItem_t * ) listGET_NEXT( pxEnd );
 			 pxIterator != ( ListItem_t * ) pxEnd;
 			 pxIterator  = ( ListItem_t * ) listGET_NEXT( pxIterator ) )
@@ -2898,6 +4226,50 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 
 		return pxResult;
 	}
+	/*-----------------------------------------------------------*/
+
+	#if( ipconfigTCP_HASH_TABLE_SIZE > 0 )
+
+		void vSocketTCPHashUpdate( FreeRTOS_Socket_t *pxSocket )
+		{
+		ListItem_t *pxItem = &( pxSocket->u.xTCP.xHashListItem );
+
+			if( listLIST_ITEM_CONTAINER( pxItem ) != NULL )
+			{
+				( void ) uxListRemove( pxItem );
+			}
+
+			if( socketSOCKET_IS_BOUND( pxSocket ) == pdFALSE )
+			{
+				/* Only bound sockets can receive packets. */
+			}
+			else if( pxSocket->u.xTCP.ucTCPState == eTCP_LISTEN )
+			{
+				vListInsertEnd( &( xTCPListenTable[ prvTCPHash( pxSocket->usLocalPort, 0UL, 0U ) ] ), pxItem );
+			}
+			else if( ( pxSocket->u.xTCP.ulRemoteIP != 0UL ) || ( pxSocket->u.xTCP.usRemotePort != 0U ) )
+			{
+				vListInsertEnd( &( xTCPConnectionTable[ prvTCPHash( pxSocket->usLocalPort, pxSocket->u.xTCP.ulRemoteIP, pxSocket->u.xTCP.usRemotePort ) ] ), pxItem );
+			}
+			else
+			{
+				/* Neither listening nor connected yet. */
+			}
+		}
+		/*-----------------------------------------------------------*/
+
+		static UBaseType_t prvTCPHash( UBaseType_t uxLocalPort, uint32_t ulRemoteIP, UBaseType_t uxRemotePort )
+		{
+		uint32_t ulHash;
+
+			ulHash = ulRemoteIP ^ ( ( ( uint32_t ) uxRemotePort ) << 16 ) ^ ( uint32_t ) uxLocalPort;
+			ulHash ^= ulHash >> 16;
+			ulHash ^= ulHash >> 8;
+
+			return ( UBaseType_t ) ( ulHash & ( ( uint32_t ) ipconfigTCP_HASH_TABLE_SIZE - 1UL ) );
+		}
+
+	#endif /* ipconfigTCP_HASH_TABLE_SIZE */
 
 #endif /* ipconfigUSE_TCP */
 /*-----------------------------------------------------------*/
@@ -3102,18 +4474,38 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 					}
 				}
 
-				/* New incoming data is available, wake up the user.   User's
-				semaphores will be set just before the IP-task goes asleep. */
-				pxSocket->xEventBits |= eSOCKET_RECEIVE;
-
-				#if ipconfigSUPPORT_SELECT_FUNCTION == 1
+				#if( ipconfigTCP_RX_COALESCE_BYTES > 0 )
+				if( ( pxSocket->u.xTCP.bits.bRxCoalesce != pdFALSE_UNSIGNED ) &&
+					( pxSocket->u.xTCP.bits.bLowWater == pdFALSE_UNSIGNED ) &&
+					( uxStreamBufferGetSize( pxStream ) < FreeRTOS_min_uint32( ( uint32_t ) ipconfigTCP_RX_COALESCE_BYTES, ( uint32_t ) ( pxSocket->u.xTCP.uxRxStreamSize / 2u ) ) ) )
+				{
+					/* More full-size segments are on their way, let the user
+					sleep until a bigger amount of data is available.  The
+					IP-task will wake it up when the delayed-ACK timer expires. */
+					pxSocket->u.xTCP.bits.bRxWakePending = pdTRUE_UNSIGNED;
+				}
+				else
+				#endif /* ipconfigTCP_RX_COALESCE_BYTES */
 				{
-					if( ( pxSocket->xSelectBits & eSELECT_READ ) != 0 )
+					#if( ipconfigTCP_RX_COALESCE_BYTES > 0 )
+					{
+						pxSocket->u.xTCP.bits.bRxWakePending = pdFALSE_UNSIGNED;
+					}
+					#endif
+
+					/* New incoming data is available, wake up the user.   User's
+					semaphores will be set just before the IP-task goes asleep. */
+					pxSocket->xEventBits |= eSOCKET_RECEIVE;
+
+					#if ipconfigSUPPORT_SELECT_FUNCTION == 1
 					{
-						pxSocket->xEventBits |= ( eSELECT_READ << SOCKET_EVENT_BIT_COUNT );
+						if( ( pxSocket->xSelectBits & eSELECT_READ ) != 0 )
+						{
+							pxSocket->xEventBits |= ( eSELECT_READ << SOCKET_EVENT_BIT_COUNT );
+						}
 					}
+					#endif
 				}
-				#endif
 			}
 		}
 
@@ -3252,6 +4644,106 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 #endif /* ipconfigUSE_TCP */
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+
+	BaseType_t FreeRTOS_GetCongestionInfo( Socket_t xSocket, CongestionInfo_t *pxInfo )
+	{
+	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+	const TCPCongestion_t *pxCongestion;
+	BaseType_t xReturn;
+
+		if( ( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP ) || ( pxSocket->u.xTCP.xTCPWindow.u.bits.bHasInit == pdFALSE_UNSIGNED ) )
+		{
+			/* The congestion window only exists once a connection is being
+			made. */
+			xReturn = -pdFREERTOS_ERRNO_EINVAL;
+		}
+		else
+		{
+			pxCongestion = &( pxSocket->u.xTCP.xTCPWindow.xCongestion );
+
+			/* The values are updated by the IP-task, take a consistent
+			snapshot. */
+			vTaskSuspendAll();
+			{
+				pxInfo->pcAlgorithm = pxCongestion->pxOps->pcName;
+				pxInfo->ulCWnd = pxCongestion->ulCWnd;
+				pxInfo->ulSSThresh = pxCongestion->ulSSThresh;
+				pxInfo->ulFastRetransmits = pxCongestion->ulFastRetransmits;
+				pxInfo->ulTimeouts = pxCongestion->ulTimeouts;
+				pxInfo->xInRecovery = ( pxCongestion->ucInRecovery != 0u ) ? pdTRUE : pdFALSE;
+			}
+			( void ) xTaskResumeAll();
+
+			xReturn = 0;
+		}
+
+		return xReturn;
+	}
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_INFO != 0 )
+
+	BaseType_t FreeRTOS_GetTCPInfo( Socket_t xSocket, TCPInfo_t *pxInfo )
+	{
+	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+	const TCPWindow_t *pxWindow;
+	BaseType_t xReturn;
+
+		if( ( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP ) || ( pxSocket->u.xTCP.xTCPWindow.u.bits.bHasInit == pdFALSE_UNSIGNED ) )
+		{
+			/* The window and its statistics only exist once a connection is
+			being made. */
+			xReturn = -pdFREERTOS_ERRNO_EINVAL;
+		}
+		else
+		{
+			pxWindow = &( pxSocket->u.xTCP.xTCPWindow );
+
+			/* The values are updated by the IP-task, take a consistent
+			snapshot. */
+			vTaskSuspendAll();
+			{
+				pxInfo->ucState = pxSocket->u.xTCP.ucTCPState;
+				#if( ipconfigUSE_TCP_WIN != 0 )
+				{
+					pxInfo->ucMyWinScale = pxSocket->u.xTCP.ucMyWinScaleFactor;
+					pxInfo->ucPeerWinScale = pxSocket->u.xTCP.ucPeerWinScaleFactor;
+				}
+				#else
+				{
+					pxInfo->ucMyWinScale = 0u;
+					pxInfo->ucPeerWinScale = 0u;
+				}
+				#endif /* ipconfigUSE_TCP_WIN */
+				pxInfo->usMSS = pxWindow->usMSS;
+				pxInfo->lSRTT = pxWindow->lSRTT;
+				pxInfo->lRTTVar = pxWindow->lRTTVar;
+				pxInfo->lRTO = pxWindow->lRTO;
+				pxInfo->ulRxWindow = pxWindow->xSize.ulRxWindowLength;
+				pxInfo->ulTxWindow = pxWindow->xSize.ulTxWindowLength;
+				pxInfo->ulPeerWindow = pxSocket->u.xTCP.ulWindowSize;
+				pxInfo->ulBytesInFlight = ulTCPWindowTxInFlight( pxWindow );
+				pxInfo->uxRxQueued = ( pxSocket->u.xTCP.rxStream != NULL ) ? uxStreamBufferGetSize( pxSocket->u.xTCP.rxStream ) : 0u;
+				pxInfo->uxTxQueued = ( pxSocket->u.xTCP.txStream != NULL ) ? uxStreamBufferGetSize( pxSocket->u.xTCP.txStream ) : 0u;
+				pxInfo->ulSegmentsIn = pxWindow->ulSegmentsIn;
+				pxInfo->ulSegmentsOut = pxWindow->ulSegmentsOut;
+				pxInfo->ulRetransmits = pxWindow->ulRetransmits;
+				pxInfo->ulDupAcks = pxWindow->ulDupAcks;
+			}
+			( void ) xTaskResumeAll();
+
+			xReturn = 0;
+		}
+
+		return xReturn;
+	}
+
+#endif /* ipconfigUSE_TCP_INFO */
+/*-----------------------------------------------------------*/
+
 #if( ipconfigUSE_TCP == 1 )
 
 	/* Returns pdTRUE if TCP socket is connected. */
@@ -3583,6 +5075,17 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 					/* The WRITE and EXCEPT bits are not used for UDP */
 				}	/* if( pxSocket->ucProtocol == FREERTOS_IPPROTO_TCP ) */
 
+				#if( ipconfigSUPPORT_SELECT_READY_LIST == 1 )
+				{
+					/* Only the events that were not reported before make the
+					socket ready. */
+					if( ( xSocketBits & ~pxSocket->xSocketBits ) != 0u )
+					{
+						vSocketSelectReady( pxSocket, xSocketBits & ~pxSocket->xSocketBits );
+					}
+				}
+				#endif /* ipconfigSUPPORT_SELECT_READY_LIST */
+
 				/* Each socket keeps its own event flags, which are looked-up
 				by FreeRTOS_FD_ISSSET() */
 				pxSocket->xSocketBits = xSocketBits;
@@ -3620,6 +5123,37 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 #endif /* ipconfigSUPPORT_SELECT_FUNCTION == 1 */
 /*-----------------------------------------------------------*/
 
+#if( ipconfigSUPPORT_SELECT_READY_LIST == 1 )
+
+	void vSocketSelectReady( FreeRTOS_Socket_t *pxSocket, EventBits_t xSelectBits )
+	{
+	SocketSelect_t *pxSocketSet = pxSocket->pxSocketSet;
+
+		/* Only report the events that the owner of the set asked for. */
+		xSelectBits &= pxSocket->xSelectBits & eSELECT_ALL;
+
+		if( ( pxSocketSet != NULL ) && ( xSelectBits != 0u ) )
+		{
+			/* A socket is in the list only once, further events are ORed
+			into xReadyBits until FreeRTOS_select_ready() takes it. */
+			taskENTER_CRITICAL();
+			{
+				pxSocket->xReadyBits |= xSelectBits;
+
+				if( listLIST_ITEM_CONTAINER( &( pxSocket->xReadyListItem ) ) == NULL )
+				{
+					vListInsertEnd( &( pxSocketSet->xReadyList ), &( pxSocket->xReadyListItem ) );
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			xEventGroupSetBits( pxSocketSet->xSelectGroup, eSELECT_READY_LIST );
+		}
+	}
+
+#endif /* ipconfigSUPPORT_SELECT_READY_LIST */
+/*-----------------------------------------------------------*/
+
 #if( ipconfigSUPPORT_SIGNALS != 0 )
 
 	/* Send a signal to the task which reads from this socket. */
@@ -0,0 +1,299 @@
+/*
+ * FreeRTOS+TCP V2.0.11
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ * FreeRTOS_TCP_CC.c
+ * Module which contains the congestion control algorithms that can be used by
+ * FreeRTOS_TCP_WIN.c: NewReno (RFC 5681, RFC 6582) and CUBIC (RFC 8312).
+ *
+ * FreeRTOS_TCP_WIN.c detects the losses and takes care of the fast
+ * retransmission and the fast recovery.  The algorithms in this module only
+ * decide how the congestion window grows when new data is acknowledged, and
+ * what the new slow start threshold becomes after a loss.  All sizes are in
+ * bytes.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_UDP_IP.h"
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_IP_Private.h"
+#include "NetworkBufferManagement.h"
+#include "FreeRTOS_TCP_WIN.h"
+
+/* Exclude the entire file if congestion control is not being used. */
+#if( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+
+/* CUBIC reduces the window with a factor beta = 0.7 after a loss. */
+#define cubicBETA_NUMERATOR			( 7UL )
+#define cubicBETA_DENOMINATOR		( 10UL )
+
+/* The cubic function is calculated in units of 10 ms.  The time since the
+plateau of the function is limited to 10 seconds, so the calculation fits in
+32 bits. */
+#define cubicTIME_UNIT_MS			( 10UL )
+#define cubicMAX_TIME_UNITS			( 1000UL )
+
+/* The maximum number of segments between the window and the plateau, used to
+calculate K. */
+#define cubicMAX_K_SEGMENTS			( 1000UL )
+
+/*
+ * Grow the window by at most one MSS for every ACK (RFC 5681).  Returns
+ * pdTRUE when the connection is in slow start.
+ */
+static BaseType_t prvSlowStart( TCPWindow_t *pxWindow, uint32_t ulBytesAcked );
+
+/*
+ * Returns the integer cube root of 'ulValue'.
+ */
+static uint32_t prvCubeRoot( uint32_t ulValue );
+
+static void prvNewRenoOnAck( TCPWindow_t *pxWindow, uint32_t ulBytesAcked );
+static uint32_t prvNewRenoOnLoss( TCPWindow_t *pxWindow, uint32_t ulFlightSize );
+static void prvCubicOnAck( TCPWindow_t *pxWindow, uint32_t ulBytesAcked );
+static uint32_t prvCubicOnLoss( TCPWindow_t *pxWindow, uint32_t ulFlightSize );
+
+/*-----------------------------------------------------------*/
+
+const TCPCongestionOps_t xTCPCongestionNewReno =
+{
+	"newreno",
+	NULL,
+	prvNewRenoOnAck,
+	prvNewRenoOnLoss
+};
+
+const TCPCongestionOps_t xTCPCongestionCubic =
+{
+	"cubic",
+	NULL,
+	prvCubicOnAck,
+	prvCubicOnLoss
+};
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSlowStart( TCPWindow_t *pxWindow, uint32_t ulBytesAcked )
+{
+TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+BaseType_t xReturn;
+
+	if( pxCongestion->ulCWnd < pxCongestion->ulSSThresh )
+	{
+		pxCongestion->ulCWnd += FreeRTOS_min_uint32( ulBytesAcked, ( uint32_t ) pxWindow->usMSS );
+		xReturn = pdTRUE;
+	}
+	else
+	{
+		xReturn = pdFALSE;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvCubeRoot( uint32_t ulValue )
+{
+uint32_t ulRoot = 0UL, ulBit;
+BaseType_t xShift;
+
+	/* Determine the root bit by bit, starting with the most significant bit. */
+	for( xShift = 30; xShift >= 0; xShift -= 3 )
+	{
+		ulRoot <<= 1;
+		ulBit = ( 3UL * ulRoot * ( ulRoot + 1UL ) ) + 1UL;
+
+		if( ( ulValue >> xShift ) >= ulBit )
+		{
+			ulValue -= ulBit << xShift;
+			ulRoot++;
+		}
+	}
+
+	return ulRoot;
+}
+/*-----------------------------------------------------------*/
+
+static void prvNewRenoOnAck( TCPWindow_t *pxWindow, uint32_t ulBytesAcked )
+{
+TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+
+	if( prvSlowStart( pxWindow, ulBytesAcked ) == pdFALSE )
+	{
+		/* Congestion avoidance: grow by one MSS for every window of data that
+		has been acknowledged (appropriate byte counting, RFC 3465). */
+		pxCongestion->ulBytesAcked += ulBytesAcked;
+
+		if( pxCongestion->ulBytesAcked >= pxCongestion->ulCWnd )
+		{
+			pxCongestion->ulBytesAcked -= pxCongestion->ulCWnd;
+			pxCongestion->ulCWnd += ( uint32_t ) pxWindow->usMSS;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvNewRenoOnLoss( TCPWindow_t *pxWindow, uint32_t ulFlightSize )
+{
+	/* Half of the outstanding data, but at least 2 segments. */
+	return FreeRTOS_max_uint32( ulFlightSize / 2UL, 2UL * ( uint32_t ) pxWindow->usMSS );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCubicOnAck( TCPWindow_t *pxWindow, uint32_t ulBytesAcked )
+{
+TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+uint32_t ulMSS = ( uint32_t ) pxWindow->usMSS;
+uint32_t ulTime, ulOffset, ulDelta, ulTarget, ulBytesPerMSS;
+TickType_t xNow;
+
+	if( prvSlowStart( pxWindow, ulBytesAcked ) == pdFALSE )
+	{
+		xNow = xTaskGetTickCount();
+
+		if( pxCongestion->xEpochStart == ( TickType_t ) 0u )
+		{
+			/* The first ACK in congestion avoidance since the last loss:
+			determine the time K it will take to grow back to ulWMax, in units
+			of cubicTIME_UNIT_MS: K = cbrt( ( ulWMax - ulCWnd ) / C ), with
+			C = 0.4 segments per second cubed. */
+			pxCongestion->xEpochStart = ( xNow != ( TickType_t ) 0u ) ? xNow : ( TickType_t ) 1u;
+			pxCongestion->ulRenoCWnd = pxCongestion->ulCWnd;
+			pxCongestion->ulBytesAcked = 0UL;
+
+			if( pxCongestion->ulCWnd < pxCongestion->ulWMax )
+			{
+				ulDelta = FreeRTOS_min_uint32( ( pxCongestion->ulWMax - pxCongestion->ulCWnd ) / ulMSS, cubicMAX_K_SEGMENTS );
+				pxCongestion->ulK = prvCubeRoot( ulDelta * 2500000UL );
+				pxCongestion->ulOriginPoint = pxCongestion->ulWMax;
+			}
+			else
+			{
+				pxCongestion->ulK = 0UL;
+				pxCongestion->ulOriginPoint = pxCongestion->ulCWnd;
+			}
+		}
+
+		/* The window that NewReno would have reached by now, so CUBIC is never
+		slower than NewReno: grow by 3 * ( 1 - beta ) / ( 1 + beta ) = 9/17 MSS
+		for every window of data. */
+		pxCongestion->ulRenoCWnd += ( ( ( 9UL * ulMSS ) / 17UL ) * ulBytesAcked ) / pxCongestion->ulRenoCWnd;
+
+		/* The target is the value of the cubic function one SRTT from now. */
+		ulTime = ( ( ( uint32_t ) ( xNow - pxCongestion->xEpochStart ) * portTICK_PERIOD_MS ) + ( uint32_t ) pxWindow->lSRTT ) / cubicTIME_UNIT_MS;
+
+		if( ulTime < pxCongestion->ulK )
+		{
+			ulOffset = pxCongestion->ulK - ulTime;
+		}
+		else
+		{
+			ulOffset = ulTime - pxCongestion->ulK;
+		}
+
+		ulOffset = FreeRTOS_min_uint32( ulOffset, cubicMAX_TIME_UNITS );
+
+		/* C * t^3 segments, first in units of 1/1024 segment, then in bytes. */
+		ulDelta = ( ulOffset * ulOffset * ulOffset ) / 2441UL;
+		ulDelta = ( ( ulDelta >> 4 ) * ulMSS ) >> 6;
+
+		if( ulTime < pxCongestion->ulK )
+		{
+			ulTarget = pxCongestion->ulOriginPoint - FreeRTOS_min_uint32( ulDelta, pxCongestion->ulOriginPoint );
+		}
+		else
+		{
+			ulTarget = pxCongestion->ulOriginPoint + ulDelta;
+		}
+
+		/* Never grow faster than 1.5 times per round-trip. */
+		ulTarget = FreeRTOS_min_uint32( ulTarget, pxCongestion->ulCWnd + ( pxCongestion->ulCWnd / 2UL ) );
+
+		if( pxCongestion->ulRenoCWnd > pxCongestion->ulCWnd )
+		{
+			/* In the TCP-friendly region. */
+			pxCongestion->ulCWnd = pxCongestion->ulRenoCWnd;
+		}
+		else
+		{
+			/* Grow by one MSS after 'ulBytesPerMSS' bytes have been
+			acknowledged, so the target is reached after one round-trip. */
+			if( ulTarget > pxCongestion->ulCWnd )
+			{
+				ulBytesPerMSS = ( pxCongestion->ulCWnd / ( ulTarget - pxCongestion->ulCWnd ) ) * ulMSS;
+			}
+			else
+			{
+				/* Close to the plateau: grow very slowly. */
+				ulBytesPerMSS = 100UL * pxCongestion->ulCWnd;
+			}
+
+			pxCongestion->ulBytesAcked += ulBytesAcked;
+
+			if( pxCongestion->ulBytesAcked >= ulBytesPerMSS )
+			{
+				pxCongestion->ulBytesAcked = 0UL;
+				pxCongestion->ulCWnd += ulMSS;
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvCubicOnLoss( TCPWindow_t *pxWindow, uint32_t ulFlightSize )
+{
+TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+
+	( void ) ulFlightSize;
+
+	/* A new epoch starts with the next ACK in congestion avoidance. */
+	pxCongestion->xEpochStart = ( TickType_t ) 0u;
+
+	if( pxCongestion->ulCWnd < pxCongestion->ulWMax )
+	{
+		/* Fast convergence: the previous plateau wasn't reached, release some
+		bandwidth for new flows by lowering the plateau to ( 1 + beta ) / 2 of
+		the window. */
+		pxCongestion->ulWMax = ( pxCongestion->ulCWnd / ( 2UL * cubicBETA_DENOMINATOR ) ) * ( cubicBETA_DENOMINATOR + cubicBETA_NUMERATOR );
+	}
+	else
+	{
+		pxCongestion->ulWMax = pxCongestion->ulCWnd;
+	}
+
+	return FreeRTOS_max_uint32( ( pxCongestion->ulCWnd / cubicBETA_DENOMINATOR ) * cubicBETA_NUMERATOR, 2UL * ( uint32_t ) pxWindow->usMSS );
+}
+/*-----------------------------------------------------------*/
+
+#endif /* ( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 ) */
@@ -54,6 +54,7 @@
 #include "NetworkBufferManagement.h"
 #include "FreeRTOS_ARP.h"
 #include "FreeRTOS_TCP_WIN.h"
+#include "FreeRTOS_Routing.h"
 
 
 /* Just make sure the contents doesn't get compiled if TCP is not enabled. */
@@ -98,7 +99,19 @@ the defined MTU size can contain at least a complete TCP packet. */
 #define TCP_OPT_MSS_LEN			4u   /* Length of TCP MSS option. */
 #define TCP_OPT_WSOPT_LEN		3u   /* Length of TCP WSOPT option. */
 
-#define TCP_OPT_TIMESTAMP_LEN	10	/* fixed length of the time-stamp option */
+#define TCP_OPT_TIMESTAMP_LEN	10u	/* fixed length of the time-stamp option */
+#define TCP_OPT_TIMESTAMP_SPACE	12u	/* Two NOP's followed by the time-stamp option */
+
+#if( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+	/* The clock used for the time-stamps (TSval) runs in ms. */
+	#define tcpTIMESTAMP_CLOCK()				( ( uint32_t ) ( xTaskGetTickCount() * portTICK_PERIOD_MS ) )
+
+	/* Once both parties agreed to use time-stamps, every segment carries them. */
+	#define tcpTIMESTAMP_OPTIONS_LENGTH( pxSocket )	\
+		( ( ( pxSocket )->u.xTCP.bits.bTimeStamps != pdFALSE_UNSIGNED ) ? TCP_OPT_TIMESTAMP_SPACE : 0u )
+#else
+	#define tcpTIMESTAMP_OPTIONS_LENGTH( pxSocket )	0u
+#endif
 
 #ifndef ipconfigTCP_ACK_EARLIER_PACKET
 	#define ipconfigTCP_ACK_EARLIER_PACKET		1
@@ -234,6 +247,21 @@ static void prvCheckOptions( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescripto
  */
 static UBaseType_t prvSetSynAckOptions( FreeRTOS_Socket_t *pxSocket, TCPPacket_t * pxTCPPacket );
 
+#if( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+	/*
+	 * Write two NOP's and the time-stamp option to 'pucOptions', and return
+	 * the number of bytes written.
+	 */
+	static UBaseType_t prvSetTimeStampOption( FreeRTOS_Socket_t *pxSocket, uint8_t *pucOptions );
+
+	/*
+	 * A time-stamp option has been received: remember the value that will be
+	 * echoed, and measure the round trip time if new data was acknowledged.
+	 */
+	static void prvCheckTimeStamp( FreeRTOS_Socket_t *pxSocket, const TCPHeader_t *pxTCPHeader,
+		uint32_t ulPreviousUnacked, uint32_t ulTSValue, uint32_t ulTSEcho );
+#endif /* ipconfigUSE_TCP_TIMESTAMPS */
+
 /*
  * For anti-hang protection and TCP keep-alive messages.  Called in two places:
  * after receiving a packet and after a state change.  The socket's alive timer
@@ -301,6 +329,15 @@ static BaseType_t prvHandleEstablished( FreeRTOS_Socket_t *pxSocket, NetworkBuff
 static BaseType_t prvSendData( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t **ppxNetworkBuffer,
 	uint32_t ulReceiveLength, BaseType_t xSendLength );
 
+#if( ipconfigUSE_TCP_WIN == 1 ) && ( ( ipconfigTCP_ACK_EVERY_N_SEGMENTS > 0 ) || ( ipconfigTCP_QUICKACK_IDLE_MS > 0 ) )
+	/*
+	 * Called from prvSendData() for every data segment received.  Returns
+	 * pdTRUE when the ACK policy says that the segment must be acknowledged
+	 * without delay.
+	 */
+	static BaseType_t prvTCPAckImmediately( FreeRTOS_Socket_t *pxSocket );
+#endif
+
 /*
  * The heart of all: check incoming packet for valid data and acks and do what
  * is necessary in each state.
@@ -331,6 +368,11 @@ static BaseType_t prvTCPSendReset( NetworkBufferDescriptor_t *pxNetworkBuffer );
  */
 static void prvSocketSetMSS( FreeRTOS_Socket_t *pxSocket );
 
+/*
+ * Return the MSS to be used with a peer, 'ulRemoteIP' is host-endian.
+ */
+static uint32_t prvGetMSSForPeer( uint32_t ulRemoteIP );
+
 /*
  * Return either a newly created socket, or the current socket in a connected
  * state (depends on the 'bReuseSocket' flag).
@@ -343,6 +385,28 @@ static FreeRTOS_Socket_t *prvHandleListen( FreeRTOS_Socket_t *pxSocket, NetworkB
  */
 static BaseType_t prvTCPSocketCopy( FreeRTOS_Socket_t *pxNewSocket, FreeRTOS_Socket_t *pxSocket );
 
+#if( ipconfigTCP_SYN_CACHE_SIZE > 0 )
+	/*
+	 * Called for a SYN to a listening socket that creates a new socket for
+	 * every connection.  The request is stored in the SYN cache, or encoded in
+	 * a SYN cookie, and answered with a SYN+ACK.
+	 */
+	static void prvSynCacheHandleSyn( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxNetworkBuffer );
+
+	/*
+	 * Called for an ACK to a listening socket.  If it completes a handshake
+	 * that was started by prvSynCacheHandleSyn(), a new socket is returned in
+	 * the eSYN_RECEIVED state.  Otherwise NULL is returned.
+	 */
+	static FreeRTOS_Socket_t *prvSynCacheAccept( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxNetworkBuffer );
+
+	/*
+	 * Called for a RST to a listening socket: forget the connection request
+	 * that it refers to.
+	 */
+	static void prvSynCacheReset( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxNetworkBuffer );
+#endif /* ipconfigTCP_SYN_CACHE_SIZE */
+
 /*
  * prvTCPStatusAgeCheck() will see if the socket has been in a non-connected
  * state for too long.  If so, the socket will be closed, and -1 will be
@@ -355,12 +419,39 @@ static BaseType_t prvTCPSocketCopy( FreeRTOS_Socket_t *pxNewSocket, FreeRTOS_Soc
 static NetworkBufferDescriptor_t *prvTCPBufferResize( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxNetworkBuffer,
 	int32_t lDataLen, UBaseType_t uxOptionsLength );
 
+/*
+ * When the driver cuts long TCP frames into segments, fetch more segments that
+ * directly follow the 'ulDataLength' bytes that are about to be sent.  Returns
+ * the number of bytes added.
+ */
+#if( ( ipconfigUSE_DRIVER_OFFLOADS != 0 ) && ( ipconfigUSE_TCP_WIN == 1 ) )
+	static int32_t prvTCPSegmentationOffload( FreeRTOS_Socket_t *pxSocket, uint32_t ulDataLength, UBaseType_t uxOptionsLength );
+#endif
+
+#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+	/*
+	 * 'ulCount' bytes at the tail of txStream have been acknowledged: release
+	 * the buffers of the application that only held such bytes.
+	 */
+	static void prvTCPTxBuffersAcked( FreeRTOS_Socket_t *pxSocket, uint32_t ulCount );
+
+	/*
+	 * Returns pdTRUE if the interface that will send the next packet of the
+	 * socket can gather a frame from a header buffer and a chained payload.
+	 */
+	static BaseType_t prvTCPCanGather( FreeRTOS_Socket_t *pxSocket );
+#endif
+
 #if( ( ipconfigHAS_DEBUG_PRINTF != 0 ) || ( ipconfigHAS_PRINTF != 0 ) )
 	const char *FreeRTOS_GetTCPStateName( UBaseType_t ulState );
 #endif
 
 #if( ipconfigUSE_TCP_WIN != 0 )
-	static uint8_t prvWinScaleFactor( FreeRTOS_Socket_t *pxSocket );
+	/*
+	 * The shift that makes a reception window of 'uxRxWinSize' segments of
+	 * 'uxMSS' bytes fit in the 16-bit window field.
+	 */
+	static uint8_t prvWinScaleFactor( size_t uxRxWinSize, size_t uxMSS );
 #endif
 
 /*
@@ -481,6 +572,27 @@ BaseType_t xTCPSocketCheck( FreeRTOS_Socket_t *pxSocket )
 BaseType_t xResult = 0;
 BaseType_t xReady = pdFALSE;
 
+	#if( ipconfigTCP_RX_COALESCE_BYTES > 0 )
+	{
+		if( pxSocket->u.xTCP.bits.bRxWakePending != pdFALSE_UNSIGNED )
+		{
+			/* Data was stored without waking up the reader, hoping that more
+			would follow.  Don't let it wait any longer. */
+			pxSocket->u.xTCP.bits.bRxWakePending = pdFALSE_UNSIGNED;
+			pxSocket->xEventBits |= eSOCKET_RECEIVE;
+
+			#if ipconfigSUPPORT_SELECT_FUNCTION == 1
+			{
+				if( ( pxSocket->xSelectBits & eSELECT_READ ) != 0 )
+				{
+					pxSocket->xEventBits |= ( eSELECT_READ << SOCKET_EVENT_BIT_COUNT );
+				}
+			}
+			#endif
+		}
+	}
+	#endif /* ipconfigTCP_RX_COALESCE_BYTES */
+
 	if( ( pxSocket->u.xTCP.ucTCPState >= eESTABLISHED ) && ( pxSocket->u.xTCP.txStream != NULL ) )
 	{
 		/* The API FreeRTOS_send() might have added data to the TX stream.  Add
@@ -706,6 +818,12 @@ NetworkBufferDescriptor_t xTempBuffer;
 			xTempBuffer.pxNextBuffer = NULL;
 		}
 		#endif
+		#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+		{
+			xTempBuffer.pxPayloadBuffer = NULL;
+			xTempBuffer.uxPayloadLength = 0U;
+		}
+		#endif
 		xTempBuffer.pucEthernetBuffer = pxSocket->u.xTCP.xPacket.u.ucLastPacket;
 		xTempBuffer.xDataLength = sizeof( pxSocket->u.xTCP.xPacket.u.ucLastPacket );
 		xReleaseAfterSend = pdFALSE;
@@ -844,8 +962,9 @@ NetworkBufferDescriptor_t xTempBuffer;
 				if( ( pxTCPPacket->xTCPHeader.ucTCPFlags & ( uint8_t ) ipTCP_FLAG_FIN ) != 0u )
 				{
 					/* Suppress FIN in case this packet carries earlier data to be
-					retransmitted. */
-					uint32_t ulDataLen = ( uint32_t ) ( ulLen - ( ipSIZE_OF_TCP_HEADER + ipSIZE_OF_IPv4_HEADER ) );
+					retransmitted.  Data packets may carry time-stamp options, so
+					use the actual length of the TCP header. */
+					uint32_t ulDataLen = ( uint32_t ) ( ulLen - ( ( ( uint32_t ) ( pxTCPPacket->xTCPHeader.ucTCPOffset >> 4 ) << 2 ) + ipSIZE_OF_IPv4_HEADER ) );
 					if( ( pxTCPWindow->ulOurSequenceNumber + ulDataLen ) != pxTCPWindow->tx.ulFINSequenceNumber )
 					{
 						pxTCPPacket->xTCPHeader.ucTCPFlags &= ( ( uint8_t ) ~ipTCP_FLAG_FIN );
@@ -859,6 +978,13 @@ NetworkBufferDescriptor_t xTempBuffer;
 
 			/* Tell which sequence number is expected next time */
 			pxTCPPacket->xTCPHeader.ulAckNr = FreeRTOS_htonl( pxTCPWindow->rx.ulCurrentSequenceNumber );
+
+			#if( ipconfigTCP_ACK_EVERY_N_SEGMENTS > 0 )
+			{
+				/* All data received so far is being acknowledged. */
+				pxSocket->u.xTCP.ucUnackedSegments = 0u;
+			}
+			#endif
 		}
 		else
 		{
@@ -869,6 +995,15 @@ NetworkBufferDescriptor_t xTempBuffer;
 
 		pxIPHeader->ucTimeToLive		   = ( uint8_t ) ipconfigTCP_TIME_TO_LIVE;
 		pxIPHeader->usLength			   = FreeRTOS_htons( ulLen );
+		#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+		{
+			/* The destination field holds the local address of the connection,
+			which determines the end-point that sends the packet.  For sockets
+			it was set by prvTCPPrepareConnect() or copied from the SYN. */
+			ulSourceAddress = pxIPHeader->ulDestinationIPAddress;
+			pxNetworkBuffer->pxEndPoint = FreeRTOS_FindEndPointOnIP( ulSourceAddress );
+		}
+		#else
 		if( ( pxSocket == NULL ) || ( *ipLOCAL_IP_ADDRESS_POINTER == 0ul ) )
 		{
 			/* When pxSocket is NULL, this function is called by prvTCPSendReset()
@@ -881,6 +1016,7 @@ NetworkBufferDescriptor_t xTempBuffer;
 		{
 			ulSourceAddress = *ipLOCAL_IP_ADDRESS_POINTER;
 		}
+		#endif /* ipconfigUSE_MULTI_INTERFACE */
 		pxIPHeader->ulDestinationIPAddress = pxIPHeader->ulSourceIPAddress;
 		pxIPHeader->ulSourceIPAddress = ulSourceAddress;
 		vFlip_16( pxTCPPacket->xTCPHeader.usSourcePort, pxTCPPacket->xTCPHeader.usDestinationPort );
@@ -890,7 +1026,27 @@ NetworkBufferDescriptor_t xTempBuffer;
 		usPacketIdentifier++;
 		pxIPHeader->usFragmentOffset = 0u;
 
+		#if( ipconfigUSE_DRIVER_OFFLOADS != 0 )
+		{
+			if( ulLen > ( uint32_t ) ipconfigNETWORK_MTU )
+			{
+				/* Only a socket sends frames this long, see
+				prvTCPSegmentationOffload().  The driver cuts them along the
+				segments of the window. */
+				pxNetworkBuffer->usSegmentSize = pxSocket->u.xTCP.xTCPWindow.usMSS;
+			}
+			else
+			{
+				pxNetworkBuffer->usSegmentSize = 0U;
+			}
+		}
+		#endif /* ipconfigUSE_DRIVER_OFFLOADS */
+
 		#if( ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM == 0 )
+		/* A driver that segments a long frame sets the checksums of each
+		segment, and so does a driver that gathers a chained payload. */
+		if( ( ulLen <= ( uint32_t ) ipconfigNETWORK_MTU ) && ( ipHAS_OFFLOAD( pxNetworkBuffer, ipOFFLOAD_TX_CHECKSUM ) == pdFALSE ) &&
+			( ipIS_CHAINED( pxNetworkBuffer ) == pdFALSE ) )
 		{
 			/* calculate the IP header checksum, in case the driver won't do that. */
 			pxIPHeader->usHeaderChecksum = 0x00u;
@@ -916,6 +1072,13 @@ NetworkBufferDescriptor_t xTempBuffer;
 		/* Important: tell NIC driver how many bytes must be sent. */
 		pxNetworkBuffer->xDataLength = ulLen + ipSIZE_OF_ETH_HEADER;
 
+		#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+		{
+			/* 'xDataLength' only counts the bytes in the header buffer. */
+			pxNetworkBuffer->xDataLength -= pxNetworkBuffer->uxPayloadLength;
+		}
+		#endif
+
 		/* Fill in the destination MAC addresses. */
 		memcpy( ( void * ) &( pxEthernetHeader->xDestinationAddress ), ( void * ) &( pxEthernetHeader->xSourceAddress ),
 			sizeof( pxEthernetHeader->xDestinationAddress ) );
@@ -925,7 +1088,8 @@ NetworkBufferDescriptor_t xTempBuffer;
 
 		#if defined( ipconfigETHERNET_MINIMUM_PACKET_BYTES )
 		{
-			if( pxNetworkBuffer->xDataLength < ( size_t ) ipconfigETHERNET_MINIMUM_PACKET_BYTES )
+			/* A chained frame is padded by the driver. */
+			if( ( pxNetworkBuffer->xDataLength < ( size_t ) ipconfigETHERNET_MINIMUM_PACKET_BYTES ) && ( ipIS_CHAINED( pxNetworkBuffer ) == pdFALSE ) )
 			{
 			BaseType_t xIndex;
 
@@ -938,15 +1102,49 @@ NetworkBufferDescriptor_t xTempBuffer;
 		}
 		#endif
 
+		ipMIB_INCREMENT( ulTCPOutSegs );
+		#if( ipconfigUSE_MIB_COUNTERS != 0 )
+		{
+			if( ( pxTCPPacket->xTCPHeader.ucTCPFlags & ( uint8_t ) ipTCP_FLAG_RST ) != 0u )
+			{
+				ipMIB_INCREMENT( ulTCPOutRsts );
+			}
+		}
+		#endif /* ipconfigUSE_MIB_COUNTERS */
+
+		#if( ipconfigUSE_TCP_INFO != 0 )
+		{
+			if( pxSocket != NULL )
+			{
+				pxSocket->u.xTCP.xTCPWindow.ulSegmentsOut++;
+			}
+		}
+		#endif /* ipconfigUSE_TCP_INFO */
+
 		/* Send! */
+		ipCAPTURE_SENT( pxNetworkBuffer );
 		xNetworkInterfaceOutput( pxNetworkBuffer, xReleaseAfterSend );
 
 		if( xReleaseAfterSend == pdFALSE )
 		{
+			#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+			{
+				/* The driver has sent the payload, the buffer will be used
+				again. */
+				vNetworkBufferUnchain( pxNetworkBuffer );
+			}
+			#endif
+
 			/* Swap-back some fields, as pxBuffer probably points to a socket field
 			containing the packet header. */
 			vFlip_16( pxTCPPacket->xTCPHeader.usSourcePort, pxTCPPacket->xTCPHeader.usDestinationPort);
 			pxTCPPacket->xIPHeader.ulSourceIPAddress = pxTCPPacket->xIPHeader.ulDestinationIPAddress;
+			#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+			{
+				/* The local address is needed again for the next packet. */
+				pxTCPPacket->xIPHeader.ulDestinationIPAddress = ulSourceAddress;
+			}
+			#endif /* ipconfigUSE_MULTI_INTERFACE */
 			memcpy( pxEthernetHeader->xSourceAddress.ucBytes, pxEthernetHeader->xDestinationAddress.ucBytes, ( size_t ) ipMAC_ADDRESS_LENGTH_BYTES );
 		}
 		else
@@ -996,6 +1194,7 @@ uint32_t ulRemoteIP;
 MACAddress_t xEthAddress;
 BaseType_t xReturn = pdTRUE;
 uint32_t ulInitialSequenceNumber = 0;
+uint32_t ulLocalIP = *ipLOCAL_IP_ADDRESS_POINTER;
 
 	#if( ipconfigHAS_PRINTF != 0 )
 	{
@@ -1007,7 +1206,23 @@ uint32_t ulInitialSequenceNumber = 0;
 	ulRemoteIP = FreeRTOS_htonl( pxSocket->u.xTCP.ulRemoteIP );
 
 	/* Determine the ARP cache status for the requested IP address. */
-	eReturned = eARPGetCacheEntry( &( ulRemoteIP ), &( xEthAddress ) );
+	#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+	{
+	NetworkEndPoint_t *pxEndPoint = NULL;
+
+		/* The connection will use the address of the end-point through
+		which the peer is reached. */
+		eReturned = eARPGetCacheEntryOnEndPoint( &( ulRemoteIP ), &( xEthAddress ), &pxEndPoint );
+		if( pxEndPoint != NULL )
+		{
+			ulLocalIP = pxEndPoint->ulIPAddress;
+		}
+	}
+	#else
+	{
+		eReturned = eARPGetCacheEntry( &( ulRemoteIP ), &( xEthAddress ) );
+	}
+	#endif /* ipconfigUSE_MULTI_INTERFACE */
 
 	switch( eReturned )
 	{
@@ -1039,7 +1254,7 @@ uint32_t ulInitialSequenceNumber = 0;
 	if( xReturn != pdFALSE )
 	{
 		/* Get a difficult-to-predict initial sequence number for this 4-tuple. */
-		ulInitialSequenceNumber = ulApplicationGetNextSequenceNumber( *ipLOCAL_IP_ADDRESS_POINTER,
+		ulInitialSequenceNumber = ulApplicationGetNextSequenceNumber( ulLocalIP,
 																	  pxSocket->usLocalPort,
 																	  pxSocket->u.xTCP.ulRemoteIP,
 																	  pxSocket->u.xTCP.usRemotePort );
@@ -1064,6 +1279,14 @@ uint32_t ulInitialSequenceNumber = 0;
 		/* And remember that the connect/SYN data are prepared. */
 		pxSocket->u.xTCP.bits.bConnPrepared = pdTRUE_UNSIGNED;
 
+		#if( ipconfigTCP_HASH_TABLE_SIZE > 0 )
+		{
+			/* FreeRTOS_connect() set the remote address from the API task,
+			file the socket in the connection table before the SYN is sent. */
+			vSocketTCPHashUpdate( pxSocket );
+		}
+		#endif /* ipconfigTCP_HASH_TABLE_SIZE */
+
 		/* Now that the Ethernet address is known, the initial packet can be
 		prepared. */
 		memset( pxSocket->u.xTCP.xPacket.u.ucLastPacket, '\0', sizeof( pxSocket->u.xTCP.xPacket.u.ucLastPacket ) );
@@ -1083,7 +1306,7 @@ uint32_t ulInitialSequenceNumber = 0;
 
 		/* Addresses and ports will be stored swapped because prvTCPReturnPacket
 		will swap them back while replying. */
-		pxIPHeader->ulDestinationIPAddress = *ipLOCAL_IP_ADDRESS_POINTER;
+		pxIPHeader->ulDestinationIPAddress = ulLocalIP;
 		pxIPHeader->ulSourceIPAddress = FreeRTOS_htonl( pxSocket->u.xTCP.ulRemoteIP );
 
 		pxTCPPacket->xTCPHeader.usSourcePort = FreeRTOS_htons( pxSocket->u.xTCP.usRemotePort );
@@ -1152,6 +1375,9 @@ const unsigned char *pucPtr;
 const unsigned char *pucLast;
 TCPWindow_t *pxTCPWindow;
 UBaseType_t uxNewMSS;
+#if( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+	uint32_t ulPreviousUnacked;
+#endif
 
 	pxTCPPacket = ( TCPPacket_t * ) ( pxNetworkBuffer->pucEthernetBuffer );
 	pxTCPHeader = &pxTCPPacket->xTCPHeader;
@@ -1161,6 +1387,14 @@ UBaseType_t uxNewMSS;
 	pucLast = pucPtr + (((pxTCPHeader->ucTCPOffset >> 4) - 5) << 2);
 	pxTCPWindow = &pxSocket->u.xTCP.xTCPWindow;
 
+	#if( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+	{
+		/* A SACK option may advance the transmission window before the
+		time-stamp option is seen. */
+		ulPreviousUnacked = pxTCPWindow->tx.ulCurrentSequenceNumber;
+	}
+	#endif
+
 	/* Validate options size calculation. */
 	if( pucLast > ( pxNetworkBuffer->pucEthernetBuffer + pxNetworkBuffer->xDataLength ) )
 	{
@@ -1255,6 +1489,19 @@ UBaseType_t uxNewMSS;
 				pucPtr += TCP_OPT_MSS_LEN;
 			#endif	/* ipconfigUSE_TCP_WIN != 1 */
 		}
+#if( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+		else if( pucPtr[ 0 ] == TCP_OPT_TIMESTAMP )
+		{
+			/* Confirm that the option fits in the remaining buffer space. */
+			if( ( xRemainingOptionsBytes < TCP_OPT_TIMESTAMP_LEN ) || ( pucPtr[ 1 ] != TCP_OPT_TIMESTAMP_LEN ) )
+			{
+				break;
+			}
+
+			prvCheckTimeStamp( pxSocket, pxTCPHeader, ulPreviousUnacked, ulChar2u32( pucPtr + 2 ), ulChar2u32( pucPtr + 6 ) );
+			pucPtr += TCP_OPT_TIMESTAMP_LEN;
+		}
+#endif	/* ipconfigUSE_TCP_TIMESTAMPS */
 		else
 		{
 			/* All other options have a length field, so that we easily
@@ -1287,6 +1534,12 @@ UBaseType_t uxNewMSS;
 						Advance the tail pointer in txStream. */
 						if( ( pxSocket->u.xTCP.txStream  != NULL ) && ( ulCount > 0 ) )
 						{
+							#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+							{
+								prvTCPTxBuffersAcked( pxSocket, ulCount );
+							}
+							#endif
+
 							/* Just advancing the tail index, 'ulCount' bytes have been confirmed. */
 							uxStreamBufferGet( pxSocket->u.xTCP.txStream, 0, NULL, ( size_t ) ulCount, pdFALSE );
 							pxSocket->xEventBits |= eSOCKET_SEND;
@@ -1329,13 +1582,13 @@ UBaseType_t uxNewMSS;
 
 #if( ipconfigUSE_TCP_WIN != 0 )
 
-	static uint8_t prvWinScaleFactor( FreeRTOS_Socket_t *pxSocket )
+	static uint8_t prvWinScaleFactor( size_t uxRxWinSize, size_t uxMSS )
 	{
 	size_t uxWinSize;
 	uint8_t ucFactor;
 
 		/* 'xTCP.uxRxWinSize' is the size of the reception window in units of MSS. */
-		uxWinSize = pxSocket->u.xTCP.uxRxWinSize * ( size_t ) pxSocket->u.xTCP.usInitMSS;
+		uxWinSize = uxRxWinSize * uxMSS;
 		ucFactor = 0u;
 		while( uxWinSize > 0xfffful )
 		{
@@ -1345,8 +1598,8 @@ UBaseType_t uxNewMSS;
 		}
 
 		FreeRTOS_debug_printf( ( "prvWinScaleFactor: uxRxWinSize %lu MSS %lu Factor %u\n",
-			pxSocket->u.xTCP.uxRxWinSize,
-			pxSocket->u.xTCP.usInitMSS,
+			uxRxWinSize,
+			uxMSS,
 			ucFactor ) );
 
 		return ucFactor;
@@ -1375,7 +1628,7 @@ UBaseType_t uxOptionsLength;
 
 	#if( ipconfigUSE_TCP_WIN != 0 )
 	{
-		pxSocket->u.xTCP.ucMyWinScaleFactor = prvWinScaleFactor( pxSocket );
+		pxSocket->u.xTCP.ucMyWinScaleFactor = prvWinScaleFactor( pxSocket->u.xTCP.uxRxWinSize, ( size_t ) pxSocket->u.xTCP.usInitMSS );
 
 		pxTCPHeader->ucOptdata[ 4 ] = TCP_OPT_NOOP;
 		pxTCPHeader->ucOptdata[ 5 ] = ( uint8_t ) ( TCP_OPT_WSOPT );
@@ -1401,10 +1654,108 @@ UBaseType_t uxOptionsLength;
 		pxTCPHeader->ucOptdata[ uxOptionsLength + 3 ] = 2;	/* 2: length of this option. */
 		uxOptionsLength += 4u;
 
+		#if( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+		{
+			if( pxSocket->u.xTCP.ucTCPState == eCONNECT_SYN )
+			{
+				/* Time-stamps will be used if the SYN+ACK of the peer carries
+				them as well. */
+				pxSocket->u.xTCP.bits.bTimeStamps = pdFALSE_UNSIGNED;
+				pxSocket->u.xTCP.ulTSRecent = 0u;
+			}
+
+			/* Offer time-stamps in a SYN, or accept them in a SYN+ACK. */
+			if( ( pxSocket->u.xTCP.ucTCPState == eCONNECT_SYN ) || ( pxSocket->u.xTCP.bits.bTimeStamps != pdFALSE_UNSIGNED ) )
+			{
+				uxOptionsLength += prvSetTimeStampOption( pxSocket, &( pxTCPHeader->ucOptdata[ uxOptionsLength ] ) );
+			}
+		}
+		#endif /* ipconfigUSE_TCP_TIMESTAMPS */
+
 		return uxOptionsLength; /* bytes, not words. */
 	}
 	#endif	/* ipconfigUSE_TCP_WIN == 0 */
 }
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+
+	static UBaseType_t prvSetTimeStampOption( FreeRTOS_Socket_t *pxSocket, uint8_t *pucOptions )
+	{
+	uint32_t ulValue;
+
+		/* The NOP's make sure that the time-stamps are 32-bit aligned. */
+		pucOptions[ 0 ] = ( uint8_t ) TCP_OPT_NOOP;
+		pucOptions[ 1 ] = ( uint8_t ) TCP_OPT_NOOP;
+		pucOptions[ 2 ] = ( uint8_t ) TCP_OPT_TIMESTAMP;
+		pucOptions[ 3 ] = ( uint8_t ) TCP_OPT_TIMESTAMP_LEN;
+
+		/* TSval: the current time. */
+		ulValue = FreeRTOS_htonl( tcpTIMESTAMP_CLOCK() );
+		memcpy( pucOptions + 4, &ulValue, sizeof( ulValue ) );
+
+		/* TSecr: the most recent time-stamp received from the peer. */
+		ulValue = FreeRTOS_htonl( pxSocket->u.xTCP.ulTSRecent );
+		memcpy( pucOptions + 8, &ulValue, sizeof( ulValue ) );
+
+		return TCP_OPT_TIMESTAMP_SPACE;
+	}
+
+#endif /* ipconfigUSE_TCP_TIMESTAMPS */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+
+	static void prvCheckTimeStamp( FreeRTOS_Socket_t *pxSocket, const TCPHeader_t *pxTCPHeader,
+		uint32_t ulPreviousUnacked, uint32_t ulTSValue, uint32_t ulTSEcho )
+	{
+	TCPWindow_t *pxTCPWindow = &pxSocket->u.xTCP.xTCPWindow;
+	uint32_t ulSequenceNumber = FreeRTOS_ntohl( pxTCPHeader->ulSequenceNumber );
+	uint32_t ulAckNumber = FreeRTOS_ntohl( pxTCPHeader->ulAckNr );
+	uint32_t ulRoundTripTime;
+
+		if( ( pxTCPHeader->ucTCPFlags & ipTCP_FLAG_SYN ) != 0u )
+		{
+			/* The peer offers time-stamps in its SYN, or it accepts the offer
+			in its SYN+ACK. */
+			pxSocket->u.xTCP.bits.bTimeStamps = pdTRUE_UNSIGNED;
+			pxSocket->u.xTCP.ulTSRecent = ulTSValue;
+		}
+		else if( pxSocket->u.xTCP.bits.bTimeStamps != pdFALSE_UNSIGNED )
+		{
+			/* Echo the time-stamp of the oldest segment that is not yet
+			acknowledged.  A segment beyond the expected sequence number, or a
+			time-stamp that is older than the current one, is ignored
+			(RFC 7323, section 4.3). */
+			if( ( ( int32_t ) ( ulSequenceNumber - pxTCPWindow->rx.ulCurrentSequenceNumber ) <= 0 ) &&
+				( ( int32_t ) ( ulTSValue - pxSocket->u.xTCP.ulTSRecent ) >= 0 ) )
+			{
+				pxSocket->u.xTCP.ulTSRecent = ulTSValue;
+			}
+
+			/* An ACK that confirms new data echoes the time at which the
+			segment that caused it was sent.  This is a valid measurement of
+			the round trip time, also when the segment was retransmitted. */
+			if( ( ( pxTCPHeader->ucTCPFlags & ipTCP_FLAG_ACK ) != 0u ) &&
+				( ( int32_t ) ( ulAckNumber - ulPreviousUnacked ) > 0 ) &&
+				( ( int32_t ) ( ulAckNumber - pxTCPWindow->tx.ulHighestSequenceNumber ) <= 0 ) )
+			{
+				ulRoundTripTime = tcpTIMESTAMP_CLOCK() - ulTSEcho;
+
+				if( ulRoundTripTime <= ( uint32_t ) ipconfigTCP_RTO_MAX_MS )
+				{
+					vTCPWindowUpdateRTT( pxTCPWindow, ( int32_t ) ulRoundTripTime );
+				}
+			}
+		}
+		else
+		{
+			/* Time-stamps were not negotiated, ignore the option. */
+		}
+	}
+
+#endif /* ipconfigUSE_TCP_TIMESTAMPS */
+/*-----------------------------------------------------------*/
 
 /*
  * For anti-hanging protection and TCP keep-alive messages.  Called in two
@@ -1432,6 +1783,108 @@ static void prvTCPTouchSocket( FreeRTOS_Socket_t *pxSocket )
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+
+	static void prvTCPTxBuffersAcked( FreeRTOS_Socket_t *pxSocket, uint32_t ulCount )
+	{
+	NetworkBufferDescriptor_t *pxBuffer, *pxHead;
+	size_t uxBufferOffset;
+
+		do
+		{
+			pxBuffer = NULL;
+
+			/* FreeRTOS_send() may be adding to the list in another task, so it
+			is only read with the scheduler suspended. */
+			vTaskSuspendAll();
+			{
+				if( listLIST_IS_EMPTY( &( pxSocket->u.xTCP.xTxBufferList ) ) == pdFALSE )
+				{
+					pxHead = ( NetworkBufferDescriptor_t * ) listGET_OWNER_OF_HEAD_ENTRY( &( pxSocket->u.xTCP.xTxBufferList ) );
+					uxBufferOffset = uxStreamBufferDistance( pxSocket->u.xTCP.txStream, pxSocket->u.xTCP.txStream->uxTail,
+						pxHead->uxStreamOffset );
+
+					/* Only remove it when all its bytes have been
+					acknowledged. */
+					if( ( uxBufferOffset + pxHead->xDataLength ) <= ( size_t ) ulCount )
+					{
+						( void ) uxListRemove( &( pxHead->xBufferListItem ) );
+						pxBuffer = pxHead;
+					}
+				}
+			}
+			( void ) xTaskResumeAll();
+
+			if( pxBuffer != NULL )
+			{
+				/* Frames that are still being sent keep their own reference. */
+				vReleaseNetworkBufferAndDescriptor( pxBuffer );
+			}
+		} while( pxBuffer != NULL );
+	}
+	/*-----------------------------------------------------------*/
+
+	void vTCPReleaseTxBuffers( FreeRTOS_Socket_t *pxSocket )
+	{
+	NetworkBufferDescriptor_t *pxBuffer;
+
+		do
+		{
+			pxBuffer = NULL;
+
+			vTaskSuspendAll();
+			{
+				if( listLIST_IS_EMPTY( &( pxSocket->u.xTCP.xTxBufferList ) ) == pdFALSE )
+				{
+					pxBuffer = ( NetworkBufferDescriptor_t * ) listGET_OWNER_OF_HEAD_ENTRY( &( pxSocket->u.xTCP.xTxBufferList ) );
+					( void ) uxListRemove( &( pxBuffer->xBufferListItem ) );
+				}
+			}
+			( void ) xTaskResumeAll();
+
+			if( pxBuffer != NULL )
+			{
+				vReleaseNetworkBufferAndDescriptor( pxBuffer );
+			}
+		} while( pxBuffer != NULL );
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvTCPCanGather( FreeRTOS_Socket_t *pxSocket )
+	{
+	UBaseType_t uxOffloads;
+
+		#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+		{
+		const TCPPacket_t *pxTCPPacket = ( const TCPPacket_t * ) pxSocket->u.xTCP.xPacket.u.ucLastPacket;
+		const NetworkEndPoint_t *pxEndPoint;
+
+			/* The destination field holds the local address of the connection,
+			see prvTCPReturnPacket(). */
+			pxEndPoint = FreeRTOS_FindEndPointOnIP( pxTCPPacket->xIPHeader.ulDestinationIPAddress );
+
+			if( ( pxEndPoint != NULL ) && ( pxEndPoint->pxNetworkInterface != NULL ) )
+			{
+				uxOffloads = pxEndPoint->pxNetworkInterface->uxOffloads;
+			}
+			else
+			{
+				uxOffloads = 0U;
+			}
+		}
+		#else
+		{
+			( void ) pxSocket;
+			uxOffloads = uxIPGetOffloads( NULL, NULL );
+		}
+		#endif /* ipconfigUSE_MULTI_INTERFACE */
+
+		return ( ( uxOffloads & ipOFFLOAD_TX_GATHER ) != 0U ) ? pdTRUE : pdFALSE;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_NETWORK_BUFFER_CHAINS */
+
 /*
  * Changing to a new state. Centralised here to do specific actions such as
  * resetting the alive timer, calling the user's OnConnect handler to notify
@@ -1582,6 +2035,17 @@ BaseType_t bAfter  = ( BaseType_t ) NOW_CONNECTED( eTCPState );						/* Is it co
 	/* touch the alive timers because moving to another state. */
 	prvTCPTouchSocket( pxSocket );
 
+	#if( ipconfigTCP_HASH_TABLE_SIZE > 0 )
+	{
+		/* The tables are only accessed by the IP-task.  When the state is
+		changed by an API call, pxTCPSocketLookup() moves the socket later. */
+		if( xIsCallingFromIPTask() != pdFALSE )
+		{
+			vSocketTCPHashUpdate( pxSocket );
+		}
+	}
+	#endif /* ipconfigTCP_HASH_TABLE_SIZE */
+
 	#if( ipconfigHAS_DEBUG_PRINTF == 1 )
 	{
 	if( ( xTCPWindowLoggingLevel >= 0 ) && ( ipconfigTCP_MAY_LOG_PORT( pxSocket->usLocalPort ) != pdFALSE ) )
@@ -1691,7 +2155,13 @@ size_t uxOffset;
 uint32_t ulDataGot, ulDistance;
 TCPWindow_t *pxTCPWindow;
 NetworkBufferDescriptor_t *pxNewBuffer;
+NetworkBufferDescriptor_t *pxPayloadBuffer = NULL;
 int32_t lStreamPos;
+#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+	NetworkBufferDescriptor_t *pxBuffer;
+	const ListItem_t *pxIterator;
+	size_t uxBufferOffset;
+#endif
 
 	if( ( *ppxNetworkBuffer ) != NULL )
 	{
@@ -1710,6 +2180,13 @@ int32_t lStreamPos;
 	lStreamPos = 0;
 	pxTCPPacket->xTCPHeader.ucTCPFlags |= ipTCP_FLAG_ACK;
 
+	#if( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+	{
+		/* The options are either empty or contain time-stamps only. */
+		uxOptionsLength = tcpTIMESTAMP_OPTIONS_LENGTH( pxSocket );
+	}
+	#endif /* ipconfigUSE_TCP_TIMESTAMPS */
+
 	if( pxSocket->u.xTCP.txStream != NULL )
 	{
 		/* ulTCPWindowTxGet will return the amount of data which may be sent
@@ -1719,13 +2196,71 @@ int32_t lStreamPos;
 		if( pxSocket->u.xTCP.usCurMSS > 1u )
 		{
 			lDataLen = ( int32_t ) ulTCPWindowTxGet( pxTCPWindow, pxSocket->u.xTCP.ulWindowSize, &lStreamPos );
+
+			#if( ( ipconfigUSE_DRIVER_OFFLOADS != 0 ) && ( ipconfigUSE_TCP_WIN == 1 ) )
+			{
+				if( lDataLen > 0 )
+				{
+					lDataLen += prvTCPSegmentationOffload( pxSocket, ( uint32_t ) lDataLen, uxOptionsLength );
+				}
+			}
+			#endif
 		}
 
 		if( lDataLen > 0 )
 		{
+			/* Translate the position in txStream to an offset from the tail
+			marker. */
+			uxOffset = uxStreamBufferDistance( pxSocket->u.xTCP.txStream, pxSocket->u.xTCP.txStream->uxTail, ( size_t ) lStreamPos );
+
+			#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+			{
+				/* See if all data lie in one buffer of the application, which
+				can be chained to the headers in stead of being copied. */
+				pxPayloadBuffer = NULL;
+
+				if( prvTCPCanGather( pxSocket ) != pdFALSE )
+				{
+					/* FreeRTOS_send() may be appending to the list in another
+					task.  Only the IP-task removes buffers, so the one that is
+					found stays valid after the scheduler is resumed. */
+					vTaskSuspendAll();
+
+					for( pxIterator = listGET_HEAD_ENTRY( &( pxSocket->u.xTCP.xTxBufferList ) );
+						 pxIterator != listGET_END_MARKER( &( pxSocket->u.xTCP.xTxBufferList ) );
+						 pxIterator = listGET_NEXT( pxIterator ) )
+					{
+						pxBuffer = ( NetworkBufferDescriptor_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+						uxBufferOffset = uxStreamBufferDistance( pxSocket->u.xTCP.txStream, pxSocket->u.xTCP.txStream->uxTail,
+							pxBuffer->uxStreamOffset );
+
+						if( uxBufferOffset > uxOffset )
+						{
+							break;
+						}
+
+						if( ( uxOffset + ( size_t ) lDataLen ) <= ( uxBufferOffset + pxBuffer->xDataLength ) )
+						{
+							pxPayloadBuffer = pxBuffer;
+							break;
+						}
+					}
+
+					( void ) xTaskResumeAll();
+				}
+			}
+			#endif /* ipconfigUSE_NETWORK_BUFFER_CHAINS */
+
 			/* Check if the current network buffer is big enough, if not,
-			resize it. */
-			pxNewBuffer = prvTCPBufferResize( pxSocket, *ppxNetworkBuffer, lDataLen, uxOptionsLength );
+			resize it.  A chained payload does not need any space. */
+			if( pxPayloadBuffer != NULL )
+			{
+				pxNewBuffer = prvTCPBufferResize( pxSocket, *ppxNetworkBuffer, 0, uxOptionsLength );
+			}
+			else
+			{
+				pxNewBuffer = prvTCPBufferResize( pxSocket, *ppxNetworkBuffer, lDataLen, uxOptionsLength );
+			}
 
 			if( pxNewBuffer != NULL )
 			{
@@ -1735,29 +2270,75 @@ int32_t lStreamPos;
 
 				pucSendData = pucEthernetBuffer + ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER + uxOptionsLength;
 
-				/* Translate the position in txStream to an offset from the tail
-				marker. */
-				uxOffset = uxStreamBufferDistance( pxSocket->u.xTCP.txStream, pxSocket->u.xTCP.txStream->uxTail, ( size_t ) lStreamPos );
-
-				/* Here data is copied from the txStream in 'peek' mode.  Only
-				when the packets are acked, the tail marker will be updated. */
-				ulDataGot = ( uint32_t ) uxStreamBufferGet( pxSocket->u.xTCP.txStream, uxOffset, pucSendData, ( size_t ) lDataLen, pdTRUE );
-
-				#if( ipconfigHAS_DEBUG_PRINTF != 0 )
+				#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+				if( pxPayloadBuffer != NULL )
 				{
-					if( ulDataGot != ( uint32_t ) lDataLen )
-					{
-						FreeRTOS_debug_printf( ( "uxStreamBufferGet: pos %lu offs %lu only %lu != %lu\n",
-							lStreamPos, uxOffset, ulDataGot, lDataLen ) );
-					}
+					/* The driver will send the data directly from the buffer of
+					the application, the frame holds a reference to it. */
+					uxBufferOffset = uxStreamBufferDistance( pxSocket->u.xTCP.txStream, pxSocket->u.xTCP.txStream->uxTail,
+						pxPayloadBuffer->uxStreamOffset );
+					vNetworkBufferChainPayload( pxNewBuffer, pxPayloadBuffer,
+						pxPayloadBuffer->pucEthernetBuffer + ( uxOffset - uxBufferOffset ), ( size_t ) lDataLen );
+					ulDataGot = ( uint32_t ) lDataLen;
 				}
-				#endif
-
-				/* If the owner of the socket requests a closure, add the FIN
-				flag to the last packet. */
-				if( ( pxSocket->u.xTCP.bits.bCloseRequested != pdFALSE_UNSIGNED ) && ( pxSocket->u.xTCP.bits.bFinSent == pdFALSE_UNSIGNED ) )
+				else
+				#endif /* ipconfigUSE_NETWORK_BUFFER_CHAINS */
 				{
-					ulDistance = ( uint32_t ) uxStreamBufferDistance( pxSocket->u.xTCP.txStream, ( size_t ) lStreamPos, pxSocket->u.xTCP.txStream->uxHead );
+					/* Here data is copied from the txStream in 'peek' mode.  Only
+					when the packets are acked, the tail marker will be updated. */
+					ulDataGot = ( uint32_t ) uxStreamBufferGet( pxSocket->u.xTCP.txStream, uxOffset, pucSendData, ( size_t ) lDataLen, pdTRUE );
+
+					#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+					{
+						/* The space of data that were sent without copying holds
+						nothing, take those bytes from the buffers themselves.
+						The list is protected as above. */
+						vTaskSuspendAll();
+
+						for( pxIterator = listGET_HEAD_ENTRY( &( pxSocket->u.xTCP.xTxBufferList ) );
+							 pxIterator != listGET_END_MARKER( &( pxSocket->u.xTCP.xTxBufferList ) );
+							 pxIterator = listGET_NEXT( pxIterator ) )
+						{
+						size_t uxFirst, uxLast;
+
+							pxBuffer = ( NetworkBufferDescriptor_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+							uxBufferOffset = uxStreamBufferDistance( pxSocket->u.xTCP.txStream, pxSocket->u.xTCP.txStream->uxTail,
+								pxBuffer->uxStreamOffset );
+
+							if( uxBufferOffset >= ( uxOffset + ( size_t ) lDataLen ) )
+							{
+								break;
+							}
+
+							uxFirst = FreeRTOS_max_uint32( ( uint32_t ) uxOffset, ( uint32_t ) uxBufferOffset );
+							uxLast = FreeRTOS_min_uint32( ( uint32_t ) ( uxOffset + ( size_t ) lDataLen ), ( uint32_t ) ( uxBufferOffset + pxBuffer->xDataLength ) );
+
+							if( uxFirst < uxLast )
+							{
+								memcpy( pucSendData + ( uxFirst - uxOffset ), pxBuffer->pucEthernetBuffer + ( uxFirst - uxBufferOffset ), uxLast - uxFirst );
+							}
+						}
+
+						( void ) xTaskResumeAll();
+					}
+					#endif /* ipconfigUSE_NETWORK_BUFFER_CHAINS */
+				}
+
+				#if( ipconfigHAS_DEBUG_PRINTF != 0 )
+				{
+					if( ulDataGot != ( uint32_t ) lDataLen )
+					{
+						FreeRTOS_debug_printf( ( "uxStreamBufferGet: pos %lu offs %lu only %lu != %lu\n",
+							lStreamPos, uxOffset, ulDataGot, lDataLen ) );
+					}
+				}
+				#endif
+
+				/* If the owner of the socket requests a closure, add the FIN
+				flag to the last packet. */
+				if( ( pxSocket->u.xTCP.bits.bCloseRequested != pdFALSE_UNSIGNED ) && ( pxSocket->u.xTCP.bits.bFinSent == pdFALSE_UNSIGNED ) )
+				{
+					ulDistance = ( uint32_t ) uxStreamBufferDistance( pxSocket->u.xTCP.txStream, ( size_t ) lStreamPos, pxSocket->u.xTCP.txStream->uxHead );
 
 					if( ulDistance == ulDataGot )
 					{
@@ -1850,6 +2431,16 @@ int32_t lStreamPos;
 		pxTCPPacket->xTCPHeader.ucTCPFlags &= ( ( uint8_t ) ~ipTCP_FLAG_PSH );
 		pxTCPPacket->xTCPHeader.ucTCPOffset = ( uint8_t )( ( ipSIZE_OF_TCP_HEADER + uxOptionsLength ) << 2 );
 
+		#if( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+		{
+			if( uxOptionsLength != 0u )
+			{
+				/* A retransmission gets a new time-stamp as well. */
+				( void ) prvSetTimeStampOption( pxSocket, pxTCPPacket->xTCPHeader.ucOptdata );
+			}
+		}
+		#endif /* ipconfigUSE_TCP_TIMESTAMPS */
+
 		pxTCPPacket->xTCPHeader.ucTCPFlags |= ( uint8_t ) ipTCP_FLAG_ACK;
 
 		if( lDataLen != 0l )
@@ -1864,6 +2455,66 @@ int32_t lStreamPos;
 }
 /*-----------------------------------------------------------*/
 
+#if( ( ipconfigUSE_DRIVER_OFFLOADS != 0 ) && ( ipconfigUSE_TCP_WIN == 1 ) )
+
+	static int32_t prvTCPSegmentationOffload( FreeRTOS_Socket_t *pxSocket, uint32_t ulDataLength, UBaseType_t uxOptionsLength )
+	{
+	size_t uxMaxFrameLength;
+	const size_t uxHeaderLength = ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER + uxOptionsLength;
+	uint32_t ulLength = ulDataLength, ulMaxLength, ulNext;
+
+		#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+		{
+		const TCPPacket_t *pxTCPPacket = ( const TCPPacket_t * ) pxSocket->u.xTCP.xPacket.u.ucLastPacket;
+		const NetworkEndPoint_t *pxEndPoint;
+
+			/* The destination field holds the local address of the connection,
+			see prvTCPReturnPacket(). */
+			pxEndPoint = FreeRTOS_FindEndPointOnIP( pxTCPPacket->xIPHeader.ulDestinationIPAddress );
+
+			if( ( pxEndPoint != NULL ) &&
+				( pxEndPoint->pxNetworkInterface != NULL ) &&
+				( ( pxEndPoint->pxNetworkInterface->uxOffloads & ipOFFLOAD_TCP_SEGMENTATION ) != 0U ) )
+			{
+				uxMaxFrameLength = pxEndPoint->pxNetworkInterface->uxMaxFrameLength;
+			}
+			else
+			{
+				uxMaxFrameLength = 0U;
+			}
+		}
+		#else
+		{
+			( void ) uxIPGetOffloads( NULL, &uxMaxFrameLength );
+		}
+		#endif /* ipconfigUSE_MULTI_INTERFACE */
+
+		/* A long frame needs a network buffer of a variable size, and the IP
+		length field limits it to 64 KB. */
+		if( ( xBufferAllocFixedSize == pdFALSE ) && ( uxMaxFrameLength > uxHeaderLength ) )
+		{
+			uxMaxFrameLength = FreeRTOS_min_uint32( ( uint32_t ) uxMaxFrameLength, ipSIZE_OF_ETH_HEADER + 0xFFFFUL );
+			ulMaxLength = ( uint32_t ) ( uxMaxFrameLength - uxHeaderLength );
+
+			while( ulLength < ulMaxLength )
+			{
+				ulNext = ulTCPWindowTxGetNext( &( pxSocket->u.xTCP.xTCPWindow ), pxSocket->u.xTCP.ulWindowSize, ulLength, ulMaxLength - ulLength );
+
+				if( ulNext == 0UL )
+				{
+					break;
+				}
+
+				ulLength += ulNext;
+			}
+		}
+
+		return ( int32_t ) ( ulLength - ulDataLength );
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ( ipconfigUSE_DRIVER_OFFLOADS != 0 ) && ( ipconfigUSE_TCP_WIN == 1 ) */
+
 /*
  * Calculate after how much time this socket needs to be checked again.
  */
@@ -1979,6 +2630,7 @@ uint8_t ucTCPFlags = pxTCPHeader->ucTCPFlags;
 TCPWindow_t *pxTCPWindow = &pxSocket->u.xTCP.xTCPWindow;
 BaseType_t xSendLength = 0;
 uint32_t ulAckNr = FreeRTOS_ntohl( pxTCPHeader->ulAckNr );
+UBaseType_t uxOptionsLength;
 
 	if( ( ucTCPFlags & ipTCP_FLAG_FIN ) != 0u )
 	{
@@ -2039,12 +2691,16 @@ uint32_t ulAckNr = FreeRTOS_ntohl( pxTCPHeader->ulAckNr );
 
 	pxTCPWindow->ulOurSequenceNumber = pxTCPWindow->tx.ulCurrentSequenceNumber;
 
+	/* prvSetOptions() has placed the time-stamps, if used, in front of the
+	SACK option. */
+	uxOptionsLength = tcpTIMESTAMP_OPTIONS_LENGTH( pxSocket ) + pxTCPWindow->ucOptionLength;
+
 	if( pxTCPHeader->ucTCPFlags != 0u )
 	{
-		xSendLength = ( BaseType_t ) ( ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER + pxTCPWindow->ucOptionLength );
+		xSendLength = ( BaseType_t ) ( ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER + uxOptionsLength );
 	}
 
-	pxTCPHeader->ucTCPOffset = ( uint8_t ) ( ( ipSIZE_OF_TCP_HEADER + pxTCPWindow->ucOptionLength ) << 2 );
+	pxTCPHeader->ucTCPOffset = ( uint8_t ) ( ( ipSIZE_OF_TCP_HEADER + uxOptionsLength ) << 2 );
 
 	if( xTCPWindowLoggingLevel != 0 )
 	{
@@ -2163,6 +2819,23 @@ BaseType_t xResult = 0;
 
 		lOffset = lTCPWindowRxCheck( pxTCPWindow, ulSequenceNumber, ulReceiveLength, ulSpace );
 
+		#if( ipconfigTCP_RX_COALESCE_BYTES > 0 )
+		{
+			/* A full-size segment without the PSH flag is probably followed by
+			more data, so the reader need not be woken up for this one. */
+			if( ( ulReceiveLength >= ( uint32_t ) pxSocket->u.xTCP.usCurMSS ) &&
+				( ( pxTCPHeader->ucTCPFlags & ipTCP_FLAG_PSH ) == 0u ) &&
+				( pxSocket->u.xTCP.ucTCPState == eESTABLISHED ) )
+			{
+				pxSocket->u.xTCP.bits.bRxCoalesce = pdTRUE_UNSIGNED;
+			}
+			else
+			{
+				pxSocket->u.xTCP.bits.bRxCoalesce = pdFALSE_UNSIGNED;
+			}
+		}
+		#endif /* ipconfigTCP_RX_COALESCE_BYTES */
+
 		if( lOffset >= 0 )
 		{
 			/* New data has arrived and may be made available to the user.  See
@@ -2197,6 +2870,23 @@ BaseType_t xResult = 0;
 			}
 		}
 		#endif /* ipconfigUSE_TCP_WIN */
+
+		#if( ipconfigTCP_RX_COALESCE_BYTES > 0 )
+		{
+			pxSocket->u.xTCP.bits.bRxCoalesce = pdFALSE_UNSIGNED;
+
+			if( pxSocket->u.xTCP.bits.bRxWakePending != pdFALSE_UNSIGNED )
+			{
+				/* Make sure that xTCPSocketCheck() will wake up the reader in
+				case no more data arrives. */
+				if( ( pxSocket->u.xTCP.usTimeout == 0u ) ||
+					( pxSocket->u.xTCP.usTimeout > ( uint16_t ) pdMS_TO_MIN_TICKS( DELAYED_ACK_LONGER_DELAY_MS ) ) )
+				{
+					pxSocket->u.xTCP.usTimeout = ( uint16_t ) pdMS_TO_MIN_TICKS( DELAYED_ACK_LONGER_DELAY_MS );
+				}
+			}
+		}
+		#endif /* ipconfigTCP_RX_COALESCE_BYTES */
 	}
 	else
 	{
@@ -2214,6 +2904,17 @@ TCPPacket_t *pxTCPPacket = ( TCPPacket_t * ) ( pxNetworkBuffer->pucEthernetBuffe
 TCPHeader_t *pxTCPHeader = &pxTCPPacket->xTCPHeader;
 TCPWindow_t *pxTCPWindow = &pxSocket->u.xTCP.xTCPWindow;
 UBaseType_t uxOptionsLength = pxTCPWindow->ucOptionLength;
+/* Time-stamps, when used, are placed in front of the other options. */
+UBaseType_t uxOffset = 0u;
+
+	#if( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+	{
+		if( pxSocket->u.xTCP.bits.bTimeStamps != pdFALSE_UNSIGNED )
+		{
+			uxOffset = prvSetTimeStampOption( pxSocket, pxTCPHeader->ucOptdata );
+		}
+	}
+	#endif /* ipconfigUSE_TCP_TIMESTAMPS */
 
 	#if(	ipconfigUSE_TCP_WIN == 1 )
 		if( uxOptionsLength != 0u )
@@ -2227,11 +2928,7 @@ UBaseType_t uxOptionsLength = pxTCPWindow->ucOptionLength;
 					uxOptionsLength,
 					FreeRTOS_ntohl( pxTCPWindow->ulOptionsData[ 1 ] ) - pxSocket->u.xTCP.xTCPWindow.rx.ulFirstSequenceNumber,
 					FreeRTOS_ntohl( pxTCPWindow->ulOptionsData[ 2 ] ) - pxSocket->u.xTCP.xTCPWindow.rx.ulFirstSequenceNumber ) );
-			memcpy( pxTCPHeader->ucOptdata, pxTCPWindow->ulOptionsData, ( size_t ) uxOptionsLength );
-
-			/* The header length divided by 4, goes into the higher nibble,
-			effectively a shift-left 2. */
-			pxTCPHeader->ucTCPOffset = ( uint8_t )( ( ipSIZE_OF_TCP_HEADER + uxOptionsLength ) << 2 );
+			memcpy( &( pxTCPHeader->ucOptdata[ uxOffset ] ), pxTCPWindow->ulOptionsData, ( size_t ) uxOptionsLength );
 		}
 		else
 	#endif	/* ipconfigUSE_TCP_WIN */
@@ -2244,11 +2941,19 @@ UBaseType_t uxOptionsLength = pxTCPWindow->ucOptionLength;
 			FreeRTOS_debug_printf( ( "MSS: sending %d\n", pxSocket->u.xTCP.usCurMSS ) );
 		}
 
-		pxTCPHeader->ucOptdata[ 0 ] = TCP_OPT_MSS;
-		pxTCPHeader->ucOptdata[ 1 ] = TCP_OPT_MSS_LEN;
-		pxTCPHeader->ucOptdata[ 2 ] = ( uint8_t ) ( ( pxSocket->u.xTCP.usCurMSS ) >> 8 );
-		pxTCPHeader->ucOptdata[ 3 ] = ( uint8_t ) ( ( pxSocket->u.xTCP.usCurMSS ) & 0xffu );
+		pxTCPHeader->ucOptdata[ uxOffset + 0 ] = TCP_OPT_MSS;
+		pxTCPHeader->ucOptdata[ uxOffset + 1 ] = TCP_OPT_MSS_LEN;
+		pxTCPHeader->ucOptdata[ uxOffset + 2 ] = ( uint8_t ) ( ( pxSocket->u.xTCP.usCurMSS ) >> 8 );
+		pxTCPHeader->ucOptdata[ uxOffset + 3 ] = ( uint8_t ) ( ( pxSocket->u.xTCP.usCurMSS ) & 0xffu );
 		uxOptionsLength = 4u;
+	}
+
+	uxOptionsLength += uxOffset;
+
+	if( uxOptionsLength != 0u )
+	{
+		/* The header length divided by 4, goes into the higher nibble,
+		effectively a shift-left 2. */
 		pxTCPHeader->ucTCPOffset = ( uint8_t )( ( ipSIZE_OF_TCP_HEADER + uxOptionsLength ) << 2 );
 	}
 
@@ -2348,6 +3053,20 @@ BaseType_t xSendLength = 0;
 			}
 		}
 		#endif /* ipconfigUSE_TCP_WIN */
+		#if( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+		{
+			if( pxSocket->u.xTCP.bits.bTimeStamps != pdFALSE_UNSIGNED )
+			{
+				/* Every segment will carry a time-stamp option, lower the MSS
+				to make room for it. */
+				pxSocket->u.xTCP.usCurMSS = ( uint16_t ) ( pxSocket->u.xTCP.usCurMSS - TCP_OPT_TIMESTAMP_SPACE );
+				pxTCPWindow->usMSS = pxSocket->u.xTCP.usCurMSS;
+
+				/* The RTT will be measured with the time-stamps. */
+				pxTCPWindow->u.bits.bTimeStamps = pdTRUE_UNSIGNED;
+			}
+		}
+		#endif /* ipconfigUSE_TCP_TIMESTAMPS */
 		/* This was the third step of connecting: SYN, SYN+ACK, ACK	so now the
 		connection is established. */
 		vTCPStateChange( pxSocket, eESTABLISHED );
@@ -2375,6 +3094,9 @@ uint8_t ucTCPFlags = pxTCPHeader->ucTCPFlags;
 uint32_t ulSequenceNumber = FreeRTOS_ntohl( pxTCPHeader->ulSequenceNumber ), ulCount;
 BaseType_t xSendLength = 0, xMayClose = pdFALSE, bRxComplete, bTxDone;
 int32_t lDistance, lSendResult;
+#if( ( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 ) || ( ipconfigUSE_TCP_INFO != 0 ) )
+	uint32_t ulPreviousWindowSize = pxSocket->u.xTCP.ulWindowSize;
+#endif
 
 	/* Remember the window size the peer is advertising. */
 	pxSocket->u.xTCP.ulWindowSize = FreeRTOS_ntohs( pxTCPHeader->usWindow );
@@ -2387,6 +3109,34 @@ int32_t lDistance, lSendResult;
 
 	if( ( ucTCPFlags & ( uint8_t ) ipTCP_FLAG_ACK ) != 0u )
 	{
+		#if( ( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 ) || ( ipconfigUSE_TCP_INFO != 0 ) )
+		{
+			/* An ACK that carries no data and that doesn't change the window
+			may be a duplicate ACK.  It must be checked before
+			ulTCPWindowTxAck() advances the transmission window. */
+			if( ( ulReceiveLength == 0u ) &&
+				( pxSocket->u.xTCP.ulWindowSize == ulPreviousWindowSize ) &&
+				( ( ucTCPFlags & ( uint8_t ) ( ipTCP_FLAG_SYN | ipTCP_FLAG_FIN ) ) == 0u ) )
+			{
+				#if( ipconfigUSE_TCP_INFO != 0 )
+				{
+					if( ( FreeRTOS_ntohl( pxTCPPacket->xTCPHeader.ulAckNr ) == pxTCPWindow->tx.ulCurrentSequenceNumber ) &&
+						( ulTCPWindowTxInFlight( pxTCPWindow ) != 0u ) )
+					{
+						pxTCPWindow->ulDupAcks++;
+					}
+				}
+				#endif /* ipconfigUSE_TCP_INFO */
+
+				#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+				{
+					vTCPWindowTxDupAck( pxTCPWindow, FreeRTOS_ntohl( pxTCPPacket->xTCPHeader.ulAckNr ) );
+				}
+				#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+			}
+		}
+		#endif /* ( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 ) || ( ipconfigUSE_TCP_INFO != 0 ) */
+
 		ulCount = ulTCPWindowTxAck( pxTCPWindow, FreeRTOS_ntohl( pxTCPPacket->xTCPHeader.ulAckNr ) );
 
 		/* ulTCPWindowTxAck() returns the number of bytes which have been acked,
@@ -2398,6 +3148,12 @@ int32_t lDistance, lSendResult;
 			confirmed, and because there is new space in the txStream, the
 			user/owner should be woken up. */
 			/* _HT_ : only in case the socket's waiting? */
+			#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+			{
+				prvTCPTxBuffersAcked( pxSocket, ulCount );
+			}
+			#endif
+
 			if( uxStreamBufferGet( pxSocket->u.xTCP.txStream, 0u, NULL, ( size_t ) ulCount, pdFALSE ) != 0u )
 			{
 				pxSocket->xEventBits |= eSOCKET_SEND;
@@ -2503,8 +3259,9 @@ int32_t lDistance, lSendResult;
 		/* _HT_ patch: since the MTU has be fixed at 1500 in stead of 1526, TCP
 		can not	send-out both TCP options and also a full packet. Sending
 		options (SACK) is always more urgent than sending data, which can be
-		sent later. */
-		if( uxOptionsLength == 0u )
+		sent later.  Time-stamps are the exception: the MSS has been lowered
+		to make room for them. */
+		if( uxOptionsLength == tcpTIMESTAMP_OPTIONS_LENGTH( pxSocket ) )
 		{
 			/* prvTCPPrepareSend might allocate a bigger network buffer, if
 			necessary. */
@@ -2520,6 +3277,54 @@ int32_t lDistance, lSendResult;
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_TCP_WIN == 1 ) && ( ( ipconfigTCP_ACK_EVERY_N_SEGMENTS > 0 ) || ( ipconfigTCP_QUICKACK_IDLE_MS > 0 ) )
+
+	static BaseType_t prvTCPAckImmediately( FreeRTOS_Socket_t *pxSocket )
+	{
+	BaseType_t xReturn = pdFALSE;
+
+		#if( ipconfigTCP_QUICKACK_IDLE_MS > 0 )
+		{
+		TickType_t xNow = xTaskGetTickCount();
+
+			if( ( xNow - pxSocket->u.xTCP.xLastRxDataTime ) >= pdMS_TO_TICKS( ipconfigTCP_QUICKACK_IDLE_MS ) )
+			{
+				/* The peer has been silent for a while, its congestion window
+				may have shrunk.  Let it grow quickly by acknowledging the next
+				segments one by one. */
+				pxSocket->u.xTCP.ucQuickAcks = ( uint8_t ) ipconfigTCP_QUICKACK_SEGMENTS;
+			}
+			pxSocket->u.xTCP.xLastRxDataTime = xNow;
+
+			if( pxSocket->u.xTCP.ucQuickAcks != 0u )
+			{
+				pxSocket->u.xTCP.ucQuickAcks--;
+				xReturn = pdTRUE;
+			}
+		}
+		#endif /* ipconfigTCP_QUICKACK_IDLE_MS */
+
+		#if( ipconfigTCP_ACK_EVERY_N_SEGMENTS > 0 )
+		{
+			/* The counter is cleared by prvTCPReturnPacket() as soon as an ACK
+			is sent. */
+			if( pxSocket->u.xTCP.ucUnackedSegments < ( uint8_t ) 0xffu )
+			{
+				pxSocket->u.xTCP.ucUnackedSegments++;
+			}
+			if( pxSocket->u.xTCP.ucUnackedSegments >= ( uint8_t ) ipconfigTCP_ACK_EVERY_N_SEGMENTS )
+			{
+				xReturn = pdTRUE;
+			}
+		}
+		#endif /* ipconfigTCP_ACK_EVERY_N_SEGMENTS */
+
+		return xReturn;
+	}
+
+#endif /* ipconfigUSE_TCP_WIN && ( ipconfigTCP_ACK_EVERY_N_SEGMENTS || ipconfigTCP_QUICKACK_IDLE_MS ) */
+/*-----------------------------------------------------------*/
+
 /*
  * Called from prvTCPHandleState().  There is data to be sent.  If
  * ipconfigUSE_TCP_WIN is defined, and if only an ACK must be sent, it will be
@@ -2539,6 +3344,8 @@ int32_t lRxSpace;
 	#else
 		int32_t lMinLength;
 	#endif
+	/* Set to pdTRUE when the ACK policy does not allow a delay. */
+	BaseType_t xAckNow = pdFALSE;
 #endif
 
 	/* Set the time-out field, so that we'll be called by the IP-task in case no
@@ -2553,12 +3360,22 @@ int32_t lRxSpace;
 		}
 		#endif /* ipconfigTCP_ACK_EARLIER_PACKET */
 
+		#if( ipconfigTCP_ACK_EVERY_N_SEGMENTS > 0 ) || ( ipconfigTCP_QUICKACK_IDLE_MS > 0 )
+		{
+			if( ulReceiveLength > 0 )
+			{
+				xAckNow = prvTCPAckImmediately( pxSocket );
+			}
+		}
+		#endif
+
 		/* In case we're receiving data continuously, we might postpone sending
 		an ACK to gain performance. */
 		if( ( ulReceiveLength > 0 ) &&							/* Data was sent to this socket. */
+			( xAckNow == pdFALSE ) &&							/* The ACK policy allows a delay. */
 			( lRxSpace >= lMinLength ) &&						/* There is Rx space for more data. */
 			( pxSocket->u.xTCP.bits.bFinSent == pdFALSE_UNSIGNED ) &&	/* Not in a closure phase. */
-			( xSendLength == ( ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER ) ) && /* No Tx data or options to be sent. */
+			( xSendLength == ( BaseType_t ) ( ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER + tcpTIMESTAMP_OPTIONS_LENGTH( pxSocket ) ) ) && /* No Tx data or options to be sent. */
 			( pxSocket->u.xTCP.ucTCPState == eESTABLISHED ) &&	/* Connection established. */
 			( pxTCPHeader->ucTCPFlags == ipTCP_FLAG_ACK ) )		/* There are no other flags than an ACK. */
 		{
@@ -2874,17 +3691,29 @@ static BaseType_t prvTCPSendReset( NetworkBufferDescriptor_t *pxNetworkBuffer )
 }
 /*-----------------------------------------------------------*/
 
-static void prvSocketSetMSS( FreeRTOS_Socket_t *pxSocket )
+static uint32_t prvGetMSSForPeer( uint32_t ulRemoteIP )
 {
 uint32_t ulMSS = ipconfigTCP_MSS;
 
-	if( ( ( FreeRTOS_ntohl( pxSocket->u.xTCP.ulRemoteIP ) ^ *ipLOCAL_IP_ADDRESS_POINTER ) & xNetworkAddressing.ulNetMask ) != 0ul )
+	#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+	if( FreeRTOS_FindEndPointOnNetMask( FreeRTOS_htonl( ulRemoteIP ) ) == NULL )
+	#else
+	if( ( ( FreeRTOS_ntohl( ulRemoteIP ) ^ *ipLOCAL_IP_ADDRESS_POINTER ) & xNetworkAddressing.ulNetMask ) != 0ul )
+	#endif
 	{
 		/* Data for this peer will pass through a router, and maybe through
 		the internet.  Limit the MSS to 1400 bytes or less. */
 		ulMSS = FreeRTOS_min_uint32( ( uint32_t ) REDUCED_MSS_THROUGH_INTERNET, ulMSS );
 	}
 
+	return ulMSS;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSocketSetMSS( FreeRTOS_Socket_t *pxSocket )
+{
+uint32_t ulMSS = prvGetMSSForPeer( pxSocket->u.xTCP.ulRemoteIP );
+
 	FreeRTOS_debug_printf( ( "prvSocketSetMSS: %lu bytes for %lxip:%u\n", ulMSS, pxSocket->u.xTCP.ulRemoteIP, pxSocket->u.xTCP.usRemotePort ) );
 
 	pxSocket->u.xTCP.usInitMSS = pxSocket->u.xTCP.usCurMSS = ( uint16_t ) ulMSS;
@@ -2915,6 +3744,8 @@ uint32_t ulSequenceNumber;
 uint32_t ulAckNumber;
 BaseType_t xResult = pdPASS;
 
+	ipMIB_INCREMENT( ulTCPInSegs );
+
 	/* Check for a minimum packet size. */
 	if( pxNetworkBuffer->xDataLength >= ( ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER ) )
 	{
@@ -2932,6 +3763,7 @@ BaseType_t xResult = pdPASS;
 	}
 	else
 	{
+		ipMIB_INCREMENT( ulTCPInErrs );
 		return pdFAIL;
 	}
 
@@ -2969,22 +3801,62 @@ BaseType_t xResult = pdPASS;
 			has set the SYN flag. */
 			if( ( ucTCPFlags & ipTCP_FLAG_CTRL ) != ipTCP_FLAG_SYN )
 			{
-				/* What happens: maybe after a reboot, a client doesn't know the
-				connection had gone.  Send a RST in order to get a new connect
-				request. */
-				#if( ipconfigHAS_DEBUG_PRINTF == 1 )
+			FreeRTOS_Socket_t *pxNewSocket = NULL;
+
+				#if( ipconfigTCP_SYN_CACHE_SIZE > 0 )
 				{
-				FreeRTOS_debug_printf( ( "TCP: Server can't handle flags: %s from %lxip:%u to port %u\n",
-					prvTCPFlagMeaning( ( UBaseType_t ) ucTCPFlags ), ulRemoteIP, xRemotePort, xLocalPort ) );
+					if( pxSocket->u.xTCP.bits.bReuseSocket == pdFALSE_UNSIGNED )
+					{
+						if( ( ucTCPFlags & ipTCP_FLAG_RST ) != 0u )
+						{
+							prvSynCacheReset( pxSocket, pxNetworkBuffer );
+						}
+						else if( ( ucTCPFlags & 0x17u ) == ipTCP_FLAG_ACK )
+						{
+							/* This may be the last step of a handshake that
+							was answered from the SYN cache. */
+							pxNewSocket = prvSynCacheAccept( pxSocket, pxNetworkBuffer );
+						}
+						else
+						{
+							/* Handled below. */
+						}
+					}
 				}
-				#endif /* ipconfigHAS_DEBUG_PRINTF */
+				#endif /* ipconfigTCP_SYN_CACHE_SIZE */
 
-				if( ( ucTCPFlags & ipTCP_FLAG_RST ) == 0u )
+				if( pxNewSocket != NULL )
 				{
-					prvTCPSendReset( pxNetworkBuffer );
+					pxSocket = pxNewSocket;
 				}
+				else
+				{
+					/* What happens: maybe after a reboot, a client doesn't know the
+					connection had gone.  Send a RST in order to get a new connect
+					request. */
+					#if( ipconfigHAS_DEBUG_PRINTF == 1 )
+					{
+					FreeRTOS_debug_printf( ( "TCP: Server can't handle flags: %s from %lxip:%u to port %u\n",
+						prvTCPFlagMeaning( ( UBaseType_t ) ucTCPFlags ), ulRemoteIP, xRemotePort, xLocalPort ) );
+					}
+					#endif /* ipconfigHAS_DEBUG_PRINTF */
+
+					if( ( ucTCPFlags & ipTCP_FLAG_RST ) == 0u )
+					{
+						prvTCPSendReset( pxNetworkBuffer );
+					}
+					xResult = pdFAIL;
+				}
+			}
+			#if( ipconfigTCP_SYN_CACHE_SIZE > 0 )
+			else if( pxSocket->u.xTCP.bits.bReuseSocket == pdFALSE_UNSIGNED )
+			{
+				/* Answer the SYN without creating a socket yet.  The network
+				buffer is not consumed. */
+				prvSynCacheHandleSyn( pxSocket, pxNetworkBuffer );
 				xResult = pdFAIL;
 			}
+			#endif /* ipconfigTCP_SYN_CACHE_SIZE */
 			else
 			{
 				/* prvHandleListen() will either return a newly created socket
@@ -3061,6 +3933,12 @@ BaseType_t xResult = pdPASS;
 		socket. */
 		prvTCPTouchSocket( pxSocket );
 
+		#if( ipconfigUSE_TCP_INFO != 0 )
+		{
+			pxSocket->u.xTCP.xTCPWindow.ulSegmentsIn++;
+		}
+		#endif /* ipconfigUSE_TCP_INFO */
+
 		/* Parse the TCP option(s), if present. */
 		/* _HT_ : if we're in the SYN phase, and peer does not send a MSS option,
 		then we MUST assume an MSS size of 536 bytes for backward compatibility. */
@@ -3215,6 +4093,13 @@ struct freertos_sockaddr xAddress;
 	pxNewSocket->u.xTCP.uxRxWinSize  = pxSocket->u.xTCP.uxRxWinSize;
 	pxNewSocket->u.xTCP.uxTxWinSize  = pxSocket->u.xTCP.uxTxWinSize;
 
+	#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+	{
+		/* The congestion control algorithm chosen for the listening socket. */
+		pxNewSocket->u.xTCP.xTCPWindow.xCongestion.pxOps = pxSocket->u.xTCP.xTCPWindow.xCongestion.pxOps;
+	}
+	#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
 	#if( ipconfigSOCKET_HAS_USER_SEMAPHORE == 1 )
 	{
 		pxNewSocket->pxUserSemaphore = pxSocket->pxUserSemaphore;
@@ -3292,6 +4177,612 @@ struct freertos_sockaddr xAddress;
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigTCP_SYN_CACHE_SIZE > 0 )
+
+	/* A connection request that has been answered with a SYN+ACK, but for
+	which no socket has been created yet. */
+	typedef struct xSYN_CACHE_ENTRY
+	{
+		TickType_t xCreateTime;			/* The time at which the SYN was received. */
+		uint32_t ulRemoteIP;			/* The IP-address of the peer, host-endian. */
+		uint32_t ulPeerSequenceNumber;	/* The sequence number of the peer's SYN. */
+		uint32_t ulOurSequenceNumber;	/* The sequence number of our SYN+ACK. */
+		#if( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+			uint32_t ulTSRecent;		/* The time-stamp in the peer's SYN. */
+		#endif
+		uint16_t usRemotePort;			/* Host-endian. */
+		uint16_t usLocalPort;			/* Host-endian. */
+		uint16_t usPeerMSS;				/* The MSS offered by the peer, or zero. */
+		uint8_t ucPeerWinScaleFactor;
+		struct {
+			uint8_t bInUse : 1,
+					bWinScaling : 1,	/* The peer offered window scaling. */
+					bTimeStamps : 1;	/* The peer offered time-stamps. */
+		} bits;
+	} SynCacheEntry_t;
+
+	static SynCacheEntry_t xSynCache[ ipconfigTCP_SYN_CACHE_SIZE ];
+
+	static TCPListenStatistics_t xListenStatistics;
+
+	#if( ipconfigTCP_SYN_COOKIES != 0 )
+		/* A cookie is only valid during the period in which it was created,
+		and the next one. */
+		#define tcpSYN_COOKIE_PERIOD_MS		( 64000ul )
+
+		/* The MSS values that a cookie can represent, in 3 bits. */
+		static const uint16_t usSynCookieMSS[] = { 536u, 1200u, 1360u, 1400u, 1440u, 1460u };
+
+		static uint32_t ulSynCookieSecret = 0ul;
+	#endif
+
+	/*-----------------------------------------------------------*/
+
+	/* Find the entry for a connection request from a given peer.  Entries that
+	have expired are freed on the way. */
+	static SynCacheEntry_t *prvSynCacheLookup( uint32_t ulRemoteIP, uint16_t usRemotePort, uint16_t usLocalPort )
+	{
+	TickType_t xNow = xTaskGetTickCount();
+	SynCacheEntry_t *pxEntry;
+	SynCacheEntry_t *pxReturn = NULL;
+	BaseType_t xIndex;
+
+		for( xIndex = 0; xIndex < ( BaseType_t ) ipconfigTCP_SYN_CACHE_SIZE; xIndex++ )
+		{
+			pxEntry = &( xSynCache[ xIndex ] );
+			if( pxEntry->bits.bInUse == pdFALSE_UNSIGNED )
+			{
+				continue;
+			}
+			if( ( xNow - pxEntry->xCreateTime ) >= pdMS_TO_TICKS( ipconfigTCP_SYN_CACHE_TIMEOUT_MS ) )
+			{
+				pxEntry->bits.bInUse = pdFALSE_UNSIGNED;
+			}
+			else if( ( pxEntry->ulRemoteIP == ulRemoteIP ) &&
+					 ( pxEntry->usRemotePort == usRemotePort ) &&
+					 ( pxEntry->usLocalPort == usLocalPort ) )
+			{
+				pxReturn = pxEntry;
+				break;
+			}
+		}
+
+		return pxReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	/* Find a free entry, or one that has expired.  Returns NULL when all
+	entries are in use, with the oldest one in '*ppxOldest'. */
+	static SynCacheEntry_t *prvSynCacheAllocate( SynCacheEntry_t **ppxOldest )
+	{
+	TickType_t xNow = xTaskGetTickCount();
+	TickType_t xAge, xOldestAge = 0u;
+	SynCacheEntry_t *pxEntry;
+	SynCacheEntry_t *pxReturn = NULL;
+	BaseType_t xIndex;
+
+		*ppxOldest = &( xSynCache[ 0 ] );
+
+		for( xIndex = 0; xIndex < ( BaseType_t ) ipconfigTCP_SYN_CACHE_SIZE; xIndex++ )
+		{
+			pxEntry = &( xSynCache[ xIndex ] );
+			xAge = xNow - pxEntry->xCreateTime;
+			if( ( pxEntry->bits.bInUse == pdFALSE_UNSIGNED ) || ( xAge >= pdMS_TO_TICKS( ipconfigTCP_SYN_CACHE_TIMEOUT_MS ) ) )
+			{
+				pxReturn = pxEntry;
+				break;
+			}
+			if( xAge >= xOldestAge )
+			{
+				xOldestAge = xAge;
+				*ppxOldest = pxEntry;
+			}
+		}
+
+		return pxReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	/* Store what the options of a SYN tell about the peer. */
+	static void prvSynCacheCheckOptions( NetworkBufferDescriptor_t *pxNetworkBuffer, SynCacheEntry_t *pxEntry )
+	{
+	TCPHeader_t *pxTCPHeader = &( ( ( TCPPacket_t * ) pxNetworkBuffer->pucEthernetBuffer )->xTCPHeader );
+	const uint8_t *pucPtr = pxTCPHeader->ucOptdata;
+	const uint8_t *pucLast = pucPtr + ( ( ( pxTCPHeader->ucTCPOffset >> 4 ) - 5 ) << 2 );
+	size_t uxLength;
+
+		if( pucLast > ( pxNetworkBuffer->pucEthernetBuffer + pxNetworkBuffer->xDataLength ) )
+		{
+			return;
+		}
+
+		while( pucPtr < pucLast )
+		{
+			if( pucPtr[ 0 ] == TCP_OPT_END )
+			{
+				break;
+			}
+			if( pucPtr[ 0 ] == TCP_OPT_NOOP )
+			{
+				pucPtr++;
+				continue;
+			}
+
+			/* All other options have a length field. */
+			if( ( pucLast - pucPtr ) < 2 )
+			{
+				break;
+			}
+			uxLength = ( size_t ) pucPtr[ 1 ];
+			if( ( uxLength < 2u ) || ( uxLength > ( size_t ) ( pucLast - pucPtr ) ) )
+			{
+				break;
+			}
+
+			if( ( pucPtr[ 0 ] == TCP_OPT_MSS ) && ( uxLength == TCP_OPT_MSS_LEN ) )
+			{
+				pxEntry->usPeerMSS = usChar2u16( pucPtr + 2 );
+			}
+			#if( ipconfigUSE_TCP_WIN != 0 )
+			else if( ( pucPtr[ 0 ] == TCP_OPT_WSOPT ) && ( uxLength == TCP_OPT_WSOPT_LEN ) )
+			{
+				pxEntry->ucPeerWinScaleFactor = pucPtr[ 2 ];
+				pxEntry->bits.bWinScaling = pdTRUE_UNSIGNED;
+			}
+			#endif
+			#if( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+			else if( ( pucPtr[ 0 ] == TCP_OPT_TIMESTAMP ) && ( uxLength == TCP_OPT_TIMESTAMP_LEN ) )
+			{
+				pxEntry->ulTSRecent = ulChar2u32( pucPtr + 2 );
+				pxEntry->bits.bTimeStamps = pdTRUE_UNSIGNED;
+			}
+			#endif
+			else
+			{
+				/* Not needed for the SYN+ACK. */
+			}
+
+			pucPtr += uxLength;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	#if( ipconfigTCP_SYN_COOKIES != 0 )
+
+		static uint32_t prvSynCookieHash( const SynCacheEntry_t *pxEntry, uint32_t ulCounter )
+		{
+		uint32_t ulWords[ 4 ];
+		uint32_t ulHash = ulSynCookieSecret;
+		BaseType_t xIndex;
+
+			ulWords[ 0 ] = pxEntry->ulRemoteIP;
+			ulWords[ 1 ] = ( ( ( uint32_t ) pxEntry->usRemotePort ) << 16 ) | ( uint32_t ) pxEntry->usLocalPort;
+			ulWords[ 2 ] = pxEntry->ulPeerSequenceNumber;
+			ulWords[ 3 ] = ulCounter;
+
+			for( xIndex = 0; xIndex < ( BaseType_t ) ARRAY_SIZE( ulWords ); xIndex++ )
+			{
+				/* The finalisation step of MurmurHash3, which lets every bit
+				of the input affect every bit of the result. */
+				ulHash ^= ulWords[ xIndex ];
+				ulHash ^= ulHash >> 16;
+				ulHash *= 0x85ebca6bul;
+				ulHash ^= ulHash >> 13;
+				ulHash *= 0xc2b2ae35ul;
+				ulHash ^= ulHash >> 16;
+			}
+
+			return ulHash;
+		}
+		/*-----------------------------------------------------------*/
+
+		/* Encode a connection request in an initial sequence number: 5 bits of
+		time, 3 bits for the MSS and a 24-bit hash.  The MSS of the entry is
+		rounded down to a value in usSynCookieMSS[]. */
+		static uint32_t prvSynCookieCreate( SynCacheEntry_t *pxEntry )
+		{
+		uint32_t ulCounter = ( uint32_t ) ( xTaskGetTickCount() / pdMS_TO_TICKS( tcpSYN_COOKIE_PERIOD_MS ) );
+		uint32_t ulIndex = 0ul;
+
+			if( ulSynCookieSecret == 0ul )
+			{
+				ulSynCookieSecret = ( ( uint32_t ) ipconfigRAND32() << 16 ) ^ ( uint32_t ) ipconfigRAND32();
+				if( ulSynCookieSecret == 0ul )
+				{
+					ulSynCookieSecret = 1ul;
+				}
+			}
+
+			while( ( ( ulIndex + 1ul ) < ( uint32_t ) ARRAY_SIZE( usSynCookieMSS ) ) && ( usSynCookieMSS[ ulIndex + 1ul ] <= pxEntry->usPeerMSS ) )
+			{
+				ulIndex++;
+			}
+			pxEntry->usPeerMSS = usSynCookieMSS[ ulIndex ];
+
+			return ( ( ulCounter & 0x1ful ) << 27 ) | ( ulIndex << 24 ) |
+				( prvSynCookieHash( pxEntry, ( ulCounter << 3 ) | ulIndex ) & 0x00fffffful );
+		}
+		/*-----------------------------------------------------------*/
+
+		/* Check if 'ulCookie' was created by prvSynCookieCreate() for the
+		connection request in 'pxEntry'.  If so, the MSS is stored in it. */
+		static BaseType_t prvSynCookieCheck( SynCacheEntry_t *pxEntry, uint32_t ulCookie )
+		{
+		uint32_t ulCounter = ( uint32_t ) ( xTaskGetTickCount() / pdMS_TO_TICKS( tcpSYN_COOKIE_PERIOD_MS ) );
+		uint32_t ulAge = ( ulCounter - ( ulCookie >> 27 ) ) & 0x1ful;
+		uint32_t ulIndex = ( ulCookie >> 24 ) & 0x07ul;
+		BaseType_t xReturn = pdFALSE;
+
+			if( ( ulSynCookieSecret != 0ul ) && ( ulAge <= 1ul ) && ( ulIndex < ( uint32_t ) ARRAY_SIZE( usSynCookieMSS ) ) )
+			{
+				ulCounter -= ulAge;
+				if( ( prvSynCookieHash( pxEntry, ( ulCounter << 3 ) | ulIndex ) & 0x00fffffful ) == ( ulCookie & 0x00fffffful ) )
+				{
+					pxEntry->usPeerMSS = usSynCookieMSS[ ulIndex ];
+					xReturn = pdTRUE;
+				}
+			}
+
+			return xReturn;
+		}
+		/*-----------------------------------------------------------*/
+
+	#endif /* ipconfigTCP_SYN_COOKIES */
+
+	/* Answer the SYN in 'pxNetworkBuffer' with a SYN+ACK.  A cookie only
+	carries the MSS option, as nothing else can be remembered. */
+	static void prvSynCacheSendSynAck( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxNetworkBuffer,
+		const SynCacheEntry_t *pxEntry, BaseType_t xIsCookie )
+	{
+	TCPPacket_t *pxTCPPacket = ( TCPPacket_t * ) ( pxNetworkBuffer->pucEthernetBuffer );
+	TCPHeader_t *pxTCPHeader = &( pxTCPPacket->xTCPHeader );
+	uint32_t ulMSS = prvGetMSSForPeer( pxEntry->ulRemoteIP );
+	uint32_t ulWinSize;
+	uint32_t ulLen;
+	UBaseType_t uxOptionsLength;
+
+		if( pxEntry->usPeerMSS != 0u )
+		{
+			ulMSS = FreeRTOS_min_uint32( ulMSS, ( uint32_t ) pxEntry->usPeerMSS );
+		}
+
+		pxTCPHeader->ucOptdata[ 0 ] = ( uint8_t ) TCP_OPT_MSS;
+		pxTCPHeader->ucOptdata[ 1 ] = ( uint8_t ) TCP_OPT_MSS_LEN;
+		pxTCPHeader->ucOptdata[ 2 ] = ( uint8_t ) ( ulMSS >> 8 );
+		pxTCPHeader->ucOptdata[ 3 ] = ( uint8_t ) ( ulMSS & 0xffu );
+		uxOptionsLength = 4u;
+
+		#if( ipconfigUSE_TCP_WIN != 0 )
+		if( xIsCookie == pdFALSE )
+		{
+			if( pxEntry->bits.bWinScaling != pdFALSE_UNSIGNED )
+			{
+				pxTCPHeader->ucOptdata[ uxOptionsLength + 0 ] = TCP_OPT_NOOP;
+				pxTCPHeader->ucOptdata[ uxOptionsLength + 1 ] = ( uint8_t ) ( TCP_OPT_WSOPT );
+				pxTCPHeader->ucOptdata[ uxOptionsLength + 2 ] = ( uint8_t ) ( TCP_OPT_WSOPT_LEN );
+				pxTCPHeader->ucOptdata[ uxOptionsLength + 3 ] = prvWinScaleFactor( pxSocket->u.xTCP.uxRxWinSize, ( size_t ) ulMSS );
+				uxOptionsLength += 4u;
+			}
+
+			pxTCPHeader->ucOptdata[ uxOptionsLength + 0 ] = TCP_OPT_NOOP;
+			pxTCPHeader->ucOptdata[ uxOptionsLength + 1 ] = TCP_OPT_NOOP;
+			pxTCPHeader->ucOptdata[ uxOptionsLength + 2 ] = TCP_OPT_SACK_P;	/* 4: Sack-Permitted Option. */
+			pxTCPHeader->ucOptdata[ uxOptionsLength + 3 ] = 2;	/* 2: length of this option. */
+			uxOptionsLength += 4u;
+
+			#if( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+			{
+				if( pxEntry->bits.bTimeStamps != pdFALSE_UNSIGNED )
+				{
+				uint8_t *pucOptions = &( pxTCPHeader->ucOptdata[ uxOptionsLength ] );
+				uint32_t ulValue;
+
+					pucOptions[ 0 ] = ( uint8_t ) TCP_OPT_NOOP;
+					pucOptions[ 1 ] = ( uint8_t ) TCP_OPT_NOOP;
+					pucOptions[ 2 ] = ( uint8_t ) TCP_OPT_TIMESTAMP;
+					pucOptions[ 3 ] = ( uint8_t ) TCP_OPT_TIMESTAMP_LEN;
+					ulValue = FreeRTOS_htonl( tcpTIMESTAMP_CLOCK() );
+					memcpy( pucOptions + 4, &ulValue, sizeof( ulValue ) );
+					ulValue = FreeRTOS_htonl( pxEntry->ulTSRecent );
+					memcpy( pucOptions + 8, &ulValue, sizeof( ulValue ) );
+					uxOptionsLength += TCP_OPT_TIMESTAMP_SPACE;
+				}
+			}
+			#endif /* ipconfigUSE_TCP_TIMESTAMPS */
+		}
+		#else
+		{
+			( void ) xIsCookie;
+		}
+		#endif /* ipconfigUSE_TCP_WIN */
+
+		/* The window field of a SYN is never scaled. */
+		ulWinSize = FreeRTOS_min_uint32( ( uint32_t ) ( pxSocket->u.xTCP.uxRxWinSize * ulMSS ), ( uint32_t ) pxSocket->u.xTCP.uxRxStreamSize );
+		ulWinSize = FreeRTOS_min_uint32( ulWinSize, 0xfffcul );
+		pxTCPHeader->usWindow = FreeRTOS_htons( ( uint16_t ) ulWinSize );
+
+		pxTCPHeader->ucTCPFlags = ipTCP_FLAG_SYN | ipTCP_FLAG_ACK;
+		pxTCPHeader->ucTCPOffset = ( uint8_t ) ( ( ipSIZE_OF_TCP_HEADER + uxOptionsLength ) << 2 );
+
+		/* Without a socket, prvTCPReturnPacket() swaps the sequence number and
+		the acknowledge number. */
+		pxTCPHeader->ulAckNr = FreeRTOS_htonl( pxEntry->ulOurSequenceNumber );
+		pxTCPHeader->ulSequenceNumber = FreeRTOS_htonl( pxEntry->ulPeerSequenceNumber + 1u );
+
+		/* The SYN+ACK may be longer than the SYN, like when a socket answers
+		it in the same buffer. */
+		ulLen = ( uint32_t ) ( ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER + uxOptionsLength );
+		pxNetworkBuffer->xDataLength = ( size_t ) ( ulLen + ipSIZE_OF_ETH_HEADER );
+
+		prvTCPReturnPacket( NULL, pxNetworkBuffer, ulLen, pdFALSE );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvSynCacheHandleSyn( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxNetworkBuffer )
+	{
+	TCPPacket_t *pxTCPPacket = ( TCPPacket_t * ) ( pxNetworkBuffer->pucEthernetBuffer );
+	uint32_t ulRemoteIP = FreeRTOS_ntohl( pxTCPPacket->xIPHeader.ulSourceIPAddress );
+	uint16_t usRemotePort = FreeRTOS_ntohs( pxTCPPacket->xTCPHeader.usSourcePort );
+	uint32_t ulPeerSequenceNumber = FreeRTOS_ntohl( pxTCPPacket->xTCPHeader.ulSequenceNumber );
+	uint32_t ulInitialSequenceNumber;
+	SynCacheEntry_t *pxEntry;
+	SynCacheEntry_t *pxOldest;
+	BaseType_t xIsCookie = pdFALSE;
+	#if( ipconfigTCP_SYN_COOKIES != 0 )
+		SynCacheEntry_t xCookie;
+	#endif
+
+		xListenStatistics.ulSynReceived++;
+
+		pxEntry = prvSynCacheLookup( ulRemoteIP, usRemotePort, pxSocket->usLocalPort );
+
+		if( ( pxEntry != NULL ) && ( pxEntry->ulPeerSequenceNumber != ulPeerSequenceNumber ) )
+		{
+			/* A new request from the same port replaces the old one. */
+			pxEntry->bits.bInUse = pdFALSE_UNSIGNED;
+			pxEntry = NULL;
+		}
+
+		if( pxEntry != NULL )
+		{
+			/* The peer did not receive the SYN+ACK, send it again. */
+			xListenStatistics.ulSynRepeated++;
+		}
+		else if( pxSocket->u.xTCP.usChildCount >= pxSocket->u.xTCP.usBacklog )
+		{
+			FreeRTOS_printf( ( "Check: Socket %u already has %u / %u child%s\n",
+				pxSocket->usLocalPort,
+				pxSocket->u.xTCP.usChildCount,
+				pxSocket->u.xTCP.usBacklog,
+				pxSocket->u.xTCP.usChildCount == 1u ? "" : "ren" ) );
+			xListenStatistics.ulBacklogOverflows++;
+			prvTCPSendReset( pxNetworkBuffer );
+		}
+		else
+		{
+			/* Request the Initial Sequence Number first, in order to fail out
+			if necessary, like prvHandleListen() does. */
+			ulInitialSequenceNumber = ulApplicationGetNextSequenceNumber( *ipLOCAL_IP_ADDRESS_POINTER,
+																		  pxSocket->usLocalPort,
+																		  pxTCPPacket->xIPHeader.ulSourceIPAddress,
+																		  pxTCPPacket->xTCPHeader.usSourcePort );
+			if( ulInitialSequenceNumber != 0ul )
+			{
+				pxEntry = prvSynCacheAllocate( &pxOldest );
+
+				if( pxEntry == NULL )
+				{
+					#if( ipconfigTCP_SYN_COOKIES != 0 )
+					{
+						/* No need to store anything, all will be in the cookie. */
+						pxEntry = &xCookie;
+						xIsCookie = pdTRUE;
+					}
+					#else
+					{
+						FreeRTOS_debug_printf( ( "SYN cache: full, drop the request from %lxip:%u\n",
+							pxOldest->ulRemoteIP, pxOldest->usRemotePort ) );
+						pxEntry = pxOldest;
+						xListenStatistics.ulCacheOverflows++;
+					}
+					#endif
+				}
+
+				memset( pxEntry, '\0', sizeof( *pxEntry ) );
+				pxEntry->xCreateTime = xTaskGetTickCount();
+				pxEntry->ulRemoteIP = ulRemoteIP;
+				pxEntry->usRemotePort = usRemotePort;
+				pxEntry->usLocalPort = pxSocket->usLocalPort;
+				pxEntry->ulPeerSequenceNumber = ulPeerSequenceNumber;
+				pxEntry->ulOurSequenceNumber = ulInitialSequenceNumber;
+				prvSynCacheCheckOptions( pxNetworkBuffer, pxEntry );
+
+				#if( ipconfigTCP_SYN_COOKIES != 0 )
+				if( xIsCookie != pdFALSE )
+				{
+					if( pxEntry->usPeerMSS == 0u )
+					{
+						/* The default MSS for IPv4, RFC 1122. */
+						pxEntry->usPeerMSS = 536u;
+					}
+					pxEntry->usPeerMSS = ( uint16_t ) FreeRTOS_min_uint32( ( uint32_t ) pxEntry->usPeerMSS, prvGetMSSForPeer( ulRemoteIP ) );
+					pxEntry->ulOurSequenceNumber = prvSynCookieCreate( pxEntry );
+					xListenStatistics.ulCookiesSent++;
+				}
+				else
+				#endif /* ipconfigTCP_SYN_COOKIES */
+				{
+					pxEntry->bits.bInUse = pdTRUE_UNSIGNED;
+				}
+			}
+		}
+
+		if( pxEntry != NULL )
+		{
+			prvSynCacheSendSynAck( pxSocket, pxNetworkBuffer, pxEntry, xIsCookie );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static FreeRTOS_Socket_t *prvSynCacheAccept( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxNetworkBuffer )
+	{
+	TCPPacket_t *pxTCPPacket = ( TCPPacket_t * ) ( pxNetworkBuffer->pucEthernetBuffer );
+	uint32_t ulRemoteIP = FreeRTOS_ntohl( pxTCPPacket->xIPHeader.ulSourceIPAddress );
+	uint16_t usRemotePort = FreeRTOS_ntohs( pxTCPPacket->xTCPHeader.usSourcePort );
+	uint32_t ulSequenceNumber = FreeRTOS_ntohl( pxTCPPacket->xTCPHeader.ulSequenceNumber );
+	uint32_t ulAckNumber = FreeRTOS_ntohl( pxTCPPacket->xTCPHeader.ulAckNr );
+	SynCacheEntry_t *pxEntry;
+	SynCacheEntry_t xEntry;
+	BaseType_t xFound = pdFALSE;
+	FreeRTOS_Socket_t *pxNewSocket = NULL;
+	TCPWindow_t *pxTCPWindow;
+
+		pxEntry = prvSynCacheLookup( ulRemoteIP, usRemotePort, pxSocket->usLocalPort );
+
+		if( ( pxEntry != NULL ) &&
+			( ulAckNumber == ( pxEntry->ulOurSequenceNumber + 1u ) ) &&
+			( ulSequenceNumber == ( pxEntry->ulPeerSequenceNumber + 1u ) ) )
+		{
+			xEntry = *pxEntry;
+			pxEntry->bits.bInUse = pdFALSE_UNSIGNED;
+			xFound = pdTRUE;
+		}
+		#if( ipconfigTCP_SYN_COOKIES != 0 )
+		else
+		{
+			memset( &xEntry, '\0', sizeof( xEntry ) );
+			xEntry.ulRemoteIP = ulRemoteIP;
+			xEntry.usRemotePort = usRemotePort;
+			xEntry.usLocalPort = pxSocket->usLocalPort;
+			xEntry.ulPeerSequenceNumber = ulSequenceNumber - 1u;
+			xEntry.ulOurSequenceNumber = ulAckNumber - 1u;
+
+			if( prvSynCookieCheck( &xEntry, xEntry.ulOurSequenceNumber ) != pdFALSE )
+			{
+				xListenStatistics.ulCookiesAccepted++;
+				xFound = pdTRUE;
+			}
+		}
+		#endif /* ipconfigTCP_SYN_COOKIES */
+
+		if( xFound == pdFALSE )
+		{
+			xListenStatistics.ulInvalidAcks++;
+		}
+		else if( pxSocket->u.xTCP.usChildCount >= pxSocket->u.xTCP.usBacklog )
+		{
+			FreeRTOS_printf( ( "Check: Socket %u already has %u / %u child%s\n",
+				pxSocket->usLocalPort,
+				pxSocket->u.xTCP.usChildCount,
+				pxSocket->u.xTCP.usBacklog,
+				pxSocket->u.xTCP.usChildCount == 1u ? "" : "ren" ) );
+			xListenStatistics.ulBacklogOverflows++;
+		}
+		else
+		{
+			pxNewSocket = ( FreeRTOS_Socket_t * ) FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+
+			if( ( pxNewSocket == NULL ) || ( pxNewSocket == FREERTOS_INVALID_SOCKET ) )
+			{
+				FreeRTOS_debug_printf( ( "TCP: Listen: new socket failed\n" ) );
+				xListenStatistics.ulSocketFailures++;
+				pxNewSocket = NULL;
+			}
+			else if( prvTCPSocketCopy( pxNewSocket, pxSocket ) == pdFALSE )
+			{
+				/* prvTCPSocketCopy() has closed the new socket. */
+				xListenStatistics.ulSocketFailures++;
+				pxNewSocket = NULL;
+			}
+			else
+			{
+				pxTCPWindow = &( pxNewSocket->u.xTCP.xTCPWindow );
+
+				/* This is what prvHandleListen() does for a SYN. */
+				pxNewSocket->u.xTCP.usRemotePort = xEntry.usRemotePort;
+				pxNewSocket->u.xTCP.ulRemoteIP = xEntry.ulRemoteIP;
+				pxTCPWindow->ulOurSequenceNumber = xEntry.ulOurSequenceNumber;
+				pxTCPWindow->rx.ulCurrentSequenceNumber = xEntry.ulPeerSequenceNumber;
+				prvSocketSetMSS( pxNewSocket );
+				prvTCPCreateWindow( pxNewSocket );
+
+				/* This is what prvCheckOptions() would have learned from the
+				options of the SYN. */
+				if( ( xEntry.usPeerMSS != 0u ) && ( xEntry.usPeerMSS < pxNewSocket->u.xTCP.usInitMSS ) )
+				{
+					pxNewSocket->u.xTCP.bits.bMssChange = pdTRUE_UNSIGNED;
+					pxTCPWindow->xSize.ulRxWindowLength = ( ( uint32_t ) xEntry.usPeerMSS ) * ( pxTCPWindow->xSize.ulRxWindowLength / ( ( uint32_t ) xEntry.usPeerMSS ) );
+					pxTCPWindow->usMSSInit = xEntry.usPeerMSS;
+					pxTCPWindow->usMSS = xEntry.usPeerMSS;
+					pxNewSocket->u.xTCP.usInitMSS = xEntry.usPeerMSS;
+					pxNewSocket->u.xTCP.usCurMSS = xEntry.usPeerMSS;
+				}
+				#if( ipconfigUSE_TCP_WIN != 0 )
+				{
+					if( xEntry.bits.bWinScaling != pdFALSE_UNSIGNED )
+					{
+						pxNewSocket->u.xTCP.ucPeerWinScaleFactor = xEntry.ucPeerWinScaleFactor;
+						pxNewSocket->u.xTCP.bits.bWinScaling = pdTRUE_UNSIGNED;
+					}
+					pxNewSocket->u.xTCP.ucMyWinScaleFactor = prvWinScaleFactor( pxNewSocket->u.xTCP.uxRxWinSize, ( size_t ) pxNewSocket->u.xTCP.usInitMSS );
+				}
+				#endif
+				#if( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+				{
+					if( xEntry.bits.bTimeStamps != pdFALSE_UNSIGNED )
+					{
+						pxNewSocket->u.xTCP.bits.bTimeStamps = pdTRUE_UNSIGNED;
+						pxNewSocket->u.xTCP.ulTSRecent = xEntry.ulTSRecent;
+					}
+				}
+				#endif
+
+				/* And this is the state after sending the SYN+ACK, see
+				eSYN_FIRST in prvTCPHandleState().  The ACK will now be handled
+				as usual, and make the connection established. */
+				vTCPStateChange( pxNewSocket, eSYN_RECEIVED );
+				pxTCPWindow->rx.ulCurrentSequenceNumber = pxTCPWindow->rx.ulHighestSequenceNumber = xEntry.ulPeerSequenceNumber + 1u;
+				pxTCPWindow->tx.ulCurrentSequenceNumber = pxTCPWindow->ulNextTxSequenceNumber = pxTCPWindow->tx.ulFirstSequenceNumber + 1u;
+
+				/* Make a copy of the header up to the TCP header.  It is needed
+				later on, whenever data must be sent to the peer. */
+				memcpy( pxNewSocket->u.xTCP.xPacket.u.ucLastPacket, pxNetworkBuffer->pucEthernetBuffer, sizeof( pxNewSocket->u.xTCP.xPacket.u.ucLastPacket ) );
+
+				xListenStatistics.ulConnectionsCreated++;
+			}
+		}
+
+		return pxNewSocket;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvSynCacheReset( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxNetworkBuffer )
+	{
+	TCPPacket_t *pxTCPPacket = ( TCPPacket_t * ) ( pxNetworkBuffer->pucEthernetBuffer );
+	SynCacheEntry_t *pxEntry;
+
+		pxEntry = prvSynCacheLookup( FreeRTOS_ntohl( pxTCPPacket->xIPHeader.ulSourceIPAddress ),
+									 FreeRTOS_ntohs( pxTCPPacket->xTCPHeader.usSourcePort ),
+									 pxSocket->usLocalPort );
+
+		/* Only a RST with the expected sequence number is accepted, see
+		RFC 5961, section 3.2. */
+		if( ( pxEntry != NULL ) && ( FreeRTOS_ntohl( pxTCPPacket->xTCPHeader.ulSequenceNumber ) == ( pxEntry->ulPeerSequenceNumber + 1u ) ) )
+		{
+			pxEntry->bits.bInUse = pdFALSE_UNSIGNED;
+			xListenStatistics.ulResets++;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	void FreeRTOS_GetListenStatistics( TCPListenStatistics_t *pxStatistics )
+	{
+		*pxStatistics = xListenStatistics;
+	}
+
+#endif /* ipconfigTCP_SYN_CACHE_SIZE */
+/*-----------------------------------------------------------*/
+
 #if( ( ipconfigHAS_DEBUG_PRINTF != 0 ) || ( ipconfigHAS_PRINTF != 0 ) )
 
 	const char *FreeRTOS_GetTCPStateName( UBaseType_t ulState )
@@ -50,12 +50,12 @@
 #include "NetworkBufferManagement.h"
 #include "FreeRTOS_TCP_WIN.h"
 
-/* Constants used for Smoothed Round Trip Time (SRTT). */
-#define	winSRTT_INCREMENT_NEW 		2
-#define winSRTT_INCREMENT_CURRENT 	6
-#define	winSRTT_DECREMENT_NEW 		1
-#define winSRTT_DECREMENT_CURRENT 	7
-#define winSRTT_CAP_mS				50
+/* Constants used to calculate the retransmission time-out (RTO), see RFC 6298.
+SRTT follows a new measurement with a gain of 1/8, RTTVAR with a gain of 1/4. */
+#define winRTO_INITIAL_mS			1000
+#define winSRTT_GAIN_DIVISOR		8
+#define winRTTVAR_GAIN_DIVISOR		4
+#define winRTTVAR_FACTOR			4
 
 #if( ipconfigUSE_TCP_WIN == 1 )
 
@@ -181,6 +181,22 @@ extern void vListInsertGeneric( List_t * const pxList, ListItem_t * const pxNewL
 	static BaseType_t prvTCPWindowTxHasSpace( TCPWindow_t *pxWindow, uint32_t ulWindowSize );
 #endif /* ipconfigUSE_TCP_WIN == 1 */
 
+/*
+ * Take the first segment out of the transmission queue, it is about to be sent
+ * for the first time.
+ */
+#if( ipconfigUSE_TCP_WIN == 1 )
+	static TCPSegment_t *prvTCPWindowTxDequeue( TCPWindow_t *pxWindow );
+#endif /* ipconfigUSE_TCP_WIN == 1 */
+
+/*
+ * A segment is being sent: add it to the waiting queue and start its
+ * retransmission timer.
+ */
+#if( ipconfigUSE_TCP_WIN == 1 )
+	static void prvTCPWindowTxSent( TCPWindow_t *pxWindow, TCPSegment_t *pxSegment );
+#endif /* ipconfigUSE_TCP_WIN == 1 */
+
 /*
  * An acknowledge was received.  See if some outstanding data may be removed
  * from the transmission queue(s).
@@ -197,6 +213,59 @@ extern void vListInsertGeneric( List_t * const pxList, ListItem_t * const pxNewL
 	static uint32_t prvTCPWindowFastRetransmit( TCPWindow_t *pxWindow, uint32_t ulFirst );
 #endif /* ipconfigUSE_TCP_WIN == 1 */
 
+/*
+ * Returns the number of ms to wait for an ACK of 'pxSegment' before it will be
+ * retransmitted: the RTO, doubled for every earlier transmission.
+ */
+static uint32_t prvTCPWindowRetransmitTime( const TCPWindow_t *pxWindow, const TCPSegment_t *pxSegment );
+
+/*
+ * A segment is being sent again, count it in the statistics of the connection
+ * and in the MIB counters.
+ */
+static void prvTCPWindowCountRetransmit( TCPWindow_t *pxWindow );
+
+/*
+ * Set the congestion window and the slow start threshold to their initial
+ * values, and let the congestion control algorithm initialise its state.
+ */
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+	static void prvTCPWindowCongestionInit( TCPWindow_t *pxWindow, uint32_t ulSequenceNumber );
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
+/*
+ * The left side of the transmission window has advanced by 'ulBytesAcked'.
+ * Grow the congestion window, or handle a partial or full acknowledgement
+ * while in fast recovery.
+ */
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+	static void prvTCPWindowCongestionAck( TCPWindow_t *pxWindow, uint32_t ulBytesAcked );
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
+/*
+ * A loss was detected by duplicate ACKs or by SACK's: lower the slow start
+ * threshold and enter fast recovery.
+ */
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+	static void prvTCPWindowCongestionEnterRecovery( TCPWindow_t *pxWindow );
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
+/*
+ * The retransmission timer of 'pxSegment' has expired: shrink the congestion
+ * window to a single segment.
+ */
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+	static void prvTCPWindowCongestionTimeout( TCPWindow_t *pxWindow, const TCPSegment_t *pxSegment );
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
+/*
+ * Move the oldest unacknowledged segment from the waiting queue to the
+ * priority queue, so it will be retransmitted immediately.
+ */
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+	static BaseType_t prvTCPWindowRetransmitFirst( TCPWindow_t *pxWindow );
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
 /*-----------------------------------------------------------*/
 
 /* TCP segment pool. */
@@ -276,6 +345,49 @@ static portINLINE uint32_t ulTimerGetAge( TCPTimer_t *pxTimer )
 }
 /*-----------------------------------------------------------*/
 
+static uint32_t prvTCPWindowRetransmitTime( const TCPWindow_t *pxWindow, const TCPSegment_t *pxSegment )
+{
+uint32_t ulTime = ( uint32_t ) pxWindow->lRTO;
+uint32_t ulCount;
+
+	/* After a packet has been sent for the first time, it will wait 'lRTO' ms
+	for an ACK.  A second time it will wait '2 * lRTO' ms, each time doubling
+	the time-out, up to ipconfigTCP_RTO_MAX_MS.  'ucTransmitCount' has a
+	minimum of 1 once the segment has been sent. */
+	for( ulCount = 1u; ulCount < ( uint32_t ) pxSegment->u.bits.ucTransmitCount; ulCount++ )
+	{
+		if( ulTime >= ( uint32_t ) ipconfigTCP_RTO_MAX_MS )
+		{
+			break;
+		}
+		ulTime <<= 1;
+	}
+
+	if( ulTime > ( uint32_t ) ipconfigTCP_RTO_MAX_MS )
+	{
+		ulTime = ( uint32_t ) ipconfigTCP_RTO_MAX_MS;
+	}
+
+	return ulTime;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTCPWindowCountRetransmit( TCPWindow_t *pxWindow )
+{
+	#if( ipconfigUSE_TCP_INFO != 0 )
+	{
+		pxWindow->ulRetransmits++;
+	}
+	#else
+	{
+		( void ) pxWindow;
+	}
+	#endif /* ipconfigUSE_TCP_INFO */
+
+	ipMIB_INCREMENT( ulTCPRetransSegs );
+}
+/*-----------------------------------------------------------*/
+
 /* _HT_ GCC (using the settings that I'm using) checks for every public function if it is
 preceded by a prototype. Later this prototype will be located in list.h? */
 
@@ -615,14 +727,22 @@ void vTCPWindowCreate( TCPWindow_t *pxWindow, uint32_t ulRxWindowLength,
 	pxWindow->xSize.ulRxWindowLength = ulRxWindowLength;
 	pxWindow->xSize.ulTxWindowLength = ulTxWindowLength;
 
+	#if( ipconfigUSE_TCP_INFO != 0 )
+	{
+		/* The statistics are kept from the start of a connection. */
+		pxWindow->ulSegmentsIn = 0ul;
+		pxWindow->ulSegmentsOut = 0ul;
+		pxWindow->ulRetransmits = 0ul;
+		pxWindow->ulDupAcks = 0ul;
+	}
+	#endif /* ipconfigUSE_TCP_INFO */
+
 	vTCPWindowInit( pxWindow, ulAckNumber, ulSequenceNumber, ulMSS );
 }
 /*-----------------------------------------------------------*/
 
 void vTCPWindowInit( TCPWindow_t *pxWindow, uint32_t ulAckNumber, uint32_t ulSequenceNumber, uint32_t ulMSS )
 {
-const int32_t l500ms = 500;
-
 	pxWindow->u.ulFlags = 0ul;
 	pxWindow->u.bits.bHasInit = pdTRUE_UNSIGNED;
 
@@ -646,8 +766,11 @@ const int32_t l500ms = 500;
 	}
 	#endif /* ipconfigUSE_TCP_WIN == 1 */
 
-	/*Start with a timeout of 2 * 500 ms (1 sec). */
-	pxWindow->lSRTT = l500ms;
+	/* Until the round trip time has been measured, start with a time-out of
+	1 second, as recommended by RFC 6298. */
+	pxWindow->lSRTT = 0;
+	pxWindow->lRTTVar = 0;
+	pxWindow->lRTO = winRTO_INITIAL_mS;
 
 	/* Just for logging, to print relative sequence numbers. */
 	pxWindow->rx.ulFirstSequenceNumber = ulAckNumber;
@@ -670,6 +793,64 @@ const int32_t l500ms = 500;
 	/* The right-hand side of the transmit window. */
 	pxWindow->tx.ulHighestSequenceNumber = ulSequenceNumber;
 	pxWindow->ulOurSequenceNumber = ulSequenceNumber;
+
+	#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+	{
+		prvTCPWindowCongestionInit( pxWindow, ulSequenceNumber );
+	}
+	#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+}
+/*-----------------------------------------------------------*/
+
+void vTCPWindowUpdateRTT( TCPWindow_t *pxWindow, int32_t lRoundTripTime )
+{
+int32_t lDeviation;
+
+	if( lRoundTripTime < 0 )
+	{
+		lRoundTripTime = 0;
+	}
+
+	if( pxWindow->u.bits.bHasRTT == pdFALSE_UNSIGNED )
+	{
+		/* The first measurement:
+		SRTT = R, RTTVAR = R / 2 */
+		pxWindow->lSRTT = lRoundTripTime;
+		pxWindow->lRTTVar = lRoundTripTime / 2;
+		pxWindow->u.bits.bHasRTT = pdTRUE_UNSIGNED;
+	}
+	else
+	{
+		/* Next measurements, RTTVAR must be updated with the old SRTT:
+		RTTVAR = ( 3 / 4 ) * RTTVAR + ( 1 / 4 ) * | SRTT - R |
+		SRTT   = ( 7 / 8 ) * SRTT + ( 1 / 8 ) * R */
+		lDeviation = pxWindow->lSRTT - lRoundTripTime;
+
+		if( lDeviation < 0 )
+		{
+			lDeviation = -lDeviation;
+		}
+
+		pxWindow->lRTTVar += ( lDeviation - pxWindow->lRTTVar ) / winRTTVAR_GAIN_DIVISOR;
+		pxWindow->lSRTT += ( lRoundTripTime - pxWindow->lSRTT ) / winSRTT_GAIN_DIVISOR;
+	}
+
+	/* RTO = SRTT + max( G, 4 * RTTVAR ), where G is the clock granularity. */
+	pxWindow->lRTO = pxWindow->lSRTT +
+		FreeRTOS_max_int32( ( int32_t ) portTICK_PERIOD_MS, winRTTVAR_FACTOR * pxWindow->lRTTVar );
+
+	if( pxWindow->lRTO < ( int32_t ) ipconfigTCP_RTO_MIN_MS )
+	{
+		pxWindow->lRTO = ( int32_t ) ipconfigTCP_RTO_MIN_MS;
+	}
+	else if( pxWindow->lRTO > ( int32_t ) ipconfigTCP_RTO_MAX_MS )
+	{
+		pxWindow->lRTO = ( int32_t ) ipconfigTCP_RTO_MAX_MS;
+	}
+	else
+	{
+		/* The RTO is within its limits. */
+	}
 }
 /*-----------------------------------------------------------*/
 
@@ -1187,6 +1368,17 @@ const int32_t l500ms = 500;
 			{
 				xHasSpace = pdFALSE;
 			}
+
+			#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+			{
+				/* The congestion window limits the outstanding data in the
+				same way. */
+				if( ( ulTxOutstanding != 0UL ) && ( pxWindow->xCongestion.ulCWnd < ulTxOutstanding + ( ( uint32_t ) pxSegment->lDataLength ) ) )
+				{
+					xHasSpace = pdFALSE;
+				}
+			}
+			#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
 		}
 
 		return xHasSpace;
@@ -1221,11 +1413,7 @@ const int32_t l500ms = 500;
 				/* There is an outstanding segment, see if it is time to resend
 				it. */
 				ulAge = ulTimerGetAge( &pxSegment->xTransmitTimer );
-
-				/* After a packet has been sent for the first time, it will wait
-				'1 * lSRTT' ms for an ACK. A second time it will wait '2 * lSRTT' ms,
-				each time doubling the time-out */
-				ulMaxAge = ( 1u << pxSegment->u.bits.ucTransmitCount ) * ( ( uint32_t ) pxWindow->lSRTT );
+				ulMaxAge = prvTCPWindowRetransmitTime( pxWindow, pxSegment );
 
 				if( ulMaxAge > ulAge )
 				{
@@ -1297,7 +1485,7 @@ const int32_t l500ms = 500;
 			if( pxSegment != NULL )
 			{
 				/* Do check the timing. */
-				ulMaxTime = ( 1u << pxSegment->u.bits.ucTransmitCount ) * ( ( uint32_t ) pxWindow->lSRTT );
+				ulMaxTime = prvTCPWindowRetransmitTime( pxWindow, pxSegment );
 
 				if( ulTimerGetAge( &pxSegment->xTransmitTimer ) > ulMaxTime )
 				{
@@ -1306,6 +1494,12 @@ const int32_t l500ms = 500;
 					pxSegment = xTCPWindowGetHead( &( pxWindow->xWaitQueue ) );
 					pxSegment->u.bits.ucDupAckCount = pdFALSE_UNSIGNED;
 
+					#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+					{
+						prvTCPWindowCongestionTimeout( pxWindow, pxSegment );
+					}
+					#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
 					/* Some detailed logging. */
 					if( ( xTCPWindowLoggingLevel != 0 ) && ( ipconfigTCP_MAY_LOG_PORT( pxWindow->usOurPortNumber ) != 0 ) )
 					{
@@ -1349,18 +1543,7 @@ const int32_t l500ms = 500;
 				else
 				{
 					/* Move it out of the Tx queue. */
-					pxSegment = xTCPWindowGetHead( &( pxWindow->xTxQueue ) );
-
-					/* Don't let pxHeadSegment point to this segment any more,
-					so no more data will be added. */
-					if( pxWindow->pxHeadSegment == pxSegment )
-					{
-						pxWindow->pxHeadSegment = NULL;
-					}
-
-					/* pxWindow->tx.highest registers the highest sequence
-					number in our transmission window. */
-					pxWindow->tx.ulHighestSequenceNumber = pxSegment->ulSequenceNumber + ( ( uint32_t ) pxSegment->lDataLength );
+					pxSegment = prvTCPWindowTxDequeue( pxWindow );
 
 					/* ...and more detailed logging */
 					if( ( xTCPWindowLoggingLevel >= 2 ) && ( ipconfigTCP_MAY_LOG_PORT( pxWindow->usOurPortNumber ) != pdFALSE ) )
@@ -1395,21 +1578,74 @@ const int32_t l500ms = 500;
 		/* See if it has already been determined to return 0. */
 		if( ulReturn != 0UL )
 		{
-			configASSERT( listLIST_ITEM_CONTAINER( &(pxSegment->xQueueItem ) ) == NULL );
+			prvTCPWindowTxSent( pxWindow, pxSegment );
+
+			pxWindow->ulOurSequenceNumber = pxSegment->ulSequenceNumber;
+
+			/* Inform the caller where to find the data within the queue. */
+			*plPosition = pxSegment->lStreamPos;
+
+			/* And return the length of the data segment */
+			ulReturn = ( uint32_t ) pxSegment->lDataLength;
+		}
+
+		return ulReturn;
+	}
+
+#endif /* ipconfigUSE_TCP_WIN == 1 */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_WIN == 1 )
+
+	static TCPSegment_t *prvTCPWindowTxDequeue( TCPWindow_t *pxWindow )
+	{
+	TCPSegment_t *pxSegment = xTCPWindowGetHead( &( pxWindow->xTxQueue ) );
+
+		/* Don't let pxHeadSegment point to this segment any more, so no more
+		data will be added. */
+		if( pxWindow->pxHeadSegment == pxSegment )
+		{
+			pxWindow->pxHeadSegment = NULL;
+		}
 
-			/* Now that the segment will be transmitted, add it to the tail of
-			the waiting queue. */
-			vListInsertFifo( &pxWindow->xWaitQueue, &pxSegment->xQueueItem );
+		/* pxWindow->tx.highest registers the highest sequence number in our
+		transmission window. */
+		pxWindow->tx.ulHighestSequenceNumber = pxSegment->ulSequenceNumber + ( ( uint32_t ) pxSegment->lDataLength );
 
-			/* And mark it as outstanding. */
-			pxSegment->u.bits.bOutstanding = pdTRUE_UNSIGNED;
+		return pxSegment;
+	}
+
+#endif /* ipconfigUSE_TCP_WIN == 1 */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_WIN == 1 )
+
+	static void prvTCPWindowTxSent( TCPWindow_t *pxWindow, TCPSegment_t *pxSegment )
+	{
+		configASSERT( listLIST_ITEM_CONTAINER( &(pxSegment->xQueueItem ) ) == NULL );
 
-			/* Administer the transmit count, needed for fast
-			retransmissions. */
-			( pxSegment->u.bits.ucTransmitCount )++;
+		/* Now that the segment will be transmitted, add it to the tail of
+		the waiting queue. */
+		vListInsertFifo( &pxWindow->xWaitQueue, &pxSegment->xQueueItem );
 
-			/* If there have been several retransmissions (4), decrease the
-			size of the transmission window to at most 2 times MSS. */
+		/* And mark it as outstanding. */
+		pxSegment->u.bits.bOutstanding = pdTRUE_UNSIGNED;
+
+		/* Administer the transmit count, needed for fast
+		retransmissions. */
+		( pxSegment->u.bits.ucTransmitCount )++;
+
+		if( pxSegment->u.bits.ucTransmitCount > 1u )
+		{
+			prvTCPWindowCountRetransmit( pxWindow );
+		}
+
+		/* If there have been several retransmissions (4), decrease the
+		size of the transmission window to at most 2 times MSS.  When
+		congestion control is used, the congestion window has already
+		been reduced, and it will grow again when the path recovers. */
+		#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 0 )
+		{
 			if( pxSegment->u.bits.ucTransmitCount == MAX_TRANSMIT_COUNT_USING_LARGE_WINDOW )
 			{
 				if( pxWindow->xSize.ulTxWindowLength > ( 2U * pxWindow->usMSS ) )
@@ -1420,23 +1656,43 @@ const int32_t l500ms = 500;
 					pxWindow->xSize.ulTxWindowLength = ( 2UL * pxWindow->usMSS );
 				}
 			}
+		}
+		#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL == 0 */
 
-			/* Clear the transmit timer. */
-			vTCPTimerSet( &( pxSegment->xTransmitTimer ) );
+		/* Clear the transmit timer. */
+		vTCPTimerSet( &( pxSegment->xTransmitTimer ) );
+	}
 
-			pxWindow->ulOurSequenceNumber = pxSegment->ulSequenceNumber;
+#endif /* ipconfigUSE_TCP_WIN == 1 */
+/*-----------------------------------------------------------*/
 
-			/* Inform the caller where to find the data within the queue. */
-			*plPosition = pxSegment->lStreamPos;
+#if( ( ipconfigUSE_TCP_WIN == 1 ) && ( ipconfigUSE_DRIVER_OFFLOADS != 0 ) )
 
-			/* And return the length of the data segment */
+	uint32_t ulTCPWindowTxGetNext( TCPWindow_t *pxWindow, uint32_t ulWindowSize, uint32_t ulLength, uint32_t ulMaxLength )
+	{
+	TCPSegment_t *pxSegment = xTCPWindowPeekHead( &( pxWindow->xTxQueue ) );
+	uint32_t ulReturn = 0UL;
+
+		/* Only whole segments are combined, so the driver will cut the frame
+		at the same boundaries as the segments of the window.  The segment must
+		follow the data that has been fetched already, which rules out the
+		retransmission of a segment in the middle of the window. */
+		if( ( pxSegment != NULL ) &&
+			( ( ulLength % ( uint32_t ) pxWindow->usMSS ) == 0UL ) &&
+			( pxSegment->ulSequenceNumber == ( pxWindow->ulOurSequenceNumber + ulLength ) ) &&
+			( ( uint32_t ) pxSegment->lDataLength <= ulMaxLength ) &&
+			( ( pxWindow->u.bits.bSendFullSize == pdFALSE_UNSIGNED ) || ( pxSegment->lDataLength >= pxSegment->lMaxLength ) ) &&
+			( prvTCPWindowTxHasSpace( pxWindow, ulWindowSize ) != pdFALSE ) )
+		{
+			pxSegment = prvTCPWindowTxDequeue( pxWindow );
+			prvTCPWindowTxSent( pxWindow, pxSegment );
 			ulReturn = ( uint32_t ) pxSegment->lDataLength;
 		}
 
 		return ulReturn;
 	}
 
-#endif /* ipconfigUSE_TCP_WIN == 1 */
+#endif /* ( ipconfigUSE_TCP_WIN == 1 ) && ( ipconfigUSE_DRIVER_OFFLOADS != 0 ) */
 /*-----------------------------------------------------------*/
 
 #if( ipconfigUSE_TCP_WIN == 1 )
@@ -1456,19 +1712,9 @@ const int32_t l500ms = 500;
 		contiguous block.  Note that the segments are stored in xTxSegments in a
 		strict sequential order. */
 
-		/* SRTT[i] = (1-a) * SRTT[i-1] + a * RTT
-
-		0 < a < 1; usually a = 1/8
-
-		RTO = 2 * SRTT
-
-		where:
-		  RTT is Round Trip Time
-		  SRTT is Smoothed RTT
-		  RTO is Retransmit timeout
-
-		 A Smoothed RTT will increase quickly, but it is conservative when
-		 becoming smaller. */
+		/* The round trip time is measured with the help of the segment that
+		is confirmed last, see vTCPWindowUpdateRTT().  When TCP time-stamps are
+		in use, FreeRTOS_TCP_IP.c measures it with the echoed time-stamps. */
 
 		for(
 				pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxEnd );
@@ -1523,27 +1769,13 @@ const int32_t l500ms = 500;
 				pxSegment->u.bits.bAcked = pdTRUE_UNSIGNED;
 
 				/* Calculate the RTT only if the segment was sent-out for the
-				first time and if this is the last ACK'd segment in a range. */
-				if( ( pxSegment->u.bits.ucTransmitCount == 1 ) && ( ( pxSegment->ulSequenceNumber + ulDataLength ) == ulLast ) )
+				first time (Karn's algorithm) and if this is the last ACK'd
+				segment in a range. */
+				if( ( pxWindow->u.bits.bTimeStamps == pdFALSE_UNSIGNED ) &&
+					( pxSegment->u.bits.ucTransmitCount == 1 ) &&
+					( ( pxSegment->ulSequenceNumber + ulDataLength ) == ulLast ) )
 				{
-					int32_t mS = ( int32_t ) ulTimerGetAge( &( pxSegment->xTransmitTimer ) );
-
-					if( pxWindow->lSRTT >= mS )
-					{
-						/* RTT becomes smaller: adapt slowly. */
-						pxWindow->lSRTT = ( ( winSRTT_DECREMENT_NEW * mS ) + ( winSRTT_DECREMENT_CURRENT * pxWindow->lSRTT ) ) / ( winSRTT_DECREMENT_NEW + winSRTT_DECREMENT_CURRENT );
-					}
-					else
-					{
-						/* RTT becomes larger: adapt quicker */
-						pxWindow->lSRTT = ( ( winSRTT_INCREMENT_NEW * mS ) + ( winSRTT_INCREMENT_CURRENT * pxWindow->lSRTT ) ) / ( winSRTT_INCREMENT_NEW + winSRTT_INCREMENT_CURRENT );
-					}
-
-					/* Cap to the minimum of 50ms. */
-					if( pxWindow->lSRTT < winSRTT_CAP_mS )
-					{
-						pxWindow->lSRTT = winSRTT_CAP_mS;
-					}
+					vTCPWindowUpdateRTT( pxWindow, ( int32_t ) ulTimerGetAge( &( pxSegment->xTransmitTimer ) ) );
 				}
 
 				/* Unlink it from the 3 queues, but do not destroy it (yet). */
@@ -1665,6 +1897,15 @@ const int32_t l500ms = 500;
 		else
 		{
 			ulReturn = prvTCPWindowTxCheckAck( pxWindow, ulFirstSequence, ulSequenceNumber );
+
+			#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+			{
+				if( ulReturn != 0UL )
+				{
+					prvTCPWindowCongestionAck( pxWindow, ulReturn );
+				}
+			}
+			#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
 		}
 
 		return ulReturn;
@@ -1682,7 +1923,20 @@ const int32_t l500ms = 500;
 
 		/* Receive a SACK option. */
 		ulAckCount = prvTCPWindowTxCheckAck( pxWindow, ulFirst, ulLast );
-		prvTCPWindowFastRetransmit( pxWindow, ulFirst );
+
+		#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+		{
+			/* A retransmission because of SACK's starts a fast recovery. */
+			if( prvTCPWindowFastRetransmit( pxWindow, ulFirst ) != 0UL )
+			{
+				prvTCPWindowCongestionEnterRecovery( pxWindow );
+			}
+		}
+		#else
+		{
+			prvTCPWindowFastRetransmit( pxWindow, ulFirst );
+		}
+		#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
 
 		if( ( xTCPWindowLoggingLevel >= 1 ) && ( xSequenceGreaterThan( ulFirst, ulCurrentSequenceNumber ) != pdFALSE ) )
 		{
@@ -1701,6 +1955,256 @@ const int32_t l500ms = 500;
 #endif /* ipconfigUSE_TCP_WIN == 1 */
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+
+	void vTCPWindowTxDupAck( TCPWindow_t *pxWindow, uint32_t ulSequenceNumber )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+
+		/* Only an ACK for the left side of the transmission window, while there
+		is outstanding data, counts as a duplicate ACK. */
+		if( ( ulSequenceNumber == pxWindow->tx.ulCurrentSequenceNumber ) &&
+			( pxWindow->tx.ulHighestSequenceNumber != pxWindow->tx.ulCurrentSequenceNumber ) )
+		{
+			if( pxCongestion->ucDupAckCount < 0xffu )
+			{
+				pxCongestion->ucDupAckCount++;
+			}
+
+			if( pxCongestion->ucInRecovery != pdFALSE_UNSIGNED )
+			{
+				/* Every duplicate ACK means that a segment has left the network,
+				inflate the window so new data may be sent. */
+				pxCongestion->ulCWnd += ( uint32_t ) pxWindow->usMSS;
+			}
+			else if( ( pxCongestion->ucDupAckCount == DUPLICATE_ACKS_BEFORE_FAST_RETRANSMIT ) &&
+					 ( xSequenceGreaterThanOrEqual( ulSequenceNumber, pxCongestion->ulRecover ) != pdFALSE ) )
+			{
+				/* Duplicate ACKs for data sent before an earlier loss was
+				detected do not start a new recovery (RFC 6582). */
+				if( prvTCPWindowRetransmitFirst( pxWindow ) != pdFALSE )
+				{
+					if( ( xTCPWindowLoggingLevel >= 0 ) && ( ipconfigTCP_MAY_LOG_PORT( pxWindow->usOurPortNumber ) != pdFALSE ) )
+					{
+						FreeRTOS_debug_printf( ( "vTCPWindowTxDupAck[%u,%u]: Requeue sequence number %lu\n",
+							pxWindow->usPeerPortNumber,
+							pxWindow->usOurPortNumber,
+							ulSequenceNumber - pxWindow->tx.ulFirstSequenceNumber ) );
+						FreeRTOS_flush_logging( );
+					}
+
+					prvTCPWindowCongestionEnterRecovery( pxWindow );
+				}
+			}
+		}
+	}
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+
+	static void prvTCPWindowCongestionInit( TCPWindow_t *pxWindow, uint32_t ulSequenceNumber )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+	const TCPCongestionOps_t *pxOps = pxCongestion->pxOps;
+
+		/* The algorithm may have been chosen with FREERTOS_SO_TCP_CONGESTION
+		before the connection was made. */
+		if( pxOps == NULL )
+		{
+			pxOps = &( ipconfigTCP_CONGESTION_DEFAULT );
+		}
+
+		memset( pxCongestion, '\0', sizeof( *pxCongestion ) );
+		pxCongestion->pxOps = pxOps;
+
+		/* Start with a small window in slow start.  The slow start threshold
+		is as high as possible, it will be lowered after the first loss. */
+		pxCongestion->ulCWnd = ( uint32_t ) ipconfigTCP_INITIAL_CWND_SEGMENTS * ( uint32_t ) pxWindow->usMSS;
+		pxCongestion->ulSSThresh = 0xFFFFFFFFUL;
+		pxCongestion->ulRecover = ulSequenceNumber;
+
+		if( pxOps->fnInit != NULL )
+		{
+			pxOps->fnInit( pxWindow );
+		}
+	}
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+
+	static void prvTCPWindowCongestionAck( TCPWindow_t *pxWindow, uint32_t ulBytesAcked )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+	uint32_t ulMSS = ( uint32_t ) pxWindow->usMSS;
+	uint32_t ulFlightSize;
+
+		pxCongestion->ucDupAckCount = 0u;
+
+		if( pxCongestion->ucInRecovery == pdFALSE_UNSIGNED )
+		{
+			pxCongestion->pxOps->fnOnAck( pxWindow, ulBytesAcked );
+
+			/* There is no use in growing beyond the self-imposed limit of the
+			transmission window. */
+			pxCongestion->ulCWnd = FreeRTOS_min_uint32( pxCongestion->ulCWnd, pxWindow->xSize.ulTxWindowLength );
+		}
+		else if( xSequenceGreaterThanOrEqual( pxWindow->tx.ulCurrentSequenceNumber, pxCongestion->ulRecover ) != pdFALSE )
+		{
+			/* A full acknowledgement: all data that was outstanding when the
+			loss was detected has arrived.  Leave fast recovery and deflate the
+			window. */
+			ulFlightSize = pxWindow->tx.ulHighestSequenceNumber - pxWindow->tx.ulCurrentSequenceNumber;
+			pxCongestion->ulCWnd = FreeRTOS_min_uint32( pxCongestion->ulSSThresh, FreeRTOS_max_uint32( ulFlightSize, ulMSS ) + ulMSS );
+			pxCongestion->ucInRecovery = pdFALSE_UNSIGNED;
+		}
+		else
+		{
+			/* A partial acknowledgement: the next segment was lost as well.
+			Retransmit it now, and deflate the window by the amount of data
+			that was acknowledged. */
+			( void ) prvTCPWindowRetransmitFirst( pxWindow );
+
+			pxCongestion->ulCWnd -= FreeRTOS_min_uint32( pxCongestion->ulCWnd, ulBytesAcked );
+
+			if( ulBytesAcked >= ulMSS )
+			{
+				pxCongestion->ulCWnd += ulMSS;
+			}
+
+			pxCongestion->ulCWnd = FreeRTOS_max_uint32( pxCongestion->ulCWnd, ulMSS );
+		}
+	}
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+
+	static void prvTCPWindowCongestionEnterRecovery( TCPWindow_t *pxWindow )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+	uint32_t ulFlightSize;
+
+		if( pxCongestion->ucInRecovery == pdFALSE_UNSIGNED )
+		{
+			ulFlightSize = pxWindow->tx.ulHighestSequenceNumber - pxWindow->tx.ulCurrentSequenceNumber;
+			pxCongestion->ulSSThresh = pxCongestion->pxOps->fnOnLoss( pxWindow, ulFlightSize );
+
+			/* The three duplicate ACKs stand for segments that have left the
+			network. */
+			pxCongestion->ulCWnd = pxCongestion->ulSSThresh + ( DUPLICATE_ACKS_BEFORE_FAST_RETRANSMIT * ( uint32_t ) pxWindow->usMSS );
+			pxCongestion->ulBytesAcked = 0UL;
+			pxCongestion->ulRecover = pxWindow->tx.ulHighestSequenceNumber;
+			pxCongestion->ucInRecovery = pdTRUE_UNSIGNED;
+			pxCongestion->ulFastRetransmits++;
+
+			if( ( xTCPWindowLoggingLevel != 0 ) && ( ipconfigTCP_MAY_LOG_PORT( pxWindow->usOurPortNumber ) != pdFALSE ) )
+			{
+				FreeRTOS_debug_printf( ( "TCP %s[%u,%u]: fast recovery, cwnd %lu ssthresh %lu\n",
+					pxCongestion->pxOps->pcName,
+					pxWindow->usPeerPortNumber,
+					pxWindow->usOurPortNumber,
+					pxCongestion->ulCWnd,
+					pxCongestion->ulSSThresh ) );
+			}
+		}
+	}
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+
+	static void prvTCPWindowCongestionTimeout( TCPWindow_t *pxWindow, const TCPSegment_t *pxSegment )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+	uint32_t ulFlightSize;
+
+		/* The slow start threshold is only lowered once for the data that
+		was outstanding when the loss was detected, not for every segment that
+		times out, nor for repeated time-outs of the same segment. */
+		if( xSequenceGreaterThanOrEqual( pxSegment->ulSequenceNumber, pxCongestion->ulRecover ) != pdFALSE )
+		{
+			ulFlightSize = pxWindow->tx.ulHighestSequenceNumber - pxWindow->tx.ulCurrentSequenceNumber;
+			pxCongestion->ulSSThresh = pxCongestion->pxOps->fnOnLoss( pxWindow, ulFlightSize );
+			pxCongestion->ulRecover = pxWindow->tx.ulHighestSequenceNumber;
+		}
+
+		/* Start all over in slow start. */
+		pxCongestion->ulCWnd = ( uint32_t ) pxWindow->usMSS;
+		pxCongestion->ulBytesAcked = 0UL;
+		pxCongestion->ucDupAckCount = 0u;
+		pxCongestion->ucInRecovery = pdFALSE_UNSIGNED;
+		pxCongestion->ulTimeouts++;
+	}
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+
+	static BaseType_t prvTCPWindowRetransmitFirst( TCPWindow_t *pxWindow )
+	{
+	TCPSegment_t *pxSegment;
+	BaseType_t xReturn = pdFALSE;
+
+		/* The segments in xTxSegments are sorted on sequence number, the head
+		is the oldest segment that has not been acknowledged yet. */
+		pxSegment = xTCPWindowPeekHead( &( pxWindow->xTxSegments ) );
+
+		if( ( pxSegment != NULL ) &&
+			( pxSegment->u.bits.bAcked == pdFALSE_UNSIGNED ) &&
+			( listLIST_ITEM_CONTAINER( &( pxSegment->xQueueItem ) ) == &( pxWindow->xWaitQueue ) ) )
+		{
+			/* Like in prvTCPWindowFastRetransmit(), the retransmission starts
+			with a fresh time-out. */
+			pxSegment->u.bits.ucTransmitCount = pdFALSE_UNSIGNED;
+			uxListRemove( &( pxSegment->xQueueItem ) );
+			vListInsertFifo( &( pxWindow->xPriorityQueue ), &( pxSegment->xQueueItem ) );
+			xReturn = pdTRUE;
+		}
+
+		return xReturn;
+	}
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_INFO != 0 )
+
+	uint32_t ulTCPWindowTxInFlight( const TCPWindow_t *pxWindow )
+	{
+	uint32_t ulInFlight = 0ul;
+
+		#if( ipconfigUSE_TCP_WIN == 1 )
+		{
+			/* 'tx.ulHighestSequenceNumber' follows the last byte sent. */
+			if( xSequenceGreaterThan( pxWindow->tx.ulHighestSequenceNumber, pxWindow->tx.ulCurrentSequenceNumber ) != pdFALSE )
+			{
+				ulInFlight = pxWindow->tx.ulHighestSequenceNumber - pxWindow->tx.ulCurrentSequenceNumber;
+			}
+		}
+		#else
+		{
+			/* Tiny TCP has at most one outstanding segment, its length is
+			cleared once it has been acknowledged. */
+			if( pxWindow->xTxSegment.u.bits.bOutstanding != pdFALSE_UNSIGNED )
+			{
+				ulInFlight = ( uint32_t ) pxWindow->xTxSegment.lDataLength;
+			}
+		}
+		#endif /* ipconfigUSE_TCP_WIN */
+
+		return ulInFlight;
+	}
+
+#endif /* ipconfigUSE_TCP_INFO */
+/*-----------------------------------------------------------*/
+
 /*
 #####   #                      #####   ####  ######
 # # #   #                      # # #  #    #  #    #
@@ -1809,8 +2313,7 @@ const int32_t l500ms = 500;
 
 			if( pxSegment->u.bits.bOutstanding != pdFALSE_UNSIGNED )
 			{
-				/* As 'ucTransmitCount' has a minimum of 1, take 2 * RTT */
-				ulMaxTime = ( ( uint32_t ) 1u << pxSegment->u.bits.ucTransmitCount ) * ( ( uint32_t ) pxWindow->lSRTT );
+				ulMaxTime = prvTCPWindowRetransmitTime( pxWindow, pxSegment );
 
 				if( ulTimerGetAge( &( pxSegment->xTransmitTimer ) ) < ulMaxTime )
 				{
@@ -1822,6 +2325,12 @@ const int32_t l500ms = 500;
 			{
 				pxSegment->u.bits.bOutstanding = pdTRUE_UNSIGNED;
 				pxSegment->u.bits.ucTransmitCount++;
+
+				if( pxSegment->u.bits.ucTransmitCount > 1u )
+				{
+					prvTCPWindowCountRetransmit( pxWindow );
+				}
+
 				vTCPTimerSet (&pxSegment->xTransmitTimer);
 				pxWindow->ulOurSequenceNumber = pxSegment->ulSequenceNumber;
 				*plPosition = pxSegment->lStreamPos;
@@ -1898,7 +2407,7 @@ const int32_t l500ms = 500;
 			if( pxSegment->u.bits.bOutstanding != pdFALSE_UNSIGNED )
 			{
 				ulAge = ulTimerGetAge ( &pxSegment->xTransmitTimer );
-				ulMaxAge = ( ( TickType_t ) 1u << pxSegment->u.bits.ucTransmitCount ) * ( ( uint32_t ) pxWindow->lSRTT );
+				ulMaxAge = prvTCPWindowRetransmitTime( pxWindow, pxSegment );
 
 				if( ulMaxAge > ulAge )
 				{
@@ -1952,6 +2461,13 @@ const int32_t l500ms = 500;
 			{
 				pxWindow->tx.ulCurrentSequenceNumber += ulDataLength;
 
+				/* Measure the RTT only if the segment was sent-out once
+				(Karn's algorithm). */
+				if( pxSegment->u.bits.ucTransmitCount == 1 )
+				{
+					vTCPWindowUpdateRTT( pxWindow, ( int32_t ) ulTimerGetAge( &( pxSegment->xTransmitTimer ) ) );
+				}
+
 				if( ( xTCPWindowLoggingLevel != 0 ) && ( ipconfigTCP_MAY_LOG_PORT( pxWindow->usOurPortNumber ) != pdFALSE ) )
 				{
 					FreeRTOS_debug_printf( ( "win_tx_ack: acked seqnr %ld len %ld\n",
@@ -42,6 +42,8 @@
 #include "FreeRTOS_DHCP.h"
 #include "NetworkInterface.h"
 #include "NetworkBufferManagement.h"
+#include "FreeRTOS_Routing.h"
+#include "FreeRTOS_IPv6.h"
 
 #if( ipconfigUSE_DNS == 1 )
 	#include "FreeRTOS_DNS.h"
@@ -72,18 +74,37 @@ UDPPacketHeader_t xDefaultPartUDPPacketHeader =
 };
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_CHECKSUM_KERNELS != 0 )
+	/*
+	 * Set the checksum of a UDP packet of which the payload was summed while
+	 * it was copied.  Only the pseudo header and the UDP header are left.
+	 */
+	static void prvSetUDPChecksum( UDPPacket_t *pxUDPPacket, uint16_t usPayloadChecksum );
+#endif
+/*-----------------------------------------------------------*/
+
 void vProcessGeneratedUDPPacket( NetworkBufferDescriptor_t * const pxNetworkBuffer )
 {
 UDPPacket_t *pxUDPPacket;
 IPHeader_t *pxIPHeader;
 eARPLookupResult_t eReturned;
 uint32_t ulIPAddress = pxNetworkBuffer->ulIPAddress;
+BaseType_t xWaitingForARP = pdFALSE;
 
 	/* Map the UDP packet onto the start of the frame. */
 	pxUDPPacket = ( UDPPacket_t * ) pxNetworkBuffer->pucEthernetBuffer;
 
 	/* Determine the ARP cache status for the requested IP address. */
-	eReturned = eARPGetCacheEntry( &( ulIPAddress ), &( pxUDPPacket->xEthernetHeader.xDestinationAddress ) );
+	#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+	{
+		/* Also find the end-point that will send the packet. */
+		eReturned = eARPGetCacheEntryOnEndPoint( &( ulIPAddress ), &( pxUDPPacket->xEthernetHeader.xDestinationAddress ), &( pxNetworkBuffer->pxEndPoint ) );
+	}
+	#else
+	{
+		eReturned = eARPGetCacheEntry( &( ulIPAddress ), &( pxUDPPacket->xEthernetHeader.xDestinationAddress ) );
+	}
+	#endif /* ipconfigUSE_MULTI_INTERFACE */
 
 	if( eReturned != eCantSendPacket )
 	{
@@ -144,11 +165,13 @@ uint32_t ulIPAddress = pxNetworkBuffer->ulIPAddress;
 			{
 				pxIPHeader->ucProtocol = ipPROTOCOL_ICMP;
 				pxIPHeader->usLength = ( uint16_t ) ( pxNetworkBuffer->xDataLength + sizeof( IPHeader_t ) );
+				ipMIB_INCREMENT( ulICMPOutMsgs );
 			}
 			else
 		#endif /* ipconfigSUPPORT_OUTGOING_PINGS */
 			{
 				pxIPHeader->usLength = ( uint16_t ) ( pxNetworkBuffer->xDataLength + sizeof( IPHeader_t ) + sizeof( UDPHeader_t ) );
+				ipMIB_INCREMENT( ulUDPOutDatagrams );
 			}
 
 			/* The total transmit size adds on the Ethernet header. */
@@ -157,6 +180,14 @@ uint32_t ulIPAddress = pxNetworkBuffer->ulIPAddress;
 			/* HT:endian: changed back to network endian */
 			pxIPHeader->ulDestinationIPAddress = pxNetworkBuffer->ulIPAddress;
 
+			#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+			{
+				/* The default header contains the address of the primary
+				end-point. */
+				pxIPHeader->ulSourceIPAddress = pxNetworkBuffer->pxEndPoint->ulIPAddress;
+			}
+			#endif /* ipconfigUSE_MULTI_INTERFACE */
+
 			#if( ipconfigUSE_LLMNR == 1 )
 			{
 				/* LLMNR messages are typically used on a LAN and they're
@@ -169,6 +200,7 @@ uint32_t ulIPAddress = pxNetworkBuffer->ulIPAddress;
 			#endif
 
 			#if( ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM == 0 )
+			if( ipHAS_OFFLOAD( pxNetworkBuffer, ipOFFLOAD_TX_CHECKSUM ) == pdFALSE )
 			{
 				pxIPHeader->usHeaderChecksum = 0u;
 				pxIPHeader->usHeaderChecksum = usGenerateChecksum( 0UL, ( uint8_t * ) &( pxIPHeader->ucVersionHeaderLength ), ipSIZE_OF_IPv4_HEADER );
@@ -176,7 +208,16 @@ uint32_t ulIPAddress = pxNetworkBuffer->ulIPAddress;
 
 				if( ( ucSocketOptions & ( uint8_t ) FREERTOS_SO_UDPCKSUM_OUT ) != 0u )
 				{
-					usGenerateProtocolChecksum( (uint8_t*)pxUDPPacket, pxNetworkBuffer->xDataLength, pdTRUE );
+					#if( ipconfigUSE_CHECKSUM_KERNELS != 0 )
+					if( ( pxNetworkBuffer->usPayloadChecksum != 0U ) && ( pxIPHeader->ucProtocol == ( uint8_t ) ipPROTOCOL_UDP ) )
+					{
+						prvSetUDPChecksum( pxUDPPacket, pxNetworkBuffer->usPayloadChecksum );
+					}
+					else
+					#endif
+					{
+						usGenerateProtocolChecksum( (uint8_t*)pxUDPPacket, pxNetworkBuffer->xDataLength, pdTRUE );
+					}
 				}
 				else
 				{
@@ -192,10 +233,22 @@ uint32_t ulIPAddress = pxNetworkBuffer->ulIPAddress;
 			outstanding, and perform retransmissions if necessary. */
 			vARPRefreshCacheEntry( NULL, ulIPAddress );
 
-			/* Generate an ARP for the required IP address. */
-			iptracePACKET_DROPPED_TO_GENERATE_ARP( pxNetworkBuffer->ulIPAddress );
-			pxNetworkBuffer->ulIPAddress = ulIPAddress;
-			vARPGenerateRequestPacket( pxNetworkBuffer );
+			#if( ipconfigARP_QUEUE_LENGTH > 0 )
+			if( xARPWaitForResolution( pxNetworkBuffer, ulIPAddress ) != pdFALSE )
+			{
+				/* The new entry holds the packet until the reply arrives, the
+				request is sent from a buffer of its own. */
+				FreeRTOS_OutputARPRequest( ulIPAddress );
+				xWaitingForARP = pdTRUE;
+			}
+			else
+			#endif /* ipconfigARP_QUEUE_LENGTH */
+			{
+				/* Generate an ARP for the required IP address. */
+				iptracePACKET_DROPPED_TO_GENERATE_ARP( pxNetworkBuffer->ulIPAddress );
+				pxNetworkBuffer->ulIPAddress = ulIPAddress;
+				vARPGenerateRequestPacket( pxNetworkBuffer );
+			}
 		}
 		else
 		{
@@ -204,8 +257,20 @@ uint32_t ulIPAddress = pxNetworkBuffer->ulIPAddress;
 			eReturned = eCantSendPacket;
 		}
 	}
+	#if( ipconfigARP_QUEUE_LENGTH > 0 )
+	else if( xARPWaitForResolution( pxNetworkBuffer, ulIPAddress ) != pdFALSE )
+	{
+		/* An ARP request for the next hop is outstanding, its entry holds the
+		packet until the reply arrives. */
+		xWaitingForARP = pdTRUE;
+	}
+	#endif /* ipconfigARP_QUEUE_LENGTH */
 
-	if( eReturned != eCantSendPacket )
+	if( xWaitingForARP != pdFALSE )
+	{
+		/* The packet is held by the ARP cache. */
+	}
+	else if( eReturned != eCantSendPacket )
 	{
 		/* The network driver is responsible for freeing the network buffer
 		after the packet has been sent. */
@@ -225,6 +290,7 @@ uint32_t ulIPAddress = pxNetworkBuffer->ulIPAddress;
 		}
 		#endif
 
+		ipCAPTURE_SENT( pxNetworkBuffer );
 		xNetworkInterfaceOutput( pxNetworkBuffer, pdTRUE );
 	}
 	else
@@ -236,6 +302,37 @@ uint32_t ulIPAddress = pxNetworkBuffer->ulIPAddress;
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_CHECKSUM_KERNELS != 0 )
+
+	static void prvSetUDPChecksum( UDPPacket_t *pxUDPPacket, uint16_t usPayloadChecksum )
+	{
+	uint32_t ulSum;
+	uint16_t usChecksum;
+
+		/* The protocol and length fields of the pseudo header, plus the sum of
+		the payload, folded into 16 bits. */
+		ulSum = ( uint32_t ) FreeRTOS_ntohs( pxUDPPacket->xUDPHeader.usLength ) + ( uint32_t ) ipPROTOCOL_UDP + usPayloadChecksum;
+		ulSum = ( ulSum & 0xffffUL ) + ( ulSum >> 16 );
+		ulSum = ( ulSum & 0xffffUL ) + ( ulSum >> 16 );
+
+		/* And then continue at the IPv4 source and destination addresses,
+		which are followed by the UDP header. */
+		pxUDPPacket->xUDPHeader.usChecksum = 0u;
+		usChecksum = ( uint16_t ) ~usGenerateChecksum( ulSum, ( uint8_t * ) &( pxUDPPacket->xIPHeader.ulSourceIPAddress ),
+			2u * sizeof( pxUDPPacket->xIPHeader.ulSourceIPAddress ) + ipSIZE_OF_UDP_HEADER );
+
+		if( usChecksum == 0u )
+		{
+			/* A checksum of zero would mean that it is not used. */
+			usChecksum = ( uint16_t ) 0xffffu;
+		}
+
+		pxUDPPacket->xUDPHeader.usChecksum = FreeRTOS_htons( usChecksum );
+	}
+
+#endif /* ipconfigUSE_CHECKSUM_KERNELS */
+/*-----------------------------------------------------------*/
+
 BaseType_t xProcessReceivedUDPPacket( NetworkBufferDescriptor_t *pxNetworkBuffer, uint16_t usPort )
 {
 BaseType_t xReturn = pdPASS;
@@ -251,8 +348,14 @@ UDPPacket_t *pxUDPPacket = (UDPPacket_t *) pxNetworkBuffer->pucEthernetBuffer;
 
 		/* When refreshing the ARP cache with received UDP packets we must be
 		careful;  hundreds of broadcast messages may pass and if we're not
-		handling them, no use to fill the ARP cache with those IP addresses. */
-		vARPRefreshCacheEntry( &( pxUDPPacket->xEthernetHeader.xSourceAddress ), pxUDPPacket->xIPHeader.ulSourceIPAddress );
+		handling them, no use to fill the ARP cache with those IP addresses.
+		An IPv6 packet was stored in the neighbour cache already. */
+		#if( ipconfigUSE_IPv6 != 0 )
+		if( pxNetworkBuffer->xUsesIPv6 == pdFALSE )
+		#endif
+		{
+			vARPRefreshCacheEntry( &( pxUDPPacket->xEthernetHeader.xSourceAddress ), pxUDPPacket->xIPHeader.ulSourceIPAddress );
+		}
 
 		#if( ipconfigUSE_CALLBACKS == 1 )
 		{
@@ -262,13 +365,40 @@ UDPPacket_t *pxUDPPacket = (UDPPacket_t *) pxNetworkBuffer->pucEthernetBuffer;
 				struct freertos_sockaddr xSourceAddress, destinationAddress;
 				void *pcData = ( void * ) &( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] );
 				FOnUDPReceive_t xHandler = ( FOnUDPReceive_t ) pxSocket->u.xUDP.pxHandleReceive;
-				xSourceAddress.sin_port = pxNetworkBuffer->usPort;
-				xSourceAddress.sin_addr = pxNetworkBuffer->ulIPAddress;
-				destinationAddress.sin_port = usPort;
-				destinationAddress.sin_addr = pxUDPPacket->xIPHeader.ulDestinationIPAddress;
+				struct freertos_sockaddr *pxSourceAddress = &xSourceAddress;
+				struct freertos_sockaddr *pxDestinationAddress = &destinationAddress;
+
+				#if( ipconfigUSE_IPv6 != 0 )
+					/* The handler can tell the addresses of an IPv6 packet by
+					their sin_family. */
+					struct freertos_sockaddr6 xSourceAddress6, xDestinationAddress6;
+
+					if( pxNetworkBuffer->xUsesIPv6 != pdFALSE )
+					{
+						xSourceAddress6.sin6_len = ( uint8_t ) sizeof( xSourceAddress6 );
+						xSourceAddress6.sin6_family = FREERTOS_AF_INET6;
+						xSourceAddress6.sin6_port = pxNetworkBuffer->usPort;
+						xSourceAddress6.sin6_flowinfo = 0UL;
+						memcpy( xSourceAddress6.sin6_addr.ucBytes, pxNetworkBuffer->xIPv6Address.ucBytes, sizeof( xSourceAddress6.sin6_addr.ucBytes ) );
+						xDestinationAddress6.sin6_len = ( uint8_t ) sizeof( xDestinationAddress6 );
+						xDestinationAddress6.sin6_family = FREERTOS_AF_INET6;
+						xDestinationAddress6.sin6_port = usPort;
+						xDestinationAddress6.sin6_flowinfo = 0UL;
+						memcpy( xDestinationAddress6.sin6_addr.ucBytes, &( pxNetworkBuffer->pucEthernetBuffer[ ipIPv6_UDP_DESTINATION_OFFSET ] ), sizeof( xDestinationAddress6.sin6_addr.ucBytes ) );
+						pxSourceAddress = ( struct freertos_sockaddr * ) &xSourceAddress6;
+						pxDestinationAddress = ( struct freertos_sockaddr * ) &xDestinationAddress6;
+					}
+					else
+				#endif /* ipconfigUSE_IPv6 */
+				{
+					xSourceAddress.sin_port = pxNetworkBuffer->usPort;
+					xSourceAddress.sin_addr = pxNetworkBuffer->ulIPAddress;
+					destinationAddress.sin_port = usPort;
+					destinationAddress.sin_addr = pxUDPPacket->xIPHeader.ulDestinationIPAddress;
+				}
 
 				if( xHandler( ( Socket_t * ) pxSocket, ( void* ) pcData, ( size_t ) pxNetworkBuffer->xDataLength,
-					&xSourceAddress, &destinationAddress ) )
+					pxSourceAddress, pxDestinationAddress ) )
 				{
 					xReturn = pdFAIL; /* FAIL means that we did not consume or release the buffer */
 				}
@@ -286,6 +416,7 @@ UDPPacket_t *pxUDPPacket = (UDPPacket_t *) pxNetworkBuffer->pucEthernetBuffer;
 						listCURRENT_LIST_LENGTH( &( pxSocket->u.xUDP.xWaitingPacketsList ) ),
 						pxSocket->u.xUDP.uxMaxPackets, pxSocket->usLocalPort ) );
 					xReturn = pdFAIL; /* we did not consume or release the buffer */
+					ipMIB_INCREMENT( ulUDPInErrors );
 				}
 			}
 		}
@@ -293,6 +424,8 @@ UDPPacket_t *pxUDPPacket = (UDPPacket_t *) pxNetworkBuffer->pucEthernetBuffer;
 
 		if( xReturn == pdPASS )
 		{
+			ipMIB_INCREMENT( ulUDPInDatagrams );
+
 			vTaskSuspendAll();
 			{
 				if( xReturn == pdPASS )
@@ -319,6 +452,12 @@ UDPPacket_t *pxUDPPacket = (UDPPacket_t *) pxNetworkBuffer->pucEthernetBuffer;
 				if( ( pxSocket->pxSocketSet != NULL ) && ( ( pxSocket->xSelectBits & eSELECT_READ ) != 0 ) )
 				{
 					xEventGroupSetBits( pxSocket->pxSocketSet->xSelectGroup, eSELECT_READ );
+
+					#if( ipconfigSUPPORT_SELECT_READY_LIST == 1 )
+					{
+						vSocketSelectReady( pxSocket, eSELECT_READ );
+					}
+					#endif /* ipconfigSUPPORT_SELECT_READY_LIST */
 				}
 			}
 			#endif
@@ -340,6 +479,15 @@ UDPPacket_t *pxUDPPacket = (UDPPacket_t *) pxNetworkBuffer->pucEthernetBuffer;
 				}
 			}
 			#endif
+
+			#if( ipconfigUSE_DNS == 1 ) && ( ipconfigDNS_USE_CALLBACKS != 0 )
+			{
+				if( xIsDNSSocket( pxSocket ) )
+				{
+					xSendEventToIPTask( eDNSEvent );
+				}
+			}
+			#endif
 		}
 	}
 	else
@@ -347,6 +495,15 @@ UDPPacket_t *pxUDPPacket = (UDPPacket_t *) pxNetworkBuffer->pucEthernetBuffer;
 		/* There is no socket listening to the target port, but still it might
 		be for this node. */
 
+		#if( ipconfigUSE_IPv6 != 0 )
+			/* LLMNR, DNS and NBNS are only handled for IPv4. */
+			if( pxNetworkBuffer->xUsesIPv6 != pdFALSE )
+			{
+				xReturn = pdFAIL;
+			}
+			else
+		#endif /* ipconfigUSE_IPv6 */
+
 		#if( ipconfigUSE_LLMNR == 1 )
 			/* a LLMNR request, check for the destination port. */
 			if( ( usPort == FreeRTOS_ntohs( ipLLMNR_PORT ) ) ||
@@ -358,6 +515,15 @@ UDPPacket_t *pxUDPPacket = (UDPPacket_t *) pxNetworkBuffer->pucEthernetBuffer;
 			else
 		#endif /* ipconfigUSE_LLMNR */
 
+		#if( ipconfigUSE_DNS == 1 ) && ( ipconfigUSE_DNS_CACHE == 1 ) && ( ipconfigDNS_CACHE_PREFETCH != 0 )
+			/* A late DNS reply, maybe to a request that refreshes the DNS cache. */
+			if( pxUDPPacket->xUDPHeader.usSourcePort == FreeRTOS_ntohs( ipDNS_PORT ) )
+			{
+				xReturn = ( BaseType_t )ulDNSHandlePacket( pxNetworkBuffer );
+			}
+			else
+		#endif /* ipconfigDNS_CACHE_PREFETCH */
+
 		#if( ipconfigUSE_NBNS == 1 )
 			/* a NetBIOS request, check for the destination port */
 			if( ( usPort == FreeRTOS_ntohs( ipNBNS_PORT ) ) ||
@@ -370,6 +536,7 @@ UDPPacket_t *pxUDPPacket = (UDPPacket_t *) pxNetworkBuffer->pucEthernetBuffer;
 		#endif /* ipconfigUSE_NBNS */
 		{
 			xReturn = pdFAIL;
+			ipMIB_INCREMENT( ulUDPNoPorts );
 		}
 	}
 
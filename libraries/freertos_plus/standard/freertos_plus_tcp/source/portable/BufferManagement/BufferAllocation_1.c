@@ -281,6 +281,47 @@ UBaseType_t uxCount;
 				}
 				#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
 
+				#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+				{
+					/* The buffer does not belong to any interface yet. */
+					pxReturn->pxInterface = NULL;
+					pxReturn->pxEndPoint = NULL;
+				}
+				#endif /* ipconfigUSE_MULTI_INTERFACE */
+
+				#if( ipconfigUSE_DRIVER_OFFLOADS != 0 )
+				{
+					/* Frames are not segmented by the driver unless the TCP code asks
+					for it. */
+					pxReturn->usSegmentSize = 0U;
+				}
+				#endif /* ipconfigUSE_DRIVER_OFFLOADS */
+
+				#if( ipconfigUSE_CHECKSUM_KERNELS != 0 )
+				{
+					/* The payload has not been summed yet. */
+					pxReturn->usPayloadChecksum = 0U;
+				}
+				#endif
+
+				#if( ipconfigUSE_IPv6 != 0 )
+				{
+					/* The addressing is IPv4 until the IPv6 code says otherwise. */
+					pxReturn->xUsesIPv6 = pdFALSE;
+				}
+				#endif
+
+				#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+				{
+					/* The caller is the only owner, and the frame is contiguous. */
+					pxReturn->ulReferenceCount = 1UL;
+					pxReturn->pxPayloadBuffer = NULL;
+					pxReturn->pucPayload = NULL;
+					pxReturn->uxPayloadLength = 0U;
+					pxReturn->pxReleaseCallback = NULL;
+				}
+				#endif /* ipconfigUSE_NETWORK_BUFFER_CHAINS */
+
 				if( xTCPWindowLoggingLevel > 3 )
 				{
 					FreeRTOS_debug_printf( ( "BUF_GET[%ld]: %p (%p)\n",
@@ -325,6 +366,18 @@ NetworkBufferDescriptor_t *pxReturn = NULL;
 			}
 			ipconfigBUFFER_ALLOC_UNLOCK_FROM_ISR();
 
+			#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+			{
+				/* The interrupt is the only owner, and the frame is
+				contiguous. */
+				pxReturn->ulReferenceCount = 1UL;
+				pxReturn->pxPayloadBuffer = NULL;
+				pxReturn->pucPayload = NULL;
+				pxReturn->uxPayloadLength = 0U;
+				pxReturn->pxReleaseCallback = NULL;
+			}
+			#endif /* ipconfigUSE_NETWORK_BUFFER_CHAINS */
+
 			iptraceNETWORK_BUFFER_OBTAINED_FROM_ISR( pxReturn );
 		}
 	}
@@ -342,6 +395,14 @@ BaseType_t vNetworkBufferReleaseFromISR( NetworkBufferDescriptor_t * const pxNet
 {
 BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
+	/* An interrupt can neither call back the application nor release a
+	chained payload, so it only releases buffers that it owns alone. */
+	#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+	{
+		configASSERT( ( pxNetworkBuffer->ulReferenceCount == 1UL ) && ( pxNetworkBuffer->pxPayloadBuffer == NULL ) );
+	}
+	#endif
+
 	/* Ensure the buffer is returned to the list of free buffers before the
 	counting semaphore is 'given' to say a buffer is available. */
 	ipconfigBUFFER_ALLOC_LOCK_FROM_ISR();
@@ -361,6 +422,17 @@ void vReleaseNetworkBufferAndDescriptor( NetworkBufferDescriptor_t * const pxNet
 {
 BaseType_t xListItemAlreadyInFreeList;
 
+	#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+	{
+		if( xNetworkBufferReleaseReference( pxNetworkBuffer ) == pdFALSE )
+		{
+			/* The buffer is still referenced, or it belongs to the
+			application. */
+			return;
+		}
+	}
+	#endif /* ipconfigUSE_NETWORK_BUFFER_CHAINS */
+
 	if( bIsValidNetworkDescriptor( pxNetworkBuffer ) == pdFALSE_UNSIGNED )
 	{
 		FreeRTOS_debug_printf( ( "vReleaseNetworkBufferAndDescriptor: Invalid buffer %p\n", pxNetworkBuffer ) );
@@ -244,6 +244,47 @@ size_t uxCount;
 			uxMinimumFreeNetworkBuffers = uxCount;
 		}
 
+		#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+		{
+			/* The buffer does not belong to any interface yet. */
+			pxReturn->pxInterface = NULL;
+			pxReturn->pxEndPoint = NULL;
+		}
+		#endif /* ipconfigUSE_MULTI_INTERFACE */
+
+		#if( ipconfigUSE_DRIVER_OFFLOADS != 0 )
+		{
+			/* Frames are not segmented by the driver unless the TCP code asks
+			for it. */
+			pxReturn->usSegmentSize = 0U;
+		}
+		#endif /* ipconfigUSE_DRIVER_OFFLOADS */
+
+		#if( ipconfigUSE_CHECKSUM_KERNELS != 0 )
+		{
+			/* The payload has not been summed yet. */
+			pxReturn->usPayloadChecksum = 0U;
+		}
+		#endif
+
+		#if( ipconfigUSE_IPv6 != 0 )
+		{
+			/* The addressing is IPv4 until the IPv6 code says otherwise. */
+			pxReturn->xUsesIPv6 = pdFALSE;
+		}
+		#endif
+
+		#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+		{
+			/* The caller is the only owner, and the frame is contiguous. */
+			pxReturn->ulReferenceCount = 1UL;
+			pxReturn->pxPayloadBuffer = NULL;
+			pxReturn->pucPayload = NULL;
+			pxReturn->uxPayloadLength = 0U;
+			pxReturn->pxReleaseCallback = NULL;
+		}
+		#endif /* ipconfigUSE_NETWORK_BUFFER_CHAINS */
+
 		/* Allocate storage of exactly the requested size to the buffer. */
 		configASSERT( pxReturn->pucEthernetBuffer == NULL );
 		if( xRequestedSizeBytes > 0 )
@@ -305,6 +346,17 @@ void vReleaseNetworkBufferAndDescriptor( NetworkBufferDescriptor_t * const pxNet
 {
 BaseType_t xListItemAlreadyInFreeList;
 
+	#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+	{
+		if( xNetworkBufferReleaseReference( pxNetworkBuffer ) == pdFALSE )
+		{
+			/* The buffer is still referenced, or it belongs to the
+			application. */
+			return;
+		}
+	}
+	#endif /* ipconfigUSE_NETWORK_BUFFER_CHAINS */
+
 	/* Ensure the buffer is returned to the list of free buffers before the
 	counting semaphore is 'given' to say a buffer is available.  Release the
 	storage allocated to the buffer payload.  THIS FILE SHOULD NOT BE USED
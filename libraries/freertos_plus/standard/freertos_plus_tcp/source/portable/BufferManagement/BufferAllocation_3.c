@@ -0,0 +1,927 @@
+/*
+ * FreeRTOS+TCP V2.0.11
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/******************************************************************************
+ *
+ * See the following web page for essential buffer allocation scheme usage and
+ * configuration details:
+ * http://www.FreeRTOS.org/FreeRTOS-Plus/FreeRTOS_Plus_TCP/Embedded_Ethernet_Buffer_Management.html
+ *
+ ******************************************************************************/
+
+/* Like BufferAllocation_1.c, this scheme allocates all storage statically, but:
+
++ The free buffers are kept on stacks that are updated with the
+  compare-and-swap of atomic.h, instead of a critical section and a semaphore.
+  The stacks are only lock-free when configUSE_GCC_BUILTIN_ATOMICS is defined,
+  otherwise atomic.h implements each compare-and-swap with a short critical
+  section.  A semaphore is only given when a task is blocked waiting for a
+  buffer.
++ ipconfigBUFFER_ALLOC_SMALL_COUNT buffers only have room for a frame of
+  ipconfigBUFFER_ALLOC_SMALL_SIZE bytes, which saves RAM.  Short frames, like
+  ARP packets and TCP acknowledgements, are stored in them.  When no small
+  buffer is left, a full-size buffer is used.
++ The IP-task keeps up to ipconfigBUFFER_ALLOC_CACHE_SIZE free buffers of each
+  size for itself, as long as more than half of all buffers are free.
++ A task may ask for a buffer longer than ipTOTAL_ETHERNET_FRAME_SIZE, for
+  instance for TCP segmentation offload or IP reassembly.  Such a buffer gets a
+  storage from pvPortMalloc(), which is freed when the buffer is released, so
+  a heap that implements vPortFree() is needed.  An interrupt can neither
+  obtain nor release such a buffer.
++ vGetNetworkBufferStatistics() reports about the use of the buffers.
+
+The storage belongs to this module, vNetworkInterfaceAllocateRAMToBuffers()
+will not be called.  Drivers that need special RAM for DMA should use
+BufferAllocation_1.c. */
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "atomic.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "NetworkInterface.h"
+#include "NetworkBufferManagement.h"
+
+/* For an Ethernet interrupt to be able to obtain a network buffer there must
+be at least this number of buffers available. */
+#define baINTERRUPT_BUFFER_GET_THRESHOLD	( 3 )
+
+/* The smallest storage must be large enough to hold a packet that might
+replace the packet that was requested to be sent. */
+#if ipconfigUSE_TCP == 1
+	#define baMINIMAL_BUFFER_SIZE		sizeof( TCPPacket_t )
+#else
+	#define baMINIMAL_BUFFER_SIZE		sizeof( ARPPacket_t )
+#endif /* ipconfigUSE_TCP == 1 */
+
+/* The two sizes of storage, and the index of their free stacks. */
+#define baCLASS_SMALL		( 0 )
+#define baCLASS_FULL		( 1 )
+#define baCLASS_COUNT		( 2 )
+
+/* The number of bytes that the storage of each class occupies, including the
+ipBUFFER_PADDING bytes in front of the Ethernet frame.  Rounded up to a
+multiple of 'sizeof( size_t )' so that every storage is properly aligned. */
+#define baROUND_UP( xSize )		( ( ( ( size_t ) ( xSize ) ) + sizeof( size_t ) - 1u ) & ~( sizeof( size_t ) - 1u ) )
+#define baSMALL_STORAGE_SIZE	baROUND_UP( ipBUFFER_PADDING + ipconfigBUFFER_ALLOC_SMALL_SIZE )
+#define baFULL_STORAGE_SIZE		baROUND_UP( ipBUFFER_PADDING + ipTOTAL_ETHERNET_FRAME_SIZE )
+
+#define baFULL_COUNT	( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS - ipconfigBUFFER_ALLOC_SMALL_COUNT )
+#define baSTORAGE_SIZE	( ( ipconfigBUFFER_ALLOC_SMALL_COUNT * baSMALL_STORAGE_SIZE ) + ( baFULL_COUNT * baFULL_STORAGE_SIZE ) )
+
+/* The head of a free stack holds the index of the top descriptor plus one in
+its lower 16 bits, or zero when the stack is empty.  The upper 16 bits count
+the updates, so that a compare-and-swap fails when the top was popped and
+pushed again in the meantime. */
+#define baHEAD_INDEX_MASK	( 0x0000FFFFUL )
+#define baHEAD_TAG_ADD		( 0x00010000UL )
+
+#if( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS >= 0xFFFF )
+	#error BufferAllocation_3.c can not handle that many network buffers
+#endif
+
+#if( ipconfigBUFFER_ALLOC_SMALL_COUNT > ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS )
+	#error ipconfigBUFFER_ALLOC_SMALL_COUNT is larger than ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS
+#endif
+
+#define ASSERT_CONCAT_(a, b) a##b
+#define ASSERT_CONCAT(a, b) ASSERT_CONCAT_(a, b)
+#define STATIC_ASSERT(e) \
+	;enum { ASSERT_CONCAT(assert_line_, __LINE__) = 1/(!!(e)) }
+
+STATIC_ASSERT( ipconfigBUFFER_ALLOC_SMALL_SIZE >= baMINIMAL_BUFFER_SIZE );
+
+#if defined( ipconfigETHERNET_MINIMUM_PACKET_BYTES )
+	STATIC_ASSERT( ipconfigETHERNET_MINIMUM_PACKET_BYTES <= ipconfigBUFFER_ALLOC_SMALL_SIZE );
+#endif
+
+/* Declares the pool of NetworkBufferDescriptor_t structures that are available
+to the system. */
+static NetworkBufferDescriptor_t xNetworkBuffers[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ];
+
+/* The storage of all buffers: first the small ones, then the full-size ones.
+The storage of a descriptor may change when pxResizeNetworkBufferWithDescriptor()
+is called, so the size of a buffer is always derived from the address of its
+storage. */
+static size_t uxBufferStorage[ baSTORAGE_SIZE / sizeof( size_t ) ];
+
+/* For each descriptor, the number of bytes that its storage from pvPortMalloc()
+can hold, or zero when it uses its storage in uxBufferStorage[]. */
+static size_t uxHeapStorageSize[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ];
+
+/* The heads of the free stacks, and for each descriptor, the index plus one of
+the descriptor below it on the stack. */
+static volatile uint32_t ulFreeStackHead[ baCLASS_COUNT ];
+static volatile uint16_t usNextFree[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ];
+
+/* Set to 1 while a descriptor is given out, to catch a buffer that is released
+twice. */
+static volatile uint32_t ulInUse[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ];
+
+/* The number of buffers on the free stacks. */
+static volatile uint32_t ulFreeCount;
+
+#if( ipconfigBUFFER_ALLOC_CACHE_SIZE > 0 )
+	/* Free buffers that only the IP-task uses. */
+	static uint16_t usCache[ baCLASS_COUNT ][ ipconfigBUFFER_ALLOC_CACHE_SIZE ];
+	static UBaseType_t uxCacheCount[ baCLASS_COUNT ];
+#endif
+
+/* The number of tasks that are blocked in pxGetNetworkBufferWithDescriptor(),
+and the semaphore on which they wait. */
+static volatile uint32_t ulWaitingTasks;
+static SemaphoreHandle_t xBufferFreedSemaphore = NULL;
+
+/* Some statistics about the use of buffers. */
+static NetworkBufferStatistics_t xStatistics;
+
+/* This constant is defined as false to let FreeRTOS_TCP_IP.c know that the
+network buffers have a variable size: resizing may be necessary */
+const BaseType_t xBufferAllocFixedSize = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Returns the index of a descriptor, or -1 if it is not one of
+ * xNetworkBuffers[].
+ */
+static BaseType_t prvDescriptorIndex( const NetworkBufferDescriptor_t *pxDescriptor );
+
+/*
+ * Returns baCLASS_SMALL or baCLASS_FULL, depending on the storage to which
+ * the descriptor points.
+ */
+static BaseType_t prvDescriptorClass( const NetworkBufferDescriptor_t *pxDescriptor );
+
+/*
+ * Push a descriptor on the free stack of its class, and pop one from the free
+ * stack of a class.
+ */
+static void prvPush( BaseType_t xIndex );
+static NetworkBufferDescriptor_t *prvPop( BaseType_t xClass );
+
+/*
+ * Find a free buffer that can hold 'xRequestedSizeBytes' bytes, taking it
+ * from the cache when called from the IP-task.
+ */
+static NetworkBufferDescriptor_t *prvGetFreeBuffer( size_t xRequestedSizeBytes, BaseType_t xFromCache );
+
+/*
+ * Prepare a buffer that is about to be given out.
+ */
+static void prvInitialiseDescriptor( NetworkBufferDescriptor_t *pxDescriptor, size_t xRequestedSizeBytes );
+
+/*
+ * Make a descriptor use a storage, and store the pointer to the descriptor in
+ * front of the storage.
+ */
+static void prvSetStorage( NetworkBufferDescriptor_t *pxDescriptor, uint8_t *pucStorage );
+
+/*
+ * Returns the storage in uxBufferStorage[] that belongs to a descriptor.
+ */
+static uint8_t *prvStaticStorage( BaseType_t xIndex );
+
+/*
+ * Returns the number of bytes that the storage of a descriptor can hold.
+ */
+static size_t prvStorageSize( const NetworkBufferDescriptor_t *pxDescriptor );
+
+/*
+ * Give a descriptor a storage from the heap of 'xSizeBytes' bytes, copying the
+ * frame that it holds.  Returns pdFAIL when the heap is exhausted.
+ */
+static BaseType_t prvSetHeapStorage( NetworkBufferDescriptor_t *pxDescriptor, size_t xSizeBytes );
+
+/*
+ * Free the heap storage of a descriptor, if any, and let it use its own storage
+ * again.
+ */
+static void prvReleaseHeapStorage( NetworkBufferDescriptor_t *pxDescriptor );
+
+/*
+ * Return a descriptor to its free stack, and wake up a task that is waiting
+ * for one.
+ */
+static void prvReturnDescriptor( BaseType_t xIndex );
+
+/*
+ * Return the number of free buffers, including those in the cache.
+ */
+static UBaseType_t prvFreeBuffers( void );
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvDescriptorIndex( const NetworkBufferDescriptor_t *pxDescriptor )
+{
+BaseType_t xIndex;
+size_t uxOffset = ( size_t ) ( ( ( const uint8_t * ) pxDescriptor ) - ( ( const uint8_t * ) xNetworkBuffers ) );
+
+	if( ( uxOffset >= sizeof( xNetworkBuffers ) ) || ( ( uxOffset % sizeof( xNetworkBuffers[ 0 ] ) ) != 0u ) )
+	{
+		xIndex = -1;
+	}
+	else
+	{
+		xIndex = ( BaseType_t ) ( uxOffset / sizeof( xNetworkBuffers[ 0 ] ) );
+	}
+
+	return xIndex;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvDescriptorClass( const NetworkBufferDescriptor_t *pxDescriptor )
+{
+const uint8_t *pucFirstFull = ( ( const uint8_t * ) uxBufferStorage ) + ( ipconfigBUFFER_ALLOC_SMALL_COUNT * baSMALL_STORAGE_SIZE );
+BaseType_t xClass;
+
+	if( ( pxDescriptor->pucEthernetBuffer - ipBUFFER_PADDING ) < pucFirstFull )
+	{
+		xClass = baCLASS_SMALL;
+	}
+	else
+	{
+		xClass = baCLASS_FULL;
+	}
+
+	return xClass;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetStorage( NetworkBufferDescriptor_t *pxDescriptor, uint8_t *pucStorage )
+{
+	/* Store a pointer to the descriptor in front of the Ethernet frame, as
+	pxPacketBuffer_to_NetworkBuffer() expects it. */
+	*( ( NetworkBufferDescriptor_t ** ) pucStorage ) = pxDescriptor;
+	pxDescriptor->pucEthernetBuffer = pucStorage + ipBUFFER_PADDING;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t *prvStaticStorage( BaseType_t xIndex )
+{
+uint8_t *pucStorage = ( uint8_t * ) uxBufferStorage;
+
+	if( xIndex < ipconfigBUFFER_ALLOC_SMALL_COUNT )
+	{
+		pucStorage += ( size_t ) xIndex * baSMALL_STORAGE_SIZE;
+	}
+	else
+	{
+		pucStorage += ( ipconfigBUFFER_ALLOC_SMALL_COUNT * baSMALL_STORAGE_SIZE ) +
+			( ( size_t ) ( xIndex - ipconfigBUFFER_ALLOC_SMALL_COUNT ) * baFULL_STORAGE_SIZE );
+	}
+
+	return pucStorage;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvStorageSize( const NetworkBufferDescriptor_t *pxDescriptor )
+{
+size_t uxSize = uxHeapStorageSize[ prvDescriptorIndex( pxDescriptor ) ];
+
+	if( uxSize != 0u )
+	{
+		/* The storage was obtained with pvPortMalloc(). */
+	}
+	else if( prvDescriptorClass( pxDescriptor ) == baCLASS_SMALL )
+	{
+		uxSize = ( size_t ) ipconfigBUFFER_ALLOC_SMALL_SIZE;
+	}
+	else
+	{
+		uxSize = ( size_t ) ipTOTAL_ETHERNET_FRAME_SIZE;
+	}
+
+	return uxSize;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSetHeapStorage( NetworkBufferDescriptor_t *pxDescriptor, size_t xSizeBytes )
+{
+BaseType_t xIndex = prvDescriptorIndex( pxDescriptor );
+uint8_t *pucStorage;
+BaseType_t xReturn;
+
+	pucStorage = ( uint8_t * ) pvPortMalloc( ipBUFFER_PADDING + xSizeBytes );
+
+	if( pucStorage == NULL )
+	{
+		xReturn = pdFAIL;
+	}
+	else
+	{
+		memcpy( pucStorage + ipBUFFER_PADDING, pxDescriptor->pucEthernetBuffer,
+			FreeRTOS_min_uint32( ( uint32_t ) pxDescriptor->xDataLength, ( uint32_t ) prvStorageSize( pxDescriptor ) ) );
+
+		/* Free a heap storage that was obtained earlier, the descriptor
+		does not need its own storage while it uses the new one. */
+		if( uxHeapStorageSize[ xIndex ] != 0u )
+		{
+			vPortFree( pxDescriptor->pucEthernetBuffer - ipBUFFER_PADDING );
+		}
+
+		prvSetStorage( pxDescriptor, pucStorage );
+		uxHeapStorageSize[ xIndex ] = xSizeBytes;
+		xStatistics.ulHeapAllocations++;
+		xReturn = pdPASS;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReleaseHeapStorage( NetworkBufferDescriptor_t *pxDescriptor )
+{
+BaseType_t xIndex = prvDescriptorIndex( pxDescriptor );
+
+	if( uxHeapStorageSize[ xIndex ] != 0u )
+	{
+		vPortFree( pxDescriptor->pucEthernetBuffer - ipBUFFER_PADDING );
+		prvSetStorage( pxDescriptor, prvStaticStorage( xIndex ) );
+		uxHeapStorageSize[ xIndex ] = 0u;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvReturnDescriptor( BaseType_t xIndex )
+{
+	prvPush( xIndex );
+
+	if( ulWaitingTasks != 0UL )
+	{
+		( void ) xSemaphoreGive( xBufferFreedSemaphore );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvPush( BaseType_t xIndex )
+{
+BaseType_t xClass = prvDescriptorClass( &( xNetworkBuffers[ xIndex ] ) );
+uint32_t ulOldHead, ulNewHead;
+
+	for( ;; )
+	{
+		ulOldHead = ulFreeStackHead[ xClass ];
+		usNextFree[ xIndex ] = ( uint16_t ) ( ulOldHead & baHEAD_INDEX_MASK );
+		ulNewHead = ( ( ulOldHead + baHEAD_TAG_ADD ) & ~baHEAD_INDEX_MASK ) | ( ( uint32_t ) xIndex + 1UL );
+
+		if( Atomic_CompareAndSwap_u32( &( ulFreeStackHead[ xClass ] ), ulNewHead, ulOldHead ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+		{
+			break;
+		}
+
+		xStatistics.ulContentions++;
+	}
+
+	( void ) Atomic_Increment_u32( &ulFreeCount );
+}
+/*-----------------------------------------------------------*/
+
+static NetworkBufferDescriptor_t *prvPop( BaseType_t xClass )
+{
+NetworkBufferDescriptor_t *pxReturn = NULL;
+uint32_t ulOldHead, ulNewHead, ulTop;
+
+	for( ;; )
+	{
+		ulOldHead = ulFreeStackHead[ xClass ];
+		ulTop = ulOldHead & baHEAD_INDEX_MASK;
+
+		if( ulTop == 0UL )
+		{
+			/* The stack is empty. */
+			break;
+		}
+
+		/* 'usNextFree' may be outdated when another context popped the same
+		descriptor meanwhile, but then the tag has changed and the swap fails. */
+		ulNewHead = ( ( ulOldHead + baHEAD_TAG_ADD ) & ~baHEAD_INDEX_MASK ) | ( uint32_t ) usNextFree[ ulTop - 1UL ];
+
+		if( Atomic_CompareAndSwap_u32( &( ulFreeStackHead[ xClass ] ), ulNewHead, ulOldHead ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+		{
+			pxReturn = &( xNetworkBuffers[ ulTop - 1UL ] );
+			( void ) Atomic_Decrement_u32( &ulFreeCount );
+			break;
+		}
+
+		xStatistics.ulContentions++;
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+static NetworkBufferDescriptor_t *prvGetFreeBuffer( size_t xRequestedSizeBytes, BaseType_t xFromCache )
+{
+NetworkBufferDescriptor_t *pxReturn = NULL;
+BaseType_t xClass;
+
+	if( xRequestedSizeBytes <= ( size_t ) ipconfigBUFFER_ALLOC_SMALL_SIZE )
+	{
+		xClass = baCLASS_SMALL;
+	}
+	else
+	{
+		xClass = baCLASS_FULL;
+	}
+
+	#if( ipconfigBUFFER_ALLOC_CACHE_SIZE > 0 )
+	{
+		if( xFromCache != pdFALSE )
+		{
+			/* A small request may use a full-size buffer from the cache,
+			rather than taking one from the free stack. */
+			if( uxCacheCount[ xClass ] == 0u )
+			{
+				if( ( xClass == baCLASS_SMALL ) && ( uxCacheCount[ baCLASS_FULL ] != 0u ) && ( ( ulFreeStackHead[ baCLASS_SMALL ] & baHEAD_INDEX_MASK ) == 0UL ) )
+				{
+					xClass = baCLASS_FULL;
+				}
+			}
+
+			if( uxCacheCount[ xClass ] != 0u )
+			{
+				uxCacheCount[ xClass ]--;
+				pxReturn = &( xNetworkBuffers[ usCache[ xClass ][ uxCacheCount[ xClass ] ] ] );
+				xStatistics.ulCacheHits++;
+			}
+		}
+	}
+	#else
+	{
+		( void ) xFromCache;
+	}
+	#endif /* ipconfigBUFFER_ALLOC_CACHE_SIZE */
+
+	if( pxReturn == NULL )
+	{
+		pxReturn = prvPop( xClass );
+
+		if( ( pxReturn == NULL ) && ( xClass == baCLASS_SMALL ) )
+		{
+			pxReturn = prvPop( baCLASS_FULL );
+		}
+	}
+
+	if( pxReturn != NULL )
+	{
+		if( prvDescriptorClass( pxReturn ) == baCLASS_SMALL )
+		{
+			xStatistics.ulSmallAllocations++;
+		}
+		else
+		{
+			if( xRequestedSizeBytes <= ( size_t ) ipconfigBUFFER_ALLOC_SMALL_SIZE )
+			{
+				xStatistics.ulFallbacks++;
+			}
+			xStatistics.ulFullAllocations++;
+		}
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseDescriptor( NetworkBufferDescriptor_t *pxDescriptor, size_t xRequestedSizeBytes )
+{
+UBaseType_t uxCount;
+
+	ulInUse[ prvDescriptorIndex( pxDescriptor ) ] = 1UL;
+
+	/* For stats, latch the lowest number of network buffers since booting. */
+	uxCount = prvFreeBuffers();
+	if( xStatistics.uxMinimumFreeBuffers > uxCount )
+	{
+		xStatistics.uxMinimumFreeBuffers = uxCount;
+	}
+
+	pxDescriptor->xDataLength = xRequestedSizeBytes;
+
+	#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+	{
+		/* make sure the buffer is not linked */
+		pxDescriptor->pxNextBuffer = NULL;
+	}
+	#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
+
+	#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+	{
+		/* The buffer does not belong to any interface yet. */
+		pxDescriptor->pxInterface = NULL;
+		pxDescriptor->pxEndPoint = NULL;
+	}
+	#endif /* ipconfigUSE_MULTI_INTERFACE */
+
+	#if( ipconfigUSE_DRIVER_OFFLOADS != 0 )
+	{
+		/* Frames are not segmented by the driver unless the TCP code asks
+		for it. */
+		pxDescriptor->usSegmentSize = 0U;
+	}
+	#endif /* ipconfigUSE_DRIVER_OFFLOADS */
+
+	#if( ipconfigUSE_CHECKSUM_KERNELS != 0 )
+	{
+		/* The payload has not been summed yet. */
+		pxDescriptor->usPayloadChecksum = 0U;
+	}
+	#endif
+
+	#if( ipconfigUSE_IPv6 != 0 )
+	{
+		/* The addressing is IPv4 until the IPv6 code says otherwise. */
+		pxDescriptor->xUsesIPv6 = pdFALSE;
+	}
+	#endif
+
+	#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+	{
+		/* The caller is the only owner, and the frame is contiguous. */
+		pxDescriptor->ulReferenceCount = 1UL;
+		pxDescriptor->pxPayloadBuffer = NULL;
+		pxDescriptor->pucPayload = NULL;
+		pxDescriptor->uxPayloadLength = 0U;
+		pxDescriptor->pxReleaseCallback = NULL;
+	}
+	#endif /* ipconfigUSE_NETWORK_BUFFER_CHAINS */
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvFreeBuffers( void )
+{
+UBaseType_t uxCount = ( UBaseType_t ) ulFreeCount;
+
+	#if( ipconfigBUFFER_ALLOC_CACHE_SIZE > 0 )
+	{
+		/* Reading UBaseType_t, no critical section needed. */
+		uxCount += uxCacheCount[ baCLASS_SMALL ] + uxCacheCount[ baCLASS_FULL ];
+	}
+	#endif
+
+	return uxCount;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkBuffersInitialise( void )
+{
+BaseType_t xReturn, x;
+
+	/* Only initialise the buffers and their associated kernel objects if they
+	have not been initialised before. */
+	if( xBufferFreedSemaphore == NULL )
+	{
+		/* Tasks that wait for a buffer retry after each 'give', so the count
+		only needs to be large enough not to lose one. */
+		xBufferFreedSemaphore = xSemaphoreCreateCounting( ( UBaseType_t ) ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS, ( UBaseType_t ) 0 );
+		configASSERT( xBufferFreedSemaphore );
+
+		if( xBufferFreedSemaphore != NULL )
+		{
+			#if ( configQUEUE_REGISTRY_SIZE > 0 )
+			{
+				vQueueAddToRegistry( xBufferFreedSemaphore, "NetBufFreed" );
+			}
+			#endif /* configQUEUE_REGISTRY_SIZE */
+
+			for( x = 0; x < ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS; x++ )
+			{
+				/* Initialise and set the owner of the buffer list items. */
+				vListInitialiseItem( &( xNetworkBuffers[ x ].xBufferListItem ) );
+				listSET_LIST_ITEM_OWNER( &( xNetworkBuffers[ x ].xBufferListItem ), &xNetworkBuffers[ x ] );
+
+				prvSetStorage( &( xNetworkBuffers[ x ] ), prvStaticStorage( x ) );
+			}
+
+			/* Currently, all buffers are available for use.  Push them in
+			reverse order, so the first buffer comes out first. */
+			for( x = ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS - 1; x >= 0; x-- )
+			{
+				prvPush( x );
+			}
+
+			xStatistics.uxMinimumFreeBuffers = ( UBaseType_t ) ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS;
+			xStatistics.ulContentions = 0UL;
+		}
+	}
+
+	if( xBufferFreedSemaphore == NULL )
+	{
+		xReturn = pdFAIL;
+	}
+	else
+	{
+		xReturn = pdPASS;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+NetworkBufferDescriptor_t *pxGetNetworkBufferWithDescriptor( size_t xRequestedSizeBytes, TickType_t xBlockTimeTicks )
+{
+NetworkBufferDescriptor_t *pxReturn = NULL;
+TimeOut_t xTimeOut;
+BaseType_t xFromCache;
+size_t xDescriptorSize = xRequestedSizeBytes;
+
+	if( xRequestedSizeBytes > ( size_t ) ipTOTAL_ETHERNET_FRAME_SIZE )
+	{
+		/* The frame will be stored on the heap, so the storage of the
+		descriptor is not used: take one with a small storage if possible. */
+		xDescriptorSize = ( size_t ) ipconfigBUFFER_ALLOC_SMALL_SIZE;
+	}
+
+	if( xBufferFreedSemaphore != NULL )
+	{
+		xFromCache = xIsCallingFromIPTask();
+		vTaskSetTimeOutState( &xTimeOut );
+
+		for( ;; )
+		{
+			pxReturn = prvGetFreeBuffer( xDescriptorSize, xFromCache );
+
+			if( ( pxReturn != NULL ) || ( xBlockTimeTicks == ( TickType_t ) 0u ) )
+			{
+				break;
+			}
+
+			/* Announce the wait before looking again: a buffer that is
+			released after this point will give the semaphore. */
+			( void ) Atomic_Increment_u32( &ulWaitingTasks );
+
+			pxReturn = prvGetFreeBuffer( xDescriptorSize, pdFALSE );
+
+			if( pxReturn == NULL )
+			{
+				( void ) xSemaphoreTake( xBufferFreedSemaphore, xBlockTimeTicks );
+			}
+
+			( void ) Atomic_Decrement_u32( &ulWaitingTasks );
+
+			if( pxReturn != NULL )
+			{
+				break;
+			}
+
+			/* Another task may have been faster, try again until the time-out
+			is reached. */
+			if( xTaskCheckForTimeOut( &xTimeOut, &xBlockTimeTicks ) != pdFALSE )
+			{
+				pxReturn = prvGetFreeBuffer( xDescriptorSize, pdFALSE );
+				break;
+			}
+		}
+	}
+	else
+	{
+		/* The buffers have not been initialised yet. */
+	}
+
+	if( ( pxReturn != NULL ) && ( xRequestedSizeBytes > ( size_t ) ipTOTAL_ETHERNET_FRAME_SIZE ) )
+	{
+		/* There is nothing to copy yet. */
+		pxReturn->xDataLength = 0u;
+
+		if( prvSetHeapStorage( pxReturn, xRequestedSizeBytes ) == pdFAIL )
+		{
+			FreeRTOS_debug_printf( ( "pxGetNetworkBufferWithDescriptor: no heap for %lu bytes\n", ( uint32_t ) xRequestedSizeBytes ) );
+			prvReturnDescriptor( prvDescriptorIndex( pxReturn ) );
+			pxReturn = NULL;
+		}
+	}
+
+	if( pxReturn != NULL )
+	{
+		prvInitialiseDescriptor( pxReturn, xRequestedSizeBytes );
+		iptraceNETWORK_BUFFER_OBTAINED( pxReturn );
+	}
+	else
+	{
+		xStatistics.ulFailures++;
+		iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER();
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+NetworkBufferDescriptor_t *pxNetworkBufferGetFromISR( size_t xRequestedSizeBytes )
+{
+NetworkBufferDescriptor_t *pxReturn = NULL;
+
+	/* Only take a buffer if there are at least baINTERRUPT_BUFFER_GET_THRESHOLD
+	buffers remaining.  This prevents, to a certain degree at least, a rapidly
+	executing interrupt exhausting buffer and in so doing preventing tasks from
+	continuing.  pvPortMalloc() can not be called here, so the frame must fit
+	in a storage of this module. */
+	if( ( xRequestedSizeBytes <= ( size_t ) ipTOTAL_ETHERNET_FRAME_SIZE ) &&
+		( ulFreeCount > ( uint32_t ) baINTERRUPT_BUFFER_GET_THRESHOLD ) )
+	{
+		pxReturn = prvGetFreeBuffer( xRequestedSizeBytes, pdFALSE );
+	}
+
+	if( pxReturn != NULL )
+	{
+		prvInitialiseDescriptor( pxReturn, xRequestedSizeBytes );
+		iptraceNETWORK_BUFFER_OBTAINED_FROM_ISR( pxReturn );
+	}
+	else
+	{
+		xStatistics.ulFailures++;
+		iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER_FROM_ISR();
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t vNetworkBufferReleaseFromISR( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+{
+BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+BaseType_t xIndex = prvDescriptorIndex( pxNetworkBuffer );
+
+	/* An interrupt can neither call back the application nor release a
+	chained payload, so it only releases buffers that it owns alone. */
+	#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+	{
+		configASSERT( ( pxNetworkBuffer->ulReferenceCount == 1UL ) && ( pxNetworkBuffer->pxPayloadBuffer == NULL ) );
+	}
+	#endif
+
+	/* Make sure the buffer is not released twice. */
+	if( ( xIndex >= 0 ) && ( Atomic_CompareAndSwap_u32( &( ulInUse[ xIndex ] ), 0UL, 1UL ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS ) )
+	{
+		/* vPortFree() can not be called from an interrupt. */
+		configASSERT( uxHeapStorageSize[ xIndex ] == 0u );
+
+		prvPush( xIndex );
+
+		if( ulWaitingTasks != 0UL )
+		{
+			( void ) xSemaphoreGiveFromISR( xBufferFreedSemaphore, &xHigherPriorityTaskWoken );
+		}
+
+		iptraceNETWORK_BUFFER_RELEASED( pxNetworkBuffer );
+	}
+
+	return xHigherPriorityTaskWoken;
+}
+/*-----------------------------------------------------------*/
+
+void vReleaseNetworkBufferAndDescriptor( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+{
+BaseType_t xIndex = prvDescriptorIndex( pxNetworkBuffer );
+BaseType_t xCached = pdFALSE;
+
+	#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+	if( xNetworkBufferReleaseReference( pxNetworkBuffer ) == pdFALSE )
+	{
+		/* The buffer is still referenced, or it belongs to the application. */
+	}
+	else
+	#endif /* ipconfigUSE_NETWORK_BUFFER_CHAINS */
+	if( xIndex < 0 )
+	{
+		FreeRTOS_debug_printf( ( "vReleaseNetworkBufferAndDescriptor: Invalid buffer %p\n", pxNetworkBuffer ) );
+	}
+	else if( Atomic_CompareAndSwap_u32( &( ulInUse[ xIndex ] ), 0UL, 1UL ) != ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+	{
+		FreeRTOS_debug_printf( ( "vReleaseNetworkBufferAndDescriptor: %p ALREADY RELEASED (now %lu)\n",
+			pxNetworkBuffer, prvFreeBuffers() ) );
+	}
+	else
+	{
+		prvReleaseHeapStorage( pxNetworkBuffer );
+
+		#if( ipconfigBUFFER_ALLOC_CACHE_SIZE > 0 )
+		{
+		BaseType_t xClass = prvDescriptorClass( pxNetworkBuffer );
+
+			/* Only keep buffers aside while plenty are left for the other
+			tasks, and never when a task is waiting for one. */
+			if( ( ulWaitingTasks == 0UL ) &&
+				( ulFreeCount > ( uint32_t ) ( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS / 2 ) ) &&
+				( uxCacheCount[ xClass ] < ( UBaseType_t ) ipconfigBUFFER_ALLOC_CACHE_SIZE ) &&
+				( xIsCallingFromIPTask() != pdFALSE ) )
+			{
+				usCache[ xClass ][ uxCacheCount[ xClass ] ] = ( uint16_t ) xIndex;
+				uxCacheCount[ xClass ]++;
+				xCached = pdTRUE;
+			}
+		}
+		#endif /* ipconfigBUFFER_ALLOC_CACHE_SIZE */
+
+		if( xCached == pdFALSE )
+		{
+			prvReturnDescriptor( xIndex );
+		}
+
+		iptraceNETWORK_BUFFER_RELEASED( pxNetworkBuffer );
+	}
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetMinimumFreeNetworkBuffers( void )
+{
+	return xStatistics.uxMinimumFreeBuffers;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetNumberOfFreeNetworkBuffers( void )
+{
+	return prvFreeBuffers();
+}
+/*-----------------------------------------------------------*/
+
+void vGetNetworkBufferStatistics( NetworkBufferStatistics_t *pxStatistics )
+{
+	*pxStatistics = xStatistics;
+	pxStatistics->uxFreeBuffers = prvFreeBuffers();
+}
+/*-----------------------------------------------------------*/
+
+NetworkBufferDescriptor_t *pxResizeNetworkBufferWithDescriptor( NetworkBufferDescriptor_t * pxNetworkBuffer, size_t xNewSizeBytes )
+{
+NetworkBufferDescriptor_t *pxOther;
+uint8_t *pucStorage;
+
+	if( xNewSizeBytes <= prvStorageSize( pxNetworkBuffer ) )
+	{
+		/* The storage is large enough already. */
+	}
+	else if( xNewSizeBytes > ( size_t ) ipTOTAL_ETHERNET_FRAME_SIZE )
+	{
+		/* No static storage is that long, store the frame on the heap. */
+		if( prvSetHeapStorage( pxNetworkBuffer, xNewSizeBytes ) == pdFAIL )
+		{
+			pxNetworkBuffer = NULL;
+		}
+	}
+	else
+	{
+		/* The storage is too small.  Take a full-size buffer, and exchange
+		the storage of the two descriptors, so the caller keeps its
+		descriptor. */
+		pxOther = pxGetNetworkBufferWithDescriptor( xNewSizeBytes, ( TickType_t ) 0u );
+
+		if( pxOther == NULL )
+		{
+			/* In case the allocation fails, return NULL. */
+			pxNetworkBuffer = NULL;
+		}
+		else
+		{
+			memcpy( pxOther->pucEthernetBuffer, pxNetworkBuffer->pucEthernetBuffer,
+				FreeRTOS_min_uint32( ( uint32_t ) pxNetworkBuffer->xDataLength, ( uint32_t ) ipconfigBUFFER_ALLOC_SMALL_SIZE ) );
+
+			pucStorage = pxNetworkBuffer->pucEthernetBuffer - ipBUFFER_PADDING;
+			prvSetStorage( pxNetworkBuffer, pxOther->pucEthernetBuffer - ipBUFFER_PADDING );
+			prvSetStorage( pxOther, pucStorage );
+
+			/* 'pxOther' now has the small storage, and will be returned to the
+			free stack of small buffers. */
+			vReleaseNetworkBufferAndDescriptor( pxOther );
+		}
+	}
+
+	if( pxNetworkBuffer != NULL )
+	{
+		pxNetworkBuffer->xDataLength = xNewSizeBytes;
+	}
+
+	return pxNetworkBuffer;
+}
+/*-----------------------------------------------------------*/
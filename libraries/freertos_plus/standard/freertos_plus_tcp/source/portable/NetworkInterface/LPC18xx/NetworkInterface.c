@@ -665,9 +665,6 @@ NetworkBufferDescriptor_t *pxDescriptor;
 #if( ipconfigZERO_COPY_RX_DRIVER != 0 )
 	NetworkBufferDescriptor_t *pxNewDescriptor;
 #endif /* ipconfigZERO_COPY_RX_DRIVER */
-#if( ipconfigUSE_LINKED_RX_MESSAGES == 0 )
-	IPStackEvent_t xRxEvent = { eNetworkRxEvent, NULL };
-#endif
 
 	/* Process each descriptor that is not still in use by the DMA. */
 	ulStatus = xDMARxDescriptors[ ulNextRxDescriptorToProcess ].STATUS;
@@ -752,13 +749,12 @@ NetworkBufferDescriptor_t *pxDescriptor;
 						adjust the length to remove any trailing bytes. */
 						prvRemoveTrailingBytes( pxDescriptor );
 
-						/* Pass the data to the TCP/IP task for processing. */
-						xRxEvent.pvData = ( void * ) pxDescriptor;
-						if( xSendEventStructToIPTask( &xRxEvent, xDescriptorWaitTime ) == pdFALSE )
+						/* Pass the data to the TCP/IP task for processing.
+						When the descriptor could not be sent, it has been
+						released. */
+						if( xSendNetworkBuffersToIPTask( pxDescriptor, xDescriptorWaitTime ) == pdFALSE )
 						{
-							/* Could not send the descriptor into the TCP/IP
-							stack, it must be released. */
-							vReleaseNetworkBufferAndDescriptor( pxDescriptor );
+							FreeRTOS_debug_printf( ( "prvNetworkInterfaceInput: IP-task queue is full\n" ) );
 						}
 						else
 						{
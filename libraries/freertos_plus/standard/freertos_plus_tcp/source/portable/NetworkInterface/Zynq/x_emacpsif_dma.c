@@ -42,6 +42,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "FreeRTOS_Sockets.h"
 #include "FreeRTOS_IP_Private.h"
 #include "NetworkBufferManagement.h"
+#include "NetworkInterface.h"
 
 #include "uncached_memory.h"
 
@@ -319,24 +320,11 @@ static NetworkBufferDescriptor_t *ethLast = NULL;
 
 static void passEthMessages( void )
 {
-IPStackEvent_t xRxEvent;
-
-	xRxEvent.eEventType = eNetworkRxEvent;
-	xRxEvent.pvData = ( void * ) ethMsg;
-
-	if( xSendEventStructToIPTask( &xRxEvent, ( TickType_t ) 1000 ) != pdPASS )
+	/* When the chain could not be sent to the stack, all buffers in it have
+	been released again.  This is a deferred handler task, not a real
+	interrupt, so it is ok to use the task level functions here. */
+	if( xSendNetworkBuffersToIPTask( ethMsg, ( TickType_t ) 1000 ) != pdPASS )
 	{
-		/* The buffer could not be sent to the stack so	must be released again.
-		This is a deferred handler taskr, not a real interrupt, so it is ok to
-		use the task level function here. */
-		do
-		{
-			NetworkBufferDescriptor_t *xNext = ethMsg->pxNextBuffer;
-			vReleaseNetworkBufferAndDescriptor( ethMsg );
-			ethMsg = xNext;
-		} while( ethMsg != NULL );
-
-		iptraceETHERNET_RX_EVENT_LOST();
 		FreeRTOS_printf( ( "passEthMessages: Can not queue return packet!\n" ) );
 	}
 
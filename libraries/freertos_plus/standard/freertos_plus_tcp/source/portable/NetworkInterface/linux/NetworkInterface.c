@@ -0,0 +1,909 @@
+/*
+FreeRTOS+TCP V2.0.11
+Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ http://aws.amazon.com/freertos
+ http://www.FreeRTOS.org
+*/
+
+/* recvmmsg() is a GNU extension. */
+#define _GNU_SOURCE
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <linux/if_tun.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "NetworkInterface.h"
+#include "NetworkBufferManagement.h"
+#include "NetworkInterface_Linux.h"
+
+/* The host network interface that is opened when only one interface is used,
+see ReadMe.txt.  With ipconfigUSE_MULTI_INTERFACE set to 1 the interfaces are
+set up by pxLinux_FillInterfaceDescriptor() and vLinux_FillLoopbackPair()
+instead. */
+#ifndef configLINUX_NETWORK_INTERFACE_NAME
+	#define configLINUX_NETWORK_INTERFACE_NAME		"tap0"
+#endif
+
+/* Set to 1 to bind a raw socket to an existing host interface, such as "eth0",
+rather than to use a TAP device. */
+#ifndef configLINUX_NETWORK_INTERFACE_RAW
+	#define configLINUX_NETWORK_INTERFACE_RAW		0
+#endif
+
+#ifndef configMAC_ISR_SIMULATOR_PRIORITY
+	#define configMAC_ISR_SIMULATOR_PRIORITY		( configMAX_PRIORITIES - 1 )
+#endif
+
+/* The time the task that simulates the Ethernet interrupt sleeps when the host
+has no frames for it. */
+#ifndef configLINUX_MAC_INTERRUPT_SIMULATOR_DELAY
+	#define configLINUX_MAC_INTERRUPT_SIMULATOR_DELAY	( ( TickType_t ) 1 )
+#endif
+
+/* If ipconfigETHERNET_DRIVER_FILTERS_FRAME_TYPES is set to 1, then the Ethernet
+driver will filter incoming packets and only pass the stack those packets it
+considers need processing. */
+#if( ipconfigETHERNET_DRIVER_FILTERS_FRAME_TYPES == 0 )
+	#define ipCONSIDER_FRAME_FOR_PROCESSING( pucEthernetBuffer ) eProcessBuffer
+#else
+	#define ipCONSIDER_FRAME_FOR_PROCESSING( pucEthernetBuffer ) eConsiderFrameForProcessing( ( pucEthernetBuffer ) )
+#endif
+
+/* The maximum number of frames that are fetched from the host in one go.  When
+ipconfigUSE_LINKED_RX_MESSAGES is set to 1 the frames of one batch are also
+passed to the IP-task in a single message. */
+#define niRX_BATCH_SIZE			16
+
+/* The number of host interfaces that can be opened. */
+#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+	#define niMAX_INTERFACES	4
+#else
+	#define niMAX_INTERFACES	1
+#endif
+
+/* The size of each buffer when BufferAllocation_1 is used, rounded up to a
+multiple of 8 bytes. */
+#define niBUFFER_1_PACKET_SIZE	( ( ipTOTAL_ETHERNET_FRAME_SIZE + ipBUFFER_PADDING + 7 ) & ~7UL )
+
+#if( ipconfigUSE_DRIVER_OFFLOADS != 0 )
+	/* The offloads that the interfaces of a loopback pair advertise, see
+	NetworkInterface.h.  The pair does the work itself, so that the code in the
+	stack that depends on the offloads can be tested without hardware. */
+	#ifndef configLINUX_LOOPBACK_OFFLOADS
+		#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+			#define configLINUX_LOOPBACK_OFFLOADS	( ipOFFLOAD_TX_CHECKSUM | ipOFFLOAD_RX_CHECKSUM | ipOFFLOAD_TCP_SEGMENTATION | ipOFFLOAD_TX_GATHER )
+		#else
+			#define configLINUX_LOOPBACK_OFFLOADS	( ipOFFLOAD_TX_CHECKSUM | ipOFFLOAD_RX_CHECKSUM | ipOFFLOAD_TCP_SEGMENTATION )
+		#endif
+	#endif
+
+	/* The longest frame that a loopback pair accepts for segmentation. */
+	#ifndef configLINUX_LOOPBACK_MAX_FRAME_LENGTH
+		#define configLINUX_LOOPBACK_MAX_FRAME_LENGTH	( 16U * 1024U )
+	#endif
+
+	/* The TCP flags that only the last segment of a long frame keeps. */
+	#define niTCP_FLAG_FIN			0x01U
+	#define niTCP_FLAG_PSH			0x08U
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* The state of one host network interface. */
+typedef struct xLINUX_INTERFACE
+{
+	int iSocket;							/* The TAP device or raw socket, -1 while closed. */
+	BaseType_t xRawSocket;					/* pdTRUE when iSocket is an AF_PACKET socket. */
+	char cName[ IFNAMSIZ ];					/* The name of the host interface. */
+	TaskHandle_t xRxTask;					/* The task that simulates the Ethernet interrupt. */
+	#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+		NetworkInterface_t *pxInterface;	/* The interface as seen by the stack. */
+		struct xLINUX_INTERFACE *pxPeer;	/* The other end of a loopback pair. */
+	#endif
+	#if( ipconfigZERO_COPY_RX_DRIVER != 0 )
+		/* Frames are received straight into network buffers.  Buffers that
+		did not receive a frame are kept for the next batch. */
+		NetworkBufferDescriptor_t *pxRxBuffers[ niRX_BATCH_SIZE ];
+	#else
+		/* Frames are received here and copied into a network buffer of
+		exactly the right size, but only if the stack wants them. */
+		uint8_t ucRxFrames[ niRX_BATCH_SIZE ][ ipTOTAL_ETHERNET_FRAME_SIZE ];
+	#endif
+	volatile uint32_t ulRxDropped;			/* For viewing in the debugger only. */
+	volatile uint32_t ulTxFailures;			/* For viewing in the debugger only. */
+} LinuxInterface_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Claim a LinuxInterface_t for the host interface pcHostName.
+ */
+static LinuxInterface_t *prvNewInterface( const char *pcHostName, BaseType_t xRawSocket );
+
+/*
+ * Open the host interface and start the task that receives from it.  Returns
+ * pdPASS when the interface is ready for use.
+ */
+static BaseType_t prvStartInterface( LinuxInterface_t *pxLinux );
+
+/*
+ * Open a TAP device, or a raw socket bound to a host interface.  Both return
+ * a non-blocking file descriptor, or -1.
+ */
+static int prvOpenTAP( const char *pcName );
+static int prvOpenRawSocket( const char *pcName );
+
+/*
+ * Write a frame to the host interface.
+ */
+static BaseType_t prvSendFrame( LinuxInterface_t *pxLinux, NetworkBufferDescriptor_t * const pxNetworkBuffer, BaseType_t xReleaseAfterSend );
+
+/*
+ * A task that simulates the Ethernet interrupt by polling the host interface
+ * for new frames.
+ */
+static void prvInterruptSimulatorTask( void *pvParameters );
+
+/*
+ * Fetch as many frames as are waiting, up to niRX_BATCH_SIZE, and pass those
+ * the stack wants to the IP-task.  Returns pdTRUE when a full batch was passed
+ * on, meaning that more frames are probably waiting.
+ */
+static BaseType_t prvReceiveBatch( LinuxInterface_t *pxLinux );
+
+/*
+ * Pass received network buffers to the IP-task.  The buffers are released if
+ * the IP-task can not take them.  Returns pdFAIL if any buffer was lost.
+ */
+static BaseType_t prvPassToIPTask( NetworkBufferDescriptor_t *pxBuffers[], UBaseType_t uxCount );
+
+#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+
+	/*
+	 * The NetworkInterface_t functions of host interfaces.
+	 */
+	static BaseType_t prvInitialise( NetworkInterface_t *pxInterface );
+	static BaseType_t prvOutput( NetworkInterface_t *pxInterface, NetworkBufferDescriptor_t * const pxNetworkBuffer, BaseType_t xReleaseAfterSend );
+
+	/*
+	 * The NetworkInterface_t functions of the interfaces of a loopback pair.
+	 */
+	static BaseType_t prvLoopbackInitialise( NetworkInterface_t *pxInterface );
+	static BaseType_t prvLoopbackOutput( NetworkInterface_t *pxInterface, NetworkBufferDescriptor_t * const pxNetworkBuffer, BaseType_t xReleaseAfterSend );
+
+	/*
+	 * Pass a frame that was sent on one interface of a loopback pair to the
+	 * IP-task as if it was received by pxPeer.
+	 */
+	static void prvLoopbackDeliver( LinuxInterface_t *pxPeer, NetworkBufferDescriptor_t *pxBuffer );
+
+	#if( ipconfigUSE_DRIVER_OFFLOADS != 0 )
+
+		/*
+		 * Do the work of ipOFFLOAD_TX_CHECKSUM: set the IP header checksum and
+		 * the protocol checksum of an outgoing IPv4 frame.
+		 */
+		static void prvLoopbackSetChecksums( NetworkBufferDescriptor_t *pxBuffer );
+
+		/*
+		 * Do the work of ipOFFLOAD_TCP_SEGMENTATION: cut a long TCP frame into
+		 * segments of at most 'usSegmentSize' bytes of payload, and deliver
+		 * each of them to pxPeer.
+		 */
+		static void prvLoopbackSegment( LinuxInterface_t *pxPeer, const NetworkBufferDescriptor_t *pxNetworkBuffer );
+
+	#endif /* ipconfigUSE_DRIVER_OFFLOADS */
+
+#endif /* ipconfigUSE_MULTI_INTERFACE */
+
+/*-----------------------------------------------------------*/
+
+/* The host interfaces that are in use. */
+static LinuxInterface_t xLinuxInterfaces[ niMAX_INTERFACES ];
+static UBaseType_t uxLinuxInterfaceCount = 0U;
+
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_MULTI_INTERFACE == 0 )
+
+	BaseType_t xNetworkInterfaceInitialise( void )
+	{
+		if( uxLinuxInterfaceCount == 0U )
+		{
+			( void ) prvNewInterface( configLINUX_NETWORK_INTERFACE_NAME, configLINUX_NETWORK_INTERFACE_RAW );
+		}
+
+		return prvStartInterface( &( xLinuxInterfaces[ 0 ] ) );
+	}
+	/*-----------------------------------------------------------*/
+
+	BaseType_t xNetworkInterfaceOutput( NetworkBufferDescriptor_t * const pxNetworkBuffer, BaseType_t xReleaseAfterSend )
+	{
+		return prvSendFrame( &( xLinuxInterfaces[ 0 ] ), pxNetworkBuffer, xReleaseAfterSend );
+	}
+	/*-----------------------------------------------------------*/
+
+#else /* ipconfigUSE_MULTI_INTERFACE */
+
+	NetworkInterface_t *pxLinux_FillInterfaceDescriptor( NetworkInterface_t *pxInterface,
+		const char *pcHostName, BaseType_t xRawSocket )
+	{
+	LinuxInterface_t *pxLinux = prvNewInterface( pcHostName, xRawSocket );
+
+		memset( pxInterface, '\0', sizeof( *pxInterface ) );
+		pxInterface->pcName = pxLinux->cName;
+		pxInterface->pvArgument = ( void * ) pxLinux;
+		pxInterface->pfInitialise = prvInitialise;
+		pxInterface->pfOutput = prvOutput;
+		pxLinux->pxInterface = pxInterface;
+
+		return pxInterface;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vLinux_FillLoopbackPair( NetworkInterface_t *pxInterfaceA, NetworkInterface_t *pxInterfaceB )
+	{
+	LinuxInterface_t *pxLinuxA = prvNewInterface( NULL, pdFALSE );
+	LinuxInterface_t *pxLinuxB = prvNewInterface( NULL, pdFALSE );
+
+		snprintf( pxLinuxA->cName, sizeof( pxLinuxA->cName ), "loop%ua", ( unsigned ) uxLinuxInterfaceCount );
+		snprintf( pxLinuxB->cName, sizeof( pxLinuxB->cName ), "loop%ub", ( unsigned ) uxLinuxInterfaceCount );
+		pxLinuxA->pxPeer = pxLinuxB;
+		pxLinuxB->pxPeer = pxLinuxA;
+
+		memset( pxInterfaceA, '\0', sizeof( *pxInterfaceA ) );
+		pxInterfaceA->pcName = pxLinuxA->cName;
+		pxInterfaceA->pvArgument = ( void * ) pxLinuxA;
+		pxInterfaceA->pfInitialise = prvLoopbackInitialise;
+		pxInterfaceA->pfOutput = prvLoopbackOutput;
+		pxLinuxA->pxInterface = pxInterfaceA;
+
+		memset( pxInterfaceB, '\0', sizeof( *pxInterfaceB ) );
+		pxInterfaceB->pcName = pxLinuxB->cName;
+		pxInterfaceB->pvArgument = ( void * ) pxLinuxB;
+		pxInterfaceB->pfInitialise = prvLoopbackInitialise;
+		pxInterfaceB->pfOutput = prvLoopbackOutput;
+		pxLinuxB->pxInterface = pxInterfaceB;
+
+		#if( ipconfigUSE_DRIVER_OFFLOADS != 0 )
+		{
+			pxInterfaceA->uxOffloads = configLINUX_LOOPBACK_OFFLOADS;
+			pxInterfaceA->uxMaxFrameLength = configLINUX_LOOPBACK_MAX_FRAME_LENGTH;
+			pxInterfaceB->uxOffloads = configLINUX_LOOPBACK_OFFLOADS;
+			pxInterfaceB->uxMaxFrameLength = configLINUX_LOOPBACK_MAX_FRAME_LENGTH;
+		}
+		#endif
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvInitialise( NetworkInterface_t *pxInterface )
+	{
+		return prvStartInterface( ( LinuxInterface_t * ) pxInterface->pvArgument );
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvOutput( NetworkInterface_t *pxInterface, NetworkBufferDescriptor_t * const pxNetworkBuffer, BaseType_t xReleaseAfterSend )
+	{
+		return prvSendFrame( ( LinuxInterface_t * ) pxInterface->pvArgument, pxNetworkBuffer, xReleaseAfterSend );
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvLoopbackInitialise( NetworkInterface_t *pxInterface )
+	{
+		/* The virtual cable is always connected. */
+		( void ) pxInterface;
+		return pdPASS;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvLoopbackOutput( NetworkInterface_t *pxInterface, NetworkBufferDescriptor_t * const pxNetworkBuffer, BaseType_t xReleaseAfterSend )
+	{
+	LinuxInterface_t *pxPeer = ( ( LinuxInterface_t * ) pxInterface->pvArgument )->pxPeer;
+	NetworkBufferDescriptor_t *pxBuffer = pxNetworkBuffer;
+
+		iptraceNETWORK_INTERFACE_TRANSMIT();
+
+		#if( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+		{
+			if( ipIS_CHAINED( pxNetworkBuffer ) != pdFALSE )
+			{
+				/* Gather the headers and the chained payload in a buffer of
+				the pair, the way a DMA would read them. */
+				pxBuffer = pxDuplicateNetworkBufferWithDescriptor( pxNetworkBuffer, pxNetworkBuffer->xDataLength );
+
+				if( pxBuffer != NULL )
+				{
+					pxBuffer->usSegmentSize = pxNetworkBuffer->usSegmentSize;
+				}
+
+				if( xReleaseAfterSend != pdFALSE )
+				{
+					vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+				}
+
+				xReleaseAfterSend = pdTRUE;
+			}
+		}
+		#endif /* ipconfigUSE_NETWORK_BUFFER_CHAINS */
+
+		if( pxBuffer == NULL )
+		{
+			pxPeer->ulRxDropped++;
+		}
+		else
+		#if( ipconfigUSE_DRIVER_OFFLOADS != 0 )
+			if( pxBuffer->usSegmentSize != 0U )
+			{
+				/* Every segment is delivered in a new buffer. */
+				prvLoopbackSegment( pxPeer, pxBuffer );
+
+				if( xReleaseAfterSend != pdFALSE )
+				{
+					vReleaseNetworkBufferAndDescriptor( pxBuffer );
+				}
+			}
+			else
+		#endif /* ipconfigUSE_DRIVER_OFFLOADS */
+		{
+			if( xReleaseAfterSend == pdFALSE )
+			{
+				/* The buffer still belongs to the caller, so the peer receives a
+				copy.  Otherwise the peer receives the buffer itself, which is
+				passed back to the IP-task without copying the frame. */
+				pxBuffer = pxDuplicateNetworkBufferWithDescriptor( pxBuffer, pxBuffer->xDataLength );
+			}
+
+			if( pxBuffer != NULL )
+			{
+				#if( ipconfigUSE_DRIVER_OFFLOADS != 0 )
+				{
+					if( ( pxInterface->uxOffloads & ipOFFLOAD_TX_CHECKSUM ) != 0U )
+					{
+						prvLoopbackSetChecksums( pxBuffer );
+					}
+				}
+				#endif
+
+				prvLoopbackDeliver( pxPeer, pxBuffer );
+			}
+			else
+			{
+				pxPeer->ulRxDropped++;
+			}
+		}
+
+		return pdPASS;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvLoopbackDeliver( LinuxInterface_t *pxPeer, NetworkBufferDescriptor_t *pxBuffer )
+	{
+		iptraceNETWORK_INTERFACE_RECEIVE();
+
+		if( ipCONSIDER_FRAME_FOR_PROCESSING( pxBuffer->pucEthernetBuffer ) == eProcessBuffer )
+		{
+			pxBuffer->pxInterface = pxPeer->pxInterface;
+
+			/* Called from the IP-task, which will pick up the message as
+			soon as this frame has been sent. */
+			if( prvPassToIPTask( &pxBuffer, 1U ) == pdFAIL )
+			{
+				pxPeer->ulRxDropped++;
+			}
+		}
+		else
+		{
+			vReleaseNetworkBufferAndDescriptor( pxBuffer );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	#if( ipconfigUSE_DRIVER_OFFLOADS != 0 )
+
+		static void prvLoopbackSetChecksums( NetworkBufferDescriptor_t *pxBuffer )
+		{
+		EthernetHeader_t *pxEthernetHeader = ( EthernetHeader_t * ) pxBuffer->pucEthernetBuffer;
+		IPHeader_t *pxIPHeader;
+		size_t uxHeaderLength;
+
+			if( ( pxEthernetHeader->usFrameType == ipIPv4_FRAME_TYPE ) &&
+				( pxBuffer->xDataLength >= ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER ) )
+			{
+				pxIPHeader = ( IPHeader_t * ) &( pxBuffer->pucEthernetBuffer[ ipSIZE_OF_ETH_HEADER ] );
+				uxHeaderLength = ( size_t ) ( ( pxIPHeader->ucVersionHeaderLength & 0x0FU ) << 2 );
+
+				pxIPHeader->usHeaderChecksum = 0U;
+				pxIPHeader->usHeaderChecksum = usGenerateChecksum( 0UL, ( uint8_t * ) &( pxIPHeader->ucVersionHeaderLength ), uxHeaderLength );
+				pxIPHeader->usHeaderChecksum = ~FreeRTOS_htons( pxIPHeader->usHeaderChecksum );
+
+				/* Frames of other protocols are left alone. */
+				( void ) usGenerateProtocolChecksum( pxBuffer->pucEthernetBuffer, pxBuffer->xDataLength, pdTRUE );
+			}
+		}
+		/*-----------------------------------------------------------*/
+
+		static void prvLoopbackSegment( LinuxInterface_t *pxPeer, const NetworkBufferDescriptor_t *pxNetworkBuffer )
+		{
+		const IPHeader_t *pxIPHeader = ( const IPHeader_t * ) &( pxNetworkBuffer->pucEthernetBuffer[ ipSIZE_OF_ETH_HEADER ] );
+		const TCPHeader_t *pxTCPHeader;
+		NetworkBufferDescriptor_t *pxSegment;
+		IPHeader_t *pxSegmentIPHeader;
+		TCPHeader_t *pxSegmentTCPHeader;
+		size_t uxIPHeaderLength, uxHeadersLength, uxOffset, uxPayload;
+		uint32_t ulSequenceNumber;
+		uint16_t usIdentification;
+
+			uxIPHeaderLength = ( size_t ) ( ( pxIPHeader->ucVersionHeaderLength & 0x0FU ) << 2 );
+			pxTCPHeader = ( const TCPHeader_t * ) &( pxNetworkBuffer->pucEthernetBuffer[ ipSIZE_OF_ETH_HEADER + uxIPHeaderLength ] );
+			uxHeadersLength = ipSIZE_OF_ETH_HEADER + uxIPHeaderLength + ( size_t ) ( ( pxTCPHeader->ucTCPOffset >> 4 ) << 2 );
+			ulSequenceNumber = FreeRTOS_ntohl( pxTCPHeader->ulSequenceNumber );
+			usIdentification = FreeRTOS_ntohs( pxIPHeader->usIdentification );
+
+			for( uxOffset = uxHeadersLength; uxOffset < pxNetworkBuffer->xDataLength; uxOffset += uxPayload )
+			{
+				uxPayload = pxNetworkBuffer->xDataLength - uxOffset;
+
+				if( uxPayload > ( size_t ) pxNetworkBuffer->usSegmentSize )
+				{
+					uxPayload = ( size_t ) pxNetworkBuffer->usSegmentSize;
+				}
+
+				pxSegment = pxGetNetworkBufferWithDescriptor( uxHeadersLength + uxPayload, 0U );
+
+				if( pxSegment == NULL )
+				{
+					/* The peer will ask for the missing data again. */
+					pxPeer->ulRxDropped++;
+					break;
+				}
+
+				memcpy( pxSegment->pucEthernetBuffer, pxNetworkBuffer->pucEthernetBuffer, uxHeadersLength );
+				memcpy( &( pxSegment->pucEthernetBuffer[ uxHeadersLength ] ), &( pxNetworkBuffer->pucEthernetBuffer[ uxOffset ] ), uxPayload );
+				pxSegment->xDataLength = uxHeadersLength + uxPayload;
+
+				pxSegmentIPHeader = ( IPHeader_t * ) &( pxSegment->pucEthernetBuffer[ ipSIZE_OF_ETH_HEADER ] );
+				pxSegmentTCPHeader = ( TCPHeader_t * ) &( pxSegment->pucEthernetBuffer[ ipSIZE_OF_ETH_HEADER + uxIPHeaderLength ] );
+				pxSegmentIPHeader->usLength = FreeRTOS_htons( ( uint16_t ) ( pxSegment->xDataLength - ipSIZE_OF_ETH_HEADER ) );
+				pxSegmentIPHeader->usIdentification = FreeRTOS_htons( usIdentification );
+				pxSegmentTCPHeader->ulSequenceNumber = FreeRTOS_htonl( ulSequenceNumber );
+
+				if( uxOffset + uxPayload < pxNetworkBuffer->xDataLength )
+				{
+					pxSegmentTCPHeader->ucTCPFlags &= ( uint8_t ) ~( niTCP_FLAG_FIN | niTCP_FLAG_PSH );
+				}
+
+				prvLoopbackSetChecksums( pxSegment );
+				prvLoopbackDeliver( pxPeer, pxSegment );
+
+				ulSequenceNumber += ( uint32_t ) uxPayload;
+				usIdentification++;
+			}
+		}
+		/*-----------------------------------------------------------*/
+
+	#endif /* ipconfigUSE_DRIVER_OFFLOADS */
+
+#endif /* ipconfigUSE_MULTI_INTERFACE */
+
+void vNetworkInterfaceAllocateRAMToBuffers( NetworkBufferDescriptor_t pxNetworkBuffers[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ] )
+{
+static uint8_t ucNetworkPackets[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS * niBUFFER_1_PACKET_SIZE ] __attribute__ ( ( aligned( 8 ) ) );
+uint8_t *pucRAMBuffer = ucNetworkPackets;
+uint32_t ul;
+
+	/* Only used by BufferAllocation_1.c.  Each buffer starts with a pointer
+	back to its descriptor, which ipBUFFER_PADDING must be large enough to
+	hold on a 64-bit host. */
+	configASSERT( ipBUFFER_PADDING >= sizeof( NetworkBufferDescriptor_t * ) );
+
+	for( ul = 0; ul < ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS; ul++ )
+	{
+		pxNetworkBuffers[ ul ].pucEthernetBuffer = pucRAMBuffer + ipBUFFER_PADDING;
+		*( ( NetworkBufferDescriptor_t ** ) pucRAMBuffer ) = &( pxNetworkBuffers[ ul ] );
+		pucRAMBuffer += niBUFFER_1_PACKET_SIZE;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static LinuxInterface_t *prvNewInterface( const char *pcHostName, BaseType_t xRawSocket )
+{
+LinuxInterface_t *pxLinux;
+
+	/* niMAX_INTERFACES is too low. */
+	configASSERT( uxLinuxInterfaceCount < ( UBaseType_t ) niMAX_INTERFACES );
+
+	pxLinux = &( xLinuxInterfaces[ uxLinuxInterfaceCount ] );
+	uxLinuxInterfaceCount++;
+
+	pxLinux->iSocket = -1;
+	pxLinux->xRawSocket = xRawSocket;
+
+	if( pcHostName != NULL )
+	{
+		strncpy( pxLinux->cName, pcHostName, sizeof( pxLinux->cName ) - 1 );
+	}
+
+	return pxLinux;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvStartInterface( LinuxInterface_t *pxLinux )
+{
+BaseType_t xReturn = pdFAIL;
+
+	/* The host interface stays open when the network goes down and up
+	again. */
+	if( pxLinux->iSocket < 0 )
+	{
+		if( pxLinux->xRawSocket != pdFALSE )
+		{
+			pxLinux->iSocket = prvOpenRawSocket( pxLinux->cName );
+		}
+		else
+		{
+			pxLinux->iSocket = prvOpenTAP( pxLinux->cName );
+		}
+	}
+
+	if( pxLinux->iSocket >= 0 )
+	{
+		if( pxLinux->xRxTask == NULL )
+		{
+			/* Create a task that simulates an interrupt in a real system.  It
+			polls the host interface, then sends a message to the IP task when
+			data is available. */
+			xTaskCreate( prvInterruptSimulatorTask, "MAC_ISR", configMINIMAL_STACK_SIZE, ( void * ) pxLinux, configMAC_ISR_SIMULATOR_PRIORITY, &( pxLinux->xRxTask ) );
+		}
+
+		if( pxLinux->xRxTask != NULL )
+		{
+			xReturn = pdPASS;
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static int prvOpenTAP( const char *pcName )
+{
+struct ifreq xRequest;
+int iSocket;
+
+	/* Attach to the TAP device, or create it if the process is allowed to.  The
+	device must be brought up and given an address by the host, see
+	ReadMe.txt. */
+	iSocket = open( "/dev/net/tun", O_RDWR | O_NONBLOCK );
+
+	if( iSocket >= 0 )
+	{
+		memset( &xRequest, '\0', sizeof( xRequest ) );
+		xRequest.ifr_flags = IFF_TAP | IFF_NO_PI;
+		strncpy( xRequest.ifr_name, pcName, sizeof( xRequest.ifr_name ) - 1 );
+
+		if( ioctl( iSocket, TUNSETIFF, ( void * ) &xRequest ) < 0 )
+		{
+			close( iSocket );
+			iSocket = -1;
+		}
+	}
+
+	if( iSocket < 0 )
+	{
+		FreeRTOS_printf( ( "prvOpenTAP: can not open %s: %s\n", pcName, strerror( errno ) ) );
+	}
+
+	return iSocket;
+}
+/*-----------------------------------------------------------*/
+
+static int prvOpenRawSocket( const char *pcName )
+{
+struct sockaddr_ll xAddress;
+struct packet_mreq xMembership;
+int iSocket;
+
+	iSocket = socket( AF_PACKET, SOCK_RAW | SOCK_NONBLOCK, htons( ETH_P_ALL ) );
+
+	if( iSocket >= 0 )
+	{
+		memset( &xAddress, '\0', sizeof( xAddress ) );
+		xAddress.sll_family = AF_PACKET;
+		xAddress.sll_protocol = htons( ETH_P_ALL );
+		xAddress.sll_ifindex = ( int ) if_nametoindex( pcName );
+
+		/* The interface is put in promiscuous mode because the MAC address of
+		the stack is not the MAC address of the host interface. */
+		memset( &xMembership, '\0', sizeof( xMembership ) );
+		xMembership.mr_ifindex = xAddress.sll_ifindex;
+		xMembership.mr_type = PACKET_MR_PROMISC;
+
+		if( ( xAddress.sll_ifindex == 0 ) ||
+			( bind( iSocket, ( struct sockaddr * ) &xAddress, sizeof( xAddress ) ) < 0 ) ||
+			( setsockopt( iSocket, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &xMembership, sizeof( xMembership ) ) < 0 ) )
+		{
+			close( iSocket );
+			iSocket = -1;
+		}
+	}
+
+	if( iSocket < 0 )
+	{
+		FreeRTOS_printf( ( "prvOpenRawSocket: can not open %s: %s\n", pcName, strerror( errno ) ) );
+	}
+
+	return iSocket;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSendFrame( LinuxInterface_t *pxLinux, NetworkBufferDescriptor_t * const pxNetworkBuffer, BaseType_t xReleaseAfterSend )
+{
+	iptraceNETWORK_INTERFACE_TRANSMIT();
+
+	/* The host copies the frame while it is written, so the frame is sent
+	straight from the network buffer, whether ipconfigZERO_COPY_TX_DRIVER is
+	set or not.  The write never blocks: a frame for which the host has no
+	room is dropped, as a real MAC would do. */
+	if( ( pxLinux->iSocket < 0 ) ||
+		( write( pxLinux->iSocket, pxNetworkBuffer->pucEthernetBuffer, pxNetworkBuffer->xDataLength ) != ( ssize_t ) pxNetworkBuffer->xDataLength ) )
+	{
+		pxLinux->ulTxFailures++;
+	}
+
+	if( xReleaseAfterSend != pdFALSE )
+	{
+		vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+	}
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInterruptSimulatorTask( void *pvParameters )
+{
+LinuxInterface_t *pxLinux = ( LinuxInterface_t * ) pvParameters;
+
+	for( ;; )
+	{
+		/* Keep on reading while full batches arrive, under load the task
+		only sleeps when the host runs out of frames. */
+		if( prvReceiveBatch( pxLinux ) == pdFALSE )
+		{
+			/* There is no real way of simulating an interrupt.  Make sure
+			other tasks can run. */
+			vTaskDelay( configLINUX_MAC_INTERRUPT_SIMULATOR_DELAY );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvReceiveBatch( LinuxInterface_t *pxLinux )
+{
+struct mmsghdr xMessages[ niRX_BATCH_SIZE ];
+struct iovec xVectors[ niRX_BATCH_SIZE ];
+NetworkBufferDescriptor_t *pxReceived[ niRX_BATCH_SIZE ];
+NetworkBufferDescriptor_t *pxNetworkBuffer;
+uint8_t *pucFrame;
+UBaseType_t uxAvailable = 0U, uxFetched = 0U, uxReceived = 0U, uxIndex;
+size_t xLength;
+ssize_t xResult;
+BaseType_t xReturn = pdFALSE;
+
+	/* Point one receive area at each frame of the batch. */
+	memset( xMessages, '\0', sizeof( xMessages ) );
+
+	for( uxIndex = 0U; uxIndex < ( UBaseType_t ) niRX_BATCH_SIZE; uxIndex++ )
+	{
+		#if( ipconfigZERO_COPY_RX_DRIVER != 0 )
+		{
+			if( pxLinux->pxRxBuffers[ uxIndex ] == NULL )
+			{
+				pxLinux->pxRxBuffers[ uxIndex ] = pxGetNetworkBufferWithDescriptor( ipTOTAL_ETHERNET_FRAME_SIZE, 0 );
+			}
+
+			if( pxLinux->pxRxBuffers[ uxIndex ] == NULL )
+			{
+				/* Out of network buffers, receive fewer frames. */
+				break;
+			}
+
+			pucFrame = pxLinux->pxRxBuffers[ uxIndex ]->pucEthernetBuffer;
+		}
+		#else
+		{
+			pucFrame = pxLinux->ucRxFrames[ uxIndex ];
+		}
+		#endif /* ipconfigZERO_COPY_RX_DRIVER */
+
+		xVectors[ uxIndex ].iov_base = ( void * ) pucFrame;
+		xVectors[ uxIndex ].iov_len = ipTOTAL_ETHERNET_FRAME_SIZE;
+		xMessages[ uxIndex ].msg_hdr.msg_iov = &( xVectors[ uxIndex ] );
+		xMessages[ uxIndex ].msg_hdr.msg_iovlen = 1;
+		uxAvailable++;
+	}
+
+	/* Fetch the frames that are waiting.  A raw socket hands out a whole batch
+	in a single system call, a TAP device one frame per read(). */
+	if( uxAvailable == 0U )
+	{
+		/* No receive areas. */
+	}
+	else if( pxLinux->xRawSocket != pdFALSE )
+	{
+		xResult = recvmmsg( pxLinux->iSocket, xMessages, ( unsigned int ) uxAvailable, MSG_DONTWAIT, NULL );
+
+		if( xResult > 0 )
+		{
+			uxFetched = ( UBaseType_t ) xResult;
+		}
+	}
+	else
+	{
+		while( uxFetched < uxAvailable )
+		{
+			xResult = read( pxLinux->iSocket, xVectors[ uxFetched ].iov_base, xVectors[ uxFetched ].iov_len );
+
+			if( xResult <= 0 )
+			{
+				break;
+			}
+
+			xMessages[ uxFetched ].msg_len = ( unsigned int ) xResult;
+			uxFetched++;
+		}
+	}
+
+	/* Pass the frames that are of interest on to the stack. */
+	for( uxIndex = 0U; uxIndex < uxFetched; uxIndex++ )
+	{
+		iptraceNETWORK_INTERFACE_RECEIVE();
+
+		xLength = ( size_t ) xMessages[ uxIndex ].msg_len;
+		pucFrame = ( uint8_t * ) xVectors[ uxIndex ].iov_base;
+		pxNetworkBuffer = NULL;
+
+		if( ( xLength >= sizeof( EthernetHeader_t ) ) &&
+			( ipCONSIDER_FRAME_FOR_PROCESSING( pucFrame ) == eProcessBuffer ) )
+		{
+			#if( ipconfigZERO_COPY_RX_DRIVER != 0 )
+			{
+				/* The frame is already in a network buffer.  The slot gets a
+				new buffer at the start of the next batch. */
+				pxNetworkBuffer = pxLinux->pxRxBuffers[ uxIndex ];
+				pxLinux->pxRxBuffers[ uxIndex ] = NULL;
+			}
+			#else
+			{
+				pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( xLength, 0 );
+
+				if( pxNetworkBuffer != NULL )
+				{
+					memcpy( pxNetworkBuffer->pucEthernetBuffer, pucFrame, xLength );
+				}
+			}
+			#endif /* ipconfigZERO_COPY_RX_DRIVER */
+		}
+
+		if( pxNetworkBuffer != NULL )
+		{
+			pxNetworkBuffer->xDataLength = xLength;
+
+			#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+			{
+				pxNetworkBuffer->pxInterface = pxLinux->pxInterface;
+			}
+			#endif
+
+			pxReceived[ uxReceived ] = pxNetworkBuffer;
+			uxReceived++;
+		}
+		else if( xLength >= sizeof( EthernetHeader_t ) )
+		{
+			/* Either a frame for another host, or there was no network buffer
+			to copy it to. */
+			pxLinux->ulRxDropped++;
+		}
+		else
+		{
+			/* A runt frame. */
+		}
+	}
+
+	if( uxReceived > 0U )
+	{
+		if( prvPassToIPTask( pxReceived, uxReceived ) == pdFAIL )
+		{
+			pxLinux->ulRxDropped++;
+		}
+		else if( uxFetched == ( UBaseType_t ) niRX_BATCH_SIZE )
+		{
+			xReturn = pdTRUE;
+		}
+		else
+		{
+			/* The host has run out of frames. */
+		}
+	}
+	else if( uxFetched == ( UBaseType_t ) niRX_BATCH_SIZE )
+	{
+		/* A full batch of frames that were all filtered out. */
+		xReturn = pdTRUE;
+	}
+	else
+	{
+		/* Nothing to do. */
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvPassToIPTask( NetworkBufferDescriptor_t *pxBuffers[], UBaseType_t uxCount )
+{
+BaseType_t xReturn = pdPASS;
+UBaseType_t uxIndex;
+
+	#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+	{
+		/* Chain the buffers together so the IP-task receives the whole batch
+		with a single message. */
+		for( uxIndex = 0U; uxIndex < uxCount; uxIndex++ )
+		{
+			pxBuffers[ uxIndex ]->pxNextBuffer = ( ( uxIndex + 1U ) < uxCount ) ? pxBuffers[ uxIndex + 1U ] : NULL;
+		}
+
+		/* When it fails, the whole chain has been released. */
+		xReturn = xSendNetworkBuffersToIPTask( pxBuffers[ 0 ], ( TickType_t ) 0 );
+	}
+	#else
+	{
+		for( uxIndex = 0U; uxIndex < uxCount; uxIndex++ )
+		{
+			if( xSendNetworkBuffersToIPTask( pxBuffers[ uxIndex ], ( TickType_t ) 0 ) == pdFAIL )
+			{
+				xReturn = pdFAIL;
+			}
+		}
+	}
+	#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,61 @@
+/*
+FreeRTOS+TCP V2.0.11
+Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ http://aws.amazon.com/freertos
+ http://www.FreeRTOS.org
+*/
+
+#ifndef NETWORK_INTERFACE_LINUX_H
+#define NETWORK_INTERFACE_LINUX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if( ipconfigUSE_MULTI_INTERFACE != 0 )
+
+	/*
+	 * Fill in pxInterface so it sends and receives through the host network
+	 * interface pcHostName.  When xRawSocket is pdFALSE pcHostName is the name
+	 * of a TAP device, which is created if it does not exist yet.  Otherwise
+	 * an AF_PACKET socket is bound to the existing host interface pcHostName.
+	 * The result must be passed to FreeRTOS_AddNetworkInterface().
+	 */
+	NetworkInterface_t *pxLinux_FillInterfaceDescriptor( NetworkInterface_t *pxInterface,
+		const char *pcHostName, BaseType_t xRawSocket );
+
+	/*
+	 * Fill in two interfaces that are connected to each other by a virtual
+	 * cable that never leaves the process: every frame sent through one of
+	 * them is received by the other.  Give each interface an end-point, and
+	 * add a host route to the address of the peer end-point through the
+	 * local one, so the stack talks to itself through the pair.  This allows
+	 * throughput and latency to be measured without any host networking.
+	 */
+	void vLinux_FillLoopbackPair( NetworkInterface_t *pxInterfaceA, NetworkInterface_t *pxInterfaceB );
+
+#endif /* ipconfigUSE_MULTI_INTERFACE */
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NETWORK_INTERFACE_LINUX_H */
@@ -30,9 +30,83 @@ uint32_t TEST_FreeRTOS_TCP_prvParseDNSReply( uint8_t * pucUDPPayloadBuffer,
                                              size_t xBufferLength,
                                              TickType_t xIdentifier );
 
+#if ( ipconfigUSE_DNS_CACHE == 1 )
+/* Looks up pcName in the DNS cache, as FreeRTOS_gethostbyname() does. */
+    BaseType_t TEST_FreeRTOS_DNS_LookupCache( const char * pcName,
+                                              uint32_t * pulIP,
+                                              TickType_t * pxPrefetchIdentifier );
+
+/* Makes the cache entry of pcName ulSeconds older. */
+    void TEST_FreeRTOS_DNS_AgeCacheEntry( const char * pcName,
+                                          uint32_t ulSeconds );
+#endif
+
+#if ( ipconfigDNS_USE_CALLBACKS != 0 )
+/* Returns the socket through which the IP-task sends asynchronous look-ups. */
+    Socket_t TEST_FreeRTOS_DNS_ResolverSocket( void );
+
+/* Returns pdTRUE while the asynchronous look-up of pcName is outstanding, and
+ * copies the identifier and the number of attempts of its request. */
+    BaseType_t TEST_FreeRTOS_DNS_GetRequest( const char * pcName,
+                                             uint16_t * pusIdentifier,
+                                             BaseType_t * pxAttempts );
+#endif
+
 void TEST_FreeRTOS_TCP_prvCheckOptions( FreeRTOS_Socket_t * pxSocket,
                                         NetworkBufferDescriptor_t * pxNetworkBuffer );
 
 void TEST_FreeRTOS_TCP_prvTCPCreateWindow( FreeRTOS_Socket_t * pxSocket );
 
+#if ( ipconfigUSE_TCP_WIN == 1 ) && ( ( ipconfigTCP_ACK_EVERY_N_SEGMENTS > 0 ) || ( ipconfigTCP_QUICKACK_IDLE_MS > 0 ) )
+/* Returns pdTRUE when a data segment that arrives now must be acknowledged
+ * without delay. */
+    BaseType_t TEST_FreeRTOS_TCP_prvTCPAckImmediately( FreeRTOS_Socket_t * pxSocket );
+#endif
+
+#if ( ipconfigTCP_SYN_CACHE_SIZE > 0 )
+/* Returns pdTRUE when the SYN cache holds a request from the peer, and copies
+ * the sequence number of the SYN+ACK that answered it.  All values are
+ * host-endian. */
+    BaseType_t TEST_FreeRTOS_TCP_SynCacheLookup( uint32_t ulRemoteIP,
+                                                 uint16_t usRemotePort,
+                                                 uint16_t usLocalPort,
+                                                 uint32_t * pulOurSequenceNumber );
+#endif
+
+#if ( ipconfigTCP_SYN_COOKIES != 0 )
+    uint32_t TEST_FreeRTOS_TCP_prvSynCookieCreate( uint32_t ulRemoteIP,
+                                                   uint16_t usRemotePort,
+                                                   uint16_t usLocalPort,
+                                                   uint32_t ulPeerSequenceNumber,
+                                                   uint16_t * pusMSS );
+
+    BaseType_t TEST_FreeRTOS_TCP_prvSynCookieCheck( uint32_t ulRemoteIP,
+                                                    uint16_t usRemotePort,
+                                                    uint16_t usLocalPort,
+                                                    uint32_t ulPeerSequenceNumber,
+                                                    uint32_t ulCookie,
+                                                    uint16_t * pusMSS );
+#endif
+
+#if ( ipconfigARP_QUEUE_LENGTH > 0 )
+/* Returns the number of packets that wait for the ARP reply of ulIPAddress. */
+    UBaseType_t TEST_FreeRTOS_ARP_WaitingPackets( uint32_t ulIPAddress );
+#endif
+
+#if ( ipconfigUSE_IPv6 != 0 )
+    #include "FreeRTOS_IPv6.h"
+
+/* Returns the state of an address of this node: 0 unused, 1 tentative,
+ * 2 preferred or 3 duplicate, and copies the address, whatever its state. */
+    BaseType_t TEST_FreeRTOS_IPv6_GetAddressState( eIPv6AddressType_t eType,
+                                                   IPv6_Address_t * pxAddress );
+
+/* Returns pdTRUE when the neighbour cache knows the MAC address of pxAddress. */
+    BaseType_t TEST_FreeRTOS_IPv6_NDLookup( const IPv6_Address_t * pxAddress,
+                                            MACAddress_t * pxMACAddress );
+
+/* Returns pdTRUE when a packet waits for the advertisement of pxAddress. */
+    BaseType_t TEST_FreeRTOS_IPv6_NDIsWaiting( const IPv6_Address_t * pxAddress );
+#endif
+
 #endif /* ifndef _AWS_FREERTOS_TCP_TEST_ACCESS_DECLARE_H_ */
@@ -45,4 +45,71 @@ uint32_t TEST_FreeRTOS_TCP_prvParseDNSReply( uint8_t * pucUDPPayloadBuffer,
 }
 /*-----------------------------------------------------------*/
 
+#if ( ipconfigUSE_DNS_CACHE == 1 )
+    BaseType_t TEST_FreeRTOS_DNS_LookupCache( const char * pcName,
+                                              uint32_t * pulIP,
+                                              TickType_t * pxPrefetchIdentifier )
+    {
+        return prvLookupDNSCache( pcName, pulIP, pxPrefetchIdentifier );
+    }
+/*-----------------------------------------------------------*/
+
+    void TEST_FreeRTOS_DNS_AgeCacheEntry( const char * pcName,
+                                          uint32_t ulSeconds )
+    {
+        BaseType_t x;
+
+        vTaskSuspendAll();
+        {
+            x = prvFindDNSCacheEntry( pcName, prvHashDNSName( pcName ) );
+
+            if( x >= 0 )
+            {
+                xDNSCache[ x ].ulTimeWhenAddedInSeconds -= ulSeconds;
+            }
+        }
+        ( void ) xTaskResumeAll();
+    }
+/*-----------------------------------------------------------*/
+#endif /* if ( ipconfigUSE_DNS_CACHE == 1 ) */
+
+#if ( ipconfigDNS_USE_CALLBACKS != 0 )
+    Socket_t TEST_FreeRTOS_DNS_ResolverSocket( void )
+    {
+        return xDNSResolverSocket;
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t TEST_FreeRTOS_DNS_GetRequest( const char * pcName,
+                                             uint16_t * pusIdentifier,
+                                             BaseType_t * pxAttempts )
+    {
+        const ListItem_t * pxIterator;
+        const MiniListItem_t * xEnd = ( const MiniListItem_t * ) listGET_END_MARKER( &xCallbackList );
+        BaseType_t xFound = pdFALSE;
+
+        vTaskSuspendAll();
+        {
+            for( pxIterator = ( const ListItem_t * ) listGET_NEXT( xEnd );
+                 pxIterator != ( const ListItem_t * ) xEnd;
+                 pxIterator = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+            {
+                DNSCallback_t * pxCallback = ( DNSCallback_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+
+                if( strcmp( pxCallback->pcName, pcName ) == 0 )
+                {
+                    *pusIdentifier = ( uint16_t ) listGET_LIST_ITEM_VALUE( pxIterator );
+                    *pxAttempts = pxCallback->xAttempts;
+                    xFound = pdTRUE;
+                    break;
+                }
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        return xFound;
+    }
+/*-----------------------------------------------------------*/
+#endif /* if ( ipconfigDNS_USE_CALLBACKS != 0 ) */
+
 #endif /* ifndef _AWS_FREERTOS_TCP_TEST_ACCESS_DNS_DEFINE_H_ */
@@ -0,0 +1,79 @@
+/*
+ * FreeRTOS+TCP V2.0.11
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_freertos_tcp_test_access_ipv6_define.h
+ * @brief Function wrappers that access private members of FreeRTOS_IPv6.c.
+ *
+ * Needed for testing private functions.
+ */
+
+#ifndef _AWS_FREERTOS_TCP_TEST_ACCESS_IPV6_DEFINE_H_
+#define _AWS_FREERTOS_TCP_TEST_ACCESS_IPV6_DEFINE_H_
+
+#include "iot_freertos_tcp_test_access_declare.h"
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TEST_FreeRTOS_IPv6_GetAddressState( eIPv6AddressType_t eType,
+                                               IPv6_Address_t * pxAddress )
+{
+    memcpy( pxAddress->ucBytes, xAddresses[ eType ].xAddress.ucBytes, sizeof( pxAddress->ucBytes ) );
+
+    return ( BaseType_t ) xAddresses[ eType ].eState;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t TEST_FreeRTOS_IPv6_NDLookup( const IPv6_Address_t * pxAddress,
+                                        MACAddress_t * pxMACAddress )
+{
+    BaseType_t x = prvNDFindEntry( pxAddress );
+    BaseType_t xReturn = pdFALSE;
+
+    if( ( x >= 0 ) && ( xNDCache[ x ].ucValid != ( uint8_t ) pdFALSE ) )
+    {
+        memcpy( pxMACAddress->ucBytes, xNDCache[ x ].xMACAddress.ucBytes, sizeof( pxMACAddress->ucBytes ) );
+        xReturn = pdTRUE;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t TEST_FreeRTOS_IPv6_NDIsWaiting( const IPv6_Address_t * pxAddress )
+{
+    BaseType_t x = prvNDFindEntry( pxAddress );
+    BaseType_t xReturn = pdFALSE;
+
+    if( ( x >= 0 ) && ( xNDCache[ x ].pxWaitingPacket != NULL ) )
+    {
+        xReturn = pdTRUE;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* ifndef _AWS_FREERTOS_TCP_TEST_ACCESS_IPV6_DEFINE_H_ */
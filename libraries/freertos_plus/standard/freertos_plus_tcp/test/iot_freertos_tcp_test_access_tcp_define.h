@@ -50,4 +50,84 @@ void TEST_FreeRTOS_TCP_prvTCPCreateWindow( FreeRTOS_Socket_t * pxSocket )
 }
 /*-----------------------------------------------------------*/
 
+#if ( ipconfigUSE_TCP_WIN == 1 ) && ( ( ipconfigTCP_ACK_EVERY_N_SEGMENTS > 0 ) || ( ipconfigTCP_QUICKACK_IDLE_MS > 0 ) )
+
+    BaseType_t TEST_FreeRTOS_TCP_prvTCPAckImmediately( FreeRTOS_Socket_t * pxSocket )
+    {
+        return prvTCPAckImmediately( pxSocket );
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if ( ipconfigUSE_TCP_WIN == 1 ) && ( ( ipconfigTCP_ACK_EVERY_N_SEGMENTS > 0 ) || ( ipconfigTCP_QUICKACK_IDLE_MS > 0 ) ) */
+
+#if ( ipconfigTCP_SYN_CACHE_SIZE > 0 )
+
+    BaseType_t TEST_FreeRTOS_TCP_SynCacheLookup( uint32_t ulRemoteIP,
+                                                 uint16_t usRemotePort,
+                                                 uint16_t usLocalPort,
+                                                 uint32_t * pulOurSequenceNumber )
+    {
+        SynCacheEntry_t * pxEntry = prvSynCacheLookup( ulRemoteIP, usRemotePort, usLocalPort );
+        BaseType_t xReturn = pdFALSE;
+
+        if( pxEntry != NULL )
+        {
+            *pulOurSequenceNumber = pxEntry->ulOurSequenceNumber;
+            xReturn = pdTRUE;
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if ( ipconfigTCP_SYN_CACHE_SIZE > 0 ) */
+
+#if ( ipconfigTCP_SYN_COOKIES != 0 )
+
+    uint32_t TEST_FreeRTOS_TCP_prvSynCookieCreate( uint32_t ulRemoteIP,
+                                                   uint16_t usRemotePort,
+                                                   uint16_t usLocalPort,
+                                                   uint32_t ulPeerSequenceNumber,
+                                                   uint16_t * pusMSS )
+    {
+        SynCacheEntry_t xEntry;
+        uint32_t ulCookie;
+
+        memset( &xEntry, 0, sizeof( xEntry ) );
+        xEntry.ulRemoteIP = ulRemoteIP;
+        xEntry.usRemotePort = usRemotePort;
+        xEntry.usLocalPort = usLocalPort;
+        xEntry.ulPeerSequenceNumber = ulPeerSequenceNumber;
+        xEntry.usPeerMSS = *pusMSS;
+        ulCookie = prvSynCookieCreate( &xEntry );
+        *pusMSS = xEntry.usPeerMSS;
+
+        return ulCookie;
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t TEST_FreeRTOS_TCP_prvSynCookieCheck( uint32_t ulRemoteIP,
+                                                    uint16_t usRemotePort,
+                                                    uint16_t usLocalPort,
+                                                    uint32_t ulPeerSequenceNumber,
+                                                    uint32_t ulCookie,
+                                                    uint16_t * pusMSS )
+    {
+        SynCacheEntry_t xEntry;
+        BaseType_t xResult;
+
+        memset( &xEntry, 0, sizeof( xEntry ) );
+        xEntry.ulRemoteIP = ulRemoteIP;
+        xEntry.usRemotePort = usRemotePort;
+        xEntry.usLocalPort = usLocalPort;
+        xEntry.ulPeerSequenceNumber = ulPeerSequenceNumber;
+        xResult = prvSynCookieCheck( &xEntry, ulCookie );
+        *pusMSS = xEntry.usPeerMSS;
+
+        return xResult;
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if ( ipconfigTCP_SYN_COOKIES != 0 ) */
+
 #endif /* ifndef _AWS_FREERTOS_TCP_TEST_ACCESS_TCP_DEFINE_H_ */
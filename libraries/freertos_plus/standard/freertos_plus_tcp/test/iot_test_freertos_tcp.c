@@ -30,10 +30,17 @@
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
+#include "task.h"
 #include "list.h"
 #include "FreeRTOS_IP.h"
 #include "FreeRTOS_IP_Private.h"
+#include "FreeRTOS_ARP.h"
 #include "FreeRTOS_DNS.h"
+#include "FreeRTOS_Routing.h"
+#include "FreeRTOS_IPv6.h"
+#include "NetworkBufferManagement.h"
+#include "NetworkInterface.h"
+#include "FreeRTOS_Capture.h"
 
 /* Test includes. */
 #include "unity_fixture.h"
@@ -44,6 +51,12 @@
  * @brief Configuration for this test group.
  */
 
+/* The TCP flags that the tests put in a segment, as FreeRTOS_TCP_IP.c defines
+ * them privately. */
+#define testTCP_FLAG_SYN    ( 0x02u )
+#define testTCP_FLAG_RST    ( 0x04u )
+#define testTCP_FLAG_ACK    ( 0x10u )
+
 /*
  * @brief Test group definition.
  */
@@ -68,6 +81,133 @@ TEST_GROUP_RUNNER( Full_FREERTOS_TCP )
 
     /* xProcessReceivedUDPPacket test. */
     RUN_TEST_CASE( Full_FREERTOS_TCP, UDPPacketLength );
+
+    /* usGenerateChecksum() test. */
+    RUN_TEST_CASE( Full_FREERTOS_TCP, InternetChecksum );
+
+    /* RTO estimator test. */
+    RUN_TEST_CASE( Full_FREERTOS_TCP, RetransmissionTimeout );
+
+    #if ( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+        /* Time-stamp option test. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, TimeStamps );
+    #endif
+
+    #if ( ipconfigUSE_MULTI_INTERFACE == 1 )
+        /* FreeRTOS_FindRoute() tests. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, RoutingLongestPrefix );
+        RUN_TEST_CASE( Full_FREERTOS_TCP, RoutingEqualCost );
+    #endif
+
+    #if ( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+        /* Congestion control tests. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, CongestionNewReno );
+        RUN_TEST_CASE( Full_FREERTOS_TCP, CongestionCubic );
+    #endif
+
+    #if ( ipconfigUSE_DRIVER_OFFLOADS != 0 ) && ( ipconfigUSE_TCP_WIN == 1 )
+        /* TCP segmentation offload test. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, SegmentationOffload );
+    #endif
+
+    #if ( ipconfigUSE_IP_REASSEMBLY != 0 )
+        /* IP reassembly test. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, Reassembly );
+    #endif
+
+    #if ( ipconfigUSE_IPv6 != 0 )
+        /* IPv6 address text conversion test. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, IPv6AddressText );
+
+        /* IPv6 neighbour discovery, address configuration, ping and UDP. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, IPv6SLAAC );
+        RUN_TEST_CASE( Full_FREERTOS_TCP, IPv6NeighbourDiscovery );
+        RUN_TEST_CASE( Full_FREERTOS_TCP, IPv6EchoRequest );
+        RUN_TEST_CASE( Full_FREERTOS_TCP, IPv6DualStackUDP );
+    #endif
+
+    #if ( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+        /* Reference counted network buffer test. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, NetworkBufferChains );
+    #endif
+
+    #if ( ipconfigTCP_SYN_COOKIES != 0 )
+        /* SYN cookie encoding test. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, SynCookies );
+    #endif
+
+    #if ( ipconfigUSE_TCP_INFO != 0 ) && ( ipconfigUSE_TCP_WIN == 1 )
+        /* Connection statistics test. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, TCPInfo );
+    #endif
+
+    #if ( ipconfigUSE_PCAP_CAPTURE != 0 )
+        /* Frame capture test. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, Capture );
+    #endif
+
+    #if ( ipconfigUSE_UDP_BATCH != 0 )
+        /* Batched UDP send and receive test. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, UDPBatch );
+    #endif
+
+    /* Network buffer allocation tests. */
+    RUN_TEST_CASE( Full_FREERTOS_TCP, NetworkBufferGetRelease );
+    RUN_TEST_CASE( Full_FREERTOS_TCP, NetworkBufferExhaustion );
+    RUN_TEST_CASE( Full_FREERTOS_TCP, NetworkBufferOversize );
+
+    /* UDP port look-up test. */
+    RUN_TEST_CASE( Full_FREERTOS_TCP, UDPPortLookup );
+
+    #if ( ipconfigARP_HASH_TABLE_SIZE > 0 )
+        /* ARP cache replacement test. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, ARPCacheLRU );
+    #endif
+
+    #if ( ipconfigARP_QUEUE_LENGTH > 0 )
+        /* ARP pending-packet queue test. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, ARPPendingQueue );
+    #endif
+
+    #if ( ipconfigUSE_DNS_CACHE == 1 )
+        /* DNS cache test. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, DNSCache );
+    #endif
+
+    #if ( ipconfigDNS_USE_CALLBACKS != 0 ) && ( configUSE_TASK_NOTIFICATIONS == 1 )
+        /* Asynchronous DNS test. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, DNSAsync );
+    #endif
+
+    #if ( ipconfigSUPPORT_SELECT_READY_LIST == 1 )
+        /* Socket set ready-list test. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, SelectReady );
+    #endif
+
+    #if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+        /* Linked receive messages test. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, LinkedRxMessages );
+    #endif
+
+    #if ( ipconfigUSE_TCP_WIN == 1 ) && ( ( ipconfigTCP_ACK_EVERY_N_SEGMENTS > 0 ) || ( ipconfigTCP_QUICKACK_IDLE_MS > 0 ) )
+        /* Delayed-ACK policy test. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, TCPAckPolicy );
+    #endif
+
+    #if ( ipconfigTCP_RX_COALESCE_BYTES > 0 )
+        /* Reader wake-up coalescing test. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, TCPRxCoalesce );
+    #endif
+
+    #if ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_SYN_CACHE_SIZE > 0 )
+        /* SYN cache test. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, SynCache );
+    #endif
+
+    #if ( ipconfigUSE_TCP == 1 )
+        /* TCP socket look-up test. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, TCPSocketLookup );
+    #endif
 }
 
 TEST( Full_FREERTOS_TCP, prvParseDnsResponse )
@@ -360,3 +500,2455 @@ TEST( Full_FREERTOS_TCP, UDPPacketLength )
     xReturn = xProcessReceivedUDPPacket( &xNetworkBuffer, usPort );
     TEST_ASSERT_EQUAL_UINT32( pdFAIL, xReturn );
 }
+
+/* The Internet checksum of RFC 1071, one 16-bit word at a time. */
+static uint16_t prvReferenceChecksum( uint32_t ulSum,
+                                      const uint8_t * pucData,
+                                      size_t uxLength )
+{
+    uint32_t ulTotal = ulSum;
+    size_t uxIndex;
+
+    for( uxIndex = 0; uxIndex < uxLength; uxIndex++ )
+    {
+        ulTotal += ( ( uxIndex & 1U ) == 0U ) ? ( ( uint32_t ) pucData[ uxIndex ] << 8 ) : pucData[ uxIndex ];
+        ulTotal = ( ulTotal & 0xffffU ) + ( ulTotal >> 16 );
+    }
+
+    return ( uint16_t ) ulTotal;
+}
+
+TEST( Full_FREERTOS_TCP, InternetChecksum )
+{
+    static uint8_t ucSource[ 1600 ];
+    static uint8_t ucTarget[ 1600 ];
+    uint32_t ulSum;
+    size_t uxLength, uxOffset;
+    uint16_t usExpected;
+
+    for( uxLength = 0; uxLength < sizeof( ucSource ); uxLength++ )
+    {
+        ucSource[ uxLength ] = ( uint8_t ) ( ( uxLength * 181U ) + ( uxLength >> 8 ) );
+    }
+
+    /* All lengths of a short frame, at every alignment.  The initial value is
+     * only used at even addresses, like the stack does. */
+    for( uxLength = 0; uxLength <= 1500; uxLength += ( uxLength < 80 ) ? 1 : 37 )
+    {
+        for( uxOffset = 0; uxOffset < 4; uxOffset++ )
+        {
+            ulSum = ( ( uxOffset & 1U ) == 0U ) ? ( 0x1234U + uxLength ) : 0U;
+            usExpected = prvReferenceChecksum( ulSum, &( ucSource[ uxOffset ] ), uxLength );
+            TEST_ASSERT_EQUAL_HEX16( usExpected, usGenerateChecksum( ulSum, &( ucSource[ uxOffset ] ), uxLength ) );
+
+            #if ( ipconfigUSE_CHECKSUM_KERNELS != 0 )
+                memset( ucTarget, 0, sizeof( ucTarget ) );
+                TEST_ASSERT_EQUAL_HEX16( usExpected, usGenerateChecksumCopy( ulSum, &( ucTarget[ 3 - uxOffset ] ), &( ucSource[ uxOffset ] ), uxLength ) );
+                TEST_ASSERT_EQUAL_MEMORY( &( ucSource[ uxOffset ] ), &( ucTarget[ 3 - uxOffset ] ), uxLength );
+            #endif
+        }
+    }
+
+    /* Carries out of every position. */
+    memset( ucSource, 0xff, sizeof( ucSource ) );
+    TEST_ASSERT_EQUAL_HEX16( 0xffff, usGenerateChecksum( 0U, ucSource, sizeof( ucSource ) ) );
+    TEST_ASSERT_EQUAL_HEX16( 0xffff, usGenerateChecksum( 0U, &( ucSource[ 1 ] ), sizeof( ucSource ) - 2 ) );
+
+    ( void ) ucTarget;
+}
+
+TEST( Full_FREERTOS_TCP, RetransmissionTimeout )
+{
+    static TCPWindow_t xWindow;
+    int32_t lPosition;
+    TickType_t uxDelay = 0;
+
+    memset( &xWindow, 0, sizeof( xWindow ) );
+    vTCPWindowCreate( &xWindow, 4000, 4000, 1000, 10000, 1000 );
+
+    /* RFC 6298 (2.1): before the first measurement the RTO is one second. */
+    TEST_ASSERT_EQUAL( 1000, xWindow.lRTO );
+
+    /* (2.2): SRTT = R, RTTVAR = R / 2, RTO = SRTT + 4 * RTTVAR. */
+    vTCPWindowUpdateRTT( &xWindow, 300 );
+    TEST_ASSERT_EQUAL( 300, xWindow.lSRTT );
+    TEST_ASSERT_EQUAL( 150, xWindow.lRTTVar );
+    TEST_ASSERT_EQUAL( 900, xWindow.lRTO );
+
+    /* (2.3): RTTVAR first, using the old SRTT, then SRTT. */
+    vTCPWindowUpdateRTT( &xWindow, 100 );
+    TEST_ASSERT_EQUAL( 162, xWindow.lRTTVar );
+    TEST_ASSERT_EQUAL( 275, xWindow.lSRTT );
+    TEST_ASSERT_EQUAL( 275 + 4 * 162, xWindow.lRTO );
+
+    /* The RTO is clamped to the configured limits. */
+    for( lPosition = 0; lPosition < 100; lPosition++ )
+    {
+        vTCPWindowUpdateRTT( &xWindow, 2 );
+    }
+
+    TEST_ASSERT_EQUAL( ipconfigTCP_RTO_MIN_MS, xWindow.lRTO );
+
+    vTCPWindowUpdateRTT( &xWindow, 2 * ipconfigTCP_RTO_MAX_MS );
+    TEST_ASSERT_EQUAL( ipconfigTCP_RTO_MAX_MS, xWindow.lRTO );
+
+    /* A segment that was sent once is due after one RTO. */
+    xWindow.lRTO = 400;
+    TEST_ASSERT_EQUAL( 1000, lTCPWindowTxAdd( &xWindow, 1000, 0, 4000 ) );
+    TEST_ASSERT_EQUAL( 1000, ulTCPWindowTxGet( &xWindow, 4000, &lPosition ) );
+    TEST_ASSERT_TRUE( xTCPWindowTxHasData( &xWindow, 4000, &uxDelay ) );
+    TEST_ASSERT_TRUE( uxDelay <= pdMS_TO_TICKS( 400 ) );
+    TEST_ASSERT_TRUE( uxDelay > pdMS_TO_TICKS( 350 ) );
+
+    vTCPWindowDestroy( &xWindow );
+}
+
+#if ( ipconfigUSE_TCP_TIMESTAMPS != 0 )
+
+/* Write a TCP header that carries only a time-stamp option. */
+    static void prvSetTimeStampPacket( TCPPacket_t * pxPacket,
+                                       uint8_t ucFlags,
+                                       uint32_t ulSequence,
+                                       uint32_t ulAck,
+                                       uint32_t ulTSValue,
+                                       uint32_t ulTSEcho )
+    {
+        uint8_t * pucOption = pxPacket->xTCPHeader.ucOptdata;
+
+        memset( pxPacket, 0, sizeof( *pxPacket ) );
+        pxPacket->xTCPHeader.ucTCPOffset = ( uint8_t ) ( ( ipSIZE_OF_TCP_HEADER + 12u ) << 2 );
+        pxPacket->xTCPHeader.ucTCPFlags = ucFlags;
+        pxPacket->xTCPHeader.ulSequenceNumber = FreeRTOS_htonl( ulSequence );
+        pxPacket->xTCPHeader.ulAckNr = FreeRTOS_htonl( ulAck );
+
+        pucOption[ 0 ] = 1u; /* NOP */
+        pucOption[ 1 ] = 1u; /* NOP */
+        pucOption[ 2 ] = 8u; /* Time-stamp option. */
+        pucOption[ 3 ] = 10u;
+        ulTSValue = FreeRTOS_htonl( ulTSValue );
+        ulTSEcho = FreeRTOS_htonl( ulTSEcho );
+        memcpy( pucOption + 4, &ulTSValue, sizeof( ulTSValue ) );
+        memcpy( pucOption + 8, &ulTSEcho, sizeof( ulTSEcho ) );
+    }
+
+    TEST( Full_FREERTOS_TCP, TimeStamps )
+    {
+        static FreeRTOS_Socket_t xSocket;
+        static TCPPacket_t xPacket;
+        NetworkBufferDescriptor_t xNetworkBuffer;
+        TCPWindow_t * pxWindow = &( xSocket.u.xTCP.xTCPWindow );
+        uint32_t ulNow;
+
+        memset( &xSocket, 0, sizeof( xSocket ) );
+        xSocket.u.xTCP.usInitMSS = 1000;
+        xSocket.u.xTCP.uxRxWinSize = 4;
+        xSocket.u.xTCP.uxTxWinSize = 4;
+        pxWindow->rx.ulCurrentSequenceNumber = 5000;
+        pxWindow->ulOurSequenceNumber = 10000;
+        TEST_FreeRTOS_TCP_prvTCPCreateWindow( &xSocket );
+
+        xNetworkBuffer.pucEthernetBuffer = ( uint8_t * ) &xPacket;
+        xNetworkBuffer.xDataLength = sizeof( xPacket );
+
+        /* A SYN with a time-stamp enables the option. */
+        prvSetTimeStampPacket( &xPacket, testTCP_FLAG_SYN, 4999, 0, 777, 0 );
+        TEST_FreeRTOS_TCP_prvCheckOptions( &xSocket, &xNetworkBuffer );
+        TEST_ASSERT_EQUAL( 1, xSocket.u.xTCP.bits.bTimeStamps );
+        TEST_ASSERT_EQUAL( 777, xSocket.u.xTCP.ulTSRecent );
+
+        /* An in-order segment updates TS.Recent. */
+        prvSetTimeStampPacket( &xPacket, testTCP_FLAG_ACK, 5000, 10000, 800, 0 );
+        TEST_FreeRTOS_TCP_prvCheckOptions( &xSocket, &xNetworkBuffer );
+        TEST_ASSERT_EQUAL( 800, xSocket.u.xTCP.ulTSRecent );
+
+        /* An older time-stamp and an out-of-order segment do not. */
+        prvSetTimeStampPacket( &xPacket, testTCP_FLAG_ACK, 5000, 10000, 790, 0 );
+        TEST_FreeRTOS_TCP_prvCheckOptions( &xSocket, &xNetworkBuffer );
+        TEST_ASSERT_EQUAL( 800, xSocket.u.xTCP.ulTSRecent );
+
+        prvSetTimeStampPacket( &xPacket, testTCP_FLAG_ACK, 9000, 10000, 900, 0 );
+        TEST_FreeRTOS_TCP_prvCheckOptions( &xSocket, &xNetworkBuffer );
+        TEST_ASSERT_EQUAL( 800, xSocket.u.xTCP.ulTSRecent );
+
+        /* Nothing new was acknowledged, so there is no RTT sample yet. */
+        TEST_ASSERT_EQUAL( 0, pxWindow->u.bits.bHasRTT );
+
+        /* An ACK for new data measures the RTT from the echoed time-stamp. */
+        pxWindow->tx.ulHighestSequenceNumber = 12000;
+        ulNow = ( uint32_t ) ( xTaskGetTickCount() * portTICK_PERIOD_MS );
+        prvSetTimeStampPacket( &xPacket, testTCP_FLAG_ACK, 5000, 11000, 810, ulNow - 250u );
+        TEST_FreeRTOS_TCP_prvCheckOptions( &xSocket, &xNetworkBuffer );
+        TEST_ASSERT_EQUAL( 1, pxWindow->u.bits.bHasRTT );
+        TEST_ASSERT_TRUE( pxWindow->lSRTT >= 250 );
+        TEST_ASSERT_TRUE( pxWindow->lSRTT < 300 );
+
+        vTCPWindowDestroy( pxWindow );
+    }
+
+#endif /* if ( ipconfigUSE_TCP_TIMESTAMPS != 0 ) */
+
+#if ( ipconfigUSE_MULTI_INTERFACE == 1 )
+
+    TEST( Full_FREERTOS_TCP, RoutingLongestPrefix )
+    {
+        NetworkEndPoint_t * pxEndPoint = FreeRTOS_FirstEndPoint();
+        uint32_t ulNet24 = FreeRTOS_inet_addr_quick( 203, 0, 113, 0 );
+        uint32_t ulNet25 = FreeRTOS_inet_addr_quick( 203, 0, 113, 128 );
+        uint32_t ulMask24 = FreeRTOS_inet_addr_quick( 255, 255, 255, 0 );
+        uint32_t ulMask25 = FreeRTOS_inet_addr_quick( 255, 255, 255, 128 );
+        uint32_t ulGatewayA = FreeRTOS_inet_addr_quick( 198, 51, 100, 1 );
+        uint32_t ulGatewayB = FreeRTOS_inet_addr_quick( 198, 51, 100, 2 );
+        uint32_t ulGatewayC = FreeRTOS_inet_addr_quick( 198, 51, 100, 3 );
+        uint32_t ulNextHop = 0;
+
+        TEST_ASSERT_EQUAL( pdPASS, FreeRTOS_AddRoute( ulNet24, ulMask24, ulGatewayA, pxEndPoint, 10 ) );
+        TEST_ASSERT_EQUAL( pdPASS, FreeRTOS_AddRoute( ulNet25, ulMask25, ulGatewayB, pxEndPoint, 20 ) );
+
+        /* The /25 wins over the /24, even though its metric is higher. */
+        TEST_ASSERT_EQUAL_PTR( pxEndPoint, FreeRTOS_FindRoute( FreeRTOS_inet_addr_quick( 203, 0, 113, 200 ), &ulNextHop ) );
+        TEST_ASSERT_EQUAL_UINT32( ulGatewayB, ulNextHop );
+        TEST_ASSERT_EQUAL_PTR( pxEndPoint, FreeRTOS_FindRoute( FreeRTOS_inet_addr_quick( 203, 0, 113, 5 ), &ulNextHop ) );
+        TEST_ASSERT_EQUAL_UINT32( ulGatewayA, ulNextHop );
+
+        /* For routes of the same length the lowest metric wins. */
+        TEST_ASSERT_EQUAL( pdPASS, FreeRTOS_AddRoute( ulNet24, ulMask24, ulGatewayC, pxEndPoint, 5 ) );
+        ( void ) FreeRTOS_FindRoute( FreeRTOS_inet_addr_quick( 203, 0, 113, 5 ), &ulNextHop );
+        TEST_ASSERT_EQUAL_UINT32( ulGatewayC, ulNextHop );
+
+        TEST_ASSERT_EQUAL( pdPASS, FreeRTOS_RemoveRoute( ulNet24, ulMask24, pxEndPoint ) );
+        TEST_ASSERT_EQUAL( pdPASS, FreeRTOS_RemoveRoute( ulNet24, ulMask24, pxEndPoint ) );
+        TEST_ASSERT_EQUAL( pdPASS, FreeRTOS_RemoveRoute( ulNet25, ulMask25, pxEndPoint ) );
+        TEST_ASSERT_EQUAL( pdFAIL, FreeRTOS_RemoveRoute( ulNet25, ulMask25, pxEndPoint ) );
+    }
+
+    TEST( Full_FREERTOS_TCP, RoutingEqualCost )
+    {
+        NetworkEndPoint_t * pxEndPoint = FreeRTOS_FirstEndPoint();
+        uint32_t ulNet = FreeRTOS_inet_addr_quick( 192, 0, 2, 0 );
+        uint32_t ulMask = FreeRTOS_inet_addr_quick( 255, 255, 255, 0 );
+        uint32_t ulGatewayA = FreeRTOS_inet_addr_quick( 198, 51, 100, 1 );
+        uint32_t ulGatewayB = FreeRTOS_inet_addr_quick( 198, 51, 100, 2 );
+        uint32_t ulFirst = 0, ulSecond = 0;
+        BaseType_t xUsedA = pdFALSE, xUsedB = pdFALSE;
+        uint8_t ucHost;
+
+        TEST_ASSERT_EQUAL( pdPASS, FreeRTOS_AddRoute( ulNet, ulMask, ulGatewayA, pxEndPoint, 1 ) );
+        TEST_ASSERT_EQUAL( pdPASS, FreeRTOS_AddRoute( ulNet, ulMask, ulGatewayB, pxEndPoint, 1 ) );
+
+        for( ucHost = 1; ucHost < 255; ucHost++ )
+        {
+            /* The same destination always takes the same route. */
+            ( void ) FreeRTOS_FindRoute( FreeRTOS_inet_addr_quick( 192, 0, 2, ucHost ), &ulFirst );
+            ( void ) FreeRTOS_FindRoute( FreeRTOS_inet_addr_quick( 192, 0, 2, ucHost ), &ulSecond );
+            TEST_ASSERT_EQUAL_UINT32( ulFirst, ulSecond );
+
+            if( ulFirst == ulGatewayA )
+            {
+                xUsedA = pdTRUE;
+            }
+            else
+            {
+                TEST_ASSERT_EQUAL_UINT32( ulGatewayB, ulFirst );
+                xUsedB = pdTRUE;
+            }
+        }
+
+        /* Different destinations are spread over both routes. */
+        TEST_ASSERT_TRUE( xUsedA );
+        TEST_ASSERT_TRUE( xUsedB );
+
+        TEST_ASSERT_EQUAL( pdPASS, FreeRTOS_RemoveRoute( ulNet, ulMask, pxEndPoint ) );
+        TEST_ASSERT_EQUAL( pdPASS, FreeRTOS_RemoveRoute( ulNet, ulMask, pxEndPoint ) );
+    }
+
+#endif /* if ( ipconfigUSE_MULTI_INTERFACE == 1 ) */
+
+#if ( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 )
+
+/* A lossy link between the sender's TCP window and a receiver that
+ * acknowledges every segment, like a peer that doesn't use SACK.  In every
+ * round-trip, the sender transmits all that its windows allow, after which
+ * the receiver acknowledges the segments that were not lost. */
+    #define testCC_MSS               ( 1000UL )
+    #define testCC_SEGMENTS          ( 64UL )
+    #define testCC_FIRST_SEQUENCE    ( 10000UL )
+    #define testCC_LAST_SEQUENCE     ( testCC_FIRST_SEQUENCE + ( testCC_SEGMENTS * testCC_MSS ) )
+
+    static TCPWindow_t xTestWindow;
+
+    static void prvCreateTestWindow( const TCPCongestionOps_t * pxOps )
+    {
+        int32_t lPosition = 0;
+        uint32_t ulIndex;
+
+        memset( &xTestWindow, 0, sizeof( xTestWindow ) );
+        xTestWindow.xCongestion.pxOps = pxOps;
+        vTCPWindowCreate( &xTestWindow, 8 * testCC_MSS, testCC_SEGMENTS * testCC_MSS, 1000, testCC_FIRST_SEQUENCE, testCC_MSS );
+
+        for( ulIndex = 0; ulIndex < testCC_SEGMENTS; ulIndex++ )
+        {
+            TEST_ASSERT_EQUAL( testCC_MSS, lTCPWindowTxAdd( &xTestWindow, testCC_MSS, lPosition, testCC_SEGMENTS * testCC_MSS ) );
+            lPosition += testCC_MSS;
+        }
+    }
+
+    /* Transfers all segments, the first transmission of every segment for
+     * which pxDrop[] is true gets lost.  Returns the number of transmissions. */
+    static uint32_t prvLossyTransfer( const bool * pxDrop )
+    {
+        bool xSent[ testCC_SEGMENTS ] = { false };
+        bool xReceived[ testCC_SEGMENTS ] = { false };
+        uint32_t ulInFlight[ 2 * testCC_SEGMENTS ];
+        uint32_t ulReceiveNext = testCC_FIRST_SEQUENCE;
+        uint32_t ulTransmissions = 0, ulCount, ulIndex, ulOutstanding;
+        int32_t lPosition;
+
+        while( ulReceiveNext != testCC_LAST_SEQUENCE )
+        {
+            ulCount = 0;
+
+            while( ulTCPWindowTxGet( &xTestWindow, testCC_SEGMENTS * testCC_MSS, &lPosition ) != 0 )
+            {
+                ulIndex = ( xTestWindow.ulOurSequenceNumber - testCC_FIRST_SEQUENCE ) / testCC_MSS;
+                TEST_ASSERT_EQUAL( ulIndex * testCC_MSS, lPosition );
+                ulTransmissions++;
+
+                if( xSent[ ulIndex ] == false )
+                {
+                    /* New data must fit in the congestion window. */
+                    ulOutstanding = xTestWindow.tx.ulHighestSequenceNumber - xTestWindow.tx.ulCurrentSequenceNumber;
+                    TEST_ASSERT_TRUE( ulOutstanding <= xTestWindow.xCongestion.ulCWnd );
+                    xSent[ ulIndex ] = true;
+
+                    if( pxDrop[ ulIndex ] == true )
+                    {
+                        continue;
+                    }
+                }
+
+                ulInFlight[ ulCount++ ] = ulIndex;
+            }
+
+            /* Without time-outs, the sender may never stall. */
+            TEST_ASSERT_TRUE( ulCount > 0 );
+
+            for( ulIndex = 0; ulIndex < ulCount; ulIndex++ )
+            {
+                xReceived[ ulInFlight[ ulIndex ] ] = true;
+
+                while( ( ulReceiveNext != testCC_LAST_SEQUENCE ) &&
+                       ( xReceived[ ( ulReceiveNext - testCC_FIRST_SEQUENCE ) / testCC_MSS ] == true ) )
+                {
+                    ulReceiveNext += testCC_MSS;
+                }
+
+                /* In the same order as prvHandleEstablished() does. */
+                vTCPWindowTxDupAck( &xTestWindow, ulReceiveNext );
+                ( void ) ulTCPWindowTxAck( &xTestWindow, ulReceiveNext );
+            }
+        }
+
+        return ulTransmissions;
+    }
+
+    static void prvCongestionTest( const TCPCongestionOps_t * pxOps )
+    {
+        bool xDrop[ testCC_SEGMENTS ] = { false };
+        int32_t lPosition;
+        uint32_t ulIndex;
+
+        /* A single loss, followed by two losses in the same window. */
+        xDrop[ 20 ] = true;
+        xDrop[ 40 ] = true;
+        xDrop[ 41 ] = true;
+
+        prvCreateTestWindow( pxOps );
+        TEST_ASSERT_EQUAL( testCC_SEGMENTS + 3, prvLossyTransfer( xDrop ) );
+
+        /* Both windows with losses were repaired by a fast retransmission.
+         * The second lost segment was retransmitted after a partial ACK. */
+        TEST_ASSERT_EQUAL( 2, xTestWindow.xCongestion.ulFastRetransmits );
+        TEST_ASSERT_EQUAL( 0, xTestWindow.xCongestion.ulTimeouts );
+        TEST_ASSERT_EQUAL( 0, xTestWindow.xCongestion.ucInRecovery );
+        TEST_ASSERT_TRUE( xTestWindow.xCongestion.ulSSThresh >= 2 * testCC_MSS );
+        TEST_ASSERT_TRUE( xTestWindow.xCongestion.ulSSThresh < testCC_SEGMENTS * testCC_MSS );
+        TEST_ASSERT_TRUE( listLIST_IS_EMPTY( &( xTestWindow.xTxSegments ) ) );
+        vTCPWindowDestroy( &xTestWindow );
+
+        /* A complete window gets lost: only the retransmission timer helps,
+         * and the congestion window shrinks to a single segment. */
+        prvCreateTestWindow( pxOps );
+
+        for( ulIndex = 0; ulIndex < ipconfigTCP_INITIAL_CWND_SEGMENTS; ulIndex++ )
+        {
+            TEST_ASSERT_EQUAL( testCC_MSS, ulTCPWindowTxGet( &xTestWindow, testCC_SEGMENTS * testCC_MSS, &lPosition ) );
+        }
+
+        TEST_ASSERT_EQUAL( 0, ulTCPWindowTxGet( &xTestWindow, testCC_SEGMENTS * testCC_MSS, &lPosition ) );
+
+        xTestWindow.lRTO = 100;
+        vTaskDelay( pdMS_TO_TICKS( 150 ) );
+
+        TEST_ASSERT_EQUAL( testCC_MSS, ulTCPWindowTxGet( &xTestWindow, testCC_SEGMENTS * testCC_MSS, &lPosition ) );
+        TEST_ASSERT_EQUAL( 0, lPosition );
+        TEST_ASSERT_EQUAL( 1, xTestWindow.xCongestion.ulTimeouts );
+        TEST_ASSERT_EQUAL( testCC_MSS, xTestWindow.xCongestion.ulCWnd );
+        TEST_ASSERT_TRUE( xTestWindow.xCongestion.ulSSThresh >= 2 * testCC_MSS );
+        TEST_ASSERT_TRUE( xTestWindow.xCongestion.ulSSThresh < ipconfigTCP_INITIAL_CWND_SEGMENTS * testCC_MSS );
+        vTCPWindowDestroy( &xTestWindow );
+    }
+
+    TEST( Full_FREERTOS_TCP, CongestionNewReno )
+    {
+        prvCongestionTest( &xTCPCongestionNewReno );
+    }
+
+    TEST( Full_FREERTOS_TCP, CongestionCubic )
+    {
+        prvCongestionTest( &xTCPCongestionCubic );
+    }
+
+#endif /* if ( ipconfigUSE_TCP_CONGESTION_CONTROL != 0 ) */
+
+#if ( ipconfigUSE_DRIVER_OFFLOADS != 0 ) && ( ipconfigUSE_TCP_WIN == 1 )
+
+/* ulTCPWindowTxGetNext() lets the sender combine consecutive segments of its
+ * window into one frame, which the driver cuts at the same boundaries. */
+    #define testTSO_MSS         ( 1000UL )
+    #define testTSO_SEGMENTS    ( 8UL )
+
+    TEST( Full_FREERTOS_TCP, SegmentationOffload )
+    {
+        TCPWindow_t xWindow;
+        int32_t lPosition = 0;
+        uint32_t ulIndex;
+
+        memset( &xWindow, 0, sizeof( xWindow ) );
+        vTCPWindowCreate( &xWindow, testTSO_SEGMENTS * testTSO_MSS, testTSO_SEGMENTS * testTSO_MSS, 1000, 1000, testTSO_MSS );
+
+        for( ulIndex = 0; ulIndex < testTSO_SEGMENTS; ulIndex++ )
+        {
+            TEST_ASSERT_EQUAL( testTSO_MSS, lTCPWindowTxAdd( &xWindow, testTSO_MSS, lPosition, testTSO_SEGMENTS * testTSO_MSS ) );
+            lPosition += testTSO_MSS;
+        }
+
+        TEST_ASSERT_EQUAL( testTSO_MSS, ulTCPWindowTxGet( &xWindow, testTSO_SEGMENTS * testTSO_MSS, &lPosition ) );
+        TEST_ASSERT_EQUAL( 0, lPosition );
+
+        /* Only whole segments that follow the fetched data are combined. */
+        TEST_ASSERT_EQUAL( 0, ulTCPWindowTxGetNext( &xWindow, testTSO_SEGMENTS * testTSO_MSS, testTSO_MSS - 1, testTSO_MSS ) );
+        TEST_ASSERT_EQUAL( 0, ulTCPWindowTxGetNext( &xWindow, testTSO_SEGMENTS * testTSO_MSS, 0, testTSO_MSS ) );
+
+        /* The frame may not get longer than the driver accepts. */
+        TEST_ASSERT_EQUAL( testTSO_MSS, ulTCPWindowTxGetNext( &xWindow, testTSO_SEGMENTS * testTSO_MSS, testTSO_MSS, 2 * testTSO_MSS ) );
+        TEST_ASSERT_EQUAL( testTSO_MSS, ulTCPWindowTxGetNext( &xWindow, testTSO_SEGMENTS * testTSO_MSS, 2 * testTSO_MSS, testTSO_MSS ) );
+        TEST_ASSERT_EQUAL( 0, ulTCPWindowTxGetNext( &xWindow, testTSO_SEGMENTS * testTSO_MSS, 3 * testTSO_MSS, 0 ) );
+
+        /* The combined segments are outstanding, like those of ulTCPWindowTxGet(). */
+        TEST_ASSERT_EQUAL( 3 * testTSO_MSS, xWindow.tx.ulHighestSequenceNumber - xWindow.tx.ulCurrentSequenceNumber );
+        TEST_ASSERT_EQUAL( 3 * testTSO_MSS, ulTCPWindowTxAck( &xWindow, xWindow.tx.ulCurrentSequenceNumber + 3 * testTSO_MSS ) );
+        vTCPWindowDestroy( &xWindow );
+    }
+
+#endif /* if ( ipconfigUSE_DRIVER_OFFLOADS != 0 ) && ( ipconfigUSE_TCP_WIN == 1 ) */
+
+#if ( ipconfigUSE_IP_REASSEMBLY != 0 )
+
+/* pxIPReassemble() builds a datagram from fragments that arrive in any order,
+ * and keeps the data that arrived first when fragments overlap. */
+    #define testREASSEMBLY_LENGTH    ( 1000U )
+    #define testREASSEMBLY_HEADERS   ( ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER )
+
+    static uint8_t ucDatagram[ testREASSEMBLY_HEADERS + testREASSEMBLY_LENGTH ];
+
+    static NetworkBufferDescriptor_t * prvReassembleFragment( size_t uxOffset,
+                                                              size_t uxLength,
+                                                              BaseType_t xMoreFragments,
+                                                              BaseType_t xCorrupt )
+    {
+        NetworkBufferDescriptor_t * pxFragment;
+        NetworkBufferDescriptor_t * pxReturn;
+        IPHeader_t * pxIPHeader;
+        uint16_t usFlags = ( uint16_t ) ( uxOffset / 8U );
+
+        pxFragment = pxGetNetworkBufferWithDescriptor( testREASSEMBLY_HEADERS + uxLength, 0 );
+        TEST_ASSERT_NOT_NULL( pxFragment );
+
+        memcpy( pxFragment->pucEthernetBuffer, ucDatagram, testREASSEMBLY_HEADERS );
+        memcpy( &( pxFragment->pucEthernetBuffer[ testREASSEMBLY_HEADERS ] ), &( ucDatagram[ testREASSEMBLY_HEADERS + uxOffset ] ), uxLength );
+
+        if( xCorrupt != pdFALSE )
+        {
+            memset( &( pxFragment->pucEthernetBuffer[ testREASSEMBLY_HEADERS ] ), 0xA5, uxLength );
+        }
+
+        if( xMoreFragments != pdFALSE )
+        {
+            usFlags |= 0x2000U;
+        }
+
+        pxIPHeader = &( ( ( IPPacket_t * ) pxFragment->pucEthernetBuffer )->xIPHeader );
+        pxIPHeader->usLength = FreeRTOS_htons( ( uint16_t ) ( ipSIZE_OF_IPv4_HEADER + uxLength ) );
+        pxIPHeader->usFragmentOffset = FreeRTOS_htons( usFlags );
+
+        pxReturn = pxIPReassemble( pxFragment, ipSIZE_OF_IPv4_HEADER );
+        vReleaseNetworkBufferAndDescriptor( pxFragment );
+
+        return pxReturn;
+    }
+
+    TEST( Full_FREERTOS_TCP, Reassembly )
+    {
+        UDPPacket_t * pxUDPPacket = ( UDPPacket_t * ) ucDatagram;
+        NetworkBufferDescriptor_t * pxDatagram;
+        uint32_t ulIndex;
+
+        /* A UDP datagram with a valid checksum. */
+        memset( ucDatagram, 0, sizeof( ucDatagram ) );
+        pxUDPPacket->xIPHeader.ucVersionHeaderLength = 0x45U;
+        pxUDPPacket->xIPHeader.usLength = FreeRTOS_htons( ipSIZE_OF_IPv4_HEADER + testREASSEMBLY_LENGTH );
+        pxUDPPacket->xIPHeader.usIdentification = FreeRTOS_htons( 0x1234U );
+        pxUDPPacket->xIPHeader.ucTimeToLive = 64U;
+        pxUDPPacket->xIPHeader.ucProtocol = ipPROTOCOL_UDP;
+        pxUDPPacket->xIPHeader.ulSourceIPAddress = FreeRTOS_inet_addr_quick( 192, 168, 1, 2 );
+        pxUDPPacket->xIPHeader.ulDestinationIPAddress = FreeRTOS_inet_addr_quick( 192, 168, 1, 3 );
+        pxUDPPacket->xUDPHeader.usSourcePort = FreeRTOS_htons( 53U );
+        pxUDPPacket->xUDPHeader.usDestinationPort = FreeRTOS_htons( 5353U );
+        pxUDPPacket->xUDPHeader.usLength = FreeRTOS_htons( testREASSEMBLY_LENGTH );
+
+        for( ulIndex = sizeof( UDPPacket_t ); ulIndex < sizeof( ucDatagram ); ulIndex++ )
+        {
+            ucDatagram[ ulIndex ] = ( uint8_t ) ( ulIndex * 7U );
+        }
+
+        ( void ) usGenerateProtocolChecksum( ucDatagram, sizeof( ucDatagram ), pdTRUE );
+
+        /* The middle, a corrupted fragment that overlaps it, and the last
+         * fragment, which overlaps the middle one too. */
+        TEST_ASSERT_NULL( prvReassembleFragment( 400U, 400U, pdTRUE, pdFALSE ) );
+        TEST_ASSERT_NULL( prvReassembleFragment( 408U, 384U, pdTRUE, pdTRUE ) );
+        TEST_ASSERT_NULL( prvReassembleFragment( 784U, 216U, pdFALSE, pdFALSE ) );
+
+        /* The first fragment completes the datagram. */
+        pxDatagram = prvReassembleFragment( 0U, 400U, pdTRUE, pdFALSE );
+        TEST_ASSERT_NOT_NULL( pxDatagram );
+        TEST_ASSERT_EQUAL( sizeof( ucDatagram ), pxDatagram->xDataLength );
+        TEST_ASSERT_EQUAL( 0U, ( ( IPPacket_t * ) pxDatagram->pucEthernetBuffer )->xIPHeader.usFragmentOffset );
+
+        /* The corrupted fragment did not overwrite any data. */
+        TEST_ASSERT_EQUAL_MEMORY( &( ucDatagram[ testREASSEMBLY_HEADERS ] ), &( pxDatagram->pucEthernetBuffer[ testREASSEMBLY_HEADERS ] ), testREASSEMBLY_LENGTH );
+        TEST_ASSERT_EQUAL_HEX16( 0xFFFFU, usGenerateProtocolChecksum( pxDatagram->pucEthernetBuffer, pxDatagram->xDataLength, pdFALSE ) );
+        vReleaseNetworkBufferAndDescriptor( pxDatagram );
+    }
+
+#endif /* if ( ipconfigUSE_IP_REASSEMBLY != 0 ) */
+
+#if ( ipconfigUSE_IPv6 != 0 )
+
+/* FreeRTOS_inet_ntop6() writes the shortest form of RFC 5952, which
+ * FreeRTOS_inet_pton6() reads back, and malformed addresses are rejected. */
+    TEST( Full_FREERTOS_TCP, IPv6AddressText )
+    {
+        static const char * const pcAddresses[] =
+        {
+            "::",
+            "::1",
+            "fe80::211:22ff:fe33:4455",
+            "2001:db8::1:0:0:1",
+            "2001:db8:0:1:1:1:1:1",
+            "ff02::1:ff00:1"
+        };
+        static const char * const pcMalformed[] =
+        {
+            ":::",
+            "1::2::3",
+            "1:2:3:4:5:6:7",
+            "1:2:3:4:5:6:7:8:9",
+            "12345::",
+            "::ffff:192.168.1.1"
+        };
+        IPv6_Address_t xAddress;
+        char cBuffer[ 40 ];
+        size_t uxIndex;
+
+        for( uxIndex = 0; uxIndex < sizeof( pcAddresses ) / sizeof( pcAddresses[ 0 ] ); uxIndex++ )
+        {
+            TEST_ASSERT_EQUAL( pdPASS, FreeRTOS_inet_pton6( pcAddresses[ uxIndex ], &xAddress ) );
+            TEST_ASSERT_NOT_NULL( FreeRTOS_inet_ntop6( &xAddress, cBuffer, sizeof( cBuffer ) ) );
+            TEST_ASSERT_EQUAL_STRING( pcAddresses[ uxIndex ], cBuffer );
+        }
+
+        for( uxIndex = 0; uxIndex < sizeof( pcMalformed ) / sizeof( pcMalformed[ 0 ] ); uxIndex++ )
+        {
+            TEST_ASSERT_EQUAL( pdFAIL, FreeRTOS_inet_pton6( pcMalformed[ uxIndex ], &xAddress ) );
+        }
+
+        /* Upper case and leading zeros are accepted, but not written. */
+        TEST_ASSERT_EQUAL( pdPASS, FreeRTOS_inet_pton6( "2001:0DB8:0:0:0:0:0:0001", &xAddress ) );
+        TEST_ASSERT_EQUAL_STRING( "2001:db8::1", FreeRTOS_inet_ntop6( &xAddress, cBuffer, sizeof( cBuffer ) ) );
+
+        /* The buffer must be able to hold the longest address. */
+        TEST_ASSERT_NULL( FreeRTOS_inet_ntop6( &xAddress, cBuffer, sizeof( cBuffer ) - 1U ) );
+    }
+
+/* The frames below come from a neighbour with this MAC address. */
+    static const MACAddress_t xNeighbourMAC = { { 0x02, 0x00, 0x00, 0x00, 0x00, 0x02 } };
+
+    static void prvIPv6Address( IPv6_Address_t * pxAddress,
+                                const char * pcText )
+    {
+        TEST_ASSERT_EQUAL( pdPASS, FreeRTOS_inet_pton6( pcText, pxAddress ) );
+    }
+
+/* The sum of the pseudo header and the protocol data of an IPv6 frame, which
+ * is 0xffff when the checksum in the protocol header is correct. */
+    static uint16_t prvIPv6ProtocolSum( const NetworkBufferDescriptor_t * pxNetworkBuffer )
+    {
+        const IPv6Packet_t * pxPacket = ( const IPv6Packet_t * ) pxNetworkBuffer->pucEthernetBuffer;
+        size_t uxLength = ( size_t ) FreeRTOS_ntohs( pxPacket->xIPHeader.usPayloadLength );
+        uint32_t ulSum;
+
+        ulSum = ( uint32_t ) uxLength + ( uint32_t ) pxPacket->xIPHeader.ucNextHeader;
+        ulSum = ( ulSum & 0xffffUL ) + ( ulSum >> 16 );
+
+        return usGenerateChecksum( ulSum, pxPacket->xIPHeader.xSourceAddress.ucBytes, 2u * sizeof( IPv6_Address_t ) + uxLength );
+    }
+
+/* Builds a received frame from the neighbour that holds an ICMPv6 or UDP
+ * message, of which the checksum is filled in. */
+    static NetworkBufferDescriptor_t * prvIPv6Frame( const IPv6_Address_t * pxSource,
+                                                     const IPv6_Address_t * pxDestination,
+                                                     uint8_t ucNextHeader,
+                                                     const uint8_t * pucMessage,
+                                                     size_t uxMessageLength )
+    {
+        NetworkBufferDescriptor_t * pxNetworkBuffer;
+        IPv6Packet_t * pxPacket;
+        uint8_t * pucChecksum;
+        uint16_t usChecksum;
+
+        pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( sizeof( IPv6Packet_t ) + uxMessageLength, 0u );
+        TEST_ASSERT_NOT_NULL( pxNetworkBuffer );
+        pxPacket = ( IPv6Packet_t * ) pxNetworkBuffer->pucEthernetBuffer;
+
+        memset( pxPacket, 0, sizeof( *pxPacket ) );
+        memcpy( pxPacket->xEthernetHeader.xSourceAddress.ucBytes, xNeighbourMAC.ucBytes, sizeof( xNeighbourMAC.ucBytes ) );
+        memcpy( pxPacket->xEthernetHeader.xDestinationAddress.ucBytes, FreeRTOS_GetMACAddress(), sizeof( MACAddress_t ) );
+        pxPacket->xEthernetHeader.usFrameType = ipIPv6_FRAME_TYPE;
+        pxPacket->xIPHeader.ucVersionTrafficClass = 0x60u;
+        pxPacket->xIPHeader.usPayloadLength = FreeRTOS_htons( ( uint16_t ) uxMessageLength );
+        pxPacket->xIPHeader.ucNextHeader = ucNextHeader;
+        pxPacket->xIPHeader.ucHopLimit = 255u;
+        memcpy( pxPacket->xIPHeader.xSourceAddress.ucBytes, pxSource->ucBytes, sizeof( IPv6_Address_t ) );
+        memcpy( pxPacket->xIPHeader.xDestinationAddress.ucBytes, pxDestination->ucBytes, sizeof( IPv6_Address_t ) );
+        memcpy( &( pxNetworkBuffer->pucEthernetBuffer[ sizeof( IPv6Packet_t ) ] ), pucMessage, uxMessageLength );
+
+        /* The checksum is at offset 2 of an ICMPv6 header, and at offset 6 of
+         * a UDP header. */
+        pucChecksum = &( pxNetworkBuffer->pucEthernetBuffer[ sizeof( IPv6Packet_t ) + ( ( ucNextHeader == ( uint8_t ) ipPROTOCOL_UDP ) ? 6u : 2u ) ] );
+        pucChecksum[ 0 ] = 0u;
+        pucChecksum[ 1 ] = 0u;
+        usChecksum = ( uint16_t ) ~prvIPv6ProtocolSum( pxNetworkBuffer );
+        pucChecksum[ 0 ] = ( uint8_t ) ( usChecksum >> 8 );
+        pucChecksum[ 1 ] = ( uint8_t ) ( usChecksum & 0xffu );
+
+        #if ( ipconfigUSE_MULTI_INTERFACE != 0 )
+            pxNetworkBuffer->pxEndPoint = FreeRTOS_FirstEndPoint();
+        #endif
+
+        return pxNetworkBuffer;
+    }
+
+/* Passes a frame to the IPv6 layer, as the IP-task would. */
+    static eFrameProcessingResult_t prvIPv6Receive( NetworkBufferDescriptor_t * pxNetworkBuffer )
+    {
+        eFrameProcessingResult_t eResult = eIPv6ProcessPacket( pxNetworkBuffer );
+
+        if( eResult != eFrameConsumed )
+        {
+            vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+        }
+
+        return eResult;
+    }
+
+/* Writes a neighbour solicitation or advertisement for pxTarget, with a
+ * link-layer address option of type ucOption, unless it is zero.  Returns the
+ * length of the message. */
+    static size_t prvNDMessage( uint8_t * pucMessage,
+                                uint8_t ucType,
+                                const IPv6_Address_t * pxTarget,
+                                uint8_t ucOption )
+    {
+        size_t uxLength = 24u;
+
+        memset( pucMessage, 0, 32u );
+        pucMessage[ 0 ] = ucType;
+        memcpy( &( pucMessage[ 8 ] ), pxTarget->ucBytes, sizeof( IPv6_Address_t ) );
+
+        if( ucOption != 0u )
+        {
+            pucMessage[ 24 ] = ucOption;
+            pucMessage[ 25 ] = 1u;
+            memcpy( &( pucMessage[ 26 ] ), xNeighbourMAC.ucBytes, sizeof( xNeighbourMAC.ucBytes ) );
+            uxLength = 32u;
+        }
+
+        return uxLength;
+    }
+
+/* Restarts IPv6 and waits for duplicate address detection of the link-local
+ * address, which takes two calls of vIPv6CheckTimers(). */
+    static void prvIPv6Start( IPv6_Address_t * pxLinkLocal )
+    {
+        vIPv6NetworkUp();
+        vIPv6CheckTimers();
+        vIPv6CheckTimers();
+        TEST_ASSERT_EQUAL( pdPASS, FreeRTOS_GetIPv6Address( eIPv6LinkLocal, pxLinkLocal ) );
+    }
+
+/* The link-local address is formed from the MAC address, a router
+ * advertisement adds a global address, and both are tentative until duplicate
+ * address detection has passed. */
+    TEST( Full_FREERTOS_TCP, IPv6SLAAC )
+    {
+        static const uint8_t ucPrefix[ 8 ] = { 0x20, 0x01, 0x0d, 0xb8, 0x00, 0x01, 0x00, 0x02 };
+        const uint8_t * pucMAC = FreeRTOS_GetMACAddress();
+        uint8_t ucAdvertisement[ 16 + 32 ];
+        uint8_t * pucOption = &( ucAdvertisement[ 16 ] );
+        IPv6_Address_t xLinkLocal, xGlobal, xRouter, xAllNodes;
+        NetworkBufferDescriptor_t * pxNetworkBuffer;
+
+        vIPv6NetworkUp();
+        TEST_ASSERT_EQUAL( 1, TEST_FreeRTOS_IPv6_GetAddressState( eIPv6LinkLocal, &xLinkLocal ) );
+        TEST_ASSERT_EQUAL( pdFAIL, FreeRTOS_GetIPv6Address( eIPv6LinkLocal, &xLinkLocal ) );
+
+        /* fe80::/64 and the modified EUI-64 of the MAC address. */
+        TEST_ASSERT_EQUAL_HEX8( 0xfe, xLinkLocal.ucBytes[ 0 ] );
+        TEST_ASSERT_EQUAL_HEX8( 0x80, xLinkLocal.ucBytes[ 1 ] );
+        TEST_ASSERT_EQUAL_HEX8( pucMAC[ 0 ] ^ 0x02u, xLinkLocal.ucBytes[ 8 ] );
+        TEST_ASSERT_EQUAL_MEMORY( &( pucMAC[ 1 ] ), &( xLinkLocal.ucBytes[ 9 ] ), 2u );
+        TEST_ASSERT_EQUAL_HEX8( 0xff, xLinkLocal.ucBytes[ 11 ] );
+        TEST_ASSERT_EQUAL_HEX8( 0xfe, xLinkLocal.ucBytes[ 12 ] );
+        TEST_ASSERT_EQUAL_MEMORY( &( pucMAC[ 3 ] ), &( xLinkLocal.ucBytes[ 13 ] ), 3u );
+
+        vIPv6CheckTimers();
+        vIPv6CheckTimers();
+        TEST_ASSERT_EQUAL( pdPASS, FreeRTOS_GetIPv6Address( eIPv6LinkLocal, &xLinkLocal ) );
+        TEST_ASSERT_EQUAL( 0, TEST_FreeRTOS_IPv6_GetAddressState( eIPv6Global, &xGlobal ) );
+
+        /* A router advertisement with a router lifetime of 1800 seconds and a
+         * prefix information option for 2001:db8:1:2::/64, autonomous, valid
+         * for 3600 and preferred for 1800 seconds. */
+        memset( ucAdvertisement, 0, sizeof( ucAdvertisement ) );
+        ucAdvertisement[ 0 ] = 134u;
+        ucAdvertisement[ 4 ] = 64u;
+        ucAdvertisement[ 6 ] = 0x07u;
+        ucAdvertisement[ 7 ] = 0x08u;
+        pucOption[ 0 ] = 3u;
+        pucOption[ 1 ] = 4u;
+        pucOption[ 2 ] = 64u;
+        pucOption[ 3 ] = 0x40u;
+        pucOption[ 6 ] = 0x0eu;
+        pucOption[ 7 ] = 0x10u;
+        pucOption[ 10 ] = 0x07u;
+        pucOption[ 11 ] = 0x08u;
+        memcpy( &( pucOption[ 16 ] ), ucPrefix, sizeof( ucPrefix ) );
+        prvIPv6Address( &xRouter, "fe80::1" );
+        prvIPv6Address( &xAllNodes, "ff02::1" );
+
+        /* An advertisement that may have passed a router is ignored. */
+        pxNetworkBuffer = prvIPv6Frame( &xRouter, &xAllNodes, ( uint8_t ) ipPROTOCOL_ICMP_IPv6, ucAdvertisement, sizeof( ucAdvertisement ) );
+        ( ( IPv6Packet_t * ) pxNetworkBuffer->pucEthernetBuffer )->xIPHeader.ucHopLimit = 64u;
+        ( void ) prvIPv6Receive( pxNetworkBuffer );
+        TEST_ASSERT_EQUAL( 0, TEST_FreeRTOS_IPv6_GetAddressState( eIPv6Global, &xGlobal ) );
+
+        ( void ) prvIPv6Receive( prvIPv6Frame( &xRouter, &xAllNodes, ( uint8_t ) ipPROTOCOL_ICMP_IPv6, ucAdvertisement, sizeof( ucAdvertisement ) ) );
+        TEST_ASSERT_EQUAL( 1, TEST_FreeRTOS_IPv6_GetAddressState( eIPv6Global, &xGlobal ) );
+        TEST_ASSERT_EQUAL_MEMORY( ucPrefix, xGlobal.ucBytes, sizeof( ucPrefix ) );
+        TEST_ASSERT_EQUAL_MEMORY( &( xLinkLocal.ucBytes[ 8 ] ), &( xGlobal.ucBytes[ 8 ] ), 8u );
+        TEST_ASSERT_EQUAL( pdFAIL, FreeRTOS_GetIPv6Address( eIPv6Global, &xGlobal ) );
+
+        vIPv6CheckTimers();
+        vIPv6CheckTimers();
+        TEST_ASSERT_EQUAL( pdPASS, FreeRTOS_GetIPv6Address( eIPv6Global, &xGlobal ) );
+        TEST_ASSERT_EQUAL_MEMORY( ucPrefix, xGlobal.ucBytes, sizeof( ucPrefix ) );
+    }
+
+/* Neighbour solicitations and advertisements fill the neighbour cache, a
+ * packet waits for the advertisement of its destination, and a node that
+ * probes for a tentative address makes it a duplicate. */
+    TEST( Full_FREERTOS_TCP, IPv6NeighbourDiscovery )
+    {
+        uint8_t ucMessage[ 32 ];
+        size_t uxLength;
+        IPv6_Address_t xLinkLocal, xNeighbour, xOther, xSolicitedNode, xUnspecified;
+        MACAddress_t xMAC;
+        NetworkBufferDescriptor_t * pxNetworkBuffer;
+
+        prvIPv6Start( &xLinkLocal );
+        prvIPv6Address( &xNeighbour, "fe80::2" );
+        prvIPv6Address( &xSolicitedNode, "ff02::1:ff00:0" );
+        memcpy( &( xSolicitedNode.ucBytes[ 13 ] ), &( xLinkLocal.ucBytes[ 13 ] ), 3u );
+
+        /* A solicitation tells the MAC address of the neighbour that sent it. */
+        uxLength = prvNDMessage( ucMessage, 135u, &xLinkLocal, 1u );
+        ( void ) prvIPv6Receive( prvIPv6Frame( &xNeighbour, &xSolicitedNode, ( uint8_t ) ipPROTOCOL_ICMP_IPv6, ucMessage, uxLength ) );
+        TEST_ASSERT_EQUAL( pdTRUE, TEST_FreeRTOS_IPv6_NDLookup( &xNeighbour, &xMAC ) );
+        TEST_ASSERT_EQUAL_MEMORY( xNeighbourMAC.ucBytes, xMAC.ucBytes, sizeof( xMAC.ucBytes ) );
+
+        /* A packet to an unknown neighbour waits for its advertisement. */
+        prvIPv6Address( &xOther, "fe80::3" );
+        pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( sizeof( UDPv6Packet_t ) + 4u, 0u );
+        TEST_ASSERT_NOT_NULL( pxNetworkBuffer );
+        memset( pxNetworkBuffer->pucEthernetBuffer, 0, sizeof( UDPv6Packet_t ) );
+        memcpy( pxNetworkBuffer->xIPv6Address.ucBytes, xOther.ucBytes, sizeof( xOther.ucBytes ) );
+        pxNetworkBuffer->usPort = FreeRTOS_htons( 7u );
+        pxNetworkBuffer->usBoundPort = FreeRTOS_htons( 7u );
+        pxNetworkBuffer->xDataLength = 4u;
+        pxNetworkBuffer->xUsesIPv6 = pdTRUE;
+        vIPv6ProcessGeneratedUDPPacket( pxNetworkBuffer );
+        TEST_ASSERT_EQUAL( pdTRUE, TEST_FreeRTOS_IPv6_NDIsWaiting( &xOther ) );
+        TEST_ASSERT_EQUAL( pdFALSE, TEST_FreeRTOS_IPv6_NDLookup( &xOther, &xMAC ) );
+
+        /* The advertisement sends the packet. */
+        uxLength = prvNDMessage( ucMessage, 136u, &xOther, 2u );
+        ucMessage[ 4 ] = 0x60u;
+        ( void ) prvIPv6Receive( prvIPv6Frame( &xOther, &xLinkLocal, ( uint8_t ) ipPROTOCOL_ICMP_IPv6, ucMessage, uxLength ) );
+        TEST_ASSERT_EQUAL( pdTRUE, TEST_FreeRTOS_IPv6_NDLookup( &xOther, &xMAC ) );
+        TEST_ASSERT_EQUAL( pdFALSE, TEST_FreeRTOS_IPv6_NDIsWaiting( &xOther ) );
+
+        /* An advertisement that was not asked for does not add an entry. */
+        prvIPv6Address( &xOther, "fe80::4" );
+        uxLength = prvNDMessage( ucMessage, 136u, &xOther, 2u );
+        ( void ) prvIPv6Receive( prvIPv6Frame( &xOther, &xLinkLocal, ( uint8_t ) ipPROTOCOL_ICMP_IPv6, ucMessage, uxLength ) );
+        TEST_ASSERT_EQUAL( pdFALSE, TEST_FreeRTOS_IPv6_NDLookup( &xOther, &xMAC ) );
+
+        /* Another node probes for the tentative address. */
+        vIPv6NetworkUp();
+        memset( &xUnspecified, 0, sizeof( xUnspecified ) );
+        uxLength = prvNDMessage( ucMessage, 135u, &xLinkLocal, 0u );
+        ( void ) prvIPv6Receive( prvIPv6Frame( &xUnspecified, &xSolicitedNode, ( uint8_t ) ipPROTOCOL_ICMP_IPv6, ucMessage, uxLength ) );
+        TEST_ASSERT_EQUAL( 3, TEST_FreeRTOS_IPv6_GetAddressState( eIPv6LinkLocal, &xOther ) );
+
+        /* Leave a usable address for the other tests. */
+        prvIPv6Start( &xLinkLocal );
+    }
+
+/* An echo request is answered in the same buffer, and one with a wrong
+ * checksum is dropped. */
+    TEST( Full_FREERTOS_TCP, IPv6EchoRequest )
+    {
+        uint8_t ucRequest[ 8 + 16 ];
+        IPv6_Address_t xLinkLocal, xNeighbour;
+        NetworkBufferDescriptor_t * pxNetworkBuffer;
+        size_t uxIndex;
+
+        prvIPv6Start( &xLinkLocal );
+        prvIPv6Address( &xNeighbour, "fe80::2" );
+
+        /* Type 128, identifier 0x1234, sequence number 1 and some data. */
+        memset( ucRequest, 0, sizeof( ucRequest ) );
+        ucRequest[ 0 ] = 128u;
+        ucRequest[ 4 ] = 0x12u;
+        ucRequest[ 5 ] = 0x34u;
+        ucRequest[ 7 ] = 0x01u;
+
+        for( uxIndex = 8u; uxIndex < sizeof( ucRequest ); uxIndex++ )
+        {
+            ucRequest[ uxIndex ] = ( uint8_t ) uxIndex;
+        }
+
+        pxNetworkBuffer = prvIPv6Frame( &xNeighbour, &xLinkLocal, ( uint8_t ) ipPROTOCOL_ICMP_IPv6, ucRequest, sizeof( ucRequest ) );
+
+        #if ( ipconfigREPLY_TO_INCOMING_PINGS == 1 )
+            {
+                ICMPv6Packet_t * pxPacket = ( ICMPv6Packet_t * ) pxNetworkBuffer->pucEthernetBuffer;
+
+                TEST_ASSERT_EQUAL( eReturnEthernetFrame, eIPv6ProcessPacket( pxNetworkBuffer ) );
+                TEST_ASSERT_EQUAL( 129, pxPacket->xICMPHeader.ucTypeOfMessage );
+                TEST_ASSERT_EQUAL_MEMORY( xLinkLocal.ucBytes, pxPacket->xIPHeader.xSourceAddress.ucBytes, sizeof( IPv6_Address_t ) );
+                TEST_ASSERT_EQUAL_MEMORY( xNeighbour.ucBytes, pxPacket->xIPHeader.xDestinationAddress.ucBytes, sizeof( IPv6_Address_t ) );
+                TEST_ASSERT_EQUAL_MEMORY( &( ucRequest[ 4 ] ), pxPacket->xICMPHeader.ucMessageBody, sizeof( ucRequest ) - 4u );
+                TEST_ASSERT_EQUAL( sizeof( IPv6Packet_t ) + sizeof( ucRequest ), pxNetworkBuffer->xDataLength );
+                TEST_ASSERT_EQUAL_HEX16( 0xffffu, prvIPv6ProtocolSum( pxNetworkBuffer ) );
+            }
+        #else
+            TEST_ASSERT_EQUAL( eReleaseBuffer, eIPv6ProcessPacket( pxNetworkBuffer ) );
+        #endif /* if ( ipconfigREPLY_TO_INCOMING_PINGS == 1 ) */
+        vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+
+        pxNetworkBuffer = prvIPv6Frame( &xNeighbour, &xLinkLocal, ( uint8_t ) ipPROTOCOL_ICMP_IPv6, ucRequest, sizeof( ucRequest ) );
+        pxNetworkBuffer->pucEthernetBuffer[ sizeof( IPv6Packet_t ) + 8u ] ^= 0x01u;
+        TEST_ASSERT_EQUAL( eReleaseBuffer, eIPv6ProcessPacket( pxNetworkBuffer ) );
+        vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+    }
+
+/* One UDP socket receives from an IPv6 and an IPv4 peer, and the address
+ * structure that is passed to FreeRTOS_sendto() selects the protocol. */
+    TEST( Full_FREERTOS_TCP, IPv6DualStackUDP )
+    {
+        static uint8_t ucLong[ ipMAX_UDP_PAYLOAD_LENGTH ];
+        Socket_t xSocket;
+        FreeRTOS_Socket_t * pxSocket;
+        NetworkBufferDescriptor_t * pxNetworkBuffer;
+        struct freertos_sockaddr xAddress;
+        struct freertos_sockaddr6 xAddress6;
+        socklen_t xAddressLength;
+        IPv6_Address_t xLinkLocal, xNeighbour;
+        MACAddress_t xMAC;
+        uint8_t ucDatagram[ 8 + 4 ];
+        uint8_t ucBuffer[ 8 ];
+        TickType_t xNoTimeOut = 0;
+
+        prvIPv6Start( &xLinkLocal );
+        prvIPv6Address( &xNeighbour, "fe80::2" );
+
+        xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+        TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, xSocket );
+        ( void ) FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, &xNoTimeOut, sizeof( xNoTimeOut ) );
+        ( void ) FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_SNDTIMEO, &xNoTimeOut, sizeof( xNoTimeOut ) );
+        memset( &xAddress, 0, sizeof( xAddress ) );
+        xAddress.sin_port = FreeRTOS_htons( 50125u );
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_bind( xSocket, &xAddress, sizeof( xAddress ) ) );
+        pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+
+        /* "ping" from port 7000 of the neighbour. */
+        memset( ucDatagram, 0, sizeof( ucDatagram ) );
+        ucDatagram[ 0 ] = 0x1bu;
+        ucDatagram[ 1 ] = 0x58u;
+        ucDatagram[ 2 ] = 0xc3u;
+        ucDatagram[ 3 ] = 0xcdu;
+        ucDatagram[ 5 ] = ( uint8_t ) sizeof( ucDatagram );
+        memcpy( &( ucDatagram[ 8 ] ), "ping", 4u );
+        TEST_ASSERT_EQUAL( eFrameConsumed, prvIPv6Receive( prvIPv6Frame( &xNeighbour, &xLinkLocal, ( uint8_t ) ipPROTOCOL_UDP, ucDatagram, sizeof( ucDatagram ) ) ) );
+
+        xAddressLength = sizeof( xAddress6 );
+        TEST_ASSERT_EQUAL( 4, FreeRTOS_recvfrom( xSocket, ucBuffer, sizeof( ucBuffer ), 0, ( struct freertos_sockaddr * ) &xAddress6, &xAddressLength ) );
+        TEST_ASSERT_EQUAL( sizeof( xAddress6 ), xAddressLength );
+        TEST_ASSERT_EQUAL( FREERTOS_AF_INET6, xAddress6.sin6_family );
+        TEST_ASSERT_EQUAL( FreeRTOS_htons( 7000u ), xAddress6.sin6_port );
+        TEST_ASSERT_EQUAL_MEMORY( xNeighbour.ucBytes, xAddress6.sin6_addr.ucBytes, sizeof( IPv6_Address_t ) );
+        TEST_ASSERT_EQUAL_MEMORY( "ping", ucBuffer, 4u );
+
+        /* The datagram taught the MAC address of the neighbour, so the reply
+         * does not wait for neighbour discovery. */
+        TEST_ASSERT_EQUAL( pdTRUE, TEST_FreeRTOS_IPv6_NDLookup( &xNeighbour, &xMAC ) );
+        TEST_ASSERT_EQUAL( 4, FreeRTOS_sendto( xSocket, "pong", 4u, 0, ( struct freertos_sockaddr * ) &xAddress6, sizeof( xAddress6 ) ) );
+
+        /* A datagram from an IPv4 peer on the same socket. */
+        pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( ipUDP_PAYLOAD_OFFSET_IPv4 + 4u, 0u );
+        TEST_ASSERT_NOT_NULL( pxNetworkBuffer );
+        pxNetworkBuffer->xDataLength = 4u;
+        pxNetworkBuffer->usPort = FreeRTOS_htons( 7001u );
+        pxNetworkBuffer->ulIPAddress = 0x0200a8c0ul;
+        pxNetworkBuffer->xUsesIPv6 = pdFALSE;
+        memcpy( &( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] ), "ipv4", 4u );
+        vTaskSuspendAll();
+        vListInsertEnd( &( pxSocket->u.xUDP.xWaitingPacketsList ), &( pxNetworkBuffer->xBufferListItem ) );
+        ( void ) xTaskResumeAll();
+
+        xAddressLength = sizeof( xAddress );
+        TEST_ASSERT_EQUAL( 4, FreeRTOS_recvfrom( xSocket, ucBuffer, sizeof( ucBuffer ), 0, &xAddress, &xAddressLength ) );
+        TEST_ASSERT_EQUAL( FreeRTOS_htons( 7001u ), xAddress.sin_port );
+        TEST_ASSERT_EQUAL( 0x0200a8c0ul, xAddress.sin_addr );
+        TEST_ASSERT_EQUAL_MEMORY( "ipv4", ucBuffer, 4u );
+
+        /* The longest IPv4 payload is too long for IPv6.  A structure that is
+         * too short for IPv6 is sent as IPv4, whatever its sin_family says. */
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_sendto( xSocket, ucLong, sizeof( ucLong ), 0, ( struct freertos_sockaddr * ) &xAddress6, sizeof( xAddress6 ) ) );
+        xAddress.sin_family = FREERTOS_AF_INET6;
+        TEST_ASSERT_EQUAL( ( int32_t ) sizeof( ucLong ), FreeRTOS_sendto( xSocket, ucLong, sizeof( ucLong ), 0, &xAddress, sizeof( xAddress ) ) );
+
+        FreeRTOS_closesocket( xSocket );
+    }
+
+#endif /* if ( ipconfigUSE_IPv6 != 0 ) */
+
+#if ( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 )
+
+    static uint32_t ulChainReleaseCount;
+
+    static void prvChainReleased( NetworkBufferDescriptor_t * pxNetworkBuffer )
+    {
+        ( void ) pxNetworkBuffer;
+        ulChainReleaseCount++;
+    }
+
+/* Data of the application stay in use until the last frame that carries them
+ * has been released, and a duplicate of a chained frame is contiguous. */
+    TEST( Full_FREERTOS_TCP, NetworkBufferChains )
+    {
+        static uint8_t ucData[ 100 ];
+        NetworkBufferDescriptor_t xData;
+        NetworkBufferDescriptor_t * pxHeaders;
+        NetworkBufferDescriptor_t * pxCopy;
+        size_t uxIndex;
+
+        for( uxIndex = 0; uxIndex < sizeof( ucData ); uxIndex++ )
+        {
+            ucData[ uxIndex ] = ( uint8_t ) uxIndex;
+        }
+
+        ulChainReleaseCount = 0U;
+        vNetworkBufferWrapData( &xData, ucData, sizeof( ucData ), prvChainReleased );
+
+        pxHeaders = pxGetNetworkBufferWithDescriptor( 20U, 0U );
+        TEST_ASSERT_NOT_NULL( pxHeaders );
+        memset( pxHeaders->pucEthernetBuffer, 0xEE, 20U );
+        pxHeaders->xDataLength = 20U;
+
+        /* The frame carries the last 60 bytes. */
+        vNetworkBufferChainPayload( pxHeaders, &xData, &( ucData[ 40 ] ), 60U );
+        TEST_ASSERT_EQUAL( 2U, xData.ulReferenceCount );
+
+        pxCopy = pxDuplicateNetworkBufferWithDescriptor( pxHeaders, ( BaseType_t ) pxHeaders->xDataLength );
+        TEST_ASSERT_NOT_NULL( pxCopy );
+        TEST_ASSERT_NULL( pxCopy->pxPayloadBuffer );
+        TEST_ASSERT_EQUAL( 80U, pxCopy->xDataLength );
+        TEST_ASSERT_EQUAL_HEX8( 0xEEU, pxCopy->pucEthernetBuffer[ 19 ] );
+        TEST_ASSERT_EQUAL_MEMORY( &( ucData[ 40 ] ), &( pxCopy->pucEthernetBuffer[ 20 ] ), 60U );
+        vReleaseNetworkBufferAndDescriptor( pxCopy );
+
+        /* The owner lets go first, the frame still holds the data. */
+        vReleaseNetworkBufferAndDescriptor( &xData );
+        TEST_ASSERT_EQUAL( 0U, ulChainReleaseCount );
+
+        vReleaseNetworkBufferAndDescriptor( pxHeaders );
+        TEST_ASSERT_EQUAL( 1U, ulChainReleaseCount );
+    }
+
+#endif /* if ( ipconfigUSE_NETWORK_BUFFER_CHAINS != 0 ) */
+
+#if ( ipconfigTCP_SYN_COOKIES != 0 )
+
+/* A SYN cookie opens a connection for the request that it was made for, with
+ * the MSS rounded down to a value it can encode, and for no other. */
+    TEST( Full_FREERTOS_TCP, SynCookies )
+    {
+        uint16_t usMSS = 1300u;
+        uint16_t usCheckedMSS = 0u;
+        uint32_t ulCookie;
+
+        ulCookie = TEST_FreeRTOS_TCP_prvSynCookieCreate( 0xc0a80002ul, 50000u, 80u, 123456ul, &usMSS );
+        TEST_ASSERT_EQUAL( 1200u, usMSS );
+
+        TEST_ASSERT_EQUAL( pdTRUE, TEST_FreeRTOS_TCP_prvSynCookieCheck( 0xc0a80002ul, 50000u, 80u, 123456ul, ulCookie, &usCheckedMSS ) );
+        TEST_ASSERT_EQUAL( 1200u, usCheckedMSS );
+
+        TEST_ASSERT_EQUAL( pdFALSE, TEST_FreeRTOS_TCP_prvSynCookieCheck( 0xc0a80003ul, 50000u, 80u, 123456ul, ulCookie, &usCheckedMSS ) );
+        TEST_ASSERT_EQUAL( pdFALSE, TEST_FreeRTOS_TCP_prvSynCookieCheck( 0xc0a80002ul, 50001u, 80u, 123456ul, ulCookie, &usCheckedMSS ) );
+        TEST_ASSERT_EQUAL( pdFALSE, TEST_FreeRTOS_TCP_prvSynCookieCheck( 0xc0a80002ul, 50000u, 80u, 123457ul, ulCookie, &usCheckedMSS ) );
+
+        /* The MSS bits are covered by the hash. */
+        TEST_ASSERT_EQUAL( pdFALSE, TEST_FreeRTOS_TCP_prvSynCookieCheck( 0xc0a80002ul, 50000u, 80u, 123456ul, ulCookie ^ 0x01000000ul, &usCheckedMSS ) );
+
+        /* A peer without an MSS option gets the smallest value. */
+        usMSS = 0u;
+        ( void ) TEST_FreeRTOS_TCP_prvSynCookieCreate( 0xc0a80002ul, 50000u, 80u, 123456ul, &usMSS );
+        TEST_ASSERT_EQUAL( 536u, usMSS );
+    }
+
+#endif /* if ( ipconfigTCP_SYN_COOKIES != 0 ) */
+
+#if ( ipconfigUSE_TCP_INFO != 0 ) && ( ipconfigUSE_TCP_WIN == 1 )
+
+/* The bytes in flight follow the transmissions and the ACK's, and a segment
+ * that is sent again after its time-out counts as a retransmission. */
+    TEST( Full_FREERTOS_TCP, TCPInfo )
+    {
+        static TCPWindow_t xWindow;
+        int32_t lPosition;
+
+        memset( &xWindow, 0, sizeof( xWindow ) );
+        vTCPWindowCreate( &xWindow, 4000, 4000, 1000, 10000, 1000 );
+        TEST_ASSERT_EQUAL( 0, ulTCPWindowTxInFlight( &xWindow ) );
+
+        TEST_ASSERT_EQUAL( 2000, lTCPWindowTxAdd( &xWindow, 2000, 0, 4000 ) );
+        TEST_ASSERT_EQUAL( 1000, ulTCPWindowTxGet( &xWindow, 4000, &lPosition ) );
+        TEST_ASSERT_EQUAL( 1000, ulTCPWindowTxInFlight( &xWindow ) );
+        TEST_ASSERT_EQUAL( 1000, ulTCPWindowTxGet( &xWindow, 4000, &lPosition ) );
+        TEST_ASSERT_EQUAL( 2000, ulTCPWindowTxInFlight( &xWindow ) );
+
+        TEST_ASSERT_EQUAL( 1000, ulTCPWindowTxAck( &xWindow, 11000 ) );
+        TEST_ASSERT_EQUAL( 1000, ulTCPWindowTxInFlight( &xWindow ) );
+        TEST_ASSERT_EQUAL( 0, xWindow.ulRetransmits );
+
+        /* Let the second segment time out. */
+        xWindow.lRTO = 10;
+        vTaskDelay( pdMS_TO_TICKS( 50 ) );
+        TEST_ASSERT_EQUAL( 1000, ulTCPWindowTxGet( &xWindow, 4000, &lPosition ) );
+        TEST_ASSERT_EQUAL( 1, xWindow.ulRetransmits );
+        TEST_ASSERT_EQUAL( 1000, ulTCPWindowTxInFlight( &xWindow ) );
+
+        TEST_ASSERT_EQUAL( 1000, ulTCPWindowTxAck( &xWindow, 12000 ) );
+        TEST_ASSERT_EQUAL( 0, ulTCPWindowTxInFlight( &xWindow ) );
+
+        vTCPWindowDestroy( &xWindow );
+    }
+
+#endif /* if ( ipconfigUSE_TCP_INFO != 0 ) && ( ipconfigUSE_TCP_WIN == 1 ) */
+
+#if ( ipconfigUSE_PCAP_CAPTURE != 0 )
+
+    typedef struct
+    {
+        uint8_t ucData[ 256 ];
+        size_t uxLength;
+    } CaptureOutput_t;
+
+    static BaseType_t prvCaptureToMemory( void * pvContext,
+                                          const uint8_t * pucData,
+                                          size_t uxLength )
+    {
+        CaptureOutput_t * pxOutput = ( CaptureOutput_t * ) pvContext;
+        size_t uxCopy = 0;
+
+        if( pxOutput->uxLength < sizeof( pxOutput->ucData ) )
+        {
+            uxCopy = sizeof( pxOutput->ucData ) - pxOutput->uxLength;
+            uxCopy = ( uxCopy < uxLength ) ? uxCopy : uxLength;
+            memcpy( &( pxOutput->ucData[ pxOutput->uxLength ] ), pucData, uxCopy );
+        }
+
+        /* Count all bytes, also those that didn't fit. */
+        pxOutput->uxLength += uxLength;
+
+        return pdPASS;
+    }
+
+/* A frame that passes the filter is stored as a pcapng packet block behind the
+ * section header and interface blocks, and the oldest frames are dropped when
+ * the ring is full. */
+    TEST( Full_FREERTOS_TCP, Capture )
+    {
+        static uint8_t ucFrame[ 60 ];
+        static NetworkBufferDescriptor_t xDescriptor;
+        static CaptureOutput_t xOutput;
+        CaptureFilter_t xFilter;
+        uint32_t ulWord, ulStored, ulLost;
+        UBaseType_t uxIndex;
+        const size_t uxBlockLength = 28u + 60u + 16u;
+
+        /* An IPv4 UDP frame from port 50123. */
+        memset( ucFrame, 0, sizeof( ucFrame ) );
+        ucFrame[ 12 ] = 0x08u;
+        ucFrame[ 14 ] = 0x45u;
+        ucFrame[ 23 ] = ipPROTOCOL_UDP;
+        ucFrame[ 34 ] = 0xC3u;
+        ucFrame[ 35 ] = 0xCBu;
+        memset( &xDescriptor, 0, sizeof( xDescriptor ) );
+        xDescriptor.pucEthernetBuffer = ucFrame;
+        xDescriptor.xDataLength = sizeof( ucFrame );
+
+        /* A filter that doesn't match. */
+        memset( &xFilter, 0, sizeof( xFilter ) );
+        xFilter.ucProtocol = ipPROTOCOL_TCP;
+        FreeRTOS_CaptureStart( &xFilter, 0 );
+        vCaptureFrame( &xDescriptor, pdFALSE );
+        FreeRTOS_CaptureGetCounts( &ulStored, &ulLost );
+        TEST_ASSERT_EQUAL( 0, ulStored );
+
+        /* A matching filter, with a snap length. */
+        xFilter.ucProtocol = ipPROTOCOL_UDP;
+        xFilter.usPort = FreeRTOS_htons( 50123u );
+        FreeRTOS_CaptureStart( &xFilter, 32 );
+        vCaptureFrame( &xDescriptor, pdTRUE );
+        FreeRTOS_CaptureStop();
+        FreeRTOS_CaptureGetCounts( &ulStored, &ulLost );
+        TEST_ASSERT_EQUAL( 1, ulStored );
+
+        memset( &xOutput, 0, sizeof( xOutput ) );
+        TEST_ASSERT_EQUAL( 28 + 20 + 76, FreeRTOS_CaptureExport( prvCaptureToMemory, &xOutput ) );
+        TEST_ASSERT_EQUAL( 28 + 20 + 76, xOutput.uxLength );
+
+        memcpy( &ulWord, &( xOutput.ucData[ 0 ] ), sizeof( ulWord ) );
+        TEST_ASSERT_EQUAL_HEX32( 0x0A0D0D0Aul, ulWord );
+        memcpy( &ulWord, &( xOutput.ucData[ 8 ] ), sizeof( ulWord ) );
+        TEST_ASSERT_EQUAL_HEX32( 0x1A2B3C4Dul, ulWord );
+        memcpy( &ulWord, &( xOutput.ucData[ 28 + 12 ] ), sizeof( ulWord ) );
+        TEST_ASSERT_EQUAL( 32, ulWord );
+
+        /* The packet block: type, length, captured and original length, the
+         * data, and the direction. */
+        memcpy( &ulWord, &( xOutput.ucData[ 48 ] ), sizeof( ulWord ) );
+        TEST_ASSERT_EQUAL( 6, ulWord );
+        memcpy( &ulWord, &( xOutput.ucData[ 48 + 4 ] ), sizeof( ulWord ) );
+        TEST_ASSERT_EQUAL( 76, ulWord );
+        memcpy( &ulWord, &( xOutput.ucData[ 48 + 20 ] ), sizeof( ulWord ) );
+        TEST_ASSERT_EQUAL( 32, ulWord );
+        memcpy( &ulWord, &( xOutput.ucData[ 48 + 24 ] ), sizeof( ulWord ) );
+        TEST_ASSERT_EQUAL( 60, ulWord );
+        TEST_ASSERT_EQUAL_MEMORY( ucFrame, &( xOutput.ucData[ 48 + 28 ] ), 32 );
+        memcpy( &ulWord, &( xOutput.ucData[ 48 + 28 + 32 + 4 ] ), sizeof( ulWord ) );
+        TEST_ASSERT_EQUAL( 2, ulWord );
+        memcpy( &ulWord, &( xOutput.ucData[ 48 + 72 ] ), sizeof( ulWord ) );
+        TEST_ASSERT_EQUAL( 76, ulWord );
+
+        /* Overfill the ring. */
+        FreeRTOS_CaptureStart( &xFilter, 0 );
+
+        for( uxIndex = 0; uxIndex < ( ipconfigPCAP_CAPTURE_BUFFER_SIZE / uxBlockLength ) + 5u; uxIndex++ )
+        {
+            vCaptureFrame( &xDescriptor, pdFALSE );
+        }
+
+        FreeRTOS_CaptureStop();
+        FreeRTOS_CaptureGetCounts( &ulStored, &ulLost );
+        TEST_ASSERT_EQUAL( ipconfigPCAP_CAPTURE_BUFFER_SIZE / uxBlockLength, ulStored );
+        TEST_ASSERT_EQUAL( 5, ulLost );
+
+        memset( &xOutput, 0, sizeof( xOutput ) );
+        TEST_ASSERT_EQUAL( ( BaseType_t ) ( 28 + 20 + ( ulStored * uxBlockLength ) ), FreeRTOS_CaptureExport( prvCaptureToMemory, &xOutput ) );
+
+        /* The oldest block that is left is still complete. */
+        memcpy( &ulWord, &( xOutput.ucData[ 48 ] ), sizeof( ulWord ) );
+        TEST_ASSERT_EQUAL( 6, ulWord );
+        memcpy( &ulWord, &( xOutput.ucData[ 48 + 4 ] ), sizeof( ulWord ) );
+        TEST_ASSERT_EQUAL( uxBlockLength, ulWord );
+    }
+
+#endif /* if ( ipconfigUSE_PCAP_CAPTURE != 0 ) */
+
+#if ( ipconfigUSE_UDP_BATCH != 0 )
+
+/* FreeRTOS_recvmmsg() takes the waiting datagrams in order, up to the number
+ * of messages, and FreeRTOS_sendmmsg() stops at the first datagram that can
+ * not be sent. */
+    TEST( Full_FREERTOS_TCP, UDPBatch )
+    {
+        Socket_t xSocket;
+        FreeRTOS_Socket_t * pxSocket;
+        NetworkBufferDescriptor_t * pxNetworkBuffer;
+        UDPMessage_t xMessages[ 2 ];
+        struct freertos_sockaddr xAddresses[ 2 ];
+        uint8_t ucData[ 2 ][ 8 ];
+        BaseType_t xIndex;
+        TickType_t xNoTimeOut = 0;
+
+        xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+        TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, xSocket );
+        ( void ) FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, &xNoTimeOut, sizeof( xNoTimeOut ) );
+        ( void ) FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_SNDTIMEO, &xNoTimeOut, sizeof( xNoTimeOut ) );
+        xAddresses[ 0 ].sin_port = FreeRTOS_htons( 50124u );
+        xAddresses[ 0 ].sin_addr = 0u;
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_bind( xSocket, &xAddresses[ 0 ], sizeof( xAddresses[ 0 ] ) ) );
+        pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+
+        memset( xMessages, 0, sizeof( xMessages ) );
+
+        for( xIndex = 0; xIndex < 2; xIndex++ )
+        {
+            xMessages[ xIndex ].pvBuffer = ucData[ xIndex ];
+            xMessages[ xIndex ].uxLength = sizeof( ucData[ xIndex ] );
+            xMessages[ xIndex ].pxAddress = &( xAddresses[ xIndex ] );
+            xMessages[ xIndex ].xAddressLength = sizeof( xAddresses[ xIndex ] );
+        }
+
+        TEST_ASSERT_EQUAL( -pdFREERTOS_ERRNO_EWOULDBLOCK, FreeRTOS_recvmmsg( xSocket, xMessages, 2, 0 ) );
+
+        /* Let three datagrams of 1, 2 and 3 bytes arrive. */
+        for( xIndex = 1; xIndex <= 3; xIndex++ )
+        {
+            pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( ipUDP_PAYLOAD_OFFSET_IPv4 + 8u, 0u );
+            TEST_ASSERT_NOT_NULL( pxNetworkBuffer );
+            pxNetworkBuffer->xDataLength = ( size_t ) xIndex;
+            pxNetworkBuffer->usPort = FreeRTOS_htons( ( uint16_t ) ( 1000 + xIndex ) );
+            pxNetworkBuffer->ulIPAddress = 0x0100a8c0ul;
+            memset( &( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] ), ( int ) xIndex, 8u );
+            #if ( ipconfigUSE_IPv6 != 0 )
+                pxNetworkBuffer->xUsesIPv6 = pdFALSE;
+            #endif
+            vTaskSuspendAll();
+            vListInsertEnd( &( pxSocket->u.xUDP.xWaitingPacketsList ), &( pxNetworkBuffer->xBufferListItem ) );
+            ( void ) xTaskResumeAll();
+        }
+
+        TEST_ASSERT_EQUAL( 2, FreeRTOS_recvmmsg( xSocket, xMessages, 2, 0 ) );
+        TEST_ASSERT_EQUAL( 1, xMessages[ 0 ].lResult );
+        TEST_ASSERT_EQUAL( 2, xMessages[ 1 ].lResult );
+        TEST_ASSERT_EQUAL( FreeRTOS_htons( 1001u ), xAddresses[ 0 ].sin_port );
+        TEST_ASSERT_EQUAL( FreeRTOS_htons( 1002u ), xAddresses[ 1 ].sin_port );
+        TEST_ASSERT_EQUAL( 0x0100a8c0ul, xAddresses[ 1 ].sin_addr );
+        TEST_ASSERT_EQUAL( 2, ucData[ 1 ][ 1 ] );
+
+        TEST_ASSERT_EQUAL( 1, FreeRTOS_recvmmsg( xSocket, xMessages, 2, 0 ) );
+        TEST_ASSERT_EQUAL( 3, xMessages[ 0 ].lResult );
+        TEST_ASSERT_EQUAL( FreeRTOS_htons( 1003u ), xAddresses[ 0 ].sin_port );
+
+        /* A datagram that is too long is not sent, nor the ones after it. */
+        xMessages[ 0 ].uxLength = ipMAX_UDP_PAYLOAD_LENGTH + 1u;
+        xMessages[ 1 ].uxLength = sizeof( ucData[ 1 ] );
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_sendmmsg( xSocket, xMessages, 2, 0 ) );
+        TEST_ASSERT_EQUAL( 0, xMessages[ 0 ].lResult );
+        TEST_ASSERT_EQUAL( 0, xMessages[ 1 ].lResult );
+
+        TEST_ASSERT_EQUAL( -pdFREERTOS_ERRNO_EINVAL, FreeRTOS_recvmmsg( xSocket, xMessages, 2, FREERTOS_MSG_PEEK ) );
+
+        FreeRTOS_closesocket( xSocket );
+
+        /* A socket is not bound for a datagram that is too long. */
+        xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+        TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, xSocket );
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_sendmmsg( xSocket, xMessages, 2, 0 ) );
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_sendto( xSocket, ucData[ 0 ], xMessages[ 0 ].uxLength, 0, &xAddresses[ 0 ], sizeof( xAddresses[ 0 ] ) ) );
+        ( void ) FreeRTOS_GetLocalAddress( xSocket, &xAddresses[ 1 ] );
+        TEST_ASSERT_EQUAL( 0, xAddresses[ 1 ].sin_port );
+        FreeRTOS_closesocket( xSocket );
+    }
+
+#endif /* if ( ipconfigUSE_UDP_BATCH != 0 ) */
+
+/* A buffer that is obtained can hold the requested number of bytes, keeps its
+ * contents when it grows, and is counted as free again after its release. */
+TEST( Full_FREERTOS_TCP, NetworkBufferGetRelease )
+{
+    NetworkBufferDescriptor_t * pxNetworkBuffer;
+    UBaseType_t uxFree;
+
+    pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( 60u, 0u );
+    TEST_ASSERT_NOT_NULL( pxNetworkBuffer );
+    TEST_ASSERT_EQUAL( 60u, pxNetworkBuffer->xDataLength );
+    memset( pxNetworkBuffer->pucEthernetBuffer, 0x5A, 60u );
+    uxFree = uxGetNumberOfFreeNetworkBuffers();
+
+    /* A short buffer may get a larger storage, the descriptor stays the same. */
+    pxNetworkBuffer = pxResizeNetworkBufferWithDescriptor( pxNetworkBuffer, ipTOTAL_ETHERNET_FRAME_SIZE );
+    TEST_ASSERT_NOT_NULL( pxNetworkBuffer );
+    TEST_ASSERT_EQUAL( 0x5A, pxNetworkBuffer->pucEthernetBuffer[ 59 ] );
+    pxNetworkBuffer->pucEthernetBuffer[ ipTOTAL_ETHERNET_FRAME_SIZE - 1u ] = 0xA5;
+    TEST_ASSERT_EQUAL( ( BaseType_t ) uxFree, ( BaseType_t ) uxGetNumberOfFreeNetworkBuffers() );
+
+    vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+    TEST_ASSERT_EQUAL( ( BaseType_t ) uxFree + 1, ( BaseType_t ) uxGetNumberOfFreeNetworkBuffers() );
+}
+
+/* When all buffers are given out, a request without a block time fails, and
+ * it succeeds again after one buffer is released. */
+TEST( Full_FREERTOS_TCP, NetworkBufferExhaustion )
+{
+    NetworkBufferDescriptor_t * pxBuffers[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ];
+    NetworkBufferDescriptor_t * pxNetworkBuffer;
+    UBaseType_t uxCount = 0u, uxIndex;
+
+    /* The IP-task may hold some of the buffers. */
+    while( uxCount < ( UBaseType_t ) ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS )
+    {
+        pxBuffers[ uxCount ] = pxGetNetworkBufferWithDescriptor( 60u, 0u );
+
+        if( pxBuffers[ uxCount ] == NULL )
+        {
+            break;
+        }
+
+        uxCount++;
+    }
+
+    TEST_ASSERT_TRUE( uxCount > 0u );
+    TEST_ASSERT_NULL( pxGetNetworkBufferWithDescriptor( 60u, 0u ) );
+    TEST_ASSERT_EQUAL( 0, ( BaseType_t ) uxGetNumberOfFreeNetworkBuffers() );
+
+    vReleaseNetworkBufferAndDescriptor( pxBuffers[ uxCount - 1u ] );
+    pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( 60u, 0u );
+    TEST_ASSERT_NOT_NULL( pxNetworkBuffer );
+    pxBuffers[ uxCount - 1u ] = pxNetworkBuffer;
+
+    for( uxIndex = 0u; uxIndex < uxCount; uxIndex++ )
+    {
+        vReleaseNetworkBufferAndDescriptor( pxBuffers[ uxIndex ] );
+    }
+
+    TEST_ASSERT_TRUE( uxGetNumberOfFreeNetworkBuffers() >= uxCount );
+}
+
+/* An allocator with buffers of a variable size serves requests longer than an
+ * Ethernet frame, as TCP segmentation offload and IP reassembly need them. */
+TEST( Full_FREERTOS_TCP, NetworkBufferOversize )
+{
+    NetworkBufferDescriptor_t * pxNetworkBuffer;
+    const size_t uxLongSize = ipTOTAL_ETHERNET_FRAME_SIZE + 1000u;
+    UBaseType_t uxFree = uxGetNumberOfFreeNetworkBuffers();
+
+    if( xBufferAllocFixedSize != pdFALSE )
+    {
+        TEST_IGNORE_MESSAGE( "The network buffers have a fixed size." );
+    }
+
+    pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( uxLongSize, 0u );
+    TEST_ASSERT_NOT_NULL( pxNetworkBuffer );
+    TEST_ASSERT_EQUAL( uxLongSize, pxNetworkBuffer->xDataLength );
+    pxNetworkBuffer->pucEthernetBuffer[ uxLongSize - 1u ] = 0xA5;
+    vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+
+    /* Growing beyond a frame keeps the contents. */
+    pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( ipTOTAL_ETHERNET_FRAME_SIZE, 0u );
+    TEST_ASSERT_NOT_NULL( pxNetworkBuffer );
+    memset( pxNetworkBuffer->pucEthernetBuffer, 0x5A, ipTOTAL_ETHERNET_FRAME_SIZE );
+    pxNetworkBuffer = pxResizeNetworkBufferWithDescriptor( pxNetworkBuffer, uxLongSize );
+    TEST_ASSERT_NOT_NULL( pxNetworkBuffer );
+    TEST_ASSERT_EQUAL( uxLongSize, pxNetworkBuffer->xDataLength );
+    TEST_ASSERT_EQUAL( 0x5A, pxNetworkBuffer->pucEthernetBuffer[ ipTOTAL_ETHERNET_FRAME_SIZE - 1u ] );
+    pxNetworkBuffer->pucEthernetBuffer[ uxLongSize - 1u ] = 0xA5;
+    vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+
+    TEST_ASSERT_EQUAL( ( BaseType_t ) uxFree, ( BaseType_t ) uxGetNumberOfFreeNetworkBuffers() );
+}
+
+/* Each bound UDP port finds its own socket, also when the ports share a bucket
+ * of the port table, and a closed socket is no longer found. */
+TEST( Full_FREERTOS_TCP, UDPPortLookup )
+{
+    /* The first three ports share a bucket of a table of up to 16 buckets,
+     * the last one does not. */
+    static const uint16_t usPorts[] = { 50140u, 50395u, 50650u, 50141u };
+    const size_t uxCount = sizeof( usPorts ) / sizeof( usPorts[ 0 ] );
+    Socket_t xSockets[ sizeof( usPorts ) / sizeof( usPorts[ 0 ] ) ];
+    FreeRTOS_Socket_t * pxFound[ sizeof( usPorts ) / sizeof( usPorts[ 0 ] ) ];
+    FreeRTOS_Socket_t * pxUnused, * pxEphemeral;
+    Socket_t xExtra;
+    struct freertos_sockaddr xAddress;
+    BaseType_t xDuplicateBind;
+    size_t uxIndex;
+
+    memset( &xAddress, 0, sizeof( xAddress ) );
+
+    for( uxIndex = 0; uxIndex < uxCount; uxIndex++ )
+    {
+        xSockets[ uxIndex ] = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+        TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, xSockets[ uxIndex ] );
+        xAddress.sin_port = FreeRTOS_htons( usPorts[ uxIndex ] );
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_bind( xSockets[ uxIndex ], &xAddress, sizeof( xAddress ) ) );
+    }
+
+    /* A port can only be bound once, and an ephemeral port is a free one. */
+    xExtra = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+    TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, xExtra );
+    xAddress.sin_port = FreeRTOS_htons( usPorts[ 1 ] );
+    xDuplicateBind = FreeRTOS_bind( xExtra, &xAddress, sizeof( xAddress ) );
+    TEST_ASSERT_EQUAL( 0, FreeRTOS_bind( xExtra, NULL, 0u ) );
+    ( void ) FreeRTOS_GetLocalAddress( xExtra, &xAddress );
+
+    /* The IP task also walks the table, so look up with the scheduler
+     * suspended and check the results afterwards. */
+    vTaskSuspendAll();
+    {
+        for( uxIndex = 0; uxIndex < uxCount; uxIndex++ )
+        {
+            pxFound[ uxIndex ] = pxUDPSocketLookup( FreeRTOS_htons( usPorts[ uxIndex ] ) );
+        }
+
+        pxUnused = pxUDPSocketLookup( FreeRTOS_htons( 50905u ) );
+        pxEphemeral = pxUDPSocketLookup( xAddress.sin_port );
+    }
+    ( void ) xTaskResumeAll();
+
+    for( uxIndex = 0; uxIndex < uxCount; uxIndex++ )
+    {
+        TEST_ASSERT_EQUAL_PTR( xSockets[ uxIndex ], pxFound[ uxIndex ] );
+    }
+
+    TEST_ASSERT_NULL( pxUnused );
+    TEST_ASSERT_NOT_EQUAL( 0, xDuplicateBind );
+    TEST_ASSERT_EQUAL_PTR( xExtra, pxEphemeral );
+    FreeRTOS_closesocket( xExtra );
+
+    /* Closing the socket in the middle of a bucket leaves the others.  The
+     * IP task does the actual close. */
+    FreeRTOS_closesocket( xSockets[ 1 ] );
+    vTaskDelay( pdMS_TO_TICKS( 50 ) );
+
+    vTaskSuspendAll();
+    {
+        for( uxIndex = 0; uxIndex < uxCount; uxIndex++ )
+        {
+            pxFound[ uxIndex ] = pxUDPSocketLookup( FreeRTOS_htons( usPorts[ uxIndex ] ) );
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    TEST_ASSERT_NULL( pxFound[ 1 ] );
+
+    for( uxIndex = 0; uxIndex < uxCount; uxIndex++ )
+    {
+        if( uxIndex != 1u )
+        {
+            TEST_ASSERT_EQUAL_PTR( xSockets[ uxIndex ], pxFound[ uxIndex ] );
+            FreeRTOS_closesocket( xSockets[ uxIndex ] );
+        }
+    }
+}
+
+/* Returns the x-th address after the one of this node on the local network,
+ * skipping the network and the broadcast address. */
+static uint32_t prvARPTestAddress( BaseType_t x )
+{
+    uint32_t ulIPAddress, ulNetMask, ulHostMask, ulHost;
+
+    FreeRTOS_GetAddressConfiguration( &ulIPAddress, &ulNetMask, NULL, NULL );
+    ulIPAddress = FreeRTOS_ntohl( ulIPAddress );
+    ulHostMask = ~FreeRTOS_ntohl( ulNetMask );
+    ulHost = ( ( ( ulIPAddress & ulHostMask ) + 1UL + ( uint32_t ) x ) % ( ulHostMask - 1UL ) ) + 1UL;
+
+    return FreeRTOS_htonl( ( ulIPAddress & ~ulHostMask ) | ulHost );
+}
+
+#if ( ipconfigARP_HASH_TABLE_SIZE > 0 )
+
+/* When the ARP cache is full a new neighbour replaces the one that was used
+ * least recently, not the one that was added first. */
+    TEST( Full_FREERTOS_TCP, ARPCacheLRU )
+    {
+        MACAddress_t xMACAddress = { { 0x02, 0x00, 0x00, 0x00, 0x01, 0x00 } };
+        eARPLookupResult_t eResults[ ipconfigARP_CACHE_ENTRIES + 1 ];
+        uint32_t ulIPAddress;
+        BaseType_t x;
+
+        /* The IP-task also uses the cache, so work with the scheduler
+         * suspended and check the results afterwards. */
+        vTaskSuspendAll();
+        {
+            FreeRTOS_ClearARP();
+
+            for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+            {
+                xMACAddress.ucBytes[ 5 ] = ( uint8_t ) x;
+                vARPRefreshCacheEntry( &xMACAddress, prvARPTestAddress( x ) );
+            }
+
+            /* Using the first entry makes the second one the oldest. */
+            ulIPAddress = prvARPTestAddress( 0 );
+            ( void ) eARPGetCacheEntry( &ulIPAddress, &xMACAddress );
+
+            xMACAddress.ucBytes[ 5 ] = ( uint8_t ) ipconfigARP_CACHE_ENTRIES;
+            vARPRefreshCacheEntry( &xMACAddress, prvARPTestAddress( ipconfigARP_CACHE_ENTRIES ) );
+
+            for( x = 0; x <= ipconfigARP_CACHE_ENTRIES; x++ )
+            {
+                ulIPAddress = prvARPTestAddress( x );
+                eResults[ x ] = eARPGetCacheEntry( &ulIPAddress, &xMACAddress );
+            }
+
+            /* Do not leave the made-up MAC addresses behind. */
+            FreeRTOS_ClearARP();
+        }
+        ( void ) xTaskResumeAll();
+
+        for( x = 0; x <= ipconfigARP_CACHE_ENTRIES; x++ )
+        {
+            TEST_ASSERT_EQUAL( ( x == 1 ) ? eARPCacheMiss : eARPCacheHit, eResults[ x ] );
+        }
+    }
+
+#endif /* if ( ipconfigARP_HASH_TABLE_SIZE > 0 ) */
+
+#if ( ipconfigARP_QUEUE_LENGTH > 0 )
+
+/* An ARP entry that waits for a reply holds up to ipconfigARP_QUEUE_LENGTH
+ * packets, releases them when it is cleared, and sends them when the reply
+ * arrives. */
+    TEST( Full_FREERTOS_TCP, ARPPendingQueue )
+    {
+        const MACAddress_t xMACAddress = { { 0x02, 0x00, 0x00, 0x00, 0x01, 0x01 } };
+        NetworkBufferDescriptor_t * pxBuffers[ ipconfigARP_QUEUE_LENGTH + 1 ];
+        BaseType_t xQueued[ ipconfigARP_QUEUE_LENGTH + 1 ];
+        UBaseType_t uxWaiting, uxWaitingAfterClear, uxFreeBefore, uxFreeAfter;
+        eARPLookupResult_t eLookup;
+        MACAddress_t xFound;
+        uint32_t ulIPAddress = prvARPTestAddress( 0 );
+        uint32_t ulLookup = ulIPAddress;
+        BaseType_t x;
+
+        for( x = 0; x <= ipconfigARP_QUEUE_LENGTH; x++ )
+        {
+            pxBuffers[ x ] = pxGetNetworkBufferWithDescriptor( ipUDP_PAYLOAD_OFFSET_IPv4 + 4U, 0U );
+            TEST_ASSERT_NOT_NULL( pxBuffers[ x ] );
+        }
+
+        vTaskSuspendAll();
+        {
+            FreeRTOS_ClearARP();
+
+            /* As vProcessGeneratedUDPPacket() does on a cache miss. */
+            vARPRefreshCacheEntry( NULL, ulIPAddress );
+            eLookup = eARPGetCacheEntry( &ulLookup, &xFound );
+
+            for( x = 0; x <= ipconfigARP_QUEUE_LENGTH; x++ )
+            {
+                xQueued[ x ] = xARPWaitForResolution( pxBuffers[ x ], ulIPAddress );
+            }
+
+            uxWaiting = TEST_FreeRTOS_ARP_WaitingPackets( ulIPAddress );
+            uxFreeBefore = uxGetNumberOfFreeNetworkBuffers();
+            FreeRTOS_ClearARP();
+            uxFreeAfter = uxGetNumberOfFreeNetworkBuffers();
+            uxWaitingAfterClear = TEST_FreeRTOS_ARP_WaitingPackets( ulIPAddress );
+        }
+        ( void ) xTaskResumeAll();
+
+        TEST_ASSERT_EQUAL( eCantSendPacket, eLookup );
+
+        for( x = 0; x < ipconfigARP_QUEUE_LENGTH; x++ )
+        {
+            TEST_ASSERT_EQUAL( pdTRUE, xQueued[ x ] );
+        }
+
+        /* The queue is full, the caller still owns the last buffer. */
+        TEST_ASSERT_EQUAL( pdFALSE, xQueued[ ipconfigARP_QUEUE_LENGTH ] );
+        TEST_ASSERT_EQUAL( ipconfigARP_QUEUE_LENGTH, uxWaiting );
+        TEST_ASSERT_EQUAL( ipconfigARP_QUEUE_LENGTH, uxFreeAfter - uxFreeBefore );
+        TEST_ASSERT_EQUAL( 0U, uxWaitingAfterClear );
+
+        /* A datagram of 4 bytes from port 50160 to port 50161, as sendto()
+         * prepares it. */
+        pxBuffers[ 0 ] = pxBuffers[ ipconfigARP_QUEUE_LENGTH ];
+        pxBuffers[ 0 ]->ulIPAddress = ulIPAddress;
+        pxBuffers[ 0 ]->usBoundPort = FreeRTOS_htons( 50160U );
+        pxBuffers[ 0 ]->usPort = FreeRTOS_htons( 50161U );
+        pxBuffers[ 0 ]->xDataLength = 4U;
+        pxBuffers[ 0 ]->pucEthernetBuffer[ ipSOCKET_OPTIONS_OFFSET ] = 0U;
+        memcpy( &( pxBuffers[ 0 ]->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] ), "ping", 4U );
+
+        vTaskSuspendAll();
+        {
+            vARPRefreshCacheEntry( NULL, ulIPAddress );
+            xQueued[ 0 ] = xARPWaitForResolution( pxBuffers[ 0 ], ulIPAddress );
+        }
+        ( void ) xTaskResumeAll();
+
+        TEST_ASSERT_EQUAL( pdTRUE, xQueued[ 0 ] );
+
+        /* The reply sends the datagram.  The driver may block, so the
+         * scheduler keeps running here. */
+        vARPRefreshCacheEntry( &xMACAddress, ulIPAddress );
+
+        vTaskSuspendAll();
+        {
+            uxWaiting = TEST_FreeRTOS_ARP_WaitingPackets( ulIPAddress );
+            ulLookup = ulIPAddress;
+            eLookup = eARPGetCacheEntry( &ulLookup, &xFound );
+            FreeRTOS_ClearARP();
+        }
+        ( void ) xTaskResumeAll();
+
+        TEST_ASSERT_EQUAL( 0U, uxWaiting );
+        TEST_ASSERT_EQUAL( eARPCacheHit, eLookup );
+        TEST_ASSERT_EQUAL_MEMORY( xMACAddress.ucBytes, xFound.ucBytes, sizeof( xFound.ucBytes ) );
+    }
+
+#endif /* if ( ipconfigARP_QUEUE_LENGTH > 0 ) */
+
+#if ( ipconfigUSE_DNS_CACHE == 1 ) || ( ipconfigDNS_USE_CALLBACKS != 0 )
+
+/* Writes a DNS reply with identifier 0x1234 for pcName, which contains
+ * uxCount A records.  Returns the length of the reply. */
+    static size_t prvDNSReply( uint8_t * pucBuffer,
+                               uint16_t usFlags,
+                               const char * pcName,
+                               const uint32_t * pulAddresses,
+                               const uint32_t * pulTTLs,
+                               size_t uxCount )
+    {
+        const char * pcLabel = pcName;
+        size_t uxLength, uxIndex, uxLabel;
+
+        memset( pucBuffer, 0, 12U );
+        pucBuffer[ 0 ] = 0x12U;
+        pucBuffer[ 1 ] = 0x34U;
+        pucBuffer[ 2 ] = ( uint8_t ) ( usFlags >> 8 );
+        pucBuffer[ 3 ] = ( uint8_t ) usFlags;
+        pucBuffer[ 5 ] = 1U;
+        pucBuffer[ 7 ] = ( uint8_t ) uxCount;
+        uxLength = 12U;
+
+        /* The question, with the name as a sequence of labels. */
+        while( *pcLabel != '\0' )
+        {
+            for( uxLabel = 0U; ( pcLabel[ uxLabel ] != '\0' ) && ( pcLabel[ uxLabel ] != '.' ); uxLabel++ )
+            {
+            }
+
+            pucBuffer[ uxLength++ ] = ( uint8_t ) uxLabel;
+            memcpy( &( pucBuffer[ uxLength ] ), pcLabel, uxLabel );
+            uxLength += uxLabel;
+            pcLabel += ( pcLabel[ uxLabel ] == '.' ) ? ( uxLabel + 1U ) : uxLabel;
+        }
+
+        pucBuffer[ uxLength++ ] = 0U;
+        memcpy( &( pucBuffer[ uxLength ] ), "\x00\x01\x00\x01", 4U );
+        uxLength += 4U;
+
+        for( uxIndex = 0U; uxIndex < uxCount; uxIndex++ )
+        {
+            /* A pointer to the name in the question, type A, class IN. */
+            memcpy( &( pucBuffer[ uxLength ] ), "\xc0\x0c\x00\x01\x00\x01", 6U );
+            pucBuffer[ uxLength + 6U ] = ( uint8_t ) ( pulTTLs[ uxIndex ] >> 24 );
+            pucBuffer[ uxLength + 7U ] = ( uint8_t ) ( pulTTLs[ uxIndex ] >> 16 );
+            pucBuffer[ uxLength + 8U ] = ( uint8_t ) ( pulTTLs[ uxIndex ] >> 8 );
+            pucBuffer[ uxLength + 9U ] = ( uint8_t ) pulTTLs[ uxIndex ];
+            pucBuffer[ uxLength + 10U ] = 0U;
+            pucBuffer[ uxLength + 11U ] = 4U;
+            memcpy( &( pucBuffer[ uxLength + 12U ] ), &( pulAddresses[ uxIndex ] ), 4U );
+            uxLength += 16U;
+        }
+
+        return uxLength;
+    }
+
+#endif /* if ( ipconfigUSE_DNS_CACHE == 1 ) || ( ipconfigDNS_USE_CALLBACKS != 0 ) */
+
+#if ( ipconfigUSE_DNS_CACHE == 1 )
+
+/* Replies are stored in the DNS cache for the shortest TTL of their A
+ * records, their addresses are returned in turn, a name without address is
+ * remembered as such, and an entry that is about to expire is refreshed once. */
+    TEST( Full_FREERTOS_TCP, DNSCache )
+    {
+        const uint32_t ulAddresses[ 2 ] = { FreeRTOS_inet_addr_quick( 192, 0, 2, 1 ), FreeRTOS_inet_addr_quick( 192, 0, 2, 2 ) };
+        const uint32_t ulTTLs[ 2 ] = { 800UL, 400UL };
+        uint8_t ucReply[ 128 ];
+        size_t uxLength;
+        uint32_t ulIPAddress;
+        TickType_t xPrefetchIdentifier;
+
+        FreeRTOS_dnsclear();
+
+        uxLength = prvDNSReply( ucReply, 0x8180U, "multi.example", ulAddresses, ulTTLs, 2U );
+        TEST_ASSERT_EQUAL_UINT32( ulAddresses[ 0 ], TEST_FreeRTOS_TCP_prvParseDNSReply( ucReply, uxLength, *( uint16_t * ) ucReply ) );
+
+        /* The hash is only a first check, the name must match. */
+        TEST_ASSERT_EQUAL( pdFALSE, TEST_FreeRTOS_DNS_LookupCache( "multi.exampld", &ulIPAddress, &xPrefetchIdentifier ) );
+
+        TEST_ASSERT_EQUAL( pdTRUE, TEST_FreeRTOS_DNS_LookupCache( "multi.example", &ulIPAddress, &xPrefetchIdentifier ) );
+        TEST_ASSERT_EQUAL_UINT32( ulAddresses[ 0 ], ulIPAddress );
+        TEST_ASSERT_EQUAL( 0U, xPrefetchIdentifier );
+        TEST_ASSERT_EQUAL( pdTRUE, TEST_FreeRTOS_DNS_LookupCache( "multi.example", &ulIPAddress, &xPrefetchIdentifier ) );
+        TEST_ASSERT_EQUAL_UINT32( ulAddresses[ ( ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY > 1 ) ? 1 : 0 ], ulIPAddress );
+        TEST_ASSERT_EQUAL( pdTRUE, TEST_FreeRTOS_DNS_LookupCache( "multi.example", &ulIPAddress, &xPrefetchIdentifier ) );
+        TEST_ASSERT_EQUAL_UINT32( ulAddresses[ 0 ], ulIPAddress );
+
+        /* In the last eighth of the shortest TTL. */
+        TEST_FreeRTOS_DNS_AgeCacheEntry( "multi.example", 360UL );
+        TEST_ASSERT_EQUAL( pdTRUE, TEST_FreeRTOS_DNS_LookupCache( "multi.example", &ulIPAddress, &xPrefetchIdentifier ) );
+
+        #if ( ipconfigDNS_CACHE_PREFETCH != 0 )
+            /* Only the first look-up refreshes the entry. */
+            TEST_ASSERT_NOT_EQUAL( 0U, xPrefetchIdentifier );
+            TEST_ASSERT_EQUAL( pdTRUE, TEST_FreeRTOS_DNS_LookupCache( "multi.example", &ulIPAddress, &xPrefetchIdentifier ) );
+            TEST_ASSERT_EQUAL( 0U, xPrefetchIdentifier );
+        #endif
+
+        /* The shortest TTL has passed. */
+        TEST_FreeRTOS_DNS_AgeCacheEntry( "multi.example", 40UL );
+        TEST_ASSERT_EQUAL( pdFALSE, TEST_FreeRTOS_DNS_LookupCache( "multi.example", &ulIPAddress, &xPrefetchIdentifier ) );
+        TEST_ASSERT_EQUAL_UINT32( 0UL, ulIPAddress );
+
+        #if ( ipconfigDNS_CACHE_NEGATIVE_TTL > 0 )
+            /* The server says that the name does not exist. */
+            uxLength = prvDNSReply( ucReply, 0x8183U, "none.example", NULL, NULL, 0U );
+            TEST_ASSERT_EQUAL_UINT32( 0UL, TEST_FreeRTOS_TCP_prvParseDNSReply( ucReply, uxLength, *( uint16_t * ) ucReply ) );
+            TEST_ASSERT_EQUAL( pdTRUE, TEST_FreeRTOS_DNS_LookupCache( "none.example", &ulIPAddress, &xPrefetchIdentifier ) );
+            TEST_ASSERT_EQUAL_UINT32( 0UL, ulIPAddress );
+            TEST_ASSERT_EQUAL( 0U, xPrefetchIdentifier );
+
+            /* Until its TTL has passed. */
+            TEST_FreeRTOS_DNS_AgeCacheEntry( "none.example", ( uint32_t ) ipconfigDNS_CACHE_NEGATIVE_TTL );
+            TEST_ASSERT_EQUAL( pdFALSE, TEST_FreeRTOS_DNS_LookupCache( "none.example", &ulIPAddress, &xPrefetchIdentifier ) );
+        #endif
+
+        FreeRTOS_dnsclear();
+    }
+
+#endif /* if ( ipconfigUSE_DNS_CACHE == 1 ) */
+
+#if ( ipconfigDNS_USE_CALLBACKS != 0 ) && ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+/* Lets a DNS reply from port 53 of ulServer arrive at the resolver socket of
+ * the IP-task, as xProcessReceivedUDPPacket() does. */
+    static void prvDNSInjectReply( uint32_t ulServer,
+                                   uint16_t usIdentifier,
+                                   uint16_t usFlags,
+                                   const char * pcName,
+                                   uint32_t ulAddress )
+    {
+        const uint32_t ulTTL = 600UL;
+        FreeRTOS_Socket_t * pxSocket = ( FreeRTOS_Socket_t * ) TEST_FreeRTOS_DNS_ResolverSocket();
+        NetworkBufferDescriptor_t * pxNetworkBuffer;
+        uint8_t * pucPayload;
+
+        TEST_ASSERT_NOT_NULL( pxSocket );
+        pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( ipUDP_PAYLOAD_OFFSET_IPv4 + 128U, 0U );
+        TEST_ASSERT_NOT_NULL( pxNetworkBuffer );
+
+        pucPayload = &( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] );
+        pxNetworkBuffer->xDataLength = prvDNSReply( pucPayload, usFlags, pcName, &ulAddress, &ulTTL, ( ulAddress != 0UL ) ? 1U : 0U );
+        memcpy( pucPayload, &usIdentifier, sizeof( usIdentifier ) );
+        pxNetworkBuffer->usPort = FreeRTOS_htons( 53U );
+        pxNetworkBuffer->ulIPAddress = ulServer;
+        #if ( ipconfigUSE_IPv6 != 0 )
+            pxNetworkBuffer->xUsesIPv6 = pdFALSE;
+        #endif
+
+        vTaskSuspendAll();
+        vListInsertEnd( &( pxSocket->u.xUDP.xWaitingPacketsList ), &( pxNetworkBuffer->xBufferListItem ) );
+        ( void ) xTaskResumeAll();
+        ( void ) xSendEventToIPTask( eDNSEvent );
+    }
+
+/* Two look-ups are outstanding at the same time.  A server failure makes the
+ * IP-task ask again, and each reply completes the look-up with the same
+ * identifier. */
+    TEST( Full_FREERTOS_TCP, DNSAsync )
+    {
+        static const char * const pcNames[ 2 ] = { "async-a.example", "async-b.example" };
+        const uint32_t ulAnswers[ 2 ] = { FreeRTOS_inet_addr_quick( 192, 0, 2, 10 ), FreeRTOS_inet_addr_quick( 192, 0, 2, 11 ) };
+        uint32_t ulSavedServers[ ipconfigDNS_MAX_SERVERS ];
+        volatile uint32_t ulResults[ 2 ] = { 0UL, 0UL };
+        uint16_t usIdentifiers[ 2 ];
+        BaseType_t xAttempts[ 2 ], xRetries, xIndex, xPending[ 2 ];
+        uint32_t ulBits, ulReceived = 0UL;
+        TickType_t xStart;
+
+        /* Servers that do not answer, only the injected replies do. */
+        for( xIndex = 0; xIndex < ( BaseType_t ) ipconfigDNS_MAX_SERVERS; xIndex++ )
+        {
+            ulSavedServers[ xIndex ] = FreeRTOS_GetDNSServerAddressAt( xIndex );
+            FreeRTOS_SetDNSServerAddressAt( xIndex, FreeRTOS_inet_addr_quick( 192, 0, 2, ( uint8_t ) ( 53 + xIndex ) ) );
+        }
+
+        #if ( ipconfigUSE_DNS_CACHE == 1 )
+            FreeRTOS_dnsclear();
+        #endif
+        ( void ) xTaskNotifyWait( 0UL, 0x3UL, NULL, 0U );
+
+        for( xIndex = 0; xIndex < 2; xIndex++ )
+        {
+            TEST_ASSERT_EQUAL( pdPASS, FreeRTOS_gethostbyname_notify( pcNames[ xIndex ], ( uint32_t * ) &( ulResults[ xIndex ] ), 1UL << xIndex, 10000U ) );
+        }
+
+        /* Let the IP-task send both requests. */
+        vTaskDelay( pdMS_TO_TICKS( 50 ) );
+
+        for( xIndex = 0; xIndex < 2; xIndex++ )
+        {
+            TEST_ASSERT_EQUAL( pdTRUE, TEST_FreeRTOS_DNS_GetRequest( pcNames[ xIndex ], &( usIdentifiers[ xIndex ] ), &( xAttempts[ xIndex ] ) ) );
+            TEST_ASSERT_GREATER_THAN( 0, xAttempts[ xIndex ] );
+        }
+
+        /* The first server fails to answer the first name, which is asked
+         * again, to the next server. */
+        prvDNSInjectReply( FreeRTOS_GetDNSServerAddressAt( 0 ), usIdentifiers[ 0 ], 0x8182U, pcNames[ 0 ], 0UL );
+        vTaskDelay( pdMS_TO_TICKS( 50 ) );
+        TEST_ASSERT_EQUAL( pdTRUE, TEST_FreeRTOS_DNS_GetRequest( pcNames[ 0 ], &( usIdentifiers[ 0 ] ), &xRetries ) );
+        TEST_ASSERT_GREATER_THAN( xAttempts[ 0 ], xRetries );
+
+        /* The answers arrive in the other order. */
+        prvDNSInjectReply( FreeRTOS_GetDNSServerAddressAt( 0 ), usIdentifiers[ 1 ], 0x8180U, pcNames[ 1 ], ulAnswers[ 1 ] );
+        prvDNSInjectReply( FreeRTOS_GetDNSServerAddressAt( 1 % ipconfigDNS_MAX_SERVERS ), usIdentifiers[ 0 ], 0x8180U, pcNames[ 0 ], ulAnswers[ 0 ] );
+
+        xStart = xTaskGetTickCount();
+
+        while( ( ulReceived != 0x3UL ) && ( ( xTaskGetTickCount() - xStart ) < pdMS_TO_TICKS( 1000 ) ) )
+        {
+            if( xTaskNotifyWait( 0UL, 0x3UL, &ulBits, pdMS_TO_TICKS( 100 ) ) != pdFALSE )
+            {
+                ulReceived |= ulBits & 0x3UL;
+            }
+        }
+
+        for( xIndex = 0; xIndex < 2; xIndex++ )
+        {
+            xPending[ xIndex ] = TEST_FreeRTOS_DNS_GetRequest( pcNames[ xIndex ], &( usIdentifiers[ xIndex ] ), &( xAttempts[ xIndex ] ) );
+        }
+
+        for( xIndex = 0; xIndex < ( BaseType_t ) ipconfigDNS_MAX_SERVERS; xIndex++ )
+        {
+            FreeRTOS_SetDNSServerAddressAt( xIndex, ulSavedServers[ xIndex ] );
+        }
+
+        #if ( ipconfigUSE_DNS_CACHE == 1 )
+            FreeRTOS_dnsclear();
+        #endif
+
+        TEST_ASSERT_EQUAL_HEX32( 0x3UL, ulReceived );
+        TEST_ASSERT_EQUAL_UINT32( ulAnswers[ 0 ], ulResults[ 0 ] );
+        TEST_ASSERT_EQUAL_UINT32( ulAnswers[ 1 ], ulResults[ 1 ] );
+        TEST_ASSERT_EQUAL( pdFALSE, xPending[ 0 ] );
+        TEST_ASSERT_EQUAL( pdFALSE, xPending[ 1 ] );
+    }
+
+#endif /* if ( ipconfigDNS_USE_CALLBACKS != 0 ) && ( configUSE_TASK_NOTIFICATIONS == 1 ) */
+
+#if ( ipconfigSUPPORT_SELECT_READY_LIST == 1 )
+
+/* FreeRTOS_select_ready() returns only the sockets that had an event which
+ * their owner asked for, each one once, in the order of their first event. */
+    TEST( Full_FREERTOS_TCP, SelectReady )
+    {
+        SocketSet_t xSocketSet;
+        Socket_t xSockets[ 3 ];
+        FreeRTOS_Socket_t * pxSockets[ 3 ];
+        SocketSelectEvent_t xEvents[ 4 ];
+        struct freertos_sockaddr xAddress;
+        BaseType_t xIndex;
+
+        xSocketSet = FreeRTOS_CreateSocketSet();
+        TEST_ASSERT_NOT_NULL( xSocketSet );
+        memset( &xAddress, 0, sizeof( xAddress ) );
+
+        for( xIndex = 0; xIndex < 3; xIndex++ )
+        {
+            xSockets[ xIndex ] = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+            TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, xSockets[ xIndex ] );
+            xAddress.sin_port = FreeRTOS_htons( ( uint16_t ) ( 50170 + xIndex ) );
+            TEST_ASSERT_EQUAL( 0, FreeRTOS_bind( xSockets[ xIndex ], &xAddress, sizeof( xAddress ) ) );
+            FreeRTOS_FD_SET( xSockets[ xIndex ], xSocketSet, eSELECT_READ );
+            pxSockets[ xIndex ] = ( FreeRTOS_Socket_t * ) xSockets[ xIndex ];
+        }
+
+        /* Let the IP-task look at the new members of the set. */
+        vTaskDelay( pdMS_TO_TICKS( 20 ) );
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_select_ready( xSocketSet, xEvents, 4, 0U ) );
+
+        /* Events as the IP-task reports them.  The second event on the third
+         * socket joins the first one, and nobody asked for write events. */
+        vSocketSelectReady( pxSockets[ 2 ], eSELECT_READ );
+        vSocketSelectReady( pxSockets[ 0 ], eSELECT_READ | eSELECT_WRITE );
+        vSocketSelectReady( pxSockets[ 2 ], eSELECT_READ );
+        vSocketSelectReady( pxSockets[ 1 ], eSELECT_WRITE );
+
+        TEST_ASSERT_EQUAL( 2, FreeRTOS_select_ready( xSocketSet, xEvents, 4, pdMS_TO_TICKS( 100 ) ) );
+        TEST_ASSERT_EQUAL_PTR( xSockets[ 2 ], xEvents[ 0 ].xSocket );
+        TEST_ASSERT_EQUAL( eSELECT_READ, xEvents[ 0 ].xEvents );
+        TEST_ASSERT_EQUAL_PTR( xSockets[ 0 ], xEvents[ 1 ].xSocket );
+        TEST_ASSERT_EQUAL( eSELECT_READ, xEvents[ 1 ].xEvents );
+
+        /* A socket is only returned again after a new event. */
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_select_ready( xSocketSet, xEvents, 4, 0U ) );
+
+        /* The sockets that do not fit are kept for the next call. */
+        for( xIndex = 0; xIndex < 3; xIndex++ )
+        {
+            vSocketSelectReady( pxSockets[ xIndex ], eSELECT_READ );
+        }
+
+        TEST_ASSERT_EQUAL( 2, FreeRTOS_select_ready( xSocketSet, xEvents, 2, 0U ) );
+        TEST_ASSERT_EQUAL_PTR( xSockets[ 0 ], xEvents[ 0 ].xSocket );
+        TEST_ASSERT_EQUAL_PTR( xSockets[ 1 ], xEvents[ 1 ].xSocket );
+        TEST_ASSERT_EQUAL( 1, FreeRTOS_select_ready( xSocketSet, xEvents, 2, 0U ) );
+        TEST_ASSERT_EQUAL_PTR( xSockets[ 2 ], xEvents[ 0 ].xSocket );
+
+        /* A socket that leaves the set takes its pending events along. */
+        vSocketSelectReady( pxSockets[ 0 ], eSELECT_READ );
+        FreeRTOS_FD_CLR( xSockets[ 0 ], xSocketSet, eSELECT_ALL );
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_select_ready( xSocketSet, xEvents, 4, 0U ) );
+
+        for( xIndex = 0; xIndex < 3; xIndex++ )
+        {
+            FreeRTOS_closesocket( xSockets[ xIndex ] );
+        }
+
+        vTaskDelay( pdMS_TO_TICKS( 20 ) );
+        FreeRTOS_DeleteSocketSet( xSocketSet );
+    }
+
+#endif /* if ( ipconfigSUPPORT_SELECT_READY_LIST == 1 ) */
+
+#if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 ) || ( ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_SYN_CACHE_SIZE > 0 ) )
+
+/* Builds a received frame for this node that holds a UDP or TCP message, of
+ * which the checksums are filled in.  It comes from a peer on 192.0.2.0/24,
+ * a network that is reserved for documentation. */
+    static NetworkBufferDescriptor_t * prvIPv4Frame( uint8_t ucProtocol,
+                                                     const uint8_t * pucMessage,
+                                                     size_t uxMessageLength )
+    {
+        static const MACAddress_t xPeerMAC = { { 0x02, 0x00, 0x00, 0x00, 0x00, 0x03 } };
+        NetworkBufferDescriptor_t * pxNetworkBuffer;
+        IPPacket_t * pxPacket;
+        IPHeader_t * pxIPHeader;
+
+        pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( sizeof( IPPacket_t ) + uxMessageLength, 0u );
+        TEST_ASSERT_NOT_NULL( pxNetworkBuffer );
+        pxNetworkBuffer->xDataLength = sizeof( IPPacket_t ) + uxMessageLength;
+        #if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+            pxNetworkBuffer->pxNextBuffer = NULL;
+        #endif
+        pxPacket = ( IPPacket_t * ) pxNetworkBuffer->pucEthernetBuffer;
+        pxIPHeader = &( pxPacket->xIPHeader );
+
+        memset( pxPacket, 0, sizeof( *pxPacket ) );
+        memcpy( pxPacket->xEthernetHeader.xSourceAddress.ucBytes, xPeerMAC.ucBytes, sizeof( xPeerMAC.ucBytes ) );
+        memcpy( pxPacket->xEthernetHeader.xDestinationAddress.ucBytes, FreeRTOS_GetMACAddress(), sizeof( MACAddress_t ) );
+        pxPacket->xEthernetHeader.usFrameType = ipIPv4_FRAME_TYPE;
+        pxIPHeader->ucVersionHeaderLength = 0x45U;
+        pxIPHeader->usLength = FreeRTOS_htons( ( uint16_t ) ( ipSIZE_OF_IPv4_HEADER + uxMessageLength ) );
+        pxIPHeader->ucTimeToLive = 64U;
+        pxIPHeader->ucProtocol = ucProtocol;
+        pxIPHeader->ulSourceIPAddress = FreeRTOS_inet_addr_quick( 192, 0, 2, 1 );
+        pxIPHeader->ulDestinationIPAddress = FreeRTOS_GetIPAddress();
+        pxIPHeader->usHeaderChecksum = usGenerateChecksum( 0UL, ( uint8_t * ) &( pxIPHeader->ucVersionHeaderLength ), ipSIZE_OF_IPv4_HEADER );
+        pxIPHeader->usHeaderChecksum = ~FreeRTOS_htons( pxIPHeader->usHeaderChecksum );
+        memcpy( &( pxNetworkBuffer->pucEthernetBuffer[ sizeof( IPPacket_t ) ] ), pucMessage, uxMessageLength );
+        ( void ) usGenerateProtocolChecksum( pxNetworkBuffer->pucEthernetBuffer, pxNetworkBuffer->xDataLength, pdTRUE );
+
+        return pxNetworkBuffer;
+    }
+
+#endif /* if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 ) || ( ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_SYN_CACHE_SIZE > 0 ) ) */
+
+#if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+
+/* Builds a received UDP frame from port 7002 of the peer for port 50180 of
+ * this node, with a payload of four bytes. */
+    static NetworkBufferDescriptor_t * prvLinkedRxFrame( const char * pcPayload )
+    {
+        uint8_t ucDatagram[ ipSIZE_OF_UDP_HEADER + 4u ];
+        UDPHeader_t * pxUDPHeader = ( UDPHeader_t * ) ucDatagram;
+
+        memset( ucDatagram, 0, sizeof( ucDatagram ) );
+        pxUDPHeader->usSourcePort = FreeRTOS_htons( 7002u );
+        pxUDPHeader->usDestinationPort = FreeRTOS_htons( 50180u );
+        pxUDPHeader->usLength = FreeRTOS_htons( ( uint16_t ) sizeof( ucDatagram ) );
+        memcpy( &( ucDatagram[ ipSIZE_OF_UDP_HEADER ] ), pcPayload, 4u );
+
+        return prvIPv4Frame( ( uint8_t ) ipPROTOCOL_UDP, ucDatagram, sizeof( ucDatagram ) );
+    }
+
+/* xSendNetworkBuffersToIPTask() passes a chain of frames in a single event,
+ * and the IP-task delivers each of them, in the order of the chain. */
+    TEST( Full_FREERTOS_TCP, LinkedRxMessages )
+    {
+        static const char * const pcPayloads[] = { "rx-0", "rx-1", "rx-2" };
+        const size_t uxCount = sizeof( pcPayloads ) / sizeof( pcPayloads[ 0 ] );
+        NetworkBufferDescriptor_t * pxFirst = NULL, * pxLast = NULL, * pxFrame;
+        struct freertos_sockaddr xAddress;
+        socklen_t xAddressLength;
+        TickType_t xTimeOut = pdMS_TO_TICKS( 500 );
+        uint8_t ucBuffer[ 8 ];
+        Socket_t xSocket;
+        size_t uxIndex;
+
+        xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+        TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, xSocket );
+        ( void ) FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, &xTimeOut, sizeof( xTimeOut ) );
+        memset( &xAddress, 0, sizeof( xAddress ) );
+        xAddress.sin_port = FreeRTOS_htons( 50180u );
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_bind( xSocket, &xAddress, sizeof( xAddress ) ) );
+
+        for( uxIndex = 0; uxIndex < uxCount; uxIndex++ )
+        {
+            pxFrame = prvLinkedRxFrame( pcPayloads[ uxIndex ] );
+
+            if( pxLast == NULL )
+            {
+                pxFirst = pxFrame;
+            }
+            else
+            {
+                pxLast->pxNextBuffer = pxFrame;
+            }
+
+            pxLast = pxFrame;
+        }
+
+        TEST_ASSERT_EQUAL( pdPASS, xSendNetworkBuffersToIPTask( pxFirst, 0u ) );
+
+        for( uxIndex = 0; uxIndex < uxCount; uxIndex++ )
+        {
+            xAddressLength = sizeof( xAddress );
+            TEST_ASSERT_EQUAL( 4, FreeRTOS_recvfrom( xSocket, ucBuffer, sizeof( ucBuffer ), 0, &xAddress, &xAddressLength ) );
+            TEST_ASSERT_EQUAL( FreeRTOS_htons( 7002u ), xAddress.sin_port );
+            TEST_ASSERT_EQUAL( FreeRTOS_inet_addr_quick( 192, 0, 2, 1 ), xAddress.sin_addr );
+            TEST_ASSERT_EQUAL_MEMORY( pcPayloads[ uxIndex ], ucBuffer, 4u );
+        }
+
+        FreeRTOS_closesocket( xSocket );
+    }
+
+#endif /* if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 ) */
+
+#if ( ipconfigUSE_TCP_WIN == 1 ) && ( ( ipconfigTCP_ACK_EVERY_N_SEGMENTS > 0 ) || ( ipconfigTCP_QUICKACK_IDLE_MS > 0 ) )
+
+/* Called for every ACK that the socket sends, as prvTCPReturnPacket() would. */
+    static void prvTCPAckSent( FreeRTOS_Socket_t * pxSocket )
+    {
+        #if ( ipconfigTCP_ACK_EVERY_N_SEGMENTS > 0 )
+            pxSocket->u.xTCP.ucUnackedSegments = 0u;
+        #else
+            ( void ) pxSocket;
+        #endif
+    }
+
+/* prvTCPAckImmediately() acknowledges the first segments after an idle period
+ * one by one, and otherwise at least every N-th segment. */
+    TEST( Full_FREERTOS_TCP, TCPAckPolicy )
+    {
+        static FreeRTOS_Socket_t xSocket;
+        UBaseType_t uxIndex;
+
+        memset( &xSocket, 0, sizeof( xSocket ) );
+
+        #if ( ipconfigTCP_QUICKACK_IDLE_MS > 0 )
+            /* The peer has been silent for a while. */
+            xSocket.u.xTCP.xLastRxDataTime = xTaskGetTickCount() - pdMS_TO_TICKS( ipconfigTCP_QUICKACK_IDLE_MS );
+
+            for( uxIndex = 0; uxIndex < ( UBaseType_t ) ipconfigTCP_QUICKACK_SEGMENTS; uxIndex++ )
+            {
+                TEST_ASSERT_EQUAL( pdTRUE, TEST_FreeRTOS_TCP_prvTCPAckImmediately( &xSocket ) );
+                prvTCPAckSent( &xSocket );
+            }
+        #endif /* if ( ipconfigTCP_QUICKACK_IDLE_MS > 0 ) */
+
+        #if ( ipconfigTCP_ACK_EVERY_N_SEGMENTS > 0 )
+            /* While data keeps coming in, the N-th segment since the last ACK
+             * is acknowledged, twice in a row. */
+            for( uxIndex = 1; uxIndex < ( UBaseType_t ) ( 2 * ipconfigTCP_ACK_EVERY_N_SEGMENTS ); uxIndex++ )
+            {
+                if( ( uxIndex % ( UBaseType_t ) ipconfigTCP_ACK_EVERY_N_SEGMENTS ) == 0u )
+                {
+                    TEST_ASSERT_EQUAL( pdTRUE, TEST_FreeRTOS_TCP_prvTCPAckImmediately( &xSocket ) );
+                    prvTCPAckSent( &xSocket );
+                }
+                else
+                {
+                    TEST_ASSERT_EQUAL( pdFALSE, TEST_FreeRTOS_TCP_prvTCPAckImmediately( &xSocket ) );
+                }
+            }
+
+            /* Without an ACK in between, the next segment is acknowledged too. */
+            TEST_ASSERT_EQUAL( pdTRUE, TEST_FreeRTOS_TCP_prvTCPAckImmediately( &xSocket ) );
+            TEST_ASSERT_EQUAL( pdTRUE, TEST_FreeRTOS_TCP_prvTCPAckImmediately( &xSocket ) );
+            prvTCPAckSent( &xSocket );
+        #else /* if ( ipconfigTCP_ACK_EVERY_N_SEGMENTS > 0 ) */
+            /* The quick ACKs are used up, the ACK may be delayed again. */
+            TEST_ASSERT_EQUAL( pdFALSE, TEST_FreeRTOS_TCP_prvTCPAckImmediately( &xSocket ) );
+        #endif /* if ( ipconfigTCP_ACK_EVERY_N_SEGMENTS > 0 ) */
+
+        #if ( ipconfigTCP_QUICKACK_IDLE_MS > 0 ) && ( ipconfigTCP_QUICKACK_SEGMENTS > 0 )
+            /* Another idle period brings the quick ACKs back. */
+            xSocket.u.xTCP.xLastRxDataTime = xTaskGetTickCount() - pdMS_TO_TICKS( ipconfigTCP_QUICKACK_IDLE_MS );
+            TEST_ASSERT_EQUAL( pdTRUE, TEST_FreeRTOS_TCP_prvTCPAckImmediately( &xSocket ) );
+            TEST_ASSERT_EQUAL( ( uint8_t ) ( ipconfigTCP_QUICKACK_SEGMENTS - 1 ), xSocket.u.xTCP.ucQuickAcks );
+        #endif
+    }
+
+#endif /* if ( ipconfigUSE_TCP_WIN == 1 ) && ( ( ipconfigTCP_ACK_EVERY_N_SEGMENTS > 0 ) || ( ipconfigTCP_QUICKACK_IDLE_MS > 0 ) ) */
+
+#if ( ipconfigTCP_RX_COALESCE_BYTES > 0 )
+
+/* Full-size segments are stored without waking up the reader until
+ * ipconfigTCP_RX_COALESCE_BYTES are queued.  Any other segment wakes it up at
+ * once, and so does the socket timer when no more data arrives. */
+    TEST( Full_FREERTOS_TCP, TCPRxCoalesce )
+    {
+        static FreeRTOS_Socket_t xSocket;
+        static uint8_t ucData[ ipconfigTCP_RX_COALESCE_BYTES ];
+        const uint32_t ulCoalesce = ( uint32_t ) ipconfigTCP_RX_COALESCE_BYTES;
+
+        memset( &xSocket, 0, sizeof( xSocket ) );
+        xSocket.u.xTCP.usInitMSS = 1000;
+        xSocket.u.xTCP.uxRxWinSize = 4;
+        xSocket.u.xTCP.uxTxWinSize = 4;
+        xSocket.u.xTCP.uxRxStreamSize = 2u * ulCoalesce;
+        TEST_FreeRTOS_TCP_prvTCPCreateWindow( &xSocket );
+
+        /* prvStoreRxData() sets bRxCoalesce for a full-size segment without
+         * the PSH flag. */
+        xSocket.u.xTCP.bits.bRxCoalesce = pdTRUE_UNSIGNED;
+        TEST_ASSERT_EQUAL( ( int32_t ) ( ulCoalesce - 1u ), lTCPAddRxdata( &xSocket, 0u, ucData, ulCoalesce - 1u ) );
+        TEST_ASSERT_EQUAL( 0u, xSocket.xEventBits & ( EventBits_t ) eSOCKET_RECEIVE );
+        TEST_ASSERT_EQUAL( pdTRUE_UNSIGNED, xSocket.u.xTCP.bits.bRxWakePending );
+
+        /* The reader is woken up as soon as enough bytes are queued. */
+        TEST_ASSERT_EQUAL( 1, lTCPAddRxdata( &xSocket, 0u, ucData, 1u ) );
+        TEST_ASSERT_NOT_EQUAL( 0u, xSocket.xEventBits & ( EventBits_t ) eSOCKET_RECEIVE );
+        TEST_ASSERT_EQUAL( pdFALSE_UNSIGNED, xSocket.u.xTCP.bits.bRxWakePending );
+
+        /* The reader takes all data. */
+        TEST_ASSERT_EQUAL( ulCoalesce, uxStreamBufferGet( xSocket.u.xTCP.rxStream, 0u, NULL, ulCoalesce, pdFALSE ) );
+        xSocket.xEventBits = 0u;
+
+        /* No more data follows a full-size segment, the reader is woken up
+         * when the socket timer expires. */
+        TEST_ASSERT_EQUAL( 1, lTCPAddRxdata( &xSocket, 0u, ucData, 1u ) );
+        TEST_ASSERT_EQUAL( 0u, xSocket.xEventBits & ( EventBits_t ) eSOCKET_RECEIVE );
+        xSocket.u.xTCP.usTimeout = 0u;
+        ( void ) xTCPSocketCheck( &xSocket );
+        TEST_ASSERT_NOT_EQUAL( 0u, xSocket.xEventBits & ( EventBits_t ) eSOCKET_RECEIVE );
+        TEST_ASSERT_EQUAL( pdFALSE_UNSIGNED, xSocket.u.xTCP.bits.bRxWakePending );
+        xSocket.xEventBits = 0u;
+
+        /* A short segment, or one with the PSH flag, wakes up the reader at
+         * once. */
+        xSocket.u.xTCP.bits.bRxCoalesce = pdFALSE_UNSIGNED;
+        TEST_ASSERT_EQUAL( 1, lTCPAddRxdata( &xSocket, 0u, ucData, 1u ) );
+        TEST_ASSERT_NOT_EQUAL( 0u, xSocket.xEventBits & ( EventBits_t ) eSOCKET_RECEIVE );
+
+        vPortFreeLarge( xSocket.u.xTCP.rxStream );
+        vTCPWindowDestroy( &( xSocket.u.xTCP.xTCPWindow ) );
+    }
+
+#endif /* if ( ipconfigTCP_RX_COALESCE_BYTES > 0 ) */
+
+#if ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_SYN_CACHE_SIZE > 0 )
+
+    #define testSYN_CACHE_PORT    ( 50190u )
+
+/* The peer's SYN from port testSYN_PEER_PORT( x ) has the sequence number
+ * testSYN_SEQUENCE( x ). */
+    #define testSYN_PEER_PORT( x )    ( ( uint16_t ) ( 40000u + ( uint16_t ) ( x ) ) )
+    #define testSYN_SEQUENCE( x )     ( 0x10000000UL + ( ( uint32_t ) ( x ) << 12 ) )
+
+/* Passes a segment from the peer to the listening port to the IP-task, and
+ * gives it some time to handle it.  A SYN offers an MSS of 536 bytes. */
+    static void prvSynCacheSegment( uint16_t usPeerPort,
+                                    uint8_t ucFlags,
+                                    uint32_t ulSequence,
+                                    uint32_t ulAck )
+    {
+        TCPHeader_t xHeader;
+        size_t uxLength = ipSIZE_OF_TCP_HEADER;
+
+        memset( &xHeader, 0, sizeof( xHeader ) );
+        xHeader.usSourcePort = FreeRTOS_htons( usPeerPort );
+        xHeader.usDestinationPort = FreeRTOS_htons( testSYN_CACHE_PORT );
+        xHeader.ulSequenceNumber = FreeRTOS_htonl( ulSequence );
+        xHeader.ulAckNr = FreeRTOS_htonl( ulAck );
+        xHeader.ucTCPFlags = ucFlags;
+        xHeader.usWindow = FreeRTOS_htons( 8192u );
+
+        if( ( ucFlags & testTCP_FLAG_SYN ) != 0u )
+        {
+            xHeader.ucOptdata[ 0 ] = 2u; /* MSS option. */
+            xHeader.ucOptdata[ 1 ] = 4u;
+            xHeader.ucOptdata[ 2 ] = 0x02u;
+            xHeader.ucOptdata[ 3 ] = 0x18u;
+            uxLength += 4u;
+        }
+
+        xHeader.ucTCPOffset = ( uint8_t ) ( uxLength << 2 );
+
+        TEST_ASSERT_EQUAL( pdPASS, xSendNetworkBuffersToIPTask( prvIPv4Frame( ( uint8_t ) ipPROTOCOL_TCP, ( const uint8_t * ) &xHeader, uxLength ), pdMS_TO_TICKS( 100 ) ) );
+        vTaskDelay( pdMS_TO_TICKS( 20 ) );
+    }
+
+/* A listening socket answers a SYN from the SYN cache, and creates the new
+ * socket when the final ACK arrives.  When the cache is full, the oldest
+ * request is dropped, or a SYN cookie is sent in stead. */
+    TEST( Full_FREERTOS_TCP, SynCache )
+    {
+        const uint32_t ulPeer = FreeRTOS_ntohl( FreeRTOS_inet_addr_quick( 192, 0, 2, 1 ) );
+        BaseType_t xInCache[ ipconfigTCP_SYN_CACHE_SIZE + 1 ];
+        TCPListenStatistics_t xBefore, xAfter;
+        FreeRTOS_Socket_t * pxFound;
+        struct freertos_sockaddr xAddress;
+        socklen_t xAddressLength;
+        TickType_t xTimeOut = pdMS_TO_TICKS( 500 );
+        Socket_t xListen, xChild;
+        uint32_t ulOurSequence = 0;
+        BaseType_t xIndex;
+
+        xListen = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+        TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, xListen );
+        ( void ) FreeRTOS_setsockopt( xListen, 0, FREERTOS_SO_RCVTIMEO, &xTimeOut, sizeof( xTimeOut ) );
+        memset( &xAddress, 0, sizeof( xAddress ) );
+        xAddress.sin_port = FreeRTOS_htons( testSYN_CACHE_PORT );
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_bind( xListen, &xAddress, sizeof( xAddress ) ) );
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_listen( xListen, 4 ) );
+        FreeRTOS_GetListenStatistics( &xBefore );
+
+        /* A SYN is stored in the cache, no socket is created yet.  The IP-task
+         * uses the cache and the socket lists, so look them up with the
+         * scheduler suspended. */
+        prvSynCacheSegment( testSYN_PEER_PORT( 0 ), testTCP_FLAG_SYN, testSYN_SEQUENCE( 0 ), 0u );
+        vTaskSuspendAll();
+        {
+            xInCache[ 0 ] = TEST_FreeRTOS_TCP_SynCacheLookup( ulPeer, testSYN_PEER_PORT( 0 ), testSYN_CACHE_PORT, &ulOurSequence );
+            pxFound = pxTCPSocketLookup( 0u, testSYN_CACHE_PORT, ulPeer, testSYN_PEER_PORT( 0 ) );
+        }
+        ( void ) xTaskResumeAll();
+        TEST_ASSERT_EQUAL( pdTRUE, xInCache[ 0 ] );
+        TEST_ASSERT_EQUAL_PTR( xListen, pxFound );
+
+        /* The final ACK turns the entry into a connected socket. */
+        prvSynCacheSegment( testSYN_PEER_PORT( 0 ), testTCP_FLAG_ACK, testSYN_SEQUENCE( 0 ) + 1u, ulOurSequence + 1u );
+        vTaskSuspendAll();
+        {
+            xInCache[ 0 ] = TEST_FreeRTOS_TCP_SynCacheLookup( ulPeer, testSYN_PEER_PORT( 0 ), testSYN_CACHE_PORT, &ulOurSequence );
+        }
+        ( void ) xTaskResumeAll();
+        TEST_ASSERT_EQUAL( pdFALSE, xInCache[ 0 ] );
+
+        xAddressLength = sizeof( xAddress );
+        xChild = FreeRTOS_accept( xListen, &xAddress, &xAddressLength );
+        TEST_ASSERT_NOT_NULL( xChild );
+        TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, xChild );
+        TEST_ASSERT_EQUAL( FreeRTOS_htons( testSYN_PEER_PORT( 0 ) ), xAddress.sin_port );
+        TEST_ASSERT_EQUAL( pdTRUE, FreeRTOS_issocketconnected( xChild ) );
+        FreeRTOS_closesocket( xChild );
+
+        /* Fill the cache, one request after the other, and send one more. */
+        for( xIndex = 1; xIndex <= ( BaseType_t ) ipconfigTCP_SYN_CACHE_SIZE + 1; xIndex++ )
+        {
+            prvSynCacheSegment( testSYN_PEER_PORT( xIndex ), testTCP_FLAG_SYN, testSYN_SEQUENCE( xIndex ), 0u );
+        }
+
+        vTaskSuspendAll();
+        {
+            for( xIndex = 1; xIndex <= ( BaseType_t ) ipconfigTCP_SYN_CACHE_SIZE + 1; xIndex++ )
+            {
+                xInCache[ xIndex - 1 ] = TEST_FreeRTOS_TCP_SynCacheLookup( ulPeer, testSYN_PEER_PORT( xIndex ), testSYN_CACHE_PORT, &ulOurSequence );
+            }
+        }
+        ( void ) xTaskResumeAll();
+        FreeRTOS_GetListenStatistics( &xAfter );
+
+        #if ( ipconfigTCP_SYN_COOKIES != 0 )
+            {
+                uint16_t usMSS = 536u;
+                uint32_t ulCookie;
+
+                /* The last request got a cookie, and no entry. */
+                for( xIndex = 0; xIndex < ( BaseType_t ) ipconfigTCP_SYN_CACHE_SIZE; xIndex++ )
+                {
+                    TEST_ASSERT_EQUAL( pdTRUE, xInCache[ xIndex ] );
+                }
+
+                TEST_ASSERT_EQUAL( pdFALSE, xInCache[ ipconfigTCP_SYN_CACHE_SIZE ] );
+                TEST_ASSERT_EQUAL( 0u, xAfter.ulCacheOverflows - xBefore.ulCacheOverflows );
+                TEST_ASSERT_EQUAL( 1u, xAfter.ulCookiesSent - xBefore.ulCookiesSent );
+
+                /* The ACK of the cookie opens a connection as well. */
+                xIndex = ( BaseType_t ) ipconfigTCP_SYN_CACHE_SIZE + 1;
+                ulCookie = TEST_FreeRTOS_TCP_prvSynCookieCreate( ulPeer, testSYN_PEER_PORT( xIndex ), testSYN_CACHE_PORT, testSYN_SEQUENCE( xIndex ), &usMSS );
+                prvSynCacheSegment( testSYN_PEER_PORT( xIndex ), testTCP_FLAG_ACK, testSYN_SEQUENCE( xIndex ) + 1u, ulCookie + 1u );
+                FreeRTOS_GetListenStatistics( &xAfter );
+                TEST_ASSERT_EQUAL( 1u, xAfter.ulCookiesAccepted - xBefore.ulCookiesAccepted );
+
+                xAddressLength = sizeof( xAddress );
+                xChild = FreeRTOS_accept( xListen, &xAddress, &xAddressLength );
+                TEST_ASSERT_NOT_NULL( xChild );
+                TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, xChild );
+                TEST_ASSERT_EQUAL( FreeRTOS_htons( testSYN_PEER_PORT( xIndex ) ), xAddress.sin_port );
+                FreeRTOS_closesocket( xChild );
+            }
+        #else /* if ( ipconfigTCP_SYN_COOKIES != 0 ) */
+            /* The oldest request was dropped for the last one. */
+            TEST_ASSERT_EQUAL( pdFALSE, xInCache[ 0 ] );
+
+            for( xIndex = 1; xIndex <= ( BaseType_t ) ipconfigTCP_SYN_CACHE_SIZE; xIndex++ )
+            {
+                TEST_ASSERT_EQUAL( pdTRUE, xInCache[ xIndex ] );
+            }
+
+            TEST_ASSERT_EQUAL( 1u, xAfter.ulCacheOverflows - xBefore.ulCacheOverflows );
+        #endif /* if ( ipconfigTCP_SYN_COOKIES != 0 ) */
+
+        /* A RST with the right sequence number removes a request. */
+        for( xIndex = 1; xIndex <= ( BaseType_t ) ipconfigTCP_SYN_CACHE_SIZE + 1; xIndex++ )
+        {
+            prvSynCacheSegment( testSYN_PEER_PORT( xIndex ), testTCP_FLAG_RST, testSYN_SEQUENCE( xIndex ) + 1u, 0u );
+        }
+
+        vTaskSuspendAll();
+        {
+            for( xIndex = 1; xIndex <= ( BaseType_t ) ipconfigTCP_SYN_CACHE_SIZE + 1; xIndex++ )
+            {
+                xInCache[ xIndex - 1 ] = TEST_FreeRTOS_TCP_SynCacheLookup( ulPeer, testSYN_PEER_PORT( xIndex ), testSYN_CACHE_PORT, &ulOurSequence );
+            }
+        }
+        ( void ) xTaskResumeAll();
+        FreeRTOS_GetListenStatistics( &xAfter );
+
+        for( xIndex = 0; xIndex <= ( BaseType_t ) ipconfigTCP_SYN_CACHE_SIZE; xIndex++ )
+        {
+            TEST_ASSERT_EQUAL( pdFALSE, xInCache[ xIndex ] );
+        }
+
+        TEST_ASSERT_EQUAL( ( uint32_t ) ipconfigTCP_SYN_CACHE_SIZE, xAfter.ulResets - xBefore.ulResets );
+        FreeRTOS_closesocket( xListen );
+    }
+
+#endif /* if ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_SYN_CACHE_SIZE > 0 ) */
+
+#if ( ipconfigUSE_TCP == 1 )
+
+/* pxTCPSocketLookup() prefers a connected socket with the same peer over a
+ * socket that listens to the port, and finds a socket whose state was changed
+ * by an API call.  The look-ups run with the scheduler suspended, so that the
+ * IP-task does not use the sockets while they are changed, and are checked
+ * afterwards. */
+    TEST( Full_FREERTOS_TCP, TCPSocketLookup )
+    {
+        Socket_t xListenSocket, xClientSocket;
+        FreeRTOS_Socket_t * pxListenSocket, * pxClientSocket;
+        FreeRTOS_Socket_t * pxFound[ 6 ];
+        struct freertos_sockaddr xAddress;
+        BaseType_t xFiled = pdTRUE;
+
+        xListenSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+        TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, xListenSocket );
+        xClientSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+        TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, xClientSocket );
+        pxListenSocket = ( FreeRTOS_Socket_t * ) xListenSocket;
+        pxClientSocket = ( FreeRTOS_Socket_t * ) xClientSocket;
+
+        memset( &xAddress, 0, sizeof( xAddress ) );
+        xAddress.sin_port = FreeRTOS_htons( 50130u );
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_bind( xListenSocket, &xAddress, sizeof( xAddress ) ) );
+        xAddress.sin_port = FreeRTOS_htons( 50131u );
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_bind( xClientSocket, &xAddress, sizeof( xAddress ) ) );
+
+        vTaskSuspendAll();
+        pxFound[ 0 ] = pxTCPSocketLookup( 0ul, 50130u, 0xc0a80002ul, 1000u );
+        ( void ) xTaskResumeAll();
+
+        /* FreeRTOS_listen() runs in the API task, so the first look-up finds
+         * the socket by walking the bound sockets, and files it. */
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_listen( xListenSocket, 2 ) );
+
+        vTaskSuspendAll();
+        {
+            pxFound[ 1 ] = pxTCPSocketLookup( 0ul, 50130u, 0xc0a80002ul, 1000u );
+            #if ( ipconfigTCP_HASH_TABLE_SIZE > 0 )
+                xFiled = ( listLIST_ITEM_CONTAINER( &( pxListenSocket->u.xTCP.xHashListItem ) ) != NULL ) ? pdTRUE : pdFALSE;
+            #endif
+
+            /* A connection on the same port, as a child socket would be,
+             * takes the segments of its peer only. */
+            pxClientSocket->usLocalPort = 50130u;
+            pxClientSocket->u.xTCP.ulRemoteIP = 0xc0a80002ul;
+            pxClientSocket->u.xTCP.usRemotePort = 1000u;
+            pxClientSocket->u.xTCP.ucTCPState = ( uint8_t ) eESTABLISHED;
+            #if ( ipconfigTCP_HASH_TABLE_SIZE > 0 )
+                vSocketTCPHashUpdate( pxClientSocket );
+            #endif
+            pxFound[ 2 ] = pxTCPSocketLookup( 0ul, 50130u, 0xc0a80002ul, 1000u );
+            pxFound[ 3 ] = pxTCPSocketLookup( 0ul, 50130u, 0xc0a80002ul, 1001u );
+            pxFound[ 4 ] = pxTCPSocketLookup( 0ul, 50130u, 0xc0a80003ul, 1000u );
+            pxFound[ 5 ] = pxTCPSocketLookup( 0ul, 50132u, 0xc0a80002ul, 1000u );
+
+            /* Undo the changes, so the socket is closed as it was. */
+            pxClientSocket->usLocalPort = 50131u;
+            pxClientSocket->u.xTCP.ulRemoteIP = 0ul;
+            pxClientSocket->u.xTCP.usRemotePort = 0u;
+            pxClientSocket->u.xTCP.ucTCPState = ( uint8_t ) eCLOSED;
+            #if ( ipconfigTCP_HASH_TABLE_SIZE > 0 )
+                vSocketTCPHashUpdate( pxClientSocket );
+            #endif
+        }
+        ( void ) xTaskResumeAll();
+
+        FreeRTOS_closesocket( xClientSocket );
+        FreeRTOS_closesocket( xListenSocket );
+
+        TEST_ASSERT_NULL( pxFound[ 0 ] );
+        TEST_ASSERT_EQUAL_PTR( pxListenSocket, pxFound[ 1 ] );
+        TEST_ASSERT_EQUAL( pdTRUE, xFiled );
+        TEST_ASSERT_EQUAL_PTR( pxClientSocket, pxFound[ 2 ] );
+        TEST_ASSERT_EQUAL_PTR( pxListenSocket, pxFound[ 3 ] );
+        TEST_ASSERT_EQUAL_PTR( pxListenSocket, pxFound[ 4 ] );
+        TEST_ASSERT_NULL( pxFound[ 5 ] );
+    }
+
+#endif /* if ( ipconfigUSE_TCP == 1 ) */
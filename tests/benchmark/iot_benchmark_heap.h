@@ -0,0 +1,67 @@
+/*
+ * Amazon FreeRTOS V201906.00 Major
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_benchmark_heap.h
+ * @brief Access to renamed copies of heap_1.c to heap_5.c for benchmarking.
+ *
+ * Only one heap implementation can provide pvPortMalloc() and vPortFree() in
+ * an image.  Each iot_benchmark_heap_N.c file compiles a private copy of
+ * heap_N.c with its API renamed, so all five allocators can be measured from
+ * the same test binary without affecting the heap used by the application.
+ */
+
+#ifndef _IOT_BENCHMARK_HEAP_H_
+#define _IOT_BENCHMARK_HEAP_H_
+
+/* Standard includes. */
+#include <stddef.h>
+
+/**
+ * @brief Size of the private heap given to each allocator under test.
+ */
+#ifndef benchmarkHEAP_SIZE
+    #define benchmarkHEAP_SIZE    ( 64U * 1024U )
+#endif
+
+/**
+ * @brief Entry points into one renamed heap implementation.
+ */
+typedef struct BenchmarkHeap
+{
+    const char * pcName;           /**< Name used in the benchmark output. */
+    void ( * vReset )( void );     /**< Returns the heap to its initial state where the implementation allows it. */
+    void * ( *pvMalloc )( size_t xSize );
+    void ( * vFree )( void * pv );
+    int xCanFree;                  /**< Zero for heap_1, which never frees memory. */
+} BenchmarkHeap_t;
+
+extern const BenchmarkHeap_t xBenchmarkHeap1;
+extern const BenchmarkHeap_t xBenchmarkHeap2;
+extern const BenchmarkHeap_t xBenchmarkHeap3;
+extern const BenchmarkHeap_t xBenchmarkHeap4;
+extern const BenchmarkHeap_t xBenchmarkHeap5;
+
+#endif /* _IOT_BENCHMARK_HEAP_H_ */
@@ -0,0 +1,59 @@
+/*
+ * Amazon FreeRTOS V201906.00 Major
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_benchmark_heap_1.c
+ * @brief A private copy of heap_1.c, see iot_benchmark_heap.h.
+ */
+
+/* Rename the heap API before any FreeRTOS header declares it. */
+#define pvPortMalloc                       pvBenchmarkHeap1Malloc
+#define vPortFree                          vBenchmarkHeap1Free
+#define vPortInitialiseBlocks              vBenchmarkHeap1InitialiseBlocks
+#define xPortGetFreeHeapSize               xBenchmarkHeap1GetFreeHeapSize
+#define xPortGetMinimumEverFreeHeapSize    xBenchmarkHeap1GetMinimumEverFreeHeapSize
+#define vPortDefineHeapRegions             vBenchmarkHeap1DefineHeapRegions
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* Benchmark includes. */
+#include "iot_benchmark_heap.h"
+
+/* Give the copy its own, smaller, heap array. */
+#undef configTOTAL_HEAP_SIZE
+#define configTOTAL_HEAP_SIZE    benchmarkHEAP_SIZE
+
+#include "../../freertos_kernel/portable/MemMang/heap_1.c"
+/*-----------------------------------------------------------*/
+
+const BenchmarkHeap_t xBenchmarkHeap1 =
+{
+    .pcName   = "heap_1",
+    .vReset   = vBenchmarkHeap1InitialiseBlocks, /* heap_1 never frees, so is emptied between rounds instead. */
+    .pvMalloc = pvBenchmarkHeap1Malloc,
+    .vFree    = vBenchmarkHeap1Free,
+    .xCanFree = 0
+};
@@ -0,0 +1,62 @@
+/*
+ * Amazon FreeRTOS V201906.00 Major
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_benchmark_heap_3.c
+ * @brief A private copy of heap_3.c, see iot_benchmark_heap.h.
+ */
+
+/* Rename the heap API before any FreeRTOS header declares it. */
+#define pvPortMalloc                       pvBenchmarkHeap3Malloc
+#define vPortFree                          vBenchmarkHeap3Free
+#define vPortInitialiseBlocks              vBenchmarkHeap3InitialiseBlocks
+#define xPortGetFreeHeapSize               xBenchmarkHeap3GetFreeHeapSize
+#define xPortGetMinimumEverFreeHeapSize    xBenchmarkHeap3GetMinimumEverFreeHeapSize
+#define vPortDefineHeapRegions             vBenchmarkHeap3DefineHeapRegions
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* Benchmark includes. */
+#include "iot_benchmark_heap.h"
+
+#include "../../freertos_kernel/portable/MemMang/heap_3.c"
+/*-----------------------------------------------------------*/
+
+static void prvReset( void )
+{
+    /* heap_3 wraps the C library allocator, which has no state of its own to
+     * reset. */
+}
+/*-----------------------------------------------------------*/
+
+const BenchmarkHeap_t xBenchmarkHeap3 =
+{
+    .pcName   = "heap_3",
+    .vReset   = prvReset,
+    .pvMalloc = pvBenchmarkHeap3Malloc,
+    .vFree    = vBenchmarkHeap3Free,
+    .xCanFree = 1
+};
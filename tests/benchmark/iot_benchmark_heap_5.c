@@ -0,0 +1,77 @@
+/*
+ * Amazon FreeRTOS V201906.00 Major
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_benchmark_heap_5.c
+ * @brief A private copy of heap_5.c, see iot_benchmark_heap.h.
+ */
+
+/* Rename the heap API before any FreeRTOS header declares it. */
+#define pvPortMalloc                       pvBenchmarkHeap5Malloc
+#define vPortFree                          vBenchmarkHeap5Free
+#define vPortInitialiseBlocks              vBenchmarkHeap5InitialiseBlocks
+#define xPortGetFreeHeapSize               xBenchmarkHeap5GetFreeHeapSize
+#define xPortGetMinimumEverFreeHeapSize    xBenchmarkHeap5GetMinimumEverFreeHeapSize
+#define vPortDefineHeapRegions             vBenchmarkHeap5DefineHeapRegions
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* Benchmark includes. */
+#include "iot_benchmark_heap.h"
+
+#include "../../freertos_kernel/portable/MemMang/heap_5.c"
+/*-----------------------------------------------------------*/
+
+/* heap_5 does not own any memory until it is given regions. */
+static uint8_t ucHeapRegion[ benchmarkHEAP_SIZE ];
+/*-----------------------------------------------------------*/
+
+static void prvReset( void )
+{
+    static BaseType_t xRegionsDefined = pdFALSE;
+    const HeapRegion_t xHeapRegions[] =
+    {
+        { ucHeapRegion, sizeof( ucHeapRegion ) },
+        { NULL,         0                      }
+    };
+
+    /* vPortDefineHeapRegions() can only be called once. */
+    if( xRegionsDefined == pdFALSE )
+    {
+        vBenchmarkHeap5DefineHeapRegions( xHeapRegions );
+        xRegionsDefined = pdTRUE;
+    }
+}
+/*-----------------------------------------------------------*/
+
+const BenchmarkHeap_t xBenchmarkHeap5 =
+{
+    .pcName   = "heap_5",
+    .vReset   = prvReset,
+    .pvMalloc = pvBenchmarkHeap5Malloc,
+    .vFree    = vBenchmarkHeap5Free,
+    .xCanFree = 1
+};
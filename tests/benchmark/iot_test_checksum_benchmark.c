@@ -0,0 +1,202 @@
+/*
+ * Amazon FreeRTOS V201906.00 Major
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_test_checksum_benchmark.c
+ * @brief Microbenchmarks of the FreeRTOS+TCP Internet checksum.
+ *
+ * The results are printed in the same format as those of
+ * iot_test_kernel_benchmark.c, with the number of bytes as "param", so that
+ * tools/benchmark/compare_benchmarks.py can compare them between commits.
+ * Build once with ipconfigUSE_CHECKSUM_KERNELS set to 0 and once with it set
+ * to 1 to compare the generic checksum with the kernel of the target.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+
+/* Test includes. */
+#include "unity_fixture.h"
+#include "unity.h"
+#include "aws_test_runner.h"
+
+/**
+ * @brief Configuration for this test group.
+ */
+
+/*
+ * @brief Number of bytes summed by each benchmark, spread over as many
+ * operations as needed.
+ */
+#ifndef benchmarkCHECKSUM_BYTES
+    #define benchmarkCHECKSUM_BYTES    ( 16U * 1024U * 1024U )
+#endif
+
+/*
+ * @brief Time base, see iot_test_kernel_benchmark.c.
+ */
+#ifndef benchmarkGET_TIMESTAMP
+    #define benchmarkGET_TIMESTAMP()    ( ( uint32_t ) xTaskGetTickCount() )
+    #define benchmarkNS_PER_TIMESTAMP    ( 1000000000ULL / ( uint64_t ) configTICK_RATE_HZ )
+#endif
+
+/*
+ * @brief The largest block that is summed.
+ */
+#define benchmarkMAX_BLOCK_SIZE        ( 8192U )
+
+/*
+ * @brief Room for the largest block at every offset tested.
+ */
+#define benchmarkBUFFER_SIZE           ( benchmarkMAX_BLOCK_SIZE + 4U )
+/*-----------------------------------------------------------*/
+
+/* The block sizes: an IP header, a small and a medium packet, a full TCP
+ * segment, and a jumbo block. */
+static const size_t xBlockSizes[] = { 20U, 64U, 256U, 576U, 1460U, benchmarkMAX_BLOCK_SIZE };
+
+/* The data that is summed, and the target of the copies. */
+static uint8_t ucSource[ benchmarkBUFFER_SIZE ];
+static uint8_t ucTarget[ benchmarkBUFFER_SIZE ];
+
+/* Written with every result, so the compiler can not leave out the work. */
+static volatile uint16_t usSink = 0;
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Print one result, see iot_test_kernel_benchmark.c.
+ */
+static void prvReport( const char * pcName,
+                       uint32_t ulParam,
+                       uint32_t ulOperations,
+                       uint32_t ulElapsed )
+{
+    uint64_t ullTotalNs = ( uint64_t ) ulElapsed * ( uint64_t ) benchmarkNS_PER_TIMESTAMP;
+
+    configPRINTF( ( "BENCHMARK {\"name\":\"%s\",\"param\":%lu,\"iterations\":%lu,\"total_ns\":%llu,\"ns_per_op\":%llu}\r\n",
+                    pcName,
+                    ( unsigned long ) ulParam,
+                    ( unsigned long ) ulOperations,
+                    ( unsigned long long ) ullTotalNs,
+                    ( unsigned long long ) ( ullTotalNs / ( uint64_t ) ulOperations ) ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Time usGenerateChecksum(), or the copy variants, for every block
+ * size, with the data starting at xOffset bytes from a 32-bit boundary.
+ */
+static void prvChecksumBenchmark( const char * pcName,
+                                  size_t xOffset,
+                                  BaseType_t xCopy )
+{
+    char cName[ 32 ];
+    uint32_t ulSize, ulIteration, ulIterations, ulStart, ulElapsed;
+    size_t xLength;
+
+    for( ulSize = 0; ulSize < ( sizeof( xBlockSizes ) / sizeof( xBlockSizes[ 0 ] ) ); ulSize++ )
+    {
+        xLength = xBlockSizes[ ulSize ];
+        ulIterations = benchmarkCHECKSUM_BYTES / ( uint32_t ) xLength;
+
+        ulStart = benchmarkGET_TIMESTAMP();
+
+        for( ulIteration = 0; ulIteration < ulIterations; ulIteration++ )
+        {
+            if( xCopy == pdFALSE )
+            {
+                usSink = usGenerateChecksum( 0UL, &( ucSource[ xOffset ] ), xLength );
+            }
+            else
+            {
+                #if ( ipconfigUSE_CHECKSUM_KERNELS != 0 )
+                    usSink = usGenerateChecksumCopy( 0UL, &( ucTarget[ xOffset ] ), &( ucSource[ xOffset ] ), xLength );
+                #else
+                    /* What the stack does without the copy variant. */
+                    memcpy( &( ucTarget[ xOffset ] ), &( ucSource[ xOffset ] ), xLength );
+                    usSink = usGenerateChecksum( 0UL, &( ucTarget[ xOffset ] ), xLength );
+                #endif
+            }
+        }
+
+        ulElapsed = benchmarkGET_TIMESTAMP() - ulStart;
+
+        ( void ) snprintf( cName, sizeof( cName ), "%s_offset_%u", pcName, ( unsigned ) xOffset );
+        prvReport( cName, ( uint32_t ) xLength, ulIterations, ulElapsed );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * @brief Test group definition.
+ */
+TEST_GROUP( Full_Checksum_Benchmark );
+
+TEST_SETUP( Full_Checksum_Benchmark )
+{
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < benchmarkBUFFER_SIZE; ulIndex++ )
+    {
+        ucSource[ ulIndex ] = ( uint8_t ) ( ulIndex * 181U );
+    }
+}
+
+TEST_TEAR_DOWN( Full_Checksum_Benchmark )
+{
+}
+
+TEST_GROUP_RUNNER( Full_Checksum_Benchmark )
+{
+    RUN_TEST_CASE( Full_Checksum_Benchmark, Checksum );
+    RUN_TEST_CASE( Full_Checksum_Benchmark, ChecksumCopy );
+}
+/*-----------------------------------------------------------*/
+
+/* One operation sums one block.  Offsets 1 and 2 show the cost of data that is
+ * not 32-bit aligned, such as the payload after an Ethernet header. */
+TEST( Full_Checksum_Benchmark, Checksum )
+{
+    prvChecksumBenchmark( "checksum", 0U, pdFALSE );
+    prvChecksumBenchmark( "checksum", 1U, pdFALSE );
+    prvChecksumBenchmark( "checksum", 2U, pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+/* One operation copies and sums one block, like FreeRTOS_sendto() does. */
+TEST( Full_Checksum_Benchmark, ChecksumCopy )
+{
+    prvChecksumBenchmark( "checksum_copy", 0U, pdTRUE );
+    prvChecksumBenchmark( "checksum_copy", 2U, pdTRUE );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,495 @@
+/*
+ * Amazon FreeRTOS V201906.00 Major
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_test_kernel_benchmark.c
+ * @brief Kernel microbenchmarks for the host port.
+ *
+ * Every measurement is printed on a single line of the form
+ *
+ * BENCHMARK {"name":"queue_send_receive","param":64,"iterations":10000,"total_ns":123450000,"ns_per_op":12345}
+ *
+ * so results can be extracted from the test log and compared between commits
+ * with tools/benchmark/compare_benchmarks.py.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "stream_buffer.h"
+#include "timers.h"
+
+/* Test includes. */
+#include "unity_fixture.h"
+#include "unity.h"
+#include "aws_test_runner.h"
+#include "iot_benchmark_heap.h"
+
+/**
+ * @brief Configuration for this test group.
+ */
+
+/*
+ * @brief Number of operations timed by each benchmark.
+ */
+#ifndef benchmarkITERATIONS
+    #define benchmarkITERATIONS    ( 10000U )
+#endif
+
+/*
+ * @brief Time base.  Defaults to the tick count; ports with a finer run time
+ * stats counter should override both macros in aws_test_runner_config.h.
+ */
+#ifndef benchmarkGET_TIMESTAMP
+    #define benchmarkGET_TIMESTAMP()    ( ( uint32_t ) xTaskGetTickCount() )
+    #define benchmarkNS_PER_TIMESTAMP    ( 1000000000ULL / ( uint64_t ) configTICK_RATE_HZ )
+#endif
+
+/*
+ * @brief Sizes used by the queue and heap benchmarks.
+ */
+#define benchmarkMAX_ITEM_SIZE             ( 256U )
+
+/*
+ * @brief Stream buffer size used by the throughput benchmark.
+ */
+#define benchmarkSTREAM_BUFFER_SIZE        ( 4096U )
+
+/*
+ * @brief Number of blocks allocated before any are freed in the heap
+ * benchmark, so the free lists are exercised rather than a single block
+ * bouncing in and out.
+ */
+#define benchmarkHEAP_BATCH                ( 32U )
+
+/*
+ * @brief Number of software timers started together by the timer expiry
+ * benchmark.
+ */
+#define benchmarkTIMER_BATCH               ( 8U )
+
+/*
+ * @brief Stack size of the partner tasks used by the ping-pong benchmarks.
+ */
+#define benchmarkPARTNER_STACK_SIZE        ( configMINIMAL_STACK_SIZE * 4 )
+/*-----------------------------------------------------------*/
+
+/* Handle of the task running the tests, notified by partner tasks. */
+static TaskHandle_t xBenchmarkTask = NULL;
+
+/* Objects shared with the partner tasks. */
+static SemaphoreHandle_t xPingSemaphore = NULL;
+static SemaphoreHandle_t xPongSemaphore = NULL;
+
+/* Counts timer callbacks in the timer expiry benchmark. */
+static volatile uint32_t ulTimerExpiries = 0;
+
+/* Item buffers for the queue and stream buffer benchmarks. */
+static uint8_t ucTxBuffer[ benchmarkSTREAM_BUFFER_SIZE ];
+static uint8_t ucRxBuffer[ benchmarkSTREAM_BUFFER_SIZE ];
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Print one result in the machine readable format described at the
+ * top of this file.
+ */
+static void prvReport( const char * pcName,
+                       uint32_t ulParam,
+                       uint32_t ulOperations,
+                       uint32_t ulElapsed )
+{
+    uint64_t ullTotalNs = ( uint64_t ) ulElapsed * ( uint64_t ) benchmarkNS_PER_TIMESTAMP;
+
+    configPRINTF( ( "BENCHMARK {\"name\":\"%s\",\"param\":%lu,\"iterations\":%lu,\"total_ns\":%llu,\"ns_per_op\":%llu}\r\n",
+                    pcName,
+                    ( unsigned long ) ulParam,
+                    ( unsigned long ) ulOperations,
+                    ( unsigned long long ) ullTotalNs,
+                    ( unsigned long long ) ( ullTotalNs / ( uint64_t ) ulOperations ) ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvYieldPartnerTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        taskYIELD();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvNotifyPartnerTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        ( void ) xTaskNotifyGive( xBenchmarkTask );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSemaphorePartnerTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ( void ) xSemaphoreTake( xPingSemaphore, portMAX_DELAY );
+        ( void ) xSemaphoreGive( xPongSemaphore );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvTimerCallback( TimerHandle_t xTimer )
+{
+    ( void ) xTimer;
+
+    ulTimerExpiries++;
+
+    if( ulTimerExpiries == benchmarkTIMER_BATCH )
+    {
+        ( void ) xTaskNotifyGive( xBenchmarkTask );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static TaskHandle_t prvCreatePartner( TaskFunction_t pxTaskCode,
+                                      UBaseType_t uxPriority )
+{
+    TaskHandle_t xPartner = NULL;
+
+    TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( pxTaskCode,
+                                            "BenchPeer",
+                                            benchmarkPARTNER_STACK_SIZE,
+                                            NULL,
+                                            uxPriority,
+                                            &xPartner ) );
+
+    return xPartner;
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapBenchmark( const BenchmarkHeap_t * pxHeap )
+{
+    static const size_t xSizes[] = { 16U, 64U, 256U, 1024U };
+    void * pvBlocks[ benchmarkHEAP_BATCH ];
+    char cName[ 32 ];
+    uint32_t ulSize, ulRound, ulBlock, ulStart, ulElapsed;
+    uint32_t ulRounds = benchmarkITERATIONS / benchmarkHEAP_BATCH;
+
+    pxHeap->vReset();
+
+    for( ulSize = 0; ulSize < ( sizeof( xSizes ) / sizeof( xSizes[ 0 ] ) ); ulSize++ )
+    {
+        ulElapsed = 0;
+
+        for( ulRound = 0; ulRound < ulRounds; ulRound++ )
+        {
+            ulStart = benchmarkGET_TIMESTAMP();
+
+            for( ulBlock = 0; ulBlock < benchmarkHEAP_BATCH; ulBlock++ )
+            {
+                pvBlocks[ ulBlock ] = pxHeap->pvMalloc( xSizes[ ulSize ] );
+            }
+
+            if( pxHeap->xCanFree != 0 )
+            {
+                /* Free in the opposite order to allocation to exercise the
+                 * coalescing of adjacent blocks. */
+                for( ulBlock = benchmarkHEAP_BATCH; ulBlock > 0; ulBlock-- )
+                {
+                    pxHeap->vFree( pvBlocks[ ulBlock - 1 ] );
+                }
+            }
+
+            ulElapsed += benchmarkGET_TIMESTAMP() - ulStart;
+
+            for( ulBlock = 0; ulBlock < benchmarkHEAP_BATCH; ulBlock++ )
+            {
+                TEST_ASSERT_NOT_NULL( pvBlocks[ ulBlock ] );
+            }
+
+            if( pxHeap->xCanFree == 0 )
+            {
+                pxHeap->vReset();
+            }
+        }
+
+        ( void ) snprintf( cName, sizeof( cName ), "malloc_free_%s", pxHeap->pcName );
+        prvReport( cName, ( uint32_t ) xSizes[ ulSize ], ulRounds * benchmarkHEAP_BATCH, ulElapsed );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * @brief Test group definition.
+ */
+TEST_GROUP( Full_Kernel_Benchmark );
+
+TEST_SETUP( Full_Kernel_Benchmark )
+{
+    xBenchmarkTask = xTaskGetCurrentTaskHandle();
+}
+
+TEST_TEAR_DOWN( Full_Kernel_Benchmark )
+{
+    /* Give the idle task the chance to free deleted partner tasks. */
+    vTaskDelay( pdMS_TO_TICKS( 10 ) );
+}
+
+TEST_GROUP_RUNNER( Full_Kernel_Benchmark )
+{
+    RUN_TEST_CASE( Full_Kernel_Benchmark, ContextSwitchYield );
+    RUN_TEST_CASE( Full_Kernel_Benchmark, ContextSwitchNotify );
+    RUN_TEST_CASE( Full_Kernel_Benchmark, ContextSwitchSemaphore );
+    RUN_TEST_CASE( Full_Kernel_Benchmark, QueueSendReceive );
+    RUN_TEST_CASE( Full_Kernel_Benchmark, StreamBufferThroughput );
+    RUN_TEST_CASE( Full_Kernel_Benchmark, TimerArm );
+    RUN_TEST_CASE( Full_Kernel_Benchmark, TimerExpire );
+    RUN_TEST_CASE( Full_Kernel_Benchmark, HeapMallocFree );
+}
+/*-----------------------------------------------------------*/
+
+/* Two tasks of equal priority yielding to each other.  One operation is one
+ * yield by this task, which is two context switches. */
+TEST( Full_Kernel_Benchmark, ContextSwitchYield )
+{
+    TaskHandle_t xPartner;
+    uint32_t ulIteration, ulStart, ulElapsed;
+
+    xPartner = prvCreatePartner( prvYieldPartnerTask, uxTaskPriorityGet( NULL ) );
+
+    ulStart = benchmarkGET_TIMESTAMP();
+
+    for( ulIteration = 0; ulIteration < benchmarkITERATIONS; ulIteration++ )
+    {
+        taskYIELD();
+    }
+
+    ulElapsed = benchmarkGET_TIMESTAMP() - ulStart;
+
+    vTaskDelete( xPartner );
+    prvReport( "context_switch_yield", 0, benchmarkITERATIONS, ulElapsed );
+}
+/*-----------------------------------------------------------*/
+
+/* Notify a higher priority task, which notifies straight back.  One
+ * operation is a full round trip. */
+TEST( Full_Kernel_Benchmark, ContextSwitchNotify )
+{
+    TaskHandle_t xPartner;
+    uint32_t ulIteration, ulStart, ulElapsed;
+
+    xPartner = prvCreatePartner( prvNotifyPartnerTask, uxTaskPriorityGet( NULL ) + 1 );
+
+    ulStart = benchmarkGET_TIMESTAMP();
+
+    for( ulIteration = 0; ulIteration < benchmarkITERATIONS; ulIteration++ )
+    {
+        ( void ) xTaskNotifyGive( xPartner );
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+    }
+
+    ulElapsed = benchmarkGET_TIMESTAMP() - ulStart;
+
+    vTaskDelete( xPartner );
+    prvReport( "context_switch_notify", 0, benchmarkITERATIONS, ulElapsed );
+}
+/*-----------------------------------------------------------*/
+
+/* As ContextSwitchNotify, but through a pair of binary semaphores. */
+TEST( Full_Kernel_Benchmark, ContextSwitchSemaphore )
+{
+    TaskHandle_t xPartner;
+    uint32_t ulIteration, ulStart, ulElapsed;
+
+    xPingSemaphore = xSemaphoreCreateBinary();
+    xPongSemaphore = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL( xPingSemaphore );
+    TEST_ASSERT_NOT_NULL( xPongSemaphore );
+
+    xPartner = prvCreatePartner( prvSemaphorePartnerTask, uxTaskPriorityGet( NULL ) + 1 );
+
+    ulStart = benchmarkGET_TIMESTAMP();
+
+    for( ulIteration = 0; ulIteration < benchmarkITERATIONS; ulIteration++ )
+    {
+        ( void ) xSemaphoreGive( xPingSemaphore );
+        ( void ) xSemaphoreTake( xPongSemaphore, portMAX_DELAY );
+    }
+
+    ulElapsed = benchmarkGET_TIMESTAMP() - ulStart;
+
+    vTaskDelete( xPartner );
+    vSemaphoreDelete( xPingSemaphore );
+    vSemaphoreDelete( xPongSemaphore );
+    prvReport( "context_switch_semaphore", 0, benchmarkITERATIONS, ulElapsed );
+}
+/*-----------------------------------------------------------*/
+
+/* Send then receive one item from the same task, so the copy in and out of
+ * the queue storage is measured without a context switch. */
+TEST( Full_Kernel_Benchmark, QueueSendReceive )
+{
+    static const UBaseType_t uxItemSizes[] = { 4U, 16U, 64U, benchmarkMAX_ITEM_SIZE };
+    QueueHandle_t xQueue;
+    uint32_t ulSize, ulIteration, ulStart, ulElapsed;
+
+    for( ulSize = 0; ulSize < ( sizeof( uxItemSizes ) / sizeof( uxItemSizes[ 0 ] ) ); ulSize++ )
+    {
+        xQueue = xQueueCreate( 1, uxItemSizes[ ulSize ] );
+        TEST_ASSERT_NOT_NULL( xQueue );
+
+        ulStart = benchmarkGET_TIMESTAMP();
+
+        for( ulIteration = 0; ulIteration < benchmarkITERATIONS; ulIteration++ )
+        {
+            ( void ) xQueueSend( xQueue, ucTxBuffer, 0 );
+            ( void ) xQueueReceive( xQueue, ucRxBuffer, 0 );
+        }
+
+        ulElapsed = benchmarkGET_TIMESTAMP() - ulStart;
+
+        vQueueDelete( xQueue );
+        prvReport( "queue_send_receive", ( uint32_t ) uxItemSizes[ ulSize ], benchmarkITERATIONS, ulElapsed );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Write then read chunks of increasing size through a stream buffer.  The
+ * param is the chunk size; bytes per second follow from ns_per_op. */
+TEST( Full_Kernel_Benchmark, StreamBufferThroughput )
+{
+    static const size_t xChunkSizes[] = { 1U, 16U, 128U, 1024U };
+    StreamBufferHandle_t xStreamBuffer;
+    uint32_t ulSize, ulIteration, ulStart, ulElapsed;
+    size_t xReceived = 0;
+
+    xStreamBuffer = xStreamBufferCreate( benchmarkSTREAM_BUFFER_SIZE, 1 );
+    TEST_ASSERT_NOT_NULL( xStreamBuffer );
+
+    for( ulSize = 0; ulSize < ( sizeof( xChunkSizes ) / sizeof( xChunkSizes[ 0 ] ) ); ulSize++ )
+    {
+        ulStart = benchmarkGET_TIMESTAMP();
+
+        for( ulIteration = 0; ulIteration < benchmarkITERATIONS; ulIteration++ )
+        {
+            ( void ) xStreamBufferSend( xStreamBuffer, ucTxBuffer, xChunkSizes[ ulSize ], 0 );
+            xReceived = xStreamBufferReceive( xStreamBuffer, ucRxBuffer, sizeof( ucRxBuffer ), 0 );
+        }
+
+        ulElapsed = benchmarkGET_TIMESTAMP() - ulStart;
+
+        TEST_ASSERT_EQUAL( xChunkSizes[ ulSize ], xReceived );
+        prvReport( "stream_buffer_send_receive", ( uint32_t ) xChunkSizes[ ulSize ], benchmarkITERATIONS, ulElapsed );
+    }
+
+    vStreamBufferDelete( xStreamBuffer );
+}
+/*-----------------------------------------------------------*/
+
+/* Re-arm a timer that never expires.  Each operation includes the switch to
+ * the timer service task that processes the command. */
+TEST( Full_Kernel_Benchmark, TimerArm )
+{
+    TimerHandle_t xTimer;
+    uint32_t ulIteration, ulStart, ulElapsed;
+
+    xTimer = xTimerCreate( "BenchArm", portMAX_DELAY - 1, pdFALSE, NULL, prvTimerCallback );
+    TEST_ASSERT_NOT_NULL( xTimer );
+
+    ulStart = benchmarkGET_TIMESTAMP();
+
+    for( ulIteration = 0; ulIteration < benchmarkITERATIONS; ulIteration++ )
+    {
+        ( void ) xTimerReset( xTimer, portMAX_DELAY );
+    }
+
+    ulElapsed = benchmarkGET_TIMESTAMP() - ulStart;
+
+    ( void ) xTimerDelete( xTimer, portMAX_DELAY );
+    prvReport( "timer_arm", 0, benchmarkITERATIONS, ulElapsed );
+}
+/*-----------------------------------------------------------*/
+
+/* Start a batch of one tick timers together and wait for all of them to
+ * expire.  The result is dominated by the tick period, so it is mainly
+ * useful to spot regressions in the timer list handling as the param (the
+ * batch size) grows. */
+TEST( Full_Kernel_Benchmark, TimerExpire )
+{
+    TimerHandle_t xTimers[ benchmarkTIMER_BATCH ];
+    uint32_t ulTimer, ulRound, ulStart, ulElapsed = 0;
+    const uint32_t ulRounds = benchmarkITERATIONS / ( benchmarkTIMER_BATCH * 10U );
+
+    for( ulTimer = 0; ulTimer < benchmarkTIMER_BATCH; ulTimer++ )
+    {
+        xTimers[ ulTimer ] = xTimerCreate( "BenchExp", 1, pdFALSE, NULL, prvTimerCallback );
+        TEST_ASSERT_NOT_NULL( xTimers[ ulTimer ] );
+    }
+
+    for( ulRound = 0; ulRound < ulRounds; ulRound++ )
+    {
+        ulTimerExpiries = 0;
+        ulStart = benchmarkGET_TIMESTAMP();
+
+        for( ulTimer = 0; ulTimer < benchmarkTIMER_BATCH; ulTimer++ )
+        {
+            ( void ) xTimerStart( xTimers[ ulTimer ], portMAX_DELAY );
+        }
+
+        TEST_ASSERT_NOT_EQUAL( 0, ulTaskNotifyTake( pdTRUE, pdMS_TO_TICKS( 1000 ) ) );
+        ulElapsed += benchmarkGET_TIMESTAMP() - ulStart;
+    }
+
+    for( ulTimer = 0; ulTimer < benchmarkTIMER_BATCH; ulTimer++ )
+    {
+        ( void ) xTimerDelete( xTimers[ ulTimer ], portMAX_DELAY );
+    }
+
+    prvReport( "timer_expire", benchmarkTIMER_BATCH, ulRounds * benchmarkTIMER_BATCH, ulElapsed );
+}
+/*-----------------------------------------------------------*/
+
+/* pvPortMalloc()/vPortFree() for every heap implementation in the kernel. */
+TEST( Full_Kernel_Benchmark, HeapMallocFree )
+{
+    prvHeapBenchmark( &xBenchmarkHeap1 );
+    prvHeapBenchmark( &xBenchmarkHeap2 );
+    prvHeapBenchmark( &xBenchmarkHeap3 );
+    prvHeapBenchmark( &xBenchmarkHeap4 );
+    prvHeapBenchmark( &xBenchmarkHeap5 );
+}
+/*-----------------------------------------------------------*/
@@ -189,6 +189,18 @@ static void RunTests( void )
         RUN_TEST_GROUP( Full_Serializer_CBOR );
         RUN_TEST_GROUP( Full_Serializer_JSON );
     #endif
+
+    #if ( testrunnerFULL_KERNEL_BENCHMARK_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_Kernel_Benchmark );
+    #endif
+
+    #if ( testrunnerFULL_CHECKSUM_BENCHMARK_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_Checksum_Benchmark );
+    #endif
+
+    #if ( testrunnerFULL_KERNEL_WORK_QUEUE_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_Kernel_Work_Queue );
+    #endif
 }
 /*-----------------------------------------------------------*/
 
@@ -0,0 +1,145 @@
+/*
+ * Amazon FreeRTOS V201906.00 Major
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_test_kernel_work_queue.c
+ * @brief Tests of the kernel work queues in work_queue.c.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if ( configUSE_WORK_QUEUES != 0 )
+    #include "work_queue.h"
+#endif
+
+/* Test includes. */
+#include "unity_fixture.h"
+#include "unity.h"
+#include "aws_test_runner.h"
+
+/*
+ * @brief Number of items in the ring of the tested work queue.
+ */
+#define testWORK_QUEUE_LENGTH    ( 4U )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * @brief Test group definition.
+ */
+TEST_GROUP( Full_Kernel_Work_Queue );
+
+TEST_SETUP( Full_Kernel_Work_Queue )
+{
+}
+
+TEST_TEAR_DOWN( Full_Kernel_Work_Queue )
+{
+}
+
+TEST_GROUP_RUNNER( Full_Kernel_Work_Queue )
+{
+    #if ( configUSE_WORK_QUEUES != 0 )
+        RUN_TEST_CASE( Full_Kernel_Work_Queue, SubmitAndExecute );
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_WORK_QUEUES != 0 )
+
+    static uint32_t ulWorkDone[ testWORK_QUEUE_LENGTH ];
+    static volatile uint32_t ulWorkCount;
+
+/* Runs in the worker task, where a failing assertion can not end the test, so
+ * it only records what it was passed. */
+    static void prvWorkFunction( void * pvParameter1,
+                                 uint32_t ulParameter2 )
+    {
+        if( ( pvParameter1 == ( void * ) ulWorkDone ) && ( ulWorkCount < testWORK_QUEUE_LENGTH ) )
+        {
+            ulWorkDone[ ulWorkCount ] = ulParameter2;
+        }
+
+        ulWorkCount++;
+    }
+/*-----------------------------------------------------------*/
+
+/* Items submitted while the worker can not run are executed in order after a
+ * single wake-up, and a submission to a full ring is refused. */
+    TEST( Full_Kernel_Work_Queue, SubmitAndExecute )
+    {
+        /* Work queues can not be deleted, so one is kept for all runs. */
+        static WorkQueueHandle_t xWorkQueue = NULL;
+        WorkQueueStats_t xBefore, xAfter;
+        uint32_t ulIndex;
+
+        if( xWorkQueue == NULL )
+        {
+            xWorkQueue = xWorkQueueCreate( testWORK_QUEUE_LENGTH, 1U, uxTaskPriorityGet( NULL ) + 1U, configMINIMAL_STACK_SIZE * 2U, "WorkQ" );
+        }
+
+        TEST_ASSERT_NOT_NULL( xWorkQueue );
+        vWorkQueueGetStats( xWorkQueue, &xBefore );
+        ulWorkCount = 0U;
+
+        /* The worker has a higher priority, with the scheduler suspended it
+         * only runs once all items have been submitted. */
+        vTaskSuspendAll();
+
+        for( ulIndex = 0U; ulIndex < testWORK_QUEUE_LENGTH; ulIndex++ )
+        {
+            TEST_ASSERT_EQUAL( pdPASS, xWorkQueueSubmit( xWorkQueue, prvWorkFunction, ulWorkDone, ulIndex + 100U ) );
+        }
+
+        TEST_ASSERT_EQUAL( pdFAIL, xWorkQueueSubmit( xWorkQueue, prvWorkFunction, ulWorkDone, 0U ) );
+        ( void ) xTaskResumeAll();
+        vTaskDelay( 2 );
+
+        TEST_ASSERT_EQUAL( testWORK_QUEUE_LENGTH, ulWorkCount );
+
+        for( ulIndex = 0U; ulIndex < testWORK_QUEUE_LENGTH; ulIndex++ )
+        {
+            TEST_ASSERT_EQUAL( ulIndex + 100U, ulWorkDone[ ulIndex ] );
+        }
+
+        vWorkQueueGetStats( xWorkQueue, &xAfter );
+        TEST_ASSERT_EQUAL( testWORK_QUEUE_LENGTH, xAfter.ulSubmitted - xBefore.ulSubmitted );
+        TEST_ASSERT_EQUAL( testWORK_QUEUE_LENGTH, xAfter.ulExecuted - xBefore.ulExecuted );
+        TEST_ASSERT_EQUAL( 1U, xAfter.ulWakeUps - xBefore.ulWakeUps );
+        TEST_ASSERT_EQUAL( 1U, xAfter.ulOverflows - xBefore.ulOverflows );
+
+        /* The ring is usable again once it has been emptied. */
+        TEST_ASSERT_EQUAL( pdPASS, xWorkQueueSubmit( xWorkQueue, prvWorkFunction, ulWorkDone, 0U ) );
+        vTaskDelay( 2 );
+        TEST_ASSERT_EQUAL( testWORK_QUEUE_LENGTH + 1U, ulWorkCount );
+    }
+
+#endif /* if ( configUSE_WORK_QUEUES != 0 ) */
+/*-----------------------------------------------------------*/
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+#
+# Extract kernel benchmark results from a test log and compare two runs.
+#
+# Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The kernel benchmarks in tests/benchmark print one line per measurement:
+#
+#   BENCHMARK {"name":"queue_send_receive","param":64,...,"ns_per_op":123}
+#
+# Usage:
+#   compare_benchmarks.py extract <log> [<out.json>]
+#   compare_benchmarks.py compare <baseline.json|log> <current.json|log> [--threshold PERCENT]
+#
+# "compare" exits with status 1 if any benchmark got slower by more than the
+# threshold (default 10%), so it can gate a CI job.
+
+import argparse
+import json
+import sys
+
+MARKER = "BENCHMARK "
+
+
+def load_results(path):
+    """Return {(name, param): ns_per_op} from a saved JSON file or a raw log."""
+    with open(path, encoding="utf-8", errors="replace") as f:
+        text = f.read()
+
+    try:
+        records = json.loads(text)
+    except ValueError:
+        records = []
+        for line in text.splitlines():
+            index = line.find(MARKER)
+            if index >= 0:
+                records.append(json.loads(line[index + len(MARKER):].strip()))
+
+    return {(r["name"], r["param"]): r["ns_per_op"] for r in records}
+
+
+def extract(args):
+    results = load_results(args.log)
+    records = [{"name": name, "param": param, "ns_per_op": ns}
+               for (name, param), ns in sorted(results.items())]
+    out = open(args.out, "w") if args.out else sys.stdout
+    json.dump(records, out, indent=2)
+    out.write("\n")
+    return 0
+
+
+def compare(args):
+    baseline = load_results(args.baseline)
+    current = load_results(args.current)
+    regressions = 0
+
+    print("%-32s %8s %12s %12s %8s" % ("benchmark", "param", "baseline", "current", "change"))
+    for key in sorted(set(baseline) | set(current)):
+        name, param = key
+        if key not in baseline or key not in current:
+            print("%-32s %8s %12s %12s %8s" % (name, param,
+                                              baseline.get(key, "-"),
+                                              current.get(key, "-"), "n/a"))
+            continue
+
+        old, new = baseline[key], current[key]
+        change = ((new - old) * 100.0 / old) if old else 0.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        print("%-32s %8s %12d %12d %+7.1f%%%s" % (name, param, old, new, change, flag))
+
+    return 1 if regressions else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    sub = parser.add_subparsers(dest="command")
+    sub.required = True
+
+    p = sub.add_parser("extract", help="write the results found in a test log as JSON")
+    p.add_argument("log")
+    p.add_argument("out", nargs="?")
+    p.set_defaults(func=extract)
+
+    p = sub.add_parser("compare", help="compare two result sets")
+    p.add_argument("baseline")
+    p.add_argument("current")
+    p.add_argument("--threshold", type=float, default=10.0,
+                   help="percentage slowdown reported as a regression")
+    p.set_defaults(func=compare)
+
+    args = parser.parse_args()
+    return args.func(args)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -78,6 +78,9 @@
 /* Event group related definitions. */
 #define configUSE_EVENT_GROUPS                     1
 
+/* Work queue related definitions, enabled for the kernel work queue tests. */
+#define configUSE_WORK_QUEUES                      1
+
 /* Run time stats gathering definitions. */
 unsigned long ulGetRunTimeCounterValue( void );
 void vConfigureTimerForRunTimeStats( void );
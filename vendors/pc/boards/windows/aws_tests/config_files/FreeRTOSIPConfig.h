@@ -243,7 +243,7 @@ extern uint32_t ulRand();
 
 /* If ipconfigSUPPORT_SELECT_FUNCTION is set to 1 then the FreeRTOS_select()
  * (and associated) API function is available. */
-#define ipconfigSUPPORT_SELECT_FUNCTION                0
+#define ipconfigSUPPORT_SELECT_FUNCTION                1
 
 /* If ipconfigFILTER_OUT_NON_ETHERNET_II_FRAMES is set to 1 then Ethernet frames
  * that are not in Ethernet II format will be dropped.  This option is included for
@@ -297,6 +297,29 @@ extern uint32_t ulRand();
 #define ipconfigSOCKET_HAS_USER_WAKE_CALLBACK    ( 1 )
 #define ipconfigUSE_CALLBACKS                    ( 0 )
 
+/* The optional features of the stack are enabled so that the FreeRTOS+TCP tests
+ * that depend on them are built and run.  ipconfigUSE_MULTI_INTERFACE is left
+ * at 0: in that mode the stack implements xNetworkInterfaceInitialise() and
+ * xNetworkInterfaceOutput() itself, which the WinPCap driver also does. */
+#define ipconfigUSE_TCP_TIMESTAMPS               ( 1 )
+#define ipconfigUSE_TCP_CONGESTION_CONTROL       ( 1 )
+#define ipconfigUSE_TCP_INFO                     ( 1 )
+#define ipconfigTCP_SYN_CACHE_SIZE               ( 8 )
+#define ipconfigTCP_SYN_COOKIES                  ( 1 )
+#define ipconfigTCP_ACK_EVERY_N_SEGMENTS         ( 2 )
+#define ipconfigTCP_QUICKACK_IDLE_MS             ( 1000 )
+#define ipconfigTCP_RX_COALESCE_BYTES            ( 4000 )
+#define ipconfigUSE_DRIVER_OFFLOADS              ( 1 )
+#define ipconfigUSE_NETWORK_BUFFER_CHAINS        ( 1 )
+#define ipconfigUSE_LINKED_RX_MESSAGES           ( 1 )
+#define ipconfigUSE_IP_REASSEMBLY                ( 1 )
+#define ipconfigUSE_IPv6                         ( 1 )
+#define ipconfigUSE_PCAP_CAPTURE                 ( 1 )
+#define ipconfigUSE_UDP_BATCH                    ( 1 )
+#define ipconfigARP_HASH_TABLE_SIZE              ( 8 )
+#define ipconfigDNS_USE_CALLBACKS                ( 1 )
+#define ipconfigSUPPORT_SELECT_READY_LIST        ( 1 )
+
 
 #define portINLINE                               __inline
 
@@ -61,6 +61,14 @@
 #define testrunnerFULL_SERIALIZER_ENABLED             0
 #define testrunnerUTIL_PLATFORM_CLOCK_ENABLED         0
 #define testrunnerUTIL_PLATFORM_THREADS_ENABLED       0
+#define testrunnerFULL_KERNEL_BENCHMARK_ENABLED       0
+#define testrunnerFULL_CHECKSUM_BENCHMARK_ENABLED     0
+#define testrunnerFULL_KERNEL_WORK_QUEUE_ENABLED      1
+
+/* Time base for the kernel and checksum benchmarks.  The run time stats counter of this
+ * port counts in 1/100ths of a millisecond. */
+#define benchmarkGET_TIMESTAMP()                      ( ( uint32_t ) ulGetRunTimeCounterValue() )
+#define benchmarkNS_PER_TIMESTAMP                     ( 10000ULL )
 
 /* On systems using FreeRTOS+TCP (such as this one) the TCP segments must be
  * cleaned up before running the memory leak check. */